@@ -0,0 +1,925 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "apps/oskar_option_parser.h"
+#include "correlate/oskar_auto_correlate.h"
+#include "correlate/oskar_cross_correlate.h"
+#include "imager/oskar_grid_simple.h"
+#include "imager/oskar_grid_wproj.h"
+#include "imager/oskar_grid_functions_spheroidal.h"
+#include "interferometer/oskar_evaluate_jones_K.h"
+#include "interferometer/oskar_jones.h"
+#include "math/oskar_cmath.h"
+#include "math/oskar_dft_c2r.h"
+#include "math/oskar_dftw.h"
+#include "math/oskar_dftw_nufft.h"
+#include "math/oskar_fft.h"
+#include "mem/oskar_mem.h"
+#include "sky/oskar_sky.h"
+#include "splines/oskar_splines.h"
+#include "telescope/oskar_telescope.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_timer.h"
+#include "utility/oskar_version_string.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+struct Result
+{
+    string kernel, precision, location, size, work_unit;
+    int repeats;
+    double min_sec, median_sec, mean_sec, work;
+};
+
+/*
+ * Each benchmark sets up its inputs in the constructor, frees them in the
+ * destructor, and runs the kernel once per call to run().
+ * Anything that must be done between timed calls goes in reset().
+ */
+class Benchmark
+{
+public:
+    Benchmark(const char* kernel, int prec, int location)
+    : kernel_(kernel), prec_(prec), loc_(location), work_(0.0) {}
+    virtual ~Benchmark() {}
+    virtual void reset(int* /*status*/) {}
+    virtual void run(int* status) = 0;
+    const char* kernel() const { return kernel_; }
+    int location() const { return loc_; }
+    const string& size() const { return size_; }
+    const string& work_unit() const { return work_unit_; }
+    double work() const { return work_; }
+protected:
+    void describe(const char* size, double work, const char* unit)
+    {
+        size_ = size;
+        work_ = work;
+        work_unit_ = unit;
+    }
+    const char* kernel_;
+    int prec_, loc_;
+    double work_;
+    string size_, work_unit_;
+};
+
+static string str(const char* fmt, int a, int b = -1)
+{
+    char buf[128];
+    if (b < 0) snprintf(buf, sizeof(buf), fmt, a);
+    else snprintf(buf, sizeof(buf), fmt, a, b);
+    return string(buf);
+}
+
+class BenchCrossCorrelate : public Benchmark
+{
+public:
+    BenchCrossCorrelate(int prec, int loc, int num_stations, int num_sources,
+            int* status)
+    : Benchmark("cross_correlate", prec, loc)
+    {
+        const int jones_type = prec | OSKAR_COMPLEX | OSKAR_MATRIX;
+        tel = oskar_telescope_create(prec, loc, num_stations, status);
+        sky = oskar_sky_create(prec, loc, num_sources, status);
+        J = oskar_jones_create(jones_type, loc, num_stations, num_sources,
+                status);
+        vis = oskar_mem_create(jones_type, loc,
+                oskar_telescope_num_baselines(tel), status);
+        u = oskar_mem_create(prec, loc, num_stations, status);
+        v = oskar_mem_create(prec, loc, num_stations, status);
+        w = oskar_mem_create(prec, loc, num_stations, status);
+        oskar_mem_random_range(oskar_jones_mem(J), 1.0, 5.0, status);
+        oskar_mem_random_range(u, 1.0, 5.0, status);
+        oskar_mem_random_range(v, 1.0, 5.0, status);
+        oskar_mem_random_range(w, 1.0, 5.0, status);
+        oskar_mem_random_range(oskar_sky_I(sky), 1.0, 2.0, status);
+        oskar_mem_random_range(oskar_sky_Q(sky), 0.1, 1.0, status);
+        oskar_mem_random_range(oskar_sky_U(sky), 0.1, 0.5, status);
+        oskar_mem_random_range(oskar_sky_V(sky), 0.1, 0.2, status);
+        oskar_mem_random_range(oskar_sky_l(sky), 0.1, 0.9, status);
+        oskar_mem_random_range(oskar_sky_m(sky), 0.1, 0.9, status);
+        oskar_mem_random_range(oskar_sky_n(sky), 0.1, 0.9, status);
+        oskar_telescope_set_channel_bandwidth(tel, 100e3);
+        oskar_telescope_set_time_average(tel, 1.0);
+        describe(str("stations=%d,sources=%d", num_stations,
+                num_sources).c_str(), (double)num_sources *
+                oskar_telescope_num_baselines(tel), "baseline-sources");
+    }
+    ~BenchCrossCorrelate()
+    {
+        int status = 0;
+        oskar_mem_free(u, &status);
+        oskar_mem_free(v, &status);
+        oskar_mem_free(w, &status);
+        oskar_mem_free(vis, &status);
+        oskar_jones_free(J, &status);
+        oskar_telescope_free(tel, &status);
+        oskar_sky_free(sky, &status);
+    }
+    void reset(int* status) { oskar_mem_clear_contents(vis, status); }
+    void run(int* status)
+    {
+        oskar_cross_correlate(vis, oskar_sky_num_sources(sky), J, sky, tel,
+                u, v, w, 0.0, 100e6, status);
+    }
+private:
+    oskar_Telescope* tel;
+    oskar_Sky* sky;
+    oskar_Jones* J;
+    oskar_Mem *vis, *u, *v, *w;
+};
+
+class BenchAutoCorrelate : public Benchmark
+{
+public:
+    BenchAutoCorrelate(int prec, int loc, int num_stations, int num_sources,
+            int* status)
+    : Benchmark("auto_correlate", prec, loc)
+    {
+        const int jones_type = prec | OSKAR_COMPLEX | OSKAR_MATRIX;
+        sky = oskar_sky_create(prec, loc, num_sources, status);
+        J = oskar_jones_create(jones_type, loc, num_stations, num_sources,
+                status);
+        vis = oskar_mem_create(jones_type, loc, num_stations, status);
+        oskar_mem_random_range(oskar_jones_mem(J), 1.0, 5.0, status);
+        oskar_mem_random_range(oskar_sky_I(sky), 1.0, 2.0, status);
+        oskar_mem_random_range(oskar_sky_Q(sky), 0.1, 1.0, status);
+        oskar_mem_random_range(oskar_sky_U(sky), 0.1, 0.5, status);
+        oskar_mem_random_range(oskar_sky_V(sky), 0.1, 0.2, status);
+        describe(str("stations=%d,sources=%d", num_stations,
+                num_sources).c_str(), (double)num_sources * num_stations,
+                "station-sources");
+    }
+    ~BenchAutoCorrelate()
+    {
+        int status = 0;
+        oskar_mem_free(vis, &status);
+        oskar_jones_free(J, &status);
+        oskar_sky_free(sky, &status);
+    }
+    void reset(int* status) { oskar_mem_clear_contents(vis, status); }
+    void run(int* status)
+    {
+        oskar_auto_correlate(vis, oskar_sky_num_sources(sky), J, sky, status);
+    }
+private:
+    oskar_Sky* sky;
+    oskar_Jones* J;
+    oskar_Mem* vis;
+};
+
+class BenchJonesK : public Benchmark
+{
+public:
+    BenchJonesK(int prec, int loc, int num_stations, int num_sources,
+            int* status)
+    : Benchmark("evaluate_jones_K", prec, loc)
+    {
+        sky = oskar_sky_create(prec, loc, num_sources, status);
+        K = oskar_jones_create(prec | OSKAR_COMPLEX, loc, num_stations,
+                num_sources, status);
+        u = oskar_mem_create(prec, loc, num_stations, status);
+        v = oskar_mem_create(prec, loc, num_stations, status);
+        w = oskar_mem_create(prec, loc, num_stations, status);
+        oskar_mem_random_range(u, -1000.0, 1000.0, status);
+        oskar_mem_random_range(v, -1000.0, 1000.0, status);
+        oskar_mem_random_range(w, -10.0, 10.0, status);
+        oskar_mem_random_range(oskar_sky_I(sky), 1.0, 2.0, status);
+        oskar_mem_random_range(oskar_sky_l(sky), -0.1, 0.1, status);
+        oskar_mem_random_range(oskar_sky_m(sky), -0.1, 0.1, status);
+        oskar_mem_random_range(oskar_sky_n(sky), 0.9, 1.0, status);
+        describe(str("stations=%d,sources=%d", num_stations,
+                num_sources).c_str(), (double)num_sources * num_stations,
+                "station-sources");
+    }
+    ~BenchJonesK()
+    {
+        int status = 0;
+        oskar_mem_free(u, &status);
+        oskar_mem_free(v, &status);
+        oskar_mem_free(w, &status);
+        oskar_jones_free(K, &status);
+        oskar_sky_free(sky, &status);
+    }
+    void run(int* status)
+    {
+        oskar_evaluate_jones_K(K, oskar_sky_num_sources(sky),
+                oskar_sky_l_const(sky), oskar_sky_m_const(sky),
+                oskar_sky_n_const(sky), u, v, w, 100e6,
+                oskar_sky_I_const(sky), 0.0, 1e30, status);
+    }
+private:
+    oskar_Sky* sky;
+    oskar_Jones* K;
+    oskar_Mem *u, *v, *w;
+};
+
+class BenchDftw : public Benchmark
+{
+public:
+    BenchDftw(int prec, int loc, int num_in, int num_out, double tolerance,
+            int* status)
+    : Benchmark(tolerance > 0.0 ? "dftw_nufft" : "dftw", prec, loc),
+      num_in_(num_in), num_out_(num_out), tolerance_(tolerance)
+    {
+        x_in = oskar_mem_create(prec, loc, num_in, status);
+        y_in = oskar_mem_create(prec, loc, num_in, status);
+        z_in = oskar_mem_create(prec, loc, num_in, status);
+        weights = oskar_mem_create(prec | OSKAR_COMPLEX, loc, num_in, status);
+        x_out = oskar_mem_create(prec, loc, num_out, status);
+        y_out = oskar_mem_create(prec, loc, num_out, status);
+        z_out = oskar_mem_create(prec, loc, num_out, status);
+        output = oskar_mem_create(prec | OSKAR_COMPLEX, loc, num_out, status);
+        oskar_mem_random_range(x_in, -50.0, 50.0, status);
+        oskar_mem_random_range(y_in, -50.0, 50.0, status);
+        if (tolerance > 0.0)
+            oskar_mem_clear_contents(z_in, status); /* Must be coplanar. */
+        else
+            oskar_mem_random_range(z_in, -1.0, 1.0, status);
+        oskar_mem_random_range(weights, -1.0, 1.0, status);
+        oskar_mem_random_range(x_out, -0.5, 0.5, status);
+        oskar_mem_random_range(y_out, -0.5, 0.5, status);
+        oskar_mem_random_range(z_out, 0.7, 1.0, status);
+        describe(str("inputs=%d,outputs=%d", num_in, num_out).c_str(),
+                (double)num_in * num_out, "point-pairs");
+    }
+    ~BenchDftw()
+    {
+        int status = 0;
+        oskar_mem_free(x_in, &status);
+        oskar_mem_free(y_in, &status);
+        oskar_mem_free(z_in, &status);
+        oskar_mem_free(weights, &status);
+        oskar_mem_free(x_out, &status);
+        oskar_mem_free(y_out, &status);
+        oskar_mem_free(z_out, &status);
+        oskar_mem_free(output, &status);
+    }
+    void run(int* status)
+    {
+        if (tolerance_ > 0.0)
+            oskar_dftw_nufft(num_in_, 2.0 * M_PI, x_in, y_in, z_in, weights,
+                    num_out_, x_out, y_out, z_out, tolerance_, output,
+                    status);
+        else
+            oskar_dftw(num_in_, 2.0 * M_PI, x_in, y_in, z_in, weights,
+                    num_out_, x_out, y_out, z_out, 0, output, status);
+    }
+private:
+    int num_in_, num_out_;
+    double tolerance_;
+    oskar_Mem *x_in, *y_in, *z_in, *weights, *x_out, *y_out, *z_out, *output;
+};
+
+class BenchDftC2R : public Benchmark
+{
+public:
+    BenchDftC2R(int prec, int loc, int num_in, int image_size, int* status)
+    : Benchmark("dft_c2r", prec, loc), num_in_(num_in),
+      num_out_(image_size * image_size)
+    {
+        x_in = oskar_mem_create(prec, loc, num_in, status);
+        y_in = oskar_mem_create(prec, loc, num_in, status);
+        z_in = oskar_mem_create(prec, loc, num_in, status);
+        data = oskar_mem_create(prec | OSKAR_COMPLEX, loc, num_in, status);
+        weights = oskar_mem_create(prec, loc, num_in, status);
+        x_out = oskar_mem_create(prec, loc, num_out_, status);
+        y_out = oskar_mem_create(prec, loc, num_out_, status);
+        z_out = oskar_mem_create(prec, loc, num_out_, status);
+        output = oskar_mem_create(prec, loc, num_out_, status);
+        oskar_mem_random_range(x_in, -500.0, 500.0, status);
+        oskar_mem_random_range(y_in, -500.0, 500.0, status);
+        oskar_mem_random_range(z_in, -10.0, 10.0, status);
+        oskar_mem_random_range(data, -1.0, 1.0, status);
+        oskar_mem_random_range(weights, 0.5, 1.0, status);
+        oskar_mem_random_range(x_out, -0.05, 0.05, status);
+        oskar_mem_random_range(y_out, -0.05, 0.05, status);
+        oskar_mem_random_range(z_out, -0.01, 0.0, status);
+        describe(str("inputs=%d,image=%d", num_in, image_size).c_str(),
+                (double)num_in * num_out_, "point-pairs");
+    }
+    ~BenchDftC2R()
+    {
+        int status = 0;
+        oskar_mem_free(x_in, &status);
+        oskar_mem_free(y_in, &status);
+        oskar_mem_free(z_in, &status);
+        oskar_mem_free(data, &status);
+        oskar_mem_free(weights, &status);
+        oskar_mem_free(x_out, &status);
+        oskar_mem_free(y_out, &status);
+        oskar_mem_free(z_out, &status);
+        oskar_mem_free(output, &status);
+    }
+    void run(int* status)
+    {
+        oskar_dft_c2r(num_in_, 2.0 * M_PI, x_in, y_in, z_in, data, weights,
+                num_out_, x_out, y_out, z_out, output, status);
+    }
+private:
+    int num_in_, num_out_;
+    oskar_Mem *x_in, *y_in, *z_in, *data, *weights;
+    oskar_Mem *x_out, *y_out, *z_out, *output;
+};
+
+class BenchSplines : public Benchmark
+{
+public:
+    BenchSplines(int prec, int loc, int num_points, int* status)
+    : Benchmark("splines_evaluate", prec, loc), spline(0), num_points_(num_points)
+    {
+        /* Fit a smooth surface on a coarse spherical grid. */
+        const int n_theta = 19, n_phi = 37, n = n_theta * n_phi;
+        double avg_frac_err = 0.02;
+        vector<double> theta(n), phi(n), z(n), wt(n, 1.0);
+        for (int i = 0, k = 0; i < n_theta; ++i)
+        {
+            for (int j = 0; j < n_phi; ++j, ++k)
+            {
+                theta[k] = i * (M_PI / 2.0) / (n_theta - 1);
+                phi[k] = j * (2.0 * M_PI) / (n_phi - 1);
+                z[k] = cos(theta[k]) * (1.0 + 0.3 * sin(2.0 * phi[k]));
+            }
+        }
+        oskar_Splines* fitted = oskar_splines_create(OSKAR_DOUBLE, OSKAR_CPU,
+                status);
+        oskar_splines_fit(fitted, n, &theta[0], &phi[0], &z[0], &wt[0],
+                OSKAR_SPLINES_SPHERICAL, 1, &avg_frac_err, 1.5, 1.0, 1e-14,
+                status);
+        spline = oskar_splines_create(OSKAR_DOUBLE, loc, status);
+        oskar_splines_copy(spline, fitted, status);
+        oskar_splines_free(fitted, status);
+
+        x = oskar_mem_create(OSKAR_DOUBLE, loc, num_points, status);
+        y = oskar_mem_create(OSKAR_DOUBLE, loc, num_points, status);
+        output = oskar_mem_create(OSKAR_DOUBLE, loc, num_points, status);
+        oskar_mem_random_range(x, 0.0, M_PI / 2.0, status);
+        oskar_mem_random_range(y, 0.0, 2.0 * M_PI, status);
+        describe(str("points=%d", num_points).c_str(), num_points, "points");
+    }
+    ~BenchSplines()
+    {
+        int status = 0;
+        oskar_splines_free(spline, &status);
+        oskar_mem_free(x, &status);
+        oskar_mem_free(y, &status);
+        oskar_mem_free(output, &status);
+    }
+    void run(int* status)
+    {
+        oskar_splines_evaluate(output, 0, 1, spline, num_points_, x, y,
+                status);
+    }
+private:
+    oskar_Splines* spline;
+    int num_points_;
+    oskar_Mem *x, *y, *output;
+};
+
+/* The gridders and the FFT are CPU-only functions. */
+class BenchGrid : public Benchmark
+{
+public:
+    BenchGrid(int prec, int num_points, int grid_size, int num_w_planes,
+            int* status)
+    : Benchmark(num_w_planes > 0 ? "grid_wproj" : "grid_simple", prec,
+            OSKAR_CPU), num_points_(num_points), grid_size_(grid_size),
+      num_w_planes_(num_w_planes), oversample_(4), conv_size_half_(0),
+      cell_size_rad_(1e-4), w_scale_(0.0), norm_(0.0)
+    {
+        const double uv_max = 0.4 * grid_size / (grid_size * cell_size_rad_);
+        uu = oskar_mem_create(prec, OSKAR_CPU, num_points, status);
+        vv = oskar_mem_create(prec, OSKAR_CPU, num_points, status);
+        ww = oskar_mem_create(prec, OSKAR_CPU, num_points, status);
+        vis = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU, num_points,
+                status);
+        weight = oskar_mem_create(prec, OSKAR_CPU, num_points, status);
+        grid = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+                grid_size * grid_size, status);
+        oskar_mem_random_range(uu, -uv_max, uv_max, status);
+        oskar_mem_random_range(vv, -uv_max, uv_max, status);
+        oskar_mem_random_range(ww, -100.0, 100.0, status);
+        oskar_mem_random_range(vis, -1.0, 1.0, status);
+        oskar_mem_random_range(weight, 0.5, 1.0, status);
+        if (num_w_planes > 0)
+        {
+            /* Synthetic W-kernels with support growing with W-plane. */
+            int max_support = 0;
+            for (int i = 0; i < num_w_planes; ++i)
+            {
+                support.push_back(3 + i / 2);
+                max_support = std::max(max_support, support.back());
+            }
+            conv_size_half_ = (max_support + 1) * oversample_;
+            w_scale_ = pow(num_w_planes - 1, 2.0) / 100.0;
+            conv_func = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+                    num_w_planes * conv_size_half_ * conv_size_half_, status);
+            oskar_mem_random_range(conv_func, -1.0, 1.0, status);
+            describe(str("points=%d,grid=%d,", num_points, grid_size).append(
+                    str("w_planes=%d", num_w_planes)).c_str(), num_points,
+                    "visibilities");
+        }
+        else
+        {
+            support.push_back(3);
+            oskar_Mem* t = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+                    oversample_ * (support[0] + 1), status);
+            oskar_grid_convolution_function_spheroidal(support[0],
+                    oversample_, oskar_mem_double(t, status));
+            conv_func = oskar_mem_convert_precision(t, prec, status);
+            oskar_mem_free(t, status);
+            describe(str("points=%d,grid=%d", num_points, grid_size).c_str(),
+                    num_points, "visibilities");
+        }
+    }
+    ~BenchGrid()
+    {
+        int status = 0;
+        oskar_mem_free(uu, &status);
+        oskar_mem_free(vv, &status);
+        oskar_mem_free(ww, &status);
+        oskar_mem_free(vis, &status);
+        oskar_mem_free(weight, &status);
+        oskar_mem_free(grid, &status);
+        oskar_mem_free(conv_func, &status);
+    }
+    void reset(int* status)
+    {
+        oskar_mem_clear_contents(grid, status);
+        norm_ = 0.0;
+    }
+    void run(int* status)
+    {
+        size_t num_skipped = 0;
+        if (*status) return;
+        if (prec_ == OSKAR_DOUBLE && num_w_planes_ > 0)
+            oskar_grid_wproj_d((size_t) num_w_planes_, &support[0],
+                    oversample_, conv_size_half_,
+                    oskar_mem_double_const(conv_func, status), num_points_,
+                    oskar_mem_double_const(uu, status),
+                    oskar_mem_double_const(vv, status),
+                    oskar_mem_double_const(ww, status),
+                    oskar_mem_double_const(vis, status),
+                    oskar_mem_double_const(weight, status), cell_size_rad_,
+                    w_scale_, grid_size_, &num_skipped, &norm_,
+                    oskar_mem_double(grid, status));
+        else if (num_w_planes_ > 0)
+            oskar_grid_wproj_f((size_t) num_w_planes_, &support[0],
+                    oversample_, conv_size_half_,
+                    oskar_mem_float_const(conv_func, status), num_points_,
+                    oskar_mem_float_const(uu, status),
+                    oskar_mem_float_const(vv, status),
+                    oskar_mem_float_const(ww, status),
+                    oskar_mem_float_const(vis, status),
+                    oskar_mem_float_const(weight, status),
+                    (float) cell_size_rad_, (float) w_scale_, grid_size_,
+                    &num_skipped, &norm_, oskar_mem_float(grid, status));
+        else if (prec_ == OSKAR_DOUBLE)
+            oskar_grid_simple_d(support[0], oversample_,
+                    oskar_mem_double_const(conv_func, status), num_points_,
+                    oskar_mem_double_const(uu, status),
+                    oskar_mem_double_const(vv, status),
+                    oskar_mem_double_const(vis, status),
+                    oskar_mem_double_const(weight, status), cell_size_rad_,
+                    grid_size_, &num_skipped, &norm_,
+                    oskar_mem_double(grid, status));
+        else
+            oskar_grid_simple_f(support[0], oversample_,
+                    oskar_mem_float_const(conv_func, status), num_points_,
+                    oskar_mem_float_const(uu, status),
+                    oskar_mem_float_const(vv, status),
+                    oskar_mem_float_const(vis, status),
+                    oskar_mem_float_const(weight, status),
+                    (float) cell_size_rad_, grid_size_, &num_skipped, &norm_,
+                    oskar_mem_float(grid, status));
+    }
+private:
+    int num_points_, grid_size_, num_w_planes_, oversample_, conv_size_half_;
+    double cell_size_rad_, w_scale_, norm_;
+    vector<int> support;
+    oskar_Mem *uu, *vv, *ww, *vis, *weight, *grid, *conv_func;
+};
+
+class BenchFFT : public Benchmark
+{
+public:
+    BenchFFT(int prec, int size, int* status)
+    : Benchmark("fft", prec, OSKAR_CPU)
+    {
+        const int num_cells = size * size;
+        input = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU, num_cells,
+                status);
+        data = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU, num_cells,
+                status);
+        oskar_mem_random_range(input, -1.0, 1.0, status);
+        fft = oskar_fft_create(prec, OSKAR_CPU, 2, size, 0, status);
+        describe(str("size=%d", size).c_str(),
+                num_cells * log((double)num_cells) / log(2.0), "cell-log2n");
+    }
+    ~BenchFFT()
+    {
+        int status = 0;
+        oskar_mem_free(input, &status);
+        oskar_mem_free(data, &status);
+        oskar_fft_free(fft);
+    }
+    /* Restore the input so that repeated transforms cannot overflow. */
+    void reset(int* status) { oskar_mem_copy(data, input, status); }
+    void run(int* status) { oskar_fft_exec(fft, data, status); }
+private:
+    oskar_Mem *input, *data;
+    oskar_FFT* fft;
+};
+
+static void measure(Benchmark* b, int prec, int repeats,
+        vector<Result>& results, int* status)
+{
+    vector<double> times;
+    oskar_Timer* tmr = oskar_timer_create(b->location() == OSKAR_GPU ?
+            OSKAR_TIMER_CUDA : OSKAR_TIMER_NATIVE);
+
+    /* Untimed warm-up call, then the timed repeats. */
+    for (int i = -1; i < repeats && !*status; ++i)
+    {
+        b->reset(status);
+        oskar_timer_start(tmr);
+        b->run(status);
+        const double t = oskar_timer_elapsed(tmr);
+        if (i >= 0) times.push_back(t);
+    }
+    oskar_timer_free(tmr);
+    if (*status || times.empty()) return;
+
+    Result r;
+    r.kernel = b->kernel();
+    r.precision = (prec == OSKAR_DOUBLE) ? "double" : "single";
+    r.location = (b->location() == OSKAR_GPU) ? "gpu" : "cpu";
+    r.size = b->size();
+    r.work = b->work();
+    r.work_unit = b->work_unit();
+    r.repeats = (int) times.size();
+    r.mean_sec = 0.0;
+    for (size_t i = 0; i < times.size(); ++i) r.mean_sec += times[i];
+    r.mean_sec /= times.size();
+    sort(times.begin(), times.end());
+    r.min_sec = times[0];
+    r.median_sec = (times.size() % 2) ? times[times.size() / 2] :
+            0.5 * (times[times.size() / 2 - 1] + times[times.size() / 2]);
+    results.push_back(r);
+}
+
+static bool selected(const vector<string>& kernels, const char* name)
+{
+    return kernels.empty() ||
+            find(kernels.begin(), kernels.end(), name) != kernels.end();
+}
+
+static void run_all(const vector<string>& kernels, int prec, int loc,
+        double scale, int repeats, bool verbose, vector<Result>& results,
+        int* status)
+{
+    vector<Benchmark*> b;
+    const int s1 = std::max(1, (int)(scale * 1000));
+    const int s10 = std::max(1, (int)(scale * 10000));
+    const int s100 = std::max(1, (int)(scale * 100000));
+    if (selected(kernels, "cross_correlate"))
+    {
+        b.push_back(new BenchCrossCorrelate(prec, loc, 32, s1, status));
+        b.push_back(new BenchCrossCorrelate(prec, loc, 128, s1, status));
+    }
+    if (selected(kernels, "auto_correlate"))
+    {
+        b.push_back(new BenchAutoCorrelate(prec, loc, 128, s10, status));
+    }
+    if (selected(kernels, "evaluate_jones_K"))
+    {
+        b.push_back(new BenchJonesK(prec, loc, 32, s10, status));
+        b.push_back(new BenchJonesK(prec, loc, 128, s10, status));
+    }
+    if (selected(kernels, "dftw"))
+    {
+        b.push_back(new BenchDftw(prec, loc, 256, s10, 0.0, status));
+        b.push_back(new BenchDftw(prec, loc, 1024, s10, 0.0, status));
+    }
+    if (selected(kernels, "dftw_nufft"))
+    {
+        b.push_back(new BenchDftw(prec, loc, 1024, s10, 1e-6, status));
+        b.push_back(new BenchDftw(prec, loc, 4096, s10, 1e-6, status));
+    }
+    if (selected(kernels, "dft_c2r"))
+    {
+        b.push_back(new BenchDftC2R(prec, loc, s1, 64, status));
+    }
+    /* Splines are only ever fitted and evaluated in double precision. */
+    if (selected(kernels, "splines_evaluate") && prec == OSKAR_DOUBLE)
+    {
+        b.push_back(new BenchSplines(prec, loc, s10, status));
+        b.push_back(new BenchSplines(prec, loc, s100, status));
+    }
+    if (selected(kernels, "grid_simple"))
+    {
+        b.push_back(new BenchGrid(prec, s100, 1024, 0, status));
+    }
+    if (selected(kernels, "grid_wproj"))
+    {
+        b.push_back(new BenchGrid(prec, s100, 1024, 16, status));
+    }
+    if (selected(kernels, "fft"))
+    {
+        b.push_back(new BenchFFT(prec, 256, status));
+        b.push_back(new BenchFFT(prec, 1024, status));
+    }
+    for (size_t i = 0; i < b.size(); ++i)
+    {
+        if (!*status)
+        {
+            const size_t n = results.size();
+            measure(b[i], prec, repeats, results, status);
+            if (verbose && results.size() > n)
+            {
+                const Result& r = results.back();
+                printf("%-18s %-6s %-3s %-36s %10.6f s\n", r.kernel.c_str(),
+                        r.precision.c_str(), r.location.c_str(),
+                        r.size.c_str(), r.median_sec);
+            }
+        }
+        delete b[i];
+    }
+}
+
+/*
+ * Results are written one benchmark per line so that they can be read back
+ * by the comparison mode without a general-purpose JSON parser.
+ */
+static void write_json(FILE* f, const vector<Result>& results, int repeats,
+        double scale)
+{
+    int num_threads = 1;
+#ifdef _OPENMP
+    num_threads = omp_get_max_threads();
+#endif
+    fprintf(f, "{\n");
+    fprintf(f, "  \"oskar_version\": \"%s\",\n", oskar_version_string());
+    fprintf(f, "  \"num_threads\": %d,\n", num_threads);
+    fprintf(f, "  \"repeats\": %d,\n", repeats);
+    fprintf(f, "  \"scale\": %g,\n", scale);
+    fprintf(f, "  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result& r = results[i];
+        fprintf(f, "    {\"kernel\": \"%s\", \"precision\": \"%s\", "
+                "\"location\": \"%s\", \"size\": \"%s\", \"repeats\": %d, "
+                "\"min_sec\": %.9g, \"median_sec\": %.9g, "
+                "\"mean_sec\": %.9g, \"work\": %.9g, \"work_unit\": \"%s\", "
+                "\"throughput\": %.9g}%s\n",
+                r.kernel.c_str(), r.precision.c_str(), r.location.c_str(),
+                r.size.c_str(), r.repeats, r.min_sec, r.median_sec,
+                r.mean_sec, r.work, r.work_unit.c_str(),
+                r.median_sec > 0.0 ? r.work / r.median_sec : 0.0,
+                (i < results.size() - 1) ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+}
+
+static string json_string(const string& line, const char* key)
+{
+    const string k = string("\"") + key + "\": \"";
+    size_t p = line.find(k);
+    if (p == string::npos) return string();
+    p += k.size();
+    return line.substr(p, line.find('"', p) - p);
+}
+
+static double json_number(const string& line, const char* key)
+{
+    const string k = string("\"") + key + "\": ";
+    size_t p = line.find(k);
+    if (p == string::npos) return 0.0;
+    return strtod(line.c_str() + p + k.size(), 0);
+}
+
+static bool read_json(const char* filename, vector<Result>& results)
+{
+    FILE* f = fopen(filename, "r");
+    if (!f) return false;
+    string line;
+    char buf[1024];
+    while (fgets(buf, sizeof(buf), f))
+    {
+        line += buf;
+        if (line.empty() || line[line.size() - 1] != '\n') continue;
+        if (line.find("\"kernel\"") != string::npos)
+        {
+            Result r;
+            r.kernel = json_string(line, "kernel");
+            r.precision = json_string(line, "precision");
+            r.location = json_string(line, "location");
+            r.size = json_string(line, "size");
+            r.work_unit = json_string(line, "work_unit");
+            r.repeats = (int) json_number(line, "repeats");
+            r.min_sec = json_number(line, "min_sec");
+            r.median_sec = json_number(line, "median_sec");
+            r.mean_sec = json_number(line, "mean_sec");
+            r.work = json_number(line, "work");
+            results.push_back(r);
+        }
+        line.clear();
+    }
+    fclose(f);
+    return true;
+}
+
+/* Returns the number of benchmarks slower than the baseline by > tolerance. */
+static int compare(const vector<Result>& baseline,
+        const vector<Result>& results, double tolerance)
+{
+    int num_regressions = 0;
+    printf("%-18s %-6s %-3s %-36s %11s %11s %7s\n", "Kernel", "Prec", "Loc",
+            "Size", "Base (s)", "New (s)", "Ratio");
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result& r = results[i];
+        const Result* base = 0;
+        for (size_t j = 0; j < baseline.size(); ++j)
+        {
+            const Result& t = baseline[j];
+            if (t.kernel == r.kernel && t.precision == r.precision &&
+                    t.location == r.location && t.size == r.size)
+            {
+                base = &t;
+                break;
+            }
+        }
+        if (!base || base->median_sec <= 0.0)
+        {
+            printf("%-18s %-6s %-3s %-36s %11s %11.6f %7s\n",
+                    r.kernel.c_str(), r.precision.c_str(), r.location.c_str(),
+                    r.size.c_str(), "-", r.median_sec, "new");
+            continue;
+        }
+        const double ratio = r.median_sec / base->median_sec;
+        const bool regressed = ratio > 1.0 + tolerance;
+        if (regressed) num_regressions++;
+        printf("%-18s %-6s %-3s %-36s %11.6f %11.6f %7.3f%s\n",
+                r.kernel.c_str(), r.precision.c_str(), r.location.c_str(),
+                r.size.c_str(), base->median_sec, r.median_sec, ratio,
+                regressed ? "  REGRESSION" : "");
+    }
+    return num_regressions;
+}
+
+int main(int argc, char** argv)
+{
+    int status = 0;
+
+    oskar::OptionParser opt("oskar_benchmarks", oskar_version_string());
+    opt.set_description("Measures the throughput of the main OSKAR "
+            "processing kernels over a range of problem sizes, and "
+            "optionally compares the results against a stored baseline. "
+            "Available kernels are: cross_correlate, auto_correlate, "
+            "evaluate_jones_K, dftw, dftw_nufft, dft_c2r, splines_evaluate, "
+            "grid_simple, grid_wproj and fft.");
+    opt.add_flag("-k", "Comma-separated list of kernels to run "
+            "(default: all)", 1, "", false, "--kernels");
+    opt.add_flag("-p", "Precision: single, double or both", 1, "both",
+            false, "--precision");
+    opt.add_flag("-s", "Scale factor for problem sizes", 1, "1.0",
+            false, "--scale");
+    opt.add_flag("-n", "Number of timed repeats per benchmark", 1, "5",
+            false, "--repeats");
+    opt.add_flag("-g", "Run kernels with a GPU implementation on the GPU",
+            false, "--gpu");
+    opt.add_flag("-o", "Output JSON file name (default: standard output)",
+            1, "", false, "--output");
+    opt.add_flag("-c", "Baseline JSON file to compare against", 1, "",
+            false, "--compare");
+    opt.add_flag("-t", "Fractional slow-down allowed before a benchmark "
+            "is flagged as a regression", 1, "0.1", false, "--tolerance");
+    opt.add_flag("-q", "Suppress printing.", false, "--quiet");
+    opt.add_example("oskar_benchmarks -o baseline.json");
+    opt.add_example("oskar_benchmarks -k dftw,fft -p single -c baseline.json");
+    if (!opt.check_options(argc, argv)) return EXIT_FAILURE;
+
+    // Get the options.
+    string kernel_list, precision, out_file, baseline_file;
+    double scale = 1.0, tolerance = 0.1;
+    int repeats = 5;
+    opt.get("-k")->getString(kernel_list);
+    opt.get("-p")->getString(precision);
+    opt.get("-s")->getDouble(scale);
+    opt.get("-n")->getInt(repeats);
+    opt.get("-o")->getString(out_file);
+    opt.get("-c")->getString(baseline_file);
+    opt.get("-t")->getDouble(tolerance);
+    const int location = opt.is_set("-g") ? OSKAR_GPU : OSKAR_CPU;
+    const bool verbose = !opt.is_set("-q") && !out_file.empty();
+    vector<string> kernels;
+    for (size_t p = 0; !kernel_list.empty(); )
+    {
+        const size_t q = kernel_list.find(',', p);
+        kernels.push_back(kernel_list.substr(p, q - p));
+        if (q == string::npos) break;
+        p = q + 1;
+    }
+    if (precision != "single" && precision != "double" && precision != "both")
+    {
+        opt.error("Unknown precision '%s'.", precision.c_str());
+        return EXIT_FAILURE;
+    }
+    if (repeats < 1 || scale <= 0.0 || tolerance < 0.0)
+    {
+        opt.error("Repeats and scale must be positive, "
+                "and tolerance must not be negative.");
+        return EXIT_FAILURE;
+    }
+
+    // Read the baseline first, so a bad file name fails early.
+    vector<Result> baseline, results;
+    if (!baseline_file.empty() && !read_json(baseline_file.c_str(), baseline))
+    {
+        opt.error("Unable to read baseline file '%s'.",
+                baseline_file.c_str());
+        return EXIT_FAILURE;
+    }
+
+    // Run the benchmarks.
+    srand(2);
+    if (precision != "double")
+        run_all(kernels, OSKAR_SINGLE, location, scale, repeats, verbose,
+                results, &status);
+    if (precision != "single")
+        run_all(kernels, OSKAR_DOUBLE, location, scale, repeats, verbose,
+                results, &status);
+    if (status)
+    {
+        fprintf(stderr, "ERROR: Benchmark failed with code %i: %s\n", status,
+                oskar_get_error_string(status));
+        return EXIT_FAILURE;
+    }
+
+    // Write the results.
+    if (!out_file.empty())
+    {
+        FILE* f = fopen(out_file.c_str(), "w");
+        if (!f)
+        {
+            opt.error("Unable to open output file '%s'.", out_file.c_str());
+            return EXIT_FAILURE;
+        }
+        write_json(f, results, repeats, scale);
+        fclose(f);
+    }
+    else if (baseline_file.empty())
+        write_json(stdout, results, repeats, scale);
+
+    // Compare against the baseline if required.
+    if (!baseline_file.empty())
+    {
+        const int num_regressions = compare(baseline, results, tolerance);
+        if (num_regressions > 0)
+        {
+            fflush(stdout);
+            fprintf(stderr, "%d benchmark(s) slower than the baseline by "
+                    "more than %.0f%%.\n", num_regressions, 100.0 * tolerance);
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
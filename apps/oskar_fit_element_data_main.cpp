@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014-2017, The University of Oxford
+ * Copyright (c) 2014-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -99,13 +99,17 @@ int main(int argc, char** argv)
 
     // Get the main settings.
     s->begin_group("element_fit");
-    string input_cst_file = s->to_string("input_cst_file", &e);
-    string input_scalar_file = s->to_string("input_scalar_file", &e);
+    int num_cst_files = 0, num_scalar_files = 0, num_freqs = 0;
+    const char* const* input_cst_files =
+            s->to_string_list("input_cst_file", &num_cst_files, &e);
+    const char* const* input_scalar_files =
+            s->to_string_list("input_scalar_file", &num_scalar_files, &e);
     string output_dir = s->to_string("output_directory", &e);
     string pol_type = s->to_string("pol_type", &e);
     // string coordinate_system = s->to_string("coordinate_system", &e);
     int element_type_index = s->to_int("element_type_index", &e);
-    double frequency_hz = s->to_double("frequency_hz", &e);
+    const double* frequency_hz =
+            s->to_double_list("frequency_hz", &num_freqs, &e);
     double average_fractional_error =
             s->to_double("average_fractional_error", &e);
     double average_fractional_error_factor_increase =
@@ -115,64 +119,82 @@ int main(int argc, char** argv)
     int port = pol_type == "X" ? 1 : pol_type == "Y" ? 2 : 0;
 
     // Check that the input and output files have been set.
-    if ((input_cst_file.empty() && input_scalar_file.empty()) ||
-            output_dir.empty())
+    if ((num_cst_files == 0 && num_scalar_files == 0) || output_dir.empty())
     {
         oskar_log_error(log, "Specify input and output file names.");
         SettingsTree::free(s);
         return EXIT_FAILURE;
     }
 
+    // Check there is a frequency for each input file.
+    if ((num_cst_files > 0 && num_cst_files != num_freqs) ||
+            (num_scalar_files > 0 && num_scalar_files != num_freqs))
+    {
+        oskar_log_error(log, "Specify one frequency for each input file.");
+        SettingsTree::free(s);
+        return EXIT_FAILURE;
+    }
+
     // Create an element model.
     oskar_Element* element = oskar_element_create(OSKAR_DOUBLE, OSKAR_CPU, &e);
 
-    // Load the CST text file for the correct port, if specified (X=1, Y=2).
-    if (!input_cst_file.empty())
+    // Load the CST text files for the correct port, if specified (X=1, Y=2).
+    // The surfaces for all frequencies are fitted together.
+    if (num_cst_files > 0)
     {
         oskar_log_line(log, 'M', ' ');
-        oskar_log_message(log, 'M', 0, "Loading CST element pattern: %s",
-                input_cst_file.c_str());
-        oskar_element_load_cst(element, log, port, frequency_hz,
-                input_cst_file.c_str(), average_fractional_error,
+        for (int i = 0; i < num_cst_files; ++i)
+            oskar_log_message(log, 'M', 0, "Loading CST element pattern: %s",
+                    input_cst_files[i]);
+        oskar_element_load_cst_files(element, log, port, num_cst_files,
+                frequency_hz, input_cst_files, average_fractional_error,
                 average_fractional_error_factor_increase,
                 ignore_at_pole, ignore_below_horizon, &e);
 
-        // Construct the output file name based on the settings.
-        if (port == 0)
+        // Construct the output file names based on the settings.
+        for (int i = 0; i < num_cst_files; ++i)
         {
-            string output = construct_element_pathname(output_dir, 1,
-                    element_type_index, frequency_hz);
-            oskar_element_write(element, log, output.c_str(), 1,
-                    frequency_hz, &e);
-            output = construct_element_pathname(output_dir, 2,
-                    element_type_index, frequency_hz);
-            oskar_element_write(element, log, output.c_str(), 2,
-                    frequency_hz, &e);
-        }
-        else
-        {
-            string output = construct_element_pathname(output_dir, port,
-                    element_type_index, frequency_hz);
-            oskar_element_write(element, log, output.c_str(), port,
-                    frequency_hz, &e);
+            if (port == 0)
+            {
+                string output = construct_element_pathname(output_dir, 1,
+                        element_type_index, frequency_hz[i]);
+                oskar_element_write(element, log, output.c_str(), 1,
+                        frequency_hz[i], &e);
+                output = construct_element_pathname(output_dir, 2,
+                        element_type_index, frequency_hz[i]);
+                oskar_element_write(element, log, output.c_str(), 2,
+                        frequency_hz[i], &e);
+            }
+            else
+            {
+                string output = construct_element_pathname(output_dir, port,
+                        element_type_index, frequency_hz[i]);
+                oskar_element_write(element, log, output.c_str(), port,
+                        frequency_hz[i], &e);
+            }
         }
     }
 
-    // Load the scalar text file, if specified.
-    if (!input_scalar_file.empty())
+    // Load the scalar text files, if specified.
+    if (num_scalar_files > 0)
     {
-        oskar_log_message(log, 'M', 0, "Loading scalar element pattern: %s",
-                input_scalar_file.c_str());
-        oskar_element_load_scalar(element, log, frequency_hz,
-                input_scalar_file.c_str(), average_fractional_error,
+        for (int i = 0; i < num_scalar_files; ++i)
+            oskar_log_message(log, 'M', 0,
+                    "Loading scalar element pattern: %s",
+                    input_scalar_files[i]);
+        oskar_element_load_scalar_files(element, log, num_scalar_files,
+                frequency_hz, input_scalar_files, average_fractional_error,
                 average_fractional_error_factor_increase,
                 ignore_at_pole, ignore_below_horizon, &e);
 
-        // Construct the output file name based on the settings.
-        string output = construct_element_pathname(output_dir, 0,
-                element_type_index, frequency_hz);
-        oskar_element_write(element, log, output.c_str(), 0,
-                frequency_hz, &e);
+        // Construct the output file names based on the settings.
+        for (int i = 0; i < num_scalar_files; ++i)
+        {
+            string output = construct_element_pathname(output_dir, 0,
+                    element_type_index, frequency_hz[i]);
+            oskar_element_write(element, log, output.c_str(), 0,
+                    frequency_hz[i], &e);
+        }
     }
 
     // Check for errors.
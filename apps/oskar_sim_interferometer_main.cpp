@@ -40,8 +40,10 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <string>
 
 using namespace oskar;
+using std::string;
 
 static const char app[] = "oskar_sim_interferometer";
 
@@ -50,9 +52,29 @@ int main(int argc, char** argv)
     OptionParser opt(app, oskar_version_string(), oskar_app_settings(app));
     opt.add_settings_options();
     opt.add_flag("-q", "Suppress printing.", false, "--quiet");
+    opt.add_flag("--shard", "Simulate only shard i of N, given as i/N "
+            "(i counts from 0).", 1);
+    opt.add_flag("--shard-mode", "Split shards by 'time' blocks or "
+            "'channel'.", 1, "time");
+    opt.add_example("oskar_sim_interferometer --shard 0/4 settings.ini");
     if (!opt.check_options(argc, argv)) return EXIT_FAILURE;
     const char* settings = opt.get_arg(0);
-    int status = 0;
+    int status = 0, shard_index = 0, num_shards = 1;
+    string shard_mode;
+    opt.get("--shard-mode")->getString(shard_mode);
+    if (opt.is_set("--shard"))
+    {
+        string shard;
+        opt.get("--shard")->getString(shard);
+        if (sscanf(shard.c_str(), "%d/%d", &shard_index, &num_shards) != 2 ||
+                num_shards < 1 || shard_index < 0 ||
+                shard_index >= num_shards)
+        {
+            opt.error("Invalid shard '%s': expected i/N with 0 <= i < N.",
+                    shard.c_str());
+            return EXIT_FAILURE;
+        }
+    }
 
     // Create the log if necessary.
     oskar_Log* log = 0;
@@ -113,6 +135,14 @@ int main(int argc, char** argv)
     if (sky && tel)
     {
         sim = oskar_settings_to_interferometer(s, log, &status);
+        if (num_shards > 1)
+        {
+            oskar_interferometer_set_shard(sim, shard_index, num_shards,
+                    shard_mode.c_str(), &status);
+            oskar_log_message(log, 'M', 0, "Simulating shard %d of %d "
+                    "(split by %s)", shard_index, num_shards,
+                    shard_mode.c_str());
+        }
         oskar_interferometer_set_sky_model(sim, sky, &status);
         oskar_interferometer_set_telescope_model(sim, tel, &status);
         if (oskar_sky_num_sources(sky) < 32 &&
@@ -0,0 +1,362 @@
+/*
+ * Copyright (c) 2017, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "apps/oskar_option_parser.h"
+#include "binary/oskar_binary.h"
+#include "log/oskar_log.h"
+#include "mem/oskar_binary_read_mem.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_version_string.h"
+#include "vis/oskar_vis_header.h"
+#include "vis/oskar_vis_block.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+struct Shard
+{
+    string path;
+    oskar_Binary* h;
+    oskar_VisHeader* hdr;
+    oskar_VisBlock* blk;
+    int start_time, start_chan, num_blocks;
+};
+
+static bool shard_less(const Shard& a, const Shard& b)
+{
+    if (a.start_time != b.start_time) return a.start_time < b.start_time;
+    return a.start_chan < b.start_chan;
+}
+
+static bool is_compatible(const oskar_VisHeader* a, const oskar_VisHeader* b)
+{
+    if (oskar_vis_header_amp_type(a) != oskar_vis_header_amp_type(b) ||
+            oskar_vis_header_coord_precision(a) !=
+                    oskar_vis_header_coord_precision(b) ||
+            oskar_vis_header_num_stations(a) !=
+                    oskar_vis_header_num_stations(b) ||
+            oskar_vis_header_write_auto_correlations(a) !=
+                    oskar_vis_header_write_auto_correlations(b) ||
+            oskar_vis_header_write_cross_correlations(a) !=
+                    oskar_vis_header_write_cross_correlations(b) ||
+            oskar_vis_header_max_times_per_block(a) !=
+                    oskar_vis_header_max_times_per_block(b) ||
+            oskar_vis_header_num_channels_total(a) !=
+                    oskar_vis_header_num_channels_total(b))
+        return false;
+    if (oskar_vis_header_freq_start_hz(a) != oskar_vis_header_freq_start_hz(b)
+            || oskar_vis_header_freq_inc_hz(a) !=
+                    oskar_vis_header_freq_inc_hz(b)
+            || oskar_vis_header_time_start_mjd_utc(a) !=
+                    oskar_vis_header_time_start_mjd_utc(b)
+            || oskar_vis_header_time_inc_sec(a) !=
+                    oskar_vis_header_time_inc_sec(b)
+            || oskar_vis_header_phase_centre_ra_deg(a) !=
+                    oskar_vis_header_phase_centre_ra_deg(b)
+            || oskar_vis_header_phase_centre_dec_deg(a) !=
+                    oskar_vis_header_phase_centre_dec_deg(b))
+        return false;
+    return true;
+}
+
+static void write_block(const oskar_VisBlock* blk, const oskar_VisHeader* hdr,
+        oskar_Binary* vis, oskar_MeasurementSet* ms, int block_index,
+        int* status)
+{
+    if (vis) oskar_vis_block_write(blk, vis, block_index, status);
+#ifndef OSKAR_NO_MS
+    if (ms) oskar_vis_block_write_ms(blk, hdr, ms, status);
+#else
+    (void) hdr;
+    (void) ms;
+#endif
+}
+
+int main(int argc, char** argv)
+{
+    int status = 0;
+
+    oskar::OptionParser opt("oskar_vis_merge", oskar_version_string());
+    opt.set_description("Merges OSKAR visibility files written by sharded "
+            "runs of oskar_sim_interferometer into a single visibility file "
+            "and/or Measurement Set. Shards may be split either by time "
+            "or by channel, and may be given in any order.");
+    opt.add_required("OSKAR visibility files...");
+    opt.add_flag("-o", "Output OSKAR visibility file name", 1, "",
+            false, "--output");
+    opt.add_flag("-m", "Output Measurement Set name", 1, "", false, "--ms");
+    opt.add_flag("-p", "Force polarised MS format", false, "--force_polarised");
+    opt.add_flag("-q", "Suppress printing.", false, "--quiet");
+    opt.add_example("oskar_vis_merge -o merged.vis out_shard_*.vis");
+    opt.add_example("oskar_vis_merge -m merged.ms out_shard_*.vis");
+    if (!opt.check_options(argc, argv)) return EXIT_FAILURE;
+
+    // Get the options.
+    string out_vis, out_ms;
+    opt.get("-o")->getString(out_vis);
+    opt.get("-m")->getString(out_ms);
+    vector<string> in_files = opt.get_input_files(1);
+    bool verbose = opt.is_set("-q") ? false : true;
+    bool force_polarised = opt.is_set("-p") ? true : false;
+    int num_shards = (int) in_files.size();
+    if (out_vis.empty() && out_ms.empty())
+    {
+        opt.error("No output file specified.");
+        return EXIT_FAILURE;
+    }
+#ifdef OSKAR_NO_MS
+    if (!out_ms.empty())
+    {
+        oskar_log_error(0, "OSKAR was compiled without Measurement Set "
+                "support.");
+        return EXIT_FAILURE;
+    }
+#endif
+
+    // Open all the shards and read their headers.
+    vector<Shard> shards(num_shards);
+    for (int i = 0; i < num_shards; ++i)
+    {
+        int dims[6];
+        Shard& s = shards[i];
+        s.path = in_files[i];
+        s.h = oskar_binary_create(s.path.c_str(), 'r', &status);
+        s.hdr = oskar_vis_header_read(s.h, &status);
+        oskar_binary_read(s.h, OSKAR_INT, OSKAR_TAG_GROUP_VIS_BLOCK,
+                OSKAR_VIS_BLOCK_TAG_DIM_START_AND_SIZE, 0,
+                sizeof(dims), dims, &status);
+        if (status)
+        {
+            oskar_log_error(0, "Failed to read '%s': %s", s.path.c_str(),
+                    oskar_get_error_string(status));
+            return status;
+        }
+        s.start_time = dims[0];
+        s.start_chan = dims[1];
+        s.num_blocks = (oskar_vis_header_num_times_total(s.hdr) +
+                oskar_vis_header_max_times_per_block(s.hdr) - 1) /
+                oskar_vis_header_max_times_per_block(s.hdr);
+        s.blk = oskar_vis_block_create_from_header(OSKAR_CPU, s.hdr, &status);
+    }
+
+    // Sort shards by their position in the observation, so that the
+    // output does not depend on the order of the input files.
+    sort(shards.begin(), shards.end(), shard_less);
+
+    // Work out whether the shards were split by time or by channel,
+    // and check that together they cover the whole observation.
+    const oskar_VisHeader* hdr0 = shards[0].hdr;
+    const int num_channels_total = oskar_vis_header_num_channels_total(hdr0);
+    bool by_channel = false;
+    for (int i = 0; i < num_shards; ++i)
+    {
+        if (!is_compatible(hdr0, shards[i].hdr))
+        {
+            oskar_log_error(0, "Shard '%s' does not match '%s'.",
+                    shards[i].path.c_str(), shards[0].path.c_str());
+            status = OSKAR_ERR_TYPE_MISMATCH;
+        }
+        if (oskar_vis_header_max_channels_per_block(shards[i].hdr) !=
+                num_channels_total)
+            by_channel = true;
+    }
+    int expected = 0;
+    for (int i = 0; i < num_shards && !status; ++i)
+    {
+        const Shard& s = shards[i];
+        if (by_channel)
+        {
+            if (s.start_chan != expected ||
+                    s.start_time != shards[0].start_time ||
+                    s.num_blocks != shards[0].num_blocks)
+                status = OSKAR_ERR_DIMENSION_MISMATCH;
+            expected += oskar_vis_header_max_channels_per_block(s.hdr);
+        }
+        else
+        {
+            if (s.start_time != expected)
+                status = OSKAR_ERR_DIMENSION_MISMATCH;
+            expected += oskar_vis_header_num_times_total(s.hdr);
+        }
+        if (status)
+            oskar_log_error(0, "Shard '%s' is not contiguous with the "
+                    "previous shard.", s.path.c_str());
+    }
+    if (!status && by_channel && expected != num_channels_total)
+    {
+        oskar_log_error(0, "Shards contain %d of %d channels.",
+                expected, num_channels_total);
+        status = OSKAR_ERR_DIMENSION_MISMATCH;
+    }
+
+    // Create the header for the merged data.
+    oskar_VisHeader* hdr = oskar_vis_header_create_copy(hdr0, &status);
+    if (by_channel)
+        oskar_vis_header_set_max_channels_per_block(hdr, num_channels_total);
+    else
+        oskar_vis_header_set_num_times_total(hdr, expected);
+    if (verbose && !status)
+    {
+        printf("Merging %d shards split by %s:\n", num_shards,
+                by_channel ? "channel" : "time");
+        for (int i = 0; i < num_shards; ++i)
+            printf("  [%02d] %s\n", i, shards[i].path.c_str());
+    }
+
+    // Open the output files.
+    oskar_Binary* vis = 0;
+    oskar_MeasurementSet* ms = 0;
+    if (!status && !out_vis.empty())
+        vis = oskar_vis_header_write(hdr, out_vis.c_str(), &status);
+#ifndef OSKAR_NO_MS
+    if (!status && !out_ms.empty())
+        ms = oskar_vis_header_write_ms(hdr, out_ms.c_str(), 1,
+                force_polarised, &status);
+#else
+    (void) force_polarised;
+#endif
+
+    // Stream the blocks to the output, one block at a time.
+    if (!by_channel)
+    {
+        int block_index = 0;
+        for (int i = 0; i < num_shards; ++i)
+        {
+            for (int b = 0; b < shards[i].num_blocks; ++b)
+            {
+                if (status) break;
+                oskar_vis_block_read(shards[i].blk, shards[i].hdr,
+                        shards[i].h, b, &status);
+                write_block(shards[i].blk, hdr, vis, ms, block_index++,
+                        &status);
+            }
+        }
+    }
+    else
+    {
+        oskar_VisBlock* blk = oskar_vis_block_create_from_header(OSKAR_CPU,
+                hdr, &status);
+        const int num_baselines = oskar_vis_block_num_baselines(blk);
+        const int num_stations = oskar_vis_block_num_stations(blk);
+        for (int b = 0; b < shards[0].num_blocks; ++b)
+        {
+            int num_times = 0;
+            for (int i = 0; i < num_shards; ++i)
+            {
+                if (status) break;
+                const oskar_VisBlock* in = shards[i].blk;
+                oskar_vis_block_read(shards[i].blk, shards[i].hdr,
+                        shards[i].h, b, &status);
+                const int c = oskar_vis_block_start_channel_index(in);
+                const int n = oskar_vis_block_num_channels(in);
+                num_times = oskar_vis_block_num_times(in);
+                for (int t = 0; t < num_times; ++t)
+                {
+                    if (oskar_vis_block_has_cross_correlations(in))
+                        oskar_mem_copy_contents(
+                                oskar_vis_block_cross_correlations(blk),
+                                oskar_vis_block_cross_correlations_const(in),
+                                num_baselines * (num_channels_total * t + c),
+                                num_baselines * n * t, num_baselines * n,
+                                &status);
+                    if (oskar_vis_block_has_auto_correlations(in))
+                        oskar_mem_copy_contents(
+                                oskar_vis_block_auto_correlations(blk),
+                                oskar_vis_block_auto_correlations_const(in),
+                                num_stations * (num_channels_total * t + c),
+                                num_stations * n * t, num_stations * n,
+                                &status);
+                }
+
+                // Baseline coordinates do not depend on channel.
+                if (i == 0)
+                {
+                    oskar_mem_copy(oskar_vis_block_baseline_uu_metres(blk),
+                            oskar_vis_block_baseline_uu_metres_const(in),
+                            &status);
+                    oskar_mem_copy(oskar_vis_block_baseline_vv_metres(blk),
+                            oskar_vis_block_baseline_vv_metres_const(in),
+                            &status);
+                    oskar_mem_copy(oskar_vis_block_baseline_ww_metres(blk),
+                            oskar_vis_block_baseline_ww_metres_const(in),
+                            &status);
+                    oskar_vis_block_set_start_time_index(blk,
+                            oskar_vis_block_start_time_index(in));
+                }
+            }
+            oskar_vis_block_set_num_times(blk, num_times, &status);
+            oskar_vis_block_set_num_channels(blk, num_channels_total, &status);
+            oskar_vis_block_set_start_channel_index(blk, 0);
+            write_block(blk, hdr, vis, ms, b, &status);
+        }
+        oskar_vis_block_free(blk, &status);
+    }
+
+    // Copy the run log from the first shard.
+    if (!status)
+    {
+        int tag_error = 0;
+        oskar_Mem* log = oskar_mem_create(OSKAR_CHAR, OSKAR_CPU, 0, &status);
+        oskar_binary_read_mem(shards[0].h, log,
+                OSKAR_TAG_GROUP_RUN, OSKAR_TAG_RUN_LOG, 0, &tag_error);
+        if (!tag_error && vis)
+            oskar_binary_write(vis, OSKAR_CHAR, OSKAR_TAG_GROUP_RUN,
+                    OSKAR_TAG_RUN_LOG, 0, oskar_mem_length(log),
+                    oskar_mem_char_const(log), &status);
+#ifndef OSKAR_NO_MS
+        if (!tag_error && ms)
+            oskar_ms_add_history(ms, "OSKAR_LOG",
+                    oskar_mem_char_const(log), oskar_mem_length(log));
+#endif
+        oskar_mem_free(log, &status);
+    }
+
+    // Clean up.
+    oskar_binary_free(vis);
+#ifndef OSKAR_NO_MS
+    oskar_ms_close(ms);
+#endif
+    for (int i = 0; i < num_shards; ++i)
+    {
+        oskar_binary_free(shards[i].h);
+        oskar_vis_header_free(shards[i].hdr, &status);
+        oskar_vis_block_free(shards[i].blk, &status);
+    }
+    oskar_vis_header_free(hdr, &status);
+    if (status)
+        oskar_log_error(0, "Merge failed: %s", oskar_get_error_string(status));
+    else if (verbose)
+        printf("Merged %d shards.\n", num_shards);
+    return status;
+}
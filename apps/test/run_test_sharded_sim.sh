@@ -0,0 +1,112 @@
+#!/bin/bash
+
+###############################################################################
+#
+# Description:
+#   Tests sharded interferometer simulations using local processes.
+#
+# Method:
+#   1. Generate an OSKAR visibility binary file using a single process.
+#   2. Generate the same observation using several shards split by time,
+#      running as independent processes, and merge them with oskar_vis_merge.
+#   3. Repeat step 2 with shards split by channel.
+#   4. Compare the merged visibilities with those from the single process.
+#
+#   The script exits with a non-zero status if any step fails, or if the
+#   merged visibilities differ from those of the single process.
+#
+###############################################################################
+
+set -e
+source @OSKAR_BINARY_DIR@/apps/test/test_utility.sh
+
+num_shards=3
+
+echo "Running OSKAR sharded simulation test"
+echo ""
+echo "  * Example data directory = $example_data_dir"
+echo ""
+
+# Move into the example data directory
+cd "${example_data_dir}"
+
+app_sim=${oskar_app_path}/oskar_sim_interferometer
+app_merge=${oskar_app_path}/oskar_vis_merge
+app_table=${oskar_app_path}/oskar_vis_to_ascii_table
+ini_sim=oskar_sim_interferometer.ini
+set_setting $app_sim $ini_sim sky/oskar_sky_model/file sky.osm
+set_setting $app_sim $ini_sim simulator/keep_log_file false
+set_setting $app_sim $ini_sim telescope/input_directory telescope.tm
+set_setting $app_sim $ini_sim interferometer/max_time_samples_per_block 5
+set_setting $app_sim $ini_sim interferometer/correlation_type Both
+set_setting $app_sim $ini_sim interferometer/oskar_vis_filename sharded.vis
+set_setting $app_sim $ini_sim interferometer/noise/enable true
+set_setting $app_sim $ini_sim interferometer/noise/freq "Observation settings"
+set_setting $app_sim $ini_sim interferometer/noise/rms "Range"
+set_setting $app_sim $ini_sim interferometer/noise/rms/start 5
+set_setting $app_sim $ini_sim interferometer/noise/rms/end 5
+num_channels=$(get_setting $app_sim $ini_sim observation/num_channels)
+
+# Shards are only written as OSKAR binary files, so a Measurement Set
+# would not be produced. Refuse to run rather than skip it silently.
+ms_name=$(get_setting $app_sim $ini_sim interferometer/ms_filename)
+if [ -n "$ms_name" ]; then
+    echo "ERROR: Measurement Set output ('$ms_name') is not written when"
+    echo "       sharding. Remove interferometer/ms_filename from $ini_sim,"
+    echo "       and convert the merged file using oskar_vis_to_ms instead."
+    exit 1
+fi
+
+# Writes the visibilities in a file as an ASCII table.
+function vis_table() {
+    for ((c=0; c<num_channels; c++)); do
+        $app_table -s -c "$c" -p 4 "$1"
+        $app_table -s -c "$c" -p 7 "$1"
+    done
+}
+
+num_failed=0
+echo "Starting single-process simulation"
+run_sim_interferometer -q $ini_sim
+mv sharded.vis single.vis
+vis_table single.vis > single.txt
+
+for mode in time channel; do
+    echo "Starting $num_shards shards split by $mode"
+    rm -f sharded_shard_*.vis
+    pids=()
+    for ((i=0; i<num_shards; i++)); do
+        run_sim_interferometer -q --shard "$i/$num_shards" \
+            --shard-mode "$mode" $ini_sim &
+        pids+=($!)
+    done
+    for pid in "${pids[@]}"; do
+        if ! wait "$pid"; then
+            echo "ERROR: A shard split by $mode failed."
+            exit 1
+        fi
+    done
+    $app_merge -q -o "merged_$mode.vis" sharded_shard_*.vis
+    vis_table "merged_$mode.vis" > "merged_$mode.txt"
+    if cmp -s single.txt "merged_$mode.txt"; then
+        echo "  + Merged $mode shards are identical to the single process."
+    else
+        echo "  + Merged $mode shards differ from the single process:"
+        echo "    Number of differing values:" \
+            "$(diff single.txt "merged_$mode.txt" | grep -c "^<" || true)"
+        num_failed=$((num_failed + 1))
+    fi
+done
+
+echo ""
+echo "-------------------------------------------------------------------------"
+echo "Run complete!"
+echo ""
+echo "Results can be found in the directory: "
+echo "  '$example_data_dir'"
+echo "-------------------------------------------------------------------------"
+echo ""
+if [ $num_failed -ne 0 ]; then
+    echo "ERROR: $num_failed merged result(s) differ from the single process."
+    exit 1
+fi
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017, The University of Oxford
+ * Copyright (c) 2017-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -75,6 +75,9 @@ oskar_Imager* oskar_settings_to_imager(oskar::SettingsTree* s,
             s->to_int("scale_norm_with_num_input_files", status));
     oskar_imager_set_ms_column(h,
             s->to_string("ms_column", status), status);
+    oskar_imager_set_cache_input_data(h,
+            s->to_int("cache_input_data", status));
+    oskar_imager_set_cache_file(h, s->to_string("cache_file", status));
     oskar_imager_set_output_root(h, s->to_string("root_path", status));
 
     // Set remaining imager options.
@@ -98,7 +101,8 @@ oskar_Imager* oskar_settings_to_imager(oskar::SettingsTree* s,
     oskar_imager_set_weighting(h,
             s->to_string("weighting", status), status);
     if (s->starts_with("algorithm", "FFT", status) ||
-            s->starts_with("algorithm", "fft", status))
+            s->starts_with("algorithm", "fft", status) ||
+            s->starts_with("algorithm", "W-s", status))
     {
         oskar_imager_set_grid_kernel(h,
                 s->to_string("fft/kernel_type", status),
@@ -111,6 +115,8 @@ oskar_Imager* oskar_settings_to_imager(oskar::SettingsTree* s,
     oskar_imager_set_fft_on_gpu(h, s->to_int("fft/use_gpu", status));
     oskar_imager_set_generate_w_kernels_on_gpu(h,
             s->to_int("wproj/generate_w_kernels_on_gpu", status));
+    oskar_imager_set_w_kernel_dir(h,
+            s->to_string("wproj/w_kernel_dir", status));
     if (s->first_letter("direction", status) == 'R')
         oskar_imager_set_direction(h,
                 s->to_double("direction/ra_deg", status),
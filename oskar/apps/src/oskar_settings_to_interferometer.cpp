@@ -108,6 +108,12 @@ oskar_Interferometer* oskar_settings_to_interferometer(oskar::SettingsTree* s,
             s->to_string("ms_filename", status));
     oskar_interferometer_set_force_polarised_ms(h,
             s->to_int("force_polarised_ms", status));
+    oskar_interferometer_set_progress_file(h,
+            s->to_string("progress_filename", status));
+    oskar_interferometer_set_progress_interval(h,
+            s->to_double("progress_interval_sec", status));
+    oskar_interferometer_set_trace_file(h,
+            s->to_string("trace_filename", status));
     s->end_group();
 
     // Return handle to interferometer simulator.
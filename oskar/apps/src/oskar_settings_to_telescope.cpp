@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2017, The University of Oxford
+ * Copyright (c) 2011-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -36,6 +36,7 @@
 #include <limits.h>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
 using oskar::SettingsTree;
 
@@ -69,6 +70,8 @@ oskar_Telescope* oskar_settings_to_telescope(SettingsTree* s,
     oskar_telescope_set_enable_numerical_patterns(t,
             s->to_int("telescope/aperture_array/element_pattern/"
                     "enable_numerical", status));
+    oskar_telescope_set_enable_model_cache(t,
+            s->to_int("telescope/enable_model_cache", status));
 
     /************************************************************************/
     /* Load telescope model folders to define the stations. */
@@ -150,6 +153,24 @@ oskar_Telescope* oskar_settings_to_telescope(SettingsTree* s,
     for (int i = 0; i < num_stations; ++i)
         set_station_data(oskar_telescope_station(t, i), s, status);
 
+    /* Sample numerical element patterns onto look-up tables if required. */
+    s->clear_group();
+    s->begin_group("telescope/aperture_array/element_pattern");
+    if (s->to_int("enable_numerical", status))
+    {
+        int interp = OSKAR_ELEMENT_TABLE_NONE;
+        const char* t_interp = s->to_string("lookup_table/interpolation",
+                status);
+        if (!strncmp(t_interp, "BIL", 3) || !strncmp(t_interp, "Bil", 3))
+            interp = OSKAR_ELEMENT_TABLE_BILINEAR;
+        else if (!strncmp(t_interp, "BIC", 3) || !strncmp(t_interp, "Bic", 3))
+            interp = OSKAR_ELEMENT_TABLE_BICUBIC;
+        if (interp != OSKAR_ELEMENT_TABLE_NONE)
+            oskar_telescope_tabulate_element_patterns(t, interp,
+                    s->to_double("lookup_table/resolution_deg", status) * D2R,
+                    log, status);
+    }
+
     /* Apply element level overrides. */
     s->clear_group();
     s->begin_group("telescope/aperture_array/array_pattern/element");
@@ -248,10 +269,20 @@ void set_station_data(oskar_Station* station, SettingsTree* s, int* status)
             s->to_int("enable", status));
     oskar_station_set_normalise_array_pattern(station,
             s->to_int("normalise", status));
+    if (s->first_letter("method", status) == 'N')
+        oskar_station_set_nufft_tolerance(station,
+                s->to_double("nufft_tolerance", status));
     oskar_station_set_seed_time_variable_errors(station,
             (unsigned int) s->to_int(
                     "element/seed_time_variable_errors", status));
 
+    /* Set options for the station beam look-up table. */
+    s->clear_group();
+    s->begin_group("telescope/aperture_array/beam_lookup_table");
+    if (s->to_int("enable", status))
+        oskar_station_set_beam_lut_oversample(station,
+                s->to_double("samples_per_beamwidth", status));
+
     /* Set element pattern data for all element types. */
     s->clear_group();
     s->begin_group("telescope/aperture_array/element_pattern");
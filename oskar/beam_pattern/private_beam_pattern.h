@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -30,6 +30,7 @@
 #include <telescope/oskar_telescope.h>
 #include <utility/oskar_timer.h>
 #include <utility/oskar_thread.h>
+#include <utility/oskar_thread_pool.h>
 
 #include <fitsio.h>
 #include <stdio.h>
@@ -105,6 +106,7 @@ struct oskar_BeamPattern
     /* State. */
     oskar_Mutex* mutex;
     oskar_Barrier* barrier;
+    oskar_ThreadPool* pool;
     int i_global, status;
 
     /* Input data. */
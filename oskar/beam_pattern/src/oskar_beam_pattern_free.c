@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -39,6 +39,7 @@ void oskar_beam_pattern_free(oskar_BeamPattern* h, int* status)
 {
     if (!h) return;
     oskar_beam_pattern_reset_cache(h, status);
+    oskar_thread_pool_free(h->pool);
     oskar_telescope_free(h->tel, status);
     oskar_timer_free(h->tmr_sim);
     oskar_timer_free(h->tmr_write);
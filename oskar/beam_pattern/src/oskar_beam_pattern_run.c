@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2017, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -89,7 +89,7 @@ typedef struct ThreadArgs ThreadArgs;
 void oskar_beam_pattern_run(oskar_BeamPattern* h, int* status)
 {
     int i, num_threads;
-    oskar_Thread** threads = 0;
+    oskar_Future** futures = 0;
     ThreadArgs* args = 0;
     if (*status || !h) return;
 
@@ -104,10 +104,16 @@ void oskar_beam_pattern_run(oskar_BeamPattern* h, int* status)
     /* Initialise if required. */
     oskar_beam_pattern_check_init(h, status);
 
-    /* Set up worker threads. */
+    /* Set up worker threads, re-using the thread pool if possible. */
     num_threads = h->num_devices + 1;
     oskar_barrier_set_num_threads(h->barrier, num_threads);
-    threads = (oskar_Thread**) calloc(num_threads, sizeof(oskar_Thread*));
+    if (oskar_thread_pool_num_threads(h->pool) != num_threads)
+    {
+        oskar_thread_pool_free(h->pool);
+        h->pool = oskar_thread_pool_create(num_threads, 0, status);
+    }
+    if (*status) return;
+    futures = (oskar_Future**) calloc(num_threads, sizeof(oskar_Future*));
     args = (ThreadArgs*) calloc(num_threads, sizeof(ThreadArgs));
     for (i = 0; i < num_threads; ++i)
     {
@@ -134,20 +140,17 @@ void oskar_beam_pattern_run(oskar_BeamPattern* h, int* status)
     oskar_timer_start(h->tmr_sim);
 
     /* Start the worker threads. */
-    for (i = 0; i < num_threads; ++i)
-        threads[i] = oskar_thread_create(run_blocks, (void*)&args[i], 0);
+    oskar_thread_pool_submit_all(h->pool, num_threads, run_blocks,
+            (void*)args, sizeof(ThreadArgs), futures, status);
 
     /* Wait for worker threads to finish. */
     for (i = 0; i < num_threads; ++i)
-    {
-        oskar_thread_join(threads[i]);
-        oskar_thread_free(threads[i]);
-    }
-    free(threads);
+        oskar_future_free(futures[i]);
+    free(futures);
     free(args);
 
     /* Get status code. */
-    *status = h->status;
+    if (!*status) *status = h->status;
 
     /* Record memory usage. */
     if (h->log && !*status)
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -47,6 +47,10 @@ extern "C" {
  * @details
  * Simple gridding function for 1D real convolution kernel.
  *
+ * If more than one thread is available, visibilities are bucketed into
+ * grid tiles and each tile is gridded by one thread into a private
+ * sub-grid, which is then added to the main grid.
+ *
  * @param[in] support       GCF support size (typ. 3; width = 2 * support + 1).
  * @param[in] oversample    GCF oversample factor, or values per grid cell.
  * @param[in] conv_func     GCF array, length oversample * (support + 1).
@@ -84,6 +88,10 @@ void oskar_grid_simple_d(
  * @details
  * Simple gridding function for 1D real convolution kernel.
  *
+ * If more than one thread is available, visibilities are bucketed into
+ * grid tiles and each tile is gridded by one thread into a private
+ * sub-grid, which is then added to the main grid.
+ *
  * @param[in] support       GCF support size (typ. 3; width = 2 * support + 1).
  * @param[in] oversample    GCF oversample factor, or values per grid cell.
  * @param[in] conv_func     GCF array, length oversample * (support + 1).
@@ -114,6 +122,98 @@ void oskar_grid_simple_f(
         double* restrict norm,
         float* restrict grid);
 
+/**
+ * @brief
+ * Simple gridding function for sorted data (double precision).
+ *
+ * @details
+ * Same as oskar_grid_simple_d(), but for visibilities that have already been
+ * sorted by grid tile, so that the tiled gridder can use the given tile
+ * boundaries instead of finding them again.
+ *
+ * Tiles must have the side length given by oskar_grid_tiles_size()
+ * for the largest kernel support, and be numbered in row-major order.
+ * Visibilities that fall outside the grid must come after the last tile.
+ * If \p tile_start is NULL, this is the same as calling oskar_grid_simple_d().
+ *
+ * @param[in] support       GCF support size (typ. 3; width = 2 * support + 1).
+ * @param[in] oversample    GCF oversample factor, or values per grid cell.
+ * @param[in] conv_func     GCF array, length oversample * (support + 1).
+ * @param[in] num_points    Number of visibility points.
+ * @param[in] tile_start    Start of each tile in input (length num_tiles + 1).
+ * @param[in] uu            Visibility baseline uu coordinates, in wavelengths.
+ * @param[in] vv            Visibility baseline vv coordinates, in wavelengths.
+ * @param[in] vis           Complex visibilities for each baseline.
+ * @param[in] weight        Visibility weight for each baseline.
+ * @param[in] cell_size_rad Cell size, in radians.
+ * @param[in] grid_size     Side length of image and grid.
+ * @param[out] num_skipped  Number of visibilities that fell outside the grid.
+ * @param[in,out] norm      Updated grid normalisation factor.
+ * @param[in,out] grid      Updated complex visibility grid.
+ */
+OSKAR_EXPORT
+void oskar_grid_simple_sorted_d(
+        const int support,
+        const int oversample,
+        const double* restrict conv_func,
+        const size_t num_points,
+        const size_t* restrict tile_start,
+        const double* restrict uu,
+        const double* restrict vv,
+        const double* restrict vis,
+        const double* restrict weight,
+        const double cell_size_rad,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        double* restrict grid);
+
+/**
+ * @brief
+ * Simple gridding function for sorted data (single precision).
+ *
+ * @details
+ * Same as oskar_grid_simple_f(), but for visibilities that have already been
+ * sorted by grid tile, so that the tiled gridder can use the given tile
+ * boundaries instead of finding them again.
+ *
+ * Tiles must have the side length given by oskar_grid_tiles_size()
+ * for the largest kernel support, and be numbered in row-major order.
+ * Visibilities that fall outside the grid must come after the last tile.
+ * If \p tile_start is NULL, this is the same as calling oskar_grid_simple_f().
+ *
+ * @param[in] support       GCF support size (typ. 3; width = 2 * support + 1).
+ * @param[in] oversample    GCF oversample factor, or values per grid cell.
+ * @param[in] conv_func     GCF array, length oversample * (support + 1).
+ * @param[in] num_points    Number of visibility points.
+ * @param[in] tile_start    Start of each tile in input (length num_tiles + 1).
+ * @param[in] uu            Visibility baseline uu coordinates, in wavelengths.
+ * @param[in] vv            Visibility baseline vv coordinates, in wavelengths.
+ * @param[in] vis           Complex visibilities for each baseline.
+ * @param[in] weight        Visibility weight for each baseline.
+ * @param[in] cell_size_rad Cell size, in radians.
+ * @param[in] grid_size     Side length of image and grid.
+ * @param[out] num_skipped  Number of visibilities that fell outside the grid.
+ * @param[in,out] norm      Updated grid normalisation factor.
+ * @param[in,out] grid      Updated complex visibility grid.
+ */
+OSKAR_EXPORT
+void oskar_grid_simple_sorted_f(
+        const int support,
+        const int oversample,
+        const float* restrict conv_func,
+        const size_t num_points,
+        const size_t* restrict tile_start,
+        const float* restrict uu,
+        const float* restrict vv,
+        const float* restrict vis,
+        const float* restrict weight,
+        const float cell_size_rad,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        float* restrict grid);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_GRID_SIMPLE_MULTI_H_
+#define OSKAR_GRID_SIMPLE_MULTI_H_
+
+/**
+ * @file oskar_grid_simple_multi.h
+ */
+
+#include <oskar_global.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Simple gridding function for several planes at once (double precision).
+ *
+ * @details
+ * Grids visibilities for several image planes (typically polarisations)
+ * that share the same baseline coordinates, using a 1D real convolution
+ * kernel.
+ *
+ * The grid position and kernel offsets of each visibility are found only
+ * once, and the kernel values are applied to all the planes together.
+ * The result is the same as calling oskar_grid_simple_d() once per plane.
+ *
+ * @param[in] support       GCF support size (typ. 3; width = 2 * support + 1).
+ * @param[in] oversample    GCF oversample factor, or values per grid cell.
+ * @param[in] conv_func     GCF array, length oversample * (support + 1).
+ * @param[in] num_planes    Number of planes to grid.
+ * @param[in] num_points    Number of visibility points.
+ * @param[in] uu            Visibility baseline uu coordinates, in wavelengths.
+ * @param[in] vv            Visibility baseline vv coordinates, in wavelengths.
+ * @param[in] vis           Complex visibilities for each plane.
+ * @param[in] weight        Visibility weights for each plane.
+ * @param[in] cell_size_rad Cell size, in radians.
+ * @param[in] grid_size     Side length of image and grid.
+ * @param[out] num_skipped  Number of visibilities that fell outside the grid.
+ * @param[in,out] norm      Updated grid normalisation factor for each plane.
+ * @param[in,out] grid      Updated complex visibility grid for each plane.
+ */
+OSKAR_EXPORT
+void oskar_grid_simple_multi_d(
+        const int support,
+        const int oversample,
+        const double* restrict conv_func,
+        const int num_planes,
+        const size_t num_points,
+        const double* restrict uu,
+        const double* restrict vv,
+        const double* const* vis,
+        const double* const* weight,
+        const double cell_size_rad,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        double* const* grid);
+
+/**
+ * @brief
+ * Simple gridding function for several planes at once (single precision).
+ *
+ * @details
+ * Grids visibilities for several image planes (typically polarisations)
+ * that share the same baseline coordinates, using a 1D real convolution
+ * kernel.
+ *
+ * The grid position and kernel offsets of each visibility are found only
+ * once, and the kernel values are applied to all the planes together.
+ * The result is the same as calling oskar_grid_simple_f() once per plane.
+ *
+ * @param[in] support       GCF support size (typ. 3; width = 2 * support + 1).
+ * @param[in] oversample    GCF oversample factor, or values per grid cell.
+ * @param[in] conv_func     GCF array, length oversample * (support + 1).
+ * @param[in] num_planes    Number of planes to grid.
+ * @param[in] num_points    Number of visibility points.
+ * @param[in] uu            Visibility baseline uu coordinates, in wavelengths.
+ * @param[in] vv            Visibility baseline vv coordinates, in wavelengths.
+ * @param[in] vis           Complex visibilities for each plane.
+ * @param[in] weight        Visibility weights for each plane.
+ * @param[in] cell_size_rad Cell size, in radians.
+ * @param[in] grid_size     Side length of image and grid.
+ * @param[out] num_skipped  Number of visibilities that fell outside the grid.
+ * @param[in,out] norm      Updated grid normalisation factor for each plane.
+ * @param[in,out] grid      Updated complex visibility grid for each plane.
+ */
+OSKAR_EXPORT
+void oskar_grid_simple_multi_f(
+        const int support,
+        const int oversample,
+        const float* restrict conv_func,
+        const int num_planes,
+        const size_t num_points,
+        const float* restrict uu,
+        const float* restrict vv,
+        const float* const* vis,
+        const float* const* weight,
+        const float cell_size_rad,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        float* const* grid);
+
+/**
+ * @brief
+ * Simple multi-plane gridding function for sorted data (double precision).
+ *
+ * @details
+ * Same as oskar_grid_simple_multi_d(), but for visibilities that have
+ * already been sorted by grid tile, so that the tiled gridder can use the
+ * given tile boundaries instead of finding them again.
+ *
+ * Tiles must have the side length given by oskar_grid_tiles_size()
+ * for the largest kernel support, and be numbered in row-major order.
+ * Visibilities that fall outside the grid must come after the last tile.
+ * If \p tile_start is NULL, this is the same as calling
+ * oskar_grid_simple_multi_d().
+ *
+ * @param[in] support       GCF support size (typ. 3; width = 2 * support + 1).
+ * @param[in] oversample    GCF oversample factor, or values per grid cell.
+ * @param[in] conv_func     GCF array, length oversample * (support + 1).
+ * @param[in] num_planes    Number of planes to grid.
+ * @param[in] num_points    Number of visibility points.
+ * @param[in] tile_start    Start of each tile in input (length num_tiles + 1).
+ * @param[in] uu            Visibility baseline uu coordinates, in wavelengths.
+ * @param[in] vv            Visibility baseline vv coordinates, in wavelengths.
+ * @param[in] vis           Complex visibilities for each plane.
+ * @param[in] weight        Visibility weights for each plane.
+ * @param[in] cell_size_rad Cell size, in radians.
+ * @param[in] grid_size     Side length of image and grid.
+ * @param[out] num_skipped  Number of visibilities that fell outside the grid.
+ * @param[in,out] norm      Updated grid normalisation factor for each plane.
+ * @param[in,out] grid      Updated complex visibility grid for each plane.
+ */
+OSKAR_EXPORT
+void oskar_grid_simple_multi_sorted_d(
+        const int support,
+        const int oversample,
+        const double* restrict conv_func,
+        const int num_planes,
+        const size_t num_points,
+        const size_t* restrict tile_start,
+        const double* restrict uu,
+        const double* restrict vv,
+        const double* const* vis,
+        const double* const* weight,
+        const double cell_size_rad,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        double* const* grid);
+
+/**
+ * @brief
+ * Simple multi-plane gridding function for sorted data (single precision).
+ *
+ * @details
+ * Same as oskar_grid_simple_multi_f(), but for visibilities that have
+ * already been sorted by grid tile, so that the tiled gridder can use the
+ * given tile boundaries instead of finding them again.
+ *
+ * Tiles must have the side length given by oskar_grid_tiles_size()
+ * for the largest kernel support, and be numbered in row-major order.
+ * Visibilities that fall outside the grid must come after the last tile.
+ * If \p tile_start is NULL, this is the same as calling
+ * oskar_grid_simple_multi_f().
+ *
+ * @param[in] support       GCF support size (typ. 3; width = 2 * support + 1).
+ * @param[in] oversample    GCF oversample factor, or values per grid cell.
+ * @param[in] conv_func     GCF array, length oversample * (support + 1).
+ * @param[in] num_planes    Number of planes to grid.
+ * @param[in] num_points    Number of visibility points.
+ * @param[in] tile_start    Start of each tile in input (length num_tiles + 1).
+ * @param[in] uu            Visibility baseline uu coordinates, in wavelengths.
+ * @param[in] vv            Visibility baseline vv coordinates, in wavelengths.
+ * @param[in] vis           Complex visibilities for each plane.
+ * @param[in] weight        Visibility weights for each plane.
+ * @param[in] cell_size_rad Cell size, in radians.
+ * @param[in] grid_size     Side length of image and grid.
+ * @param[out] num_skipped  Number of visibilities that fell outside the grid.
+ * @param[in,out] norm      Updated grid normalisation factor for each plane.
+ * @param[in,out] grid      Updated complex visibility grid for each plane.
+ */
+OSKAR_EXPORT
+void oskar_grid_simple_multi_sorted_f(
+        const int support,
+        const int oversample,
+        const float* restrict conv_func,
+        const int num_planes,
+        const size_t num_points,
+        const size_t* restrict tile_start,
+        const float* restrict uu,
+        const float* restrict vv,
+        const float* const* vis,
+        const float* const* weight,
+        const float cell_size_rad,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        float* const* grid);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_GRID_SIMPLE_MULTI_H_ */
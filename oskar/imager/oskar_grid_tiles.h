@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_GRID_TILES_H_
+#define OSKAR_GRID_TILES_H_
+
+/**
+ * @file oskar_grid_tiles.h
+ */
+
+#include <oskar_global.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Returns true if the tiled, multi-threaded gridders should be used.
+ *
+ * @details
+ * Returns true if more than one OpenMP thread is available and there are
+ * enough visibilities to make bucketing them worthwhile.
+ * Returns false if called from inside an OpenMP parallel region.
+ *
+ * @param[in] num_points Number of visibility points.
+ */
+int oskar_grid_tiles_enabled(size_t num_points);
+
+/**
+ * @brief
+ * Returns the side length of a grid tile for the given kernel support.
+ *
+ * @details
+ * Tiles are at least twice the kernel support, so that the padded
+ * sub-grids of tiles of the same colour in a 2x2 checkerboard never overlap
+ * and can be merged into the main grid concurrently without atomics.
+ *
+ * @param[in] max_support Maximum kernel support size (half-width).
+ */
+int oskar_grid_tiles_size(int max_support);
+
+/**
+ * @brief
+ * Finds the grid tile and W-plane of each visibility (double precision).
+ *
+ * @details
+ * Finds the grid tile containing the centre of each visibility, and
+ * optionally its W-projection plane, using the same coordinate conversion
+ * as the gridders. Visibilities whose kernel would lie outside the grid
+ * are given a tile index of -1.
+ *
+ * For gridders without W-projection, set \p num_w_planes to 1 and
+ * \p ww to NULL.
+ *
+ * @param[in] num_w_planes  Number of W-projection planes.
+ * @param[in] support       GCF support size per W-plane.
+ * @param[in] num_points    Number of visibility points.
+ * @param[in] uu            Visibility baseline uu coordinates, in wavelengths.
+ * @param[in] vv            Visibility baseline vv coordinates, in wavelengths.
+ * @param[in] ww            Visibility baseline ww coordinates, or NULL.
+ * @param[in] cell_size_rad Cell size, in radians.
+ * @param[in] w_scale       Scaling factor used to find W-plane index.
+ * @param[in] grid_size     Side length of grid.
+ * @param[in] tile_size     Side length of each tile.
+ * @param[out] tile_id      Tile index of each visibility, or -1 if skipped.
+ * @param[out] w_plane      If not NULL, W-plane index of each visibility.
+ *
+ * @return The number of visibilities that fell outside the grid.
+ */
+size_t oskar_grid_tiles_find_d(const size_t num_w_planes,
+        const int* restrict support, const size_t num_points,
+        const double* restrict uu, const double* restrict vv,
+        const double* restrict ww, const double cell_size_rad,
+        const double w_scale, const int grid_size, const int tile_size,
+        int* restrict tile_id, int* restrict w_plane);
+
+/**
+ * @brief
+ * Finds the grid tile and W-plane of each visibility (single precision).
+ *
+ * @details
+ * Finds the grid tile containing the centre of each visibility, and
+ * optionally its W-projection plane, using the same coordinate conversion
+ * as the gridders. Visibilities whose kernel would lie outside the grid
+ * are given a tile index of -1.
+ *
+ * For gridders without W-projection, set \p num_w_planes to 1 and
+ * \p ww to NULL.
+ *
+ * @param[in] num_w_planes  Number of W-projection planes.
+ * @param[in] support       GCF support size per W-plane.
+ * @param[in] num_points    Number of visibility points.
+ * @param[in] uu            Visibility baseline uu coordinates, in wavelengths.
+ * @param[in] vv            Visibility baseline vv coordinates, in wavelengths.
+ * @param[in] ww            Visibility baseline ww coordinates, or NULL.
+ * @param[in] cell_size_rad Cell size, in radians.
+ * @param[in] w_scale       Scaling factor used to find W-plane index.
+ * @param[in] grid_size     Side length of grid.
+ * @param[in] tile_size     Side length of each tile.
+ * @param[out] tile_id      Tile index of each visibility, or -1 if skipped.
+ * @param[out] w_plane      If not NULL, W-plane index of each visibility.
+ *
+ * @return The number of visibilities that fell outside the grid.
+ */
+size_t oskar_grid_tiles_find_f(const size_t num_w_planes,
+        const int* restrict support, const size_t num_points,
+        const float* restrict uu, const float* restrict vv,
+        const float* restrict ww, const float cell_size_rad,
+        const float w_scale, const int grid_size, const int tile_size,
+        int* restrict tile_id, int* restrict w_plane);
+
+/**
+ * @brief
+ * Buckets visibilities by grid tile.
+ *
+ * @details
+ * Performs a stable counting sort of visibility indices by tile index.
+ * On exit, the indices of the visibilities in tile t are
+ * sorted[tile_start[t]] to sorted[tile_start[t + 1] - 1], in their original
+ * order. Visibilities with a negative tile index are ignored.
+ *
+ * @param[in] num_points  Number of visibility points.
+ * @param[in] tile_id     Tile index of each visibility, or -1 to skip it.
+ * @param[in] num_tiles   Number of tiles.
+ * @param[out] tile_start Start of each tile in \p sorted (length num_tiles + 1).
+ * @param[out] sorted     Visibility indices sorted by tile.
+ */
+void oskar_grid_tiles_bucket(size_t num_points, const int* restrict tile_id,
+        int num_tiles, size_t* restrict tile_start, size_t* restrict sorted);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_GRID_TILES_H_ */
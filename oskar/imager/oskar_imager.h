@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -66,7 +66,8 @@ enum OSKAR_IMAGE_ALGORITHM
     OSKAR_ALGORITHM_DFT_2D,
     OSKAR_ALGORITHM_DFT_3D,
     OSKAR_ALGORITHM_WPROJ,
-    OSKAR_ALGORITHM_AWPROJ
+    OSKAR_ALGORITHM_AWPROJ,
+    OSKAR_ALGORITHM_WSTACK
 };
 
 enum OSKAR_IMAGE_WEIGHTING
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -52,6 +52,30 @@ extern "C" {
 OSKAR_EXPORT
 const char* oskar_imager_algorithm(const oskar_Imager* h);
 
+/**
+ * @brief
+ * Returns the path of the input data cache file.
+ *
+ * @details
+ * Returns the path of the file used to cache the input data, if set.
+ *
+ * @param[in] h  Handle to imager.
+ */
+OSKAR_EXPORT
+const char* oskar_imager_cache_file(const oskar_Imager* h);
+
+/**
+ * @brief
+ * Returns the flag specifying whether input data are read only once.
+ *
+ * @details
+ * Returns the flag specifying whether input data are read only once.
+ *
+ * @param[in] h  Handle to imager.
+ */
+OSKAR_EXPORT
+int oskar_imager_cache_input_data(const oskar_Imager* h);
+
 /**
  * @brief
  * Returns the image cell size.
@@ -295,6 +319,7 @@ int oskar_imager_scale_norm_with_num_input_files(const oskar_Imager* h);
  * The \p type string can be:
  * - "FFT" to use standard gridding followed by a FFT.
  * - "W-projection" to use W-projection gridding followed by a FFT.
+ * - "W-stacking" to grid into W-layers, each followed by a FFT.
  * - "DFT 2D" to use a 2D Direct Fourier Transform, without gridding.
  * - "DFT 3D" to use a 3D Direct Fourier Transform, without gridding.
  *
@@ -310,6 +335,44 @@ OSKAR_EXPORT
 void oskar_imager_set_algorithm(oskar_Imager* h, const char* type,
         int* status);
 
+/**
+ * @brief
+ * Sets the path of the input data cache file.
+ *
+ * @details
+ * Sets the path of the file used to cache the input data when
+ * oskar_imager_set_cache_input_data() is enabled.
+ * The file is deleted when it is no longer needed.
+ *
+ * If this is not set, an anonymous temporary file is used instead.
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in]     filename   Path of the cache file.
+ */
+OSKAR_EXPORT
+void oskar_imager_set_cache_file(oskar_Imager* h, const char* filename);
+
+/**
+ * @brief
+ * Sets the flag specifying whether input data are read only once.
+ *
+ * @details
+ * Uniform weighting, W-projection and W-stacking all need a first pass
+ * over the baseline coordinates before any visibilities can be gridded.
+ * By default, oskar_imager_run() reads the coordinates from the input
+ * files in the first pass and then reads the files again to get the
+ * visibility data.
+ *
+ * If this flag is set, the visibility data are read together with the
+ * coordinates in the first pass and written to a cache file,
+ * which is then used for the second pass instead of the input files.
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in]     value      If true, read input files only once.
+ */
+OSKAR_EXPORT
+void oskar_imager_set_cache_input_data(oskar_Imager* h, int value);
+
 /**
  * @brief
  * Sets the image cell size.
@@ -342,7 +405,7 @@ void oskar_imager_set_channel_snapshots(oskar_Imager* h, int value);
  * Sets the imager to ignore visibility data and only update weights grids.
  *
  * @details
- * Use this method with uniform weighting or W-projection.
+ * Use this method with uniform weighting, W-projection or W-stacking.
  * The grids of weights can only be used once they are fully populated,
  * so this method puts the imager into a mode where it only updates its
  * internal weights grids when calling oskar_imager_update().
@@ -758,7 +821,8 @@ void oskar_imager_set_vis_phase_centre(oskar_Imager* h,
  * Sets the number of W planes to use.
  *
  * @details
- * Sets the number of W planes, used only for W-projection.
+ * Sets the number of W planes, used only for W-projection,
+ * or the number of W-layers when using W-stacking.
  * A value of 0 or less means 'automatic'.
  *
  * @param[in,out] h            Handle to imager.
@@ -767,6 +831,24 @@ void oskar_imager_set_vis_phase_centre(oskar_Imager* h,
 OSKAR_EXPORT
 void oskar_imager_set_num_w_planes(oskar_Imager* h, int value);
 
+/**
+ * @brief
+ * Sets the directory used to cache W-projection kernels.
+ *
+ * @details
+ * Sets the directory used to cache W-projection kernels between runs.
+ * Kernels are stored in files named using a hash of the parameters
+ * used to generate them, and are loaded from there if they match,
+ * instead of being generated again.
+ *
+ * If this is not set, the kernels are not cached.
+ *
+ * @param[in,out] h            Handle to imager.
+ * @param[in] dir_path         Path of the kernel cache directory.
+ */
+OSKAR_EXPORT
+void oskar_imager_set_w_kernel_dir(oskar_Imager* h, const char* dir_path);
+
 /**
  * @brief
  * Sets the visibility weighting scheme to use.
@@ -844,6 +926,18 @@ double oskar_imager_uv_filter_max(const oskar_Imager* h);
 OSKAR_EXPORT
 double oskar_imager_uv_filter_min(const oskar_Imager* h);
 
+/**
+ * @brief
+ * Returns the directory used to cache W-projection kernels.
+ *
+ * @details
+ * Returns the directory used to cache W-projection kernels, if set.
+ *
+ * @param[in] h  Handle to imager.
+ */
+OSKAR_EXPORT
+const char* oskar_imager_w_kernel_dir(const oskar_Imager* h);
+
 /**
  * @brief
  * Returns the visibility weighting scheme.
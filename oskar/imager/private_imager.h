@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -26,16 +26,16 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
-#ifdef OSKAR_HAVE_CUDA
-#include <cufft.h>
-#endif
-
 #include <fitsio.h>
+#include <math/oskar_fft.h>
 #include <mem/oskar_mem.h>
 #include <log/oskar_log.h>
 #include <utility/oskar_thread.h>
+#include <utility/oskar_thread_pool.h>
 #include <utility/oskar_timer.h>
 
+#include <stdio.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -48,22 +48,27 @@ struct DeviceData
 };
 typedef struct DeviceData DeviceData;
 
+/* Bounded queue of data blocks between reader and gridder threads. */
+struct oskar_ImagerQueue;
+typedef struct oskar_ImagerQueue oskar_ImagerQueue;
+
 struct oskar_Imager
 {
     char* output_name[4];
     fitsfile* fits_file[4];
     oskar_Log* log;
     oskar_Timer *tmr_grid_update, *tmr_grid_finalise, *tmr_init;
-    oskar_Timer *tmr_read, *tmr_write;
+    oskar_Timer *tmr_read, *tmr_sort, *tmr_write;
 
     /* Settings parameters. */
     int imager_prec, num_devices, num_gpus, *gpu_ids, fft_on_gpu;
     int chan_snaps, im_type, num_im_channels, num_im_pols, pol_offset;
     int algorithm, image_size, use_stokes, support, oversample;
     int generate_w_kernels_on_gpu, set_cellsize, set_fov, weighting;
-    int num_files, scale_norm_with_num_input_files;
+    int num_files, scale_norm_with_num_input_files, cache_input_data;
     char direction_type, kernel_type;
-    char **input_files, *input_root, *output_root, *ms_column;
+    char **input_files, *input_root, *output_root, *ms_column, *cache_file;
+    char *w_kernel_dir;
     double cellsize_rad, fov_deg, image_padding, im_centre_deg[2];
     double uv_filter_min, uv_filter_max;
     double time_min_utc, time_max_utc, freq_min_hz, freq_max_hz;
@@ -76,10 +81,18 @@ struct oskar_Imager
     /* State. */
     int status, i_block;
     oskar_Mutex* mutex;
+    oskar_ThreadPool* pool;
+    FILE* cache; /* Spill file of input data, for a single read. */
+    size_t cache_size; /* Bytes written to the cache file. */
+    oskar_ImagerQueue* queue;
 
     /* Scratch data. */
     oskar_Mem *uu_im, *vv_im, *ww_im, *vis_im, *weight_im, *time_im;
     oskar_Mem *uu_tmp, *vv_tmp, *ww_tmp, *stokes, *weight_tmp;
+    oskar_Mem *uu_sort, *vv_sort, *ww_sort, *vis_sort, *weight_sort;
+    size_t* tile_start; /* Start of each grid tile in the sorted data. */
+    int num_tiles; /* Number of tiles in tile_start, or 0 if not sorted. */
+    oskar_Mem *vis_pol[4], *weight_pol[4]; /* For multi-plane gridding. */
     int coords_only; /* Set if doing a first pass for uniform weighting. */
     int num_planes; /* For each output channel and polarisation. */
     double *plane_norm, delta_l, delta_m, delta_n, M[9];
@@ -90,10 +103,8 @@ struct oskar_Imager
 
     /* FFT imager data. */
     int grid_size;
-    oskar_Mem *conv_func, *corr_func, *fftpack_wsave, *fftpack_work;
-#ifdef OSKAR_HAVE_CUDA
-    cufftHandle cufft_plan;
-#endif
+    oskar_Mem *conv_func, *corr_func;
+    oskar_FFT* fft;
 
     /* W-projection imager data. */
     size_t ww_points;
@@ -101,6 +112,14 @@ struct oskar_Imager
     double w_scale, ww_min, ww_max, ww_rms;
     oskar_Mem *w_kernels, *w_support, *w_kernels_compact, *w_kernel_start;
 
+    /* W-stacking imager data. */
+    int num_w_layer_sets;
+    int w_layer_start, w_layer_end; /* Layers gridded in this pass. */
+    int w_layer_num_flushes, w_layer_num_ffts;
+    size_t w_layer_max_bytes; /* Limit on memory used by W-layers. */
+    double w_layer_spacing;
+    oskar_Mem **w_layer_planes, ***w_layers;
+
     /* Memory allocated per GPU (array of DeviceData structures). */
     DeviceData* d;
 };
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,8 +27,10 @@
  */
 
 #include "imager/oskar_grid_simple.h"
+#include "imager/oskar_grid_tiles.h"
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -175,6 +177,388 @@ static void oskar_grid_simple_default_f(
 }
 
 
+static double oskar_grid_simple_tile_d(
+        const int support,
+        const int oversample,
+        const double* restrict conv_func,
+        const size_t num_points,
+        const size_t* restrict indices,
+        const size_t first,
+        const double* restrict uu,
+        const double* restrict vv,
+        const double* restrict vis,
+        const double* restrict weight,
+        const double grid_scale,
+        const int offset_u,
+        const int offset_v,
+        const int sub_size,
+        double* restrict sub)
+{
+    size_t i;
+    double norm = 0.0;
+
+    /* Loop over visibilities in the tile. */
+    for (i = 0; i < num_points; ++i)
+    {
+        double sum = 0.0;
+        int j, k;
+        const size_t v = indices ? indices[i] : first + i;
+
+        /* Convert UV coordinates to sub-grid coordinates. */
+        const double pos_u = -uu[v] * grid_scale;
+        const double pos_v = vv[v] * grid_scale;
+        const int grid_u = (int)round(pos_u) + offset_u;
+        const int grid_v = (int)round(pos_v) + offset_v;
+
+        /* Get visibility data. */
+        const double weight_i = weight[v];
+        const double v_re = weight_i * vis[2 * v];
+        const double v_im = weight_i * vis[2 * v + 1];
+
+        /* Scaled distance from nearest grid point. */
+        const int off_u = (int)round((round(pos_u) - pos_u) * oversample);
+        const int off_v = (int)round((round(pos_v) - pos_v) * oversample);
+
+        /* Convolve this point onto the sub-grid. */
+        for (j = -support; j <= support; ++j)
+        {
+            size_t p1;
+            const double c1 = conv_func[abs(off_v + j * oversample)];
+            p1 = grid_v + j;
+            p1 *= sub_size;
+            p1 += grid_u;
+            for (k = -support; k <= support; ++k)
+            {
+                const size_t p = (p1 + k) << 1;
+                const double c = conv_func[abs(off_u + k * oversample)] * c1;
+                sub[p]     += v_re * c;
+                sub[p + 1] += v_im * c;
+                sum += c;
+            }
+        }
+        norm += sum * weight_i;
+    }
+    return norm;
+}
+
+
+static int oskar_grid_simple_tiled_d(
+        const int support,
+        const int oversample,
+        const double* restrict conv_func,
+        const size_t num_points,
+        const size_t* restrict tile_start,
+        const double* restrict uu,
+        const double* restrict vv,
+        const double* restrict vis,
+        const double* restrict weight,
+        const double cell_size_rad,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        double* restrict grid)
+{
+    int c, t, num_tiles, num_tiles_1d, tile_size, sub_size;
+    int* tile_id = 0;
+    size_t *bucket_start = 0, *sorted = 0;
+    const size_t* starts = tile_start;
+    double* tile_norm;
+    int failed = 0;
+    const int grid_centre = grid_size / 2;
+    const double grid_scale = grid_size * cell_size_rad;
+
+    /* Set up tiles for the kernel. */
+    tile_size = oskar_grid_tiles_size(support);
+    sub_size = tile_size + 2 * support;
+    num_tiles_1d = (grid_size + tile_size - 1) / tile_size;
+    num_tiles = num_tiles_1d * num_tiles_1d;
+    tile_norm = (double*) calloc(num_tiles, sizeof(double));
+    if (!tile_start)
+    {
+        tile_id = (int*) malloc(num_points * sizeof(int));
+        sorted = (size_t*) malloc(num_points * sizeof(size_t));
+        bucket_start = (size_t*) malloc((num_tiles + 1) * sizeof(size_t));
+        starts = bucket_start;
+    }
+    if (!tile_norm ||
+            (!tile_start && (!tile_id || !sorted || !bucket_start)))
+    {
+        free(tile_id);
+        free(sorted);
+        free(bucket_start);
+        free(tile_norm);
+        return 0;
+    }
+
+    /* Find the tile containing the centre of each visibility,
+     * unless the visibilities have already been sorted by tile. */
+    if (tile_start)
+        *num_skipped = num_points - tile_start[num_tiles];
+    else
+    {
+        *num_skipped = oskar_grid_tiles_find_d(1, &support, num_points,
+                uu, vv, 0, cell_size_rad, 0, grid_size, tile_size, tile_id, 0);
+        oskar_grid_tiles_bucket(num_points, tile_id, num_tiles,
+                bucket_start, sorted);
+    }
+
+    /* Grid each tile into a private padded sub-grid, then add it to the
+     * main grid. Tiles are processed in four passes, one for each colour
+     * of a 2x2 checkerboard, so that concurrent sub-grids never overlap. */
+#pragma omp parallel private(c, t)
+    {
+        const size_t sub_bytes = 2 * sub_size * sub_size * sizeof(double);
+        double* sub = (double*) malloc(sub_bytes);
+
+        /* Give up if any thread could not allocate its sub-grid. */
+        if (!sub)
+        {
+#pragma omp atomic
+            failed++;
+        }
+#pragma omp barrier
+        for (c = 0; c < 4 && !failed; ++c)
+        {
+#pragma omp for schedule(dynamic, 1)
+            for (t = 0; t < num_tiles; ++t)
+            {
+                int x, y, x0, y0, x1, y1;
+                const int tile_u = t % num_tiles_1d;
+                const int tile_v = t / num_tiles_1d;
+                const int origin_u = tile_u * tile_size - support;
+                const int origin_v = tile_v * tile_size - support;
+                const size_t start = starts[t];
+                const size_t count = starts[t + 1] - start;
+                if (count == 0 || (tile_u & 1) + 2 * (tile_v & 1) != c)
+                    continue;
+                memset(sub, 0, sub_bytes);
+                tile_norm[t] = oskar_grid_simple_tile_d(support, oversample,
+                        conv_func, count, sorted ? &sorted[start] : 0,
+                        start, uu, vv, vis, weight, grid_scale,
+                        grid_centre - origin_u, grid_centre - origin_v,
+                        sub_size, sub);
+
+                /* Add the sub-grid to the main grid. */
+                x0 = origin_u < 0 ? -origin_u : 0;
+                y0 = origin_v < 0 ? -origin_v : 0;
+                x1 = grid_size - origin_u < sub_size ?
+                        grid_size - origin_u : sub_size;
+                y1 = grid_size - origin_v < sub_size ?
+                        grid_size - origin_v : sub_size;
+                for (y = y0; y < y1; ++y)
+                {
+                    const double* restrict in = &sub[2 * y * sub_size];
+                    double* restrict out = &grid[2 * ((size_t)(origin_v + y) *
+                            grid_size + origin_u)];
+                    for (x = 2 * x0; x < 2 * x1; ++x) out[x] += in[x];
+                }
+            }
+        }
+        free(sub);
+    }
+
+    /* Sum the normalisation factors in tile order. */
+    if (!failed)
+        for (t = 0; t < num_tiles; ++t) *norm += tile_norm[t];
+    free(tile_id);
+    free(sorted);
+    free(bucket_start);
+    free(tile_norm);
+    return !failed;
+}
+
+
+static double oskar_grid_simple_tile_f(
+        const int support,
+        const int oversample,
+        const float* restrict conv_func,
+        const size_t num_points,
+        const size_t* restrict indices,
+        const size_t first,
+        const float* restrict uu,
+        const float* restrict vv,
+        const float* restrict vis,
+        const float* restrict weight,
+        const float grid_scale,
+        const int offset_u,
+        const int offset_v,
+        const int sub_size,
+        float* restrict sub)
+{
+    size_t i;
+    double norm = 0.0;
+
+    /* Loop over visibilities in the tile. */
+    for (i = 0; i < num_points; ++i)
+    {
+        double sum = 0.0;
+        int j, k;
+        const size_t v = indices ? indices[i] : first + i;
+
+        /* Convert UV coordinates to sub-grid coordinates. */
+        const float pos_u = -uu[v] * grid_scale;
+        const float pos_v = vv[v] * grid_scale;
+        const int grid_u = (int)roundf(pos_u) + offset_u;
+        const int grid_v = (int)roundf(pos_v) + offset_v;
+
+        /* Get visibility data. */
+        const float weight_i = weight[v];
+        const float v_re = weight_i * vis[2 * v];
+        const float v_im = weight_i * vis[2 * v + 1];
+
+        /* Scaled distance from nearest grid point. */
+        const int off_u = (int)roundf((roundf(pos_u) - pos_u) * oversample);
+        const int off_v = (int)roundf((roundf(pos_v) - pos_v) * oversample);
+
+        /* Convolve this point onto the sub-grid. */
+        for (j = -support; j <= support; ++j)
+        {
+            size_t p1;
+            const float c1 = conv_func[abs(off_v + j * oversample)];
+            p1 = grid_v + j;
+            p1 *= sub_size;
+            p1 += grid_u;
+            for (k = -support; k <= support; ++k)
+            {
+                const size_t p = (p1 + k) << 1;
+                const float c = conv_func[abs(off_u + k * oversample)] * c1;
+                sub[p]     += v_re * c;
+                sub[p + 1] += v_im * c;
+                sum += c;
+            }
+        }
+        norm += sum * weight_i;
+    }
+    return norm;
+}
+
+
+static int oskar_grid_simple_tiled_f(
+        const int support,
+        const int oversample,
+        const float* restrict conv_func,
+        const size_t num_points,
+        const size_t* restrict tile_start,
+        const float* restrict uu,
+        const float* restrict vv,
+        const float* restrict vis,
+        const float* restrict weight,
+        const float cell_size_rad,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        float* restrict grid)
+{
+    int c, t, num_tiles, num_tiles_1d, tile_size, sub_size;
+    int* tile_id = 0;
+    size_t *bucket_start = 0, *sorted = 0;
+    const size_t* starts = tile_start;
+    double* tile_norm;
+    int failed = 0;
+    const int grid_centre = grid_size / 2;
+    const float grid_scale = grid_size * cell_size_rad;
+
+    /* Set up tiles for the kernel. */
+    tile_size = oskar_grid_tiles_size(support);
+    sub_size = tile_size + 2 * support;
+    num_tiles_1d = (grid_size + tile_size - 1) / tile_size;
+    num_tiles = num_tiles_1d * num_tiles_1d;
+    tile_norm = (double*) calloc(num_tiles, sizeof(double));
+    if (!tile_start)
+    {
+        tile_id = (int*) malloc(num_points * sizeof(int));
+        sorted = (size_t*) malloc(num_points * sizeof(size_t));
+        bucket_start = (size_t*) malloc((num_tiles + 1) * sizeof(size_t));
+        starts = bucket_start;
+    }
+    if (!tile_norm ||
+            (!tile_start && (!tile_id || !sorted || !bucket_start)))
+    {
+        free(tile_id);
+        free(sorted);
+        free(bucket_start);
+        free(tile_norm);
+        return 0;
+    }
+
+    /* Find the tile containing the centre of each visibility,
+     * unless the visibilities have already been sorted by tile. */
+    if (tile_start)
+        *num_skipped = num_points - tile_start[num_tiles];
+    else
+    {
+        *num_skipped = oskar_grid_tiles_find_f(1, &support, num_points,
+                uu, vv, 0, cell_size_rad, 0, grid_size, tile_size, tile_id, 0);
+        oskar_grid_tiles_bucket(num_points, tile_id, num_tiles,
+                bucket_start, sorted);
+    }
+
+    /* Grid each tile into a private padded sub-grid, then add it to the
+     * main grid. Tiles are processed in four passes, one for each colour
+     * of a 2x2 checkerboard, so that concurrent sub-grids never overlap. */
+#pragma omp parallel private(c, t)
+    {
+        const size_t sub_bytes = 2 * sub_size * sub_size * sizeof(float);
+        float* sub = (float*) malloc(sub_bytes);
+
+        /* Give up if any thread could not allocate its sub-grid. */
+        if (!sub)
+        {
+#pragma omp atomic
+            failed++;
+        }
+#pragma omp barrier
+        for (c = 0; c < 4 && !failed; ++c)
+        {
+#pragma omp for schedule(dynamic, 1)
+            for (t = 0; t < num_tiles; ++t)
+            {
+                int x, y, x0, y0, x1, y1;
+                const int tile_u = t % num_tiles_1d;
+                const int tile_v = t / num_tiles_1d;
+                const int origin_u = tile_u * tile_size - support;
+                const int origin_v = tile_v * tile_size - support;
+                const size_t start = starts[t];
+                const size_t count = starts[t + 1] - start;
+                if (count == 0 || (tile_u & 1) + 2 * (tile_v & 1) != c)
+                    continue;
+                memset(sub, 0, sub_bytes);
+                tile_norm[t] = oskar_grid_simple_tile_f(support, oversample,
+                        conv_func, count, sorted ? &sorted[start] : 0,
+                        start, uu, vv, vis, weight, grid_scale,
+                        grid_centre - origin_u, grid_centre - origin_v,
+                        sub_size, sub);
+
+                /* Add the sub-grid to the main grid. */
+                x0 = origin_u < 0 ? -origin_u : 0;
+                y0 = origin_v < 0 ? -origin_v : 0;
+                x1 = grid_size - origin_u < sub_size ?
+                        grid_size - origin_u : sub_size;
+                y1 = grid_size - origin_v < sub_size ?
+                        grid_size - origin_v : sub_size;
+                for (y = y0; y < y1; ++y)
+                {
+                    const float* restrict in = &sub[2 * y * sub_size];
+                    float* restrict out = &grid[2 * ((size_t)(origin_v + y) *
+                            grid_size + origin_u)];
+                    for (x = 2 * x0; x < 2 * x1; ++x) out[x] += in[x];
+                }
+            }
+        }
+        free(sub);
+    }
+
+    /* Sum the normalisation factors in tile order. */
+    if (!failed)
+        for (t = 0; t < num_tiles; ++t) *norm += tile_norm[t];
+    free(tile_id);
+    free(sorted);
+    free(bucket_start);
+    free(tile_norm);
+    return !failed;
+}
+
+
 void oskar_grid_simple_d(
         const int support,
         const int oversample,
@@ -194,6 +578,14 @@ void oskar_grid_simple_d(
     const int grid_centre = grid_size / 2;
     const double grid_scale = grid_size * cell_size_rad;
 
+    /* Use the tiled, multi-threaded version if it is worthwhile.
+     * It returns false if its work arrays could not be allocated. */
+    if (oskar_grid_tiles_enabled(num_points) &&
+            oskar_grid_simple_tiled_d(support, oversample, conv_func,
+                num_points, 0, uu, vv, vis, weight, cell_size_rad, grid_size,
+                num_skipped, norm, grid))
+        return;
+
     /* Use slightly more efficient version for default parameters. */
     if (support == D_SUPPORT && oversample == D_OVERSAMPLE)
     {
@@ -273,6 +665,14 @@ void oskar_grid_simple_f(
     const int grid_centre = grid_size / 2;
     const float grid_scale = grid_size * cell_size_rad;
 
+    /* Use the tiled, multi-threaded version if it is worthwhile.
+     * It returns false if its work arrays could not be allocated. */
+    if (oskar_grid_tiles_enabled(num_points) &&
+            oskar_grid_simple_tiled_f(support, oversample, conv_func,
+                num_points, 0, uu, vv, vis, weight, cell_size_rad, grid_size,
+                num_skipped, norm, grid))
+        return;
+
     /* Use slightly more efficient version for default parameters. */
     if (support == D_SUPPORT && oversample == D_OVERSAMPLE)
     {
@@ -332,6 +732,60 @@ void oskar_grid_simple_f(
     }
 }
 
+
+void oskar_grid_simple_sorted_d(
+        const int support,
+        const int oversample,
+        const double* restrict conv_func,
+        const size_t num_points,
+        const size_t* restrict tile_start,
+        const double* restrict uu,
+        const double* restrict vv,
+        const double* restrict vis,
+        const double* restrict weight,
+        const double cell_size_rad,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        double* restrict grid)
+{
+    /* Use the given tile boundaries if the tiled version is used. */
+    if (tile_start && oskar_grid_tiles_enabled(num_points) &&
+            oskar_grid_simple_tiled_d(support, oversample, conv_func,
+                num_points, tile_start, uu, vv, vis, weight, cell_size_rad,
+                grid_size, num_skipped, norm, grid))
+        return;
+    oskar_grid_simple_d(support, oversample, conv_func, num_points, uu, vv, vis,
+            weight, cell_size_rad, grid_size, num_skipped, norm, grid);
+}
+
+
+void oskar_grid_simple_sorted_f(
+        const int support,
+        const int oversample,
+        const float* restrict conv_func,
+        const size_t num_points,
+        const size_t* restrict tile_start,
+        const float* restrict uu,
+        const float* restrict vv,
+        const float* restrict vis,
+        const float* restrict weight,
+        const float cell_size_rad,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        float* restrict grid)
+{
+    /* Use the given tile boundaries if the tiled version is used. */
+    if (tile_start && oskar_grid_tiles_enabled(num_points) &&
+            oskar_grid_simple_tiled_f(support, oversample, conv_func,
+                num_points, tile_start, uu, vv, vis, weight, cell_size_rad,
+                grid_size, num_skipped, norm, grid))
+        return;
+    oskar_grid_simple_f(support, oversample, conv_func, num_points, uu, vv, vis,
+            weight, cell_size_rad, grid_size, num_skipped, norm, grid);
+}
+
 #ifdef __cplusplus
 }
 #endif
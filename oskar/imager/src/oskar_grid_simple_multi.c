@@ -0,0 +1,803 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "imager/oskar_grid_simple.h"
+#include "imager/oskar_grid_simple_multi.h"
+#include "imager/oskar_grid_tiles.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static void oskar_grid_simple_multi_serial_d(
+        const int support,
+        const int oversample,
+        const double* restrict conv_func,
+        const int num_planes,
+        const size_t num_points,
+        const double* restrict uu,
+        const double* restrict vv,
+        const double* const* vis,
+        const double* const* weight,
+        const double cell_size_rad,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        double* const* grid)
+{
+    size_t i;
+    const int width = 2 * support + 1;
+    double *cu, *cv;
+    const int grid_centre = grid_size / 2;
+    const double grid_scale = grid_size * cell_size_rad;
+
+    cu = (double*) malloc(2 * width * sizeof(double));
+    if (!cu)
+    {
+        /* Grid each plane separately if there is no room for the kernel. */
+        int p;
+        for (p = 0; p < num_planes; ++p)
+            oskar_grid_simple_d(support, oversample, conv_func, num_points,
+                    uu, vv, vis[p], weight[p], cell_size_rad, grid_size,
+                    num_skipped, &norm[p], grid[p]);
+        return;
+    }
+    cv = cu + width;
+
+    /* Loop over visibilities. */
+    *num_skipped = 0;
+    for (i = 0; i < num_points; ++i)
+    {
+        double sum = 0.0;
+        int j, k, p;
+
+        /* Convert UV coordinates to grid coordinates. */
+        const double pos_u = -uu[i] * grid_scale;
+        const double pos_v = vv[i] * grid_scale;
+        const int grid_u = (int)round(pos_u) + grid_centre;
+        const int grid_v = (int)round(pos_v) + grid_centre;
+
+        /* Scaled distance from nearest grid point. */
+        const int off_u = (int)round((round(pos_u) - pos_u) * oversample);
+        const int off_v = (int)round((round(pos_v) - pos_v) * oversample);
+
+        /* Catch points that would lie outside the grid. */
+        if (grid_u + support >= grid_size || grid_u - support < 0 ||
+                grid_v + support >= grid_size || grid_v - support < 0)
+        {
+            *num_skipped += 1;
+            continue;
+        }
+
+        /* Look up the kernel values in each direction once. */
+        for (k = -support; k <= support; ++k)
+            cu[k + support] = conv_func[abs(off_u + k * oversample)];
+        for (j = -support; j <= support; ++j)
+        {
+            const double c1 = conv_func[abs(off_v + j * oversample)];
+            cv[j + support] = c1;
+            for (k = 0; k < width; ++k)
+                sum += cu[k] * c1;
+        }
+
+        /* Convolve this point onto each grid in turn. */
+        for (p = 0; p < num_planes; ++p)
+        {
+            double* restrict g = grid[p];
+            const double v_re = weight[p][i] * vis[p][2 * i];
+            const double v_im = weight[p][i] * vis[p][2 * i + 1];
+            for (j = 0; j < width; ++j)
+            {
+                size_t p1;
+                double* restrict row;
+                const double c1 = cv[j];
+                p1 = grid_v + j - support;
+                p1 *= grid_size; /* Tested to avoid int overflow. */
+                p1 += grid_u - support;
+                row = &g[p1 << 1];
+                for (k = 0; k < width; ++k)
+                {
+                    const double c = cu[k] * c1;
+                    row[2 * k]     += v_re * c;
+                    row[2 * k + 1] += v_im * c;
+                }
+            }
+            norm[p] += sum * weight[p][i];
+        }
+    }
+    free(cu);
+}
+
+
+static void oskar_grid_simple_multi_tile_d(
+        const int support,
+        const int oversample,
+        const double* restrict conv_func,
+        const int num_planes,
+        const size_t num_points,
+        const size_t* restrict indices,
+        const size_t first,
+        const double* restrict uu,
+        const double* restrict vv,
+        const double* const* vis,
+        const double* const* weight,
+        const double grid_scale,
+        const int offset_u,
+        const int offset_v,
+        const int sub_size,
+        double* restrict norm,
+        double* restrict sub,
+        double* restrict cu)
+{
+    size_t i;
+    const int width = 2 * support + 1;
+    double* restrict cv = cu + width;
+    const size_t sub_cells = (size_t) sub_size * sub_size;
+
+    /* Loop over visibilities in the tile. */
+    for (i = 0; i < num_points; ++i)
+    {
+        double sum = 0.0;
+        int j, k, p;
+        const size_t t = indices ? indices[i] : first + i;
+
+        /* Convert UV coordinates to sub-grid coordinates. */
+        const double pos_u = -uu[t] * grid_scale;
+        const double pos_v = vv[t] * grid_scale;
+        const int grid_u = (int)round(pos_u) + offset_u;
+        const int grid_v = (int)round(pos_v) + offset_v;
+
+        /* Scaled distance from nearest grid point. */
+        const int off_u = (int)round((round(pos_u) - pos_u) * oversample);
+        const int off_v = (int)round((round(pos_v) - pos_v) * oversample);
+
+        /* Look up the kernel values in each direction once. */
+        for (k = -support; k <= support; ++k)
+            cu[k + support] = conv_func[abs(off_u + k * oversample)];
+        for (j = -support; j <= support; ++j)
+        {
+            const double c1 = conv_func[abs(off_v + j * oversample)];
+            cv[j + support] = c1;
+            for (k = 0; k < width; ++k)
+                sum += cu[k] * c1;
+        }
+
+        /* Convolve this point onto each sub-grid in turn. */
+        for (p = 0; p < num_planes; ++p)
+        {
+            double* restrict g = &sub[2 * p * sub_cells];
+            const double v_re = weight[p][t] * vis[p][2 * t];
+            const double v_im = weight[p][t] * vis[p][2 * t + 1];
+            for (j = 0; j < width; ++j)
+            {
+                size_t p1;
+                double* restrict row;
+                const double c1 = cv[j];
+                p1 = grid_v + j - support;
+                p1 *= sub_size;
+                p1 += grid_u - support;
+                row = &g[p1 << 1];
+                for (k = 0; k < width; ++k)
+                {
+                    const double c = cu[k] * c1;
+                    row[2 * k]     += v_re * c;
+                    row[2 * k + 1] += v_im * c;
+                }
+            }
+            norm[p] += sum * weight[p][t];
+        }
+    }
+}
+
+
+static int oskar_grid_simple_multi_tiled_d(
+        const int support,
+        const int oversample,
+        const double* restrict conv_func,
+        const int num_planes,
+        const size_t num_points,
+        const size_t* restrict tile_start,
+        const double* restrict uu,
+        const double* restrict vv,
+        const double* const* vis,
+        const double* const* weight,
+        const double cell_size_rad,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        double* const* grid)
+{
+    int c, p, t, num_tiles, num_tiles_1d, tile_size, sub_size;
+    int* tile_id = 0;
+    size_t *bucket_start = 0, *sorted = 0;
+    const size_t* starts = tile_start;
+    double* tile_norm;
+    int failed = 0;
+    const int grid_centre = grid_size / 2;
+    const double grid_scale = grid_size * cell_size_rad;
+
+    /* Set up tiles for the kernel. */
+    tile_size = oskar_grid_tiles_size(support);
+    sub_size = tile_size + 2 * support;
+    num_tiles_1d = (grid_size + tile_size - 1) / tile_size;
+    num_tiles = num_tiles_1d * num_tiles_1d;
+    tile_norm = (double*) calloc(num_tiles * num_planes, sizeof(double));
+    if (!tile_start)
+    {
+        tile_id = (int*) malloc(num_points * sizeof(int));
+        sorted = (size_t*) malloc(num_points * sizeof(size_t));
+        bucket_start = (size_t*) malloc((num_tiles + 1) * sizeof(size_t));
+        starts = bucket_start;
+    }
+    if (!tile_norm ||
+            (!tile_start && (!tile_id || !sorted || !bucket_start)))
+    {
+        free(tile_id);
+        free(sorted);
+        free(bucket_start);
+        free(tile_norm);
+        return 0;
+    }
+
+    /* Find the tile containing the centre of each visibility,
+     * unless the visibilities have already been sorted by tile. */
+    if (tile_start)
+        *num_skipped = num_points - tile_start[num_tiles];
+    else
+    {
+        *num_skipped = oskar_grid_tiles_find_d(1, &support, num_points,
+                uu, vv, 0, cell_size_rad, 0, grid_size, tile_size, tile_id, 0);
+        oskar_grid_tiles_bucket(num_points, tile_id, num_tiles,
+                bucket_start, sorted);
+    }
+
+    /* Grid each tile into private padded sub-grids, one for each plane,
+     * then add them to the main grids, using the same checkerboard
+     * scheme as the single-plane version. */
+#pragma omp parallel private(c, p, t)
+    {
+        const size_t sub_cells = (size_t) sub_size * sub_size;
+        const size_t sub_bytes = 2 * num_planes * sub_cells * sizeof(double);
+        const size_t cu_bytes = 2 * (2 * support + 1) * sizeof(double);
+        double* sub = (double*) malloc(sub_bytes + cu_bytes);
+
+        /* Give up if any thread could not allocate its sub-grid. */
+        if (!sub)
+        {
+#pragma omp atomic
+            failed++;
+        }
+#pragma omp barrier
+        for (c = 0; c < 4 && !failed; ++c)
+        {
+#pragma omp for schedule(dynamic, 1)
+            for (t = 0; t < num_tiles; ++t)
+            {
+                int x, y, x0, y0, x1, y1;
+                const int tile_u = t % num_tiles_1d;
+                const int tile_v = t / num_tiles_1d;
+                const int origin_u = tile_u * tile_size - support;
+                const int origin_v = tile_v * tile_size - support;
+                const size_t start = starts[t];
+                const size_t count = starts[t + 1] - start;
+                if (count == 0 || (tile_u & 1) + 2 * (tile_v & 1) != c)
+                    continue;
+                memset(sub, 0, sub_bytes);
+                oskar_grid_simple_multi_tile_d(support, oversample,
+                        conv_func, num_planes, count,
+                        sorted ? &sorted[start] : 0, start,
+                        uu, vv, vis, weight, grid_scale,
+                        grid_centre - origin_u, grid_centre - origin_v,
+                        sub_size, &tile_norm[t * num_planes], sub,
+                        sub + 2 * num_planes * sub_cells);
+
+                /* Add the sub-grids to the main grids. */
+                x0 = origin_u < 0 ? -origin_u : 0;
+                y0 = origin_v < 0 ? -origin_v : 0;
+                x1 = grid_size - origin_u < sub_size ?
+                        grid_size - origin_u : sub_size;
+                y1 = grid_size - origin_v < sub_size ?
+                        grid_size - origin_v : sub_size;
+                for (p = 0; p < num_planes; ++p)
+                {
+                    for (y = y0; y < y1; ++y)
+                    {
+                        const double* restrict in =
+                                &sub[2 * (p * sub_cells + y * sub_size)];
+                        double* restrict out = &grid[p][2 * ((size_t)
+                                (origin_v + y) * grid_size + origin_u)];
+                        for (x = 2 * x0; x < 2 * x1; ++x) out[x] += in[x];
+                    }
+                }
+            }
+        }
+        free(sub);
+    }
+
+    /* Sum the normalisation factors in tile order. */
+    if (!failed)
+        for (t = 0; t < num_tiles; ++t)
+            for (p = 0; p < num_planes; ++p)
+                norm[p] += tile_norm[t * num_planes + p];
+    free(tile_id);
+    free(sorted);
+    free(bucket_start);
+    free(tile_norm);
+    return !failed;
+}
+
+
+void oskar_grid_simple_multi_d(
+        const int support,
+        const int oversample,
+        const double* restrict conv_func,
+        const int num_planes,
+        const size_t num_points,
+        const double* restrict uu,
+        const double* restrict vv,
+        const double* const* vis,
+        const double* const* weight,
+        const double cell_size_rad,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        double* const* grid)
+{
+    /* Use the tiled, multi-threaded version if it is worthwhile.
+     * It returns false if its work arrays could not be allocated. */
+    if (oskar_grid_tiles_enabled(num_points) &&
+            oskar_grid_simple_multi_tiled_d(support, oversample, conv_func,
+                num_planes, num_points, 0, uu, vv, vis, weight, cell_size_rad,
+                grid_size, num_skipped, norm, grid))
+        return;
+    if (support == 3 && oversample == 100)
+        oskar_grid_simple_multi_serial_d(3, 100, conv_func,
+                num_planes, num_points, uu, vv, vis, weight, cell_size_rad,
+                grid_size, num_skipped, norm, grid);
+    else
+        oskar_grid_simple_multi_serial_d(support, oversample, conv_func,
+                num_planes, num_points, uu, vv, vis, weight, cell_size_rad,
+                grid_size, num_skipped, norm, grid);
+}
+
+
+static void oskar_grid_simple_multi_serial_f(
+        const int support,
+        const int oversample,
+        const float* restrict conv_func,
+        const int num_planes,
+        const size_t num_points,
+        const float* restrict uu,
+        const float* restrict vv,
+        const float* const* vis,
+        const float* const* weight,
+        const float cell_size_rad,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        float* const* grid)
+{
+    size_t i;
+    const int width = 2 * support + 1;
+    float *cu, *cv;
+    const int grid_centre = grid_size / 2;
+    const float grid_scale = grid_size * cell_size_rad;
+
+    cu = (float*) malloc(2 * width * sizeof(float));
+    if (!cu)
+    {
+        /* Grid each plane separately if there is no room for the kernel. */
+        int p;
+        for (p = 0; p < num_planes; ++p)
+            oskar_grid_simple_f(support, oversample, conv_func, num_points,
+                    uu, vv, vis[p], weight[p], cell_size_rad, grid_size,
+                    num_skipped, &norm[p], grid[p]);
+        return;
+    }
+    cv = cu + width;
+
+    /* Loop over visibilities. */
+    *num_skipped = 0;
+    for (i = 0; i < num_points; ++i)
+    {
+        double sum = 0.0;
+        int j, k, p;
+
+        /* Convert UV coordinates to grid coordinates. */
+        const float pos_u = -uu[i] * grid_scale;
+        const float pos_v = vv[i] * grid_scale;
+        const int grid_u = (int)roundf(pos_u) + grid_centre;
+        const int grid_v = (int)roundf(pos_v) + grid_centre;
+
+        /* Scaled distance from nearest grid point. */
+        const int off_u = (int)roundf((roundf(pos_u) - pos_u) * oversample);
+        const int off_v = (int)roundf((roundf(pos_v) - pos_v) * oversample);
+
+        /* Catch points that would lie outside the grid. */
+        if (grid_u + support >= grid_size || grid_u - support < 0 ||
+                grid_v + support >= grid_size || grid_v - support < 0)
+        {
+            *num_skipped += 1;
+            continue;
+        }
+
+        /* Look up the kernel values in each direction once. */
+        for (k = -support; k <= support; ++k)
+            cu[k + support] = conv_func[abs(off_u + k * oversample)];
+        for (j = -support; j <= support; ++j)
+        {
+            const float c1 = conv_func[abs(off_v + j * oversample)];
+            cv[j + support] = c1;
+            for (k = 0; k < width; ++k)
+                sum += cu[k] * c1;
+        }
+
+        /* Convolve this point onto each grid in turn. */
+        for (p = 0; p < num_planes; ++p)
+        {
+            float* restrict g = grid[p];
+            const float v_re = weight[p][i] * vis[p][2 * i];
+            const float v_im = weight[p][i] * vis[p][2 * i + 1];
+            for (j = 0; j < width; ++j)
+            {
+                size_t p1;
+                float* restrict row;
+                const float c1 = cv[j];
+                p1 = grid_v + j - support;
+                p1 *= grid_size; /* Tested to avoid int overflow. */
+                p1 += grid_u - support;
+                row = &g[p1 << 1];
+                for (k = 0; k < width; ++k)
+                {
+                    const float c = cu[k] * c1;
+                    row[2 * k]     += v_re * c;
+                    row[2 * k + 1] += v_im * c;
+                }
+            }
+            norm[p] += sum * weight[p][i];
+        }
+    }
+    free(cu);
+}
+
+
+static void oskar_grid_simple_multi_tile_f(
+        const int support,
+        const int oversample,
+        const float* restrict conv_func,
+        const int num_planes,
+        const size_t num_points,
+        const size_t* restrict indices,
+        const size_t first,
+        const float* restrict uu,
+        const float* restrict vv,
+        const float* const* vis,
+        const float* const* weight,
+        const float grid_scale,
+        const int offset_u,
+        const int offset_v,
+        const int sub_size,
+        double* restrict norm,
+        float* restrict sub,
+        float* restrict cu)
+{
+    size_t i;
+    const int width = 2 * support + 1;
+    float* restrict cv = cu + width;
+    const size_t sub_cells = (size_t) sub_size * sub_size;
+
+    /* Loop over visibilities in the tile. */
+    for (i = 0; i < num_points; ++i)
+    {
+        double sum = 0.0;
+        int j, k, p;
+        const size_t t = indices ? indices[i] : first + i;
+
+        /* Convert UV coordinates to sub-grid coordinates. */
+        const float pos_u = -uu[t] * grid_scale;
+        const float pos_v = vv[t] * grid_scale;
+        const int grid_u = (int)roundf(pos_u) + offset_u;
+        const int grid_v = (int)roundf(pos_v) + offset_v;
+
+        /* Scaled distance from nearest grid point. */
+        const int off_u = (int)roundf((roundf(pos_u) - pos_u) * oversample);
+        const int off_v = (int)roundf((roundf(pos_v) - pos_v) * oversample);
+
+        /* Look up the kernel values in each direction once. */
+        for (k = -support; k <= support; ++k)
+            cu[k + support] = conv_func[abs(off_u + k * oversample)];
+        for (j = -support; j <= support; ++j)
+        {
+            const float c1 = conv_func[abs(off_v + j * oversample)];
+            cv[j + support] = c1;
+            for (k = 0; k < width; ++k)
+                sum += cu[k] * c1;
+        }
+
+        /* Convolve this point onto each sub-grid in turn. */
+        for (p = 0; p < num_planes; ++p)
+        {
+            float* restrict g = &sub[2 * p * sub_cells];
+            const float v_re = weight[p][t] * vis[p][2 * t];
+            const float v_im = weight[p][t] * vis[p][2 * t + 1];
+            for (j = 0; j < width; ++j)
+            {
+                size_t p1;
+                float* restrict row;
+                const float c1 = cv[j];
+                p1 = grid_v + j - support;
+                p1 *= sub_size;
+                p1 += grid_u - support;
+                row = &g[p1 << 1];
+                for (k = 0; k < width; ++k)
+                {
+                    const float c = cu[k] * c1;
+                    row[2 * k]     += v_re * c;
+                    row[2 * k + 1] += v_im * c;
+                }
+            }
+            norm[p] += sum * weight[p][t];
+        }
+    }
+}
+
+
+static int oskar_grid_simple_multi_tiled_f(
+        const int support,
+        const int oversample,
+        const float* restrict conv_func,
+        const int num_planes,
+        const size_t num_points,
+        const size_t* restrict tile_start,
+        const float* restrict uu,
+        const float* restrict vv,
+        const float* const* vis,
+        const float* const* weight,
+        const float cell_size_rad,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        float* const* grid)
+{
+    int c, p, t, num_tiles, num_tiles_1d, tile_size, sub_size;
+    int* tile_id = 0;
+    size_t *bucket_start = 0, *sorted = 0;
+    const size_t* starts = tile_start;
+    double* tile_norm;
+    int failed = 0;
+    const int grid_centre = grid_size / 2;
+    const float grid_scale = grid_size * cell_size_rad;
+
+    /* Set up tiles for the kernel. */
+    tile_size = oskar_grid_tiles_size(support);
+    sub_size = tile_size + 2 * support;
+    num_tiles_1d = (grid_size + tile_size - 1) / tile_size;
+    num_tiles = num_tiles_1d * num_tiles_1d;
+    tile_norm = (double*) calloc(num_tiles * num_planes, sizeof(double));
+    if (!tile_start)
+    {
+        tile_id = (int*) malloc(num_points * sizeof(int));
+        sorted = (size_t*) malloc(num_points * sizeof(size_t));
+        bucket_start = (size_t*) malloc((num_tiles + 1) * sizeof(size_t));
+        starts = bucket_start;
+    }
+    if (!tile_norm ||
+            (!tile_start && (!tile_id || !sorted || !bucket_start)))
+    {
+        free(tile_id);
+        free(sorted);
+        free(bucket_start);
+        free(tile_norm);
+        return 0;
+    }
+
+    /* Find the tile containing the centre of each visibility,
+     * unless the visibilities have already been sorted by tile. */
+    if (tile_start)
+        *num_skipped = num_points - tile_start[num_tiles];
+    else
+    {
+        *num_skipped = oskar_grid_tiles_find_f(1, &support, num_points,
+                uu, vv, 0, cell_size_rad, 0, grid_size, tile_size, tile_id, 0);
+        oskar_grid_tiles_bucket(num_points, tile_id, num_tiles,
+                bucket_start, sorted);
+    }
+
+    /* Grid each tile into private padded sub-grids, one for each plane,
+     * then add them to the main grids, using the same checkerboard
+     * scheme as the single-plane version. */
+#pragma omp parallel private(c, p, t)
+    {
+        const size_t sub_cells = (size_t) sub_size * sub_size;
+        const size_t sub_bytes = 2 * num_planes * sub_cells * sizeof(float);
+        const size_t cu_bytes = 2 * (2 * support + 1) * sizeof(float);
+        float* sub = (float*) malloc(sub_bytes + cu_bytes);
+
+        /* Give up if any thread could not allocate its sub-grid. */
+        if (!sub)
+        {
+#pragma omp atomic
+            failed++;
+        }
+#pragma omp barrier
+        for (c = 0; c < 4 && !failed; ++c)
+        {
+#pragma omp for schedule(dynamic, 1)
+            for (t = 0; t < num_tiles; ++t)
+            {
+                int x, y, x0, y0, x1, y1;
+                const int tile_u = t % num_tiles_1d;
+                const int tile_v = t / num_tiles_1d;
+                const int origin_u = tile_u * tile_size - support;
+                const int origin_v = tile_v * tile_size - support;
+                const size_t start = starts[t];
+                const size_t count = starts[t + 1] - start;
+                if (count == 0 || (tile_u & 1) + 2 * (tile_v & 1) != c)
+                    continue;
+                memset(sub, 0, sub_bytes);
+                oskar_grid_simple_multi_tile_f(support, oversample,
+                        conv_func, num_planes, count,
+                        sorted ? &sorted[start] : 0, start,
+                        uu, vv, vis, weight, grid_scale,
+                        grid_centre - origin_u, grid_centre - origin_v,
+                        sub_size, &tile_norm[t * num_planes], sub,
+                        sub + 2 * num_planes * sub_cells);
+
+                /* Add the sub-grids to the main grids. */
+                x0 = origin_u < 0 ? -origin_u : 0;
+                y0 = origin_v < 0 ? -origin_v : 0;
+                x1 = grid_size - origin_u < sub_size ?
+                        grid_size - origin_u : sub_size;
+                y1 = grid_size - origin_v < sub_size ?
+                        grid_size - origin_v : sub_size;
+                for (p = 0; p < num_planes; ++p)
+                {
+                    for (y = y0; y < y1; ++y)
+                    {
+                        const float* restrict in =
+                                &sub[2 * (p * sub_cells + y * sub_size)];
+                        float* restrict out = &grid[p][2 * ((size_t)
+                                (origin_v + y) * grid_size + origin_u)];
+                        for (x = 2 * x0; x < 2 * x1; ++x) out[x] += in[x];
+                    }
+                }
+            }
+        }
+        free(sub);
+    }
+
+    /* Sum the normalisation factors in tile order. */
+    if (!failed)
+        for (t = 0; t < num_tiles; ++t)
+            for (p = 0; p < num_planes; ++p)
+                norm[p] += tile_norm[t * num_planes + p];
+    free(tile_id);
+    free(sorted);
+    free(bucket_start);
+    free(tile_norm);
+    return !failed;
+}
+
+
+void oskar_grid_simple_multi_f(
+        const int support,
+        const int oversample,
+        const float* restrict conv_func,
+        const int num_planes,
+        const size_t num_points,
+        const float* restrict uu,
+        const float* restrict vv,
+        const float* const* vis,
+        const float* const* weight,
+        const float cell_size_rad,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        float* const* grid)
+{
+    /* Use the tiled, multi-threaded version if it is worthwhile.
+     * It returns false if its work arrays could not be allocated. */
+    if (oskar_grid_tiles_enabled(num_points) &&
+            oskar_grid_simple_multi_tiled_f(support, oversample, conv_func,
+                num_planes, num_points, 0, uu, vv, vis, weight, cell_size_rad,
+                grid_size, num_skipped, norm, grid))
+        return;
+    if (support == 3 && oversample == 100)
+        oskar_grid_simple_multi_serial_f(3, 100, conv_func,
+                num_planes, num_points, uu, vv, vis, weight, cell_size_rad,
+                grid_size, num_skipped, norm, grid);
+    else
+        oskar_grid_simple_multi_serial_f(support, oversample, conv_func,
+                num_planes, num_points, uu, vv, vis, weight, cell_size_rad,
+                grid_size, num_skipped, norm, grid);
+}
+
+
+void oskar_grid_simple_multi_sorted_d(
+        const int support,
+        const int oversample,
+        const double* restrict conv_func,
+        const int num_planes,
+        const size_t num_points,
+        const size_t* restrict tile_start,
+        const double* restrict uu,
+        const double* restrict vv,
+        const double* const* vis,
+        const double* const* weight,
+        const double cell_size_rad,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        double* const* grid)
+{
+    /* Use the given tile boundaries if the tiled version is used. */
+    if (tile_start && oskar_grid_tiles_enabled(num_points) &&
+            oskar_grid_simple_multi_tiled_d(support, oversample, conv_func,
+                num_planes, num_points, tile_start, uu, vv, vis, weight,
+                cell_size_rad, grid_size, num_skipped, norm, grid))
+        return;
+    oskar_grid_simple_multi_d(support, oversample, conv_func, num_planes,
+            num_points, uu, vv, vis, weight, cell_size_rad, grid_size,
+            num_skipped, norm, grid);
+}
+
+
+void oskar_grid_simple_multi_sorted_f(
+        const int support,
+        const int oversample,
+        const float* restrict conv_func,
+        const int num_planes,
+        const size_t num_points,
+        const size_t* restrict tile_start,
+        const float* restrict uu,
+        const float* restrict vv,
+        const float* const* vis,
+        const float* const* weight,
+        const float cell_size_rad,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        float* const* grid)
+{
+    /* Use the given tile boundaries if the tiled version is used. */
+    if (tile_start && oskar_grid_tiles_enabled(num_points) &&
+            oskar_grid_simple_multi_tiled_f(support, oversample, conv_func,
+                num_planes, num_points, tile_start, uu, vv, vis, weight,
+                cell_size_rad, grid_size, num_skipped, norm, grid))
+        return;
+    oskar_grid_simple_multi_f(support, oversample, conv_func, num_planes,
+            num_points, uu, vv, vis, weight, cell_size_rad, grid_size,
+            num_skipped, norm, grid);
+}
+
+#ifdef __cplusplus
+}
+#endif
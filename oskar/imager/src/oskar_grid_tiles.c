@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "imager/oskar_grid_tiles.h"
+#include <math.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MIN_TILE_SIZE 64
+#define MIN_TILED_VIS 8192
+
+int oskar_grid_tiles_enabled(size_t num_points)
+{
+#ifdef _OPENMP
+    return (omp_get_max_threads() > 1 && !omp_in_parallel() &&
+            num_points >= MIN_TILED_VIS);
+#else
+    (void) num_points;
+    return 0;
+#endif
+}
+
+
+int oskar_grid_tiles_size(int max_support)
+{
+    const int size = 4 * max_support;
+    return size > MIN_TILE_SIZE ? size : MIN_TILE_SIZE;
+}
+
+
+size_t oskar_grid_tiles_find_d(const size_t num_w_planes,
+        const int* restrict support, const size_t num_points,
+        const double* restrict uu, const double* restrict vv,
+        const double* restrict ww, const double cell_size_rad,
+        const double w_scale, const int grid_size, const int tile_size,
+        int* restrict tile_id, int* restrict w_plane)
+{
+    size_t skipped = 0;
+    const int grid_centre = grid_size / 2;
+    const int num_tiles_1d = (grid_size + tile_size - 1) / tile_size;
+    const double grid_scale = grid_size * cell_size_rad;
+#ifdef OSKAR_OS_WIN
+    int i;
+    const int num = (const int) num_points;
+#else
+    size_t i;
+    const size_t num = num_points;
+#endif
+
+#pragma omp parallel for private(i) reduction(+:skipped)
+    for (i = 0; i < num; ++i)
+    {
+        const int grid_u = (int)round(-uu[i] * grid_scale) + grid_centre;
+        const int grid_v = (int)round(vv[i] * grid_scale) + grid_centre;
+        size_t grid_w = ww ? (size_t)round(sqrt(fabs(ww[i] * w_scale))) : 0;
+        int w_support;
+        if (grid_w >= num_w_planes) grid_w = num_w_planes - 1;
+        w_support = support[grid_w];
+        if (w_plane) w_plane[i] = (int) grid_w;
+        if (grid_u + w_support >= grid_size || grid_u - w_support < 0 ||
+                grid_v + w_support >= grid_size || grid_v - w_support < 0)
+        {
+            tile_id[i] = -1;
+            skipped++;
+            continue;
+        }
+        tile_id[i] = (grid_v / tile_size) * num_tiles_1d + grid_u / tile_size;
+    }
+    return skipped;
+}
+
+
+size_t oskar_grid_tiles_find_f(const size_t num_w_planes,
+        const int* restrict support, const size_t num_points,
+        const float* restrict uu, const float* restrict vv,
+        const float* restrict ww, const float cell_size_rad,
+        const float w_scale, const int grid_size, const int tile_size,
+        int* restrict tile_id, int* restrict w_plane)
+{
+    size_t skipped = 0;
+    const int grid_centre = grid_size / 2;
+    const int num_tiles_1d = (grid_size + tile_size - 1) / tile_size;
+    const float grid_scale = grid_size * cell_size_rad;
+#ifdef OSKAR_OS_WIN
+    int i;
+    const int num = (const int) num_points;
+#else
+    size_t i;
+    const size_t num = num_points;
+#endif
+
+#pragma omp parallel for private(i) reduction(+:skipped)
+    for (i = 0; i < num; ++i)
+    {
+        const int grid_u = (int)roundf(-uu[i] * grid_scale) + grid_centre;
+        const int grid_v = (int)roundf(vv[i] * grid_scale) + grid_centre;
+        size_t grid_w = ww ? (size_t)roundf(sqrtf(fabsf(ww[i] * w_scale))) : 0;
+        int w_support;
+        if (grid_w >= num_w_planes) grid_w = num_w_planes - 1;
+        w_support = support[grid_w];
+        if (w_plane) w_plane[i] = (int) grid_w;
+        if (grid_u + w_support >= grid_size || grid_u - w_support < 0 ||
+                grid_v + w_support >= grid_size || grid_v - w_support < 0)
+        {
+            tile_id[i] = -1;
+            skipped++;
+            continue;
+        }
+        tile_id[i] = (grid_v / tile_size) * num_tiles_1d + grid_u / tile_size;
+    }
+    return skipped;
+}
+
+
+void oskar_grid_tiles_bucket(size_t num_points, const int* restrict tile_id,
+        int num_tiles, size_t* restrict tile_start, size_t* restrict sorted)
+{
+    size_t i;
+    int t;
+
+    /* Count visibilities in each tile. */
+    for (t = 0; t <= num_tiles; ++t) tile_start[t] = 0;
+    for (i = 0; i < num_points; ++i)
+        if (tile_id[i] >= 0) tile_start[tile_id[i] + 1]++;
+
+    /* Convert counts to start offsets. */
+    for (t = 0; t < num_tiles; ++t) tile_start[t + 1] += tile_start[t];
+
+    /* Scatter indices, using the start offsets as running counters. */
+    for (i = 0; i < num_points; ++i)
+        if (tile_id[i] >= 0) sorted[tile_start[tile_id[i]]++] = i;
+
+    /* Counters now point to the end of each tile: shift them back. */
+    for (t = num_tiles; t > 0; --t) tile_start[t] = tile_start[t - 1];
+    tile_start[0] = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,13 +27,449 @@
  */
 
 #include "imager/oskar_grid_wproj.h"
+#include "imager/oskar_grid_tiles.h"
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+static double oskar_grid_wproj_tile_d(
+        const size_t num_w_planes,
+        const int* restrict support,
+        const int oversample,
+        const int conv_size_half,
+        const double* restrict conv_func,
+        const size_t num_points,
+        const size_t* restrict indices,
+        const size_t first,
+        const double* restrict uu,
+        const double* restrict vv,
+        const double* restrict ww,
+        const double* restrict vis,
+        const double* restrict weight,
+        const double grid_scale,
+        const double w_scale,
+        const int offset_u,
+        const int offset_v,
+        const int sub_size,
+        double* restrict sub)
+{
+    size_t i;
+    double norm = 0.0;
+    const size_t kernel_dim = conv_size_half * conv_size_half;
+
+    /* Loop over visibilities in the tile. */
+    for (i = 0; i < num_points; ++i)
+    {
+        double sum = 0.0;
+        int j, k;
+        const size_t v = indices ? indices[i] : first + i;
+
+        /* Convert UV coordinates to sub-grid coordinates. */
+        const double pos_u = -uu[v] * grid_scale;
+        const double pos_v = vv[v] * grid_scale;
+        const double ww_i = ww[v];
+        const double conv_conj = (ww_i > 0.0) ? -1.0 : 1.0;
+        const size_t grid_w = (size_t)round(sqrt(fabs(ww_i * w_scale)));
+        const int grid_u = (int)round(pos_u) + offset_u;
+        const int grid_v = (int)round(pos_v) + offset_v;
+
+        /* Get visibility data. */
+        const double weight_i = weight[v];
+        const double v_re = weight_i * vis[2 * v];
+        const double v_im = weight_i * vis[2 * v + 1];
+
+        /* Scaled distance from nearest grid point. */
+        const int off_u = (int)round((round(pos_u) - pos_u) * oversample);
+        const int off_v = (int)round((round(pos_v) - pos_v) * oversample);
+
+        /* Get kernel support size and start offset. */
+        const int w_support = grid_w < num_w_planes ?
+                support[grid_w] : support[num_w_planes - 1];
+        const size_t kernel_start = grid_w < num_w_planes ?
+                grid_w * kernel_dim : (num_w_planes - 1) * kernel_dim;
+
+        /* Convolve this point onto the sub-grid. */
+        for (j = -w_support; j <= w_support; ++j)
+        {
+            size_t p1, t1;
+            p1 = grid_v + j;
+            p1 *= sub_size;
+            p1 += grid_u;
+            t1 = abs(off_v + j * oversample);
+            t1 *= conv_size_half;
+            t1 += kernel_start;
+            for (k = -w_support; k <= w_support; ++k)
+            {
+                size_t p = (t1 + abs(off_u + k * oversample)) << 1;
+                const double c_re = conv_func[p];
+                const double c_im = conv_func[p + 1] * conv_conj;
+                p = (p1 + k) << 1;
+                sub[p]     += (v_re * c_re - v_im * c_im);
+                sub[p + 1] += (v_im * c_re + v_re * c_im);
+                sum += c_re; /* Real part only. */
+            }
+        }
+        norm += sum * weight_i;
+    }
+    return norm;
+}
+
+
+static int oskar_grid_wproj_tiled_d(
+        const size_t num_w_planes,
+        const int* restrict support,
+        const int oversample,
+        const int conv_size_half,
+        const double* restrict conv_func,
+        const size_t num_points,
+        const size_t* restrict tile_start,
+        const double* restrict uu,
+        const double* restrict vv,
+        const double* restrict ww,
+        const double* restrict vis,
+        const double* restrict weight,
+        const double cell_size_rad,
+        const double w_scale,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        double* restrict grid)
+{
+    int c, t, max_support = 0, num_tiles, num_tiles_1d, tile_size, sub_size;
+    int* tile_id = 0;
+    size_t i, *bucket_start = 0, *sorted = 0;
+    const size_t* starts = tile_start;
+    double* tile_norm;
+    int failed = 0;
+    const int grid_centre = grid_size / 2;
+    const double grid_scale = grid_size * cell_size_rad;
+
+    /* Set up tiles for the largest kernel. */
+    for (i = 0; i < num_w_planes; ++i)
+        if (support[i] > max_support) max_support = support[i];
+    tile_size = oskar_grid_tiles_size(max_support);
+    sub_size = tile_size + 2 * max_support;
+    num_tiles_1d = (grid_size + tile_size - 1) / tile_size;
+    num_tiles = num_tiles_1d * num_tiles_1d;
+    tile_norm = (double*) calloc(num_tiles, sizeof(double));
+    if (!tile_start)
+    {
+        tile_id = (int*) malloc(num_points * sizeof(int));
+        sorted = (size_t*) malloc(num_points * sizeof(size_t));
+        bucket_start = (size_t*) malloc((num_tiles + 1) * sizeof(size_t));
+        starts = bucket_start;
+    }
+    if (!tile_norm ||
+            (!tile_start && (!tile_id || !sorted || !bucket_start)))
+    {
+        free(tile_id);
+        free(sorted);
+        free(bucket_start);
+        free(tile_norm);
+        return 0;
+    }
+
+    /* Find the tile containing the centre of each visibility,
+     * unless the visibilities have already been sorted by tile. */
+    if (tile_start)
+        *num_skipped = num_points - tile_start[num_tiles];
+    else
+    {
+        *num_skipped = oskar_grid_tiles_find_d(num_w_planes, support,
+                num_points, uu, vv, ww, cell_size_rad, w_scale, grid_size,
+                tile_size, tile_id, 0);
+        oskar_grid_tiles_bucket(num_points, tile_id, num_tiles,
+                bucket_start, sorted);
+    }
+
+    /* Grid each tile into a private padded sub-grid, then add it to the
+     * main grid. Tiles are processed in four passes, one for each colour
+     * of a 2x2 checkerboard, so that concurrent sub-grids never overlap. */
+#pragma omp parallel private(c, t)
+    {
+        const size_t sub_bytes = 2 * sub_size * sub_size * sizeof(double);
+        double* sub = (double*) malloc(sub_bytes);
+
+        /* Give up if any thread could not allocate its sub-grid. */
+        if (!sub)
+        {
+#pragma omp atomic
+            failed++;
+        }
+#pragma omp barrier
+        for (c = 0; c < 4 && !failed; ++c)
+        {
+#pragma omp for schedule(dynamic, 1)
+            for (t = 0; t < num_tiles; ++t)
+            {
+                int x, y, x0, y0, x1, y1;
+                const int tile_u = t % num_tiles_1d;
+                const int tile_v = t / num_tiles_1d;
+                const int origin_u = tile_u * tile_size - max_support;
+                const int origin_v = tile_v * tile_size - max_support;
+                const size_t start = starts[t];
+                const size_t count = starts[t + 1] - start;
+                if (count == 0 || (tile_u & 1) + 2 * (tile_v & 1) != c)
+                    continue;
+                memset(sub, 0, sub_bytes);
+                tile_norm[t] = oskar_grid_wproj_tile_d(num_w_planes,
+                        support, oversample, conv_size_half, conv_func,
+                        count, sorted ? &sorted[start] : 0, start,
+                        uu, vv, ww, vis, weight, grid_scale, w_scale,
+                        grid_centre - origin_u, grid_centre - origin_v,
+                        sub_size, sub);
+
+                /* Add the sub-grid to the main grid. */
+                x0 = origin_u < 0 ? -origin_u : 0;
+                y0 = origin_v < 0 ? -origin_v : 0;
+                x1 = grid_size - origin_u < sub_size ?
+                        grid_size - origin_u : sub_size;
+                y1 = grid_size - origin_v < sub_size ?
+                        grid_size - origin_v : sub_size;
+                for (y = y0; y < y1; ++y)
+                {
+                    const double* restrict in = &sub[2 * y * sub_size];
+                    double* restrict out = &grid[2 * ((size_t)(origin_v + y) *
+                            grid_size + origin_u)];
+                    for (x = 2 * x0; x < 2 * x1; ++x) out[x] += in[x];
+                }
+            }
+        }
+        free(sub);
+    }
+
+    /* Sum the normalisation factors in tile order. */
+    if (!failed)
+        for (t = 0; t < num_tiles; ++t) *norm += tile_norm[t];
+    free(tile_id);
+    free(sorted);
+    free(bucket_start);
+    free(tile_norm);
+    return !failed;
+}
+
+
+static double oskar_grid_wproj_tile_f(
+        const size_t num_w_planes,
+        const int* restrict support,
+        const int oversample,
+        const int conv_size_half,
+        const float* restrict conv_func,
+        const size_t num_points,
+        const size_t* restrict indices,
+        const size_t first,
+        const float* restrict uu,
+        const float* restrict vv,
+        const float* restrict ww,
+        const float* restrict vis,
+        const float* restrict weight,
+        const float grid_scale,
+        const float w_scale,
+        const int offset_u,
+        const int offset_v,
+        const int sub_size,
+        float* restrict sub)
+{
+    size_t i;
+    double norm = 0.0;
+    const size_t kernel_dim = conv_size_half * conv_size_half;
+
+    /* Loop over visibilities in the tile. */
+    for (i = 0; i < num_points; ++i)
+    {
+        double sum = 0.0;
+        int j, k;
+        const size_t v = indices ? indices[i] : first + i;
+
+        /* Convert UV coordinates to sub-grid coordinates. */
+        const float pos_u = -uu[v] * grid_scale;
+        const float pos_v = vv[v] * grid_scale;
+        const float ww_i = ww[v];
+        const float conv_conj = (ww_i > 0.0f) ? -1.0f : 1.0f;
+        const size_t grid_w = (size_t)roundf(sqrtf(fabsf(ww_i * w_scale)));
+        const int grid_u = (int)roundf(pos_u) + offset_u;
+        const int grid_v = (int)roundf(pos_v) + offset_v;
+
+        /* Get visibility data. */
+        const float weight_i = weight[v];
+        const float v_re = weight_i * vis[2 * v];
+        const float v_im = weight_i * vis[2 * v + 1];
+
+        /* Scaled distance from nearest grid point. */
+        const int off_u = (int)roundf((roundf(pos_u) - pos_u) * oversample);
+        const int off_v = (int)roundf((roundf(pos_v) - pos_v) * oversample);
+
+        /* Get kernel support size and start offset. */
+        const int w_support = grid_w < num_w_planes ?
+                support[grid_w] : support[num_w_planes - 1];
+        const size_t kernel_start = grid_w < num_w_planes ?
+                grid_w * kernel_dim : (num_w_planes - 1) * kernel_dim;
+
+        /* Convolve this point onto the sub-grid. */
+        for (j = -w_support; j <= w_support; ++j)
+        {
+            size_t p1, t1;
+            p1 = grid_v + j;
+            p1 *= sub_size;
+            p1 += grid_u;
+            t1 = abs(off_v + j * oversample);
+            t1 *= conv_size_half;
+            t1 += kernel_start;
+            for (k = -w_support; k <= w_support; ++k)
+            {
+                size_t p = (t1 + abs(off_u + k * oversample)) << 1;
+                const float c_re = conv_func[p];
+                const float c_im = conv_func[p + 1] * conv_conj;
+                p = (p1 + k) << 1;
+                sub[p]     += (v_re * c_re - v_im * c_im);
+                sub[p + 1] += (v_im * c_re + v_re * c_im);
+                sum += c_re; /* Real part only. */
+            }
+        }
+        norm += sum * weight_i;
+    }
+    return norm;
+}
+
+
+static int oskar_grid_wproj_tiled_f(
+        const size_t num_w_planes,
+        const int* restrict support,
+        const int oversample,
+        const int conv_size_half,
+        const float* restrict conv_func,
+        const size_t num_points,
+        const size_t* restrict tile_start,
+        const float* restrict uu,
+        const float* restrict vv,
+        const float* restrict ww,
+        const float* restrict vis,
+        const float* restrict weight,
+        const float cell_size_rad,
+        const float w_scale,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        float* restrict grid)
+{
+    int c, t, max_support = 0, num_tiles, num_tiles_1d, tile_size, sub_size;
+    int* tile_id = 0;
+    size_t i, *bucket_start = 0, *sorted = 0;
+    const size_t* starts = tile_start;
+    double* tile_norm;
+    int failed = 0;
+    const int grid_centre = grid_size / 2;
+    const float grid_scale = grid_size * cell_size_rad;
+
+    /* Set up tiles for the largest kernel. */
+    for (i = 0; i < num_w_planes; ++i)
+        if (support[i] > max_support) max_support = support[i];
+    tile_size = oskar_grid_tiles_size(max_support);
+    sub_size = tile_size + 2 * max_support;
+    num_tiles_1d = (grid_size + tile_size - 1) / tile_size;
+    num_tiles = num_tiles_1d * num_tiles_1d;
+    tile_norm = (double*) calloc(num_tiles, sizeof(double));
+    if (!tile_start)
+    {
+        tile_id = (int*) malloc(num_points * sizeof(int));
+        sorted = (size_t*) malloc(num_points * sizeof(size_t));
+        bucket_start = (size_t*) malloc((num_tiles + 1) * sizeof(size_t));
+        starts = bucket_start;
+    }
+    if (!tile_norm ||
+            (!tile_start && (!tile_id || !sorted || !bucket_start)))
+    {
+        free(tile_id);
+        free(sorted);
+        free(bucket_start);
+        free(tile_norm);
+        return 0;
+    }
+
+    /* Find the tile containing the centre of each visibility,
+     * unless the visibilities have already been sorted by tile. */
+    if (tile_start)
+        *num_skipped = num_points - tile_start[num_tiles];
+    else
+    {
+        *num_skipped = oskar_grid_tiles_find_f(num_w_planes, support,
+                num_points, uu, vv, ww, cell_size_rad, w_scale, grid_size,
+                tile_size, tile_id, 0);
+        oskar_grid_tiles_bucket(num_points, tile_id, num_tiles,
+                bucket_start, sorted);
+    }
+
+    /* Grid each tile into a private padded sub-grid, then add it to the
+     * main grid. Tiles are processed in four passes, one for each colour
+     * of a 2x2 checkerboard, so that concurrent sub-grids never overlap. */
+#pragma omp parallel private(c, t)
+    {
+        const size_t sub_bytes = 2 * sub_size * sub_size * sizeof(float);
+        float* sub = (float*) malloc(sub_bytes);
+
+        /* Give up if any thread could not allocate its sub-grid. */
+        if (!sub)
+        {
+#pragma omp atomic
+            failed++;
+        }
+#pragma omp barrier
+        for (c = 0; c < 4 && !failed; ++c)
+        {
+#pragma omp for schedule(dynamic, 1)
+            for (t = 0; t < num_tiles; ++t)
+            {
+                int x, y, x0, y0, x1, y1;
+                const int tile_u = t % num_tiles_1d;
+                const int tile_v = t / num_tiles_1d;
+                const int origin_u = tile_u * tile_size - max_support;
+                const int origin_v = tile_v * tile_size - max_support;
+                const size_t start = starts[t];
+                const size_t count = starts[t + 1] - start;
+                if (count == 0 || (tile_u & 1) + 2 * (tile_v & 1) != c)
+                    continue;
+                memset(sub, 0, sub_bytes);
+                tile_norm[t] = oskar_grid_wproj_tile_f(num_w_planes,
+                        support, oversample, conv_size_half, conv_func,
+                        count, sorted ? &sorted[start] : 0, start,
+                        uu, vv, ww, vis, weight, grid_scale, w_scale,
+                        grid_centre - origin_u, grid_centre - origin_v,
+                        sub_size, sub);
+
+                /* Add the sub-grid to the main grid. */
+                x0 = origin_u < 0 ? -origin_u : 0;
+                y0 = origin_v < 0 ? -origin_v : 0;
+                x1 = grid_size - origin_u < sub_size ?
+                        grid_size - origin_u : sub_size;
+                y1 = grid_size - origin_v < sub_size ?
+                        grid_size - origin_v : sub_size;
+                for (y = y0; y < y1; ++y)
+                {
+                    const float* restrict in = &sub[2 * y * sub_size];
+                    float* restrict out = &grid[2 * ((size_t)(origin_v + y) *
+                            grid_size + origin_u)];
+                    for (x = 2 * x0; x < 2 * x1; ++x) out[x] += in[x];
+                }
+            }
+        }
+        free(sub);
+    }
+
+    /* Sum the normalisation factors in tile order. */
+    if (!failed)
+        for (t = 0; t < num_tiles; ++t) *norm += tile_norm[t];
+    free(tile_id);
+    free(sorted);
+    free(bucket_start);
+    free(tile_norm);
+    return !failed;
+}
+
+
 void oskar_grid_wproj_d(
         const size_t num_w_planes,
         const int* restrict support,
@@ -58,6 +494,15 @@ void oskar_grid_wproj_d(
     const int grid_centre = grid_size / 2;
     const double grid_scale = grid_size * cell_size_rad;
 
+    /* Use the tiled, multi-threaded version if it is worthwhile.
+     * It returns false if its work arrays could not be allocated. */
+    if (oskar_grid_tiles_enabled(num_points) &&
+            oskar_grid_wproj_tiled_d(num_w_planes, support, oversample,
+                conv_size_half, conv_func, num_points, 0, uu, vv, ww, vis,
+                weight, cell_size_rad, w_scale, grid_size, num_skipped,
+                norm, grid))
+        return;
+
     /* Loop over visibilities. */
     *num_skipped = 0;
     for (i = 0; i < num_points; ++i)
@@ -147,6 +592,15 @@ void oskar_grid_wproj_f(
     const int grid_centre = grid_size / 2;
     const float grid_scale = grid_size * cell_size_rad;
 
+    /* Use the tiled, multi-threaded version if it is worthwhile.
+     * It returns false if its work arrays could not be allocated. */
+    if (oskar_grid_tiles_enabled(num_points) &&
+            oskar_grid_wproj_tiled_f(num_w_planes, support, oversample,
+                conv_size_half, conv_func, num_points, 0, uu, vv, ww, vis,
+                weight, cell_size_rad, w_scale, grid_size, num_skipped,
+                norm, grid))
+        return;
+
     /* Loop over visibilities. */
     *num_skipped = 0;
     for (i = 0; i < num_points; ++i)
@@ -211,6 +665,72 @@ void oskar_grid_wproj_f(
     }
 }
 
+
+void oskar_grid_wproj_sorted_d(
+        const size_t num_w_planes,
+        const int* restrict support,
+        const int oversample,
+        const int conv_size_half,
+        const double* restrict conv_func,
+        const size_t num_points,
+        const size_t* restrict tile_start,
+        const double* restrict uu,
+        const double* restrict vv,
+        const double* restrict ww,
+        const double* restrict vis,
+        const double* restrict weight,
+        const double cell_size_rad,
+        const double w_scale,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        double* restrict grid)
+{
+    /* Use the given tile boundaries if the tiled version is used. */
+    if (tile_start && oskar_grid_tiles_enabled(num_points) &&
+            oskar_grid_wproj_tiled_d(num_w_planes, support, oversample,
+                conv_size_half, conv_func, num_points, tile_start, uu, vv, ww,
+                vis, weight, cell_size_rad, w_scale, grid_size, num_skipped,
+                norm, grid))
+        return;
+    oskar_grid_wproj_d(num_w_planes, support, oversample, conv_size_half,
+            conv_func, num_points, uu, vv, ww, vis, weight, cell_size_rad,
+            w_scale, grid_size, num_skipped, norm, grid);
+}
+
+
+void oskar_grid_wproj_sorted_f(
+        const size_t num_w_planes,
+        const int* restrict support,
+        const int oversample,
+        const int conv_size_half,
+        const float* restrict conv_func,
+        const size_t num_points,
+        const size_t* restrict tile_start,
+        const float* restrict uu,
+        const float* restrict vv,
+        const float* restrict ww,
+        const float* restrict vis,
+        const float* restrict weight,
+        const float cell_size_rad,
+        const float w_scale,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        float* restrict grid)
+{
+    /* Use the given tile boundaries if the tiled version is used. */
+    if (tile_start && oskar_grid_tiles_enabled(num_points) &&
+            oskar_grid_wproj_tiled_f(num_w_planes, support, oversample,
+                conv_size_half, conv_func, num_points, tile_start, uu, vv, ww,
+                vis, weight, cell_size_rad, w_scale, grid_size, num_skipped,
+                norm, grid))
+        return;
+    oskar_grid_wproj_f(num_w_planes, support, oversample, conv_size_half,
+            conv_func, num_points, uu, vv, ww, vis, weight, cell_size_rad,
+            w_scale, grid_size, num_skipped, norm, grid);
+}
+
 #ifdef __cplusplus
 }
 #endif
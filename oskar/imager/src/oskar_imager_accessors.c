@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -55,6 +55,7 @@ const char* oskar_imager_algorithm(const oskar_Imager* h)
     {
     case OSKAR_ALGORITHM_FFT:    return "FFT";
     case OSKAR_ALGORITHM_WPROJ:  return "W-projection";
+    case OSKAR_ALGORITHM_WSTACK: return "W-stacking";
     case OSKAR_ALGORITHM_DFT_2D: return "DFT 2D";
     case OSKAR_ALGORITHM_DFT_3D: return "DFT 3D";
     default:                     return "";
@@ -62,6 +63,18 @@ const char* oskar_imager_algorithm(const oskar_Imager* h)
 }
 
 
+const char* oskar_imager_cache_file(const oskar_Imager* h)
+{
+    return h->cache_file;
+}
+
+
+int oskar_imager_cache_input_data(const oskar_Imager* h)
+{
+    return h->cache_input_data;
+}
+
+
 double oskar_imager_cellsize(const oskar_Imager* h)
 {
     return (h->cellsize_rad * (180.0 / M_PI)) * 3600.0;
@@ -227,6 +240,14 @@ void oskar_imager_set_algorithm(oskar_Imager* h, const char* type,
         h->support = 3;
         h->oversample = 100;
     }
+    else if (!strncmp(type, "W-S", 3) || !strncmp(type, "w-s", 3) ||
+            !strncmp(type, "W-s", 3))
+    {
+        h->algorithm = OSKAR_ALGORITHM_WSTACK;
+        h->kernel_type = 'S';
+        h->support = 3;
+        h->oversample = 100;
+    }
     else if (!strncmp(type, "W", 1) || !strncmp(type, "w", 1))
     {
         h->algorithm = OSKAR_ALGORITHM_WPROJ;
@@ -246,6 +267,26 @@ void oskar_imager_set_algorithm(oskar_Imager* h, const char* type,
 }
 
 
+void oskar_imager_set_cache_file(oskar_Imager* h, const char* filename)
+{
+    int len = 0;
+    free(h->cache_file);
+    h->cache_file = 0;
+    if (filename) len = (int) strlen(filename);
+    if (len > 0)
+    {
+        h->cache_file = calloc(1 + len, 1);
+        strcpy(h->cache_file, filename);
+    }
+}
+
+
+void oskar_imager_set_cache_input_data(oskar_Imager* h, int value)
+{
+    h->cache_input_data = value;
+}
+
+
 void oskar_imager_set_cellsize(oskar_Imager* h, double cellsize_arcsec)
 {
     h->set_cellsize = 1;
@@ -281,8 +322,10 @@ void oskar_imager_set_coords_only(oskar_Imager* h, int flag)
         if (h->ww_points > 0)
             h->ww_rms = sqrt(h->ww_rms / h->ww_points);
 
-        /* Calculate required number of w-planes if not set. */
-        if ((h->ww_max > 0.0) && (h->num_w_planes < 1))
+        /* Calculate required number of w-planes if not set.
+         * (The number of W-layers for W-stacking is set on initialisation.) */
+        if ((h->ww_max > 0.0) && (h->num_w_planes < 1) &&
+                h->algorithm == OSKAR_ALGORITHM_WPROJ)
         {
             double max_uvw, ww_mid;
             max_uvw = 1.05 * h->ww_max;
@@ -700,6 +743,20 @@ void oskar_imager_set_num_w_planes(oskar_Imager* h, int value)
 }
 
 
+void oskar_imager_set_w_kernel_dir(oskar_Imager* h, const char* dir_path)
+{
+    int len = 0;
+    free(h->w_kernel_dir);
+    h->w_kernel_dir = 0;
+    if (dir_path) len = (int) strlen(dir_path);
+    if (len > 0)
+    {
+        h->w_kernel_dir = calloc(1 + len, 1);
+        strcpy(h->w_kernel_dir, dir_path);
+    }
+}
+
+
 void oskar_imager_set_weighting(oskar_Imager* h, const char* type, int* status)
 {
     if (!strncmp(type, "N", 1) || !strncmp(type, "n", 1))
@@ -744,6 +801,12 @@ double oskar_imager_uv_filter_min(const oskar_Imager* h)
 }
 
 
+const char* oskar_imager_w_kernel_dir(const oskar_Imager* h)
+{
+    return h->w_kernel_dir;
+}
+
+
 const char* oskar_imager_weighting(const oskar_Imager* h)
 {
     switch (h->weighting)
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -32,6 +32,7 @@
 #include "imager/private_imager_init_dft.h"
 #include "imager/private_imager_init_fft.h"
 #include "imager/private_imager_init_wproj.h"
+#include "imager/private_imager_init_wstack.h"
 #include "utility/oskar_timer.h"
 
 #include <stdlib.h>
@@ -67,6 +68,12 @@ void oskar_imager_check_init(oskar_Imager* h, int* status)
             oskar_imager_init_wproj(h, status);
         break;
     }
+    case OSKAR_ALGORITHM_WSTACK:
+    {
+        if (!h->conv_func)
+            oskar_imager_init_wstack(h, status);
+        break;
+    }
     default:
         *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
     }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -30,6 +30,7 @@
 
 #include "imager/oskar_imager_accessors.h"
 #include "imager/oskar_imager_create.h"
+#include "imager/private_imager_wstack_layers.h"
 #include "utility/oskar_timer.h"
 
 #include <stdlib.h>
@@ -41,6 +42,7 @@ extern "C" {
 
 oskar_Imager* oskar_imager_create(int imager_precision, int* status)
 {
+    int i;
     oskar_Imager* h = 0;
     h = (oskar_Imager*) calloc(1, sizeof(oskar_Imager));
 
@@ -49,6 +51,7 @@ oskar_Imager* oskar_imager_create(int imager_precision, int* status)
     h->tmr_grid_update = oskar_timer_create(OSKAR_TIMER_NATIVE);
     h->tmr_init = oskar_timer_create(OSKAR_TIMER_NATIVE);
     h->tmr_read = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    h->tmr_sort = oskar_timer_create(OSKAR_TIMER_NATIVE);
     h->tmr_write = oskar_timer_create(OSKAR_TIMER_NATIVE);
     h->mutex = oskar_mutex_create();
 
@@ -65,6 +68,19 @@ oskar_Imager* oskar_imager_create(int imager_precision, int* status)
     h->weight_im   = oskar_mem_create(imager_precision, OSKAR_CPU, 0, status);
     h->weight_tmp  = oskar_mem_create(imager_precision, OSKAR_CPU, 0, status);
     h->time_im     = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    h->uu_sort     = oskar_mem_create(imager_precision, OSKAR_CPU, 0, status);
+    h->vv_sort     = oskar_mem_create(imager_precision, OSKAR_CPU, 0, status);
+    h->ww_sort     = oskar_mem_create(imager_precision, OSKAR_CPU, 0, status);
+    h->vis_sort    = oskar_mem_create(imager_precision | OSKAR_COMPLEX,
+            OSKAR_CPU, 0, status);
+    h->weight_sort = oskar_mem_create(imager_precision, OSKAR_CPU, 0, status);
+    for (i = 0; i < 4; ++i)
+    {
+        h->vis_pol[i] = oskar_mem_create(imager_precision | OSKAR_COMPLEX,
+                OSKAR_CPU, 0, status);
+        h->weight_pol[i] = oskar_mem_create(imager_precision,
+                OSKAR_CPU, 0, status);
+    }
 
     /* Check data type. */
     if (imager_precision != OSKAR_SINGLE && imager_precision != OSKAR_DOUBLE)
@@ -85,6 +101,7 @@ oskar_Imager* oskar_imager_create(int imager_precision, int* status)
     oskar_imager_set_fov(h, 1.0);
     oskar_imager_set_size(h, 256, status);
     oskar_imager_set_uv_filter_max(h, DBL_MAX);
+    h->w_layer_max_bytes = OSKAR_IMAGER_MAX_W_LAYER_BYTES;
     return h;
 }
 
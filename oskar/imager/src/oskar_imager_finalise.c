@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -26,18 +26,14 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
-#ifdef OSKAR_HAVE_CUDA
-#include <cufft.h>
-#endif
-
 #include "imager/private_imager.h"
 #include "imager/oskar_imager.h"
 
 #include "imager/oskar_grid_correction.h"
 #include "imager/oskar_grid_functions_pillbox.h"
 #include "imager/oskar_grid_functions_spheroidal.h"
-#include "math/oskar_fftpack_cfft.h"
-#include "math/oskar_fftpack_cfft_f.h"
+#include "imager/private_imager_finalise_plane_wstack.h"
+#include "math/oskar_fft.h"
 #include "math/oskar_fftphase.h"
 #include "mem/oskar_mem.h"
 #include "utility/oskar_device_utils.h"
@@ -96,6 +92,12 @@ void oskar_imager_finalise(oskar_Imager* h,
                     plane_size, h->image_size, status);
         }
 
+        /* Report extra FFTs needed because of the W-layer memory limit. */
+        if (h->log && h->w_layer_num_flushes > 0)
+            oskar_log_warning(h->log, "W-layer memory limit was reached "
+                    "%d time(s) while gridding: %d layer FFTs were needed.",
+                    h->w_layer_num_flushes, h->w_layer_num_ffts);
+
         /* Copy images to output image planes if given. */
         for (i = 0; (i < h->num_planes) && (i < num_output_images); ++i)
         {
@@ -128,6 +130,8 @@ void oskar_imager_finalise(oskar_Imager* h,
                 oskar_timer_elapsed(h->tmr_init));
         oskar_log_value(h->log, 'M', 0, "Grid update", "%.3f s",
                 oskar_timer_elapsed(h->tmr_grid_update));
+        oskar_log_value(h->log, 'M', 1, "Sort visibilities", "%.3f s",
+                oskar_timer_elapsed(h->tmr_sort));
         oskar_log_value(h->log, 'M', 0, "Grid finalise", "%.3f s",
                 oskar_timer_elapsed(h->tmr_grid_finalise));
         oskar_log_value(h->log, 'M', 0, "Read visibility data", "%.3f s",
@@ -181,8 +185,10 @@ void oskar_imager_finalise_plane(oskar_Imager* h,
     size_t num_cells;
     if (*status) return;
 
-    /* Apply normalisation. */
-    if (plane_norm > 0.0 || plane_norm < 0.0)
+    /* Apply normalisation. With W-stacking, this is done after the
+     * transformed layers have been summed. */
+    if ((plane_norm > 0.0 || plane_norm < 0.0) &&
+            h->algorithm != OSKAR_ALGORITHM_WSTACK)
     {
         oskar_timer_resume(h->tmr_grid_finalise);
         oskar_mem_scale_real(plane, 1.0 / plane_norm, status);
@@ -210,75 +216,41 @@ void oskar_imager_finalise_plane(oskar_Imager* h,
         return;
     }
 
-    /* Perform FFT shift of the input grid. */
+    /* Create the FFT plan if required. */
     oskar_timer_resume(h->tmr_grid_finalise);
-    if (oskar_mem_precision(plane) == OSKAR_DOUBLE)
-        oskar_fftphase_cd(size, size, oskar_mem_double(plane, status));
-    else
-        oskar_fftphase_cf(size, size, oskar_mem_float(plane, status));
-
-    /* Call FFT. */
-#ifdef OSKAR_HAVE_CUDA
-    if (h->fft_on_gpu && h->num_gpus > 0)
+    if (!h->fft)
     {
-        size_t work_size = 0;
-        oskar_Mem *plane_gpu = 0, *plane_ptr = 0;
-        oskar_device_set(h->gpu_ids[0], status);
-        if (cufftGetSize(h->cufft_plan, &work_size) != CUFFT_SUCCESS)
-            cufftPlan2d(&h->cufft_plan, size, size,
-                    (h->imager_prec == OSKAR_DOUBLE) ? CUFFT_Z2Z : CUFFT_C2C);
-        plane_ptr = plane;
-        if (oskar_mem_location(plane) != OSKAR_GPU)
+        int location = OSKAR_CPU;
+        if (h->fft_on_gpu && h->num_gpus > 0)
         {
-            plane_gpu = oskar_mem_create_copy(plane, OSKAR_GPU, status);
-            plane_ptr = plane_gpu;
+            location = OSKAR_GPU;
+            oskar_device_set(h->gpu_ids[0], status);
         }
-        if (h->imager_prec == OSKAR_DOUBLE)
-            cufftExecZ2Z(h->cufft_plan, oskar_mem_void(plane_ptr),
-                    oskar_mem_void(plane_ptr), CUFFT_FORWARD);
-        else
-            cufftExecC2C(h->cufft_plan, oskar_mem_void(plane_ptr),
-                    oskar_mem_void(plane_ptr), CUFFT_FORWARD);
-        if (oskar_mem_location(plane) != OSKAR_GPU)
-            oskar_mem_copy(plane, plane_ptr, status);
-        oskar_mem_free(plane_gpu, status);
+        h->fft = oskar_fft_create(h->imager_prec, location, 2, size, 0,
+                status);
     }
+    else if (h->fft_on_gpu && h->num_gpus > 0)
+        oskar_device_set(h->gpu_ids[0], status);
+
+    /* Perform FFT shift of the input grid, and call FFT.
+     * With W-stacking, this is done for each W-layer, and the results
+     * are summed into the plane after applying the W-phase screens. */
+    if (h->algorithm == OSKAR_ALGORITHM_WSTACK)
+        oskar_imager_finalise_plane_wstack(h, plane, plane_norm, status);
     else
-#endif
     {
-        if (!h->fftpack_work)
-            h->fftpack_work = oskar_mem_create(h->imager_prec, OSKAR_CPU,
-                    2 * num_cells, status);
-        if (!h->fftpack_wsave)
-        {
-            int len = 4 * size + 2 * (int)(log((double)size) / log(2.0)) + 8;
-            h->fftpack_wsave = oskar_mem_create(h->imager_prec, OSKAR_CPU,
-                    len, status);
-            if (h->imager_prec == OSKAR_DOUBLE)
-                oskar_fftpack_cfft2i(size, size,
-                        oskar_mem_double(h->fftpack_wsave, status));
-            else
-                oskar_fftpack_cfft2i_f(size, size,
-                        oskar_mem_float(h->fftpack_wsave, status));
-        }
-        if (h->imager_prec == OSKAR_DOUBLE)
-            oskar_fftpack_cfft2f(size, size, size,
-                    oskar_mem_double(plane, status),
-                    oskar_mem_double(h->fftpack_wsave, status),
-                    oskar_mem_double(h->fftpack_work, status));
+        if (oskar_mem_precision(plane) == OSKAR_DOUBLE)
+            oskar_fftphase_cd(size, size, oskar_mem_double(plane, status));
         else
-            oskar_fftpack_cfft2f_f(size, size, size,
-                    oskar_mem_float(plane, status),
-                    oskar_mem_float(h->fftpack_wsave, status),
-                    oskar_mem_float(h->fftpack_work, status));
-        oskar_mem_scale_real(plane, (double)num_cells, status);
+            oskar_fftphase_cf(size, size, oskar_mem_float(plane, status));
+        oskar_fft_exec(h->fft, plane, status);
     }
 
     /* Generate grid correction function if required. */
     if (!h->corr_func)
     {
         h->corr_func = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, size, status);
-        if (h->algorithm != OSKAR_ALGORITHM_FFT)
+        if (h->algorithm == OSKAR_ALGORITHM_WPROJ)
             oskar_grid_correction_function_spheroidal(size, h->oversample,
                     oskar_mem_double(h->corr_func, status));
         else
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -44,6 +44,7 @@ void oskar_imager_free(oskar_Imager* h, int* status)
     int i;
     if (!h) return;
     oskar_imager_reset_cache(h, status);
+    oskar_thread_pool_free(h->pool);
     oskar_mem_free(h->uu_im, status);
     oskar_mem_free(h->vv_im, status);
     oskar_mem_free(h->ww_im, status);
@@ -54,10 +55,22 @@ void oskar_imager_free(oskar_Imager* h, int* status)
     oskar_mem_free(h->weight_im, status);
     oskar_mem_free(h->weight_tmp, status);
     oskar_mem_free(h->time_im, status);
+    oskar_mem_free(h->uu_sort, status);
+    oskar_mem_free(h->vv_sort, status);
+    oskar_mem_free(h->ww_sort, status);
+    oskar_mem_free(h->vis_sort, status);
+    oskar_mem_free(h->weight_sort, status);
+    free(h->tile_start);
+    for (i = 0; i < 4; ++i)
+    {
+        oskar_mem_free(h->vis_pol[i], status);
+        oskar_mem_free(h->weight_pol[i], status);
+    }
     oskar_timer_free(h->tmr_grid_finalise);
     oskar_timer_free(h->tmr_grid_update);
     oskar_timer_free(h->tmr_init);
     oskar_timer_free(h->tmr_read);
+    oskar_timer_free(h->tmr_sort);
     oskar_timer_free(h->tmr_write);
     oskar_mutex_free(h->mutex);
 
@@ -73,6 +86,8 @@ void oskar_imager_free(oskar_Imager* h, int* status)
     free(h->input_root);
     free(h->output_root);
     free(h->ms_column);
+    free(h->cache_file);
+    free(h->w_kernel_dir);
     free(h->gpu_ids);
     free(h->d);
     free(h);
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -26,12 +26,11 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
-#ifdef OSKAR_HAVE_CUDA
-#include <cufft.h>
-#endif
-
 #include "imager/private_imager.h"
 #include "imager/oskar_imager_reset_cache.h"
+#include "imager/private_imager_cache.h"
+#include "imager/private_imager_queue.h"
+#include "imager/private_imager_wstack_layers.h"
 #include <fitsio.h>
 
 #include <stdlib.h>
@@ -44,6 +43,9 @@ void oskar_imager_reset_cache(oskar_Imager* h, int* status)
 {
     int i;
 
+    /* Stop the gridder thread, if it is still running. */
+    oskar_imager_queue_finish(h, status);
+
     /* Clear selected axes. */
     free(h->sel_freqs);
     free(h->im_freqs);
@@ -54,15 +56,9 @@ void oskar_imager_reset_cache(oskar_Imager* h, int* status)
 
     /* Clear FFT caches. */
     oskar_mem_free(h->corr_func, status);
-    oskar_mem_free(h->fftpack_wsave, status);
-    oskar_mem_free(h->fftpack_work, status);
-#ifdef OSKAR_HAVE_CUDA
-    cufftDestroy(h->cufft_plan);
-    h->cufft_plan = 0;
-#endif
+    oskar_fft_free(h->fft);
     h->corr_func = 0;
-    h->fftpack_wsave = 0;
-    h->fftpack_work = 0;
+    h->fft = 0;
 
     /* Clear algorithm-specific caches. */
     oskar_mem_free(h->l, status); h->l = 0;
@@ -73,6 +69,9 @@ void oskar_imager_reset_cache(oskar_Imager* h, int* status)
     oskar_mem_free(h->w_support, status); h->w_support = 0;
     oskar_mem_free(h->w_kernels_compact, status); h->w_kernels_compact = 0;
     oskar_mem_free(h->w_kernel_start, status); h->w_kernel_start = 0;
+    oskar_imager_wstack_layers_free(h, status);
+    h->w_layer_start = h->w_layer_end = 0;
+    h->w_layer_num_flushes = h->w_layer_num_ffts = 0;
 
     /* Free the image planes. */
     if (h->planes)
@@ -100,9 +99,23 @@ void oskar_imager_reset_cache(oskar_Imager* h, int* status)
     oskar_mem_realloc(h->vis_im, 0, status);
     oskar_mem_realloc(h->weight_im, 0, status);
     oskar_mem_realloc(h->weight_tmp, 0, status);
+    oskar_mem_realloc(h->uu_sort, 0, status);
+    oskar_mem_realloc(h->vv_sort, 0, status);
+    oskar_mem_realloc(h->ww_sort, 0, status);
+    oskar_mem_realloc(h->vis_sort, 0, status);
+    oskar_mem_realloc(h->weight_sort, 0, status);
+    free(h->tile_start);
+    h->tile_start = 0;
+    h->num_tiles = 0;
+    for (i = 0; i < 4; ++i)
+    {
+        oskar_mem_realloc(h->vis_pol[i], 0, status);
+        oskar_mem_realloc(h->weight_pol[i], 0, status);
+    }
     oskar_mem_realloc(h->time_im, 0, status);
     oskar_mem_free(h->stokes, status);
     h->stokes = 0;
+    oskar_imager_cache_close(h);
 
     /* Close any open FITS files. */
     for (i = 0; i < h->num_im_pols; ++i)
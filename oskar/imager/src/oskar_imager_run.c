@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,9 +27,13 @@
  */
 
 #include "imager/private_imager.h"
+#include "imager/private_imager_cache.h"
+#include "imager/private_imager_queue.h"
 #include "imager/private_imager_read_coords.h"
 #include "imager/private_imager_read_data.h"
 #include "imager/private_imager_read_dims.h"
+#include "imager/private_imager_finalise_plane_wstack.h"
+#include "imager/private_imager_wstack_layers.h"
 #include "imager/oskar_imager.h"
 
 #include <stdlib.h>
@@ -46,6 +50,7 @@ void oskar_imager_run(oskar_Imager* h,
         int num_output_grids, oskar_Mem** output_grids, int* status)
 {
     int i, num_files, percent_done = 0, percent_next = 10;
+    int pass, num_passes = 1, layers_per_pass = 0;
     const char* filename;
     if (*status) return;
 
@@ -102,11 +107,23 @@ void oskar_imager_run(oskar_Imager* h,
 
     /* Read baseline coordinates and weights if required. */
     if (h->weighting == OSKAR_WEIGHTING_UNIFORM ||
-            h->algorithm == OSKAR_ALGORITHM_WPROJ)
+            h->algorithm == OSKAR_ALGORITHM_WPROJ ||
+            h->algorithm == OSKAR_ALGORITHM_WSTACK)
     {
-        oskar_imager_set_coords_only(h, 1);
-        if (h->log)
+        /* If required, read the visibility data as well, and cache it
+         * so the input files are only read once. */
+        if (h->cache_input_data)
+        {
+            oskar_imager_cache_open(h, status);
+            if (h->log && !*status)
+                oskar_log_section(h->log, 'M', "Reading input data...");
+            else if (h->log)
+                oskar_log_error(h->log, "Error opening cache file '%s'",
+                        h->cache_file ? h->cache_file : "(temporary)");
+        }
+        else if (h->log)
             oskar_log_section(h->log, 'M', "Reading coordinates...");
+        oskar_imager_set_coords_only(h, 1);
 
         /* Loop over input files. */
         for (i = 0; i < num_files; ++i)
@@ -117,11 +134,23 @@ void oskar_imager_run(oskar_Imager* h,
             if (h->log)
                 oskar_log_message(h->log, 'M', 0, "Opening '%s'", filename);
             if (oskar_imager_is_ms(filename))
-                oskar_imager_read_coords_ms(h, filename, i, num_files,
-                        &percent_done, &percent_next, status);
+            {
+                if (h->cache)
+                    oskar_imager_read_data_ms(h, filename, i, num_files,
+                            &percent_done, &percent_next, status);
+                else
+                    oskar_imager_read_coords_ms(h, filename, i, num_files,
+                            &percent_done, &percent_next, status);
+            }
             else
-                oskar_imager_read_coords_vis(h, filename, i, num_files,
-                        &percent_done, &percent_next, status);
+            {
+                if (h->cache)
+                    oskar_imager_read_data_vis(h, filename, i, num_files,
+                            &percent_done, &percent_next, status);
+                else
+                    oskar_imager_read_coords_vis(h, filename, i, num_files,
+                            &percent_done, &percent_next, status);
+            }
         }
         oskar_imager_set_coords_only(h, 0);
     }
@@ -141,35 +170,88 @@ void oskar_imager_run(oskar_Imager* h,
     {
         oskar_log_message(h->log, 'M', 0, "Plane size is %d x %d.",
                 oskar_imager_plane_size(h), oskar_imager_plane_size(h));
-        if (h->algorithm == OSKAR_ALGORITHM_WPROJ)
+        if (h->algorithm == OSKAR_ALGORITHM_WPROJ ||
+                h->algorithm == OSKAR_ALGORITHM_WSTACK)
         {
             oskar_log_message(h->log, 'M', 0,
                     "Baseline W values (wavelengths)");
             oskar_log_message(h->log, 'M', 1, "Min: %.12e", h->ww_min);
             oskar_log_message(h->log, 'M', 1, "Max: %.12e", h->ww_max);
             oskar_log_message(h->log, 'M', 1, "RMS: %.12e", h->ww_rms);
-            oskar_log_message(h->log, 'M', 0, "Using %d W-planes.",
-                    oskar_imager_num_w_planes(h));
+            oskar_log_message(h->log, 'M', 0, "Using %d W-%s.",
+                    oskar_imager_num_w_planes(h),
+                    h->algorithm == OSKAR_ALGORITHM_WSTACK ?
+                            "layers" : "planes");
         }
         oskar_log_section(h->log, 'M', "Reading visibility data...");
     }
 
-    /* Loop over input files. */
-    percent_done = 0; percent_next = 10;
-    for (i = 0; i < num_files; ++i)
+    /* If the W-layers for all the planes do not fit in the memory limit,
+     * read the input data several times, and grid only a range of layers
+     * in each pass. Each layer is then still transformed only once. */
+    if (h->algorithm == OSKAR_ALGORITHM_WSTACK && !*status)
+    {
+        num_passes = oskar_imager_wstack_num_passes(h);
+        layers_per_pass = oskar_imager_wstack_max_layers(h);
+        if (num_passes > 1 && h->log)
+            oskar_log_warning(h->log, "W-layers exceed the memory limit of "
+                    "%.2f GiB: reading input data in %d passes.",
+                    h->w_layer_max_bytes / (double) (1 << 30), num_passes);
+    }
+
+    for (pass = 0; pass < num_passes; ++pass)
     {
-        /* Read visibility data. */
         if (*status) break;
-        filename = h->input_files[i];
-        if (h->log)
-            oskar_log_message(h->log, 'M', 0, "Opening '%s'", filename);
-        if (oskar_imager_is_ms(filename))
-            oskar_imager_read_data_ms(h, filename, i, num_files,
-                    &percent_done, &percent_next, status);
-        else
-            oskar_imager_read_data_vis(h, filename, i, num_files,
-                    &percent_done, &percent_next, status);
+        if (num_passes > 1)
+        {
+            h->w_layer_start = pass * layers_per_pass;
+            h->w_layer_end = h->w_layer_start + layers_per_pass;
+            if (h->w_layer_end > h->num_w_planes)
+                h->w_layer_end = h->num_w_planes;
+            if (h->log)
+                oskar_log_message(h->log, 'M', 0,
+                        "Pass %d of %d: W-layers %d to %d", pass + 1,
+                        num_passes, h->w_layer_start, h->w_layer_end - 1);
+        }
+
+        /* Grid in a separate thread, so that reading overlaps with
+         * gridding. */
+        oskar_imager_queue_start(h, status);
+
+        /* Use the cached data if it exists. */
+        percent_done = 0; percent_next = 10;
+        if (h->cache)
+        {
+            if (h->log)
+                oskar_log_message(h->log, 'M', 0, "Using cached input data");
+            oskar_imager_cache_replay(h, &percent_done, &percent_next,
+                    status);
+        }
+
+        /* Otherwise, loop over input files. */
+        for (i = 0; i < num_files && !h->cache; ++i)
+        {
+            /* Read visibility data. */
+            if (*status) break;
+            filename = h->input_files[i];
+            if (h->log)
+                oskar_log_message(h->log, 'M', 0, "Opening '%s'", filename);
+            if (oskar_imager_is_ms(filename))
+                oskar_imager_read_data_ms(h, filename, i, num_files,
+                        &percent_done, &percent_next, status);
+            else
+                oskar_imager_read_data_vis(h, filename, i, num_files,
+                        &percent_done, &percent_next, status);
+        }
+
+        /* Wait for the gridder to finish, and add the layers from this
+         * pass to the planes. */
+        oskar_imager_queue_finish(h, status);
+        if (num_passes > 1)
+            oskar_imager_flush_wstack(h, status);
     }
+    h->w_layer_start = h->w_layer_end = 0;
+    oskar_imager_cache_close(h);
 
     /* Check for errors. */
     if (*status)
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -31,14 +31,18 @@
 #include "convert/oskar_convert_ecef_to_baseline_uvw.h"
 #include "imager/oskar_grid_weights.h"
 #include "imager/oskar_imager.h"
+#include "imager/private_imager_cache.h"
 #include "imager/private_imager_create_fits_files.h"
 #include "imager/private_imager_filter_time.h"
 #include "imager/private_imager_filter_uv.h"
 #include "imager/private_imager_set_num_planes.h"
 #include "imager/private_imager_select_data.h"
+#include "imager/private_imager_sort_vis.h"
+#include "imager/private_imager_update_multi.h"
 #include "imager/private_imager_update_plane_dft.h"
 #include "imager/private_imager_update_plane_fft.h"
 #include "imager/private_imager_update_plane_wproj.h"
+#include "imager/private_imager_update_plane_wstack.h"
 #include "imager/private_imager_weight_radial.h"
 #include "imager/private_imager_weight_uniform.h"
 
@@ -197,6 +201,11 @@ void oskar_imager_update(oskar_Imager* h, size_t num_rows, int start_chan,
         return;
     }
 
+    /* Keep the visibility data for the second pass if required. */
+    if (h->coords_only && h->cache && amps)
+        oskar_imager_cache_write(h, num_rows, start_chan, end_chan, num_pols,
+                uu, vv, ww, amps, weight, time_centroid, status);
+
     /* Ensure image/grid planes exist and algorithm has been initialised. */
     oskar_imager_set_num_planes(h, status);
     oskar_imager_check_init(h, status);
@@ -262,8 +271,18 @@ void oskar_imager_update(oskar_Imager* h, size_t num_rows, int start_chan,
         oskar_mem_realloc(h->ww_tmp, max_num_vis, status);
     }
 
+    /* Grid all polarisations of each channel together if possible. */
+    if (oskar_imager_update_multi_enabled(h))
+    {
+        oskar_imager_update_multi(h, num_rows, start_chan, end_chan,
+                num_pols, u_in, v_in, w_in, amp_in, weight_in,
+                time_centroid, status);
+        c = h->num_im_channels; /* Skip the loop below. */
+    }
+    else c = 0;
+
     /* Loop over each image plane being made. */
-    for (c = 0; c < h->num_im_channels; ++c)
+    for (; c < h->num_im_channels; ++c)
     {
         for (p = 0; p < h->num_im_pols; ++p)
         {
@@ -403,6 +422,9 @@ void oskar_imager_update_plane(oskar_Imager* h, size_t num_vis,
             break;
         }
 
+        /* Sort visibilities by W-plane and grid tile for the gridders. */
+        oskar_imager_sort_vis(h, num_vis, &pu, &pv, &pw, &pa, &ph, status);
+
         /* Update the supplied plane with the supplied visibilities. */
         switch (h->algorithm)
         {
@@ -419,6 +441,10 @@ void oskar_imager_update_plane(oskar_Imager* h, size_t num_vis,
             oskar_imager_update_plane_wproj(h, num_vis, pu, pv, pw, pa, ph,
                     plane, plane_norm, &num_skipped, status);
             break;
+        case OSKAR_ALGORITHM_WSTACK:
+            oskar_imager_update_plane_wstack(h, num_vis, pu, pv, pw, pa, ph,
+                    plane, plane_norm, &num_skipped, status);
+            break;
         default:
             *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
             break;
@@ -478,7 +504,8 @@ void oskar_imager_update_weights_grid(oskar_Imager* h, size_t num_points,
     }
 
     /* Update baseline W minimum, maximum and RMS. */
-    if (h->algorithm == OSKAR_ALGORITHM_WPROJ)
+    if (h->algorithm == OSKAR_ALGORITHM_WPROJ ||
+            h->algorithm == OSKAR_ALGORITHM_WSTACK)
     {
         size_t j;
         double val;
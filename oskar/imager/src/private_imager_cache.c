@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/private_imager_cache.h"
+#include "imager/private_imager_queue.h"
+#include "imager/oskar_imager.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Each record in the cache starts with its kind.
+ *
+ * A header record holds the visibility meta-data of one input file:
+ * the start frequency, channel increment, number of channels and phase
+ * centre. It is written before the data records of the file.
+ *
+ * A data record holds the arguments of one call to oskar_imager_update():
+ * the dimensions, followed by each array as its type, number of elements
+ * and raw data. All the rows in the block are written, with all channels
+ * from start_chan to end_chan and all polarisations.
+ *
+ * The number of bytes written and read is counted, rather than using
+ * ftell(), which returns a long and so fails for files larger than 2 GiB
+ * on platforms where long is 32 bits. */
+
+enum { RECORD_HEADER = 1, RECORD_DATA = 2 };
+
+static void write_mem(FILE* f, const oskar_Mem* mem, size_t num_elements,
+        size_t* bytes_written, int* status)
+{
+    int type = 0;
+    size_t bytes = 0;
+    if (*status) return;
+    if (mem)
+    {
+        type = oskar_mem_type(mem);
+        if (num_elements > oskar_mem_length(mem))
+            num_elements = oskar_mem_length(mem);
+        bytes = num_elements * oskar_mem_element_size(type);
+    }
+    else num_elements = 0;
+    if (fwrite(&type, sizeof(int), 1, f) != 1 ||
+            fwrite(&num_elements, sizeof(size_t), 1, f) != 1 ||
+            (bytes > 0 && fwrite(oskar_mem_void_const(mem), 1, bytes, f) !=
+                    bytes))
+        *status = OSKAR_ERR_FILE_IO;
+    *bytes_written += sizeof(int) + sizeof(size_t) + bytes;
+}
+
+static const oskar_Mem* read_mem(FILE* f, oskar_Mem** mem,
+        size_t* bytes_read, int* status)
+{
+    int type = 0;
+    size_t num_elements = 0, bytes;
+    if (*status) return 0;
+    if (fread(&type, sizeof(int), 1, f) != 1 ||
+            fread(&num_elements, sizeof(size_t), 1, f) != 1)
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        return 0;
+    }
+    *bytes_read += sizeof(int) + sizeof(size_t);
+    if (type == 0) return 0;
+
+    /* Re-use the array from the previous record if possible. */
+    if (*mem && oskar_mem_type(*mem) != type)
+    {
+        oskar_mem_free(*mem, status);
+        *mem = 0;
+    }
+    if (!*mem)
+        *mem = oskar_mem_create(type, OSKAR_CPU, num_elements, status);
+    else if (oskar_mem_length(*mem) < num_elements)
+        oskar_mem_realloc(*mem, num_elements, status);
+    if (*status) return 0;
+    bytes = num_elements * oskar_mem_element_size(type);
+    if (bytes > 0 && fread(oskar_mem_void(*mem), 1, bytes, f) != bytes)
+        *status = OSKAR_ERR_FILE_IO;
+    *bytes_read += bytes;
+    return *mem;
+}
+
+
+void oskar_imager_cache_open(oskar_Imager* h, int* status)
+{
+    if (*status) return;
+    oskar_imager_cache_close(h);
+    h->cache = h->cache_file ? fopen(h->cache_file, "w+b") : tmpfile();
+    h->cache_size = 0;
+    if (!h->cache)
+        *status = OSKAR_ERR_FILE_IO;
+}
+
+
+void oskar_imager_cache_write_header(oskar_Imager* h, double freq_start_hz,
+        double freq_inc_hz, int num_channels, double ra_deg, double dec_deg,
+        int* status)
+{
+    const int kind = RECORD_HEADER;
+    double meta[4];
+    if (*status || !h->cache) return;
+    oskar_timer_resume(h->tmr_read);
+    meta[0] = freq_start_hz;
+    meta[1] = freq_inc_hz;
+    meta[2] = ra_deg;
+    meta[3] = dec_deg;
+    if (fwrite(&kind, sizeof(int), 1, h->cache) != 1 ||
+            fwrite(meta, sizeof(double), 4, h->cache) != 4 ||
+            fwrite(&num_channels, sizeof(int), 1, h->cache) != 1)
+        *status = OSKAR_ERR_FILE_IO;
+    h->cache_size += 2 * sizeof(int) + sizeof(meta);
+    oskar_timer_pause(h->tmr_read);
+}
+
+
+void oskar_imager_cache_write(oskar_Imager* h, size_t num_rows,
+        int start_chan, int end_chan, int num_pols, const oskar_Mem* uu,
+        const oskar_Mem* vv, const oskar_Mem* ww, const oskar_Mem* amps,
+        const oskar_Mem* weight, const oskar_Mem* time_centroid,
+        int* status)
+{
+    const int kind = RECORD_DATA;
+    int dims[3];
+    size_t num_amps;
+    if (*status || !h->cache) return;
+    oskar_timer_resume(h->tmr_read);
+    dims[0] = start_chan;
+    dims[1] = end_chan;
+    dims[2] = num_pols;
+    num_amps = num_rows * (1 + end_chan - start_chan);
+    if (amps && !oskar_mem_is_matrix(amps)) num_amps *= num_pols;
+    if (fwrite(&kind, sizeof(int), 1, h->cache) != 1 ||
+            fwrite(&num_rows, sizeof(size_t), 1, h->cache) != 1 ||
+            fwrite(dims, sizeof(int), 3, h->cache) != 3)
+        *status = OSKAR_ERR_FILE_IO;
+    h->cache_size += sizeof(int) + sizeof(size_t) + sizeof(dims);
+    write_mem(h->cache, uu, num_rows, &h->cache_size, status);
+    write_mem(h->cache, vv, num_rows, &h->cache_size, status);
+    write_mem(h->cache, ww, num_rows, &h->cache_size, status);
+    write_mem(h->cache, amps, num_amps, &h->cache_size, status);
+    write_mem(h->cache, weight, num_rows * num_pols, &h->cache_size, status);
+    write_mem(h->cache, time_centroid, num_rows, &h->cache_size, status);
+    oskar_timer_pause(h->tmr_read);
+}
+
+
+void oskar_imager_cache_replay(oskar_Imager* h, int* percent_done,
+        int* percent_next, int* status)
+{
+    oskar_Mem *uu = 0, *vv = 0, *ww = 0, *amps = 0, *weight = 0, *time = 0;
+    size_t bytes_read = 0;
+    if (*status || !h->cache) return;
+    rewind(h->cache);
+    for (;;)
+    {
+        int kind = 0, dims[3];
+        size_t num_rows = 0;
+        const oskar_Mem *pu, *pv, *pw, *pa, *ph, *pt;
+        if (*status) break;
+
+        /* Read the next record. */
+        oskar_timer_resume(h->tmr_read);
+        if (fread(&kind, sizeof(int), 1, h->cache) != 1)
+        {
+            oskar_timer_pause(h->tmr_read);
+            if (!feof(h->cache)) *status = OSKAR_ERR_FILE_IO;
+            break;
+        }
+        bytes_read += sizeof(int);
+        if (kind == RECORD_HEADER)
+        {
+            int num_channels = 0;
+            double meta[4];
+            if (fread(meta, sizeof(double), 4, h->cache) != 4 ||
+                    fread(&num_channels, sizeof(int), 1, h->cache) != 1)
+                *status = OSKAR_ERR_FILE_IO;
+            bytes_read += sizeof(int) + sizeof(meta);
+            oskar_timer_pause(h->tmr_read);
+
+            /* Restore the meta-data for the data records that follow. */
+            oskar_imager_queue_set_vis_meta(h, meta[0], meta[1],
+                    num_channels, meta[2], meta[3], status);
+            continue;
+        }
+        if (kind != RECORD_DATA ||
+                fread(&num_rows, sizeof(size_t), 1, h->cache) != 1 ||
+                fread(dims, sizeof(int), 3, h->cache) != 3)
+            *status = OSKAR_ERR_FILE_IO;
+        bytes_read += sizeof(size_t) + sizeof(dims);
+        pu = read_mem(h->cache, &uu, &bytes_read, status);
+        pv = read_mem(h->cache, &vv, &bytes_read, status);
+        pw = read_mem(h->cache, &ww, &bytes_read, status);
+        pa = read_mem(h->cache, &amps, &bytes_read, status);
+        ph = read_mem(h->cache, &weight, &bytes_read, status);
+        pt = read_mem(h->cache, &time, &bytes_read, status);
+        oskar_timer_pause(h->tmr_read);
+
+        /* Update the imager with the data. */
+        oskar_imager_queue_update(h, num_rows,
+                dims[0], dims[1], dims[2], pu, pv, pw, pa, ph, pt, status);
+        if (h->cache_size > 0)
+            *percent_done = (int) round(100.0 *
+                    bytes_read / (double) h->cache_size);
+        if (h->log && percent_next && *percent_done >= *percent_next)
+        {
+            oskar_log_message(h->log, 'S', -2, "%3d%% ...", *percent_done);
+            *percent_next = 10 + 10 * (*percent_done / 10);
+        }
+    }
+    oskar_mem_free(uu, status);
+    oskar_mem_free(vv, status);
+    oskar_mem_free(ww, status);
+    oskar_mem_free(amps, status);
+    oskar_mem_free(weight, status);
+    oskar_mem_free(time, status);
+}
+
+
+void oskar_imager_cache_close(oskar_Imager* h)
+{
+    if (!h->cache) return;
+    fclose(h->cache);
+    h->cache = 0;
+    h->cache_size = 0;
+    if (h->cache_file)
+        remove(h->cache_file);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/private_imager_finalise_plane_wstack.h"
+#include "imager/private_imager_wstack_layers.h"
+#include "math/oskar_cmath.h"
+#include "math/oskar_fft.h"
+#include "math/oskar_fftphase.h"
+#include "utility/oskar_device_utils.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Applies the W-phase screen to one transformed layer. */
+static void apply_screen_d(size_t num_cells, const double* restrict nm1,
+        double w, double* restrict layer)
+{
+    size_t i;
+    const double f = -2.0 * M_PI * w;
+    for (i = 0; i < num_cells; ++i)
+    {
+        double re, im, s, c;
+        const double phase = f * nm1[i];
+        s = sin(phase);
+        c = cos(phase);
+        re = layer[2*i];
+        im = layer[2*i + 1];
+        layer[2*i]     = re * c - im * s;
+        layer[2*i + 1] = re * s + im * c;
+    }
+}
+
+static void apply_screen_f(size_t num_cells, const double* restrict nm1,
+        double w, float* restrict layer)
+{
+    size_t i;
+    const double f = -2.0 * M_PI * w;
+    for (i = 0; i < num_cells; ++i)
+    {
+        float re, im, s, c;
+        const double phase = f * nm1[i];
+        s = (float) sin(phase);
+        c = (float) cos(phase);
+        re = layer[2*i];
+        im = layer[2*i + 1];
+        layer[2*i]     = re * c - im * s;
+        layer[2*i + 1] = re * s + im * c;
+    }
+}
+
+/*
+ * Adds the transformed layers to the plane. Each thread sums all the
+ * layers for its own rows of the plane, so no locking is needed.
+ */
+static void sum_layers_d(int size, int num_active, const int* active,
+        oskar_Mem* const* layers, double* plane)
+{
+    int iy;
+#pragma omp parallel for private(iy)
+    for (iy = 0; iy < size; ++iy)
+    {
+        int i, ix;
+        const size_t offset = 2 * (size_t) iy * size;
+        double* restrict out = plane + offset;
+        for (i = 0; i < num_active; ++i)
+        {
+            const double* restrict in = (const double*)
+                    oskar_mem_void_const(layers[active[i]]) + offset;
+            for (ix = 0; ix < 2 * size; ++ix) out[ix] += in[ix];
+        }
+    }
+}
+
+static void sum_layers_f(int size, int num_active, const int* active,
+        oskar_Mem* const* layers, float* plane)
+{
+    int iy;
+#pragma omp parallel for private(iy)
+    for (iy = 0; iy < size; ++iy)
+    {
+        int i, ix;
+        const size_t offset = 2 * (size_t) iy * size;
+        float* restrict out = plane + offset;
+        for (i = 0; i < num_active; ++i)
+        {
+            const float* restrict in = (const float*)
+                    oskar_mem_void_const(layers[active[i]]) + offset;
+            for (ix = 0; ix < 2 * size; ++ix) out[ix] += in[ix];
+        }
+    }
+}
+
+void oskar_imager_flush_plane_wstack(oskar_Imager* h, oskar_Mem* plane,
+        int* status)
+{
+    int i, ix, iy, size, num_active = 0, *active;
+    size_t num_cells;
+    double *nm1;
+    oskar_Mem** layers;
+    if (*status) return;
+    layers = oskar_imager_wstack_layers(h, plane, 0);
+    if (!layers) return;
+    size = oskar_imager_plane_size(h);
+    num_cells = (size_t) size * (size_t) size;
+    if (oskar_mem_length(plane) < num_cells)
+        oskar_mem_realloc(plane, num_cells, status);
+    active = (int*) malloc(h->num_w_planes * sizeof(int));
+    nm1 = (double*) malloc(num_cells * sizeof(double));
+    if (!active || !nm1)
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+    if (*status)
+    {
+        free(active);
+        free(nm1);
+        return;
+    }
+    for (i = 0; i < h->num_w_planes; ++i)
+        if (layers[i]) active[num_active++] = i;
+    h->w_layer_num_ffts += num_active;
+
+    /* Create the FFT plan if required, as in oskar_imager_finalise_plane(). */
+    if (num_active > 0 && !h->fft)
+    {
+        int location = OSKAR_CPU;
+        if (h->fft_on_gpu && h->num_gpus > 0)
+        {
+            location = OSKAR_GPU;
+            oskar_device_set(h->gpu_ids[0], status);
+        }
+        h->fft = oskar_fft_create(h->imager_prec, location, 2, size, 0,
+                status);
+    }
+    else if (num_active > 0 && h->fft_on_gpu && h->num_gpus > 0)
+        oskar_device_set(h->gpu_ids[0], status);
+
+    /* Evaluate (n - 1) at each pixel. */
+    for (iy = 0; iy < size; ++iy)
+    {
+        const double m = h->cellsize_rad * (iy - size / 2);
+        for (ix = 0; ix < size; ++ix)
+        {
+            const double l = h->cellsize_rad * (ix - size / 2);
+            const double rsq = l*l + m*m;
+            nm1[iy * size + ix] = (rsq < 1.0) ? sqrt(1.0 - rsq) - 1.0 : -1.0;
+        }
+    }
+
+    /* Transform each layer that has data, and apply its W-phase screen.
+     * Layers are processed concurrently unless the FFT is on the GPU. */
+#pragma omp parallel for schedule(dynamic, 1) \
+        if (num_active > 1 && !(h->fft_on_gpu && h->num_gpus > 0))
+    for (i = 0; i < num_active; ++i)
+    {
+        int layer_status = 0;
+        const int k = active[i];
+        const double w = k * h->w_layer_spacing;
+        oskar_Mem* layer = layers[k];
+        if (oskar_mem_precision(layer) == OSKAR_DOUBLE)
+        {
+            oskar_fftphase_cd(size, size, oskar_mem_double(layer,
+                    &layer_status));
+            oskar_fft_exec(h->fft, layer, &layer_status);
+            apply_screen_d(num_cells, nm1, w,
+                    oskar_mem_double(layer, &layer_status));
+        }
+        else
+        {
+            oskar_fftphase_cf(size, size, oskar_mem_float(layer,
+                    &layer_status));
+            oskar_fft_exec(h->fft, layer, &layer_status);
+            apply_screen_f(num_cells, nm1, w,
+                    oskar_mem_float(layer, &layer_status));
+        }
+        if (layer_status)
+        {
+#pragma omp critical (oskar_imager_wstack_status)
+            *status = layer_status;
+        }
+    }
+
+    /* Add the layers to the plane. */
+    if (!*status && num_active > 0)
+    {
+        if (oskar_mem_precision(plane) == OSKAR_DOUBLE)
+            sum_layers_d(size, num_active, active, layers,
+                    oskar_mem_double(plane, status));
+        else
+            sum_layers_f(size, num_active, active, layers,
+                    oskar_mem_float(plane, status));
+    }
+
+    /* Free the layers. They are created again if more data arrive. */
+    for (i = 0; i < num_active; ++i)
+    {
+        oskar_mem_free(layers[active[i]], status);
+        layers[active[i]] = 0;
+    }
+    free(active);
+    free(nm1);
+}
+
+void oskar_imager_flush_wstack(oskar_Imager* h, int* status)
+{
+    int i;
+    for (i = 0; i < h->num_w_layer_sets && !*status; ++i)
+        oskar_imager_flush_plane_wstack(h, h->w_layer_planes[i], status);
+}
+
+void oskar_imager_finalise_plane_wstack(oskar_Imager* h, oskar_Mem* plane,
+        double plane_norm, int* status)
+{
+    if (*status) return;
+
+    /* The plane holds the sum of the layers transformed so far,
+     * so add the rest, then normalise it. */
+    oskar_imager_flush_plane_wstack(h, plane, status);
+    oskar_imager_wstack_layers_release(h, plane, status);
+    if (plane_norm > 0.0 || plane_norm < 0.0)
+        oskar_mem_scale_real(plane, 1.0 / plane_norm, status);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -26,10 +26,6 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
-#ifdef OSKAR_HAVE_CUDA
-#include <cufft.h>
-#endif
-
 #include "imager/private_imager.h"
 #include "imager/oskar_imager.h"
 
@@ -37,9 +33,13 @@
 #include "imager/private_imager_generate_w_phase_screen.h"
 #include "imager/private_imager_init_wproj.h"
 #include "imager/oskar_grid_functions_spheroidal.h"
+#include "binary/oskar_binary.h"
 #include "math/oskar_cmath.h"
-#include "math/oskar_fftpack_cfft.h"
-#include "math/oskar_fftpack_cfft_f.h"
+#include "math/oskar_fft.h"
+#include "mem/oskar_binary_read_mem.h"
+#include "mem/oskar_binary_write_mem.h"
+#include "utility/oskar_dir.h"
+#include "utility/oskar_file_exists.h"
 #include "utility/oskar_get_memory_usage.h"
 #include "utility/oskar_device_utils.h"
 
@@ -47,6 +47,10 @@
 #include <string.h>
 #include <stdio.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -101,116 +105,98 @@ static void compact_kernels(const int num_w_planes, const int* support,
         const oskar_Mem* kernels_in, oskar_Mem* kernels_out,
         int* compacted_kernel_start, int* status);
 
-/*
- * W-kernel generation is based on CASA implementation
- * in code/synthesis/TransformMachines/WPConvFunc.cc
- */
-void oskar_imager_init_wproj(oskar_Imager* h, int* status)
+static void evaluate_kernel(const int iw, const int conv_size,
+        const int conv_size_half, const int inner, const double sampling,
+        const double w_scale, const oskar_Mem* taper, oskar_Mem* screen,
+        oskar_Mem* screen_ptr, oskar_FFT* fft, oskar_Mem* kernels,
+        double* max_val, int* status)
 {
-    size_t max_mem_bytes, max_bytes_per_plane, element_size, copy_len;
-    int i, iw, ix, iy, *supp, new_conv_size, oversample, prec;
-    int conv_size, conv_size_half, inner, nearest;
-    double l_max, max_conv_size, max_uvw, max_val, sampling, sum;
-    double *maxes;
-#ifdef OSKAR_HAVE_CUDA
-    cufftHandle cufft_plan = 0;
-#endif
-    oskar_Mem *screen = 0, *screen_gpu = 0, *screen_ptr = 0;
-    oskar_Mem *taper = 0, *taper_gpu = 0, *taper_ptr = 0;
-    oskar_Mem *wsave = 0, *work = 0;
-    char *ptr_out, *ptr_in, *fname = 0;
+    size_t in = 0, out = 0, offset, copy_len, element_size;
+    int iy;
+    char *ptr_out, *ptr_in;
+
+    /* Generate the tapered phase screen. */
+    oskar_imager_generate_w_phase_screen(iw, conv_size, inner, sampling,
+            w_scale, taper, screen_ptr, status);
+
+    /* Perform the FFT to get the kernel. No shifts are required. */
+    oskar_fft_exec(fft, screen_ptr, status);
+    if (screen_ptr != screen)
+        oskar_mem_copy(screen, screen_ptr, status);
     if (*status) return;
 
-    /* Get GCF padding oversample factor and imager precision. */
-    oversample = h->oversample;
-    prec = h->imager_prec;
-
-    /* Calculate required number of w-planes if not set. */
-    if (h->ww_max > 0.0)
+    /* Get the maximum (from the first element). */
+    if (oskar_mem_precision(screen) == OSKAR_DOUBLE)
     {
-        double ww_mid;
-        max_uvw = 1.05 * h->ww_max;
-        ww_mid = 0.5 * (h->ww_min + h->ww_max);
-        if (h->ww_rms > ww_mid)
-            max_uvw *= h->ww_rms / ww_mid;
+        const double* t = (const double*) oskar_mem_void_const(screen);
+        *max_val = sqrt(t[0]*t[0] + t[1]*t[1]);
     }
     else
     {
-        max_uvw = 0.25 / fabs(h->cellsize_rad);
+        const float* t = (const float*) oskar_mem_void_const(screen);
+        *max_val = sqrt(t[0]*t[0] + t[1]*t[1]);
     }
-    if (h->num_w_planes < 1)
-        h->num_w_planes = (int)(max_uvw *
-                fabs(sin(h->cellsize_rad * h->image_size / 2.0)));
-    if (h->num_w_planes < 16)
-        h->num_w_planes = 16;
 
-    /* Calculate convolution kernel size. */
-    h->w_scale = pow(h->num_w_planes - 1, 2.0) / max_uvw;
-    max_mem_bytes = oskar_get_total_physical_memory();
-    max_bytes_per_plane = 64 * 1024 * 1024; /* 64 MB per plane */
-    max_mem_bytes = MIN(max_mem_bytes, max_bytes_per_plane * h->num_w_planes);
-    max_conv_size = sqrt(max_mem_bytes / (16.0 * h->num_w_planes));
-    nearest = oskar_imager_composite_nearest_even(
-            2 * (int)(max_conv_size / 2.0), 0, 0);
-    conv_size = MIN((int)(h->image_size * h->image_padding), nearest);
-    conv_size_half = conv_size / 2 - 1;
-    h->conv_size_half = conv_size_half;
+    /* Save only the first quarter of the kernel; the rest is redundant. */
+    element_size = oskar_mem_element_size(oskar_mem_type(kernels));
+    copy_len = element_size * conv_size_half;
+    offset = ((size_t) iw) * conv_size_half * conv_size_half * element_size;
+    ptr_in = oskar_mem_char(screen);
+    ptr_out = oskar_mem_char(kernels) + offset;
+    for (iy = 0; iy < conv_size_half; ++iy)
+    {
+        memcpy(ptr_out + out, ptr_in + in, copy_len);
+        in += conv_size * element_size;
+        out += copy_len;
+    }
+}
 
-    /* Allocate kernels and support array. */
-    oskar_mem_free(h->w_kernels, status);
-    oskar_mem_free(h->w_support, status);
-    oskar_mem_free(h->w_kernels_compact, status);
-    oskar_mem_free(h->w_kernel_start, status);
-    h->w_support = oskar_mem_create(OSKAR_INT, OSKAR_CPU,
-            h->num_w_planes, status);
-    h->w_kernel_start = oskar_mem_create(OSKAR_INT, OSKAR_CPU,
-            h->num_w_planes, status);
-    h->w_kernels = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
-            ((size_t) h->num_w_planes) * ((size_t) conv_size_half) *
-            ((size_t) conv_size_half), status);
-    h->w_kernels_compact = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
-            0, status);
+static void generate_kernels(oskar_Imager* h, int conv_size, int inner,
+        double sampling, int* status)
+{
+    size_t element_size, copy_len;
+    int i, iw, ix, iy, *supp, new_conv_size, oversample, prec;
+    int conv_size_half, num_threads = 1, use_gpu = 0;
+    double max_val, sum, *maxes;
+    oskar_FFT** fft;
+    oskar_Mem **screen, *screen_gpu = 0, *taper = 0, *taper_gpu = 0;
+    oskar_Mem *taper_ptr = 0;
+    char *fname = 0;
+    if (*status) return;
+    oversample = h->oversample;
+    prec = h->imager_prec;
+    conv_size_half = h->conv_size_half;
     supp = oskar_mem_int(h->w_support, status);
     element_size = oskar_mem_element_size(oskar_mem_type(h->w_kernels));
-    if (*status) return;
-
-    /* Get size of inner region of kernel and padded grid size. */
-    inner = conv_size / oversample;
-    l_max = sin(0.5 * h->fov_deg * M_PI/180.0);
-    sampling = (2.0 * l_max * oversample) / h->image_size;
-    sampling *= ((double) oskar_imager_plane_size(h)) / ((double) conv_size);
 
-    /* Create scratch arrays and FFT plan for the phase screens. */
-    screen = oskar_mem_create(prec | OSKAR_COMPLEX,
-            OSKAR_CPU, conv_size * conv_size, status);
-    screen_ptr = screen;
+    /* Generate kernels for different W-planes in parallel on the CPU.
+     * Limit the scratch memory to the size of the kernel array. */
+#ifdef OSKAR_HAVE_CUDA
+    use_gpu = h->generate_w_kernels_on_gpu && h->num_gpus > 0;
+#endif
+#ifdef _OPENMP
+    if (!use_gpu)
+        num_threads = MIN(omp_get_max_threads(), h->num_w_planes / 4);
+#endif
+    if (num_threads < 1) num_threads = 1;
+
+    /* Create scratch arrays and FFT plans for the phase screens. */
+    screen = (oskar_Mem**) calloc(num_threads, sizeof(oskar_Mem*));
+    fft = (oskar_FFT**) calloc(num_threads, sizeof(oskar_FFT*));
+    for (i = 0; i < num_threads; ++i)
+        screen[i] = oskar_mem_create(prec | OSKAR_COMPLEX,
+                OSKAR_CPU, conv_size * conv_size, status);
 #ifdef OSKAR_HAVE_CUDA
-    if (h->generate_w_kernels_on_gpu && h->num_gpus > 0)
+    if (use_gpu)
     {
         oskar_device_set(h->gpu_ids[0], status);
         screen_gpu = oskar_mem_create(prec | OSKAR_COMPLEX,
                 OSKAR_GPU, conv_size * conv_size, status);
-        screen_ptr = screen_gpu;
-        if (prec == OSKAR_DOUBLE)
-            cufftPlan2d(&cufft_plan, conv_size, conv_size, CUFFT_Z2Z);
-        else
-            cufftPlan2d(&cufft_plan, conv_size, conv_size, CUFFT_C2C);
     }
-    else
 #endif
-    {
-        int len_save = 4 * conv_size +
-                2 * (int)(log((double)conv_size) / log(2.0)) + 8;
-        wsave = oskar_mem_create(prec, OSKAR_CPU, len_save, status);
-        work = oskar_mem_create(prec, OSKAR_CPU,
-                2 * conv_size * conv_size, status);
-        if (prec == OSKAR_DOUBLE)
-            oskar_fftpack_cfft2i(conv_size, conv_size,
-                    oskar_mem_double(wsave, status));
-        else
-            oskar_fftpack_cfft2i_f(conv_size, conv_size,
-                    oskar_mem_float(wsave, status));
-    }
+    for (i = 0; i < num_threads; ++i)
+        fft[i] = oskar_fft_create(prec, use_gpu ? OSKAR_GPU : OSKAR_CPU, 2,
+                conv_size, 0, status);
 
     /* Generate 1D spheroidal tapering function to cover the inner region. */
     taper = oskar_mem_create(prec, OSKAR_CPU, inner, status);
@@ -236,7 +222,7 @@ void oskar_imager_init_wproj(oskar_Imager* h, int* status)
         }
     }
 #ifdef OSKAR_HAVE_CUDA
-    if (h->generate_w_kernels_on_gpu && h->num_gpus > 0)
+    if (use_gpu)
     {
         taper_gpu = oskar_mem_create_copy(taper, OSKAR_GPU, status);
         taper_ptr = taper_gpu;
@@ -244,82 +230,48 @@ void oskar_imager_init_wproj(oskar_Imager* h, int* status)
 #endif
 
     /* Evaluate kernels. */
-    ptr_in   = oskar_mem_char(screen);
-    copy_len = element_size * conv_size_half;
     maxes = (double*) calloc(h->num_w_planes, sizeof(double));
-    for (iw = 0; iw < h->num_w_planes; ++iw)
+    if (!*status)
     {
-        size_t in = 0, out = 0, offset;
-
-        /* Generate the tapered phase screen. */
-        oskar_imager_generate_w_phase_screen(iw, conv_size, inner, sampling,
-                h->w_scale, taper_ptr, screen_ptr, status);
-        if (*status) break;
-
-        /* Perform the FFT to get the kernel. No shifts are required. */
-#ifdef OSKAR_HAVE_CUDA
-        if (h->generate_w_kernels_on_gpu && h->num_gpus > 0)
+#pragma omp parallel num_threads(num_threads) private(iw)
         {
-            if (oskar_mem_precision(screen) == OSKAR_DOUBLE)
-                cufftExecZ2Z(cufft_plan, oskar_mem_void(screen_ptr),
-                        oskar_mem_void(screen_ptr), CUFFT_FORWARD);
-            else
-                cufftExecC2C(cufft_plan, oskar_mem_void(screen_ptr),
-                        oskar_mem_void(screen_ptr), CUFFT_FORWARD);
-            oskar_mem_copy(screen, screen_ptr, status);
-        }
-        else
+            int thread_id = 0, thread_status = 0;
+#ifdef _OPENMP
+            thread_id = omp_get_thread_num();
 #endif
-        {
-            if (oskar_mem_precision(screen_ptr) == OSKAR_DOUBLE)
-                oskar_fftpack_cfft2f(conv_size, conv_size, conv_size,
-                        oskar_mem_double(screen_ptr, status),
-                        oskar_mem_double(wsave, status),
-                        oskar_mem_double(work, status));
-            else
-                oskar_fftpack_cfft2f_f(conv_size, conv_size, conv_size,
-                        oskar_mem_float(screen_ptr, status),
-                        oskar_mem_float(wsave, status),
-                        oskar_mem_float(work, status));
-        }
-        if (*status) break;
-
-        /* Get the maximum (from the first element). */
-        if (oskar_mem_precision(screen) == OSKAR_DOUBLE)
-        {
-            const double* t = (const double*) oskar_mem_void_const(screen);
-            maxes[iw] = sqrt(t[0]*t[0] + t[1]*t[1]);
-        }
-        else
-        {
-            const float* t = (const float*) oskar_mem_void_const(screen);
-            maxes[iw] = sqrt(t[0]*t[0] + t[1]*t[1]);
-        }
-
-        /* Save only the first quarter of the kernel; the rest is redundant. */
-        offset = iw * conv_size_half * conv_size_half * element_size;
-        ptr_out = oskar_mem_char(h->w_kernels) + offset;
-        for (iy = 0; iy < conv_size_half; ++iy)
-        {
-            memcpy(ptr_out + out, ptr_in + in, copy_len);
-            in += conv_size * element_size;
-            out += copy_len;
+#pragma omp for schedule(dynamic, 1)
+            for (iw = 0; iw < h->num_w_planes; ++iw)
+                evaluate_kernel(iw, conv_size, conv_size_half, inner,
+                        sampling, h->w_scale, taper_ptr, screen[thread_id],
+                        screen_gpu ? screen_gpu : screen[thread_id],
+                        fft[thread_id], h->w_kernels, &maxes[iw],
+                        &thread_status);
+            if (thread_status)
+            {
+#pragma omp critical
+                *status = thread_status;
+            }
         }
     }
 
     /* Clean up. */
-#ifdef OSKAR_HAVE_CUDA
-    cufftDestroy(cufft_plan);
-#endif
-    oskar_mem_free(screen, status);
+    for (i = 0; i < num_threads; ++i)
+    {
+        oskar_fft_free(fft[i]);
+        oskar_mem_free(screen[i], status);
+    }
+    free(fft);
+    free(screen);
     oskar_mem_free(screen_gpu, status);
     oskar_mem_free(taper, status);
     oskar_mem_free(taper_gpu, status);
-    oskar_mem_free(wsave, status);
-    oskar_mem_free(work, status);
 
     /* Normalise each plane by the maximum. */
-    if (*status) return;
+    if (*status)
+    {
+        free(maxes);
+        return;
+    }
     max_val = -INT_MAX;
     for (iw = 0; iw < h->num_w_planes; ++iw) max_val = MAX(max_val, maxes[iw]);
     oskar_mem_scale_real(h->w_kernels, 1.0 / max_val, status);
@@ -399,7 +351,6 @@ void oskar_imager_init_wproj(oskar_Imager* h, int* status)
                 out += copy_len;
             }
         }
-        conv_size = new_conv_size;
         h->conv_size_half = conv_size_half = new_conv_size_half;
         oskar_mem_realloc(h->w_kernels,
                 ((size_t) h->num_w_planes) * ((size_t) new_conv_size_half) *
@@ -451,10 +402,191 @@ void oskar_imager_init_wproj(oskar_Imager* h, int* status)
     write_kernel_metadata(h, fname, status);
 #endif
     free(fname);
-    
+}
+
+static char* kernel_cache_path(const oskar_Imager* h, const double* params,
+        size_t num_params)
+{
+    char name[64];
+    unsigned long long key;
+    key = oskar_mem_hash_raw(params, num_params * sizeof(double), 0);
+    sprintf(name, "oskar_w_kernels_%016llx.bin", key);
+    return oskar_dir_get_path(h->w_kernel_dir, name);
+}
+
+static int load_kernels(oskar_Imager* h, const char* fname,
+        const double* params, size_t num_params)
+{
+    int i, status = 0;
+    oskar_Binary* f;
+    oskar_Mem* stored;
+    if (!oskar_file_exists(fname)) return 0;
+    f = oskar_binary_create(fname, 'r', &status);
+    stored = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    oskar_binary_read_mem_ext(f, stored,
+            "W_KERNELS", "PARAMETERS", 0, &status);
+
+    /* Check the parameters match, in case of a hash collision. */
+    if (!status && oskar_mem_length(stored) == num_params)
+    {
+        const double* p = oskar_mem_double_const(stored, &status);
+        for (i = 0; i < (int) num_params; ++i)
+            if (p[i] != params[i]) status = OSKAR_ERR_INVALID_ARGUMENT;
+    }
+    else if (!status)
+        status = OSKAR_ERR_INVALID_ARGUMENT;
+    oskar_binary_read_ext_int(f, "W_KERNELS", "CONV_SIZE_HALF", 0,
+            &h->conv_size_half, &status);
+    oskar_binary_read_mem_ext(f, h->w_support,
+            "W_KERNELS", "SUPPORT", 0, &status);
+    oskar_binary_read_mem_ext(f, h->w_kernels,
+            "W_KERNELS", "KERNELS", 0, &status);
+    if (!status && (int) oskar_mem_length(h->w_support) != h->num_w_planes)
+        status = OSKAR_ERR_INVALID_ARGUMENT;
+    oskar_mem_free(stored, &status);
+    oskar_binary_free(f);
+    return !status;
+}
+
+static void save_kernels(oskar_Imager* h, const char* fname,
+        const double* params, size_t num_params)
+{
+    int status = 0;
+    char* temp_name;
+    oskar_Binary* f;
+    oskar_Mem* stored;
+
+    /* Write to a temporary file first, so readers never see a partial one. */
+    if (!oskar_dir_mkpath(h->w_kernel_dir)) return;
+    temp_name = oskar_dir_temp_file_name(fname);
+    if (!temp_name) return;
+    stored = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_params, &status);
+    if (!status)
+        memcpy(oskar_mem_void(stored), params, num_params * sizeof(double));
+    f = oskar_binary_create(temp_name, 'w', &status);
+    oskar_binary_write_mem_ext(f, stored,
+            "W_KERNELS", "PARAMETERS", 0, 0, &status);
+    oskar_binary_write_ext_int(f, "W_KERNELS", "CONV_SIZE_HALF", 0,
+            h->conv_size_half, &status);
+    oskar_binary_write_mem_ext(f, h->w_support,
+            "W_KERNELS", "SUPPORT", 0, 0, &status);
+    oskar_binary_write_mem_ext(f, h->w_kernels,
+            "W_KERNELS", "KERNELS", 0, 0, &status);
+    oskar_binary_free(f);
+    oskar_mem_free(stored, &status);
+    if (status || rename(temp_name, fname))
+    {
+        remove(temp_name);
+        if (h->log)
+            oskar_log_warning(h->log, "Unable to save W-kernels to '%s'",
+                    fname);
+    }
+    free(temp_name);
+}
+
+/*
+ * W-kernel generation is based on CASA implementation
+ * in code/synthesis/TransformMachines/WPConvFunc.cc
+ */
+void oskar_imager_init_wproj(oskar_Imager* h, int* status)
+{
+    size_t max_mem_bytes, max_bytes_per_plane;
+    int loaded = 0, oversample, prec, conv_size, inner, nearest;
+    double l_max, max_conv_size, max_uvw, sampling, params[7];
+    char* fname = 0;
+    if (*status) return;
+
+    /* Get GCF padding oversample factor and imager precision. */
+    oversample = h->oversample;
+    prec = h->imager_prec;
+
+    /* Calculate required number of w-planes if not set. */
+    if (h->ww_max > 0.0)
+    {
+        double ww_mid;
+        max_uvw = 1.05 * h->ww_max;
+        ww_mid = 0.5 * (h->ww_min + h->ww_max);
+        if (h->ww_rms > ww_mid)
+            max_uvw *= h->ww_rms / ww_mid;
+    }
+    else
+    {
+        max_uvw = 0.25 / fabs(h->cellsize_rad);
+    }
+    if (h->num_w_planes < 1)
+        h->num_w_planes = (int)(max_uvw *
+                fabs(sin(h->cellsize_rad * h->image_size / 2.0)));
+    if (h->num_w_planes < 16)
+        h->num_w_planes = 16;
+
+    /* Calculate convolution kernel size. */
+    h->w_scale = pow(h->num_w_planes - 1, 2.0) / max_uvw;
+    max_mem_bytes = oskar_get_total_physical_memory();
+    max_bytes_per_plane = 64 * 1024 * 1024; /* 64 MB per plane */
+    max_mem_bytes = MIN(max_mem_bytes, max_bytes_per_plane * h->num_w_planes);
+    max_conv_size = sqrt(max_mem_bytes / (16.0 * h->num_w_planes));
+    nearest = oskar_imager_composite_nearest_even(
+            2 * (int)(max_conv_size / 2.0), 0, 0);
+    conv_size = MIN((int)(h->image_size * h->image_padding), nearest);
+    h->conv_size_half = conv_size / 2 - 1;
+
+    /* Allocate kernels and support array. */
+    oskar_mem_free(h->w_kernels, status);
+    oskar_mem_free(h->w_support, status);
+    oskar_mem_free(h->w_kernels_compact, status);
+    oskar_mem_free(h->w_kernel_start, status);
+    h->w_support = oskar_mem_create(OSKAR_INT, OSKAR_CPU,
+            h->num_w_planes, status);
+    h->w_kernel_start = oskar_mem_create(OSKAR_INT, OSKAR_CPU,
+            h->num_w_planes, status);
+    h->w_kernels = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+            ((size_t) h->num_w_planes) * ((size_t) h->conv_size_half) *
+            ((size_t) h->conv_size_half), status);
+    h->w_kernels_compact = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+            0, status);
+    if (*status) return;
+
+    /* Get size of inner region of kernel and padded grid size. */
+    inner = conv_size / oversample;
+    l_max = sin(0.5 * h->fov_deg * M_PI/180.0);
+    sampling = (2.0 * l_max * oversample) / h->image_size;
+    sampling *= ((double) oskar_imager_plane_size(h)) / ((double) conv_size);
+
+    /* Load the kernels if they were cached by a previous run. */
+    params[0] = (double) prec;
+    params[1] = (double) h->num_w_planes;
+    params[2] = (double) conv_size;
+    params[3] = (double) inner;
+    params[4] = (double) oversample;
+    params[5] = sampling;
+    params[6] = h->w_scale;
+    if (h->w_kernel_dir)
+    {
+        fname = kernel_cache_path(h, params, 7);
+        loaded = load_kernels(h, fname, params, 7);
+        if (loaded && h->log)
+            oskar_log_message(h->log, 'M', 0, "Loaded W-kernels from '%s'",
+                    fname);
+    }
+
+    /* Otherwise, generate the kernels and save them if required. */
+    if (!loaded)
+    {
+        h->conv_size_half = conv_size / 2 - 1;
+        oskar_mem_realloc(h->w_support, h->num_w_planes, status);
+        oskar_mem_clear_contents(h->w_support, status);
+        oskar_mem_realloc(h->w_kernels, ((size_t) h->num_w_planes) *
+                ((size_t) h->conv_size_half) *
+                ((size_t) h->conv_size_half), status);
+        generate_kernels(h, conv_size, inner, sampling, status);
+        if (fname && !*status)
+            save_kernels(h, fname, params, 7);
+    }
+    free(fname);
+
     /* Compact and rearrange the kernels. */
-    compact_kernels(h->num_w_planes, supp, oversample, conv_size_half,
-            h->w_kernels, h->w_kernels_compact,
+    compact_kernels(h->num_w_planes, oskar_mem_int(h->w_support, status),
+            oversample, h->conv_size_half, h->w_kernels, h->w_kernels_compact,
             oskar_mem_int(h->w_kernel_start, status), status);
 }
 
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/private_imager_init_fft.h"
+#include "imager/private_imager_init_wstack.h"
+#include "imager/private_imager_wstack_layers.h"
+#include "math/oskar_cmath.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_imager_init_wstack(oskar_Imager* h, int* status)
+{
+    int grid_size;
+    double l_max, max_w, nm1_max, rsq;
+    if (*status) return;
+
+    /* The layers are gridded using the same kernel as the FFT imager. */
+    oskar_imager_init_fft(h, status);
+    oskar_imager_wstack_layers_free(h, status);
+
+    /* Get the range of baseline W values to cover. */
+    if (h->ww_max > 0.0)
+        max_w = 1.05 * h->ww_max;
+    else
+        max_w = 0.25 / fabs(h->cellsize_rad);
+
+    /* Find the largest value of (1 - n), at the corners of the image. */
+    grid_size = oskar_imager_plane_size(h);
+    l_max = fabs(h->cellsize_rad) * (grid_size / 2);
+    rsq = 2.0 * l_max * l_max;
+    nm1_max = (rsq < 1.0) ? 1.0 - sqrt(1.0 - rsq) : 1.0;
+
+    /* Calculate required number of W-layers if not set.
+     * Visibilities are assigned to the nearest layer, so this keeps the
+     * residual W-phase error below 0.25 radians across the image. */
+    if (h->num_w_planes < 1)
+        h->num_w_planes = 1 + (int) ceil(4.0 * M_PI * max_w * nm1_max);
+    h->w_layer_spacing = (h->num_w_planes > 1) ?
+            max_w / (h->num_w_planes - 1) : 0.0;
+}
+
+#ifdef __cplusplus
+}
+#endif
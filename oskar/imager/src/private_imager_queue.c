@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/private_imager_queue.h"
+#include "imager/oskar_imager.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NUM_SLOTS 3
+
+/* The arguments of one call to oskar_imager_update(), copied so that the
+ * reader can carry on filling its own buffers, or the visibility meta-data
+ * for the blocks that follow it. */
+struct Slot
+{
+    int is_meta, num_channels;
+    double freq_start_hz, freq_inc_hz, ra_deg, dec_deg;
+    size_t num_rows;
+    int start_chan, end_chan, num_pols;
+    oskar_Mem *uu, *vv, *ww, *amps, *weight, *time;
+    const oskar_Mem *pu, *pv, *pw, *pa, *ph, *pt;
+};
+typedef struct Slot Slot;
+
+struct oskar_ImagerQueue
+{
+    oskar_ConditionVar* var;
+    oskar_Thread* thread;
+    Slot slot[NUM_SLOTS];
+    int head, count, done, abort, status;
+};
+
+static const oskar_Mem* copy_mem(oskar_Mem** dst, const oskar_Mem* src,
+        size_t num_elements, int* status)
+{
+    int type;
+    if (*status || !src) return 0;
+    type = oskar_mem_type(src);
+    if (num_elements > oskar_mem_length(src))
+        num_elements = oskar_mem_length(src);
+
+    /* Re-use the array from the previous block if possible. */
+    if (*dst && oskar_mem_type(*dst) != type)
+    {
+        oskar_mem_free(*dst, status);
+        *dst = 0;
+    }
+    if (!*dst)
+        *dst = oskar_mem_create(type, OSKAR_CPU, num_elements, status);
+    else if (oskar_mem_length(*dst) != num_elements)
+        oskar_mem_realloc(*dst, num_elements, status);
+    oskar_mem_copy_contents(*dst, src, 0, 0, num_elements, status);
+    return *dst;
+}
+
+static void* run_gridder(void* arg)
+{
+    oskar_Imager* h = (oskar_Imager*) arg;
+    oskar_ImagerQueue* q = h->queue;
+    int status = 0;
+    for (;;)
+    {
+        Slot* s;
+
+        /* Wait for the next block, or for the reader to finish. */
+        oskar_condition_lock(q->var);
+        while (q->count == 0 && !q->done)
+            oskar_condition_wait(q->var);
+        if (q->count == 0 || q->abort)
+        {
+            oskar_condition_unlock(q->var);
+            break;
+        }
+        s = &q->slot[q->head];
+        oskar_condition_unlock(q->var);
+
+        /* Apply new meta-data here, so it only affects the blocks read
+         * after it. Otherwise, grid the block while the reader fills the
+         * other slots. */
+        if (s->is_meta)
+        {
+            oskar_imager_set_vis_frequency(h, s->freq_start_hz,
+                    s->freq_inc_hz, s->num_channels);
+            oskar_imager_set_vis_phase_centre(h, s->ra_deg, s->dec_deg);
+        }
+        else
+            oskar_imager_update(h, s->num_rows, s->start_chan, s->end_chan,
+                    s->num_pols, s->pu, s->pv, s->pw, s->pa, s->ph, s->pt,
+                    &status);
+
+        /* Release the slot. */
+        oskar_condition_lock(q->var);
+        q->head = (q->head + 1) % NUM_SLOTS;
+        q->count--;
+        if (status) q->status = status;
+        oskar_condition_notify_all(q->var);
+        oskar_condition_unlock(q->var);
+        if (status) break;
+    }
+    return 0;
+}
+
+
+void oskar_imager_queue_start(oskar_Imager* h, int* status)
+{
+    if (*status || h->queue) return;
+    h->queue = (oskar_ImagerQueue*) calloc(1, sizeof(oskar_ImagerQueue));
+    if (!h->queue) return;
+    h->queue->var = oskar_condition_create();
+    h->queue->thread = oskar_thread_create(run_gridder, (void*)h, 0);
+    if (!h->queue->thread)
+    {
+        /* Fall back to updating the imager directly. */
+        oskar_condition_free(h->queue->var);
+        free(h->queue);
+        h->queue = 0;
+    }
+}
+
+
+/* Waits for a free slot, which is returned with the queue unlocked. */
+static Slot* wait_for_slot(oskar_ImagerQueue* q, int* status)
+{
+    Slot* s = 0;
+    oskar_condition_lock(q->var);
+    while (q->count == NUM_SLOTS && !q->status)
+        oskar_condition_wait(q->var);
+    if (q->status)
+        *status = q->status;
+    else
+        s = &q->slot[(q->head + q->count) % NUM_SLOTS];
+    oskar_condition_unlock(q->var);
+    return s;
+}
+
+/* Hands a filled slot to the gridder. */
+static void submit_slot(oskar_ImagerQueue* q)
+{
+    oskar_condition_lock(q->var);
+    q->count++;
+    oskar_condition_notify_all(q->var);
+    oskar_condition_unlock(q->var);
+}
+
+
+void oskar_imager_queue_set_vis_meta(oskar_Imager* h, double freq_start_hz,
+        double freq_inc_hz, int num_channels, double ra_deg, double dec_deg,
+        int* status)
+{
+    oskar_ImagerQueue* q = h->queue;
+    Slot* s;
+    if (*status) return;
+
+    /* Set the meta-data directly if there is no gridder thread. */
+    if (!q)
+    {
+        oskar_imager_set_vis_frequency(h, freq_start_hz, freq_inc_hz,
+                num_channels);
+        oskar_imager_set_vis_phase_centre(h, ra_deg, dec_deg);
+        return;
+    }
+
+    /* Pass the meta-data to the gridder in order with the blocks,
+     * as it must not change while earlier blocks are being gridded. */
+    s = wait_for_slot(q, status);
+    if (!s) return;
+    s->is_meta = 1;
+    s->freq_start_hz = freq_start_hz;
+    s->freq_inc_hz = freq_inc_hz;
+    s->num_channels = num_channels;
+    s->ra_deg = ra_deg;
+    s->dec_deg = dec_deg;
+    submit_slot(q);
+}
+
+
+void oskar_imager_queue_update(oskar_Imager* h, size_t num_rows,
+        int start_chan, int end_chan, int num_pols, const oskar_Mem* uu,
+        const oskar_Mem* vv, const oskar_Mem* ww, const oskar_Mem* amps,
+        const oskar_Mem* weight, const oskar_Mem* time_centroid,
+        int* status)
+{
+    size_t num_amps;
+    oskar_ImagerQueue* q = h->queue;
+    Slot* s;
+    if (*status) return;
+
+    /* Update the imager directly if there is no gridder thread. */
+    if (!q)
+    {
+        oskar_imager_update(h, num_rows, start_chan, end_chan, num_pols,
+                uu, vv, ww, amps, weight, time_centroid, status);
+        return;
+    }
+
+    /* Wait for a free slot. */
+    s = wait_for_slot(q, status);
+    if (!s) return;
+
+    /* Copy the block into the slot. Only the elements used are copied. */
+    if (num_rows == 0)
+        num_rows = oskar_mem_length(uu);
+    num_amps = num_rows * (1 + end_chan - start_chan);
+    if (amps && !oskar_mem_is_matrix(amps)) num_amps *= num_pols;
+    s->is_meta = 0;
+    s->num_rows = num_rows;
+    s->start_chan = start_chan;
+    s->end_chan = end_chan;
+    s->num_pols = num_pols;
+    s->pu = copy_mem(&s->uu, uu, num_rows, status);
+    s->pv = copy_mem(&s->vv, vv, num_rows, status);
+    s->pw = copy_mem(&s->ww, ww, num_rows, status);
+    s->pa = copy_mem(&s->amps, amps, num_amps, status);
+    s->ph = copy_mem(&s->weight, weight, num_rows * num_pols, status);
+    s->pt = copy_mem(&s->time, time_centroid, num_rows, status);
+    if (*status) return;
+
+    /* Hand the slot to the gridder. */
+    submit_slot(q);
+}
+
+
+void oskar_imager_queue_finish(oskar_Imager* h, int* status)
+{
+    int i;
+    oskar_ImagerQueue* q = h->queue;
+    if (!q) return;
+
+    /* Let the gridder drain the queue, unless there was an error. */
+    oskar_condition_lock(q->var);
+    q->done = 1;
+    if (*status) q->abort = 1;
+    oskar_condition_notify_all(q->var);
+    oskar_condition_unlock(q->var);
+    oskar_thread_join(q->thread);
+    oskar_thread_free(q->thread);
+    if (!*status) *status = q->status;
+
+    /* Free the queue. */
+    for (i = 0; i < NUM_SLOTS; ++i)
+    {
+        oskar_mem_free(q->slot[i].uu, status);
+        oskar_mem_free(q->slot[i].vv, status);
+        oskar_mem_free(q->slot[i].ww, status);
+        oskar_mem_free(q->slot[i].amps, status);
+        oskar_mem_free(q->slot[i].weight, status);
+        oskar_mem_free(q->slot[i].time, status);
+    }
+    oskar_condition_free(q->var);
+    free(q);
+    h->queue = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017, The University of Oxford
+ * Copyright (c) 2017-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,6 +27,8 @@
  */
 
 #include "imager/private_imager.h"
+#include "imager/private_imager_cache.h"
+#include "imager/private_imager_queue.h"
 #include "imager/private_imager_read_data.h"
 #include "imager/oskar_imager.h"
 #include "binary/oskar_binary.h"
@@ -71,13 +73,19 @@ void oskar_imager_read_data_ms(oskar_Imager* h, const char* filename,
     num_pols = (int) oskar_ms_num_pols(ms);
     num_channels = (int) oskar_ms_num_channels(ms);
 
-    /* Set visibility meta-data. */
-    oskar_imager_set_vis_frequency(h,
+    /* Set visibility meta-data, after any blocks already queued,
+     * and keep it with any cached data. */
+    oskar_imager_queue_set_vis_meta(h,
             oskar_ms_freq_start_hz(ms),
-            oskar_ms_freq_inc_hz(ms), num_channels);
-    oskar_imager_set_vis_phase_centre(h,
+            oskar_ms_freq_inc_hz(ms), num_channels,
             oskar_ms_phase_centre_ra_rad(ms) * 180/M_PI,
-            oskar_ms_phase_centre_dec_rad(ms) * 180/M_PI);
+            oskar_ms_phase_centre_dec_rad(ms) * 180/M_PI, status);
+    if (h->coords_only)
+        oskar_imager_cache_write_header(h,
+                oskar_ms_freq_start_hz(ms),
+                oskar_ms_freq_inc_hz(ms), num_channels,
+                oskar_ms_phase_centre_ra_rad(ms) * 180/M_PI,
+                oskar_ms_phase_centre_dec_rad(ms) * 180/M_PI, status);
 
     /* Create arrays. */
     uvw = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 3 * num_baselines, status);
@@ -135,8 +143,8 @@ void oskar_imager_read_data_ms(oskar_Imager* h, const char* filename,
 
         /* Update the imager with the data. */
         oskar_timer_pause(h->tmr_read);
-        oskar_imager_update(h, block_size, 0, num_channels - 1, num_pols,
-                u, v, w, data, weight, time_centroid, status);
+        oskar_imager_queue_update(h, block_size, 0, num_channels - 1,
+                num_pols, u, v, w, data, weight, time_centroid, status);
         *percent_done = (int) round(100.0 * (
                 (start_row + block_size) / (double)(num_rows * num_files) +
                 i_file / (double)num_files));
@@ -200,13 +208,19 @@ void oskar_imager_read_data_vis(oskar_Imager* h, const char* filename,
     time_start_mjd = oskar_vis_header_time_start_mjd_utc(header) * 86400.0;
     time_inc_sec = oskar_vis_header_time_inc_sec(header);
 
-    /* Set visibility meta-data. */
-    oskar_imager_set_vis_frequency(h,
+    /* Set visibility meta-data, after any blocks already queued,
+     * and keep it with any cached data. */
+    oskar_imager_queue_set_vis_meta(h,
             oskar_vis_header_freq_start_hz(header),
-            oskar_vis_header_freq_inc_hz(header), num_channels_tot);
-    oskar_imager_set_vis_phase_centre(h,
+            oskar_vis_header_freq_inc_hz(header), num_channels_tot,
             oskar_vis_header_phase_centre_ra_deg(header),
-            oskar_vis_header_phase_centre_dec_deg(header));
+            oskar_vis_header_phase_centre_dec_deg(header), status);
+    if (h->coords_only)
+        oskar_imager_cache_write_header(h,
+                oskar_vis_header_freq_start_hz(header),
+                oskar_vis_header_freq_inc_hz(header), num_channels_tot,
+                oskar_vis_header_phase_centre_ra_deg(header),
+                oskar_vis_header_phase_centre_dec_deg(header), status);
 
     /* Create scratch arrays. Weights are all 1. */
     time_centroid = oskar_mem_create(OSKAR_DOUBLE,
@@ -288,8 +302,8 @@ void oskar_imager_read_data_vis(oskar_Imager* h, const char* filename,
 
         /* Update the imager with the data. */
         oskar_timer_pause(h->tmr_read);
-        oskar_imager_update(h, num_rows, start_chan, end_chan, num_pols,
-                oskar_vis_block_baseline_uu_metres(block),
+        oskar_imager_queue_update(h, num_rows, start_chan, end_chan,
+                num_pols, oskar_vis_block_baseline_uu_metres(block),
                 oskar_vis_block_baseline_vv_metres(block),
                 oskar_vis_block_baseline_ww_metres(block),
                 ptr, weight, time_centroid, status);
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -93,14 +93,17 @@ void oskar_imager_select_data(
         if (c < start_chan || c > end_chan) return;
         if (fabs((im_freq_hz - f0) - c * df) > s * df) return;
 
-        /* Copy the baseline coordinates in wavelengths. */
-        inv_wavelength = (f0 + c * df) / C0;
-        oskar_mem_copy_contents(uu_out, uu_in, 0, 0, num_rows, status);
-        oskar_mem_copy_contents(vv_out, vv_in, 0, 0, num_rows, status);
-        oskar_mem_copy_contents(ww_out, ww_in, 0, 0, num_rows, status);
-        oskar_mem_scale_real(uu_out, inv_wavelength, status);
-        oskar_mem_scale_real(vv_out, inv_wavelength, status);
-        oskar_mem_scale_real(ww_out, inv_wavelength, status);
+        /* Copy the baseline coordinates in wavelengths, if required. */
+        if (uu_out)
+        {
+            inv_wavelength = (f0 + c * df) / C0;
+            oskar_mem_copy_contents(uu_out, uu_in, 0, 0, num_rows, status);
+            oskar_mem_copy_contents(vv_out, vv_in, 0, 0, num_rows, status);
+            oskar_mem_copy_contents(ww_out, ww_in, 0, 0, num_rows, status);
+            oskar_mem_scale_real(uu_out, inv_wavelength, status);
+            oskar_mem_scale_real(vv_out, inv_wavelength, status);
+            oskar_mem_scale_real(ww_out, inv_wavelength, status);
+        }
 
         /* Copy visibility data and weights if present. */
         copy_vis_pol(num_rows, num_channels, num_pols,
@@ -128,17 +131,20 @@ void oskar_imager_select_data(
             if (c < start_chan || c > end_chan) continue;
             if (fabs((h->sel_freqs[i] - f0) - c * df) > s * df) continue;
 
-            /* Copy the baseline coordinates in wavelengths. */
-            inv_wavelength = (f0 + c * df) / C0;
-            oskar_mem_set_alias(uu_, uu_out, *num_out, num_rows, status);
-            oskar_mem_set_alias(vv_, vv_out, *num_out, num_rows, status);
-            oskar_mem_set_alias(ww_, ww_out, *num_out, num_rows, status);
-            oskar_mem_copy_contents(uu_, uu_in, 0, 0, num_rows, status);
-            oskar_mem_copy_contents(vv_, vv_in, 0, 0, num_rows, status);
-            oskar_mem_copy_contents(ww_, ww_in, 0, 0, num_rows, status);
-            oskar_mem_scale_real(uu_, inv_wavelength, status);
-            oskar_mem_scale_real(vv_, inv_wavelength, status);
-            oskar_mem_scale_real(ww_, inv_wavelength, status);
+            /* Copy the baseline coordinates in wavelengths, if required. */
+            if (uu_out)
+            {
+                inv_wavelength = (f0 + c * df) / C0;
+                oskar_mem_set_alias(uu_, uu_out, *num_out, num_rows, status);
+                oskar_mem_set_alias(vv_, vv_out, *num_out, num_rows, status);
+                oskar_mem_set_alias(ww_, ww_out, *num_out, num_rows, status);
+                oskar_mem_copy_contents(uu_, uu_in, 0, 0, num_rows, status);
+                oskar_mem_copy_contents(vv_, vv_in, 0, 0, num_rows, status);
+                oskar_mem_copy_contents(ww_, ww_in, 0, 0, num_rows, status);
+                oskar_mem_scale_real(uu_, inv_wavelength, status);
+                oskar_mem_scale_real(vv_, inv_wavelength, status);
+                oskar_mem_scale_real(ww_, inv_wavelength, status);
+            }
 
             /* Copy visibility data and weights if present. */
             copy_vis_pol(num_rows, num_channels, num_pols,
@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/private_imager_sort_vis.h"
+#include "imager/oskar_grid_tiles.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static void gather_d(size_t num, const size_t* restrict idx,
+        const double* restrict in, double* restrict out)
+{
+    size_t i;
+    for (i = 0; i < num; ++i) out[i] = in[idx[i]];
+}
+
+static void gather_f(size_t num, const size_t* restrict idx,
+        const float* restrict in, float* restrict out)
+{
+    size_t i;
+    for (i = 0; i < num; ++i) out[i] = in[idx[i]];
+}
+
+static void gather(size_t num, const size_t* idx, const oskar_Mem* in,
+        oskar_Mem* out, int* status)
+{
+    size_t i;
+    if (*status) return;
+    if (oskar_mem_length(out) < num)
+        oskar_mem_realloc(out, num, status);
+    if (*status) return;
+    if (!oskar_mem_is_complex(in))
+    {
+        if (oskar_mem_precision(in) == OSKAR_DOUBLE)
+            gather_d(num, idx, oskar_mem_double_const(in, status),
+                    oskar_mem_double(out, status));
+        else
+            gather_f(num, idx, oskar_mem_float_const(in, status),
+                    oskar_mem_float(out, status));
+    }
+    else if (oskar_mem_precision(in) == OSKAR_DOUBLE)
+    {
+        const double2* restrict t_in = oskar_mem_double2_const(in, status);
+        double2* restrict t_out = oskar_mem_double2(out, status);
+        for (i = 0; i < num; ++i) t_out[i] = t_in[idx[i]];
+    }
+    else
+    {
+        const float2* restrict t_in = oskar_mem_float2_const(in, status);
+        float2* restrict t_out = oskar_mem_float2(out, status);
+        for (i = 0; i < num; ++i) t_out[i] = t_in[idx[i]];
+    }
+}
+
+static size_t* sort_index(oskar_Imager* h, size_t num_vis,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        int* status)
+{
+    int *tile_id, *w_plane, max_support = 0, tile_size, grid_size;
+    int t, num_tiles, num_buckets;
+    size_t i, num_w_planes, *bucket_start, *sorted, *tile_start;
+    const int* support;
+
+    /* Only the gridding algorithms benefit from sorting. */
+    if (h->algorithm == OSKAR_ALGORITHM_FFT)
+    {
+        num_w_planes = 1;
+        support = &h->support;
+    }
+    else if (h->algorithm == OSKAR_ALGORITHM_WPROJ)
+    {
+        num_w_planes = (size_t) h->num_w_planes;
+        support = oskar_mem_int_const(h->w_support, status);
+    }
+    else return 0;
+
+    /* Find the W-plane and grid tile of each visibility. */
+    for (i = 0; i < num_w_planes; ++i)
+        if (support[i] > max_support) max_support = support[i];
+    grid_size = oskar_imager_plane_size(h);
+    tile_size = oskar_grid_tiles_size(max_support);
+    num_tiles = (grid_size + tile_size - 1) / tile_size;
+    num_tiles *= num_tiles;
+    tile_id = (int*) malloc(num_vis * sizeof(int));
+    w_plane = (int*) malloc(num_vis * sizeof(int));
+    if (!tile_id || !w_plane)
+    {
+        free(tile_id);
+        free(w_plane);
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+    if (h->imager_prec == OSKAR_DOUBLE)
+        oskar_grid_tiles_find_d(num_w_planes, support, num_vis,
+                oskar_mem_double_const(uu, status),
+                oskar_mem_double_const(vv, status),
+                h->algorithm == OSKAR_ALGORITHM_WPROJ ?
+                        oskar_mem_double_const(ww, status) : 0,
+                h->cellsize_rad, h->w_scale, grid_size, tile_size,
+                tile_id, w_plane);
+    else
+        oskar_grid_tiles_find_f(num_w_planes, support, num_vis,
+                oskar_mem_float_const(uu, status),
+                oskar_mem_float_const(vv, status),
+                h->algorithm == OSKAR_ALGORITHM_WPROJ ?
+                        oskar_mem_float_const(ww, status) : 0,
+                (float) (h->cellsize_rad), (float) (h->w_scale),
+                grid_size, tile_size, tile_id, w_plane);
+
+    /* Bucket by tile, then by W-plane within each tile, so that each tile
+     * is a contiguous block that the tiled gridders can use directly.
+     * Visibilities that will be skipped by the gridder go in the last
+     * bucket. */
+    num_buckets = num_tiles * (int) num_w_planes + 1;
+    for (i = 0; i < num_vis; ++i)
+        tile_id[i] = (tile_id[i] < 0) ? num_buckets - 1 :
+                tile_id[i] * (int) num_w_planes + w_plane[i];
+    free(w_plane);
+    bucket_start = (size_t*) malloc((num_buckets + 1) * sizeof(size_t));
+    sorted = (size_t*) malloc(num_vis * sizeof(size_t));
+    tile_start = (size_t*) realloc(h->tile_start,
+            (num_tiles + 1) * sizeof(size_t));
+    if (tile_start) h->tile_start = tile_start;
+    if (!bucket_start || !sorted || !tile_start)
+    {
+        free(tile_id);
+        free(bucket_start);
+        free(sorted);
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+    oskar_grid_tiles_bucket(num_vis, tile_id, num_buckets,
+            bucket_start, sorted);
+
+    /* Store the start of each tile for the gridders. */
+    for (t = 0; t <= num_tiles; ++t)
+        tile_start[t] = bucket_start[t * num_w_planes];
+    h->num_tiles = num_tiles;
+    free(tile_id);
+    free(bucket_start);
+    return sorted;
+}
+
+void oskar_imager_sort_vis(oskar_Imager* h, size_t num_vis,
+        const oskar_Mem** uu, const oskar_Mem** vv, const oskar_Mem** ww,
+        const oskar_Mem** amps, const oskar_Mem** weight, int* status)
+{
+    size_t* sorted;
+    h->num_tiles = 0;
+    if (*status || num_vis < 2) return;
+    oskar_timer_resume(h->tmr_sort);
+    sorted = sort_index(h, num_vis, *uu, *vv, *ww, status);
+    if (sorted)
+    {
+        /* Re-order the visibility data into scratch arrays. */
+        gather(num_vis, sorted, *uu, h->uu_sort, status);
+        gather(num_vis, sorted, *vv, h->vv_sort, status);
+        gather(num_vis, sorted, *amps, h->vis_sort, status);
+        gather(num_vis, sorted, *weight, h->weight_sort, status);
+        *uu = h->uu_sort;
+        *vv = h->vv_sort;
+        *amps = h->vis_sort;
+        *weight = h->weight_sort;
+        if (h->algorithm == OSKAR_ALGORITHM_WPROJ)
+        {
+            gather(num_vis, sorted, *ww, h->ww_sort, status);
+            *ww = h->ww_sort;
+        }
+        free(sorted);
+    }
+    oskar_timer_pause(h->tmr_sort);
+}
+
+static void gather_swap(size_t num, const size_t* idx, oskar_Mem** data,
+        oskar_Mem** scratch, int* status)
+{
+    oskar_Mem* t;
+    if (*status) return;
+    if (oskar_mem_length(*scratch) < oskar_mem_length(*data))
+        oskar_mem_realloc(*scratch, oskar_mem_length(*data), status);
+    gather(num, idx, *data, *scratch, status);
+    t = *data;
+    *data = *scratch;
+    *scratch = t;
+}
+
+void oskar_imager_sort_vis_multi(oskar_Imager* h, size_t num_vis,
+        int num_planes, int* status)
+{
+    int p;
+    size_t* sorted;
+    h->num_tiles = 0;
+    if (*status || num_vis < 2) return;
+    oskar_timer_resume(h->tmr_sort);
+    sorted = sort_index(h, num_vis, h->uu_im, h->vv_im, h->ww_im, status);
+    if (sorted)
+    {
+        /* Re-order the shared coordinates and the data for each plane,
+         * swapping the scratch arrays with the ones they replace. */
+        gather_swap(num_vis, sorted, &h->uu_im, &h->uu_sort, status);
+        gather_swap(num_vis, sorted, &h->vv_im, &h->vv_sort, status);
+        for (p = 0; p < num_planes; ++p)
+        {
+            gather_swap(num_vis, sorted, &h->vis_pol[p], &h->vis_sort,
+                    status);
+            gather_swap(num_vis, sorted, &h->weight_pol[p], &h->weight_sort,
+                    status);
+        }
+        free(sorted);
+    }
+    oskar_timer_pause(h->tmr_sort);
+}
+
+#ifdef __cplusplus
+}
+#endif
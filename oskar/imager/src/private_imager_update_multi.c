@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/oskar_grid_simple_multi.h"
+#include "imager/private_imager_select_data.h"
+#include "imager/private_imager_sort_vis.h"
+#include "imager/private_imager_update_multi.h"
+#include "imager/private_imager_weight_radial.h"
+#include "imager/private_imager_weight_uniform.h"
+
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MAX_POLS 4
+
+/* Moves the elements of the array that are kept to the start of it. */
+static void compact(size_t num, const unsigned char* keep, oskar_Mem* mem,
+        int* status)
+{
+    size_t i, j;
+    const size_t size = oskar_mem_element_size(oskar_mem_type(mem));
+    char* p = oskar_mem_char(mem);
+    if (*status) return;
+    for (i = 0, j = 0; i < num; ++i)
+    {
+        if (!keep[i]) continue;
+        if (j != i) memcpy(p + j * size, p + i * size, size);
+        ++j;
+    }
+}
+
+/*
+ * Applies the time and baseline length filters, if set, to the selected
+ * data for all polarisations. The filters depend only on the baseline
+ * coordinates and the time, which are the same for every polarisation,
+ * so the visibilities to keep are found once and removed from each plane.
+ */
+static void filter_multi(const oskar_Imager* h, int num_planes,
+        size_t* num_vis, int use_time, int* status)
+{
+    int p, use_uv;
+    size_t i, n = 0;
+    unsigned char* keep;
+    double uv_range[2], time_range[2];
+    const double *t, *u_d = 0, *v_d = 0;
+    const float *u_f = 0, *v_f = 0;
+    use_uv = !(h->uv_filter_min <= 0.0 && h->uv_filter_max < 0.0);
+    use_time = use_time &&
+            !(h->time_min_utc <= 0.0 && h->time_max_utc <= 0.0);
+    if (*status || (!use_uv && !use_time) || *num_vis == 0) return;
+    keep = (unsigned char*) malloc(*num_vis);
+    if (!keep)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+
+    /* Get the ranges, as in oskar_imager_filter_uv() and
+     * oskar_imager_filter_time(). */
+    uv_range[0] = h->uv_filter_min;
+    uv_range[1] = (h->uv_filter_max < 0.0) ?
+            (double) FLT_MAX : h->uv_filter_max;
+    uv_range[0] *= uv_range[0];
+    uv_range[1] *= uv_range[1];
+    time_range[0] = h->time_min_utc;
+    time_range[1] = (h->time_max_utc <= 0.0) ?
+            (double) FLT_MAX : h->time_max_utc;
+    t = use_time ? oskar_mem_double_const(h->time_im, status) : 0;
+    if (h->imager_prec == OSKAR_DOUBLE)
+    {
+        u_d = oskar_mem_double_const(h->uu_im, status);
+        v_d = oskar_mem_double_const(h->vv_im, status);
+    }
+    else
+    {
+        u_f = oskar_mem_float_const(h->uu_im, status);
+        v_f = oskar_mem_float_const(h->vv_im, status);
+    }
+    if (*status)
+    {
+        free(keep);
+        return;
+    }
+
+    /* Find the visibilities to keep. */
+    for (i = 0; i < *num_vis; ++i)
+    {
+        int k = 1;
+        if (use_uv)
+        {
+            const double r = u_d ? u_d[i] * u_d[i] + v_d[i] * v_d[i] :
+                    u_f[i] * u_f[i] + v_f[i] * v_f[i];
+            k = (r >= uv_range[0] && r <= uv_range[1]);
+        }
+        if (use_time)
+            k = k && (t[i] >= time_range[0] && t[i] <= time_range[1]);
+        keep[i] = (unsigned char) k;
+        n += k;
+    }
+
+    /* Remove the others from all the arrays. */
+    if (n < *num_vis)
+    {
+        compact(*num_vis, keep, h->uu_im, status);
+        compact(*num_vis, keep, h->vv_im, status);
+        compact(*num_vis, keep, h->ww_im, status);
+        for (p = 0; p < num_planes; ++p)
+        {
+            compact(*num_vis, keep, h->vis_pol[p], status);
+            compact(*num_vis, keep, h->weight_pol[p], status);
+        }
+        *num_vis = n;
+    }
+    free(keep);
+}
+
+
+int oskar_imager_update_multi_enabled(const oskar_Imager* h)
+{
+    /* Only for the FFT algorithm when making more than one polarisation. */
+    return !(h->coords_only || h->algorithm != OSKAR_ALGORITHM_FFT ||
+            h->num_im_pols < 2 || h->num_im_pols > MAX_POLS);
+}
+
+
+void oskar_imager_update_multi(oskar_Imager* h, size_t num_rows,
+        int start_chan, int end_chan, int num_pols, const oskar_Mem* uu,
+        const oskar_Mem* vv, const oskar_Mem* ww, const oskar_Mem* amps,
+        const oskar_Mem* weight, const oskar_Mem* time_centroid,
+        int* status)
+{
+    int c, p, grid_size, use_time;
+    size_t max_num_vis, num_cells;
+    const int num_planes = h->num_im_pols;
+    if (*status) return;
+    grid_size = oskar_imager_plane_size(h);
+    num_cells = grid_size * grid_size;
+    use_time = time_centroid && oskar_mem_length(time_centroid) > 0;
+
+    /* Ensure work arrays are large enough. */
+    max_num_vis = num_rows;
+    if (!h->chan_snaps) max_num_vis *= (1 + end_chan - start_chan);
+    for (p = 0; p < num_planes; ++p)
+    {
+        oskar_mem_realloc(h->vis_pol[p], max_num_vis, status);
+        oskar_mem_realloc(h->weight_pol[p], max_num_vis, status);
+    }
+
+    /* Loop over image channels. */
+    for (c = 0; c < h->num_im_channels; ++c)
+    {
+        oskar_Mem *pu, *pv, *pw;
+        size_t num_vis = 0, num_skipped = 0;
+        if (*status) break;
+
+        /* Get the visibility data for all polarisations of this channel.
+         * The baseline coordinates are the same for all of them. */
+        pu = h->uu_im; pv = h->vv_im; pw = h->ww_im;
+        if (h->direction_type == 'R')
+        {
+            pu = h->uu_tmp; pv = h->vv_tmp; pw = h->ww_tmp;
+        }
+        for (p = 0; p < num_planes; ++p)
+            oskar_imager_select_data(h, num_rows, start_chan, end_chan,
+                    num_pols, uu, vv, ww, amps, weight,
+                    use_time ? time_centroid : 0, h->im_freqs[c], p,
+                    &num_vis, p == 0 ? pu : 0, p == 0 ? pv : 0,
+                    p == 0 ? pw : 0, h->vis_pol[p], h->weight_pol[p],
+                    (p == 0 && use_time) ? h->time_im : 0, status);
+
+        /* Skip if nothing was selected. */
+        if (*status || num_vis == 0) continue;
+
+        /* Rotate baseline coordinates and phase rotate if required. */
+        if (h->direction_type == 'R')
+        {
+            oskar_imager_rotate_coords(h, num_vis,
+                    h->uu_tmp, h->vv_tmp, h->ww_tmp,
+                    h->uu_im, h->vv_im, h->ww_im);
+            for (p = 0; p < num_planes; ++p)
+                oskar_imager_rotate_vis(h, num_vis,
+                        h->uu_tmp, h->vv_tmp, h->ww_tmp, h->vis_pol[p]);
+        }
+
+        /* Apply time and baseline length filters if required. */
+        filter_multi(h, num_planes, &num_vis, use_time, status);
+        if (*status || num_vis == 0) continue;
+        oskar_timer_resume(h->tmr_grid_update);
+
+        /* Re-weight visibilities if required. */
+        for (p = 0; p < num_planes; ++p)
+        {
+            oskar_Mem* wt = h->weight_pol[p];
+            switch (h->weighting)
+            {
+            case OSKAR_WEIGHTING_NATURAL:
+                /* Nothing to do. */
+                break;
+            case OSKAR_WEIGHTING_RADIAL:
+                oskar_imager_weight_radial(num_vis, h->uu_im, h->vv_im,
+                        wt, wt, status);
+                break;
+            case OSKAR_WEIGHTING_UNIFORM:
+                oskar_imager_weight_uniform(num_vis, h->uu_im, h->vv_im,
+                        wt, wt, h->cellsize_rad, grid_size,
+                        h->weights_grids[num_planes * c + p], status);
+                break;
+            default:
+                *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
+                break;
+            }
+        }
+
+        /* Sort visibilities by grid tile, once for all planes. */
+        oskar_imager_sort_vis_multi(h, num_vis, num_planes, status);
+
+        /* Check the planes. */
+        for (p = 0; p < num_planes; ++p)
+        {
+            oskar_Mem* plane = h->planes[num_planes * c + p];
+            if (oskar_mem_precision(plane) != h->imager_prec)
+                *status = OSKAR_ERR_TYPE_MISMATCH;
+            if (oskar_mem_length(plane) < num_cells)
+                oskar_mem_realloc(plane, num_cells, status);
+        }
+
+        /* Grid all polarisations of this channel in one pass. */
+        if (!*status)
+        {
+            if (h->imager_prec == OSKAR_DOUBLE)
+            {
+                const double *vis[MAX_POLS], *wt[MAX_POLS];
+                double *grid[MAX_POLS];
+                for (p = 0; p < num_planes; ++p)
+                {
+                    vis[p] = oskar_mem_double_const(h->vis_pol[p], status);
+                    wt[p] = oskar_mem_double_const(h->weight_pol[p], status);
+                    grid[p] = oskar_mem_double(
+                            h->planes[num_planes * c + p], status);
+                }
+                oskar_grid_simple_multi_sorted_d(h->support,
+                        h->oversample,
+                        oskar_mem_double_const(h->conv_func, status),
+                        num_planes, num_vis, h->num_tiles ? h->tile_start : 0,
+                        oskar_mem_double_const(h->uu_im, status),
+                        oskar_mem_double_const(h->vv_im, status),
+                        vis, wt, h->cellsize_rad, grid_size, &num_skipped,
+                        &h->plane_norm[num_planes * c], grid);
+            }
+            else
+            {
+                const float *vis[MAX_POLS], *wt[MAX_POLS];
+                float *grid[MAX_POLS];
+                for (p = 0; p < num_planes; ++p)
+                {
+                    vis[p] = oskar_mem_float_const(h->vis_pol[p], status);
+                    wt[p] = oskar_mem_float_const(h->weight_pol[p], status);
+                    grid[p] = oskar_mem_float(
+                            h->planes[num_planes * c + p], status);
+                }
+                oskar_grid_simple_multi_sorted_f(h->support,
+                        h->oversample,
+                        oskar_mem_float_const(h->conv_func, status),
+                        num_planes, num_vis, h->num_tiles ? h->tile_start : 0,
+                        oskar_mem_float_const(h->uu_im, status),
+                        oskar_mem_float_const(h->vv_im, status),
+                        vis, wt, (float) (h->cellsize_rad), grid_size,
+                        &num_skipped, &h->plane_norm[num_planes * c], grid);
+            }
+        }
+        oskar_timer_pause(h->tmr_grid_update);
+
+        if (num_skipped > 0)
+            printf("WARNING: Skipped %lu visibility points.\n",
+                    (unsigned long) (num_skipped * num_planes));
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
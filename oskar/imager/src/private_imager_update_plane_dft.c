@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -33,8 +33,10 @@
 #include "imager/oskar_imager.h"
 #include "math/oskar_cmath.h"
 #include "math/oskar_dft_c2r.h"
+#include "math/oskar_dft_c2r_2d_separable_omp.h"
 #include "utility/oskar_device_utils.h"
 #include "utility/oskar_thread.h"
+#include "utility/oskar_thread_pool.h"
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -44,53 +46,98 @@
 extern "C" {
 #endif
 
+/* Limit on the memory used by the column phase factors of the separable
+ * 2D DFT. Visibilities are processed in chunks small enough to fit. */
+#define MAX_COLUMN_TABLE_BYTES ((size_t) 64 << 20)
+
 static void* run_blocks(void* arg);
 
 struct ThreadArgs
 {
     oskar_Imager* h;
-    oskar_Mem* plane;
+    oskar_Mem *plane;
+    const oskar_Mem *l_axis, *m_axis, *columns; /* Shared by CPU devices. */
+    const oskar_Mem *uu, *vv, *ww, *amp, *weight; /* Shared by CPU devices. */
     int thread_id, num_vis;
 };
 typedef struct ThreadArgs ThreadArgs;
 
-void oskar_imager_update_plane_dft(oskar_Imager* h, size_t num_vis,
+static void update_chunk(oskar_Imager* h, size_t num_vis,
         const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
         const oskar_Mem* amps, const oskar_Mem* weight, oskar_Mem* plane,
-        double* plane_norm, int* status)
+        const oskar_Mem* l_axis, const oskar_Mem* m_axis,
+        oskar_Mem* columns, int* status)
 {
-    size_t i, num_pixels, num_threads;
-    oskar_Thread** threads = 0;
+    size_t i, num_threads;
+    int on_cpu;
+    oskar_Future** futures = 0;
     ThreadArgs* args = 0;
+    const oskar_Mem *uu_cpu = uu, *vv_cpu = vv, *ww_cpu = ww;
+    const oskar_Mem *amp_cpu = amps, *weight_cpu = weight;
     if (*status) return;
 
-    /* Check the image plane. */
-    num_pixels = (size_t) h->image_size;
-    num_pixels *= num_pixels;
-    if (oskar_mem_precision(plane) != h->imager_prec)
-        *status = OSKAR_ERR_TYPE_MISMATCH;
-    if (oskar_mem_is_complex(plane) || oskar_mem_is_matrix(plane))
-        *status = OSKAR_ERR_BAD_DATA_TYPE;
-    if (oskar_mem_length(plane) < num_pixels)
-        oskar_mem_realloc(plane, num_pixels, status);
-    if (*status) return;
-
-    /* Copy visibility data to each device. */
+    /* Copy visibility data to each GPU. The CPU devices all share the
+     * input data, or a single copy of it if it is not in CPU memory. */
     num_threads = (size_t) (h->num_devices);
+    on_cpu = oskar_mem_location(uu) == OSKAR_CPU &&
+            oskar_mem_location(vv) == OSKAR_CPU &&
+            oskar_mem_location(amps) == OSKAR_CPU &&
+            oskar_mem_location(weight) == OSKAR_CPU &&
+            (h->algorithm != OSKAR_ALGORITHM_DFT_3D ||
+                    oskar_mem_location(ww) == OSKAR_CPU);
     for (i = 0; i < num_threads; ++i)
     {
+        DeviceData* d = &h->d[i];
         if (i < (size_t) (h->num_gpus))
             oskar_device_set(h->gpu_ids[i], status);
-        oskar_mem_copy(h->d[i].uu, uu, status);
-        oskar_mem_copy(h->d[i].vv, vv, status);
-        oskar_mem_copy(h->d[i].amp, amps, status);
-        oskar_mem_copy(h->d[i].weight, weight, status);
+        else if (on_cpu || i > (size_t) (h->num_gpus))
+            break;
+        oskar_mem_copy(d->uu, uu, status);
+        oskar_mem_copy(d->vv, vv, status);
+        oskar_mem_copy(d->amp, amps, status);
+        oskar_mem_copy(d->weight, weight, status);
         if (h->algorithm == OSKAR_ALGORITHM_DFT_3D)
-            oskar_mem_copy(h->d[i].ww, ww, status);
+            oskar_mem_copy(d->ww, ww, status);
+        if (i == (size_t) (h->num_gpus))
+        {
+            uu_cpu = d->uu;
+            vv_cpu = d->vv;
+            ww_cpu = d->ww;
+            amp_cpu = d->amp;
+            weight_cpu = d->weight;
+        }
     }
 
-    /* Set up worker threads. */
-    threads = (oskar_Thread**) calloc(num_threads, sizeof(oskar_Thread*));
+    /* Tabulate the column phase factors once, for all CPU devices. */
+    if (columns && !*status)
+    {
+        const int size = h->image_size;
+        const size_t num = num_vis * (size_t) size;
+        if (h->imager_prec == OSKAR_DOUBLE)
+        {
+            double* t = oskar_mem_double(columns, status);
+            oskar_dft_c2r_2d_separable_columns_d((int) num_vis, 2.0 * M_PI,
+                    oskar_mem_double_const(uu_cpu, status), size,
+                    oskar_mem_double_const(l_axis, status), t, t + num);
+        }
+        else
+        {
+            float* t = oskar_mem_float(columns, status);
+            oskar_dft_c2r_2d_separable_columns_f((int) num_vis,
+                    (float) (2.0 * M_PI),
+                    oskar_mem_float_const(uu_cpu, status), size,
+                    oskar_mem_float_const(l_axis, status), t, t + num);
+        }
+    }
+
+    /* Set up worker threads, re-using the thread pool if possible. */
+    if (oskar_thread_pool_num_threads(h->pool) != (int) num_threads)
+    {
+        oskar_thread_pool_free(h->pool);
+        h->pool = oskar_thread_pool_create((int) num_threads, 0, status);
+    }
+    if (*status) return;
+    futures = (oskar_Future**) calloc(num_threads, sizeof(oskar_Future*));
     args = (ThreadArgs*) calloc(num_threads, sizeof(ThreadArgs));
     for (i = 0; i < num_threads; ++i)
     {
@@ -98,6 +145,14 @@ void oskar_imager_update_plane_dft(oskar_Imager* h, size_t num_vis,
         args[i].thread_id = (int) i;
         args[i].num_vis = (int) num_vis;
         args[i].plane = plane;
+        args[i].l_axis = l_axis;
+        args[i].m_axis = m_axis;
+        args[i].columns = columns;
+        args[i].uu = uu_cpu;
+        args[i].vv = vv_cpu;
+        args[i].ww = ww_cpu;
+        args[i].amp = amp_cpu;
+        args[i].weight = weight_cpu;
     }
 
     /* Set status code. */
@@ -105,20 +160,99 @@ void oskar_imager_update_plane_dft(oskar_Imager* h, size_t num_vis,
 
     /* Start the worker threads. */
     h->i_block = 0;
-    for (i = 0; i < num_threads; ++i)
-        threads[i] = oskar_thread_create(run_blocks, (void*)&args[i], 0);
+    oskar_thread_pool_submit_all(h->pool, (int) num_threads, run_blocks,
+            (void*)args, sizeof(ThreadArgs), futures, status);
 
     /* Wait for worker threads to finish. */
     for (i = 0; i < num_threads; ++i)
-    {
-        oskar_thread_join(threads[i]);
-        oskar_thread_free(threads[i]);
-    }
-    free(threads);
+        oskar_future_free(futures[i]);
+    free(futures);
     free(args);
 
     /* Get status code. */
-    *status = h->status;
+    if (!*status) *status = h->status;
+}
+
+void oskar_imager_update_plane_dft(oskar_Imager* h, size_t num_vis,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        const oskar_Mem* amps, const oskar_Mem* weight, oskar_Mem* plane,
+        double* plane_norm, int* status)
+{
+    size_t i, num_pixels, chunk_size;
+    oskar_Mem *l_axis = 0, *m_axis = 0, *columns = 0;
+    if (*status) return;
+
+    /* Check the image plane. */
+    num_pixels = (size_t) h->image_size;
+    num_pixels *= num_pixels;
+    if (oskar_mem_precision(plane) != h->imager_prec)
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+    if (oskar_mem_is_complex(plane) || oskar_mem_is_matrix(plane))
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+    if (oskar_mem_length(plane) < num_pixels)
+        oskar_mem_realloc(plane, num_pixels, status);
+    if (*status) return;
+
+    /* The 2D pixel grid is regular, so the DFT on the CPU separates into
+     * row and column terms. Get the axis coordinates from the central
+     * row and column of the grid. The column terms are tabulated for a
+     * chunk of visibilities at a time, and shared by all CPU devices. */
+    chunk_size = num_vis;
+    if (h->algorithm == OSKAR_ALGORITHM_DFT_2D &&
+            h->num_devices > h->num_gpus)
+    {
+        int j;
+        const int size = h->image_size;
+        const size_t bytes_per_vis = 2 * (size_t) size *
+                oskar_mem_element_size(h->imager_prec);
+        l_axis = oskar_mem_create(h->imager_prec, OSKAR_CPU, size, status);
+        m_axis = oskar_mem_create(h->imager_prec, OSKAR_CPU, size, status);
+        for (j = 0; j < size; ++j)
+        {
+            oskar_mem_copy_contents(l_axis, h->l, j,
+                    (size / 2) * size + j, 1, status);
+            oskar_mem_copy_contents(m_axis, h->m, j,
+                    j * size + size / 2, 1, status);
+        }
+        chunk_size = MAX_COLUMN_TABLE_BYTES / bytes_per_vis;
+        if (chunk_size < 1) chunk_size = 1;
+        if (chunk_size > num_vis) chunk_size = num_vis;
+        columns = oskar_mem_create(h->imager_prec, OSKAR_CPU,
+                2 * chunk_size * (size_t) size, status);
+    }
+
+    /* Update the plane with each chunk of visibilities.
+     * Chunks are only used for the 2D DFT, which does not need ww. */
+    if (chunk_size == num_vis)
+        update_chunk(h, num_vis, uu, vv, ww, amps, weight, plane,
+                l_axis, m_axis, columns, status);
+    else
+    {
+        oskar_Mem *u_, *v_, *a_, *wt_;
+        u_ = oskar_mem_create_alias(0, 0, 0, status);
+        v_ = oskar_mem_create_alias(0, 0, 0, status);
+        a_ = oskar_mem_create_alias(0, 0, 0, status);
+        wt_ = oskar_mem_create_alias(0, 0, 0, status);
+        for (i = 0; i < num_vis && !*status; i += chunk_size)
+        {
+            const size_t n = (num_vis - i < chunk_size) ?
+                    num_vis - i : chunk_size;
+            oskar_mem_set_alias(u_, uu, i, n, status);
+            oskar_mem_set_alias(v_, vv, i, n, status);
+            oskar_mem_set_alias(a_, amps, i, n, status);
+            oskar_mem_set_alias(wt_, weight, i, n, status);
+            update_chunk(h, n, u_, v_, ww, a_, wt_, plane,
+                    l_axis, m_axis, columns, status);
+        }
+        oskar_mem_free(u_, status);
+        oskar_mem_free(v_, status);
+        oskar_mem_free(a_, status);
+        oskar_mem_free(wt_, status);
+    }
+    oskar_mem_free(l_axis, status);
+    oskar_mem_free(m_axis, status);
+    oskar_mem_free(columns, status);
+    if (*status) return;
 
     /* Update normalisation. */
     if (oskar_mem_precision(weight) == OSKAR_DOUBLE)
@@ -138,23 +272,27 @@ void oskar_imager_update_plane_dft(oskar_Imager* h, size_t num_vis,
 static void* run_blocks(void* arg)
 {
     oskar_Imager* h;
-    oskar_Mem *t, *plane;
+    oskar_Mem *t, *plane, *block, *l, *m, *n;
     DeviceData* d;
+    ThreadArgs* a;
     size_t max_block_size, num_pixels;
     const size_t smallest = 1024, largest = 65536;
-    int i_block, thread_id, num_blocks, num_vis;
+    int i_block, thread_id, num_blocks, num_vis, on_cpu, separable;
     int *status;
 
     /* Get thread function arguments. */
-    h = ((ThreadArgs*)arg)->h;
-    thread_id = ((ThreadArgs*)arg)->thread_id;
-    num_vis = ((ThreadArgs*)arg)->num_vis;
-    plane = ((ThreadArgs*)arg)->plane;
+    a = (ThreadArgs*) arg;
+    h = a->h;
+    thread_id = a->thread_id;
+    num_vis = a->num_vis;
+    plane = a->plane;
     status = &(h->status);
 
     /* Set the device used by the thread. */
     d = &h->d[thread_id];
-    if (thread_id < h->num_gpus)
+    on_cpu = (thread_id >= h->num_gpus);
+    separable = on_cpu && (h->algorithm == OSKAR_ALGORITHM_DFT_2D);
+    if (!on_cpu)
         oskar_device_set(h->gpu_ids[thread_id], status);
 
 #ifdef _OPENMP
@@ -163,15 +301,24 @@ static void* run_blocks(void* arg)
     omp_set_num_threads(1);
 #endif
 
-    /* Pointer to output block. */
+    /* Pointers to output block and pixel positions. */
     t = oskar_mem_create_alias(0, 0, 0, status);
+    l = oskar_mem_create_alias(0, 0, 0, status);
+    m = oskar_mem_create_alias(0, 0, 0, status);
+    n = oskar_mem_create_alias(0, 0, 0, status);
 
-    /* Calculate the maximum pixel block size, and number of blocks. */
+    /* Calculate the maximum pixel block size, and number of blocks.
+     * For the 2D DFT, blocks are made of whole rows. */
     num_pixels = h->image_size * h->image_size;
     max_block_size = num_pixels / h->num_devices;
     max_block_size = ((max_block_size + smallest - 1) / smallest) * smallest;
     if (max_block_size > largest) max_block_size = largest;
     if (max_block_size < smallest) max_block_size = smallest;
+    if (h->algorithm == OSKAR_ALGORITHM_DFT_2D)
+    {
+        const size_t row = (size_t) h->image_size;
+        max_block_size = ((max_block_size + row - 1) / row) * row;
+    }
     num_blocks = (int) ((num_pixels + max_block_size - 1) / max_block_size);
 
     /* Loop until all blocks are done. */
@@ -190,34 +337,104 @@ static void* run_blocks(void* arg)
         block_size = num_pixels - block_start;
         if (block_size > max_block_size) block_size = max_block_size;
 
-        /* Copy the l,m,n positions for the block. */
-        if (oskar_mem_length(d->l) < block_size)
-            oskar_mem_realloc(d->l, block_size, status);
-        oskar_mem_copy_contents(d->l, h->l, 0, block_start,
-                block_size, status);
-        if (oskar_mem_length(d->m) < block_size)
-            oskar_mem_realloc(d->m, block_size, status);
-        oskar_mem_copy_contents(d->m, h->m, 0, block_start,
-                block_size, status);
-        if (h->algorithm == OSKAR_ALGORITHM_DFT_3D)
+        if (separable)
         {
-            if (oskar_mem_length(d->n) < block_size)
-                oskar_mem_realloc(d->n, block_size, status);
-            oskar_mem_copy_contents(d->n, h->n, 0, block_start,
-                    block_size, status);
+            /* Run separable DFT for the rows in the block. */
+            const int size = h->image_size;
+            const int row_start = (int) (block_start / size);
+            const int num_rows = (int) (block_size / size);
+            size_t i;
+            block = d->block_cpu;
+            if (oskar_mem_length(block) < block_size)
+                oskar_mem_realloc(block, block_size, status);
+            if (*status) break;
+            if (h->imager_prec == OSKAR_DOUBLE)
+            {
+                const double* l_ = oskar_mem_double_const(h->l, status);
+                const double* cols = oskar_mem_double_const(a->columns,
+                        status);
+                double* out = oskar_mem_double(block, status);
+                oskar_dft_c2r_2d_separable_omp_d(num_vis, 2.0 * M_PI,
+                        oskar_mem_double_const(a->vv, status),
+                        oskar_mem_double2_const(a->amp, status),
+                        oskar_mem_double_const(a->weight, status), size,
+                        cols, cols + (size_t) num_vis * size, num_rows,
+                        oskar_mem_double_const(a->m_axis, status) +
+                        row_start, out, status);
+
+                /* Pixels beyond the horizon are not valid. */
+                for (i = 0; i < block_size; ++i)
+                    if (l_[block_start + i] != l_[block_start + i])
+                        out[i] = l_[block_start + i];
+            }
+            else
+            {
+                const float* l_ = oskar_mem_float_const(h->l, status);
+                const float* cols = oskar_mem_float_const(a->columns,
+                        status);
+                float* out = oskar_mem_float(block, status);
+                oskar_dft_c2r_2d_separable_omp_f(num_vis, (float) (2.0 * M_PI),
+                        oskar_mem_float_const(a->vv, status),
+                        oskar_mem_float2_const(a->amp, status),
+                        oskar_mem_float_const(a->weight, status), size,
+                        cols, cols + (size_t) num_vis * size, num_rows,
+                        oskar_mem_float_const(a->m_axis, status) +
+                        row_start, out, status);
+
+                /* Pixels beyond the horizon are not valid. */
+                for (i = 0; i < block_size; ++i)
+                    if (l_[block_start + i] != l_[block_start + i])
+                        out[i] = l_[block_start + i];
+            }
         }
+        else if (on_cpu)
+        {
+            /* Run DFT for the block, using the pixel positions directly. */
+            block = d->block_dev;
+            oskar_mem_set_alias(l, h->l, block_start, block_size, status);
+            oskar_mem_set_alias(m, h->m, block_start, block_size, status);
+            oskar_mem_set_alias(n, h->n, block_start, block_size, status);
+            oskar_dft_c2r(num_vis, 2.0 * M_PI, a->uu, a->vv, a->ww,
+                    a->amp, a->weight, (int) block_size, l, m, n,
+                    block, status);
+        }
+        else
+        {
+            /* Copy the l,m,n positions for the block. */
+            if (oskar_mem_length(d->l) < block_size)
+                oskar_mem_realloc(d->l, block_size, status);
+            oskar_mem_copy_contents(d->l, h->l, 0, block_start,
+                    block_size, status);
+            if (oskar_mem_length(d->m) < block_size)
+                oskar_mem_realloc(d->m, block_size, status);
+            oskar_mem_copy_contents(d->m, h->m, 0, block_start,
+                    block_size, status);
+            if (h->algorithm == OSKAR_ALGORITHM_DFT_3D)
+            {
+                if (oskar_mem_length(d->n) < block_size)
+                    oskar_mem_realloc(d->n, block_size, status);
+                oskar_mem_copy_contents(d->n, h->n, 0, block_start,
+                        block_size, status);
+            }
 
-        /* Run DFT for the block. */
-        oskar_dft_c2r(num_vis, 2.0 * M_PI, d->uu, d->vv, d->ww,
-                d->amp, d->weight, (int) block_size,
-                d->l, d->m, d->n, d->block_dev, status);
+            /* Run DFT for the block. */
+            oskar_dft_c2r(num_vis, 2.0 * M_PI, d->uu, d->vv, d->ww,
+                    d->amp, d->weight, (int) block_size,
+                    d->l, d->m, d->n, d->block_dev, status);
+
+            /* Copy data to the host. */
+            oskar_mem_copy(d->block_cpu, d->block_dev, status);
+            block = d->block_cpu;
+        }
 
-        /* Copy data to the host and add to existing pixels. */
-        oskar_mem_copy(d->block_cpu, d->block_dev, status);
+        /* Add to existing pixels. */
         oskar_mem_set_alias(t, plane, block_start, block_size, status);
-        oskar_mem_add(t, t, d->block_cpu, block_size, status);
+        oskar_mem_add(t, t, block, block_size, status);
     }
     oskar_mem_free(t, status);
+    oskar_mem_free(l, status);
+    oskar_mem_free(m, status);
+    oskar_mem_free(n, status);
     return 0;
 }
 
@@ -52,8 +52,9 @@ void oskar_imager_update_plane_fft(oskar_Imager* h, size_t num_vis,
         oskar_mem_realloc(plane, num_cells, status);
     if (*status) return;
     if (h->imager_prec == OSKAR_DOUBLE)
-        oskar_grid_simple_d(h->support, h->oversample,
+        oskar_grid_simple_sorted_d(h->support, h->oversample,
                 oskar_mem_double_const(h->conv_func, status), num_vis,
+                h->num_tiles ? h->tile_start : 0,
                 oskar_mem_double_const(uu, status),
                 oskar_mem_double_const(vv, status),
                 oskar_mem_double_const(amps, status),
@@ -61,8 +62,9 @@ void oskar_imager_update_plane_fft(oskar_Imager* h, size_t num_vis,
                 h->cellsize_rad, grid_size, num_skipped, plane_norm,
                 oskar_mem_double(plane, status));
     else
-        oskar_grid_simple_f(h->support, h->oversample,
+        oskar_grid_simple_sorted_f(h->support, h->oversample,
                 oskar_mem_float_const(h->conv_func, status), num_vis,
+                h->num_tiles ? h->tile_start : 0,
                 oskar_mem_float_const(uu, status),
                 oskar_mem_float_const(vv, status),
                 oskar_mem_float_const(amps, status),
@@ -60,10 +60,11 @@ void oskar_imager_update_plane_wproj(oskar_Imager* h, size_t num_vis,
         oskar_mem_realloc(plane, num_cells, status);
     if (*status) return;
     if (h->imager_prec == OSKAR_DOUBLE)
-        oskar_grid_wproj_d(h->num_w_planes,
+        oskar_grid_wproj_sorted_d(h->num_w_planes,
                 oskar_mem_int_const(h->w_support, status),
                 h->oversample, h->conv_size_half,
                 oskar_mem_double_const(h->w_kernels, status), num_vis,
+                h->num_tiles ? h->tile_start : 0,
                 oskar_mem_double_const(uu, status),
                 oskar_mem_double_const(vv, status),
                 oskar_mem_double_const(ww, status),
@@ -106,10 +107,11 @@ void oskar_imager_update_plane_wproj(oskar_Imager* h, size_t num_vis,
             fclose(f);
         }
 #endif
-        oskar_grid_wproj_f(h->num_w_planes,
+        oskar_grid_wproj_sorted_f(h->num_w_planes,
                 oskar_mem_int_const(h->w_support, status),
                 h->oversample, h->conv_size_half,
                 oskar_mem_float_const(h->w_kernels, status), num_vis,
+                h->num_tiles ? h->tile_start : 0,
                 oskar_mem_float_const(uu, status),
                 oskar_mem_float_const(vv, status),
                 oskar_mem_float_const(ww, status),
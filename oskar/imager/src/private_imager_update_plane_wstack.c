@@ -0,0 +1,314 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/private_imager_finalise_plane_wstack.h"
+#include "imager/private_imager_update_plane_wstack.h"
+#include "imager/private_imager_wstack_layers.h"
+#include "imager/oskar_grid_simple.h"
+#include "imager/oskar_grid_tiles.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Finds the W-layer of each visibility, using the conjugate of visibilities
+ * with negative W so that only non-negative W values need to be stacked.
+ */
+static void find_layers_d(size_t num, const double* restrict ww,
+        double inv_spacing, int num_layers, int* restrict layer)
+{
+    size_t i;
+    for (i = 0; i < num; ++i)
+    {
+        int k = (int) round(fabs(ww[i]) * inv_spacing);
+        layer[i] = (k < num_layers) ? k : num_layers - 1;
+    }
+}
+
+static void find_layers_f(size_t num, const float* restrict ww,
+        double inv_spacing, int num_layers, int* restrict layer)
+{
+    size_t i;
+    for (i = 0; i < num; ++i)
+    {
+        int k = (int) round(fabs((double) ww[i]) * inv_spacing);
+        layer[i] = (k < num_layers) ? k : num_layers - 1;
+    }
+}
+
+static void gather_d(size_t num, const size_t* restrict idx,
+        const double* restrict uu, const double* restrict vv,
+        const double* restrict ww, const double2* restrict vis,
+        const double* restrict weight, double* restrict uu_out,
+        double* restrict vv_out, double2* restrict vis_out,
+        double* restrict weight_out)
+{
+    size_t i;
+    for (i = 0; i < num; ++i)
+    {
+        const size_t j = idx[i];
+        const double s = (ww[j] < 0.0) ? -1.0 : 1.0;
+        uu_out[i] = s * uu[j];
+        vv_out[i] = s * vv[j];
+        vis_out[i].x = vis[j].x;
+        vis_out[i].y = s * vis[j].y;
+        weight_out[i] = weight[j];
+    }
+}
+
+static void gather_f(size_t num, const size_t* restrict idx,
+        const float* restrict uu, const float* restrict vv,
+        const float* restrict ww, const float2* restrict vis,
+        const float* restrict weight, float* restrict uu_out,
+        float* restrict vv_out, float2* restrict vis_out,
+        float* restrict weight_out)
+{
+    size_t i;
+    for (i = 0; i < num; ++i)
+    {
+        const size_t j = idx[i];
+        const float s = (ww[j] < 0.0f) ? -1.0f : 1.0f;
+        uu_out[i] = s * uu[j];
+        vv_out[i] = s * vv[j];
+        vis_out[i].x = vis[j].x;
+        vis_out[i].y = s * vis[j].y;
+        weight_out[i] = weight[j];
+    }
+}
+
+static void ensure_length(oskar_Mem* mem, size_t length, int* status)
+{
+    if (oskar_mem_length(mem) < length)
+        oskar_mem_realloc(mem, length, status);
+}
+
+static void grid_layer(const oskar_Imager* h, size_t start, size_t num,
+        int grid_size, size_t* num_skipped, double* norm, oskar_Mem* grid,
+        int* status)
+{
+    if (h->imager_prec == OSKAR_DOUBLE)
+        oskar_grid_simple_d(h->support, h->oversample,
+                oskar_mem_double_const(h->conv_func, status), num,
+                oskar_mem_double_const(h->uu_sort, status) + start,
+                oskar_mem_double_const(h->vv_sort, status) + start,
+                oskar_mem_double_const(h->vis_sort, status) + 2 * start,
+                oskar_mem_double_const(h->weight_sort, status) + start,
+                h->cellsize_rad, grid_size, num_skipped, norm,
+                oskar_mem_double(grid, status));
+    else
+        oskar_grid_simple_f(h->support, h->oversample,
+                oskar_mem_float_const(h->conv_func, status), num,
+                oskar_mem_float_const(h->uu_sort, status) + start,
+                oskar_mem_float_const(h->vv_sort, status) + start,
+                oskar_mem_float_const(h->vis_sort, status) + 2 * start,
+                oskar_mem_float_const(h->weight_sort, status) + start,
+                (float) (h->cellsize_rad), grid_size, num_skipped, norm,
+                oskar_mem_float(grid, status));
+}
+
+/*
+ * Grids the given W-layers. If there are enough layers to keep all threads
+ * busy, they are gridded concurrently; otherwise the gridder uses the
+ * threads.
+ */
+static void grid_layers(const oskar_Imager* h, int num_active,
+        const int* active, const size_t* layer_start, oskar_Mem** layers,
+        int grid_size, size_t* num_skipped, double* plane_norm, int* status)
+{
+    int i, num_threads = 1;
+    size_t skipped = 0;
+    double norm = 0.0;
+#ifdef _OPENMP
+    num_threads = omp_get_max_threads();
+#endif
+#pragma omp parallel for schedule(dynamic, 1) reduction(+:skipped, norm) \
+        if (num_active >= num_threads && num_threads > 1)
+    for (i = 0; i < num_active; ++i)
+    {
+        const int kk = active[i];
+        size_t layer_skipped = 0;
+        double layer_norm = 0.0;
+        int layer_status = 0;
+        grid_layer(h, layer_start[kk], layer_start[kk + 1] -
+                layer_start[kk], grid_size, &layer_skipped, &layer_norm,
+                layers[kk], &layer_status);
+        skipped += layer_skipped;
+        norm += layer_norm;
+        if (layer_status)
+        {
+#pragma omp critical (oskar_imager_wstack_status)
+            *status = layer_status;
+        }
+    }
+    *num_skipped += skipped;
+    *plane_norm += norm;
+}
+
+void oskar_imager_update_plane_wstack(oskar_Imager* h, size_t num_vis,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        const oskar_Mem* amps, const oskar_Mem* weight, oskar_Mem* plane,
+        double* plane_norm, size_t* num_skipped, int* status)
+{
+    int i, k, grid_size, num_layers, num_active = 0, num_held = 0;
+    int max_layers, *layer, *active;
+    size_t num_cells, *layer_start, *sorted;
+    double inv_spacing;
+    oskar_Mem** layers;
+    if (*status) return;
+    if (oskar_mem_precision(plane) != h->imager_prec)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    grid_size = oskar_imager_plane_size(h);
+    num_cells = (size_t) grid_size * (size_t) grid_size;
+    if (oskar_mem_length(plane) < num_cells)
+        oskar_mem_realloc(plane, num_cells, status);
+    num_layers = h->num_w_planes;
+    inv_spacing = (h->w_layer_spacing > 0.0) ? 1.0 / h->w_layer_spacing : 0.0;
+    layers = oskar_imager_wstack_layers(h, plane, 1);
+    if (!layers)
+    {
+        *status = OSKAR_ERR_MEMORY_NOT_ALLOCATED;
+        return;
+    }
+
+    /* Ensure scratch arrays are large enough. */
+    ensure_length(h->uu_sort, num_vis, status);
+    ensure_length(h->vv_sort, num_vis, status);
+    ensure_length(h->vis_sort, num_vis, status);
+    ensure_length(h->weight_sort, num_vis, status);
+    if (*status) return;
+
+    /* Bucket visibilities by W-layer, conjugating those with negative W. */
+    layer = (int*) malloc(num_vis * sizeof(int));
+    layer_start = (size_t*) malloc((num_layers + 1) * sizeof(size_t));
+    sorted = (size_t*) malloc(num_vis * sizeof(size_t));
+    active = (int*) malloc(num_layers * sizeof(int));
+    if (!layer || !layer_start || !sorted || !active)
+    {
+        free(layer);
+        free(layer_start);
+        free(sorted);
+        free(active);
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    if (h->imager_prec == OSKAR_DOUBLE)
+    {
+        find_layers_d(num_vis, oskar_mem_double_const(ww, status),
+                inv_spacing, num_layers, layer);
+        oskar_grid_tiles_bucket(num_vis, layer, num_layers,
+                layer_start, sorted);
+        gather_d(num_vis, sorted, oskar_mem_double_const(uu, status),
+                oskar_mem_double_const(vv, status),
+                oskar_mem_double_const(ww, status),
+                oskar_mem_double2_const(amps, status),
+                oskar_mem_double_const(weight, status),
+                oskar_mem_double(h->uu_sort, status),
+                oskar_mem_double(h->vv_sort, status),
+                oskar_mem_double2(h->vis_sort, status),
+                oskar_mem_double(h->weight_sort, status));
+    }
+    else
+    {
+        find_layers_f(num_vis, oskar_mem_float_const(ww, status),
+                inv_spacing, num_layers, layer);
+        oskar_grid_tiles_bucket(num_vis, layer, num_layers,
+                layer_start, sorted);
+        gather_f(num_vis, sorted, oskar_mem_float_const(uu, status),
+                oskar_mem_float_const(vv, status),
+                oskar_mem_float_const(ww, status),
+                oskar_mem_float2_const(amps, status),
+                oskar_mem_float_const(weight, status),
+                oskar_mem_float(h->uu_sort, status),
+                oskar_mem_float(h->vv_sort, status),
+                oskar_mem_float2(h->vis_sort, status),
+                oskar_mem_float(h->weight_sort, status));
+    }
+    free(layer);
+    free(sorted);
+
+    /* Find the layers that have data, and those already held.
+     * If the input data are being read in several passes, only the
+     * layers in the range for this pass are gridded. */
+    for (k = 0; k < num_layers; ++k)
+    {
+        if (layers[k]) num_held++;
+        if (h->w_layer_end > 0 &&
+                (k < h->w_layer_start || k >= h->w_layer_end)) continue;
+        if (layer_start[k + 1] > layer_start[k]) active[num_active++] = k;
+    }
+
+    /* Grid the layers in groups that fit within the memory limit.
+     * If there is no room for the next layer, the layers held for this
+     * plane are transformed, added to the plane and freed first.
+     * This costs extra FFTs, so the number of times it happens is
+     * recorded and reported when the imager is finalised. */
+    max_layers = oskar_imager_wstack_max_layers(h);
+    for (i = 0; i < num_active && !*status;)
+    {
+        int j;
+        for (j = i; j < num_active && !*status; ++j)
+        {
+            const int kk = active[j];
+            if (layers[kk]) continue;
+            if (num_held >= max_layers) break;
+            layers[kk] = oskar_mem_create(h->imager_prec | OSKAR_COMPLEX,
+                    OSKAR_CPU, num_cells, status);
+            num_held++;
+        }
+        if (j == i)
+        {
+            oskar_imager_flush_plane_wstack(h, plane, status);
+            h->w_layer_num_flushes++;
+            num_held = 0;
+            continue;
+        }
+        grid_layers(h, j - i, active + i, layer_start, layers, grid_size,
+                num_skipped, plane_norm, status);
+        i = j;
+    }
+    free(active);
+    free(layer_start);
+}
+
+#ifdef __cplusplus
+}
+#endif
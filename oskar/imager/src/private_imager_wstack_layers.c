@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/private_imager_wstack_layers.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static int find_set(const oskar_Imager* h, oskar_Mem* plane)
+{
+    int i;
+    for (i = 0; i < h->num_w_layer_sets; ++i)
+        if (h->w_layer_planes[i] == plane) return i;
+    return -1;
+}
+
+oskar_Mem** oskar_imager_wstack_layers(oskar_Imager* h,
+        oskar_Mem* plane, int create)
+{
+    int i;
+    void *t1, *t2;
+    oskar_Mem** layers;
+    i = find_set(h, plane);
+    if (i >= 0) return h->w_layers[i];
+    if (!create || h->num_w_planes < 1) return 0;
+
+    /* Add a new set of (unallocated) layers for this plane.
+     * The arrays are only updated if all the allocations succeed. */
+    i = h->num_w_layer_sets;
+    t1 = realloc(h->w_layer_planes, (i + 1) * sizeof(oskar_Mem*));
+    if (t1) h->w_layer_planes = (oskar_Mem**) t1;
+    t2 = realloc(h->w_layers, (i + 1) * sizeof(oskar_Mem**));
+    if (t2) h->w_layers = (oskar_Mem***) t2;
+    layers = (oskar_Mem**) calloc(h->num_w_planes, sizeof(oskar_Mem*));
+    if (!t1 || !t2 || !layers)
+    {
+        free(layers);
+        return 0;
+    }
+    h->w_layer_planes[i] = plane;
+    h->w_layers[i] = layers;
+    h->num_w_layer_sets++;
+    return layers;
+}
+
+int oskar_imager_wstack_max_layers(oskar_Imager* h)
+{
+    size_t num_cells, layer_bytes, max_layers;
+    const int num_planes = (h->num_planes > 0) ? h->num_planes : 1;
+
+    /* Share the memory limit between the planes, allowing at least one
+     * layer per plane. */
+    num_cells = (size_t) oskar_imager_plane_size(h);
+    num_cells *= num_cells;
+    layer_bytes = num_cells *
+            oskar_mem_element_size(h->imager_prec | OSKAR_COMPLEX);
+    max_layers = h->w_layer_max_bytes / (layer_bytes * num_planes);
+    if (max_layers < 1) return 1;
+    return (max_layers < (size_t) h->num_w_planes) ?
+            (int) max_layers : h->num_w_planes;
+}
+
+int oskar_imager_wstack_num_passes(oskar_Imager* h)
+{
+    const int max_layers = oskar_imager_wstack_max_layers(h);
+    if (h->num_w_planes < 1) return 1;
+    return (h->num_w_planes + max_layers - 1) / max_layers;
+}
+
+void oskar_imager_wstack_layers_release(oskar_Imager* h,
+        oskar_Mem* plane, int* status)
+{
+    int i, k, last;
+    i = find_set(h, plane);
+    if (i < 0) return;
+    for (k = 0; k < h->num_w_planes; ++k)
+        oskar_mem_free(h->w_layers[i][k], status);
+    free(h->w_layers[i]);
+
+    /* Move the last set into the gap. */
+    last = --h->num_w_layer_sets;
+    h->w_layer_planes[i] = h->w_layer_planes[last];
+    h->w_layers[i] = h->w_layers[last];
+}
+
+void oskar_imager_wstack_layers_free(oskar_Imager* h, int* status)
+{
+    while (h->num_w_layer_sets > 0)
+        oskar_imager_wstack_layers_release(h, h->w_layer_planes[0], status);
+    free(h->w_layer_planes);
+    free(h->w_layers);
+    h->w_layer_planes = 0;
+    h->w_layers = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
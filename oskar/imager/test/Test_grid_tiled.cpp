@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+#include "imager/oskar_grid_simple.h"
+#include "imager/oskar_grid_simple_multi.h"
+#include "imager/oskar_grid_wproj.h"
+#include "mem/oskar_mem.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static void set_num_threads(int num_threads)
+{
+#ifdef _OPENMP
+    omp_set_num_threads(num_threads);
+#else
+    (void) num_threads;
+#endif
+}
+
+static void fill_random(std::vector<double>& v, double scale)
+{
+    for (size_t i = 0; i < v.size(); ++i)
+        v[i] = scale * (2.0 * rand() / (double)RAND_MAX - 1.0);
+}
+
+static void check_grids(const std::vector<double>& a,
+        const std::vector<double>& b, double tol)
+{
+    double max_abs = 0.0, max_diff = 0.0;
+    ASSERT_EQ(a.size(), b.size());
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        if (fabs(a[i]) > max_abs) max_abs = fabs(a[i]);
+        if (fabs(a[i] - b[i]) > max_diff) max_diff = fabs(a[i] - b[i]);
+    }
+    EXPECT_GT(max_abs, 0.0);
+    EXPECT_LE(max_diff, tol * max_abs);
+}
+
+TEST(grid_tiled, simple)
+{
+    const int grid_size = 512, num_vis = 50000;
+    const double cell_size_rad = 1.0 / grid_size;
+    const int supports[] = {3, 1, 5}, oversamples[] = {100, 100, 8};
+    std::vector<double> uu(num_vis), vv(num_vis), vis(2 * num_vis);
+    std::vector<double> weight(num_vis, 1.0);
+    srand(1);
+
+    // Some visibilities lie outside the grid.
+    fill_random(uu, 0.52 * grid_size);
+    fill_random(vv, 0.52 * grid_size);
+    fill_random(vis, 1.0);
+    for (int s = 0; s < 3; ++s)
+    {
+        const int support = supports[s], oversample = oversamples[s];
+        std::vector<double> conv_func((support + 1) * oversample + 1);
+        for (size_t i = 0; i < conv_func.size(); ++i)
+            conv_func[i] = exp(-(double)i / ((support + 1) * oversample));
+        std::vector<double> grid_serial(2 * grid_size * grid_size, 0.0);
+        std::vector<double> grid_tiled(2 * grid_size * grid_size, 0.0);
+        size_t skipped_serial = 0, skipped_tiled = 0;
+        double norm_serial = 0.0, norm_tiled = 0.0;
+
+        // Grid serially and with tiles.
+        set_num_threads(1);
+        oskar_grid_simple_d(support, oversample, &conv_func[0], num_vis,
+                &uu[0], &vv[0], &vis[0], &weight[0], cell_size_rad,
+                grid_size, &skipped_serial, &norm_serial, &grid_serial[0]);
+        set_num_threads(4);
+        oskar_grid_simple_d(support, oversample, &conv_func[0], num_vis,
+                &uu[0], &vv[0], &vis[0], &weight[0], cell_size_rad,
+                grid_size, &skipped_tiled, &norm_tiled, &grid_tiled[0]);
+        set_num_threads(1);
+
+        // Check results are consistent.
+        EXPECT_GT(skipped_serial, 0u);
+        EXPECT_EQ(skipped_serial, skipped_tiled);
+        EXPECT_NEAR(norm_serial, norm_tiled, 1e-10 * norm_serial);
+        check_grids(grid_serial, grid_tiled, 1e-12);
+    }
+}
+
+TEST(grid_tiled, simple_multi)
+{
+    const int grid_size = 256, num_vis = 50000, num_planes = 4;
+    const int support = 3, oversample = 100;
+    const double cell_size_rad = 1.0 / grid_size;
+    const int num_threads[] = {1, 4};
+    std::vector<double> uu(num_vis), vv(num_vis);
+    std::vector<double> conv_func((support + 1) * oversample + 1);
+    std::vector<std::vector<double> > vis(num_planes), weight(num_planes);
+    std::vector<std::vector<double> > grid_ref(num_planes);
+    std::vector<double> norm_ref(num_planes, 0.0);
+    size_t skipped_ref = 0;
+    srand(3);
+
+    // Some visibilities lie outside the grid.
+    fill_random(uu, 0.52 * grid_size);
+    fill_random(vv, 0.52 * grid_size);
+    for (size_t i = 0; i < conv_func.size(); ++i)
+        conv_func[i] = exp(-(double)i / ((support + 1) * oversample));
+    for (int p = 0; p < num_planes; ++p)
+    {
+        vis[p].resize(2 * num_vis);
+        weight[p].resize(num_vis);
+        fill_random(vis[p], 1.0);
+        fill_random(weight[p], 1.0);
+        for (int i = 0; i < num_vis; ++i)
+            weight[p][i] = fabs(weight[p][i]);
+
+        // Grid each plane separately for reference.
+        set_num_threads(1);
+        grid_ref[p].resize(2 * grid_size * grid_size, 0.0);
+        oskar_grid_simple_d(support, oversample, &conv_func[0], num_vis,
+                &uu[0], &vv[0], &vis[p][0], &weight[p][0], cell_size_rad,
+                grid_size, &skipped_ref, &norm_ref[p], &grid_ref[p][0]);
+    }
+
+    // Grid all planes together, serially and with tiles.
+    for (int t = 0; t < 2; ++t)
+    {
+        std::vector<std::vector<double> > grid(num_planes);
+        std::vector<double> norm(num_planes, 0.0);
+        const double *vis_ptr[num_planes], *weight_ptr[num_planes];
+        double *grid_ptr[num_planes];
+        size_t skipped = 0;
+        for (int p = 0; p < num_planes; ++p)
+        {
+            grid[p].resize(2 * grid_size * grid_size, 0.0);
+            vis_ptr[p] = &vis[p][0];
+            weight_ptr[p] = &weight[p][0];
+            grid_ptr[p] = &grid[p][0];
+        }
+        set_num_threads(num_threads[t]);
+        oskar_grid_simple_multi_d(support, oversample, &conv_func[0],
+                num_planes, num_vis, &uu[0], &vv[0], vis_ptr, weight_ptr,
+                cell_size_rad, grid_size, &skipped, &norm[0], grid_ptr);
+        set_num_threads(1);
+
+        // Check results are consistent.
+        EXPECT_GT(skipped, 0u);
+        EXPECT_EQ(skipped_ref, skipped);
+        for (int p = 0; p < num_planes; ++p)
+        {
+            EXPECT_NEAR(norm_ref[p], norm[p], 1e-10 * norm_ref[p]);
+            check_grids(grid_ref[p], grid[p], 1e-12);
+        }
+    }
+}
+
+TEST(grid_tiled, wproj)
+{
+    const int grid_size = 512, num_vis = 50000, oversample = 4;
+    const int num_w_planes = 4, support[] = {2, 4, 8, 16};
+    const int conv_size_half = (support[num_w_planes - 1] + 1) * oversample;
+    const double cell_size_rad = 1.0 / grid_size, w_scale = 0.01;
+    std::vector<float> uu(num_vis), vv(num_vis), ww(num_vis);
+    std::vector<float> vis(2 * num_vis), weight(num_vis, 1.0f);
+    std::vector<float> conv_func(2 * num_w_planes *
+            conv_size_half * conv_size_half);
+    std::vector<double> tmp(num_vis);
+    srand(2);
+
+    // Some visibilities lie outside the grid, or beyond the last W-plane.
+    fill_random(tmp, 0.52 * grid_size);
+    for (int i = 0; i < num_vis; ++i) uu[i] = (float) tmp[i];
+    fill_random(tmp, 0.52 * grid_size);
+    for (int i = 0; i < num_vis; ++i) vv[i] = (float) tmp[i];
+    fill_random(tmp, 1500.0);
+    for (int i = 0; i < num_vis; ++i) ww[i] = (float) tmp[i];
+    for (size_t i = 0; i < vis.size(); ++i)
+        vis[i] = (float) (2.0 * rand() / (double)RAND_MAX - 1.0);
+    for (size_t i = 0; i < conv_func.size(); ++i)
+        conv_func[i] = (float) (rand() / (double)RAND_MAX);
+
+    // Grid serially and with tiles.
+    std::vector<float> grid_serial(2 * grid_size * grid_size, 0.0f);
+    std::vector<float> grid_tiled(2 * grid_size * grid_size, 0.0f);
+    size_t skipped_serial = 0, skipped_tiled = 0;
+    double norm_serial = 0.0, norm_tiled = 0.0;
+    set_num_threads(1);
+    oskar_grid_wproj_f(num_w_planes, support, oversample, conv_size_half,
+            &conv_func[0], num_vis, &uu[0], &vv[0], &ww[0], &vis[0],
+            &weight[0], (float) cell_size_rad, (float) w_scale, grid_size,
+            &skipped_serial, &norm_serial, &grid_serial[0]);
+    set_num_threads(4);
+    oskar_grid_wproj_f(num_w_planes, support, oversample, conv_size_half,
+            &conv_func[0], num_vis, &uu[0], &vv[0], &ww[0], &vis[0],
+            &weight[0], (float) cell_size_rad, (float) w_scale, grid_size,
+            &skipped_tiled, &norm_tiled, &grid_tiled[0]);
+    set_num_threads(1);
+
+    // Check results are consistent.
+    EXPECT_GT(skipped_serial, 0u);
+    EXPECT_EQ(skipped_serial, skipped_tiled);
+    EXPECT_NEAR(norm_serial, norm_tiled, 1e-6 * norm_serial);
+    check_grids(std::vector<double>(grid_serial.begin(), grid_serial.end()),
+            std::vector<double>(grid_tiled.begin(), grid_tiled.end()), 1e-4);
+}
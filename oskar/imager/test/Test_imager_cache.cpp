@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+#include "imager/oskar_imager.h"
+#include "imager/private_imager.h"
+#include "mem/oskar_mem.h"
+#include "utility/oskar_dir.h"
+#include "utility/oskar_get_error_string.h"
+#include "vis/oskar_vis.h"
+
+#include <cmath>
+#include <cstdio>
+
+static void write_vis_file(const char* filename,
+        double freq_start_hz = 100e6, double dec_deg = 60.0, int seed = 1)
+{
+    int status = 0;
+    const int num_channels = 3, num_times = 20, num_stations = 30;
+
+    // Create visibility data with random coordinates and amplitudes.
+    oskar_Vis* vis = oskar_vis_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            num_channels, num_times, num_stations, &status);
+    oskar_vis_set_freq_start_hz(vis, freq_start_hz);
+    oskar_vis_set_freq_inc_hz(vis, 1e6);
+    oskar_vis_set_time_start_mjd_utc(vis, 51544.5);
+    oskar_vis_set_time_inc_sec(vis, 10.0);
+    oskar_vis_set_phase_centre(vis, 0.0, dec_deg);
+    oskar_mem_random_gaussian(oskar_vis_baseline_uu_metres(vis),
+            seed, 2, 3, 4, 1000.0, &status);
+    oskar_mem_random_gaussian(oskar_vis_baseline_vv_metres(vis),
+            seed, 6, 7, 8, 1000.0, &status);
+    oskar_mem_random_gaussian(oskar_vis_baseline_ww_metres(vis),
+            seed, 10, 11, 12, 100.0, &status);
+    oskar_mem_random_gaussian(oskar_vis_amplitude(vis),
+            seed, 14, 15, 16, 1.0, &status);
+    oskar_vis_write(vis, 0, filename, &status);
+    oskar_vis_free(vis, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+static oskar_Mem* run_imager(int num_files, const char* const* filenames,
+        const char* algorithm, int cache_input_data, const char* cache_file,
+        const char* w_kernel_dir = 0, size_t w_layer_max_bytes = 0,
+        int* num_w_planes = 0, int* num_flushes = 0)
+{
+    int status = 0;
+    oskar_Mem* image = 0;
+    oskar_Imager* h = oskar_imager_create(OSKAR_DOUBLE, &status);
+    oskar_imager_set_algorithm(h, algorithm, &status);
+    oskar_imager_set_weighting(h, "Uniform", &status);
+    oskar_imager_set_fov(h, 4.0);
+    oskar_imager_set_size(h, 256, &status);
+    oskar_imager_set_direction(h, 0.0, 60.0);
+    oskar_imager_set_input_files(h, num_files, filenames, &status);
+    oskar_imager_set_cache_input_data(h, cache_input_data);
+    oskar_imager_set_cache_file(h, cache_file);
+    oskar_imager_set_w_kernel_dir(h, w_kernel_dir);
+    if (w_layer_max_bytes > 0) h->w_layer_max_bytes = w_layer_max_bytes;
+    oskar_imager_run(h, 1, &image, 0, 0, &status);
+    if (num_w_planes) *num_w_planes = oskar_imager_num_w_planes(h);
+    if (num_flushes) *num_flushes = h->w_layer_num_flushes;
+    oskar_imager_free(h, &status);
+    EXPECT_EQ(0, status) << oskar_get_error_string(status);
+    return image;
+}
+
+TEST(imager, cache_input_data)
+{
+    int status = 0;
+    const char* filenames[] = {
+            "temp_test_imager_cache_1.vis", "temp_test_imager_cache_2.vis"};
+    const char* cache_file = "temp_test_imager_cache.dat";
+    const char* algorithms[] = {"FFT", "W-projection"};
+
+    // Use files with different frequencies and phase centres, so the
+    // cache must keep the meta-data for each file.
+    write_vis_file(filenames[0], 100e6, 60.0, 1);
+    write_vis_file(filenames[1], 102e6, 60.5, 2);
+
+    for (int a = 0; a < 2; ++a)
+    {
+        // Image with and without reading the input files only once.
+        oskar_Mem* image1 = run_imager(2, filenames, algorithms[a], 0, 0);
+        oskar_Mem* image2 = run_imager(2, filenames, algorithms[a], 1, 0);
+        oskar_Mem* image3 = run_imager(2, filenames, algorithms[a], 1,
+                cache_file);
+        ASSERT_TRUE(image1 && image2 && image3);
+
+        // Check the images are identical, and the cache file has gone.
+        const double* pix = oskar_mem_double_const(image1, &status);
+        double peak = 0.0;
+        for (size_t i = 0; i < oskar_mem_length(image1); ++i)
+            if (fabs(pix[i]) > peak) peak = fabs(pix[i]);
+        EXPECT_GT(peak, 0.0);
+        EXPECT_EQ(0, oskar_mem_different(image1, image2, 0, &status));
+        EXPECT_EQ(0, oskar_mem_different(image1, image3, 0, &status));
+        FILE* f = fopen(cache_file, "rb");
+        EXPECT_TRUE(f == NULL);
+        if (f) fclose(f);
+        oskar_mem_free(image1, &status);
+        oskar_mem_free(image2, &status);
+        oskar_mem_free(image3, &status);
+    }
+    remove(filenames[0]);
+    remove(filenames[1]);
+}
+
+TEST(imager, w_kernel_cache)
+{
+    int status = 0, num_items = 0;
+    char** items = 0;
+    const char* filename = "temp_test_imager_w_kernels.vis";
+    const char* dir = "temp_test_imager_w_kernels";
+    write_vis_file(filename);
+
+    // Image without the kernel cache, then twice with it.
+    oskar_Mem* image1 = run_imager(1, &filename, "W-projection", 0, 0);
+    oskar_Mem* image2 = run_imager(1, &filename, "W-projection", 0, 0, dir);
+    oskar_dir_items(dir, "*.bin", 1, 0, &num_items, &items);
+    EXPECT_EQ(1, num_items);
+    oskar_Mem* image3 = run_imager(1, &filename, "W-projection", 0, 0, dir);
+    ASSERT_TRUE(image1 && image2 && image3);
+
+    // Check the images are identical.
+    EXPECT_EQ(0, oskar_mem_different(image1, image2, 0, &status));
+    EXPECT_EQ(0, oskar_mem_different(image1, image3, 0, &status));
+    for (int i = 0; i < num_items; ++i) free(items[i]);
+    free(items);
+    oskar_mem_free(image1, &status);
+    oskar_mem_free(image2, &status);
+    oskar_mem_free(image3, &status);
+    oskar_dir_remove(dir);
+    remove(filename);
+}
+
+TEST(imager, wstack_multi_pass)
+{
+    int status = 0, num_w_planes = 0, num_flushes = -1;
+    const char* filename = "temp_test_imager_wstack_passes.vis";
+    write_vis_file(filename);
+
+    // Image with enough memory for all the W-layers, then with room for
+    // only one layer, which needs one pass over the input per layer.
+    oskar_Mem* image1 = run_imager(1, &filename, "W-stacking", 0, 0, 0, 0,
+            &num_w_planes);
+    oskar_Mem* image2 = run_imager(1, &filename, "W-stacking", 0, 0, 0, 1);
+    oskar_Mem* image3 = run_imager(1, &filename, "W-stacking", 1, 0, 0, 1,
+            0, &num_flushes);
+    ASSERT_TRUE(image1 && image2 && image3);
+    EXPECT_GT(num_w_planes, 1);
+
+    // Layers should not have been flushed early to stay within the limit.
+    EXPECT_EQ(0, num_flushes);
+
+    // Check the images agree, allowing for the order of summation.
+    const double* pix1 = oskar_mem_double_const(image1, &status);
+    const double* pix2 = oskar_mem_double_const(image2, &status);
+    const double* pix3 = oskar_mem_double_const(image3, &status);
+    double peak = 0.0, max_diff2 = 0.0, max_diff3 = 0.0;
+    for (size_t i = 0; i < oskar_mem_length(image1); ++i)
+    {
+        if (fabs(pix1[i]) > peak) peak = fabs(pix1[i]);
+        if (fabs(pix1[i] - pix2[i]) > max_diff2)
+            max_diff2 = fabs(pix1[i] - pix2[i]);
+        if (fabs(pix1[i] - pix3[i]) > max_diff3)
+            max_diff3 = fabs(pix1[i] - pix3[i]);
+    }
+    EXPECT_GT(peak, 0.0);
+    EXPECT_LT(max_diff2, 1e-10 * peak);
+    EXPECT_LT(max_diff3, 1e-10 * peak);
+    oskar_mem_free(image1, &status);
+    oskar_mem_free(image2, &status);
+    oskar_mem_free(image3, &status);
+    remove(filename);
+}
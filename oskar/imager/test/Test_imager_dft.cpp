@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+#include "imager/oskar_imager.h"
+#include "mem/oskar_mem.h"
+
+#include <cmath>
+
+static oskar_Mem* image_dft(const char* algorithm, int num_vis,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        const oskar_Mem* vis, const oskar_Mem* weight)
+{
+    int status = 0, size = 32;
+    double norm = 0.0;
+    oskar_Imager* im = oskar_imager_create(OSKAR_DOUBLE, &status);
+    oskar_imager_set_algorithm(im, algorithm, &status);
+    oskar_imager_set_fov(im, 2.0);
+    oskar_imager_set_size(im, size, &status);
+    oskar_Mem* plane = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            size * size, &status);
+    oskar_mem_clear_contents(plane, &status);
+    oskar_imager_update_plane(im, num_vis, uu, vv, ww, vis, weight,
+            plane, &norm, 0, &status);
+    oskar_imager_finalise_plane(im, plane, norm, &status);
+    oskar_imager_free(im, &status);
+    EXPECT_EQ(0, status);
+    return plane;
+}
+
+TEST(imager, dft_2d_separable)
+{
+    // Use enough visibilities for the separable 2D DFT to process them
+    // in more than one chunk.
+    int status = 0, num_vis = 150000;
+    oskar_Mem* uu = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* vv = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* ww = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* vis = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            num_vis, &status);
+    oskar_Mem* weight = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_vis, &status);
+    oskar_mem_random_gaussian(uu, 0, 1, 2, 3, 200.0, &status);
+    oskar_mem_random_gaussian(vv, 4, 5, 6, 7, 200.0, &status);
+    oskar_mem_random_gaussian(vis, 8, 9, 10, 11, 1.0, &status);
+    oskar_mem_clear_contents(ww, &status);
+    oskar_mem_set_value_real(weight, 1.0, 0, num_vis, &status);
+    ASSERT_EQ(0, status);
+
+    // With W = 0, the 2D and 3D DFTs should give the same image.
+    oskar_Mem* image_2d = image_dft("DFT 2D", num_vis, uu, vv, ww,
+            vis, weight);
+    oskar_Mem* image_3d = image_dft("DFT 3D", num_vis, uu, vv, ww,
+            vis, weight);
+    const double* a = oskar_mem_double_const(image_2d, &status);
+    const double* b = oskar_mem_double_const(image_3d, &status);
+    double peak = 0.0, max_diff = 0.0;
+    for (size_t i = 0; i < oskar_mem_length(image_3d); ++i)
+    {
+        if (fabs(b[i]) > peak) peak = fabs(b[i]);
+        if (fabs(a[i] - b[i]) > max_diff) max_diff = fabs(a[i] - b[i]);
+    }
+    EXPECT_GT(peak, 0.0);
+    EXPECT_LT(max_diff, 1e-9 * peak);
+    oskar_mem_free(image_2d, &status);
+    oskar_mem_free(image_3d, &status);
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(ww, &status);
+    oskar_mem_free(vis, &status);
+    oskar_mem_free(weight, &status);
+}
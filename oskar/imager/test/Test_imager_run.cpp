@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+#include "imager/oskar_imager.h"
+#include "mem/oskar_mem.h"
+#include "utility/oskar_get_error_string.h"
+#include "vis/oskar_vis.h"
+
+#include <cmath>
+#include <cstdio>
+
+static void write_vis_file(const char* filename, double freq_start_hz,
+        int seed, int type = OSKAR_DOUBLE_COMPLEX)
+{
+    int status = 0;
+    const int num_channels = 3, num_times = 40, num_stations = 30;
+
+    // Create visibility data with random coordinates and amplitudes.
+    oskar_Vis* vis = oskar_vis_create(type, OSKAR_CPU,
+            num_channels, num_times, num_stations, &status);
+    oskar_vis_set_freq_start_hz(vis, freq_start_hz);
+    oskar_vis_set_freq_inc_hz(vis, 1e6);
+    oskar_vis_set_time_start_mjd_utc(vis, 51544.5);
+    oskar_vis_set_time_inc_sec(vis, 10.0);
+    oskar_vis_set_phase_centre(vis, 0.0, 60.0);
+    oskar_mem_random_gaussian(oskar_vis_baseline_uu_metres(vis),
+            seed, 2, 3, 4, 1000.0, &status);
+    oskar_mem_random_gaussian(oskar_vis_baseline_vv_metres(vis),
+            seed, 6, 7, 8, 1000.0, &status);
+    oskar_mem_random_gaussian(oskar_vis_baseline_ww_metres(vis),
+            seed, 10, 11, 12, 100.0, &status);
+    oskar_mem_random_gaussian(oskar_vis_amplitude(vis),
+            seed, 14, 15, 16, 1.0, &status);
+    oskar_vis_write(vis, 0, filename, &status);
+    oskar_vis_free(vis, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+static oskar_Mem* run_imager(int num_files, const char* const* filenames,
+        double freq_min_hz, double freq_max_hz)
+{
+    int status = 0;
+    oskar_Mem* image = 0;
+    oskar_Imager* h = oskar_imager_create(OSKAR_DOUBLE, &status);
+    oskar_imager_set_algorithm(h, "FFT", &status);
+    oskar_imager_set_fov(h, 4.0);
+    oskar_imager_set_size(h, 128, &status);
+    oskar_imager_set_freq_min_hz(h, freq_min_hz);
+    oskar_imager_set_freq_max_hz(h, freq_max_hz);
+    oskar_imager_set_input_files(h, num_files, filenames, &status);
+    oskar_imager_run(h, 1, &image, 0, 0, &status);
+    oskar_imager_free(h, &status);
+    EXPECT_EQ(0, status) << oskar_get_error_string(status);
+    return image;
+}
+
+TEST(imager, run_files_with_different_frequencies)
+{
+    int status = 0;
+    const char* filenames[] = {
+            "temp_test_imager_run_1.vis", "temp_test_imager_run_2.vis"};
+    write_vis_file(filenames[0], 100e6, 1);
+    write_vis_file(filenames[1], 200e6, 2);
+
+    // Select the channels of each file in turn. Blocks from the other file
+    // must not be gridded using the meta-data of the selected one, even
+    // though the next file is read while earlier blocks are gridded.
+    for (int i = 0; i < 2; ++i)
+    {
+        const double freq_min_hz = i == 0 ? 0.0 : 150e6;
+        const double freq_max_hz = i == 0 ? 150e6 : 0.0;
+        oskar_Mem* image1 = run_imager(1, &filenames[i],
+                freq_min_hz, freq_max_hz);
+        oskar_Mem* image2 = run_imager(2, filenames,
+                freq_min_hz, freq_max_hz);
+        ASSERT_TRUE(image1 && image2);
+        EXPECT_EQ(0, oskar_mem_different(image1, image2, 0, &status));
+        oskar_mem_free(image1, &status);
+        oskar_mem_free(image2, &status);
+    }
+    remove(filenames[0]);
+    remove(filenames[1]);
+}
+
+static void run_imager_filtered(const char* filename, const char* image_type,
+        int num_images, oskar_Mem** images, int use_filters)
+{
+    int status = 0;
+    oskar_Imager* h = oskar_imager_create(OSKAR_DOUBLE, &status);
+    oskar_imager_set_algorithm(h, "FFT", &status);
+    oskar_imager_set_image_type(h, image_type, &status);
+    oskar_imager_set_fov(h, 4.0);
+    oskar_imager_set_size(h, 128, &status);
+    if (use_filters)
+    {
+        oskar_imager_set_uv_filter_min(h, 100.0);
+        oskar_imager_set_uv_filter_max(h, 600.0);
+        oskar_imager_set_time_min_utc(h, 51544.5 + 100.0 / 86400.0);
+        oskar_imager_set_time_max_utc(h, 51544.5 + 300.0 / 86400.0);
+    }
+    oskar_imager_set_input_files(h, 1, &filename, &status);
+    oskar_imager_run(h, num_images, images, 0, 0, &status);
+    oskar_imager_free(h, &status);
+    EXPECT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(imager, run_all_polarisations_with_filters)
+{
+    int status = 0;
+    const char* filename = "temp_test_imager_run_filters.vis";
+    const char* pols[] = {"XX", "XY", "YX", "YY"};
+    write_vis_file(filename, 100e6, 1, OSKAR_DOUBLE_COMPLEX_MATRIX);
+
+    // Image all polarisations together, with and without the filters.
+    oskar_Mem *images[] = {0, 0, 0, 0}, *unfiltered[] = {0, 0, 0, 0};
+    run_imager_filtered(filename, "Linear", 4, images, 1);
+    run_imager_filtered(filename, "Linear", 4, unfiltered, 0);
+
+    // Check each polarisation against an image made on its own.
+    for (int p = 0; p < 4; ++p)
+    {
+        oskar_Mem* image = 0;
+        run_imager_filtered(filename, pols[p], 1, &image, 1);
+        ASSERT_TRUE(image && images[p] && unfiltered[p]);
+        const double* a = oskar_mem_double_const(images[p], &status);
+        const double* b = oskar_mem_double_const(image, &status);
+        const double* c = oskar_mem_double_const(unfiltered[p], &status);
+        double peak = 0.0, max_diff = 0.0, max_diff_unfiltered = 0.0;
+        for (size_t i = 0; i < oskar_mem_length(image); ++i)
+        {
+            if (fabs(b[i]) > peak) peak = fabs(b[i]);
+            if (fabs(a[i] - b[i]) > max_diff) max_diff = fabs(a[i] - b[i]);
+            if (fabs(c[i] - b[i]) > max_diff_unfiltered)
+                max_diff_unfiltered = fabs(c[i] - b[i]);
+        }
+        EXPECT_GT(peak, 0.0);
+        EXPECT_LT(max_diff, 1e-10 * peak) << pols[p];
+        EXPECT_GT(max_diff_unfiltered, 1e-3 * peak) << pols[p];
+        oskar_mem_free(image, &status);
+        oskar_mem_free(images[p], &status);
+        oskar_mem_free(unfiltered[p], &status);
+    }
+    remove(filename);
+}
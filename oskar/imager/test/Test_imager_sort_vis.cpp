@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+#include "imager/oskar_imager.h"
+#include "imager/private_imager.h"
+#include "imager/oskar_grid_simple.h"
+#include "imager/oskar_grid_wproj.h"
+
+#include <cmath>
+#include <cstring>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static void run_sort_test(const char* algorithm)
+{
+    int status = 0, type = OSKAR_DOUBLE, size = 256, num_vis = 20000;
+#ifdef _OPENMP
+    omp_set_num_threads(1);
+#endif
+
+    // Create and set up the imager.
+    oskar_Imager* im = oskar_imager_create(type, &status);
+    oskar_imager_set_algorithm(im, algorithm, &status);
+    oskar_imager_set_fov(im, 2.0);
+    oskar_imager_set_size(im, size, &status);
+    oskar_imager_set_num_w_planes(im, 8);
+
+    // Create visibility data.
+    oskar_Mem* uu = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* vv = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* ww = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* vis = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_vis, &status);
+    oskar_Mem* weight = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_mem_random_gaussian(uu, 0, 1, 2, 3, 1000.0, &status);
+    oskar_mem_random_gaussian(vv, 4, 5, 6, 7, 1000.0, &status);
+    oskar_mem_random_gaussian(ww, 8, 9, 10, 11, 100.0, &status);
+    oskar_mem_random_gaussian(vis, 12, 13, 14, 15, 1.0, &status);
+    oskar_mem_set_value_real(weight, 1.0, 0, num_vis, &status);
+    ASSERT_EQ(0, status);
+
+    // Grid visibility data through the imager, which sorts it first.
+    int grid_size = oskar_imager_plane_size(im);
+    oskar_Mem* grid1 = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            grid_size * grid_size, &status);
+    oskar_Mem* grid2 = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            grid_size * grid_size, &status);
+    double norm1 = 0.0, norm2 = 0.0;
+    size_t num_skipped = 0;
+    oskar_mem_clear_contents(grid1, &status);
+    oskar_mem_clear_contents(grid2, &status);
+    oskar_imager_update_plane(im, num_vis, uu, vv, ww, vis, weight, grid1,
+            &norm1, 0, &status);
+    ASSERT_EQ(0, status);
+    EXPECT_GT(oskar_mem_length(im->uu_sort), 0u);
+
+    // Grid the unsorted data directly.
+    if (!strcmp(algorithm, "FFT"))
+        oskar_grid_simple_d(im->support, im->oversample,
+                oskar_mem_double_const(im->conv_func, &status), num_vis,
+                oskar_mem_double_const(uu, &status),
+                oskar_mem_double_const(vv, &status),
+                oskar_mem_double_const(vis, &status),
+                oskar_mem_double_const(weight, &status),
+                im->cellsize_rad, grid_size, &num_skipped, &norm2,
+                oskar_mem_double(grid2, &status));
+    else
+        oskar_grid_wproj_d(im->num_w_planes,
+                oskar_mem_int_const(im->w_support, &status),
+                im->oversample, im->conv_size_half,
+                oskar_mem_double_const(im->w_kernels, &status), num_vis,
+                oskar_mem_double_const(uu, &status),
+                oskar_mem_double_const(vv, &status),
+                oskar_mem_double_const(ww, &status),
+                oskar_mem_double_const(vis, &status),
+                oskar_mem_double_const(weight, &status),
+                im->cellsize_rad, im->w_scale, grid_size, &num_skipped,
+                &norm2, oskar_mem_double(grid2, &status));
+    ASSERT_EQ(0, status);
+
+    // Check the tile boundaries kept for the gridder cover the sorted data.
+    ASSERT_GT(im->num_tiles, 0);
+    EXPECT_EQ(0u, im->tile_start[0]);
+    EXPECT_EQ(num_vis - num_skipped, im->tile_start[im->num_tiles]);
+
+    // Check the grids are the same, apart from summation order.
+    const double* g1 = oskar_mem_double_const(grid1, &status);
+    const double* g2 = oskar_mem_double_const(grid2, &status);
+    double max_abs = 0.0, max_diff = 0.0;
+    for (int i = 0; i < 2 * grid_size * grid_size; ++i)
+    {
+        if (fabs(g2[i]) > max_abs) max_abs = fabs(g2[i]);
+        if (fabs(g1[i] - g2[i]) > max_diff) max_diff = fabs(g1[i] - g2[i]);
+    }
+    EXPECT_GT(max_abs, 0.0);
+    EXPECT_LE(max_diff, 1e-12 * max_abs);
+    EXPECT_NEAR(norm1, norm2, 1e-12 * norm2);
+
+    // Clean up.
+    oskar_imager_free(im, &status);
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(ww, &status);
+    oskar_mem_free(vis, &status);
+    oskar_mem_free(weight, &status);
+    oskar_mem_free(grid1, &status);
+    oskar_mem_free(grid2, &status);
+}
+
+TEST(imager, sort_vis_fft)
+{
+    run_sort_test("FFT");
+}
+
+TEST(imager, sort_vis_wproj)
+{
+    run_sort_test("W-projection");
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+#include "imager/oskar_imager.h"
+#include "imager/private_imager.h"
+#include "math/oskar_cmath.h"
+
+static double image_point_source(const char* algorithm, int type,
+        int* peak_x, int* peak_y, size_t max_layer_bytes = 0)
+{
+    int status = 0, size = 128, num_vis = 20000;
+
+    // Create and set up the imager, with a wide field of view.
+    oskar_Imager* im = oskar_imager_create(type, &status);
+    oskar_imager_set_algorithm(im, algorithm, &status);
+    oskar_imager_set_fov(im, 30.0);
+    oskar_imager_set_size(im, size, &status);
+    if (max_layer_bytes > 0) im->w_layer_max_bytes = max_layer_bytes;
+
+    // Create visibility data for a point source far from the phase centre,
+    // with large baseline W values.
+    const double cellsize = im->cellsize_rad;
+    const double l0 = 30 * cellsize, m0 = -20 * cellsize;
+    const double n0 = sqrt(1.0 - l0*l0 - m0*m0) - 1.0;
+    oskar_Mem* uu = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* vv = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* ww = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* vis = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            num_vis, &status);
+    oskar_Mem* weight = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_vis, &status);
+    oskar_mem_random_gaussian(uu, 0, 1, 2, 3, 0.08 / cellsize, &status);
+    oskar_mem_random_gaussian(vv, 4, 5, 6, 7, 0.08 / cellsize, &status);
+    oskar_mem_random_gaussian(ww, 8, 9, 10, 11, 0.08 / cellsize, &status);
+    oskar_mem_set_value_real(weight, 1.0, 0, num_vis, &status);
+    const double* u = oskar_mem_double_const(uu, &status);
+    const double* v = oskar_mem_double_const(vv, &status);
+    const double* w = oskar_mem_double_const(ww, &status);
+    double* amp = oskar_mem_double(vis, &status);
+    for (int i = 0; i < num_vis; ++i)
+    {
+        const double phase = 2.0 * M_PI * (u[i] * l0 + v[i] * m0 + w[i] * n0);
+        amp[2*i]     = cos(phase);
+        amp[2*i + 1] = sin(phase);
+    }
+    EXPECT_EQ(0, status);
+
+    // Supply the coordinates first, to find the range of W values.
+    oskar_imager_set_coords_only(im, 1);
+    oskar_imager_update_plane(im, num_vis, uu, vv, ww, 0, weight,
+            0, 0, 0, &status);
+    oskar_imager_set_coords_only(im, 0);
+
+    // Make the image.
+    double norm = 0.0;
+    oskar_Mem* plane = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            0, &status);
+    oskar_imager_update_plane(im, num_vis, uu, vv, ww, vis, weight,
+            plane, &norm, 0, &status);
+    oskar_imager_finalise_plane(im, plane, norm, &status);
+    oskar_imager_trim_image(im, plane, oskar_imager_plane_size(im),
+            size, &status);
+    EXPECT_EQ(0, status);
+
+    // Find the peak.
+    double peak = -1.0;
+    for (int i = 0; i < size * size; ++i)
+    {
+        const double val = (type == OSKAR_DOUBLE) ?
+                oskar_mem_double(plane, &status)[i] :
+                oskar_mem_float(plane, &status)[i];
+        if (val > peak)
+        {
+            peak = val;
+            *peak_x = i % size - size / 2;
+            *peak_y = i / size - size / 2;
+        }
+    }
+
+    // Clean up.
+    oskar_imager_free(im, &status);
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(ww, &status);
+    oskar_mem_free(vis, &status);
+    oskar_mem_free(weight, &status);
+    oskar_mem_free(plane, &status);
+    return peak;
+}
+
+TEST(imager, wstack_point_source)
+{
+    int x = 0, y = 0, x_fft = 0, y_fft = 0;
+
+    // Without W-correction, the source is smeared out.
+    double peak_fft = image_point_source("FFT", OSKAR_DOUBLE, &x_fft, &y_fft);
+    EXPECT_LT(peak_fft, 0.5);
+
+    // With W-stacking, it should be recovered in the right place.
+    double peak = image_point_source("W-stacking", OSKAR_DOUBLE, &x, &y);
+    EXPECT_NEAR(1.0, peak, 1e-2);
+    EXPECT_EQ(-30, x);
+    EXPECT_EQ(-20, y);
+    peak = image_point_source("W-stacking", OSKAR_SINGLE, &x, &y);
+    EXPECT_NEAR(1.0, peak, 1e-2);
+    EXPECT_EQ(-30, x);
+    EXPECT_EQ(-20, y);
+}
+
+TEST(imager, wstack_layer_memory_limit)
+{
+    int x = 0, y = 0, x_lim = 0, y_lim = 0;
+
+    // Limiting the memory to one layer at a time gives the same image.
+    double peak = image_point_source("W-stacking", OSKAR_DOUBLE, &x, &y);
+    double peak_lim = image_point_source("W-stacking", OSKAR_DOUBLE,
+            &x_lim, &y_lim, 1);
+    EXPECT_NEAR(peak, peak_lim, 1e-10);
+    EXPECT_EQ(x, x_lim);
+    EXPECT_EQ(y, y_lim);
+}
@@ -140,10 +140,22 @@ OSKAR_EXPORT
 void oskar_interferometer_set_output_vis_file(oskar_Interferometer* h,
         const char* filename);
 
+OSKAR_EXPORT
+void oskar_interferometer_set_progress_file(oskar_Interferometer* h,
+        const char* filename);
+
+OSKAR_EXPORT
+void oskar_interferometer_set_progress_interval(oskar_Interferometer* h,
+        double interval_sec);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_settings_path(oskar_Interferometer* h,
         const char* filename);
 
+OSKAR_EXPORT
+void oskar_interferometer_set_shard(oskar_Interferometer* h,
+        int shard_index, int num_shards, const char* mode, int* status);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_sky_model(oskar_Interferometer* h,
         const oskar_Sky* sky, int* status);
@@ -156,6 +168,10 @@ OSKAR_EXPORT
 void oskar_interferometer_set_source_flux_range(oskar_Interferometer* h,
         double min_jy, double max_jy);
 
+OSKAR_EXPORT
+void oskar_interferometer_set_trace_file(oskar_Interferometer* h,
+        const char* filename);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_zero_failed_gaussians(oskar_Interferometer* h,
         int value);
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2017, The University of Oxford
+ * Copyright (c) 2011-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -41,12 +41,16 @@
 #include "log/oskar_log.h"
 #include "sky/oskar_sky.h"
 #include "telescope/oskar_telescope.h"
+#include "telescope/station/oskar_evaluate_station_beam_lut.h"
 #include "utility/oskar_cuda_mem_log.h"
 #include "utility/oskar_device_utils.h"
+#include "utility/oskar_event_ring.h"
 #include "utility/oskar_get_memory_usage.h"
 #include "utility/oskar_get_num_procs.h"
 #include "utility/oskar_thread.h"
+#include "utility/oskar_thread_pool.h"
 #include "utility/oskar_timer.h"
+#include "utility/oskar_trace.h"
 #include "vis/oskar_vis_block.h"
 #include "vis/oskar_vis_block_write_ms.h"
 #include "vis/oskar_vis_header.h"
@@ -77,10 +81,17 @@ struct DeviceData
     oskar_Mem *u, *v, *w;
     oskar_Sky* chunk;           /* The unmodified sky chunk being processed. */
     oskar_Sky* chunk_clip;      /* Copy of the chunk after horizon clipping. */
+    oskar_Sky* chunk_freq;      /* Copy of the chunk scaled to a channel. */
     oskar_Telescope* tel;       /* Telescope model, created as a copy. */
     oskar_Jones *J, *R, *E, *K, *Z;
     oskar_StationWork* station_work;
 
+    /* Progress events, written by the device thread. */
+    oskar_EventRing* progress;
+    int progress_units;         /* Units received from ring (writer only). */
+    int progress_capacity;      /* Number of events the ring can hold. */
+    int thread_id;              /* Index of the thread in the trace. */
+
     /* Timers. */
     oskar_Timer* tmr_compute;   /* Total time spent filling vis blocks. */
     oskar_Timer* tmr_copy;      /* Time spent copying data. */
@@ -99,15 +110,19 @@ struct oskar_Interferometer
     int prec, num_devices, num_gpus, *gpu_ids, num_channels, num_time_steps;
     int max_sources_per_chunk, max_times_per_block;
     int apply_horizon_clip, force_polarised_ms, zero_failed_gaussians;
-    int coords_only;
+    int coords_only, shard_index, num_shards;
     double freq_start_hz, freq_inc_hz, time_start_mjd_utc, time_inc_sec;
     double source_min_jy, source_max_jy;
-    char correlation_type, *vis_name, *ms_name, *settings_path;
+    double progress_interval_sec;
+    char correlation_type, shard_mode, *vis_name, *ms_name, *settings_path;
+    char *progress_name, *trace_name;
 
     /* State. */
-    int init_sky, work_unit_index, status;
-    oskar_Mutex* mutex;
+    int init_sky, status;
+    volatile int work_unit_index;
     oskar_Barrier* barrier;
+    oskar_Latch* devices_done;
+    oskar_ThreadPool* pool;
 
     /* Sky model and telescope model. */
     int num_sources_total, num_sky_chunks;
@@ -119,9 +134,14 @@ struct oskar_Interferometer
     oskar_VisHeader* header;
     oskar_MeasurementSet* ms;
     oskar_Binary* vis;
+    char* vis_name_out;     /* Actual name of the OSKAR binary file. */
     oskar_Mem* temp;
     oskar_Timer* tmr_sim;   /* The total time for the simulation. */
     oskar_Timer* tmr_write; /* The time spent writing vis blocks. */
+    FILE* progress_file;    /* Handle to JSON-lines progress stream. */
+    oskar_Trace* trace;     /* Event trace, if enabled. */
+    double progress_start_sec, progress_last_sec;
+    int progress_units_done, progress_units_total, progress_dropped;
 
     /* Array of DeviceData structures, one per compute device. */
     DeviceData* d;
@@ -139,8 +159,17 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
         int time_index_simulation, int* status);
 static void free_device_data(oskar_Interferometer* h, int* status);
 static void set_up_device_data(oskar_Interferometer* h, int* status);
+static void check_beam_lut_memory(oskar_Interferometer* h, int* status);
 static void set_up_vis_header(oskar_Interferometer* h, int* status);
 static void record_timing(oskar_Interferometer* h);
+static void record_beam_lut_error(oskar_Interferometer* h);
+static void shard_range(int total, int shard_index, int num_shards,
+        int* start, int* size);
+static int shard_block_offset(const oskar_Interferometer* h);
+static void shard_channels(const oskar_Interferometer* h,
+        int* start, int* size);
+static char* shard_vis_name(const oskar_Interferometer* h);
+static void progress_drain(oskar_Interferometer* h, int final);
 static unsigned int disp_width(unsigned int value);
 static void system_mem_log(oskar_Log* log);
 
@@ -159,6 +188,25 @@ void oskar_interferometer_check_init(oskar_Interferometer* h, int* status)
         return;
     }
 
+    /* Check there is something for this shard to do. */
+    if (h->num_shards > 1)
+    {
+        int total = 0;
+        if (h->shard_mode == 'C')
+            total = h->num_channels;
+        else
+            total = (h->num_time_steps + h->max_times_per_block - 1) /
+                    h->max_times_per_block;
+        if (h->num_shards > total)
+        {
+            oskar_log_error(h->log, "Cannot split %d %s into %d shards.",
+                    total, h->shard_mode == 'C' ? "channels" : "blocks",
+                    h->num_shards);
+            *status = OSKAR_ERR_INVALID_ARGUMENT;
+            return;
+        }
+    }
+
     /* Create the visibility header if required. */
     if (!h->header)
         set_up_vis_header(h, status);
@@ -197,6 +245,7 @@ void oskar_interferometer_check_init(oskar_Interferometer* h, int* status)
 
     /* Check that each compute device has been set up. */
     set_up_device_data(h, status);
+    check_beam_lut_memory(h, status);
 }
 
 
@@ -214,11 +263,14 @@ oskar_Interferometer* oskar_interferometer_create(int precision, int* status)
     h->tmr_sim   = oskar_timer_create(OSKAR_TIMER_NATIVE);
     h->tmr_write = oskar_timer_create(OSKAR_TIMER_NATIVE);
     h->temp      = oskar_mem_create(precision, OSKAR_CPU, 0, status);
-    h->mutex     = oskar_mutex_create();
     h->barrier   = oskar_barrier_create(0);
+    h->devices_done = oskar_latch_create();
 
     /* Set sensible defaults. */
     h->max_sources_per_chunk = 16384;
+    h->num_shards = 1;
+    h->shard_mode = 'T';
+    h->progress_interval_sec = 1.0;
     oskar_interferometer_set_gpus(h, 0, 0, status);
     oskar_interferometer_set_num_devices(h, -1);
     oskar_interferometer_set_correlation_type(h, "Cross-correlations", status);
@@ -236,6 +288,10 @@ oskar_VisBlock* oskar_interferometer_finalise_block(oskar_Interferometer* h,
     oskar_VisBlock *b0 = 0, *b = 0;
     if (*status) return 0;
 
+    /* Report progress from the device threads. */
+    oskar_trace_begin_args(h->trace, 0, "Finalise", "block", block_index, 0, 0);
+    progress_drain(h, 0);
+
     /* The visibilities must be copied back
      * at the end of the block simulation. */
 
@@ -279,12 +335,17 @@ oskar_VisBlock* oskar_interferometer_finalise_block(oskar_Interferometer* h,
                 oskar_vis_block_baseline_ww_metres(b0), h->temp, status);
     }
 
-    /* Add uncorrelated system noise to the combined visibilities. */
+    /* Add uncorrelated system noise to the combined visibilities.
+     * The global block index is used so that noise is independent of
+     * any sharding of the observation. */
     if (!h->coords_only)
     {
+        oskar_trace_begin(h->trace, 0, "Noise");
         oskar_vis_block_add_system_noise(b0, h->header, h->tel,
-                block_index, h->temp, status);
+                block_index + shard_block_offset(h), h->temp, status);
+        oskar_trace_end(h->trace, 0);
     }
+    oskar_trace_end(h->trace, 0);
 
     /* Return a pointer to the block. */
     return b0;
@@ -302,6 +363,7 @@ void oskar_interferometer_free(oskar_Interferometer* h, int* status)
     int i;
     if (!h) return;
     oskar_interferometer_reset_cache(h, status);
+    oskar_thread_pool_free(h->pool);
     for (i = 0; i < h->num_gpus; ++i)
     {
         oskar_device_set(h->gpu_ids[i], status);
@@ -313,12 +375,15 @@ void oskar_interferometer_free(oskar_Interferometer* h, int* status)
     oskar_mem_free(h->temp, status);
     oskar_timer_free(h->tmr_sim);
     oskar_timer_free(h->tmr_write);
-    oskar_mutex_free(h->mutex);
     oskar_barrier_free(h->barrier);
+    oskar_latch_free(h->devices_done);
     free(h->sky_chunks);
     free(h->gpu_ids);
     free(h->vis_name);
     free(h->ms_name);
+    free(h->vis_name_out);
+    free(h->progress_name);
+    free(h->trace_name);
     free(h->settings_path);
     free(h->d);
     free(h);
@@ -339,8 +404,13 @@ int oskar_interferometer_num_gpus(const oskar_Interferometer* h)
 
 int oskar_interferometer_num_vis_blocks(const oskar_Interferometer* h)
 {
-    return (h->num_time_steps + h->max_times_per_block - 1) /
+    int start = 0, num_blocks;
+    num_blocks = (h->num_time_steps + h->max_times_per_block - 1) /
             h->max_times_per_block;
+    if (h->num_shards > 1 && h->shard_mode == 'T')
+        shard_range(num_blocks, h->shard_index, h->num_shards,
+                &start, &num_blocks);
+    return num_blocks;
 }
 
 
@@ -352,9 +422,16 @@ void oskar_interferometer_reset_cache(oskar_Interferometer* h, int* status)
 #ifndef OSKAR_NO_MS
     oskar_ms_close(h->ms);
 #endif
+    free(h->vis_name_out);
+    if (h->progress_file) fclose(h->progress_file);
     h->vis = 0;
     h->header = 0;
     h->ms = 0;
+    h->vis_name_out = 0;
+    h->progress_file = 0;
+    h->progress_start_sec = 0.0;
+    h->progress_units_done = 0;
+    h->progress_dropped = 0;
 }
 
 
@@ -368,7 +445,7 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
         int device_id, int* status)
 {
     double obs_start_mjd, dt_dump_days;
-    int i_active, time_index_start, time_index_end;
+    int i_active, time_index_start, time_index_end, start_channel;
     int num_channels, num_times_block, total_chunks, total_times;
     DeviceData* d;
     if (*status) return;
@@ -391,15 +468,18 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
     i_active = block_index % 2; /* Index of the active buffer. */
     d = &(h->d[device_id]);
     oskar_timer_resume(d->tmr_compute);
+    oskar_trace_begin_args(h->trace, d->thread_id, "Block",
+            "block", block_index, 0, 0);
     oskar_vis_block_clear(d->vis_block, status);
 
     /* Set the visibility block meta-data. */
     total_chunks = h->num_sky_chunks;
-    num_channels = h->num_channels;
     total_times = h->num_time_steps;
     obs_start_mjd = h->time_start_mjd_utc;
     dt_dump_days = h->time_inc_sec / 86400.0;
-    time_index_start = block_index * h->max_times_per_block;
+    shard_channels(h, &start_channel, &num_channels);
+    time_index_start = (block_index + shard_block_offset(h)) *
+            h->max_times_per_block;
     time_index_end = time_index_start + h->max_times_per_block - 1;
     if (time_index_end >= total_times)
         time_index_end = total_times - 1;
@@ -408,6 +488,7 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
     /* Set the number of active times in the block. */
     oskar_vis_block_set_num_times(d->vis_block, num_times_block, status);
     oskar_vis_block_set_start_time_index(d->vis_block, time_index_start);
+    oskar_vis_block_set_start_channel_index(d->vis_block, start_channel);
 
     /* Go though all possible work units in the block. A work unit is defined
      * as the simulation for one time and one sky chunk. */
@@ -416,21 +497,23 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
         oskar_Sky* sky;
         int i_work_unit, i_chunk, i_time, i_channel, sim_time_idx;
 
-        oskar_mutex_lock(h->mutex);
-        i_work_unit = (h->work_unit_index)++;
-        oskar_mutex_unlock(h->mutex);
+        i_work_unit = oskar_atomic_add_int(&h->work_unit_index, 1);
         if ((i_work_unit >= num_times_block * total_chunks) || *status) break;
 
         /* Convert slice index to chunk/time index. */
         i_chunk      = i_work_unit / num_times_block;
         i_time       = i_work_unit - i_chunk * num_times_block;
         sim_time_idx = time_index_start + i_time;
+        oskar_trace_begin_args(h->trace, d->thread_id, "Work unit",
+                "time", sim_time_idx, "chunk", i_chunk);
 
         /* Copy sky chunk to device only if different from the previous one. */
         if (i_chunk != d->previous_chunk_index)
         {
             oskar_timer_resume(d->tmr_copy);
+            oskar_trace_begin(h->trace, d->thread_id, "Copy sky");
             oskar_sky_copy(d->chunk, h->sky_chunks[i_chunk], status);
+            oskar_trace_end(h->trace, d->thread_id);
             oskar_timer_pause(d->tmr_copy);
         }
         sky = h->apply_horizon_clip ? d->chunk_clip : d->chunk;
@@ -442,35 +525,41 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
             mjd = obs_start_mjd + dt_dump_days * (sim_time_idx + 0.5);
             gast = oskar_convert_mjd_to_gast_fast(mjd);
             oskar_timer_resume(d->tmr_clip);
+            oskar_trace_begin(h->trace, d->thread_id, "Horizon clip");
             oskar_sky_horizon_clip(d->chunk_clip, d->chunk, d->tel, gast,
                     d->station_work, status);
+            oskar_trace_end(h->trace, d->thread_id);
             oskar_timer_pause(d->tmr_clip);
         }
 
-        /* Simulate all baselines for all channels for this time and chunk. */
+        /* Simulate all baselines for all channels for this time and chunk.
+         * Progress is recorded without locking, and reported by the
+         * thread that finalises the blocks. */
         for (i_channel = 0; i_channel < num_channels; ++i_channel)
         {
+            oskar_Event event;
             if (*status) break;
-            if (h->log)
-            {
-                oskar_mutex_lock(h->mutex);
-                oskar_log_message(h->log, 'S', 1, "Time %*i/%i, "
-                        "Chunk %*i/%i, Channel %*i/%i [Device %i, %i sources]",
-                        disp_width(total_times), sim_time_idx + 1, total_times,
-                        disp_width(total_chunks), i_chunk + 1, total_chunks,
-                        disp_width(num_channels), i_channel + 1, num_channels,
-                        device_id, oskar_sky_num_sources(sky));
-                oskar_mutex_unlock(h->mutex);
-            }
+            event.type = 0;
+            event.values[0] = sim_time_idx;
+            event.values[1] = i_chunk;
+            event.values[2] = start_channel + i_channel;
+            event.values[3] = device_id;
+            event.values[4] = oskar_sky_num_sources(sky);
+            event.time_sec = oskar_timer_wall_time();
+            oskar_event_ring_push(d->progress, &event);
             sim_baselines(h, d, sky, i_channel, i_time, sim_time_idx, status);
         }
         d->previous_chunk_index = i_chunk;
+        oskar_trace_end(h->trace, d->thread_id);
     }
 
     /* Copy the visibility block to host memory. */
     oskar_timer_resume(d->tmr_copy);
+    oskar_trace_begin(h->trace, d->thread_id, "Copy vis");
     oskar_vis_block_copy(d->vis_block_cpu[i_active], d->vis_block, status);
+    oskar_trace_end(h->trace, d->thread_id);
     oskar_timer_pause(d->tmr_copy);
+    oskar_trace_end(h->trace, d->thread_id);
     oskar_timer_pause(d->tmr_compute);
 }
 
@@ -517,7 +606,10 @@ static void* run_blocks(void* arg)
     for (b = 0; b < num_blocks + 1; ++b)
     {
         if ((thread_id > 0 || num_threads == 1) && b < num_blocks)
+        {
             oskar_interferometer_run_block(h, b, device_id, status);
+            if (thread_id > 0) oskar_latch_count_down(h->devices_done);
+        }
         if (thread_id == 0 && b > 0)
         {
             oskar_VisBlock* block;
@@ -525,11 +617,26 @@ static void* run_blocks(void* arg)
             oskar_interferometer_write_block(h, block, b - 1, status);
         }
 
+        /* Report progress at regular intervals until the block is done. */
+        if (thread_id == 0 && num_threads > 1 && b < num_blocks)
+        {
+            const double interval = h->progress_interval_sec > 0.0 ?
+                    h->progress_interval_sec : 1e6;
+            oskar_trace_begin(h->trace, 0, "Wait for devices");
+            while (!oskar_latch_wait(h->devices_done, interval))
+                progress_drain(h, 0);
+            oskar_trace_end(h->trace, 0);
+        }
+
         /* Barrier 1: Reset work unit index and print status. */
+        oskar_trace_begin(h->trace, thread_id, "Barrier");
         oskar_barrier_wait(h->barrier);
+        oskar_trace_end(h->trace, thread_id);
         if (thread_id == 0)
         {
             oskar_interferometer_reset_work_unit_index(h);
+            oskar_latch_set(h->devices_done, num_threads - 1);
+            progress_drain(h, 0);
             if (b < num_blocks && h->log && !*status)
                 oskar_log_message(h->log, 'S', 0, "Block %*i/%i (%3.0f%%) "
                         "complete. Simulation time elapsed: %.3f s",
@@ -539,7 +646,9 @@ static void* run_blocks(void* arg)
         }
 
         /* Barrier 2: Synchronise before moving to the next block. */
+        oskar_trace_begin(h->trace, thread_id, "Barrier");
         oskar_barrier_wait(h->barrier);
+        oskar_trace_end(h->trace, thread_id);
     }
     return 0;
 }
@@ -547,7 +656,7 @@ static void* run_blocks(void* arg)
 void oskar_interferometer_run(oskar_Interferometer* h, int* status)
 {
     int i, num_threads;
-    oskar_Thread** threads = 0;
+    oskar_Future** futures = 0;
     ThreadArgs* args = 0;
     if (*status || !h) return;
 
@@ -567,14 +676,23 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
         *status = OSKAR_ERR_FILE_IO;
         return;
     }
+    if (h->num_shards > 1 && h->ms_name)
+        oskar_log_warning(h->log, "Measurement Sets are not written when "
+                "sharding. Use oskar_vis_merge to combine the shards.");
 
     /* Initialise if required. */
     oskar_interferometer_check_init(h, status);
 
-    /* Set up worker threads. */
+    /* Set up worker threads, re-using the thread pool if possible. */
     num_threads = h->num_devices + 1;
     oskar_barrier_set_num_threads(h->barrier, num_threads);
-    threads = (oskar_Thread**) calloc(num_threads, sizeof(oskar_Thread*));
+    if (oskar_thread_pool_num_threads(h->pool) != num_threads)
+    {
+        oskar_thread_pool_free(h->pool);
+        h->pool = oskar_thread_pool_create(num_threads, 0, status);
+    }
+    if (*status) return;
+    futures = (oskar_Future**) calloc(num_threads, sizeof(oskar_Future*));
     args = (ThreadArgs*) calloc(num_threads, sizeof(ThreadArgs));
     for (i = 0; i < num_threads; ++i)
     {
@@ -595,28 +713,53 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
         oskar_log_section(h->log, 'M', "Starting simulation...");
     }
 
+    /* Create the trace recorder if required. */
+    if (h->trace_name && !*status)
+    {
+        char name[64];
+        h->trace = oskar_trace_create(num_threads);
+        oskar_trace_set_thread_name(h->trace, 0, "Writer");
+        for (i = 0; i < h->num_devices; ++i)
+        {
+            if (i < h->num_gpus)
+                sprintf(name, "Device %d (GPU %d)", i, h->gpu_ids[i]);
+            else
+                sprintf(name, "Device %d (CPU)", i);
+            oskar_trace_set_thread_name(h->trace, i + 1, name);
+        }
+    }
+
     /* Start simulation timer. */
     oskar_timer_start(h->tmr_sim);
+    oskar_latch_set(h->devices_done, num_threads - 1);
+    h->progress_start_sec = oskar_timer_wall_time();
+    h->progress_last_sec = h->progress_start_sec;
 
     /* Set status code. */
     h->status = *status;
 
     /* Start the worker threads. */
     oskar_interferometer_reset_work_unit_index(h);
-    for (i = 0; i < num_threads; ++i)
-        threads[i] = oskar_thread_create(run_blocks, (void*)&args[i], 0);
+    oskar_thread_pool_submit_all(h->pool, num_threads, run_blocks,
+            (void*)args, sizeof(ThreadArgs), futures, status);
 
     /* Wait for worker threads to finish. */
     for (i = 0; i < num_threads; ++i)
-    {
-        oskar_thread_join(threads[i]);
-        oskar_thread_free(threads[i]);
-    }
-    free(threads);
+        oskar_future_free(futures[i]);
+    free(futures);
     free(args);
 
     /* Get status code. */
-    *status = h->status;
+    if (!*status) *status = h->status;
+    progress_drain(h, 1);
+
+    /* Write the trace if required. */
+    if (h->trace)
+    {
+        oskar_trace_write(h->trace, h->trace_name, status);
+        oskar_trace_free(h->trace);
+        h->trace = 0;
+    }
 
     /* Record memory usage. */
     if (h->log && !*status)
@@ -662,14 +805,21 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
         char* log_data;
         oskar_log_set_value_width(h->log, 25);
         record_timing(h);
+        record_beam_lut_error(h);
         oskar_log_section(h->log, 'M', "Simulation complete");
         oskar_log_message(h->log, 'M', 0, "Output(s):");
-        if (h->vis_name)
+        if (h->vis_name_out)
             oskar_log_value(h->log, 'M', 1,
-                    "OSKAR binary file", "%s", h->vis_name);
-        if (h->ms_name)
+                    "OSKAR binary file", "%s", h->vis_name_out);
+        if (h->ms)
             oskar_log_value(h->log, 'M', 1,
                     "Measurement Set", "%s", h->ms_name);
+        if (h->progress_file)
+            oskar_log_value(h->log, 'M', 1,
+                    "Progress stream", "%s", h->progress_name);
+        if (h->trace_name)
+            oskar_log_value(h->log, 'M', 1,
+                    "Trace", "%s", h->trace_name);
 
         /* Write simulation log to the output files. */
         log_data = oskar_log_file_data(h->log, &log_size);
@@ -817,6 +967,26 @@ void oskar_interferometer_set_observation_time(oskar_Interferometer* h,
 }
 
 
+void oskar_interferometer_set_progress_file(oskar_Interferometer* h,
+        const char* filename)
+{
+    int len;
+    len = (int) strlen(filename);
+    free(h->progress_name);
+    h->progress_name = 0;
+    if (len == 0) return;
+    h->progress_name = calloc(1 + len, 1);
+    strcpy(h->progress_name, filename);
+}
+
+
+void oskar_interferometer_set_progress_interval(oskar_Interferometer* h,
+        double interval_sec)
+{
+    h->progress_interval_sec = interval_sec;
+}
+
+
 void oskar_interferometer_set_settings_path(oskar_Interferometer* h,
         const char* filename)
 {
@@ -829,6 +999,30 @@ void oskar_interferometer_set_settings_path(oskar_Interferometer* h,
 }
 
 
+void oskar_interferometer_set_shard(oskar_Interferometer* h,
+        int shard_index, int num_shards, const char* mode, int* status)
+{
+    if (*status) return;
+    if (num_shards < 1 || shard_index < 0 || shard_index >= num_shards)
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return;
+    }
+    if (!strncmp(mode, "T", 1) || !strncmp(mode, "t", 1) ||
+            !strncmp(mode, "B", 1) || !strncmp(mode, "b", 1))
+        h->shard_mode = 'T';
+    else if (!strncmp(mode, "C", 1) || !strncmp(mode, "c", 1))
+        h->shard_mode = 'C';
+    else
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return;
+    }
+    h->shard_index = shard_index;
+    h->num_shards = num_shards;
+}
+
+
 void oskar_interferometer_set_sky_model(oskar_Interferometer* h,
         const oskar_Sky* sky, int* status)
 {
@@ -924,6 +1118,19 @@ void oskar_interferometer_set_source_flux_range(oskar_Interferometer* h,
 }
 
 
+void oskar_interferometer_set_trace_file(oskar_Interferometer* h,
+        const char* filename)
+{
+    int len;
+    len = (int) strlen(filename);
+    free(h->trace_name);
+    h->trace_name = 0;
+    if (len == 0) return;
+    h->trace_name = calloc(1 + len, 1);
+    strcpy(h->trace_name, filename);
+}
+
+
 void oskar_interferometer_set_zero_failed_gaussians(oskar_Interferometer* h,
         int value)
 {
@@ -944,15 +1151,19 @@ void oskar_interferometer_write_block(oskar_Interferometer* h,
 
     /* Open files only if required, and write the block into them. */
     oskar_timer_resume(h->tmr_write);
+    oskar_trace_begin_args(h->trace, 0, "Write", "block", block_index, 0, 0);
 #ifndef OSKAR_NO_MS
-    if (h->ms_name && !h->ms)
+    if (h->ms_name && !h->ms && h->num_shards <= 1)
         h->ms = oskar_vis_header_write_ms(h->header, h->ms_name, OSKAR_TRUE,
                 h->force_polarised_ms, status);
     if (h->ms) oskar_vis_block_write_ms(block, h->header, h->ms, status);
 #endif
-    if (h->vis_name && !h->vis)
-        h->vis = oskar_vis_header_write(h->header, h->vis_name, status);
+    if (!h->vis && !h->vis_name_out)
+        h->vis_name_out = shard_vis_name(h);
+    if (h->vis_name_out && !h->vis)
+        h->vis = oskar_vis_header_write(h->header, h->vis_name_out, status);
     if (h->vis) oskar_vis_block_write(block, h->vis, block_index, status);
+    oskar_trace_end(h->trace, 0);
     oskar_timer_pause(h->tmr_write);
 }
 
@@ -984,9 +1195,15 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
     t_start = h->time_start_mjd_utc;
     t_dump = t_start + dt_dump_days * (time_index_simulation + 0.5);
     gast = oskar_convert_mjd_to_gast_fast(t_dump);
-    frequency = h->freq_start_hz + channel_index_block * h->freq_inc_hz;
-
-    /* Scale source fluxes with spectral index and rotation measure. */
+    frequency = h->freq_start_hz + h->freq_inc_hz *
+            (oskar_vis_block_start_channel_index(d->vis_block) +
+                    channel_index_block);
+
+    /* Scale source fluxes with spectral index and rotation measure.
+     * Fluxes are always scaled from the reference values, so the result
+     * does not depend on the channels simulated before this one. */
+    oskar_sky_copy(d->chunk_freq, sky, status);
+    sky = d->chunk_freq;
     oskar_sky_scale_flux_with_frequency(sky, frequency, status);
 
     /* Evaluate station u,v,w coordinates. */
@@ -1009,9 +1226,11 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
 
     /* Evaluate station beam (Jones E: may be matrix). */
     oskar_timer_resume(d->tmr_E);
+    oskar_trace_begin(h->trace, d->thread_id, "Jones E");
     oskar_evaluate_jones_E(d->E, num_src, OSKAR_RELATIVE_DIRECTIONS,
             oskar_sky_l(sky), oskar_sky_m(sky), oskar_sky_n(sky), d->tel,
             gast, frequency, d->station_work, time_index_simulation, status);
+    oskar_trace_end(h->trace, d->thread_id);
     oskar_timer_pause(d->tmr_E);
 
 #if 0
@@ -1033,29 +1252,38 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
     if (d->R)
     {
         oskar_timer_resume(d->tmr_E);
+        oskar_trace_begin(h->trace, d->thread_id, "Jones R");
         oskar_evaluate_jones_R(d->R, num_src, oskar_sky_ra_rad_const(sky),
                 oskar_sky_dec_rad_const(sky), d->tel, gast, status);
+        oskar_trace_end(h->trace, d->thread_id);
         oskar_timer_pause(d->tmr_E);
         oskar_timer_resume(d->tmr_join);
+        oskar_trace_begin(h->trace, d->thread_id, "Join");
         oskar_jones_join(d->R, d->E, d->R, status);
+        oskar_trace_end(h->trace, d->thread_id);
         oskar_timer_pause(d->tmr_join);
     }
 
     /* Evaluate interferometer phase (Jones K: scalar). */
     oskar_timer_resume(d->tmr_K);
+    oskar_trace_begin(h->trace, d->thread_id, "Jones K");
     oskar_evaluate_jones_K(d->K, num_src, oskar_sky_l_const(sky),
             oskar_sky_m_const(sky), oskar_sky_n_const(sky), d->u, d->v, d->w,
             frequency, oskar_sky_I_const(sky),
             h->source_min_jy, h->source_max_jy, status);
+    oskar_trace_end(h->trace, d->thread_id);
     oskar_timer_pause(d->tmr_K);
 
     /* Join Jones K with Jones Z*E. */
     oskar_timer_resume(d->tmr_join);
+    oskar_trace_begin(h->trace, d->thread_id, "Join");
     oskar_jones_join(d->J, d->K, d->R ? d->R : d->E, status);
+    oskar_trace_end(h->trace, d->thread_id);
     oskar_timer_pause(d->tmr_join);
 
     /* Create alias for auto/cross-correlations. */
     oskar_timer_resume(d->tmr_correlate);
+    oskar_trace_begin(h->trace, d->thread_id, "Correlate");
     alias = oskar_mem_create_alias(0, 0, 0, status);
 
     /* Auto-correlate for this time and channel. */
@@ -1083,13 +1311,14 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
 
     /* Free alias for auto/cross-correlations. */
     oskar_mem_free(alias, status);
+    oskar_trace_end(h->trace, d->thread_id);
     oskar_timer_pause(d->tmr_correlate);
 }
 
 
 static void set_up_vis_header(oskar_Interferometer* h, int* status)
 {
-    int num_stations, vis_type;
+    int num_stations, vis_type, num_times, start_channel, num_channels;
     const double rad2deg = 180.0/M_PI;
     int write_autocorr = 0, write_crosscorr = 0;
     if (*status) return;
@@ -1110,8 +1339,22 @@ static void set_up_vis_header(oskar_Interferometer* h, int* status)
     vis_type = h->prec | OSKAR_COMPLEX;
     if (oskar_telescope_pol_mode(h->tel) == OSKAR_POL_MODE_FULL)
         vis_type |= OSKAR_MATRIX;
+    num_times = h->num_time_steps;
+    if (h->num_shards > 1 && h->shard_mode == 'T')
+    {
+        /* Only the time samples in this shard's blocks are written.
+         * Blocks retain their global start time index. */
+        int block_end;
+        block_end = shard_block_offset(h) +
+                oskar_interferometer_num_vis_blocks(h);
+        num_times = block_end * h->max_times_per_block;
+        if (num_times > h->num_time_steps)
+            num_times = h->num_time_steps;
+        num_times -= shard_block_offset(h) * h->max_times_per_block;
+    }
+    shard_channels(h, &start_channel, &num_channels);
     h->header = oskar_vis_header_create(vis_type, h->prec,
-            h->max_times_per_block, h->num_time_steps, h->num_channels,
+            h->max_times_per_block, num_times, num_channels,
             h->num_channels, num_stations, write_autocorr, write_crosscorr,
             status);
 
@@ -1158,6 +1401,7 @@ static void set_up_vis_header(oskar_Interferometer* h, int* status)
 static void set_up_device_data(oskar_Interferometer* h, int* status)
 {
     int i, dev_loc, complx, vistype, num_stations, num_src;
+    int start_channel, num_channels, num_units;
     if (*status) return;
 
     /* Get local variables. */
@@ -1173,10 +1417,18 @@ static void set_up_device_data(oskar_Interferometer* h, int* status)
     if (h->num_devices < h->num_gpus)
         oskar_interferometer_set_num_devices(h, h->num_gpus);
 
+    /* Each device records one progress event per work unit. The writer
+     * drains the rings at the end of every block, so a ring that holds
+     * all the work units of one block can never overflow. */
+    shard_channels(h, &start_channel, &num_channels);
+    num_units = h->max_times_per_block * h->num_sky_chunks * num_channels;
+    if (num_units < 1024) num_units = 1024;
+
     for (i = 0; i < h->num_devices; ++i)
     {
         DeviceData* d = &h->d[i];
         d->previous_chunk_index = -1;
+        d->thread_id = i + 1;
 
         /* Select the device. */
         if (i < h->num_gpus)
@@ -1203,6 +1455,20 @@ static void set_up_device_data(oskar_Interferometer* h, int* status)
             d->tmr_correlate = oskar_timer_create(timer_type);
         }
 
+        /* Progress events. */
+        if (d->progress && d->progress_capacity < num_units)
+        {
+            oskar_event_ring_free(d->progress);
+            d->progress = 0;
+        }
+        if (!d->progress)
+        {
+            d->progress = oskar_event_ring_create(num_units);
+            d->progress_capacity = num_units;
+            if (!d->progress) *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        }
+        d->progress_units = 0;
+
         /* Visibility blocks. */
         if (!d->vis_block)
         {
@@ -1225,6 +1491,7 @@ static void set_up_device_data(oskar_Interferometer* h, int* status)
             d->w = oskar_mem_create(h->prec, dev_loc, num_stations, status);
             d->chunk = oskar_sky_create(h->prec, dev_loc, num_src, status);
             d->chunk_clip = oskar_sky_create(h->prec, dev_loc, num_src, status);
+            d->chunk_freq = oskar_sky_create(h->prec, dev_loc, num_src, status);
             d->tel = oskar_telescope_create_copy(h->tel, dev_loc, status);
             d->J = oskar_jones_create(vistype, dev_loc, num_stations, num_src,
                     status);
@@ -1259,6 +1526,7 @@ static void free_device_data(oskar_Interferometer* h, int* status)
         oskar_timer_free(d->tmr_K);
         oskar_timer_free(d->tmr_join);
         oskar_timer_free(d->tmr_correlate);
+        oskar_event_ring_free(d->progress);
         oskar_vis_block_free(d->vis_block_cpu[0], status);
         oskar_vis_block_free(d->vis_block_cpu[1], status);
         oskar_vis_block_free(d->vis_block, status);
@@ -1267,6 +1535,7 @@ static void free_device_data(oskar_Interferometer* h, int* status)
         oskar_mem_free(d->w, status);
         oskar_sky_free(d->chunk, status);
         oskar_sky_free(d->chunk_clip, status);
+        oskar_sky_free(d->chunk_freq, status);
         oskar_telescope_free(d->tel, status);
         oskar_station_work_free(d->station_work, status);
         oskar_jones_free(d->J, status);
@@ -1327,6 +1596,217 @@ static void record_timing(oskar_Interferometer* h)
 }
 
 
+/*
+ * Each work unit covers one sky chunk, all stations, all times in the block
+ * and all channels, so it needs a station beam look-up table for each of
+ * these. If they don't all fit in memory, tables would be discarded and
+ * generated again for every sky chunk, which is slower than evaluating
+ * the station beams directly.
+ */
+static void check_beam_lut_memory(oskar_Interferometer* h, int* status)
+{
+    int i, c, type, num_stations, start_channel, num_channels, num_times;
+    size_t bytes = 0, max_bytes;
+    if (*status || h->num_devices <= h->num_gpus) return;
+    type = h->prec | OSKAR_COMPLEX;
+    if (oskar_telescope_pol_mode(h->tel) == OSKAR_POL_MODE_FULL)
+        type |= OSKAR_MATRIX;
+    num_stations = oskar_telescope_num_stations(h->tel);
+    if (oskar_telescope_allow_station_beam_duplication(h->tel) &&
+            oskar_telescope_identical_stations(h->tel))
+        num_stations = 1;
+    num_times = h->max_times_per_block;
+    if (num_times > h->num_time_steps) num_times = h->num_time_steps;
+    shard_channels(h, &start_channel, &num_channels);
+    for (c = start_channel; c < start_channel + num_channels; ++c)
+    {
+        const double freq_hz = h->freq_start_hz + c * h->freq_inc_hz;
+        for (i = 0; i < num_stations; ++i)
+            bytes += oskar_evaluate_station_beam_lut_bytes(
+                    oskar_telescope_station_const(h->tel, i), freq_hz,
+                    type, status);
+    }
+    bytes *= num_times;
+    max_bytes = oskar_station_work_beam_lut_max_bytes(
+            h->d[h->num_gpus].station_work);
+    if (bytes <= max_bytes) return;
+    oskar_log_warning(h->log, "Station beam look-up tables for each block "
+            "need %.1f MB, more than the limit of %.1f MB.",
+            bytes / (1024.0 * 1024.0), max_bytes / (1024.0 * 1024.0));
+    oskar_log_warning(h->log, "Evaluating station beams directly instead.");
+    for (i = 0; i < h->num_devices; ++i)
+        oskar_station_work_set_beam_lut(h->d[i].station_work, 0);
+}
+
+
+static void record_beam_lut_error(oskar_Interferometer* h)
+{
+    int i;
+    double error = 0.0;
+    for (i = 0; i < h->num_devices; ++i)
+    {
+        double t;
+        if (!h->d[i].station_work) continue;
+        t = oskar_station_work_beam_lut_error(h->d[i].station_work);
+        if (t > error) error = t;
+    }
+    if (error > 0.0)
+        oskar_log_value(h->log, 'M', 0, "Station beam look-up table error",
+                "%.3e (relative to peak)", error);
+}
+
+
+static void shard_range(int total, int shard_index, int num_shards,
+        int* start, int* size)
+{
+    *start = (int)(((long long)total * shard_index) / num_shards);
+    *size = (int)(((long long)total * (shard_index + 1)) / num_shards) -
+            *start;
+}
+
+
+static int shard_block_offset(const oskar_Interferometer* h)
+{
+    int start = 0, size = 0;
+    if (h->num_shards <= 1 || h->shard_mode != 'T') return 0;
+    shard_range((h->num_time_steps + h->max_times_per_block - 1) /
+            h->max_times_per_block, h->shard_index, h->num_shards,
+            &start, &size);
+    return start;
+}
+
+
+static void shard_channels(const oskar_Interferometer* h,
+        int* start, int* size)
+{
+    *start = 0;
+    *size = h->num_channels;
+    if (h->num_shards > 1 && h->shard_mode == 'C')
+        shard_range(h->num_channels, h->shard_index, h->num_shards,
+                start, size);
+}
+
+
+static char* shard_vis_name(const oskar_Interferometer* h)
+{
+    const char* name;
+    char* out = 0;
+    int len;
+
+    /* Use the OSKAR binary file name unless sharding. */
+    if (h->num_shards <= 1)
+    {
+        if (!h->vis_name) return 0;
+        out = (char*) calloc(1 + strlen(h->vis_name), 1);
+        strcpy(out, h->vis_name);
+        return out;
+    }
+
+    /* Shards are always written as OSKAR binary files.
+     * Strip any extension from the root name before adding a suffix. */
+    name = h->vis_name ? h->vis_name : h->ms_name;
+    if (!name) return 0;
+    len = (int) strlen(name);
+    if (len >= 4 && !strcmp(&name[len - 4], ".vis")) len -= 4;
+    else if (len >= 3 && (!strcmp(&name[len - 3], ".MS") ||
+            !strcmp(&name[len - 3], ".ms"))) len -= 3;
+    out = (char*) calloc(len + 40, 1);
+    memcpy(out, name, len);
+    sprintf(out + len, "_shard_%d_of_%d.vis",
+            h->shard_index, h->num_shards);
+    return out;
+}
+
+
+/* Reports progress events recorded by the device threads.
+ * This must only be called by one thread at a time. */
+static void progress_drain(oskar_Interferometer* h, int final)
+{
+    int i, dropped = 0, start_channel, num_channels;
+    double now, elapsed, rate, eta;
+    if (!h->d || !h->header) return;
+
+    /* Write human-readable messages in time-stamp order. */
+    for (;;)
+    {
+        const oskar_Event *e, *t;
+        DeviceData* d = 0;
+        for (i = 0, e = 0; i < h->num_devices; ++i)
+        {
+            if (!h->d[i].progress) continue;
+            t = oskar_event_ring_peek(h->d[i].progress);
+            if (t && (!e || t->time_sec < e->time_sec))
+            {
+                e = t;
+                d = &h->d[i];
+            }
+        }
+        if (!e) break;
+        if (h->log)
+            oskar_log_message(h->log, 'S', 1, "Time %*i/%i, "
+                    "Chunk %*i/%i, Channel %*i/%i [Device %i, %i sources]",
+                    disp_width(h->num_time_steps), e->values[0] + 1,
+                    h->num_time_steps,
+                    disp_width(h->num_sky_chunks), e->values[1] + 1,
+                    h->num_sky_chunks,
+                    disp_width(h->num_channels), e->values[2] + 1,
+                    h->num_channels, e->values[3], e->values[4]);
+        d->progress_units++;
+        h->progress_units_done++;
+        oskar_event_ring_pop(d->progress, 0);
+    }
+    for (i = 0; i < h->num_devices; ++i)
+        if (h->d[i].progress)
+            dropped += oskar_event_ring_num_dropped(h->d[i].progress);
+    if (h->log && dropped > h->progress_dropped)
+        oskar_log_warning(h->log, "%d progress messages were not reported.",
+                dropped - h->progress_dropped);
+    h->progress_dropped = dropped;
+
+    /* Write a line to the progress stream if required. */
+    if (!h->progress_name) return;
+    now = oskar_timer_wall_time();
+    if (h->progress_start_sec == 0.0)
+        h->progress_start_sec = h->progress_last_sec = now;
+    if (!final && now - h->progress_last_sec < h->progress_interval_sec)
+        return;
+    if (!h->progress_file)
+    {
+        h->progress_file = fopen(h->progress_name, "w");
+        if (!h->progress_file) return;
+    }
+    h->progress_last_sec = now;
+    shard_channels(h, &start_channel, &num_channels);
+    h->progress_units_total = (h->coords_only ? 0 : h->num_sky_chunks) *
+            num_channels * oskar_vis_header_num_times_total(h->header);
+    elapsed = now - h->progress_start_sec;
+    rate = elapsed > 0.0 ? (h->progress_units_done + dropped) / elapsed : 0.0;
+    eta = rate > 0.0 ? (h->progress_units_total -
+            h->progress_units_done - dropped) / rate : 0.0;
+    fprintf(h->progress_file, "{\"elapsed_sec\": %.3f, "
+            "\"units_done\": %d, \"units_total\": %d, "
+            "\"fraction\": %.4f, \"units_per_sec\": %.3f, "
+            "\"eta_sec\": %.3f, \"final\": %s, \"devices\": [",
+            elapsed, h->progress_units_done + dropped,
+            h->progress_units_total, h->progress_units_total > 0 ?
+                    (h->progress_units_done + dropped) /
+                    (double)h->progress_units_total : 0.0,
+            rate, eta > 0.0 ? eta : 0.0, final ? "true" : "false");
+    for (i = 0; i < h->num_devices; ++i)
+    {
+        int units = h->d[i].progress_units;
+        if (h->d[i].progress)
+            units += oskar_event_ring_num_dropped(h->d[i].progress);
+        fprintf(h->progress_file, "%s{\"device\": %d, \"gpu\": %s, "
+                "\"units\": %d, \"units_per_sec\": %.3f}",
+                i > 0 ? ", " : "", i, i < h->num_gpus ? "true" : "false",
+                units, elapsed > 0.0 ? units / elapsed : 0.0);
+    }
+    fprintf(h->progress_file, "]}\n");
+    fflush(h->progress_file);
+}
+
+
 static unsigned int disp_width(unsigned int v)
 {
     return (v >= 100000u) ? 6 : (v >= 10000u) ? 5 : (v >= 1000u) ? 4 :
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_DFT_C2R_2D_SEPARABLE_OMP_H_
+#define OSKAR_DFT_C2R_2D_SEPARABLE_OMP_H_
+
+/**
+ * @file oskar_dft_c2r_2d_separable_omp.h
+ */
+
+#include <oskar_global.h>
+#include <utility/oskar_vector_types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Function to tabulate the column phase factors for the separable 2D
+ * complex-to-real single-precision DFT.
+ *
+ * @details
+ * Evaluates the x-dependent phase factors for each input point and each
+ * output column, for use by oskar_dft_c2r_2d_separable_omp_f().
+ *
+ * The tables are indexed [input][x], so each must have space for
+ * \p num_in * \p num_x elements. OpenMP is used to divide the input points
+ * between threads. The tables depend only on the input and output x
+ * positions, so they can be shared by all threads that compute different
+ * output rows for the same input points.
+ *
+ * @param[in] num_in       Number of input points.
+ * @param[in] wavenumber   Wavenumber (2 pi / wavelength).
+ * @param[in] x_in         Array of input x positions.
+ * @param[in] num_x        Number of output points along x.
+ * @param[in] x_out        Array of output x positions (length \p num_x).
+ * @param[out] col_re      Real parts of the column phase factors.
+ * @param[out] col_im      Imaginary parts of the column phase factors.
+ */
+OSKAR_EXPORT
+void oskar_dft_c2r_2d_separable_columns_f(const int num_in,
+        const float wavenumber, const float* x_in, const int num_x,
+        const float* x_out, float* col_re, float* col_im);
+
+/**
+ * @brief
+ * Function to perform a 2D complex-to-real single-precision DFT onto a
+ * regular grid, using separable phase factors.
+ *
+ * @details
+ * Computes a real output from a set of complex input data, by evaluating
+ * a 2D Direct Fourier Transform (DFT) onto a grid of output points
+ * formed from the outer product of the output x and y positions.
+ *
+ * Since the phase factor at each output point separates into a product of
+ * an x-dependent and a y-dependent term, the output is formed using only
+ * complex multiply-accumulate operations. The x-dependent (column) terms
+ * must be supplied, and can be tabulated using
+ * oskar_dft_c2r_2d_separable_columns_f(). The y-dependent (row) terms
+ * are evaluated here, and the inputs and outputs are processed in blocks
+ * to keep them in cache. OpenMP is used to divide the output rows between
+ * threads.
+ *
+ * The wavelength used to compute the supplied wavenumber must be in the
+ * same units as the input positions.
+ *
+ * The fastest-varying dimension in the output array is along x. The output is
+ * assumed to be completely real, so the conjugate copy of the input data
+ * should not be supplied.
+ *
+ * @param[in] num_in       Number of input points.
+ * @param[in] wavenumber   Wavenumber (2 pi / wavelength).
+ * @param[in] y_in         Array of input y positions.
+ * @param[in] data_in      Array of complex input data.
+ * @param[in] weight_in    Array of input data weights.
+ * @param[in] num_x        Number of output points along x.
+ * @param[in] col_re       Real parts of the column phase factors.
+ * @param[in] col_im       Imaginary parts of the column phase factors.
+ * @param[in] num_y        Number of output points along y.
+ * @param[in] y_out        Array of output y positions (length \p num_y).
+ * @param[out] output      Array of computed output points.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_dft_c2r_2d_separable_omp_f(const int num_in,
+        const float wavenumber, const float* y_in, const float2* data_in,
+        const float* weight_in, const int num_x, const float* col_re,
+        const float* col_im, const int num_y, const float* y_out,
+        float* output, int* status);
+
+/**
+ * @brief
+ * Function to tabulate the column phase factors for the separable 2D
+ * complex-to-real double-precision DFT.
+ *
+ * @details
+ * Evaluates the x-dependent phase factors for each input point and each
+ * output column, for use by oskar_dft_c2r_2d_separable_omp_d().
+ *
+ * The tables are indexed [input][x], so each must have space for
+ * \p num_in * \p num_x elements. OpenMP is used to divide the input points
+ * between threads. The tables depend only on the input and output x
+ * positions, so they can be shared by all threads that compute different
+ * output rows for the same input points.
+ *
+ * @param[in] num_in       Number of input points.
+ * @param[in] wavenumber   Wavenumber (2 pi / wavelength).
+ * @param[in] x_in         Array of input x positions.
+ * @param[in] num_x        Number of output points along x.
+ * @param[in] x_out        Array of output x positions (length \p num_x).
+ * @param[out] col_re      Real parts of the column phase factors.
+ * @param[out] col_im      Imaginary parts of the column phase factors.
+ */
+OSKAR_EXPORT
+void oskar_dft_c2r_2d_separable_columns_d(const int num_in,
+        const double wavenumber, const double* x_in, const int num_x,
+        const double* x_out, double* col_re, double* col_im);
+
+/**
+ * @brief
+ * Function to perform a 2D complex-to-real double-precision DFT onto a
+ * regular grid, using separable phase factors.
+ *
+ * @details
+ * Computes a real output from a set of complex input data, by evaluating
+ * a 2D Direct Fourier Transform (DFT) onto a grid of output points
+ * formed from the outer product of the output x and y positions.
+ *
+ * Since the phase factor at each output point separates into a product of
+ * an x-dependent and a y-dependent term, the output is formed using only
+ * complex multiply-accumulate operations. The x-dependent (column) terms
+ * must be supplied, and can be tabulated using
+ * oskar_dft_c2r_2d_separable_columns_d(). The y-dependent (row) terms
+ * are evaluated here, and the inputs and outputs are processed in blocks
+ * to keep them in cache. OpenMP is used to divide the output rows between
+ * threads.
+ *
+ * The wavelength used to compute the supplied wavenumber must be in the
+ * same units as the input positions.
+ *
+ * The fastest-varying dimension in the output array is along x. The output is
+ * assumed to be completely real, so the conjugate copy of the input data
+ * should not be supplied.
+ *
+ * @param[in] num_in       Number of input points.
+ * @param[in] wavenumber   Wavenumber (2 pi / wavelength).
+ * @param[in] y_in         Array of input y positions.
+ * @param[in] data_in      Array of complex input data.
+ * @param[in] weight_in    Array of input data weights.
+ * @param[in] num_x        Number of output points along x.
+ * @param[in] col_re       Real parts of the column phase factors.
+ * @param[in] col_im       Imaginary parts of the column phase factors.
+ * @param[in] num_y        Number of output points along y.
+ * @param[in] y_out        Array of output y positions (length \p num_y).
+ * @param[out] output      Array of computed output points.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_dft_c2r_2d_separable_omp_d(const int num_in,
+        const double wavenumber, const double* y_in, const double2* data_in,
+        const double* weight_in, const int num_x, const double* col_re,
+        const double* col_im, const int num_y, const double* y_out,
+        double* output, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_DFT_C2R_2D_SEPARABLE_OMP_H_ */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -50,6 +50,17 @@ void oskar_fftpack_cfft2f(const int ldim, const int l, const int m,
 OSKAR_EXPORT
 void oskar_fftpack_cfft2i(const int l, const int m, double *wsave);
 
+OSKAR_EXPORT
+void oskar_fftpack_cfftmb(const int lot, const int jump, const int n,
+        const int inc, double *c, double *wsave, double *work);
+
+OSKAR_EXPORT
+void oskar_fftpack_cfftmf(const int lot, const int jump, const int n,
+        const int inc, double *c, double *wsave, double *work);
+
+OSKAR_EXPORT
+void oskar_fftpack_cfftmi(const int n, double *wsave);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_NUFFT_TYPE3_H_
+#define OSKAR_NUFFT_TYPE3_H_
+
+/**
+ * @file oskar_nufft_type3.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Evaluates a 2D non-uniform to non-uniform (type-3) Fourier sum.
+ *
+ * @details
+ * This function evaluates
+ *
+ *   output[k] = sum_j weights_in[j] * exp(i (u_out[k] x_in[j] + v_out[k] y_in[j]))
+ *
+ * to the requested relative \p tolerance, using a type-3 non-uniform FFT.
+ *
+ * The input points are spread onto a uniform grid with a Gaussian kernel,
+ * the grid is transformed with an oversampled FFT, and the result is
+ * interpolated to the output frequencies with a second Gaussian kernel
+ * before the spreading kernel is deconvolved (Greengard & Lee, 2004;
+ * Lee & Greengard, 2005). The grid size depends only on the product of
+ * the extents of the input and output coordinates, not on the number of
+ * points, so the cost is O(N log N + (num_in + num_out) w^2), where w is
+ * the kernel width required for the tolerance.
+ *
+ * The input positions must all be finite. Output values are set to NaN
+ * where either output frequency is not finite.
+ *
+ * The grid size is limited to 2^26 cells before oversampling:
+ * if it would be larger, the status code is set to
+ * OSKAR_ERR_MEMORY_ALLOC_FAILURE.
+ *
+ * All arrays are double precision and must be in CPU memory.
+ * Complex arrays are interleaved (real, imaginary).
+ *
+ * @param[in] num_in       Number of input points.
+ * @param[in] x_in         Array of input x positions.
+ * @param[in] y_in         Array of input y positions.
+ * @param[in] weights_in   Array of complex input weights.
+ * @param[in] num_out      Number of output points.
+ * @param[in] u_out        Array of output x frequencies (radians per unit x).
+ * @param[in] v_out        Array of output y frequencies (radians per unit y).
+ * @param[in] tolerance    Required relative accuracy (1e-14 to 1e-1).
+ * @param[out] output      Array of complex output values.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_nufft_type3_2d(int num_in, const double* x_in, const double* y_in,
+        const double* weights_in, int num_out, const double* u_out,
+        const double* v_out, double tolerance, double* output, int* status);
+
+/**
+ * @brief
+ * Returns the approximate cost of a 2D type-3 NUFFT, relative to the DFT.
+ *
+ * @details
+ * Returns an estimate of the time taken by oskar_nufft_type3_2d()
+ * divided by the time taken to evaluate the same sum directly, given
+ * the number and half-widths of the input and output coordinates.
+ *
+ * This can be used to decide whether the NUFFT is worth using:
+ * it is only likely to be faster if the returned value is less than 1.
+ * HUGE_VAL is returned if the grid would be too large to allocate.
+ *
+ * @param[in] num_in       Number of input points.
+ * @param[in] num_out      Number of output points.
+ * @param[in] x_half_width Half the extent of the input x positions.
+ * @param[in] y_half_width Half the extent of the input y positions.
+ * @param[in] u_half_width Half the extent of the output x frequencies.
+ * @param[in] v_half_width Half the extent of the output y frequencies.
+ * @param[in] tolerance    Required relative accuracy.
+ */
+OSKAR_EXPORT
+double oskar_nufft_type3_2d_relative_cost(int num_in, int num_out,
+        double x_half_width, double y_half_width,
+        double u_half_width, double v_half_width, double tolerance);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_NUFFT_TYPE3_H_ */
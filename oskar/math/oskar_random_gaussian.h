@@ -100,6 +100,51 @@ void oskar_random_gaussian4(unsigned int seed, unsigned int counter0,
         unsigned int counter1, unsigned int counter2, unsigned int counter3,
         double rnd[4]);
 
+/**
+ * @brief
+ * Generates an array of pairs of random numbers selected from a Gaussian
+ * distribution with a mean of zero and standard deviation of 1.
+ *
+ * @details
+ * This is equivalent to calling oskar_random_gaussian2() \p num times,
+ * with the first counter running from \p counter0 to (\p counter0 + \p num - 1),
+ * and gives identical results. The counters are generated in chunks so
+ * that the integer part of the generator can be vectorised.
+ *
+ * @param[in]     seed         Random seed.
+ * @param[in]     counter0     First value of the first counter.
+ * @param[in]     counter1     User-defined counter.
+ * @param[in]     num          Number of counter values to use.
+ * @param[out]    rnd          Array of (2 * \p num) random numbers.
+ */
+OSKAR_EXPORT
+void oskar_random_gaussian2_array(unsigned int seed, unsigned int counter0,
+        unsigned int counter1, int num, double* rnd);
+
+/**
+ * @brief
+ * Generates an array of quads of random numbers selected from a Gaussian
+ * distribution with a mean of zero and standard deviation of 1.
+ *
+ * @details
+ * This is equivalent to calling oskar_random_gaussian4() \p num times,
+ * with the first counter running from \p counter0 to (\p counter0 + \p num - 1),
+ * and gives identical results. The counters are generated in chunks so
+ * that the integer part of the generator can be vectorised.
+ *
+ * @param[in]     seed         Random seed.
+ * @param[in]     counter0     First value of the first counter.
+ * @param[in]     counter1     User-defined counter.
+ * @param[in]     counter2     User-defined counter.
+ * @param[in]     counter3     User-defined counter.
+ * @param[in]     num          Number of counter values to use.
+ * @param[out]    rnd          Array of (4 * \p num) random numbers.
+ */
+OSKAR_EXPORT
+void oskar_random_gaussian4_array(unsigned int seed, unsigned int counter0,
+        unsigned int counter1, unsigned int counter2, unsigned int counter3,
+        int num, double* rnd);
+
 /**
  * @brief
  * Generates a random number from a Gaussian distribution with zero mean
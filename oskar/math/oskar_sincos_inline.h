@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_SINCOS_INLINE_H_
+#define OSKAR_SINCOS_INLINE_H_
+
+/**
+ * @file oskar_sincos_inline.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Branch-free sine and cosine, written so that loops calling these
+ * functions can be vectorised by the compiler.
+ *
+ * The argument is reduced to [-pi/4, pi/4] by subtracting the nearest
+ * multiple of pi/2 (using an extended-precision representation of pi/2),
+ * and the results are computed from minimax polynomials (from Cephes).
+ *
+ * The single-precision version is accurate to about one ulp for |x| < 1e4,
+ * with an absolute error of about 1e-6 at |x| = 1e5; it should not be used
+ * for larger arguments. The double-precision version is accurate to about
+ * one ulp for |x| < 1e6, and should not be used for |x| > 1e9.
+ */
+
+/**
+ * @brief
+ * Evaluates the sine and cosine of \p x (single precision).
+ *
+ * @param[in] x   Angle in radians.
+ * @param[out] s  Sine of \p x.
+ * @param[out] c  Cosine of \p x.
+ */
+OSKAR_INLINE
+void oskar_sincos_inline_f(const float x, float* s, float* c)
+{
+    float r, z, ps, pc;
+    const float q = x * 0.636619772367581343f; /* 2 / pi */
+    const int n = (int) (q + (q >= 0.0f ? 0.5f : -0.5f));
+    const float fn = (float) n;
+    r = x - fn * 1.5703125f;
+    r -= fn * 4.837512969970703125e-4f;
+    r -= fn * 7.54978995489188216e-8f;
+    z = r * r;
+    ps = ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z -
+            1.6666654611e-1f) * z * r + r;
+    pc = ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z +
+            4.166664568298827e-2f) * z * z - 0.5f * z + 1.0f;
+    *s = (n & 1) ? pc : ps;
+    *c = (n & 1) ? ps : pc;
+    *s = (n & 2) ? -*s : *s;
+    *c = ((n + 1) & 2) ? -*c : *c;
+}
+
+/**
+ * @brief
+ * Evaluates the sine and cosine of \p x (double precision).
+ *
+ * @param[in] x   Angle in radians.
+ * @param[out] s  Sine of \p x.
+ * @param[out] c  Cosine of \p x.
+ */
+OSKAR_INLINE
+void oskar_sincos_inline_d(const double x, double* s, double* c)
+{
+    double r, z, ps, pc;
+    const double q = x * 0.636619772367581343075535; /* 2 / pi */
+    const int n = (int) (q + (q >= 0.0 ? 0.5 : -0.5));
+    const double fn = (double) n;
+    r = x - fn * 1.57079632673412561417e+00;
+    r -= fn * 6.07710050630396597660e-11;
+    r -= fn * 2.02226624871116645580e-21;
+    z = r * r;
+    ps = (((((1.58962301576546568060e-10 * z -
+            2.50507477628578072866e-8) * z +
+            2.75573136213857245213e-6) * z -
+            1.98412698295895385996e-4) * z +
+            8.33333333332211858878e-3) * z -
+            1.66666666666666307295e-1) * z * r + r;
+    pc = (((((-1.13585365213876817300e-11 * z +
+            2.08757008419747316778e-9) * z -
+            2.75573141792967388112e-7) * z +
+            2.48015872888517045348e-5) * z -
+            1.38888888888730564116e-3) * z +
+            4.16666666666665929218e-2) * z * z - 0.5 * z + 1.0;
+    *s = (n & 1) ? pc : ps;
+    *c = (n & 1) ? ps : pc;
+    *s = (n & 2) ? -*s : *s;
+    *c = ((n + 1) & 2) ? -*c : *c;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_SINCOS_INLINE_H_ */
@@ -0,0 +1,345 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "math/oskar_dft_c2r_2d_separable_omp.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of input points in each block of the row factors. */
+#define BLOCK_IN 32
+
+/* Number of output columns updated together. */
+#define BLOCK_X 128
+
+/* Number of output rows updated together. */
+#define ROWS 4
+
+/* Single precision. */
+void oskar_dft_c2r_2d_separable_columns_f(const int num_in,
+        const float wavenumber, const float* x_in, const int num_x,
+        const float* x_out, float* col_re, float* col_im)
+{
+    int i;
+#pragma omp parallel for private(i)
+    for (i = 0; i < num_in; ++i)
+    {
+        int ix;
+        float* restrict cr = col_re + (size_t) i * num_x;
+        float* restrict ci = col_im + (size_t) i * num_x;
+        const float xp = -wavenumber * x_in[i];
+        for (ix = 0; ix < num_x; ++ix)
+        {
+            const float a = xp * x_out[ix];
+            cr[ix] = cosf(a);
+            ci[ix] = sinf(a);
+        }
+    }
+}
+
+void oskar_dft_c2r_2d_separable_omp_f(const int num_in,
+        const float wavenumber, const float* y_in, const float2* data_in,
+        const float* weight_in, const int num_x, const float* col_re,
+        const float* col_im, const int num_y, const float* y_out,
+        float* output, int* status)
+{
+    int failed = 0;
+    if (*status) return;
+#pragma omp parallel
+    {
+        int i0, x0, y, num_groups, y_start = 0, y_end = num_y;
+        size_t num_row_factors;
+        float *row_re, *row_im, *dummy;
+#ifdef _OPENMP
+        const int thread_id = omp_get_thread_num();
+        const int num_threads = omp_get_num_threads();
+        y_start = (int) (((long) num_y * thread_id) / num_threads);
+        y_end = (int) (((long) num_y * (thread_id + 1)) / num_threads);
+#endif
+        num_groups = (y_end - y_start + ROWS - 1) / ROWS;
+        if (num_groups < 1) num_groups = 1;
+        num_row_factors = (size_t) num_groups * ROWS * BLOCK_IN;
+
+        /* Row factors (which include the weighted input data) are indexed
+         * [row][input] for all the rows of this thread, padded to a whole
+         * number of groups. Padding rows accumulate into dummy rows. */
+        row_re = (float*) malloc(num_row_factors * sizeof(float));
+        row_im = (float*) malloc(num_row_factors * sizeof(float));
+        dummy  = (float*) malloc(ROWS * BLOCK_X * sizeof(float));
+        if (!row_re || !row_im || !dummy)
+        {
+#pragma omp atomic
+            failed++;
+        }
+#pragma omp barrier
+
+        /* Clear the output rows. */
+        if (!failed)
+            for (y = y_start; y < y_end; ++y)
+                memset(output + (size_t) y * num_x, 0, num_x * sizeof(float));
+
+        for (i0 = 0; i0 < num_in && !failed; i0 += BLOCK_IN)
+        {
+            int k, r;
+            const int ni = (num_in - i0 < BLOCK_IN) ? num_in - i0 : BLOCK_IN;
+
+            /* Multiply the weighted input data by the row factors.
+             * These do not depend on x, so are shared by all the column
+             * blocks. */
+            for (r = 0; r < num_groups * ROWS; ++r)
+            {
+                float* restrict br = row_re + r * BLOCK_IN;
+                float* restrict bi = row_im + r * BLOCK_IN;
+                if (y_start + r >= y_end)
+                {
+                    for (k = 0; k < ni; ++k) br[k] = bi[k] = 0.0f;
+                    continue;
+                }
+                for (k = 0; k < ni; ++k)
+                {
+                    const int i = i0 + k;
+                    const float a =
+                            -y_in[i] * (wavenumber * y_out[y_start + r]);
+                    const float c = cosf(a), s = sinf(a);
+                    const float re = data_in[i].x * weight_in[i];
+                    const float im = data_in[i].y * weight_in[i];
+                    br[k] = re * c - im * s;
+                    bi[k] = re * s + im * c;
+                }
+            }
+
+            for (x0 = 0; x0 < num_x; x0 += BLOCK_X)
+            {
+                int ix, g;
+                const int nx = (num_x - x0 < BLOCK_X) ? num_x - x0 : BLOCK_X;
+
+                /* Loop over groups of output rows. */
+                for (g = 0; g < num_groups; ++g)
+                {
+                    float* restrict out[ROWS];
+                    const float* restrict gr = row_re + g * ROWS * BLOCK_IN;
+                    const float* restrict gi = row_im + g * ROWS * BLOCK_IN;
+                    y = y_start + g * ROWS;
+                    for (r = 0; r < ROWS; ++r)
+                        out[r] = (y + r >= y_end) ? dummy + r * BLOCK_X :
+                                output + (size_t) (y + r) * num_x + x0;
+
+                    /* Perform complex multiply-accumulate, using the
+                     * column factors for this block of inputs and columns.
+                     * Output is real, so only evaluate the real part. */
+                    for (k = 0; k < ni; ++k)
+                    {
+                        const size_t col = (size_t) (i0 + k) * num_x + x0;
+                        const float* restrict cr = col_re + col;
+                        const float* restrict ci = col_im + col;
+                        const float br0 = gr[k], bi0 = gi[k];
+                        const float br1 = gr[k + BLOCK_IN];
+                        const float bi1 = gi[k + BLOCK_IN];
+                        const float br2 = gr[k + 2 * BLOCK_IN];
+                        const float bi2 = gi[k + 2 * BLOCK_IN];
+                        const float br3 = gr[k + 3 * BLOCK_IN];
+                        const float bi3 = gi[k + 3 * BLOCK_IN];
+                        float* restrict out0 = out[0];
+                        float* restrict out1 = out[1];
+                        float* restrict out2 = out[2];
+                        float* restrict out3 = out[3];
+                        for (ix = 0; ix < nx; ++ix)
+                        {
+                            out0[ix] += br0 * cr[ix] - bi0 * ci[ix];
+                            out1[ix] += br1 * cr[ix] - bi1 * ci[ix];
+                            out2[ix] += br2 * cr[ix] - bi2 * ci[ix];
+                            out3[ix] += br3 * cr[ix] - bi3 * ci[ix];
+                        }
+                    }
+                }
+            }
+        }
+        free(row_re);
+        free(row_im);
+        free(dummy);
+    }
+    if (failed) *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+}
+
+/* Double precision. */
+void oskar_dft_c2r_2d_separable_columns_d(const int num_in,
+        const double wavenumber, const double* x_in, const int num_x,
+        const double* x_out, double* col_re, double* col_im)
+{
+    int i;
+#pragma omp parallel for private(i)
+    for (i = 0; i < num_in; ++i)
+    {
+        int ix;
+        double* restrict cr = col_re + (size_t) i * num_x;
+        double* restrict ci = col_im + (size_t) i * num_x;
+        const double xp = -wavenumber * x_in[i];
+        for (ix = 0; ix < num_x; ++ix)
+        {
+            const double a = xp * x_out[ix];
+            cr[ix] = cos(a);
+            ci[ix] = sin(a);
+        }
+    }
+}
+
+void oskar_dft_c2r_2d_separable_omp_d(const int num_in,
+        const double wavenumber, const double* y_in, const double2* data_in,
+        const double* weight_in, const int num_x, const double* col_re,
+        const double* col_im, const int num_y, const double* y_out,
+        double* output, int* status)
+{
+    int failed = 0;
+    if (*status) return;
+#pragma omp parallel
+    {
+        int i0, x0, y, num_groups, y_start = 0, y_end = num_y;
+        size_t num_row_factors;
+        double *row_re, *row_im, *dummy;
+#ifdef _OPENMP
+        const int thread_id = omp_get_thread_num();
+        const int num_threads = omp_get_num_threads();
+        y_start = (int) (((long) num_y * thread_id) / num_threads);
+        y_end = (int) (((long) num_y * (thread_id + 1)) / num_threads);
+#endif
+        num_groups = (y_end - y_start + ROWS - 1) / ROWS;
+        if (num_groups < 1) num_groups = 1;
+        num_row_factors = (size_t) num_groups * ROWS * BLOCK_IN;
+
+        /* Row factors (which include the weighted input data) are indexed
+         * [row][input] for all the rows of this thread, padded to a whole
+         * number of groups. Padding rows accumulate into dummy rows. */
+        row_re = (double*) malloc(num_row_factors * sizeof(double));
+        row_im = (double*) malloc(num_row_factors * sizeof(double));
+        dummy  = (double*) malloc(ROWS * BLOCK_X * sizeof(double));
+        if (!row_re || !row_im || !dummy)
+        {
+#pragma omp atomic
+            failed++;
+        }
+#pragma omp barrier
+
+        /* Clear the output rows. */
+        if (!failed)
+            for (y = y_start; y < y_end; ++y)
+                memset(output + (size_t) y * num_x, 0, num_x * sizeof(double));
+
+        for (i0 = 0; i0 < num_in && !failed; i0 += BLOCK_IN)
+        {
+            int k, r;
+            const int ni = (num_in - i0 < BLOCK_IN) ? num_in - i0 : BLOCK_IN;
+
+            /* Multiply the weighted input data by the row factors.
+             * These do not depend on x, so are shared by all the column
+             * blocks. */
+            for (r = 0; r < num_groups * ROWS; ++r)
+            {
+                double* restrict br = row_re + r * BLOCK_IN;
+                double* restrict bi = row_im + r * BLOCK_IN;
+                if (y_start + r >= y_end)
+                {
+                    for (k = 0; k < ni; ++k) br[k] = bi[k] = 0.0;
+                    continue;
+                }
+                for (k = 0; k < ni; ++k)
+                {
+                    const int i = i0 + k;
+                    const double a =
+                            -y_in[i] * (wavenumber * y_out[y_start + r]);
+                    const double c = cos(a), s = sin(a);
+                    const double re = data_in[i].x * weight_in[i];
+                    const double im = data_in[i].y * weight_in[i];
+                    br[k] = re * c - im * s;
+                    bi[k] = re * s + im * c;
+                }
+            }
+
+            for (x0 = 0; x0 < num_x; x0 += BLOCK_X)
+            {
+                int ix, g;
+                const int nx = (num_x - x0 < BLOCK_X) ? num_x - x0 : BLOCK_X;
+
+                /* Loop over groups of output rows. */
+                for (g = 0; g < num_groups; ++g)
+                {
+                    double* restrict out[ROWS];
+                    const double* restrict gr = row_re + g * ROWS * BLOCK_IN;
+                    const double* restrict gi = row_im + g * ROWS * BLOCK_IN;
+                    y = y_start + g * ROWS;
+                    for (r = 0; r < ROWS; ++r)
+                        out[r] = (y + r >= y_end) ? dummy + r * BLOCK_X :
+                                output + (size_t) (y + r) * num_x + x0;
+
+                    /* Perform complex multiply-accumulate, using the
+                     * column factors for this block of inputs and columns.
+                     * Output is real, so only evaluate the real part. */
+                    for (k = 0; k < ni; ++k)
+                    {
+                        const size_t col = (size_t) (i0 + k) * num_x + x0;
+                        const double* restrict cr = col_re + col;
+                        const double* restrict ci = col_im + col;
+                        const double br0 = gr[k], bi0 = gi[k];
+                        const double br1 = gr[k + BLOCK_IN];
+                        const double bi1 = gi[k + BLOCK_IN];
+                        const double br2 = gr[k + 2 * BLOCK_IN];
+                        const double bi2 = gi[k + 2 * BLOCK_IN];
+                        const double br3 = gr[k + 3 * BLOCK_IN];
+                        const double bi3 = gi[k + 3 * BLOCK_IN];
+                        double* restrict out0 = out[0];
+                        double* restrict out1 = out[1];
+                        double* restrict out2 = out[2];
+                        double* restrict out3 = out[3];
+                        for (ix = 0; ix < nx; ++ix)
+                        {
+                            out0[ix] += br0 * cr[ix] - bi0 * ci[ix];
+                            out1[ix] += br1 * cr[ix] - bi1 * ci[ix];
+                            out2[ix] += br2 * cr[ix] - bi2 * ci[ix];
+                            out3[ix] += br3 * cr[ix] - bi3 * ci[ix];
+                        }
+                    }
+                }
+            }
+        }
+        free(row_re);
+        free(row_im);
+        free(dummy);
+    }
+    if (failed) *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013, The University of Oxford
+ * Copyright (c) 2013-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,12 +27,15 @@
  */
 
 #include "math/oskar_dftw_c2c_3d_omp.h"
+#include "math/oskar_sincos_inline.h"
 #include <math.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#define BLOCK_SIZE 64
+
 /* Single precision. */
 void oskar_dftw_c2c_3d_omp_f(const int n_in, const float wavenumber,
         const float* x_in, const float* y_in, const float* z_in,
@@ -40,54 +43,89 @@ void oskar_dftw_c2c_3d_omp_f(const int n_in, const float wavenumber,
         const float* y_out, const float* z_out, const float2* data,
         float2* output)
 {
-    int i_out = 0;
+    int i_in = 0, i_out = 0;
+    float max_in = 0.0f;
 
-    /* Loop over output points. */
-    #pragma omp parallel for private(i_out)
-    for (i_out = 0; i_out < n_out; ++i_out)
+    /* Find the largest input coordinate, to check the phase range. */
+    for (i_in = 0; i_in < n_in; ++i_in)
     {
-        int i;
-        float xp_out, yp_out, zp_out;
-        float2 out;
+        const float r = fabsf(x_in[i_in]) + fabsf(y_in[i_in]) +
+                fabsf(z_in[i_in]);
+        if (r > max_in) max_in = r;
+    }
 
-        /* Clear output value. */
-        out.x = 0.0f;
-        out.y = 0.0f;
+    /* Loop over blocks of output points. */
+    #pragma omp parallel for private(i_out)
+    for (i_out = 0; i_out < n_out; i_out += BLOCK_SIZE)
+    {
+        int i, j, n, fast;
+        float max_out = 0.0f;
+        float xp[BLOCK_SIZE], yp[BLOCK_SIZE], zp[BLOCK_SIZE];
+        float s[BLOCK_SIZE], c[BLOCK_SIZE];
+        float re[BLOCK_SIZE], im[BLOCK_SIZE];
+
+        /* Get the output positions and clear the output values. */
+        n = n_out - i_out;
+        if (n > BLOCK_SIZE) n = BLOCK_SIZE;
+        for (j = 0; j < n; ++j)
+        {
+            xp[j] = wavenumber * x_out[i_out + j];
+            yp[j] = wavenumber * y_out[i_out + j];
+            zp[j] = wavenumber * z_out[i_out + j];
+            if (fabsf(xp[j]) > max_out) max_out = fabsf(xp[j]);
+            if (fabsf(yp[j]) > max_out) max_out = fabsf(yp[j]);
+            if (fabsf(zp[j]) > max_out) max_out = fabsf(zp[j]);
+            re[j] = 0.0f;
+            im[j] = 0.0f;
+        }
 
-        /* Get the output position. */
-        xp_out = wavenumber * x_out[i_out];
-        yp_out = wavenumber * y_out[i_out];
-        zp_out = wavenumber * z_out[i_out];
+        /* Use the vectorisable sincos only if the phase is in range. */
+        fast = (max_in * max_out < 1e5f);
 
         /* Loop over input points. */
         for (i = 0; i < n_in; ++i)
         {
-            float2 temp, w;
-            float a;
-
-            /* Calculate the phase for the output position. */
-            a = xp_out * x_in[i] + yp_out * y_in[i] + zp_out * z_in[i];
-            temp.x = cosf(a);
-            temp.y = sinf(a);
-
-            /* Multiply the supplied DFT weight by the computed phase. */
-            w = weights_in[i];
-            a = w.x;
-            w.x *= temp.x;
-            w.x -= w.y * temp.y;
-            w.y *= temp.x;
-            w.y += a * temp.y;
-
-            /* Perform complex multiply-accumulate. */
-            temp = data[i * n_out + i_out];
-            out.x += w.x * temp.x;
-            out.x -= w.y * temp.y;
-            out.y += w.y * temp.x;
-            out.y += w.x * temp.y;
+            const float xi = x_in[i], yi = y_in[i];
+            const float zi = z_in[i];
+            const float2 w = weights_in[i];
+            const float2* in = &data[i * n_out + i_out];
+
+            /* Calculate the phase for each output position. */
+            if (fast)
+            {
+                for (j = 0; j < n; ++j)
+                    oskar_sincos_inline_f(xp[j] * xi + yp[j] * yi + zp[j] * zi,
+                            &s[j], &c[j]);
+            }
+            else
+            {
+                for (j = 0; j < n; ++j)
+                {
+                    const float t = xp[j] * xi + yp[j] * yi + zp[j] * zi;
+                    s[j] = sinf(t);
+                    c[j] = cosf(t);
+                }
+            }
+
+            /* Multiply the supplied DFT weight by the computed phase,
+             * and perform complex multiply-accumulate. */
+            for (j = 0; j < n; ++j)
+            {
+                const float wx = c[j] * w.x - s[j] * w.y;
+                const float wy = c[j] * w.y + s[j] * w.x;
+                re[j] += wx * in[j].x;
+                re[j] -= wy * in[j].y;
+                im[j] += wy * in[j].x;
+                im[j] += wx * in[j].y;
+            }
         }
 
-        /* Store the output point. */
-        output[i_out] = out;
+        /* Store the output points. */
+        for (j = 0; j < n; ++j)
+        {
+            output[i_out + j].x = re[j];
+            output[i_out + j].y = im[j];
+        }
     }
 }
 
@@ -98,54 +136,89 @@ void oskar_dftw_c2c_3d_omp_d(const int n_in, const double wavenumber,
         const double* y_out, const double* z_out, const double2* data,
         double2* output)
 {
-    int i_out = 0;
+    int i_in = 0, i_out = 0;
+    double max_in = 0.0;
 
-    /* Loop over output points. */
-    #pragma omp parallel for private(i_out)
-    for (i_out = 0; i_out < n_out; ++i_out)
+    /* Find the largest input coordinate, to check the phase range. */
+    for (i_in = 0; i_in < n_in; ++i_in)
     {
-        int i;
-        double xp_out, yp_out, zp_out;
-        double2 out;
+        const double r = fabs(x_in[i_in]) + fabs(y_in[i_in]) +
+                fabs(z_in[i_in]);
+        if (r > max_in) max_in = r;
+    }
 
-        /* Clear output value. */
-        out.x = 0.0;
-        out.y = 0.0;
+    /* Loop over blocks of output points. */
+    #pragma omp parallel for private(i_out)
+    for (i_out = 0; i_out < n_out; i_out += BLOCK_SIZE)
+    {
+        int i, j, n, fast;
+        double max_out = 0.0;
+        double xp[BLOCK_SIZE], yp[BLOCK_SIZE], zp[BLOCK_SIZE];
+        double s[BLOCK_SIZE], c[BLOCK_SIZE];
+        double re[BLOCK_SIZE], im[BLOCK_SIZE];
+
+        /* Get the output positions and clear the output values. */
+        n = n_out - i_out;
+        if (n > BLOCK_SIZE) n = BLOCK_SIZE;
+        for (j = 0; j < n; ++j)
+        {
+            xp[j] = wavenumber * x_out[i_out + j];
+            yp[j] = wavenumber * y_out[i_out + j];
+            zp[j] = wavenumber * z_out[i_out + j];
+            if (fabs(xp[j]) > max_out) max_out = fabs(xp[j]);
+            if (fabs(yp[j]) > max_out) max_out = fabs(yp[j]);
+            if (fabs(zp[j]) > max_out) max_out = fabs(zp[j]);
+            re[j] = 0.0;
+            im[j] = 0.0;
+        }
 
-        /* Get the output position. */
-        xp_out = wavenumber * x_out[i_out];
-        yp_out = wavenumber * y_out[i_out];
-        zp_out = wavenumber * z_out[i_out];
+        /* Use the vectorisable sincos only if the phase is in range. */
+        fast = (max_in * max_out < 1e6);
 
         /* Loop over input points. */
         for (i = 0; i < n_in; ++i)
         {
-            double2 temp, w;
-            double a;
-
-            /* Calculate the phase for the output position. */
-            a = xp_out * x_in[i] + yp_out * y_in[i] + zp_out * z_in[i];
-            temp.x = cos(a);
-            temp.y = sin(a);
-
-            /* Multiply the supplied DFT weight by the computed phase. */
-            w = weights_in[i];
-            a = w.x;
-            w.x *= temp.x;
-            w.x -= w.y * temp.y;
-            w.y *= temp.x;
-            w.y += a * temp.y;
-
-            /* Perform complex multiply-accumulate. */
-            temp = data[i * n_out + i_out];
-            out.x += w.x * temp.x;
-            out.x -= w.y * temp.y;
-            out.y += w.y * temp.x;
-            out.y += w.x * temp.y;
+            const double xi = x_in[i], yi = y_in[i];
+            const double zi = z_in[i];
+            const double2 w = weights_in[i];
+            const double2* in = &data[i * n_out + i_out];
+
+            /* Calculate the phase for each output position. */
+            if (fast)
+            {
+                for (j = 0; j < n; ++j)
+                    oskar_sincos_inline_d(xp[j] * xi + yp[j] * yi + zp[j] * zi,
+                            &s[j], &c[j]);
+            }
+            else
+            {
+                for (j = 0; j < n; ++j)
+                {
+                    const double t = xp[j] * xi + yp[j] * yi + zp[j] * zi;
+                    s[j] = sin(t);
+                    c[j] = cos(t);
+                }
+            }
+
+            /* Multiply the supplied DFT weight by the computed phase,
+             * and perform complex multiply-accumulate. */
+            for (j = 0; j < n; ++j)
+            {
+                const double wx = c[j] * w.x - s[j] * w.y;
+                const double wy = c[j] * w.y + s[j] * w.x;
+                re[j] += wx * in[j].x;
+                re[j] -= wy * in[j].y;
+                im[j] += wy * in[j].x;
+                im[j] += wx * in[j].y;
+            }
         }
 
-        /* Store the output point. */
-        output[i_out] = out;
+        /* Store the output points. */
+        for (j = 0; j < n; ++j)
+        {
+            output[i_out + j].x = re[j];
+            output[i_out + j].y = im[j];
+        }
     }
 }
 
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "math/oskar_dftw_indexed_input.h"
+#include "math/oskar_dftw_c2c_3d_indexed_input_omp.h"
+#include "math/oskar_dftw_m2m_3d_indexed_input_omp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_dftw_indexed_input(
+        int num_in,
+        double wavenumber,
+        const oskar_Mem* x_in,
+        const oskar_Mem* y_in,
+        const oskar_Mem* z_in,
+        const oskar_Mem* weights_in,
+        const oskar_Mem* index_in,
+        int num_out,
+        const oskar_Mem* x_out,
+        const oskar_Mem* y_out,
+        const oskar_Mem* z_out,
+        const oskar_Mem* data,
+        oskar_Mem* output,
+        int* status)
+{
+    int location, type, is_dbl, is_matrix;
+    if (*status) return;
+
+    /* Find out what we have. */
+    location = oskar_mem_location(output);
+    type = oskar_mem_precision(output);
+    is_dbl = type & OSKAR_DOUBLE;
+    is_matrix = oskar_mem_is_matrix(output);
+    if (!oskar_mem_is_complex(output) || !oskar_mem_is_complex(weights_in) ||
+            oskar_mem_is_matrix(weights_in) ||
+            oskar_mem_type(index_in) != OSKAR_INT)
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+
+    /* Check type and location consistency. */
+    if (oskar_mem_location(weights_in) != location ||
+            oskar_mem_location(index_in) != location ||
+            oskar_mem_location(x_in) != location ||
+            oskar_mem_location(y_in) != location ||
+            oskar_mem_location(z_in) != location ||
+            oskar_mem_location(x_out) != location ||
+            oskar_mem_location(y_out) != location ||
+            oskar_mem_location(z_out) != location ||
+            oskar_mem_location(data) != location)
+    {
+        *status = OSKAR_ERR_LOCATION_MISMATCH;
+        return;
+    }
+    if (oskar_mem_precision(weights_in) != type ||
+            oskar_mem_type(x_in) != type ||
+            oskar_mem_type(y_in) != type ||
+            oskar_mem_type(z_in) != type ||
+            oskar_mem_type(x_out) != type ||
+            oskar_mem_type(y_out) != type ||
+            oskar_mem_type(z_out) != type ||
+            oskar_mem_type(data) != oskar_mem_type(output))
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if ((int)oskar_mem_length(index_in) < num_in)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+
+    /* Resize output array if needed. */
+    if ((int)oskar_mem_length(output) < num_out)
+        oskar_mem_realloc(output, (size_t) num_out, status);
+    if (*status) return;
+
+    /* Switch on location. */
+    if (location == OSKAR_CPU)
+    {
+        if (is_matrix)
+        {
+            if (is_dbl)
+                oskar_dftw_m2m_3d_indexed_input_omp_d(num_in, wavenumber,
+                        oskar_mem_double_const(x_in, status),
+                        oskar_mem_double_const(y_in, status),
+                        oskar_mem_double_const(z_in, status),
+                        oskar_mem_double2_const(weights_in, status),
+                        num_out, oskar_mem_double_const(x_out, status),
+                        oskar_mem_double_const(y_out, status),
+                        oskar_mem_double_const(z_out, status),
+                        oskar_mem_int_const(index_in, status),
+                        oskar_mem_double4c_const(data, status),
+                        oskar_mem_double4c(output, status));
+            else
+                oskar_dftw_m2m_3d_indexed_input_omp_f(num_in, wavenumber,
+                        oskar_mem_float_const(x_in, status),
+                        oskar_mem_float_const(y_in, status),
+                        oskar_mem_float_const(z_in, status),
+                        oskar_mem_float2_const(weights_in, status),
+                        num_out, oskar_mem_float_const(x_out, status),
+                        oskar_mem_float_const(y_out, status),
+                        oskar_mem_float_const(z_out, status),
+                        oskar_mem_int_const(index_in, status),
+                        oskar_mem_float4c_const(data, status),
+                        oskar_mem_float4c(output, status));
+        }
+        else
+        {
+            if (is_dbl)
+                oskar_dftw_c2c_3d_indexed_input_omp_d(num_in, wavenumber,
+                        oskar_mem_double_const(x_in, status),
+                        oskar_mem_double_const(y_in, status),
+                        oskar_mem_double_const(z_in, status),
+                        oskar_mem_double2_const(weights_in, status),
+                        num_out, oskar_mem_double_const(x_out, status),
+                        oskar_mem_double_const(y_out, status),
+                        oskar_mem_double_const(z_out, status),
+                        oskar_mem_int_const(index_in, status),
+                        oskar_mem_double2_const(data, status),
+                        oskar_mem_double2(output, status));
+            else
+                oskar_dftw_c2c_3d_indexed_input_omp_f(num_in, wavenumber,
+                        oskar_mem_float_const(x_in, status),
+                        oskar_mem_float_const(y_in, status),
+                        oskar_mem_float_const(z_in, status),
+                        oskar_mem_float2_const(weights_in, status),
+                        num_out, oskar_mem_float_const(x_out, status),
+                        oskar_mem_float_const(y_out, status),
+                        oskar_mem_float_const(z_out, status),
+                        oskar_mem_int_const(index_in, status),
+                        oskar_mem_float2_const(data, status),
+                        oskar_mem_float2(output, status));
+        }
+    }
+    else
+    {
+        *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "math/oskar_dftw_m2m_3d_indexed_input_omp.h"
+#include "math/oskar_sincos_inline.h"
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BLOCK_SIZE 64
+
+/* Single precision. */
+void oskar_dftw_m2m_3d_indexed_input_omp_f(const int n_in,
+        const float wavenumber, const float* x_in, const float* y_in,
+        const float* z_in, const float2* weights_in, const int n_out,
+        const float* x_out, const float* y_out, const float* z_out,
+        const int* index_in, const float4c* data, float4c* output)
+{
+    int i_in = 0, i_out = 0;
+    float max_in = 0.0f;
+
+    /* Find the largest input coordinate, to check the phase range. */
+    for (i_in = 0; i_in < n_in; ++i_in)
+    {
+        const float r = fabsf(x_in[i_in]) + fabsf(y_in[i_in]) +
+                fabsf(z_in[i_in]);
+        if (r > max_in) max_in = r;
+    }
+
+    /* Loop over blocks of output points. */
+    #pragma omp parallel for private(i_out)
+    for (i_out = 0; i_out < n_out; i_out += BLOCK_SIZE)
+    {
+        int i, j, n, fast;
+        float max_out = 0.0f;
+        float xp[BLOCK_SIZE], yp[BLOCK_SIZE], zp[BLOCK_SIZE];
+        float s[BLOCK_SIZE], c[BLOCK_SIZE];
+        float a_re[BLOCK_SIZE], a_im[BLOCK_SIZE], b_re[BLOCK_SIZE];
+        float b_im[BLOCK_SIZE], c_re[BLOCK_SIZE], c_im[BLOCK_SIZE];
+        float d_re[BLOCK_SIZE], d_im[BLOCK_SIZE];
+
+        /* Get the output positions and clear the output values. */
+        n = n_out - i_out;
+        if (n > BLOCK_SIZE) n = BLOCK_SIZE;
+        for (j = 0; j < n; ++j)
+        {
+            xp[j] = wavenumber * x_out[i_out + j];
+            yp[j] = wavenumber * y_out[i_out + j];
+            zp[j] = wavenumber * z_out[i_out + j];
+            if (fabsf(xp[j]) > max_out) max_out = fabsf(xp[j]);
+            if (fabsf(yp[j]) > max_out) max_out = fabsf(yp[j]);
+            if (fabsf(zp[j]) > max_out) max_out = fabsf(zp[j]);
+            a_re[j] = 0.0f;
+            a_im[j] = 0.0f;
+            b_re[j] = 0.0f;
+            b_im[j] = 0.0f;
+            c_re[j] = 0.0f;
+            c_im[j] = 0.0f;
+            d_re[j] = 0.0f;
+            d_im[j] = 0.0f;
+        }
+
+        /* Use the vectorisable sincos only if the phase is in range. */
+        fast = (max_in * max_out < 1e5f);
+
+        /* Loop over input points. */
+        for (i = 0; i < n_in; ++i)
+        {
+            const float xi = x_in[i], yi = y_in[i];
+            const float zi = z_in[i];
+            const float2 w = weights_in[i];
+            const float4c* in = &data[index_in[i] * n_out + i_out];
+
+            /* Calculate the phase for each output position. */
+            if (fast)
+            {
+                for (j = 0; j < n; ++j)
+                    oskar_sincos_inline_f(xp[j] * xi + yp[j] * yi + zp[j] * zi,
+                            &s[j], &c[j]);
+            }
+            else
+            {
+                for (j = 0; j < n; ++j)
+                {
+                    const float t = xp[j] * xi + yp[j] * yi + zp[j] * zi;
+                    s[j] = sinf(t);
+                    c[j] = cosf(t);
+                }
+            }
+
+            /* Multiply the supplied DFT weight by the computed phase,
+             * and perform complex multiply-accumulate. */
+            for (j = 0; j < n; ++j)
+            {
+                const float wx = c[j] * w.x - s[j] * w.y;
+                const float wy = c[j] * w.y + s[j] * w.x;
+                a_re[j] += in[j].a.x * wx;
+                a_re[j] -= in[j].a.y * wy;
+                a_im[j] += in[j].a.y * wx;
+                a_im[j] += in[j].a.x * wy;
+                b_re[j] += in[j].b.x * wx;
+                b_re[j] -= in[j].b.y * wy;
+                b_im[j] += in[j].b.y * wx;
+                b_im[j] += in[j].b.x * wy;
+                c_re[j] += in[j].c.x * wx;
+                c_re[j] -= in[j].c.y * wy;
+                c_im[j] += in[j].c.y * wx;
+                c_im[j] += in[j].c.x * wy;
+                d_re[j] += in[j].d.x * wx;
+                d_re[j] -= in[j].d.y * wy;
+                d_im[j] += in[j].d.y * wx;
+                d_im[j] += in[j].d.x * wy;
+            }
+        }
+
+        /* Store the output points. */
+        for (j = 0; j < n; ++j)
+        {
+            output[i_out + j].a.x = a_re[j];
+            output[i_out + j].a.y = a_im[j];
+            output[i_out + j].b.x = b_re[j];
+            output[i_out + j].b.y = b_im[j];
+            output[i_out + j].c.x = c_re[j];
+            output[i_out + j].c.y = c_im[j];
+            output[i_out + j].d.x = d_re[j];
+            output[i_out + j].d.y = d_im[j];
+        }
+    }
+}
+
+/* Double precision. */
+void oskar_dftw_m2m_3d_indexed_input_omp_d(const int n_in,
+        const double wavenumber, const double* x_in, const double* y_in,
+        const double* z_in, const double2* weights_in, const int n_out,
+        const double* x_out, const double* y_out, const double* z_out,
+        const int* index_in, const double4c* data, double4c* output)
+{
+    int i_in = 0, i_out = 0;
+    double max_in = 0.0;
+
+    /* Find the largest input coordinate, to check the phase range. */
+    for (i_in = 0; i_in < n_in; ++i_in)
+    {
+        const double r = fabs(x_in[i_in]) + fabs(y_in[i_in]) +
+                fabs(z_in[i_in]);
+        if (r > max_in) max_in = r;
+    }
+
+    /* Loop over blocks of output points. */
+    #pragma omp parallel for private(i_out)
+    for (i_out = 0; i_out < n_out; i_out += BLOCK_SIZE)
+    {
+        int i, j, n, fast;
+        double max_out = 0.0;
+        double xp[BLOCK_SIZE], yp[BLOCK_SIZE], zp[BLOCK_SIZE];
+        double s[BLOCK_SIZE], c[BLOCK_SIZE];
+        double a_re[BLOCK_SIZE], a_im[BLOCK_SIZE], b_re[BLOCK_SIZE];
+        double b_im[BLOCK_SIZE], c_re[BLOCK_SIZE], c_im[BLOCK_SIZE];
+        double d_re[BLOCK_SIZE], d_im[BLOCK_SIZE];
+
+        /* Get the output positions and clear the output values. */
+        n = n_out - i_out;
+        if (n > BLOCK_SIZE) n = BLOCK_SIZE;
+        for (j = 0; j < n; ++j)
+        {
+            xp[j] = wavenumber * x_out[i_out + j];
+            yp[j] = wavenumber * y_out[i_out + j];
+            zp[j] = wavenumber * z_out[i_out + j];
+            if (fabs(xp[j]) > max_out) max_out = fabs(xp[j]);
+            if (fabs(yp[j]) > max_out) max_out = fabs(yp[j]);
+            if (fabs(zp[j]) > max_out) max_out = fabs(zp[j]);
+            a_re[j] = 0.0;
+            a_im[j] = 0.0;
+            b_re[j] = 0.0;
+            b_im[j] = 0.0;
+            c_re[j] = 0.0;
+            c_im[j] = 0.0;
+            d_re[j] = 0.0;
+            d_im[j] = 0.0;
+        }
+
+        /* Use the vectorisable sincos only if the phase is in range. */
+        fast = (max_in * max_out < 1e6);
+
+        /* Loop over input points. */
+        for (i = 0; i < n_in; ++i)
+        {
+            const double xi = x_in[i], yi = y_in[i];
+            const double zi = z_in[i];
+            const double2 w = weights_in[i];
+            const double4c* in = &data[index_in[i] * n_out + i_out];
+
+            /* Calculate the phase for each output position. */
+            if (fast)
+            {
+                for (j = 0; j < n; ++j)
+                    oskar_sincos_inline_d(xp[j] * xi + yp[j] * yi + zp[j] * zi,
+                            &s[j], &c[j]);
+            }
+            else
+            {
+                for (j = 0; j < n; ++j)
+                {
+                    const double t = xp[j] * xi + yp[j] * yi + zp[j] * zi;
+                    s[j] = sin(t);
+                    c[j] = cos(t);
+                }
+            }
+
+            /* Multiply the supplied DFT weight by the computed phase,
+             * and perform complex multiply-accumulate. */
+            for (j = 0; j < n; ++j)
+            {
+                const double wx = c[j] * w.x - s[j] * w.y;
+                const double wy = c[j] * w.y + s[j] * w.x;
+                a_re[j] += in[j].a.x * wx;
+                a_re[j] -= in[j].a.y * wy;
+                a_im[j] += in[j].a.y * wx;
+                a_im[j] += in[j].a.x * wy;
+                b_re[j] += in[j].b.x * wx;
+                b_re[j] -= in[j].b.y * wy;
+                b_im[j] += in[j].b.y * wx;
+                b_im[j] += in[j].b.x * wy;
+                c_re[j] += in[j].c.x * wx;
+                c_re[j] -= in[j].c.y * wy;
+                c_im[j] += in[j].c.y * wx;
+                c_im[j] += in[j].c.x * wy;
+                d_re[j] += in[j].d.x * wx;
+                d_re[j] -= in[j].d.y * wy;
+                d_im[j] += in[j].d.y * wx;
+                d_im[j] += in[j].d.x * wy;
+            }
+        }
+
+        /* Store the output points. */
+        for (j = 0; j < n; ++j)
+        {
+            output[i_out + j].a.x = a_re[j];
+            output[i_out + j].a.y = a_im[j];
+            output[i_out + j].b.x = b_re[j];
+            output[i_out + j].b.y = b_im[j];
+            output[i_out + j].c.x = c_re[j];
+            output[i_out + j].c.y = c_im[j];
+            output[i_out + j].d.x = d_re[j];
+            output[i_out + j].d.y = d_im[j];
+        }
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "math/oskar_dftw_nufft.h"
+#include "math/oskar_dftw.h"
+#include "math/oskar_nufft_type3.h"
+#include "math/oskar_cmath.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Finds the range of the finite values in an array,
+ * and returns the number of non-finite values. */
+static int range(int n, const double* a, double* min_val, double* max_val)
+{
+    int i, num_bad = 0, found = 0;
+    *min_val = *max_val = 0.0;
+    for (i = 0; i < n; ++i)
+    {
+        if (!(a[i] - a[i] == 0.0))
+        {
+            num_bad++;
+            continue;
+        }
+        if (!found || a[i] < *min_val) *min_val = a[i];
+        if (!found || a[i] > *max_val) *max_val = a[i];
+        found = 1;
+    }
+    return num_bad;
+}
+
+void oskar_dftw_nufft(
+        int num_in,
+        double wavenumber,
+        const oskar_Mem* x_in,
+        const oskar_Mem* y_in,
+        const oskar_Mem* z_in,
+        const oskar_Mem* weights_in,
+        int num_out,
+        const oskar_Mem* x_out,
+        const oskar_Mem* y_out,
+        const oskar_Mem* z_out,
+        double tolerance,
+        oskar_Mem* output,
+        int* status)
+{
+    int i, type, is_3d, num_bad;
+    double x_min, x_max, y_min, y_max, u_min, u_max, v_min, v_max;
+    double z_min = 0.0, z_max = 0.0, *u, *v, *out;
+    oskar_Mem *x_d, *y_d, *z_d = 0, *w_d, *u_d, *v_d, *out_d;
+    if (*status) return;
+
+    /* Use the DFT for anything the NUFFT doesn't handle. */
+    type = oskar_mem_precision(output);
+    is_3d = (z_in != NULL && z_out != NULL);
+    if (tolerance <= 0.0 || num_in <= 0 || num_out <= 0 ||
+            oskar_mem_location(output) != OSKAR_CPU ||
+            oskar_mem_location(weights_in) != OSKAR_CPU ||
+            oskar_mem_location(x_in) != OSKAR_CPU ||
+            oskar_mem_location(y_in) != OSKAR_CPU ||
+            oskar_mem_location(x_out) != OSKAR_CPU ||
+            oskar_mem_location(y_out) != OSKAR_CPU ||
+            (is_3d && (oskar_mem_location(z_in) != OSKAR_CPU ||
+                    oskar_mem_location(z_out) != OSKAR_CPU ||
+                    oskar_mem_type(z_in) != type ||
+                    oskar_mem_type(z_out) != type)) ||
+            !oskar_mem_is_complex(output) || oskar_mem_is_matrix(output) ||
+            oskar_mem_type(weights_in) != oskar_mem_type(output) ||
+            oskar_mem_type(x_in) != type || oskar_mem_type(y_in) != type ||
+            oskar_mem_type(x_out) != type || oskar_mem_type(y_out) != type)
+    {
+        oskar_dftw(num_in, wavenumber, x_in, y_in, z_in, weights_in,
+                num_out, x_out, y_out, z_out, 0, output, status);
+        return;
+    }
+
+    /* Get double-precision copies of the coordinates. */
+    x_d = oskar_mem_convert_precision(x_in, OSKAR_DOUBLE, status);
+    y_d = oskar_mem_convert_precision(y_in, OSKAR_DOUBLE, status);
+    u_d = oskar_mem_convert_precision(x_out, OSKAR_DOUBLE, status);
+    v_d = oskar_mem_convert_precision(y_out, OSKAR_DOUBLE, status);
+    if (is_3d)
+        z_d = oskar_mem_convert_precision(z_in, OSKAR_DOUBLE, status);
+    if (*status) goto done;
+    u = oskar_mem_double(u_d, status);
+    v = oskar_mem_double(v_d, status);
+    for (i = 0; i < num_out; ++i)
+    {
+        u[i] *= wavenumber;
+        v[i] *= wavenumber;
+    }
+
+    /* Find the extents of the transform, and check it is worthwhile.
+     * A non-zero z-coordinate common to all inputs is just a phase term. */
+    num_bad = range(num_in, oskar_mem_double_const(x_d, status),
+            &x_min, &x_max);
+    num_bad += range(num_in, oskar_mem_double_const(y_d, status),
+            &y_min, &y_max);
+    if (is_3d)
+        num_bad += range(num_in, oskar_mem_double_const(z_d, status),
+                &z_min, &z_max);
+    range(num_out, u, &u_min, &u_max);
+    range(num_out, v, &v_min, &v_max);
+    if (num_bad > 0 || z_max != z_min ||
+            oskar_nufft_type3_2d_relative_cost(num_in, num_out,
+                    0.5 * (x_max - x_min), 0.5 * (y_max - y_min),
+                    0.5 * (u_max - u_min), 0.5 * (v_max - v_min),
+                    tolerance) >= 1.0)
+    {
+        oskar_dftw(num_in, wavenumber, x_in, y_in, z_in, weights_in,
+                num_out, x_out, y_out, z_out, 0, output, status);
+        goto done;
+    }
+
+    /* Resize output array if needed. */
+    if ((int)oskar_mem_length(output) < num_out)
+        oskar_mem_realloc(output, (size_t) num_out, status);
+
+    /* Evaluate the transform in double precision. */
+    w_d = oskar_mem_convert_precision(weights_in, OSKAR_DOUBLE, status);
+    out_d = (type == OSKAR_DOUBLE) ? output :
+            oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU, num_out, status);
+    oskar_nufft_type3_2d(num_in, oskar_mem_double_const(x_d, status),
+            oskar_mem_double_const(y_d, status),
+            oskar_mem_double_const(w_d, status), num_out, u, v, tolerance,
+            oskar_mem_double(out_d, status), status);
+    if (is_3d && z_min != 0.0 && !*status)
+    {
+        double *w_out;
+        oskar_Mem* w_out_d;
+        w_out_d = oskar_mem_convert_precision(z_out, OSKAR_DOUBLE, status);
+        w_out = oskar_mem_double(w_out_d, status);
+        out = oskar_mem_double(out_d, status);
+        for (i = 0; i < num_out; ++i)
+        {
+            double re, im, phase;
+            phase = wavenumber * w_out[i] * z_min;
+            re = out[2*i] * cos(phase) - out[2*i + 1] * sin(phase);
+            im = out[2*i] * sin(phase) + out[2*i + 1] * cos(phase);
+            out[2*i] = re;
+            out[2*i + 1] = im;
+        }
+        oskar_mem_free(w_out_d, status);
+    }
+    if (out_d != output)
+    {
+        float* out_f = oskar_mem_float(output, status);
+        out = oskar_mem_double(out_d, status);
+        for (i = 0; i < 2 * num_out; ++i) out_f[i] = (float) out[i];
+        oskar_mem_free(out_d, status);
+    }
+    oskar_mem_free(w_d, status);
+
+done:
+    oskar_mem_free(x_d, status);
+    oskar_mem_free(y_d, status);
+    oskar_mem_free(z_d, status);
+    oskar_mem_free(u_d, status);
+    oskar_mem_free(v_d, status);
+}
+
+#ifdef __cplusplus
+}
+#endif
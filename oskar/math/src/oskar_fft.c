@@ -0,0 +1,390 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef OSKAR_HAVE_CUDA
+#include <cufft.h>
+#endif
+
+#include "math/oskar_fft.h"
+#include "math/oskar_fftpack_cfft.h"
+#include "math/oskar_fftpack_cfft_f.h"
+#include "utility/oskar_device_utils.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of rows transformed together by FFTPACK. */
+#define ROW_BLOCK 4
+
+/* Side length of the tiles used for the transpose. */
+#define TILE 32
+
+struct oskar_FFT
+{
+    int precision, location, num_dim, dim_size, batch_size_1d;
+    oskar_Mem* fftpack_wsave;
+#ifdef OSKAR_HAVE_CUDA
+    cufftHandle cufft_plan;
+#endif
+};
+
+static int fft_rows_d(const int num_rows, const int n, double* data,
+        double* wsave)
+{
+    int r, failed = 0;
+#pragma omp parallel private(r)
+    {
+        double* work = (double*) malloc(2 * ROW_BLOCK * n * sizeof(double));
+
+        /* Give up if any thread could not allocate its work array. */
+        if (!work)
+        {
+#pragma omp atomic
+            failed++;
+        }
+#pragma omp barrier
+        if (!failed)
+        {
+#pragma omp for schedule(static)
+            for (r = 0; r < num_rows; r += ROW_BLOCK)
+            {
+                const int lot = (num_rows - r < ROW_BLOCK) ?
+                        num_rows - r : ROW_BLOCK;
+                oskar_fftpack_cfftmf(lot, n, n, 1,
+                        data + 2 * (size_t)r * n, wsave, work);
+            }
+        }
+        free(work);
+    }
+    return !failed;
+}
+
+
+static void transpose_d(const int n, double* data, const double scale)
+{
+    int bi;
+#pragma omp parallel for private(bi) schedule(dynamic, 1)
+    for (bi = 0; bi < n; bi += TILE)
+    {
+        int bj, i, j;
+        const int i_end = (bi + TILE < n) ? bi + TILE : n;
+        for (bj = bi; bj < n; bj += TILE)
+        {
+            const int j_end = (bj + TILE < n) ? bj + TILE : n;
+            for (i = bi; i < i_end; ++i)
+            {
+                double* restrict row = data + 2 * (size_t)i * n;
+                j = (bi == bj) ? i : bj;
+                if (j == i)
+                {
+                    row[2 * i]     *= scale;
+                    row[2 * i + 1] *= scale;
+                    ++j;
+                }
+                for (; j < j_end; ++j)
+                {
+                    double* restrict col = data + 2 * ((size_t)j * n + i);
+                    const double re = row[2 * j], im = row[2 * j + 1];
+                    row[2 * j]     = scale * col[0];
+                    row[2 * j + 1] = scale * col[1];
+                    col[0] = scale * re;
+                    col[1] = scale * im;
+                }
+            }
+        }
+    }
+}
+
+
+static void fft_cpu_d(const oskar_FFT* h, double* data, double* wsave,
+        int* status)
+{
+    const int n = h->dim_size;
+    if (h->num_dim == 1)
+    {
+        /* FFTPACK normalises each transform, so undo it afterwards. */
+        size_t i;
+        const size_t num = 2 * (size_t)n * h->batch_size_1d;
+        if (!fft_rows_d(h->batch_size_1d, n, data, wsave))
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return;
+        }
+        for (i = 0; i < num; ++i) data[i] *= (double) n;
+    }
+    else
+    {
+        /* Transform rows, then columns as rows of the transpose.
+         * Undo the FFTPACK normalisation in the final transpose. */
+        if (!fft_rows_d(n, n, data, wsave))
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return;
+        }
+        transpose_d(n, data, (double) 1);
+        if (!fft_rows_d(n, n, data, wsave))
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return;
+        }
+        transpose_d(n, data, (double) n * (double) n);
+    }
+}
+
+
+static int fft_rows_f(const int num_rows, const int n, float* data,
+        float* wsave)
+{
+    int r, failed = 0;
+#pragma omp parallel private(r)
+    {
+        float* work = (float*) malloc(2 * ROW_BLOCK * n * sizeof(float));
+
+        /* Give up if any thread could not allocate its work array. */
+        if (!work)
+        {
+#pragma omp atomic
+            failed++;
+        }
+#pragma omp barrier
+        if (!failed)
+        {
+#pragma omp for schedule(static)
+            for (r = 0; r < num_rows; r += ROW_BLOCK)
+            {
+                const int lot = (num_rows - r < ROW_BLOCK) ?
+                        num_rows - r : ROW_BLOCK;
+                oskar_fftpack_cfftmf_f(lot, n, n, 1,
+                        data + 2 * (size_t)r * n, wsave, work);
+            }
+        }
+        free(work);
+    }
+    return !failed;
+}
+
+
+static void transpose_f(const int n, float* data, const float scale)
+{
+    int bi;
+#pragma omp parallel for private(bi) schedule(dynamic, 1)
+    for (bi = 0; bi < n; bi += TILE)
+    {
+        int bj, i, j;
+        const int i_end = (bi + TILE < n) ? bi + TILE : n;
+        for (bj = bi; bj < n; bj += TILE)
+        {
+            const int j_end = (bj + TILE < n) ? bj + TILE : n;
+            for (i = bi; i < i_end; ++i)
+            {
+                float* restrict row = data + 2 * (size_t)i * n;
+                j = (bi == bj) ? i : bj;
+                if (j == i)
+                {
+                    row[2 * i]     *= scale;
+                    row[2 * i + 1] *= scale;
+                    ++j;
+                }
+                for (; j < j_end; ++j)
+                {
+                    float* restrict col = data + 2 * ((size_t)j * n + i);
+                    const float re = row[2 * j], im = row[2 * j + 1];
+                    row[2 * j]     = scale * col[0];
+                    row[2 * j + 1] = scale * col[1];
+                    col[0] = scale * re;
+                    col[1] = scale * im;
+                }
+            }
+        }
+    }
+}
+
+
+static void fft_cpu_f(const oskar_FFT* h, float* data, float* wsave,
+        int* status)
+{
+    const int n = h->dim_size;
+    if (h->num_dim == 1)
+    {
+        /* FFTPACK normalises each transform, so undo it afterwards. */
+        size_t i;
+        const size_t num = 2 * (size_t)n * h->batch_size_1d;
+        if (!fft_rows_f(h->batch_size_1d, n, data, wsave))
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return;
+        }
+        for (i = 0; i < num; ++i) data[i] *= (float) n;
+    }
+    else
+    {
+        /* Transform rows, then columns as rows of the transpose.
+         * Undo the FFTPACK normalisation in the final transpose. */
+        if (!fft_rows_f(n, n, data, wsave))
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return;
+        }
+        transpose_f(n, data, (float) 1);
+        if (!fft_rows_f(n, n, data, wsave))
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return;
+        }
+        transpose_f(n, data, (float) n * (float) n);
+    }
+}
+
+oskar_FFT* oskar_fft_create(int precision, int location, int num_dim,
+        int dim_size, int batch_size_1d, int* status)
+{
+    oskar_FFT* h;
+    h = (oskar_FFT*) calloc(1, sizeof(oskar_FFT));
+    h->precision = precision;
+    h->location = location;
+    h->num_dim = num_dim;
+    h->dim_size = dim_size;
+    h->batch_size_1d = (num_dim == 1) ? batch_size_1d : 1;
+    if (*status) return h;
+    if (num_dim != 1 && num_dim != 2)
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return h;
+    }
+    if (precision != OSKAR_SINGLE && precision != OSKAR_DOUBLE)
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return h;
+    }
+    if (location == OSKAR_GPU)
+    {
+#ifdef OSKAR_HAVE_CUDA
+        const int type = (precision == OSKAR_DOUBLE) ? CUFFT_Z2Z : CUFFT_C2C;
+        if (num_dim == 1)
+            cufftPlan1d(&h->cufft_plan, dim_size, type, batch_size_1d);
+        else
+            cufftPlan2d(&h->cufft_plan, dim_size, dim_size, type);
+#else
+        *status = OSKAR_ERR_CUDA_NOT_AVAILABLE;
+#endif
+    }
+    else if (location == OSKAR_CPU)
+    {
+        const int len = 2 * dim_size +
+                (int)(log((double)dim_size) / log(2.0)) + 4;
+        h->fftpack_wsave = oskar_mem_create(precision, OSKAR_CPU, len, status);
+        if (precision == OSKAR_DOUBLE)
+            oskar_fftpack_cfftmi(dim_size,
+                    oskar_mem_double(h->fftpack_wsave, status));
+        else
+            oskar_fftpack_cfftmi_f(dim_size,
+                    oskar_mem_float(h->fftpack_wsave, status));
+    }
+    else
+        *status = OSKAR_ERR_BAD_LOCATION;
+    return h;
+}
+
+
+void oskar_fft_exec(oskar_FFT* h, oskar_Mem* data, int* status)
+{
+    oskar_Mem *data_copy = 0, *data_ptr = data;
+    if (*status) return;
+    if (oskar_mem_precision(data) != h->precision ||
+            !oskar_mem_is_complex(data))
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (oskar_mem_length(data) <
+            (size_t)h->dim_size * (size_t)(h->num_dim == 1 ?
+                    h->batch_size_1d : h->dim_size))
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+    if (oskar_mem_location(data) != h->location)
+    {
+        data_copy = oskar_mem_create_copy(data, h->location, status);
+        data_ptr = data_copy;
+    }
+    if (*status)
+    {
+        oskar_mem_free(data_copy, status);
+        return;
+    }
+    if (h->location == OSKAR_GPU)
+    {
+#ifdef OSKAR_HAVE_CUDA
+        if (h->precision == OSKAR_DOUBLE)
+            cufftExecZ2Z(h->cufft_plan, (cufftDoubleComplex*)
+                    oskar_mem_void(data_ptr), (cufftDoubleComplex*)
+                    oskar_mem_void(data_ptr), CUFFT_FORWARD);
+        else
+            cufftExecC2C(h->cufft_plan, (cufftComplex*)
+                    oskar_mem_void(data_ptr), (cufftComplex*)
+                    oskar_mem_void(data_ptr), CUFFT_FORWARD);
+        oskar_device_check_error(status);
+#endif
+    }
+    else
+    {
+        if (h->precision == OSKAR_DOUBLE)
+            fft_cpu_d(h, oskar_mem_double(data_ptr, status),
+                    oskar_mem_double(h->fftpack_wsave, status), status);
+        else
+            fft_cpu_f(h, oskar_mem_float(data_ptr, status),
+                    oskar_mem_float(h->fftpack_wsave, status), status);
+    }
+    if (data_copy)
+    {
+        oskar_mem_copy(data, data_copy, status);
+        oskar_mem_free(data_copy, status);
+    }
+}
+
+
+void oskar_fft_free(oskar_FFT* h)
+{
+    int status = 0;
+    if (!h) return;
+    oskar_mem_free(h->fftpack_wsave, &status);
+#ifdef OSKAR_HAVE_CUDA
+    if (h->location == OSKAR_GPU)
+        cufftDestroy(h->cufft_plan);
+#endif
+    free(h);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -166,6 +166,26 @@ void oskar_fftpack_cfft2i(const int l, const int m, double *wsave)
     cfftmi(m, &wsave[(l << 1) + (int) (log((double) l) / log(2.0)) + 2]);
 }
 
+void oskar_fftpack_cfftmb(const int lot, const int jump, const int n,
+        const int inc, double *c, double *wsave, double *work)
+{
+    cfftmb(lot, jump, n, inc, c, wsave, work);
+}
+
+
+void oskar_fftpack_cfftmf(const int lot, const int jump, const int n,
+        const int inc, double *c, double *wsave, double *work)
+{
+    cfftmf(lot, jump, n, inc, c, wsave, work);
+}
+
+
+void oskar_fftpack_cfftmi(const int n, double *wsave)
+{
+    cfftmi(n, wsave);
+}
+
+
 
 void cfftmb(const int lot, const int jump, const int n, const int inc,
         double *c, double *wsave, double *work)
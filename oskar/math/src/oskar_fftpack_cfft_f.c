@@ -166,6 +166,26 @@ void oskar_fftpack_cfft2i_f(const int l, const int m, float *wsave)
     cfftmi(m, &wsave[(l << 1) + (int) (log((float) l) / log(2.0)) + 2]);
 }
 
+void oskar_fftpack_cfftmb_f(const int lot, const int jump, const int n,
+        const int inc, float *c, float *wsave, float *work)
+{
+    cfftmb(lot, jump, n, inc, c, wsave, work);
+}
+
+
+void oskar_fftpack_cfftmf_f(const int lot, const int jump, const int n,
+        const int inc, float *c, float *wsave, float *work)
+{
+    cfftmf(lot, jump, n, inc, c, wsave, work);
+}
+
+
+void oskar_fftpack_cfftmi_f(const int n, float *wsave)
+{
+    cfftmi(n, wsave);
+}
+
+
 
 void cfftmb(const int lot, const int jump, const int n, const int inc,
         float *c, float *wsave, float *work)
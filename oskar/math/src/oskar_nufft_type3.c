@@ -0,0 +1,337 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "math/oskar_nufft_type3.h"
+#include "math/oskar_fftpack_cfft.h"
+
+#include "math/oskar_cmath.h"
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Grid oversampling factor used for both stages. */
+#define R_OVER 2.0
+
+/* Relative costs of a kernel multiply-add and an FFT butterfly, in units
+ * of one term of the direct sum. */
+#define KERNEL_COST 0.5
+#define FFT_COST 0.7
+
+/* Limits on the size of the first grid. */
+#define MAX_GRID_SIDE 65536.0
+#define MAX_GRID_CELLS 67108864.0
+
+typedef struct
+{
+    double centre_in, centre_out, gamma, h, tau1, tau2;
+    int n1, n2;
+} Dim;
+
+static int kernel_half_width(double tolerance)
+{
+    int msp;
+    if (tolerance < 1e-14) tolerance = 1e-14;
+    if (tolerance > 1e-1) tolerance = 1e-1;
+    msp = (int) ceil(-log(tolerance) /
+            (M_PI * (R_OVER - 1.0) / (R_OVER - 0.5)));
+    return msp;
+}
+
+static int next_smooth_even(int n)
+{
+    int m;
+    if (n < 2) n = 2;
+    if (n & 1) n++;
+    for (;; n += 2)
+    {
+        m = n;
+        while (m % 2 == 0) m /= 2;
+        while (m % 3 == 0) m /= 3;
+        while (m % 5 == 0) m /= 5;
+        if (m == 1) return n;
+    }
+}
+
+/* Finds the centre and half-width of the finite values in an array,
+ * and returns the number of non-finite values. */
+static int find_range(int n, const double* a, double* centre,
+        double* half_width)
+{
+    int i, num_bad = 0, found = 0;
+    double min_val = 0.0, max_val = 0.0;
+    for (i = 0; i < n; ++i)
+    {
+        if (!(a[i] - a[i] == 0.0))
+        {
+            num_bad++;
+            continue;
+        }
+        if (!found || a[i] < min_val) min_val = a[i];
+        if (!found || a[i] > max_val) max_val = a[i];
+        found = 1;
+    }
+    *centre = 0.5 * (max_val + min_val);
+    *half_width = 0.5 * (max_val - min_val);
+    return num_bad;
+}
+
+/* Returns the oversampled grid size, or 0 if the grid would be too large. */
+static int plan_dim(double in_half_width, double out_half_width, int msp,
+        Dim* d)
+{
+    double m1, n;
+    n = ceil(2.0 * R_OVER * in_half_width * out_half_width / M_PI);
+    if (n > MAX_GRID_SIDE) return 0;
+    d->n1 = next_smooth_even((int) n + 2 * (msp + 1) + 2);
+    if (in_half_width > 0.0)
+        d->gamma = in_half_width /
+                (M_PI * (1.0 - 2.0 * (msp + 1) / (double) d->n1));
+    else if (out_half_width > 0.0)
+        d->gamma = d->n1 / (2.0 * R_OVER * out_half_width);
+    else
+        d->gamma = 1.0;
+    d->h = 2.0 * M_PI / d->n1;
+    m1 = d->n1 / R_OVER;
+    d->tau1 = M_PI * msp / (m1 * m1 * R_OVER * (R_OVER - 0.5));
+    d->n2 = (int) (R_OVER * d->n1);
+    d->tau2 = M_PI * msp / ((double) d->n1 * d->n1 * R_OVER * (R_OVER - 0.5));
+    return d->n2;
+}
+
+/* Evaluates Gaussian kernel values around x on a grid of spacing h. */
+static int kernel_1d(double x, double h, double tau, int msp, double* w)
+{
+    int i, start;
+    start = (int) floor(x / h + 0.5) - msp;
+    for (i = 0; i <= 2 * msp; ++i)
+    {
+        const double t = (start + i) * h - x;
+        w[i] = exp(-t * t / (4.0 * tau));
+    }
+    return start;
+}
+
+void oskar_nufft_type3_2d(int num_in, const double* x_in, const double* y_in,
+        const double* weights_in, int num_out, const double* u_out,
+        const double* v_out, double tolerance, double* output, int* status)
+{
+    int i, j, k, msp, w, nx, ny, len;
+    double in_half_x, in_half_y, out_half_x, out_half_y;
+    double *grid = 0, *wsave = 0, *work = 0, *fac_x = 0, *fac_y = 0;
+    Dim dx, dy;
+    if (*status) return;
+
+    /* Set up the grids for each dimension. */
+    msp = kernel_half_width(tolerance);
+    w = 2 * msp + 1;
+    if (find_range(num_in, x_in, &dx.centre_in, &in_half_x) ||
+            find_range(num_in, y_in, &dy.centre_in, &in_half_y))
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return;
+    }
+    find_range(num_out, u_out, &dx.centre_out, &out_half_x);
+    find_range(num_out, v_out, &dy.centre_out, &out_half_y);
+    nx = plan_dim(in_half_x, out_half_x, msp, &dx);
+    ny = plan_dim(in_half_y, out_half_y, msp, &dy);
+    if (nx == 0 || ny == 0 || (double) dx.n1 * dy.n1 > MAX_GRID_CELLS)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+
+    /* Allocate scratch arrays. */
+    len = 2 * (nx + ny) + 2 * (int)(log((double)nx) / log(2.0)) +
+            2 * (int)(log((double)ny) / log(2.0)) + 16;
+    grid = (double*) calloc(2 * (size_t) nx * ny, sizeof(double));
+    work = (double*) malloc(2 * (size_t) nx * ny * sizeof(double));
+    wsave = (double*) malloc(len * sizeof(double));
+    fac_x = (double*) malloc(dx.n1 * sizeof(double));
+    fac_y = (double*) malloc(dy.n1 * sizeof(double));
+    if (!grid || !work || !wsave || !fac_x || !fac_y)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        goto done;
+    }
+
+    /* Pre-phase and spread the input points onto the first grid.
+     * Spreading is done serially as kernels of nearby points overlap. */
+    {
+        double *kx, *ky;
+        kx = (double*) malloc(2 * w * sizeof(double));
+        if (!kx)
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            goto done;
+        }
+        ky = kx + w;
+        for (j = 0; j < num_in; ++j)
+        {
+            double c_re, c_im, re, im, phase, xi, eta;
+            int sx, sy, ix, iy;
+            xi = x_in[j] - dx.centre_in;
+            eta = y_in[j] - dy.centre_in;
+            phase = dx.centre_out * xi + dy.centre_out * eta;
+            c_re = cos(phase);
+            c_im = sin(phase);
+            re = weights_in[2*j] * c_re - weights_in[2*j + 1] * c_im;
+            im = weights_in[2*j] * c_im + weights_in[2*j + 1] * c_re;
+            sx = kernel_1d(xi / dx.gamma, dx.h, dx.tau1, msp, kx);
+            sy = kernel_1d(eta / dy.gamma, dy.h, dy.tau1, msp, ky);
+            for (iy = 0; iy < w; ++iy)
+            {
+                const int gy = (sy + iy + ny) % ny;
+                const double t_re = re * ky[iy], t_im = im * ky[iy];
+                double* row = grid + 2 * (size_t) gy * nx;
+                for (ix = 0; ix < w; ++ix)
+                {
+                    const int gx = (sx + ix + nx) % nx;
+                    row[2*gx]     += t_re * kx[ix];
+                    row[2*gx + 1] += t_im * kx[ix];
+                }
+            }
+        }
+        free(kx);
+    }
+
+    /* Pre-correct for the interpolation kernel of the second stage. */
+    for (i = 0; i < dx.n1; ++i)
+    {
+        const double m = i - dx.n1 / 2;
+        fac_x[i] = sqrt(M_PI / dx.tau2) * exp(dx.tau2 * m * m);
+    }
+    for (i = 0; i < dy.n1; ++i)
+    {
+        const double m = i - dy.n1 / 2;
+        fac_y[i] = sqrt(M_PI / dy.tau2) * exp(dy.tau2 * m * m);
+    }
+    for (j = 0; j < dy.n1; ++j)
+    {
+        double* row = grid + 2 * (size_t)((j - dy.n1 / 2 + ny) % ny) * nx;
+        for (i = 0; i < dx.n1; ++i)
+        {
+            const int gx = (i - dx.n1 / 2 + nx) % nx;
+            const double f = fac_x[i] * fac_y[j];
+            row[2*gx]     *= f;
+            row[2*gx + 1] *= f;
+        }
+    }
+
+    /* Transform the oversampled grid. */
+    oskar_fftpack_cfft2i(nx, ny, wsave);
+    oskar_fftpack_cfft2b(nx, nx, ny, grid, wsave, work);
+
+    /* Interpolate to the output points and deconvolve the first kernel. */
+#pragma omp parallel private(k)
+    {
+        double *kx, *ky;
+        kx = (double*) malloc(2 * w * sizeof(double));
+        ky = kx ? kx + w : 0;
+        if (!kx)
+        {
+#pragma omp critical (nufft_status)
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        }
+#pragma omp for
+        for (k = 0; k < num_out; ++k)
+        {
+            double tx, ty, sum_re = 0.0, sum_im = 0.0, re, im, phase, scale;
+            int sx, sy, ix, iy;
+            if (!kx) continue;
+            tx = (u_out[k] - dx.centre_out) * dx.gamma;
+            ty = (v_out[k] - dy.centre_out) * dy.gamma;
+            if (!(tx - tx == 0.0) || !(ty - ty == 0.0))
+            {
+                output[2*k] = output[2*k + 1] = NAN;
+                continue;
+            }
+            sx = kernel_1d(tx * dx.h, 2.0 * M_PI / nx, dx.tau2, msp, kx);
+            sy = kernel_1d(ty * dy.h, 2.0 * M_PI / ny, dy.tau2, msp, ky);
+            for (iy = 0; iy < w; ++iy)
+            {
+                const int gy = (sy + iy + ny) % ny;
+                const double* row = grid + 2 * (size_t) gy * nx;
+                double row_re = 0.0, row_im = 0.0;
+                for (ix = 0; ix < w; ++ix)
+                {
+                    const int gx = (sx + ix + nx) % nx;
+                    row_re += row[2*gx] * kx[ix];
+                    row_im += row[2*gx + 1] * kx[ix];
+                }
+                sum_re += row_re * ky[iy];
+                sum_im += row_im * ky[iy];
+            }
+            scale = dx.h * dy.h / ((double) nx * ny *
+                    sqrt(4.0 * M_PI * dx.tau1) * exp(-dx.tau1 * tx * tx) *
+                    sqrt(4.0 * M_PI * dy.tau1) * exp(-dy.tau1 * ty * ty));
+            sum_re *= scale;
+            sum_im *= scale;
+
+            /* Post-phase for the shift of the input origin. */
+            phase = u_out[k] * dx.centre_in + v_out[k] * dy.centre_in;
+            re = cos(phase);
+            im = sin(phase);
+            output[2*k]     = sum_re * re - sum_im * im;
+            output[2*k + 1] = sum_re * im + sum_im * re;
+        }
+        free(kx);
+    }
+
+done:
+    free(grid);
+    free(work);
+    free(wsave);
+    free(fac_x);
+    free(fac_y);
+}
+
+double oskar_nufft_type3_2d_relative_cost(int num_in, int num_out,
+        double x_half_width, double y_half_width,
+        double u_half_width, double v_half_width, double tolerance)
+{
+    int msp;
+    double cells, kernel, direct;
+    Dim dx, dy;
+    msp = kernel_half_width(tolerance);
+    direct = (double) num_in * num_out;
+    if (direct <= 0.0 ||
+            !plan_dim(x_half_width, u_half_width, msp, &dx) ||
+            !plan_dim(y_half_width, v_half_width, msp, &dy) ||
+            (double) dx.n1 * dy.n1 > MAX_GRID_CELLS)
+        return HUGE_VAL;
+    cells = (double) dx.n2 * dy.n2;
+    kernel = (2.0 * msp + 1.0) * (2.0 * msp + 1.0);
+    return (KERNEL_COST * kernel * ((double) num_in + num_out) +
+            FFT_COST * cells * log(cells) / log(2.0)) / direct;
+}
+
+#ifdef __cplusplus
+}
+#endif
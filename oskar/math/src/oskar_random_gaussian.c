@@ -50,6 +50,63 @@ void oskar_random_gaussian4(unsigned int seed, unsigned int counter0,
     oskar_box_muller_d(u.i[2], u.i[3], &rnd[2], &rnd[3]);
 }
 
+/* Number of counter values to generate before the Box-Muller transform. */
+#define CHUNK 64
+
+void oskar_random_gaussian2_array(unsigned int seed, unsigned int counter0,
+        unsigned int counter1, int num, double* rnd)
+{
+    int i, j, n;
+    unsigned int r[2 * CHUNK];
+    for (i = 0; i < num; i += CHUNK)
+    {
+        n = (num - i < CHUNK) ? num - i : CHUNK;
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+        for (j = 0; j < n; ++j)
+        {
+            OSKAR_R123_GENERATE_2(seed, counter0 + i + j, counter1);
+            r[2*j]     = u.i[0];
+            r[2*j + 1] = u.i[1];
+        }
+        for (j = 0; j < n; ++j)
+            oskar_box_muller_d(r[2*j], r[2*j + 1],
+                    &rnd[2*(i + j)], &rnd[2*(i + j) + 1]);
+    }
+}
+
+void oskar_random_gaussian4_array(unsigned int seed, unsigned int counter0,
+        unsigned int counter1, unsigned int counter2, unsigned int counter3,
+        int num, double* rnd)
+{
+    int i, j, n;
+    unsigned int r[4 * CHUNK];
+    for (i = 0; i < num; i += CHUNK)
+    {
+        n = (num - i < CHUNK) ? num - i : CHUNK;
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+        for (j = 0; j < n; ++j)
+        {
+            OSKAR_R123_GENERATE_4(seed, counter0 + i + j,
+                    counter1, counter2, counter3);
+            r[4*j]     = u.i[0];
+            r[4*j + 1] = u.i[1];
+            r[4*j + 2] = u.i[2];
+            r[4*j + 3] = u.i[3];
+        }
+        for (j = 0; j < n; ++j)
+        {
+            oskar_box_muller_d(r[4*j], r[4*j + 1],
+                    &rnd[4*(i + j)], &rnd[4*(i + j) + 1]);
+            oskar_box_muller_d(r[4*j + 2], r[4*j + 3],
+                    &rnd[4*(i + j) + 2], &rnd[4*(i + j) + 3]);
+        }
+    }
+}
+
 double oskar_random_gaussian(double* another)
 {
     double x, y, r2, fac;
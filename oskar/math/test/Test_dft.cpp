@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017, The University of Oxford
+ * Copyright (c) 2017-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -29,12 +29,20 @@
 #include <gtest/gtest.h>
 
 #include "math/oskar_dft_c2r.h"
+#include "math/oskar_dft_c2r_2d_omp.h"
+#include "math/oskar_dft_c2r_2d_separable_omp.h"
+#include "math/oskar_dftw.h"
+#include "math/oskar_dftw_indexed_input.h"
+#include "math/oskar_dftw_nufft.h"
+#include "math/oskar_nufft_type3.h"
 #include "math/oskar_cmath.h"
 #include "math/oskar_evaluate_image_lmn_grid.h"
 #include "utility/oskar_get_error_string.h"
 #include "utility/oskar_cl_utils.h"
 
 #include <cstdlib>
+#include <algorithm>
+#include <vector>
 #include <cstdio>
 
 static void run_test(int type, int loc, int num_baselines,
@@ -123,3 +131,443 @@ TEST(dft, c2r)
     oskar_mem_free(v, &status);
     oskar_mem_free(w, &status);
 }
+
+TEST(dft, indexed_input)
+{
+    int status = 0, num_in = 100, num_out = 500, num_types = 3;
+    double wavenumber = 2 * M_PI * 100e6 / 299792458.;
+    int types[] = {OSKAR_DOUBLE_COMPLEX, OSKAR_DOUBLE_COMPLEX_MATRIX};
+    for (int t = 0; t < 2; ++t)
+    {
+        oskar_Mem *x_in, *y_in, *z_in, *x_out, *y_out, *z_out, *weights;
+        oskar_Mem *index, *data, *data_expanded, *out, *out_expanded;
+        x_in = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_in, &status);
+        y_in = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_in, &status);
+        z_in = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_in, &status);
+        x_out = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_out, &status);
+        y_out = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_out, &status);
+        z_out = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_out, &status);
+        weights = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+                num_in, &status);
+        index = oskar_mem_create(OSKAR_INT, OSKAR_CPU, num_in, &status);
+        data = oskar_mem_create(types[t], OSKAR_CPU,
+                num_out * num_types, &status);
+        data_expanded = oskar_mem_create(types[t], OSKAR_CPU,
+                num_out * num_in, &status);
+        out = oskar_mem_create(types[t], OSKAR_CPU, num_out, &status);
+        out_expanded = oskar_mem_create(types[t], OSKAR_CPU,
+                num_out, &status);
+        oskar_mem_random_range(x_in, -20., 20., &status);
+        oskar_mem_random_range(y_in, -20., 20., &status);
+        oskar_mem_random_range(z_in, -1., 1., &status);
+        oskar_mem_random_range(x_out, -1., 1., &status);
+        oskar_mem_random_range(y_out, -1., 1., &status);
+        oskar_mem_random_range(z_out, 0., 1., &status);
+        oskar_mem_random_range(weights, -1., 1., &status);
+        oskar_mem_random_range(data, -1., 1., &status);
+
+        // Expand the input data using the indices.
+        int* index_ = oskar_mem_int(index, &status);
+        for (int i = 0; i < num_in; ++i)
+        {
+            index_[i] = (7 * i) % num_types;
+            oskar_mem_copy_contents(data_expanded, data, i * num_out,
+                    index_[i] * num_out, num_out, &status);
+        }
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+        // Compare the indexed DFT with the normal one.
+        oskar_dftw_indexed_input(num_in, wavenumber, x_in, y_in, z_in,
+                weights, index, num_out, x_out, y_out, z_out, data, out,
+                &status);
+        oskar_dftw(num_in, wavenumber, x_in, y_in, z_in, weights,
+                num_out, x_out, y_out, z_out, data_expanded, out_expanded,
+                &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        const double* a = oskar_mem_double_const(out, &status);
+        const double* b = oskar_mem_double_const(out_expanded, &status);
+        int n = num_out * oskar_mem_element_size(types[t]) / sizeof(double);
+        for (int i = 0; i < n; ++i)
+            ASSERT_DOUBLE_EQ(b[i], a[i]) << "at index " << i;
+
+        oskar_mem_free(x_in, &status);
+        oskar_mem_free(y_in, &status);
+        oskar_mem_free(z_in, &status);
+        oskar_mem_free(x_out, &status);
+        oskar_mem_free(y_out, &status);
+        oskar_mem_free(z_out, &status);
+        oskar_mem_free(weights, &status);
+        oskar_mem_free(index, &status);
+        oskar_mem_free(data, &status);
+        oskar_mem_free(data_expanded, &status);
+        oskar_mem_free(out, &status);
+        oskar_mem_free(out_expanded, &status);
+    }
+}
+
+static void check_dftw(int prec, int data_type, int is_3d, double scale,
+        double tol)
+{
+    int status = 0, num_in = 77, num_out = 201;
+    double wavenumber = 2 * M_PI * 100e6 / 299792458.;
+    oskar_Mem *x_in, *y_in, *z_in, *x_out, *y_out, *z_out, *weights;
+    oskar_Mem *data = 0, *out;
+    x_in = oskar_mem_create(prec, OSKAR_CPU, num_in, &status);
+    y_in = oskar_mem_create(prec, OSKAR_CPU, num_in, &status);
+    z_in = oskar_mem_create(prec, OSKAR_CPU, num_in, &status);
+    x_out = oskar_mem_create(prec, OSKAR_CPU, num_out, &status);
+    y_out = oskar_mem_create(prec, OSKAR_CPU, num_out, &status);
+    z_out = oskar_mem_create(prec, OSKAR_CPU, num_out, &status);
+    weights = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+            num_in, &status);
+    out = oskar_mem_create(prec | OSKAR_COMPLEX | data_type, OSKAR_CPU,
+            num_out, &status);
+    oskar_mem_random_range(x_in, -scale, scale, &status);
+    oskar_mem_random_range(y_in, -scale, scale, &status);
+    oskar_mem_random_range(z_in, -scale / 10., scale / 10., &status);
+    oskar_mem_random_range(x_out, -1., 1., &status);
+    oskar_mem_random_range(y_out, -1., 1., &status);
+    oskar_mem_random_range(z_out, 0., 1., &status);
+    oskar_mem_random_range(weights, -1., 1., &status);
+    if (data_type)
+    {
+        data = oskar_mem_create(prec | data_type, OSKAR_CPU,
+                num_in * num_out, &status);
+        oskar_mem_random_range(data, -1., 1., &status);
+    }
+    oskar_dftw(num_in, wavenumber, x_in, y_in, is_3d ? z_in : 0, weights,
+            num_out, x_out, y_out, is_3d ? z_out : 0, data, out, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Compare against a direct evaluation in double precision.
+    oskar_Mem *x_in_d, *y_in_d, *z_in_d, *x_out_d, *y_out_d, *z_out_d;
+    oskar_Mem *w_d, *data_d = 0, *out_d;
+    x_in_d = oskar_mem_convert_precision(x_in, OSKAR_DOUBLE, &status);
+    y_in_d = oskar_mem_convert_precision(y_in, OSKAR_DOUBLE, &status);
+    z_in_d = oskar_mem_convert_precision(z_in, OSKAR_DOUBLE, &status);
+    x_out_d = oskar_mem_convert_precision(x_out, OSKAR_DOUBLE, &status);
+    y_out_d = oskar_mem_convert_precision(y_out, OSKAR_DOUBLE, &status);
+    z_out_d = oskar_mem_convert_precision(z_out, OSKAR_DOUBLE, &status);
+    w_d = oskar_mem_convert_precision(weights, OSKAR_DOUBLE, &status);
+    out_d = oskar_mem_convert_precision(out, OSKAR_DOUBLE, &status);
+    if (data)
+        data_d = oskar_mem_convert_precision(data, OSKAR_DOUBLE, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const double *xi = oskar_mem_double_const(x_in_d, &status);
+    const double *yi = oskar_mem_double_const(y_in_d, &status);
+    const double *zi = oskar_mem_double_const(z_in_d, &status);
+    const double *xo = oskar_mem_double_const(x_out_d, &status);
+    const double *yo = oskar_mem_double_const(y_out_d, &status);
+    const double *zo = oskar_mem_double_const(z_out_d, &status);
+    const double *w = oskar_mem_double_const(w_d, &status);
+    const double *d = data_d ? oskar_mem_double_const(data_d, &status) : 0;
+    const double *o = oskar_mem_double_const(out_d, &status);
+    const int nc = oskar_mem_is_matrix(out) ? 4 : 1;
+    double max_err = 0.0, max_val = 0.0;
+    for (int j = 0; j < num_out; ++j)
+    {
+        for (int c = 0; c < nc; ++c)
+        {
+            double re = 0.0, im = 0.0;
+            for (int i = 0; i < num_in; ++i)
+            {
+                double p = wavenumber * (xo[j] * xi[i] + yo[j] * yi[i] +
+                        (is_3d ? zo[j] * zi[i] : 0.0));
+                double wr = w[2*i] * cos(p) - w[2*i+1] * sin(p);
+                double wi = w[2*i] * sin(p) + w[2*i+1] * cos(p);
+                double dr = 1.0, di = 0.0;
+                if (d)
+                {
+                    dr = d[2 * (nc * (i * num_out + j) + c)];
+                    di = d[2 * (nc * (i * num_out + j) + c) + 1];
+                }
+                re += wr * dr - wi * di;
+                im += wr * di + wi * dr;
+            }
+            const double* v = &o[2 * (nc * j + c)];
+            max_err = std::max(max_err, std::max(fabs(v[0] - re),
+                    fabs(v[1] - im)));
+            max_val = std::max(max_val, std::max(fabs(re), fabs(im)));
+        }
+    }
+    EXPECT_LT(max_err / max_val, tol) << "precision " << prec <<
+            ", data type " << data_type << ", 3D " << is_3d <<
+            ", scale " << scale;
+
+    oskar_mem_free(x_in, &status);
+    oskar_mem_free(y_in, &status);
+    oskar_mem_free(z_in, &status);
+    oskar_mem_free(x_out, &status);
+    oskar_mem_free(y_out, &status);
+    oskar_mem_free(z_out, &status);
+    oskar_mem_free(weights, &status);
+    oskar_mem_free(data, &status);
+    oskar_mem_free(out, &status);
+    oskar_mem_free(x_in_d, &status);
+    oskar_mem_free(y_in_d, &status);
+    oskar_mem_free(z_in_d, &status);
+    oskar_mem_free(x_out_d, &status);
+    oskar_mem_free(y_out_d, &status);
+    oskar_mem_free(z_out_d, &status);
+    oskar_mem_free(w_d, &status);
+    oskar_mem_free(data_d, &status);
+    oskar_mem_free(out_d, &status);
+}
+
+TEST(dft, dftw_accuracy)
+{
+    // Check all combinations of precision, data type and dimensionality,
+    // with phases both inside and outside the range of the fast sincos.
+    int data_types[] = {0, OSKAR_COMPLEX, OSKAR_COMPLEX | OSKAR_MATRIX};
+    for (int t = 0; t < 3; ++t)
+    {
+        for (int is_3d = 0; is_3d < 2; ++is_3d)
+        {
+            check_dftw(OSKAR_SINGLE, data_types[t], is_3d, 100., 1e-4);
+            check_dftw(OSKAR_DOUBLE, data_types[t], is_3d, 100., 1e-12);
+            check_dftw(OSKAR_SINGLE, data_types[t], is_3d, 1e5, 5e-2);
+            check_dftw(OSKAR_DOUBLE, data_types[t], is_3d, 1e6, 1e-8);
+        }
+    }
+}
+
+TEST(dft, nufft_type3)
+{
+    // Compare the type-3 NUFFT against the direct sum.
+    int num_in = 300, num_out = 1000, status = 0;
+    std::vector<double> x(num_in), y(num_in), w(2 * num_in);
+    std::vector<double> u(num_out), v(num_out), out(2 * num_out);
+    srand(1);
+    for (int i = 0; i < num_in; ++i)
+    {
+        x[i] = 30.0 * rand() / (double)RAND_MAX + 5.0;
+        y[i] = 20.0 * rand() / (double)RAND_MAX - 40.0;
+        w[2*i] = 2.0 * rand() / (double)RAND_MAX - 1.0;
+        w[2*i + 1] = 2.0 * rand() / (double)RAND_MAX - 1.0;
+    }
+    for (int i = 0; i < num_out; ++i)
+    {
+        u[i] = 8.0 * rand() / (double)RAND_MAX - 2.0;
+        v[i] = 4.0 * rand() / (double)RAND_MAX - 4.0;
+    }
+    double tolerances[] = {1e-3, 1e-6, 1e-10};
+    for (int t = 0; t < 3; ++t)
+    {
+        oskar_nufft_type3_2d(num_in, &x[0], &y[0], &w[0], num_out,
+                &u[0], &v[0], tolerances[t], &out[0], &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        double max_err = 0.0, max_val = 0.0;
+        for (int k = 0; k < num_out; ++k)
+        {
+            double re = 0.0, im = 0.0;
+            for (int j = 0; j < num_in; ++j)
+            {
+                double p = u[k] * x[j] + v[k] * y[j];
+                re += w[2*j] * cos(p) - w[2*j + 1] * sin(p);
+                im += w[2*j] * sin(p) + w[2*j + 1] * cos(p);
+            }
+            max_err = std::max(max_err,
+                    sqrt(pow(out[2*k] - re, 2) + pow(out[2*k + 1] - im, 2)));
+            max_val = std::max(max_val, sqrt(re * re + im * im));
+        }
+        EXPECT_LT(max_err / max_val, tolerances[t]);
+    }
+}
+
+static void check_dftw_nufft(int prec, int num_in, int side, double z_in,
+        double tol, double max_rel_err)
+{
+    int status = 0, num_out = side * side;
+    double wavenumber = 2.0 * M_PI * 150e6 / 299792458.0;
+    oskar_Mem *x_in, *y_in, *z_in_, *x_out, *y_out, *z_out;
+    oskar_Mem *out_dft, *out_nufft;
+    x_in = oskar_mem_create(prec, OSKAR_CPU, num_in, &status);
+    y_in = oskar_mem_create(prec, OSKAR_CPU, num_in, &status);
+    z_in_ = oskar_mem_create(prec, OSKAR_CPU, num_in, &status);
+    x_out = oskar_mem_create(prec, OSKAR_CPU, num_out, &status);
+    y_out = oskar_mem_create(prec, OSKAR_CPU, num_out, &status);
+    z_out = oskar_mem_create(prec, OSKAR_CPU, num_out, &status);
+    out_dft = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU, num_out,
+            &status);
+    out_nufft = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU, num_out,
+            &status);
+
+    // Station of radius 20 m, beamformed towards (l, m) = (0.2, 0.1),
+    // evaluated over the visible hemisphere.
+    oskar_mem_random_range(x_in, -20.0, 20.0, &status);
+    oskar_mem_random_range(y_in, -20.0, 20.0, &status);
+    oskar_mem_set_value_real(z_in_, z_in, 0, num_in, &status);
+    oskar_evaluate_image_lmn_grid(side, side, M_PI, M_PI, 0,
+            x_out, y_out, z_out, &status);
+    oskar_Mem* x_in_d = oskar_mem_convert_precision(x_in, OSKAR_DOUBLE,
+            &status);
+    oskar_Mem* y_in_d = oskar_mem_convert_precision(y_in, OSKAR_DOUBLE,
+            &status);
+    oskar_Mem* w_d = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            num_in, &status);
+    for (int i = 0; i < num_in; ++i)
+    {
+        double p = -wavenumber * (0.2 * oskar_mem_double(x_in_d, &status)[i] +
+                0.1 * oskar_mem_double(y_in_d, &status)[i]);
+        oskar_mem_double(w_d, &status)[2*i] = cos(p);
+        oskar_mem_double(w_d, &status)[2*i + 1] = sin(p);
+    }
+    oskar_Mem* weights = oskar_mem_convert_precision(w_d, prec, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Make sure the NUFFT is actually used for this problem.
+    EXPECT_LT(oskar_nufft_type3_2d_relative_cost(num_in, num_out,
+            20.0, 20.0, wavenumber, wavenumber, tol), 1.0);
+
+    oskar_dftw(num_in, wavenumber, x_in, y_in, z_in_, weights,
+            num_out, x_out, y_out, z_out, 0, out_dft, &status);
+    oskar_dftw_nufft(num_in, wavenumber, x_in, y_in, z_in_, weights,
+            num_out, x_out, y_out, z_out, tol, out_nufft, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_Mem* a = oskar_mem_convert_precision(out_dft, OSKAR_DOUBLE,
+            &status);
+    oskar_Mem* b = oskar_mem_convert_precision(out_nufft, OSKAR_DOUBLE,
+            &status);
+    const double *a_ = oskar_mem_double_const(a, &status);
+    const double *b_ = oskar_mem_double_const(b, &status);
+    double max_err = 0.0, max_val = 0.0;
+    for (int k = 0; k < num_out; ++k)
+    {
+        // Points beyond the horizon are NaN in both.
+        if (a_[2*k] != a_[2*k])
+        {
+            EXPECT_NE(b_[2*k], b_[2*k]);
+            continue;
+        }
+        max_err = std::max(max_err, sqrt(pow(a_[2*k] - b_[2*k], 2) +
+                pow(a_[2*k + 1] - b_[2*k + 1], 2)));
+        max_val = std::max(max_val,
+                sqrt(a_[2*k] * a_[2*k] + a_[2*k + 1] * a_[2*k + 1]));
+    }
+    EXPECT_LT(max_err / max_val, max_rel_err) << "precision " << prec <<
+            ", tolerance " << tol << ", z " << z_in;
+
+    oskar_mem_free(a, &status);
+    oskar_mem_free(b, &status);
+    oskar_mem_free(x_in_d, &status);
+    oskar_mem_free(y_in_d, &status);
+    oskar_mem_free(w_d, &status);
+    oskar_mem_free(x_in, &status);
+    oskar_mem_free(y_in, &status);
+    oskar_mem_free(z_in_, &status);
+    oskar_mem_free(weights, &status);
+    oskar_mem_free(x_out, &status);
+    oskar_mem_free(y_out, &status);
+    oskar_mem_free(z_out, &status);
+    oskar_mem_free(out_dft, &status);
+    oskar_mem_free(out_nufft, &status);
+}
+
+TEST(dft, dftw_nufft)
+{
+    check_dftw_nufft(OSKAR_DOUBLE, 4000, 128, 0.0, 1e-6, 1e-6);
+    check_dftw_nufft(OSKAR_DOUBLE, 4000, 128, 1.5, 1e-10, 1e-10);
+    check_dftw_nufft(OSKAR_SINGLE, 4000, 128, 0.0, 1e-4, 1e-4);
+}
+
+TEST(dft, dftw_nufft_fallback)
+{
+    // Small problems must give exactly the same result as the DFT.
+    int status = 0, num_in = 10, num_out = 20;
+    double wavenumber = 2.0 * M_PI;
+    oskar_Mem *x_in, *y_in, *weights, *x_out, *y_out, *out_dft, *out_nufft;
+    x_in = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_in, &status);
+    y_in = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_in, &status);
+    weights = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU, num_in,
+            &status);
+    x_out = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_out, &status);
+    y_out = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_out, &status);
+    out_dft = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU, num_out,
+            &status);
+    out_nufft = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU, num_out,
+            &status);
+    oskar_mem_random_range(x_in, -5.0, 5.0, &status);
+    oskar_mem_random_range(y_in, -5.0, 5.0, &status);
+    oskar_mem_random_range(weights, -1.0, 1.0, &status);
+    oskar_mem_random_range(x_out, -1.0, 1.0, &status);
+    oskar_mem_random_range(y_out, -1.0, 1.0, &status);
+    oskar_dftw(num_in, wavenumber, x_in, y_in, 0, weights,
+            num_out, x_out, y_out, 0, 0, out_dft, &status);
+    oskar_dftw_nufft(num_in, wavenumber, x_in, y_in, 0, weights,
+            num_out, x_out, y_out, 0, 1e-6, out_nufft, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const double* a = oskar_mem_double_const(out_dft, &status);
+    const double* b = oskar_mem_double_const(out_nufft, &status);
+    for (int i = 0; i < 2 * num_out; ++i)
+        EXPECT_DOUBLE_EQ(a[i], b[i]);
+    oskar_mem_free(x_in, &status);
+    oskar_mem_free(y_in, &status);
+    oskar_mem_free(weights, &status);
+    oskar_mem_free(x_out, &status);
+    oskar_mem_free(y_out, &status);
+    oskar_mem_free(out_dft, &status);
+    oskar_mem_free(out_nufft, &status);
+}
+
+TEST(dft, c2r_separable)
+{
+    int status = 0;
+    const int num_in = 1000, num_x = 150, num_y = 37;
+    const double wavenumber = 2.0 * M_PI * 100e6 / 299792458.0;
+    const double delta = sin(0.04 / num_x);
+    std::vector<double> u(num_in), v(num_in), wt(num_in), amp(2 * num_in);
+    std::vector<double> x(num_x), y(num_y), x_grid(num_x * num_y);
+    std::vector<double> y_grid(num_x * num_y);
+    std::vector<double> out_d(num_x * num_y), sep_d(num_x * num_y);
+    std::vector<float> uf(num_in), vf(num_in), wtf(num_in), ampf(2 * num_in);
+    std::vector<float> xf(num_x), yf(num_y), x_gridf(num_x * num_y);
+    std::vector<float> y_gridf(num_x * num_y);
+    std::vector<float> out_f(num_x * num_y), sep_f(num_x * num_y);
+
+    // Generate input data and the output grid.
+    srand(1);
+    for (int i = 0; i < num_in; ++i)
+    {
+        uf[i] = u[i] = 2000.0 * (rand() / (double)RAND_MAX - 0.5);
+        vf[i] = v[i] = 2000.0 * (rand() / (double)RAND_MAX - 0.5);
+        wtf[i] = wt[i] = rand() / (double)RAND_MAX;
+        ampf[2*i] = amp[2*i] = rand() / (double)RAND_MAX - 0.5;
+        ampf[2*i+1] = amp[2*i+1] = rand() / (double)RAND_MAX - 0.5;
+    }
+    for (int i = 0; i < num_x; ++i) xf[i] = x[i] = (num_x / 2 - i) * delta;
+    for (int j = 0; j < num_y; ++j) yf[j] = y[j] = (j - num_y / 2) * delta;
+    for (int j = 0, p = 0; j < num_y; ++j)
+    {
+        for (int i = 0; i < num_x; ++i, ++p)
+        {
+            x_gridf[p] = x_grid[p] = x[i];
+            y_gridf[p] = y_grid[p] = y[j];
+        }
+    }
+
+    // Compare the separable DFT with the direct DFT.
+    oskar_dft_c2r_2d_omp_d(num_in, wavenumber, &u[0], &v[0],
+            (const double2*) &amp[0], &wt[0], num_x * num_y,
+            &x_grid[0], &y_grid[0], &out_d[0]);
+    std::vector<double> col_d(2 * num_in * num_x);
+    std::vector<float> col_f(2 * num_in * num_x);
+    oskar_dft_c2r_2d_separable_columns_d(num_in, wavenumber, &u[0],
+            num_x, &x[0], &col_d[0], &col_d[num_in * num_x]);
+    oskar_dft_c2r_2d_separable_omp_d(num_in, wavenumber, &v[0],
+            (const double2*) &amp[0], &wt[0], num_x, &col_d[0],
+            &col_d[num_in * num_x], num_y, &y[0], &sep_d[0], &status);
+    oskar_dft_c2r_2d_omp_f(num_in, (float) wavenumber, &uf[0], &vf[0],
+            (const float2*) &ampf[0], &wtf[0], num_x * num_y,
+            &x_gridf[0], &y_gridf[0], &out_f[0]);
+    oskar_dft_c2r_2d_separable_columns_f(num_in, (float) wavenumber, &uf[0],
+            num_x, &xf[0], &col_f[0], &col_f[num_in * num_x]);
+    oskar_dft_c2r_2d_separable_omp_f(num_in, (float) wavenumber, &vf[0],
+            (const float2*) &ampf[0], &wtf[0], num_x, &col_f[0],
+            &col_f[num_in * num_x], num_y, &yf[0], &sep_f[0], &status);
+    ASSERT_EQ(0, status);
+    for (int i = 0; i < num_x * num_y; ++i)
+    {
+        ASSERT_NEAR(out_d[i], sep_d[i], 1e-9);
+        ASSERT_NEAR(out_f[i], sep_f[i], 1e-2);
+    }
+}
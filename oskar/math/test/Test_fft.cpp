@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "math/oskar_fft.h"
+#include "math/oskar_fftpack_cfft.h"
+#include "math/oskar_fftpack_cfft_f.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <cmath>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static void check_fft_2d(int prec, int size, int num_threads, double tol)
+{
+    int status = 0;
+    const int num_cells = size * size;
+    const int len_save = 4 * size + 2 * (int)(log((double)size) / log(2.0)) + 8;
+#ifdef _OPENMP
+    omp_set_num_threads(num_threads);
+#else
+    (void) num_threads;
+#endif
+
+    // Create test data.
+    oskar_Mem* data = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+            num_cells, &status);
+    oskar_mem_random_range(data, -1.0, 1.0, &status);
+    oskar_Mem* ref = oskar_mem_create_copy(data, OSKAR_CPU, &status);
+
+    // Transform using FFTPACK, then remove its normalisation.
+    std::vector<double> wsave_d(len_save), work_d(2 * num_cells);
+    std::vector<float> wsave_f(len_save), work_f(2 * num_cells);
+    if (prec == OSKAR_DOUBLE)
+    {
+        oskar_fftpack_cfft2i(size, size, &wsave_d[0]);
+        oskar_fftpack_cfft2f(size, size, size, oskar_mem_double(ref, &status),
+                &wsave_d[0], &work_d[0]);
+    }
+    else
+    {
+        oskar_fftpack_cfft2i_f(size, size, &wsave_f[0]);
+        oskar_fftpack_cfft2f_f(size, size, size, oskar_mem_float(ref, &status),
+                &wsave_f[0], &work_f[0]);
+    }
+    oskar_mem_scale_real(ref, (double)num_cells, &status);
+
+    // Transform using the FFT plan.
+    oskar_FFT* fft = oskar_fft_create(prec, OSKAR_CPU, 2, size, 0, &status);
+    oskar_fft_exec(fft, data, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Compare.
+    double max_err = 0.0, max_val = 0.0;
+    for (int i = 0; i < 2 * num_cells; ++i)
+    {
+        double a, b;
+        if (prec == OSKAR_DOUBLE)
+        {
+            a = oskar_mem_double(data, &status)[i];
+            b = oskar_mem_double(ref, &status)[i];
+        }
+        else
+        {
+            a = oskar_mem_float(data, &status)[i];
+            b = oskar_mem_float(ref, &status)[i];
+        }
+        if (fabs(a - b) > max_err) max_err = fabs(a - b);
+        if (fabs(b) > max_val) max_val = fabs(b);
+    }
+    EXPECT_LT(max_err, tol * max_val) << "size " << size;
+
+    // Clean up.
+    oskar_fft_free(fft);
+    oskar_mem_free(data, &status);
+    oskar_mem_free(ref, &status);
+#ifdef _OPENMP
+    omp_set_num_threads(1);
+#endif
+}
+
+TEST(fft, fft_2d_double)
+{
+    const int sizes[] = {64, 90, 100, 128, 150, 256};
+    for (int i = 0; i < (int)(sizeof(sizes) / sizeof(int)); ++i)
+    {
+        check_fft_2d(OSKAR_DOUBLE, sizes[i], 1, 1e-12);
+        check_fft_2d(OSKAR_DOUBLE, sizes[i], 4, 1e-12);
+    }
+}
+
+TEST(fft, fft_2d_single)
+{
+    const int sizes[] = {64, 90, 100, 128, 150, 256};
+    for (int i = 0; i < (int)(sizeof(sizes) / sizeof(int)); ++i)
+    {
+        check_fft_2d(OSKAR_SINGLE, sizes[i], 1, 1e-5);
+        check_fft_2d(OSKAR_SINGLE, sizes[i], 4, 1e-5);
+    }
+}
+
+TEST(fft, fft_1d_batch)
+{
+    int status = 0;
+    const int size = 60, batch = 7;
+
+    // Transform a batch of impulses, each offset by one more sample.
+    oskar_Mem* data = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            size * batch, &status);
+    oskar_mem_clear_contents(data, &status);
+    double* t = oskar_mem_double(data, &status);
+    for (int b = 0; b < batch; ++b) t[2 * (b * size + b)] = 1.0;
+    oskar_FFT* fft = oskar_fft_create(OSKAR_DOUBLE, OSKAR_CPU, 1, size,
+            batch, &status);
+    oskar_fft_exec(fft, data, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check against the analytic result, exp(-2 pi i k b / N).
+    for (int b = 0; b < batch; ++b)
+    {
+        for (int k = 0; k < size; ++k)
+        {
+            const double arg = -2.0 * M_PI * k * b / size;
+            EXPECT_NEAR(cos(arg), t[2 * (b * size + k)], 1e-12);
+            EXPECT_NEAR(sin(arg), t[2 * (b * size + k) + 1], 1e-12);
+        }
+    }
+    oskar_fft_free(fft);
+    oskar_mem_free(data, &status);
+}
@@ -34,6 +34,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cmath>
+#include <vector>
 
 static const bool verbose = false;
 static const bool save = false;
@@ -126,3 +127,20 @@ TEST(random_gaussian, random_gaussian24)
     oskar_mem_free(data4, &status);
     oskar_timer_free(tmr);
 }
+
+TEST(random_gaussian, random_gaussian24_array)
+{
+    // Check that the array versions match the single-call versions.
+    const unsigned int seed = 7, counter0 = 1000, counter1 = 3;
+    const int n = 1000;
+    std::vector<double> ref2(2 * n), ref4(4 * n), arr2(2 * n), arr4(4 * n);
+    for (int i = 0; i < n; ++i)
+    {
+        oskar_random_gaussian2(seed, counter0 + i, counter1, &ref2[2*i]);
+        oskar_random_gaussian4(seed, counter0 + i, counter1, 1, 2, &ref4[4*i]);
+    }
+    oskar_random_gaussian2_array(seed, counter0, counter1, n, &arr2[0]);
+    oskar_random_gaussian4_array(seed, counter0, counter1, 1, 2, n, &arr4[0]);
+    for (int i = 0; i < 2 * n; ++i) ASSERT_EQ(ref2[i], arr2[i]);
+    for (int i = 0; i < 4 * n; ++i) ASSERT_EQ(ref4[i], arr4[i]);
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2017, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -98,6 +98,7 @@ enum OSKAR_MEM_LOCATION
 #include <mem/oskar_mem_evaluate_relative_error.h>
 #include <mem/oskar_mem_free.h>
 #include <mem/oskar_mem_get_element.h>
+#include <mem/oskar_mem_hash.h>
 #include <mem/oskar_mem_load_ascii.h>
 #include <mem/oskar_mem_multiply.h>
 #include <mem/oskar_mem_random_gaussian.h>
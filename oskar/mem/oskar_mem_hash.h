@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_MEM_HASH_H_
+#define OSKAR_MEM_HASH_H_
+
+/**
+ * @file oskar_mem_hash.h
+ */
+
+#include <oskar_global.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Returns a 64-bit hash of the contents of a block of memory.
+ *
+ * @details
+ * This function computes a 64-bit FNV-1a hash of the data type, length and
+ * contents of the array, and combines it with the supplied \p hash value.
+ * Pass 0 for \p hash to start a new hash. This can be used to check
+ * cheaply whether the contents of arrays are likely to be the same.
+ *
+ * If \p num_elements is greater than zero, then only this number of
+ * elements are hashed. A NULL array has a well-defined hash.
+ * Data not in CPU memory are copied to the host first.
+ *
+ * @param[in] mem           Pointer to data structure (may be NULL).
+ * @param[in] num_elements  Number of elements to hash (0 hashes all).
+ * @param[in] hash          Hash value to combine with (0 to start).
+ * @param[in,out] status    Status return code.
+ *
+ * @return The combined hash value.
+ */
+OSKAR_EXPORT
+unsigned long long oskar_mem_hash(const oskar_Mem* mem, size_t num_elements,
+        unsigned long long hash, int* status);
+
+/**
+ * @brief
+ * Returns a 64-bit hash of a block of raw bytes.
+ *
+ * @details
+ * This function combines the 64-bit FNV-1a hash of the given bytes with the
+ * supplied \p hash value. Pass 0 for \p hash to start a new hash.
+ *
+ * @param[in] data          Pointer to data.
+ * @param[in] num_bytes     Number of bytes to hash.
+ * @param[in] hash          Hash value to combine with (0 to start).
+ *
+ * @return The combined hash value.
+ */
+OSKAR_EXPORT
+unsigned long long oskar_mem_hash_raw(const void* data, size_t num_bytes,
+        unsigned long long hash);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_MEM_HASH_H_ */
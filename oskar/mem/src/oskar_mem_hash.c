@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/oskar_mem.h"
+#include "mem/private_mem.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+unsigned long long oskar_mem_hash_raw(const void* data, size_t num_bytes,
+        unsigned long long hash)
+{
+    size_t i;
+    const unsigned char* p = (const unsigned char*) data;
+    if (hash == 0) hash = FNV_OFFSET_BASIS;
+    for (i = 0; i < num_bytes; ++i)
+    {
+        hash ^= p[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+unsigned long long oskar_mem_hash(const oskar_Mem* mem, size_t num_elements,
+        unsigned long long hash, int* status)
+{
+    int header[2];
+    oskar_Mem* temp = 0;
+    const oskar_Mem* src;
+
+    /* Check if safe to proceed. */
+    if (*status) return hash;
+
+    /* Hash the data type and number of elements. */
+    if (!mem)
+    {
+        header[0] = header[1] = 0;
+        return oskar_mem_hash_raw(header, sizeof(header), hash);
+    }
+    if (num_elements == 0 || num_elements > mem->num_elements)
+        num_elements = mem->num_elements;
+    header[0] = mem->type;
+    header[1] = (int) num_elements;
+    hash = oskar_mem_hash_raw(header, sizeof(header), hash);
+
+    /* Hash the contents, copying to the host first if necessary. */
+    src = mem;
+    if (mem->location != OSKAR_CPU)
+    {
+        temp = oskar_mem_create_copy(mem, OSKAR_CPU, status);
+        src = temp;
+    }
+    if (!*status)
+        hash = oskar_mem_hash_raw(src->data,
+                num_elements * oskar_mem_element_size(mem->type), hash);
+    oskar_mem_free(temp, status);
+    return hash;
+}
+
+#ifdef __cplusplus
+}
+#endif
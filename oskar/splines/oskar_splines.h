@@ -71,6 +71,7 @@ enum OSKAR_SPLINES_TYPE
 #include <splines/oskar_splines_copy.h>
 #include <splines/oskar_splines_create.h>
 #include <splines/oskar_splines_evaluate.h>
+#include <splines/oskar_splines_evaluate_fused.h>
 #include <splines/oskar_splines_free.h>
 #include <splines/oskar_splines_fit.h>
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2013, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -48,6 +48,10 @@ extern "C" {
  * This function evaluates a surface fitted by splines at the given
  * positions.
  *
+ * Points in CPU memory are evaluated in parallel using OpenMP.
+ * The knot interval search starts from the interval used for the
+ * previous point, so it is fastest if neighbouring points are close together.
+ *
  * @param[out] output     Output values.
  * @param[in] spline      Pointer to data structure.
  * @param[in] x           List of x coordinates.
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_SPLINES_EVALUATE_FUSED_H_
+#define OSKAR_SPLINES_EVALUATE_FUSED_H_
+
+/**
+ * @file oskar_splines_evaluate_fused.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Evaluates several surfaces fitted by splines at the same positions.
+ *
+ * @details
+ * This function evaluates up to 8 surfaces fitted by splines at the
+ * same positions in a single pass over the points.
+ * Surface \p i is written to the \p output array starting at
+ * \p offset + \p i, using the given \p stride.
+ *
+ * If a surface has the same knots as the one before it in the list,
+ * the knot interval search and the B-spline basis functions at each point
+ * are re-used, so only the coefficients need to be applied.
+ * Surfaces fitted separately normally have different knots, so for
+ * element patterns the gain comes mainly from the single pass over the
+ * points rather than from a shared basis.
+ *
+ * Results are identical to those from calling oskar_splines_evaluate()
+ * for each surface in turn, which is done if the data are not in CPU memory.
+ *
+ * @param[out] output      Output values.
+ * @param[in] offset       Index of first output value for the first surface.
+ * @param[in] stride       Stride through the output array.
+ * @param[in] num_splines  Number of surfaces to evaluate (at most 8).
+ * @param[in] splines      Array of pointers to the surfaces to evaluate.
+ * @param[in] num_points   Number of positions.
+ * @param[in] x            List of x coordinates.
+ * @param[in] y            List of y coordinates.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_splines_evaluate_fused(oskar_Mem* output, int offset, int stride,
+        int num_splines, const oskar_Splines* const* splines, int num_points,
+        const oskar_Mem* x, const oskar_Mem* y, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_SPLINES_EVALUATE_FUSED_H_ */
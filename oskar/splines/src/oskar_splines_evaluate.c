@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2015, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -26,8 +26,8 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include "splines/oskar_dierckx_bispev.h"
 #include "splines/oskar_dierckx_bispev_bicubic_cuda.h"
+#include "splines/oskar_dierckx_fpbspl.h"
 #include "splines/oskar_splines.h"
 #include "utility/oskar_device_utils.h"
 
@@ -35,6 +35,91 @@
 extern "C" {
 #endif
 
+/*
+ * Updates the (one-based) knot interval L containing ARG, after clamping
+ * ARG to the valid range. The interval used for the previous point is
+ * checked first, so points in order (such as those on a grid) need only
+ * two comparisons; otherwise a binary search is used.
+ * This gives the same interval as fpbisp.
+ */
+#define HUNT_INTERVAL(T, NK1, ARG, L) { \
+        if (ARG < T[3]) ARG = T[3]; \
+        if (ARG > T[NK1]) ARG = T[NK1]; \
+        if (ARG < T[L - 1] || !(ARG < T[L] || L == NK1)) { \
+            int lo_ = 4, hi_ = NK1; \
+            while (lo_ < hi_) { \
+                const int mid_ = (lo_ + hi_) >> 1; \
+                if (ARG < T[mid_]) hi_ = mid_; else lo_ = mid_ + 1; } \
+            L = lo_; } }
+
+static void evaluate_f(const float* tx, int nx, const float* ty, int ny,
+        const float* c, int num_points, const float* x, const float* y,
+        int stride, float* out)
+{
+    int i;
+    #pragma omp parallel private(i)
+    {
+        /* Thread-local workspace. */
+        int lx = 4, ly = 4;
+        float hx[6], hy[6];
+        #pragma omp for schedule(static)
+        for (i = 0; i < num_points; ++i)
+        {
+            int i1, j1;
+            float arg, sp = 0.0f;
+            const float* c_;
+            arg = x[i];
+            HUNT_INTERVAL(tx, nx - 4, arg, lx)
+            oskar_dierckx_fpbspl_f(tx, 3, arg, lx, hx);
+            arg = y[i];
+            HUNT_INTERVAL(ty, ny - 4, arg, ly)
+            oskar_dierckx_fpbspl_f(ty, 3, arg, ly, hy);
+            c_ = c + (lx - 4) * (ny - 4) + (ly - 4);
+            for (i1 = 0; i1 < 4; ++i1)
+            {
+                for (j1 = 0; j1 < 4; ++j1)
+                    sp += c_[j1] * hx[i1] * hy[j1];
+                c_ += (ny - 4);
+            }
+            out[i * stride] = sp;
+        }
+    }
+}
+
+static void evaluate_d(const double* tx, int nx, const double* ty, int ny,
+        const double* c, int num_points, const double* x, const double* y,
+        int stride, double* out)
+{
+    int i;
+    #pragma omp parallel private(i)
+    {
+        /* Thread-local workspace. */
+        int lx = 4, ly = 4;
+        double hx[6], hy[6];
+        #pragma omp for schedule(static)
+        for (i = 0; i < num_points; ++i)
+        {
+            int i1, j1;
+            double arg, sp = 0.0;
+            const double* c_;
+            arg = x[i];
+            HUNT_INTERVAL(tx, nx - 4, arg, lx)
+            oskar_dierckx_fpbspl_d(tx, 3, arg, lx, hx);
+            arg = y[i];
+            HUNT_INTERVAL(ty, ny - 4, arg, ly)
+            oskar_dierckx_fpbspl_d(ty, 3, arg, ly, hy);
+            c_ = c + (lx - 4) * (ny - 4) + (ly - 4);
+            for (i1 = 0; i1 < 4; ++i1)
+            {
+                for (j1 = 0; j1 < 4; ++j1)
+                    sp += c_[j1] * hx[i1] * hy[j1];
+                c_ += (ny - 4);
+            }
+            out[i * stride] = sp;
+        }
+    }
+}
+
 void oskar_splines_evaluate(oskar_Mem* output, int offset, int stride,
         const oskar_Splines* spline, int num_points, const oskar_Mem* x,
         const oskar_Mem* y, int* status)
@@ -94,24 +179,8 @@ void oskar_splines_evaluate(oskar_Mem* output, int offset, int stride,
             }
             else
             {
-                /* Set up workspace. */
-                float x1, y1, wrk[8];
-                int iwrk1[2], kwrk1 = 2, lwrk = 8, err = 0;
-
-                /* Evaluate surface at the points. */
-                for (i = 0; i < num_points; ++i)
-                {
-                    x1 = x_[i];
-                    y1 = y_[i];
-                    oskar_dierckx_bispev_f(tx, nx, ty, ny, coeff, 3, 3,
-                            &x1, 1, &y1, 1, &out[i * stride],
-                            wrk, lwrk, iwrk1, kwrk1, &err);
-                    if (err != 0)
-                    {
-                        *status = OSKAR_ERR_SPLINE_EVAL_FAIL;
-                        return;
-                    }
-                }
+                evaluate_f(tx, nx, ty, ny, coeff, num_points, x_, y_,
+                        stride, out);
             }
         }
         else if (location == OSKAR_GPU)
@@ -154,24 +223,8 @@ void oskar_splines_evaluate(oskar_Mem* output, int offset, int stride,
             }
             else
             {
-                /* Set up workspace. */
-                double x1, y1, wrk[8];
-                int iwrk1[2], kwrk1 = 2, lwrk = 8, err = 0;
-
-                /* Evaluate surface at the points. */
-                for (i = 0; i < num_points; ++i)
-                {
-                    x1 = x_[i];
-                    y1 = y_[i];
-                    oskar_dierckx_bispev_d(tx, nx, ty, ny, coeff, 3, 3,
-                            &x1, 1, &y1, 1, &out[i * stride],
-                            wrk, lwrk, iwrk1, kwrk1, &err);
-                    if (err != 0)
-                    {
-                        *status = OSKAR_ERR_SPLINE_EVAL_FAIL;
-                        return;
-                    }
-                }
+                evaluate_d(tx, nx, ty, ny, coeff, num_points, x_, y_,
+                        stride, out);
             }
         }
         else if (location == OSKAR_GPU)
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "splines/private_splines.h"
+#include "splines/oskar_splines.h"
+#include "splines/oskar_splines_evaluate_fused.h"
+#include "splines/oskar_dierckx_fpbspl.h"
+
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MAX_SPLINES 8
+
+/*
+ * Returns the (one-based) knot interval containing arg, matching the linear
+ * search done by fpbisp, after clamping arg to the valid range.
+ */
+#define FIND_INTERVAL(T, NK1, ARG, L) { \
+        int lo_ = 4, hi_ = NK1; \
+        if (ARG < T[3]) ARG = T[3]; \
+        if (ARG > T[NK1]) ARG = T[NK1]; \
+        while (lo_ < hi_) { \
+            const int mid_ = (lo_ + hi_) >> 1; \
+            if (ARG < T[mid_]) hi_ = mid_; else lo_ = mid_ + 1; } \
+        L = lo_; }
+
+static void evaluate_fused_f(float* out, int stride, int num_splines,
+        const int* nx, const int* ny, const float* const* tx,
+        const float* const* ty, const float* const* c, const int* same_knots,
+        int num_points, const float* x, const float* y)
+{
+    int i;
+    #pragma omp parallel for private(i)
+    for (i = 0; i < num_points; ++i)
+    {
+        int s, lx = 0, ly = 0;
+        float hx[6], hy[6];
+        for (s = 0; s < num_splines; ++s)
+        {
+            int i1, j1;
+            float sp = 0.0f;
+            const float* c_ = c[s];
+            if (!c_)
+            {
+                out[i * stride + s] = 0.0f;
+                continue;
+            }
+            if (!same_knots[s])
+            {
+                int l;
+                float arg = x[i];
+                FIND_INTERVAL(tx[s], nx[s] - 4, arg, l)
+                oskar_dierckx_fpbspl_f(tx[s], 3, arg, l, hx);
+                lx = l - 4;
+                arg = y[i];
+                FIND_INTERVAL(ty[s], ny[s] - 4, arg, l)
+                oskar_dierckx_fpbspl_f(ty[s], 3, arg, l, hy);
+                ly = l - 4;
+            }
+            c_ += lx * (ny[s] - 4) + ly;
+            for (i1 = 0; i1 < 4; ++i1)
+            {
+                for (j1 = 0; j1 < 4; ++j1)
+                    sp += c_[j1] * hx[i1] * hy[j1];
+                c_ += (ny[s] - 4);
+            }
+            out[i * stride + s] = sp;
+        }
+    }
+}
+
+static void evaluate_fused_d(double* out, int stride, int num_splines,
+        const int* nx, const int* ny, const double* const* tx,
+        const double* const* ty, const double* const* c, const int* same_knots,
+        int num_points, const double* x, const double* y)
+{
+    int i;
+    #pragma omp parallel for private(i)
+    for (i = 0; i < num_points; ++i)
+    {
+        int s, lx = 0, ly = 0;
+        double hx[6], hy[6];
+        for (s = 0; s < num_splines; ++s)
+        {
+            int i1, j1;
+            double sp = 0.0;
+            const double* c_ = c[s];
+            if (!c_)
+            {
+                out[i * stride + s] = 0.0;
+                continue;
+            }
+            if (!same_knots[s])
+            {
+                int l;
+                double arg = x[i];
+                FIND_INTERVAL(tx[s], nx[s] - 4, arg, l)
+                oskar_dierckx_fpbspl_d(tx[s], 3, arg, l, hx);
+                lx = l - 4;
+                arg = y[i];
+                FIND_INTERVAL(ty[s], ny[s] - 4, arg, l)
+                oskar_dierckx_fpbspl_d(ty[s], 3, arg, l, hy);
+                ly = l - 4;
+            }
+            c_ += lx * (ny[s] - 4) + ly;
+            for (i1 = 0; i1 < 4; ++i1)
+            {
+                for (j1 = 0; j1 < 4; ++j1)
+                    sp += c_[j1] * hx[i1] * hy[j1];
+                c_ += (ny[s] - 4);
+            }
+            out[i * stride + s] = sp;
+        }
+    }
+}
+
+void oskar_splines_evaluate_fused(oskar_Mem* output, int offset, int stride,
+        int num_splines, const oskar_Splines* const* splines, int num_points,
+        const oskar_Mem* x, const oskar_Mem* y, int* status)
+{
+    int i, type, nx[MAX_SPLINES], ny[MAX_SPLINES], same_knots[MAX_SPLINES];
+    const void *tx[MAX_SPLINES], *ty[MAX_SPLINES], *c[MAX_SPLINES];
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+    if (num_splines < 1 || num_splines > MAX_SPLINES)
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return;
+    }
+
+    /* Evaluate each surface separately unless everything is on the CPU. */
+    type = oskar_splines_precision(splines[0]);
+    for (i = 0; i < num_splines; ++i)
+    {
+        if (oskar_splines_mem_location(splines[i]) != OSKAR_CPU ||
+                oskar_splines_precision(splines[i]) != type)
+            break;
+    }
+    if (i < num_splines || oskar_mem_location(output) != OSKAR_CPU ||
+            oskar_mem_location(x) != OSKAR_CPU ||
+            oskar_mem_location(y) != OSKAR_CPU)
+    {
+        for (i = 0; i < num_splines; ++i)
+            oskar_splines_evaluate(output, offset + i, stride, splines[i],
+                    num_points, x, y, status);
+        return;
+    }
+
+    /* Check types. */
+    if (type != oskar_mem_type(x) || type != oskar_mem_type(y) ||
+            type != oskar_mem_precision(output))
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+
+    /* Get the surface data, and find which surfaces can share a basis. */
+    for (i = 0; i < num_splines; ++i)
+    {
+        const oskar_Splines* s = splines[i];
+        nx[i] = s->num_knots_x_theta;
+        ny[i] = s->num_knots_y_phi;
+        tx[i] = oskar_mem_void_const(s->knots_x_theta);
+        ty[i] = oskar_mem_void_const(s->knots_y_phi);
+        c[i] = oskar_mem_void_const(s->coeff);
+        if (nx[i] == 0 || ny[i] == 0 || !tx[i] || !ty[i])
+            c[i] = 0;
+        same_knots[i] = 0;
+        if (i > 0 && c[i] && c[i - 1] && nx[i] == nx[i - 1] &&
+                ny[i] == ny[i - 1])
+        {
+            const size_t e = oskar_mem_element_size(type);
+            same_knots[i] = !memcmp(tx[i], tx[i - 1], nx[i] * e) &&
+                    !memcmp(ty[i], ty[i - 1], ny[i] * e);
+        }
+    }
+
+    /* Evaluate the surfaces. */
+    if (type == OSKAR_SINGLE)
+        evaluate_fused_f(oskar_mem_float(output, status) + offset, stride,
+                num_splines, nx, ny, (const float* const*)tx,
+                (const float* const*)ty, (const float* const*)c, same_knots,
+                num_points, oskar_mem_float_const(x, status),
+                oskar_mem_float_const(y, status));
+    else if (type == OSKAR_DOUBLE)
+        evaluate_fused_d(oskar_mem_double(output, status) + offset, stride,
+                num_splines, nx, ny, (const double* const*)tx,
+                (const double* const*)ty, (const double* const*)c, same_knots,
+                num_points, oskar_mem_double_const(x, status),
+                oskar_mem_double_const(y, status));
+    else
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2016, The University of Oxford
+ * Copyright (c) 2013-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -58,6 +58,7 @@ enum OSKAR_POL_MODE_TYPE
 #include <telescope/station/oskar_station.h>
 #include <telescope/oskar_telescope_accessors.h>
 #include <telescope/oskar_telescope_analyse.h>
+#include <telescope/oskar_telescope_cache.h>
 #include <telescope/oskar_telescope_create.h>
 #include <telescope/oskar_telescope_create_copy.h>
 #include <telescope/oskar_telescope_duplicate_first_station.h>
@@ -76,5 +77,6 @@ enum OSKAR_POL_MODE_TYPE
 #include <telescope/oskar_telescope_set_station_coords_ecef.h>
 #include <telescope/oskar_telescope_set_station_coords_enu.h>
 #include <telescope/oskar_telescope_set_station_coords_wgs84.h>
+#include <telescope/oskar_telescope_tabulate_element_patterns.h>
 
 #endif /* OSKAR_TELESCOPE_H_ */
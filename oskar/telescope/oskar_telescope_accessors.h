@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2016, The University of Oxford
+ * Copyright (c) 2013-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -344,6 +344,21 @@ int oskar_telescope_allow_station_beam_duplication(
 OSKAR_EXPORT
 int oskar_telescope_enable_numerical_patterns(const oskar_Telescope* model);
 
+/**
+ * @brief
+ * Returns the flag specifying whether the loaded model is cached.
+ *
+ * @details
+ * Returns the flag specifying whether the model loaded by
+ * oskar_telescope_load() is cached in the telescope model directory.
+ *
+ * @param[in] model   Pointer to telescope model.
+ *
+ * @return The boolean flag value.
+ */
+OSKAR_EXPORT
+int oskar_telescope_enable_model_cache(const oskar_Telescope* model);
+
 /**
  * @brief
  * Returns the maximum number of elements in a station.
@@ -837,6 +852,23 @@ OSKAR_EXPORT
 void oskar_telescope_set_enable_numerical_patterns(oskar_Telescope* model,
         int value);
 
+/**
+ * @brief
+ * Sets the flag to specify whether the loaded model is cached.
+ *
+ * @details
+ * If set, oskar_telescope_load() saves a binary snapshot of the loaded
+ * model in the telescope model directory, and uses it instead of
+ * loading the directory again while neither the directory contents nor
+ * the options that affect loading have changed.
+ *
+ * @param[in] model    Pointer to telescope model.
+ * @param[in] value    If true, the loaded model will be cached.
+ */
+OSKAR_EXPORT
+void oskar_telescope_set_enable_model_cache(oskar_Telescope* model,
+        int value);
+
 /**
  * @brief
  * Sets the Gaussian station beam parameters.
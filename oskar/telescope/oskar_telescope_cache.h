@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_TELESCOPE_CACHE_H_
+#define OSKAR_TELESCOPE_CACHE_H_
+
+/**
+ * @file oskar_telescope_cache.h
+ */
+
+#include <oskar_global.h>
+
+/* Name of the cache file written in the telescope model directory. */
+#define OSKAR_TELESCOPE_CACHE_NAME ".oskar_telescope_cache"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Returns a hash of everything used to load a telescope model.
+ *
+ * @details
+ * This function returns a 64-bit hash of the names and contents of all
+ * the files in the telescope model directory tree at \p path, together
+ * with the options in the telescope model that affect how it is loaded
+ * (precision, polarisation mode, and the numerical element pattern and
+ * noise flags). The cache file itself is excluded.
+ *
+ * The hash identifies a cache written by oskar_telescope_cache_write(),
+ * so that an out-of-date cache is never used.
+ *
+ * @param[in] telescope  Telescope model, before loading.
+ * @param[in] path       Path to the telescope model directory.
+ * @param[in,out] status Status return code.
+ *
+ * @return The hash value.
+ */
+OSKAR_EXPORT
+unsigned long long oskar_telescope_cache_hash(const oskar_Telescope* telescope,
+        const char* path, int* status);
+
+/**
+ * @brief
+ * Reads a telescope model from a binary cache file.
+ *
+ * @details
+ * This function replaces the stations, station coordinates and telescope
+ * position in \p telescope with those stored in the cache file, if it
+ * exists, is valid, and was written with the same \p hash and format
+ * version on a machine with the same byte order.
+ *
+ * The file is read in a single block and checked against its stored
+ * checksum before any data are used, so a missing, stale or damaged cache
+ * leaves the telescope model unchanged and is not treated as an error.
+ *
+ * @param[in,out] telescope  Telescope model in CPU memory.
+ * @param[in] filename       Path to the cache file.
+ * @param[in] hash           Hash from oskar_telescope_cache_hash().
+ * @param[in,out] status     Status return code.
+ *
+ * @return True if the telescope model was read from the cache.
+ */
+OSKAR_EXPORT
+int oskar_telescope_cache_read(oskar_Telescope* telescope,
+        const char* filename, unsigned long long hash, int* status);
+
+/**
+ * @brief
+ * Writes a loaded telescope model to a binary cache file.
+ *
+ * @details
+ * This function writes the stations (including all element data and
+ * fitted element pattern splines), station coordinates and telescope
+ * position to a versioned binary file that can be read back using
+ * oskar_telescope_cache_read().
+ *
+ * All records in the file are aligned to 8-byte boundaries, so it can be
+ * read or memory-mapped as a single block. Consecutive sibling stations
+ * that are identical are stored only once.
+ * The file is written to a temporary name first, and then renamed.
+ *
+ * @param[in] telescope  Telescope model in CPU memory.
+ * @param[in] filename   Path to the cache file.
+ * @param[in] hash       Hash from oskar_telescope_cache_hash().
+ * @param[in,out] status Status return code.
+ */
+OSKAR_EXPORT
+void oskar_telescope_cache_write(const oskar_Telescope* telescope,
+        const char* filename, unsigned long long hash, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_TELESCOPE_CACHE_H_ */
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_TELESCOPE_TABULATE_ELEMENT_PATTERNS_H_
+#define OSKAR_TELESCOPE_TABULATE_ELEMENT_PATTERNS_H_
+
+/**
+ * @file oskar_telescope_tabulate_element_patterns.h
+ */
+
+#include <oskar_global.h>
+#include <log/oskar_log.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Samples all numerical element patterns onto look-up tables.
+ *
+ * @details
+ * Calls oskar_element_tabulate() for every element model in every station
+ * of the telescope (including child stations) that has fitted data,
+ * so that element patterns are evaluated by table interpolation.
+ * Element models that are the same as one already tabulated are copied
+ * rather than sampled again.
+ *
+ * The grid size and the largest interpolation error found for each distinct
+ * element model are written to the log.
+ *
+ * @param[in,out] telescope      Telescope model structure.
+ * @param[in] interp             Interpolation type (enumerator).
+ * @param[in] resolution_rad     Maximum grid spacing, in radians.
+ * @param[in,out] log            Pointer to log.
+ * @param[in,out] status         Status return code.
+ */
+OSKAR_EXPORT
+void oskar_telescope_tabulate_element_patterns(oskar_Telescope* telescope,
+        int interp, double resolution_rad, oskar_Log* log, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_TELESCOPE_TABULATE_ELEMENT_PATTERNS_H_ */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2016, The University of Oxford
+ * Copyright (c) 2011-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -76,6 +76,7 @@ struct oskar_Telescope
     int identical_stations;                           /* True if all stations are identical. */
     int allow_station_beam_duplication;               /* True if station beam duplication is allowed. */
     int enable_numerical_patterns;                    /* True if numerical element patterns are enabled. */
+    int enable_model_cache;                           /* True if the loaded model should be cached. */
 };
 
 #ifndef OSKAR_TELESCOPE_TYPEDEF_
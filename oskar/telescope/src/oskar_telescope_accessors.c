@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2016, The University of Oxford
+ * Copyright (c) 2013-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -145,6 +145,11 @@ int oskar_telescope_enable_numerical_patterns(const oskar_Telescope* model)
     return model->enable_numerical_patterns;
 }
 
+int oskar_telescope_enable_model_cache(const oskar_Telescope* model)
+{
+    return model->enable_model_cache;
+}
+
 int oskar_telescope_max_station_size(const oskar_Telescope* model)
 {
     return model->max_station_size;
@@ -342,6 +347,12 @@ void oskar_telescope_set_enable_numerical_patterns(oskar_Telescope* model,
     model->enable_numerical_patterns = value;
 }
 
+void oskar_telescope_set_enable_model_cache(oskar_Telescope* model,
+        int value)
+{
+    model->enable_model_cache = value;
+}
+
 static void oskar_telescope_set_gaussian_station_beam_p(oskar_Station* station,
         double fwhm_rad, double ref_freq_hz)
 {
@@ -0,0 +1,786 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "telescope/private_telescope.h"
+#include "telescope/oskar_telescope.h"
+#include "telescope/oskar_telescope_cache.h"
+#include "telescope/station/private_station.h"
+#include "telescope/station/element/private_element.h"
+#include "telescope/station/element/private_element_tables.h"
+#include "splines/private_splines.h"
+#include "utility/oskar_dir.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Increment the version if the layout of the cache file changes. */
+#define CACHE_VERSION 2
+#define CACHE_MAGIC "OSKARTMC"
+#define CACHE_BYTE_ORDER 0x0102030405060708ULL
+
+/* Header: magic, version, byte order, hash, payload size, payload hash. */
+#define HEADER_SIZE 48
+
+/* Records are padded to multiples of this number of bytes. */
+#define ALIGN 8
+
+typedef struct
+{
+    char* data;
+    size_t size, capacity;
+    int error;
+} Buffer;
+
+typedef struct
+{
+    const char* data;
+    size_t size, pos;
+    int error;
+} Reader;
+
+/* Writer functions. */
+
+static void put_bytes(Buffer* b, const void* data, size_t bytes)
+{
+    const size_t padded = (bytes + ALIGN - 1) & ~((size_t)ALIGN - 1);
+    if (b->error) return;
+    if (b->size + padded > b->capacity)
+    {
+        char* t;
+        size_t capacity = b->capacity ? 2 * b->capacity : (1 << 20);
+        while (capacity < b->size + padded) capacity *= 2;
+        t = (char*) realloc(b->data, capacity);
+        if (!t)
+        {
+            b->error = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return;
+        }
+        b->data = t;
+        b->capacity = capacity;
+    }
+    if (bytes > 0) memcpy(b->data + b->size, data, bytes);
+    memset(b->data + b->size + bytes, 0, padded - bytes);
+    b->size += padded;
+}
+
+static void put_int(Buffer* b, long long value)
+{
+    put_bytes(b, &value, sizeof(long long));
+}
+
+static void put_double(Buffer* b, double value)
+{
+    put_bytes(b, &value, sizeof(double));
+}
+
+static void put_mem(Buffer* b, const oskar_Mem* mem)
+{
+    const int type = oskar_mem_type(mem);
+    const size_t length = oskar_mem_length(mem);
+    put_int(b, type);
+    put_int(b, (long long) length);
+    put_bytes(b, oskar_mem_void_const(mem),
+            length * oskar_mem_element_size(type));
+}
+
+static void put_splines(Buffer* b, const oskar_Splines* s)
+{
+    put_int(b, s->num_knots_x_theta);
+    put_int(b, s->num_knots_y_phi);
+    put_double(b, s->smoothing_factor);
+    put_mem(b, s->knots_x_theta);
+    put_mem(b, s->knots_y_phi);
+    put_mem(b, s->coeff);
+}
+
+static void put_element(Buffer* b, const oskar_Element* e)
+{
+    int i;
+    put_int(b, e->x_element_type);
+    put_int(b, e->y_element_type);
+    put_int(b, e->x_taper_type);
+    put_int(b, e->y_taper_type);
+    put_int(b, e->x_dipole_length_units);
+    put_int(b, e->y_dipole_length_units);
+    put_double(b, e->x_dipole_length);
+    put_double(b, e->y_dipole_length);
+    put_double(b, e->x_taper_cosine_power);
+    put_double(b, e->y_taper_cosine_power);
+    put_double(b, e->x_taper_gaussian_fwhm_rad);
+    put_double(b, e->y_taper_gaussian_fwhm_rad);
+    put_double(b, e->x_taper_ref_freq_hz);
+    put_double(b, e->y_taper_ref_freq_hz);
+    put_int(b, e->element_type);
+    put_int(b, e->taper_type);
+    put_int(b, e->dipole_length_units);
+    put_double(b, e->dipole_length);
+    put_double(b, e->cosine_power);
+    put_double(b, e->gaussian_fwhm_rad);
+    put_int(b, e->coord_sys);
+    put_double(b, e->max_radius_rad);
+    put_int(b, e->table_interp);
+    put_int(b, e->table_num_theta);
+    put_int(b, e->table_num_phi);
+    put_int(b, e->num_freq);
+    for (i = 0; i < e->num_freq; ++i)
+    {
+        put_double(b, e->freqs_hz[i]);
+        put_mem(b, e->filename_x[i]);
+        put_mem(b, e->filename_y[i]);
+        put_mem(b, e->filename_scalar[i]);
+        put_splines(b, e->x_h_re[i]);
+        put_splines(b, e->x_h_im[i]);
+        put_splines(b, e->x_v_re[i]);
+        put_splines(b, e->x_v_im[i]);
+        put_splines(b, e->y_h_re[i]);
+        put_splines(b, e->y_h_im[i]);
+        put_splines(b, e->y_v_re[i]);
+        put_splines(b, e->y_v_im[i]);
+        put_splines(b, e->scalar_re[i]);
+        put_splines(b, e->scalar_im[i]);
+    }
+    put_int(b, e->tables ? e->tables->num_freq : -1);
+    for (i = 0; e->tables && i < e->tables->num_freq; ++i)
+    {
+        put_mem(b, e->tables->x[i]);
+        put_mem(b, e->tables->y[i]);
+        put_mem(b, e->tables->scalar[i]);
+    }
+}
+
+static void put_stations(Buffer* b, oskar_Station* const* stations, int n);
+
+static void put_station(Buffer* b, const oskar_Station* s)
+{
+    int i;
+    /* The unique ID is not stored, as it is reset after loading. */
+    put_int(b, s->num_elements);
+    put_int(b, s->station_type);
+    put_int(b, s->normalise_final_beam);
+    put_double(b, s->lon_rad);
+    put_double(b, s->lat_rad);
+    put_double(b, s->alt_metres);
+    put_double(b, s->pm_x_rad);
+    put_double(b, s->pm_y_rad);
+    put_double(b, s->beam_lon_rad);
+    put_double(b, s->beam_lat_rad);
+    put_int(b, s->beam_coord_type);
+    put_mem(b, s->noise_freq_hz);
+    put_mem(b, s->noise_rms_jy);
+    put_double(b, s->gaussian_beam_fwhm_rad);
+    put_double(b, s->gaussian_beam_reference_freq_hz);
+    put_int(b, s->identical_children);
+    put_int(b, s->normalise_array_pattern);
+    put_int(b, s->enable_array_pattern);
+    put_double(b, s->nufft_tolerance);
+    put_double(b, s->beam_lut_oversample);
+    put_int(b, s->common_element_orientation);
+    put_int(b, s->array_is_3d);
+    put_int(b, s->apply_element_errors);
+    put_int(b, s->apply_element_weight);
+    put_int(b, s->seed_time_variable_errors);
+    put_mem(b, s->element_true_x_enu_metres);
+    put_mem(b, s->element_true_y_enu_metres);
+    put_mem(b, s->element_true_z_enu_metres);
+    put_mem(b, s->element_measured_x_enu_metres);
+    put_mem(b, s->element_measured_y_enu_metres);
+    put_mem(b, s->element_measured_z_enu_metres);
+    put_mem(b, s->element_gain);
+    put_mem(b, s->element_gain_error);
+    put_mem(b, s->element_phase_offset_rad);
+    put_mem(b, s->element_phase_error_rad);
+    put_mem(b, s->element_weight);
+    put_mem(b, s->element_types);
+    put_mem(b, s->element_types_cpu);
+    put_mem(b, s->element_mount_types_cpu);
+    put_mem(b, s->element_x_alpha_cpu);
+    put_mem(b, s->element_x_beta_cpu);
+    put_mem(b, s->element_x_gamma_cpu);
+    put_mem(b, s->element_y_alpha_cpu);
+    put_mem(b, s->element_y_beta_cpu);
+    put_mem(b, s->element_y_gamma_cpu);
+    put_int(b, s->num_permitted_beams);
+    put_mem(b, s->permitted_beam_az_rad);
+    put_mem(b, s->permitted_beam_el_rad);
+    put_int(b, s->element ? s->num_element_types : -1);
+    for (i = 0; s->element && i < s->num_element_types; ++i)
+        put_element(b, s->element[i]);
+    put_int(b, s->child ? 1 : 0);
+    if (s->child) put_stations(b, s->child, s->num_elements);
+}
+
+static void put_stations(Buffer* b, oskar_Station* const* stations, int n)
+{
+    int i;
+    size_t prev_start = 0, prev_size = 0;
+    for (i = 0; i < n; ++i)
+    {
+        size_t marker, start, size;
+
+        /* Write a marker, followed by the station. */
+        marker = b->size;
+        put_int(b, 0);
+        start = b->size;
+        put_station(b, stations[i]);
+        if (b->error) return;
+        size = b->size - start;
+
+        /* If identical to the previous station, store only the marker. */
+        if (i > 0 && size == prev_size &&
+                !memcmp(b->data + start, b->data + prev_start, size))
+        {
+            const long long copy = 1;
+            b->size = start;
+            memcpy(b->data + marker, &copy, sizeof(long long));
+        }
+        else
+        {
+            prev_start = start;
+            prev_size = size;
+        }
+    }
+}
+
+/* Reader functions. */
+
+static const char* get_bytes(Reader* r, size_t bytes)
+{
+    const char* p;
+    const size_t padded = (bytes + ALIGN - 1) & ~((size_t)ALIGN - 1);
+    if (r->error || padded < bytes || padded > r->size - r->pos)
+    {
+        r->error = 1;
+        return 0;
+    }
+    p = r->data + r->pos;
+    r->pos += padded;
+    return p;
+}
+
+static long long get_int(Reader* r)
+{
+    long long value = 0;
+    const char* p = get_bytes(r, sizeof(long long));
+    if (p) memcpy(&value, p, sizeof(long long));
+    return value;
+}
+
+static double get_double(Reader* r)
+{
+    double value = 0.0;
+    const char* p = get_bytes(r, sizeof(double));
+    if (p) memcpy(&value, p, sizeof(double));
+    return value;
+}
+
+/* Returns a count read from the file, checking it is plausible. */
+static int get_count(Reader* r)
+{
+    const long long value = get_int(r);
+    if (value < 0 || value > (long long) (r->size - r->pos))
+    {
+        r->error = 1;
+        return 0;
+    }
+    return (int) value;
+}
+
+static void get_mem(Reader* r, oskar_Mem* mem, int* status)
+{
+    size_t element_size;
+    const char* p;
+    const int type = (int) get_int(r);
+    const long long length = get_int(r);
+    if (r->error || *status) return;
+    element_size = oskar_mem_element_size(type);
+    if (type != oskar_mem_type(mem) || length < 0 ||
+            (size_t) length > (r->size - r->pos) / element_size)
+    {
+        r->error = 1;
+        return;
+    }
+    p = get_bytes(r, (size_t) length * element_size);
+    if (!p) return;
+    oskar_mem_realloc(mem, (size_t) length, status);
+    if (length > 0 && !*status)
+        memcpy(oskar_mem_void(mem), p, (size_t) length * element_size);
+}
+
+static void get_splines(Reader* r, oskar_Splines* s, int* status)
+{
+    s->num_knots_x_theta = (int) get_int(r);
+    s->num_knots_y_phi = (int) get_int(r);
+    s->smoothing_factor = get_double(r);
+    get_mem(r, s->knots_x_theta, status);
+    get_mem(r, s->knots_y_phi, status);
+    get_mem(r, s->coeff, status);
+}
+
+static void get_element(Reader* r, oskar_Element* e, int* status)
+{
+    int i, num_freq;
+    e->x_element_type = (int) get_int(r);
+    e->y_element_type = (int) get_int(r);
+    e->x_taper_type = (int) get_int(r);
+    e->y_taper_type = (int) get_int(r);
+    e->x_dipole_length_units = (int) get_int(r);
+    e->y_dipole_length_units = (int) get_int(r);
+    e->x_dipole_length = get_double(r);
+    e->y_dipole_length = get_double(r);
+    e->x_taper_cosine_power = get_double(r);
+    e->y_taper_cosine_power = get_double(r);
+    e->x_taper_gaussian_fwhm_rad = get_double(r);
+    e->y_taper_gaussian_fwhm_rad = get_double(r);
+    e->x_taper_ref_freq_hz = get_double(r);
+    e->y_taper_ref_freq_hz = get_double(r);
+    e->element_type = (int) get_int(r);
+    e->taper_type = (int) get_int(r);
+    e->dipole_length_units = (int) get_int(r);
+    e->dipole_length = get_double(r);
+    e->cosine_power = get_double(r);
+    e->gaussian_fwhm_rad = get_double(r);
+    e->coord_sys = (int) get_int(r);
+    e->max_radius_rad = get_double(r);
+    e->table_interp = (int) get_int(r);
+    e->table_num_theta = (int) get_int(r);
+    e->table_num_phi = (int) get_int(r);
+    num_freq = get_count(r);
+    if (r->error) return;
+    oskar_element_resize_freq_data(e, num_freq, status);
+    for (i = 0; i < num_freq && !r->error && !*status; ++i)
+    {
+        e->freqs_hz[i] = get_double(r);
+        get_mem(r, e->filename_x[i], status);
+        get_mem(r, e->filename_y[i], status);
+        get_mem(r, e->filename_scalar[i], status);
+        get_splines(r, e->x_h_re[i], status);
+        get_splines(r, e->x_h_im[i], status);
+        get_splines(r, e->x_v_re[i], status);
+        get_splines(r, e->x_v_im[i], status);
+        get_splines(r, e->y_h_re[i], status);
+        get_splines(r, e->y_h_im[i], status);
+        get_splines(r, e->y_v_re[i], status);
+        get_splines(r, e->y_v_im[i], status);
+        get_splines(r, e->scalar_re[i], status);
+        get_splines(r, e->scalar_im[i], status);
+    }
+    num_freq = (int) get_int(r);
+    if (r->error || *status || num_freq < 0) return;
+    if (num_freq > (int) (r->size - r->pos))
+    {
+        r->error = 1;
+        return;
+    }
+    e->tables = oskar_element_tables_create(e->precision, num_freq, status);
+    for (i = 0; i < num_freq && !r->error && !*status; ++i)
+    {
+        get_mem(r, e->tables->x[i], status);
+        get_mem(r, e->tables->y[i], status);
+        get_mem(r, e->tables->scalar[i], status);
+    }
+}
+
+static void get_stations(Reader* r, oskar_Station** stations, int n,
+        int precision, int* status);
+
+static oskar_Station* get_station(Reader* r, int precision, int* status)
+{
+    int i, num_element_types;
+    oskar_Station* s;
+    const int num_elements = get_count(r);
+    if (r->error || *status) return 0;
+    s = oskar_station_create(precision, OSKAR_CPU, num_elements, status);
+    if (*status) return s;
+    s->station_type = (int) get_int(r);
+    s->normalise_final_beam = (int) get_int(r);
+    s->lon_rad = get_double(r);
+    s->lat_rad = get_double(r);
+    s->alt_metres = get_double(r);
+    s->pm_x_rad = get_double(r);
+    s->pm_y_rad = get_double(r);
+    s->beam_lon_rad = get_double(r);
+    s->beam_lat_rad = get_double(r);
+    s->beam_coord_type = (int) get_int(r);
+    get_mem(r, s->noise_freq_hz, status);
+    get_mem(r, s->noise_rms_jy, status);
+    s->gaussian_beam_fwhm_rad = get_double(r);
+    s->gaussian_beam_reference_freq_hz = get_double(r);
+    s->identical_children = (int) get_int(r);
+    s->normalise_array_pattern = (int) get_int(r);
+    s->enable_array_pattern = (int) get_int(r);
+    s->nufft_tolerance = get_double(r);
+    s->beam_lut_oversample = get_double(r);
+    s->common_element_orientation = (int) get_int(r);
+    s->array_is_3d = (int) get_int(r);
+    s->apply_element_errors = (int) get_int(r);
+    s->apply_element_weight = (int) get_int(r);
+    s->seed_time_variable_errors = (unsigned int) get_int(r);
+    get_mem(r, s->element_true_x_enu_metres, status);
+    get_mem(r, s->element_true_y_enu_metres, status);
+    get_mem(r, s->element_true_z_enu_metres, status);
+    get_mem(r, s->element_measured_x_enu_metres, status);
+    get_mem(r, s->element_measured_y_enu_metres, status);
+    get_mem(r, s->element_measured_z_enu_metres, status);
+    get_mem(r, s->element_gain, status);
+    get_mem(r, s->element_gain_error, status);
+    get_mem(r, s->element_phase_offset_rad, status);
+    get_mem(r, s->element_phase_error_rad, status);
+    get_mem(r, s->element_weight, status);
+    get_mem(r, s->element_types, status);
+    get_mem(r, s->element_types_cpu, status);
+    get_mem(r, s->element_mount_types_cpu, status);
+    get_mem(r, s->element_x_alpha_cpu, status);
+    get_mem(r, s->element_x_beta_cpu, status);
+    get_mem(r, s->element_x_gamma_cpu, status);
+    get_mem(r, s->element_y_alpha_cpu, status);
+    get_mem(r, s->element_y_beta_cpu, status);
+    get_mem(r, s->element_y_gamma_cpu, status);
+    s->num_permitted_beams = (int) get_int(r);
+    get_mem(r, s->permitted_beam_az_rad, status);
+    get_mem(r, s->permitted_beam_el_rad, status);
+    num_element_types = (int) get_int(r);
+    if (r->error || *status) return s;
+    if (num_element_types >= 0)
+    {
+        if (num_element_types > (int) (r->size - r->pos))
+        {
+            r->error = 1;
+            return s;
+        }
+        oskar_station_resize_element_types(s, num_element_types, status);
+        for (i = 0; i < num_element_types && !r->error && !*status; ++i)
+            get_element(r, s->element[i], status);
+    }
+    if (get_int(r) && !r->error && !*status)
+    {
+        s->child = (oskar_Station**) calloc(num_elements,
+                sizeof(oskar_Station*));
+        if (!s->child && num_elements > 0)
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return s;
+        }
+        get_stations(r, s->child, num_elements, precision, status);
+    }
+    return s;
+}
+
+static void get_stations(Reader* r, oskar_Station** stations, int n,
+        int precision, int* status)
+{
+    int i;
+    for (i = 0; i < n && !r->error && !*status; ++i)
+    {
+        const long long marker = get_int(r);
+        if (marker == 1 && i > 0)
+            stations[i] = oskar_station_create_copy(stations[i - 1],
+                    OSKAR_CPU, status);
+        else if (marker == 0)
+            stations[i] = get_station(r, precision, status);
+        else
+            r->error = 1;
+    }
+}
+
+/* Hashes the names and contents of all files in a directory tree. */
+static unsigned long long hash_dir(const char* path, unsigned long long hash,
+        char* buffer, size_t buffer_size)
+{
+    int i, num_files = 0, num_dirs = 0;
+    char **files = 0, **dirs = 0;
+    const size_t cache_name_len = strlen(OSKAR_TELESCOPE_CACHE_NAME);
+    oskar_dir_items(path, NULL, 1, 0, &num_files, &files);
+    for (i = 0; i < num_files; ++i)
+    {
+        char* file_path;
+        FILE* file;
+        if (!strncmp(files[i], OSKAR_TELESCOPE_CACHE_NAME, cache_name_len))
+            continue;
+        hash = oskar_mem_hash_raw(files[i], 1 + strlen(files[i]), hash);
+        file_path = oskar_dir_get_path(path, files[i]);
+        file = fopen(file_path, "rb");
+        if (file)
+        {
+            size_t bytes;
+            while ((bytes = fread(buffer, 1, buffer_size, file)) > 0)
+                hash = oskar_mem_hash_raw(buffer, bytes, hash);
+            fclose(file);
+        }
+        free(file_path);
+    }
+    oskar_dir_items(path, NULL, 0, 1, &num_dirs, &dirs);
+    for (i = 0; i < num_dirs; ++i)
+    {
+        char* dir_path;
+        hash = oskar_mem_hash_raw(dirs[i], 1 + strlen(dirs[i]), hash);
+        dir_path = oskar_dir_get_path(path, dirs[i]);
+        hash = hash_dir(dir_path, hash, buffer, buffer_size);
+        free(dir_path);
+    }
+    for (i = 0; i < num_files; ++i) free(files[i]);
+    for (i = 0; i < num_dirs; ++i) free(dirs[i]);
+    free(files);
+    free(dirs);
+    return hash;
+}
+
+unsigned long long oskar_telescope_cache_hash(const oskar_Telescope* telescope,
+        const char* path, int* status)
+{
+    long long options[6];
+    unsigned long long hash;
+    const size_t buffer_size = 1 << 20;
+    char* buffer;
+    if (*status) return 0;
+
+    /* Hash the options that affect the load. */
+    options[0] = CACHE_VERSION;
+    options[1] = telescope->precision;
+    options[2] = telescope->pol_mode;
+    options[3] = telescope->enable_numerical_patterns;
+    options[4] = telescope->noise_enabled;
+    options[5] = telescope->noise_seed;
+    hash = oskar_mem_hash_raw(options, sizeof(options), 0);
+
+    /* Hash the directory tree. */
+    buffer = (char*) malloc(buffer_size);
+    if (!buffer)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+    hash = hash_dir(path, hash, buffer, buffer_size);
+    free(buffer);
+    return hash;
+}
+
+int oskar_telescope_cache_read(oskar_Telescope* telescope,
+        const char* filename, unsigned long long hash, int* status)
+{
+    int i, n = 0, coord_type, loaded = 0;
+    long file_size;
+    double lon, lat, alt;
+    unsigned long long header[6];
+    char* data = 0;
+    FILE* file;
+    Reader r;
+    oskar_Mem* coords[12];
+    oskar_Mem** dst[12];
+    oskar_Station** stations = 0;
+    if (*status) return 0;
+    if (telescope->mem_location != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return 0;
+    }
+
+    /* Read the whole file and check the header. */
+    file = fopen(filename, "rb");
+    if (!file) return 0;
+    if (fseek(file, 0, SEEK_END) || (file_size = ftell(file)) < HEADER_SIZE
+            || fseek(file, 0, SEEK_SET) ||
+            fread(header, 1, HEADER_SIZE, file) != HEADER_SIZE ||
+            memcmp(header, CACHE_MAGIC, 8) ||
+            header[1] != CACHE_VERSION || header[2] != CACHE_BYTE_ORDER ||
+            header[3] != hash ||
+            header[4] != (unsigned long long) (file_size - HEADER_SIZE))
+    {
+        fclose(file);
+        return 0;
+    }
+    data = (char*) malloc((size_t) header[4] + 1);
+    if (!data)
+    {
+        fclose(file);
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+    if (fread(data, 1, (size_t) header[4], file) != (size_t) header[4] ||
+            oskar_mem_hash_raw(data, (size_t) header[4], 0) != header[5])
+    {
+        fclose(file);
+        free(data);
+        return 0;
+    }
+    fclose(file);
+
+    /* Read the telescope data into temporary arrays. */
+    r.data = data;
+    r.size = (size_t) header[4];
+    r.pos = 0;
+    r.error = 0;
+    dst[0] = &telescope->station_true_x_offset_ecef_metres;
+    dst[1] = &telescope->station_true_y_offset_ecef_metres;
+    dst[2] = &telescope->station_true_z_offset_ecef_metres;
+    dst[3] = &telescope->station_true_x_enu_metres;
+    dst[4] = &telescope->station_true_y_enu_metres;
+    dst[5] = &telescope->station_true_z_enu_metres;
+    dst[6] = &telescope->station_measured_x_offset_ecef_metres;
+    dst[7] = &telescope->station_measured_y_offset_ecef_metres;
+    dst[8] = &telescope->station_measured_z_offset_ecef_metres;
+    dst[9] = &telescope->station_measured_x_enu_metres;
+    dst[10] = &telescope->station_measured_y_enu_metres;
+    dst[11] = &telescope->station_measured_z_enu_metres;
+    lon = get_double(&r);
+    lat = get_double(&r);
+    alt = get_double(&r);
+    coord_type = (int) get_int(&r);
+    for (i = 0; i < 12; ++i)
+    {
+        coords[i] = oskar_mem_create(oskar_mem_type(*dst[i]), OSKAR_CPU, 0,
+                status);
+        get_mem(&r, coords[i], status);
+    }
+    n = get_count(&r);
+    if (!r.error && !*status && n > 0)
+    {
+        stations = (oskar_Station**) calloc(n, sizeof(oskar_Station*));
+        if (!stations) *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        get_stations(&r, stations, n, telescope->precision, status);
+    }
+
+    /* Replace the telescope data if everything was read successfully. */
+    if (!r.error && !*status && r.pos == r.size)
+    {
+        oskar_telescope_resize(telescope, 0, status);
+        free(telescope->station);
+        telescope->station = stations;
+        telescope->num_stations = n;
+        telescope->lon_rad = lon;
+        telescope->lat_rad = lat;
+        telescope->alt_metres = alt;
+        telescope->supplied_coord_type = coord_type;
+        for (i = 0; i < 12; ++i)
+        {
+            oskar_Mem* t = *dst[i];
+            *dst[i] = coords[i];
+            coords[i] = t;
+        }
+        stations = 0;
+        loaded = 1;
+    }
+
+    /* Clean up. */
+    for (i = 0; i < 12; ++i)
+        oskar_mem_free(coords[i], status);
+    if (stations)
+    {
+        for (i = 0; i < n; ++i)
+            oskar_station_free(stations[i], status);
+        free(stations);
+    }
+    free(data);
+    return loaded;
+}
+
+void oskar_telescope_cache_write(const oskar_Telescope* telescope,
+        const char* filename, unsigned long long hash, int* status)
+{
+    int i;
+    unsigned long long header[6];
+    char* temp_name;
+    FILE* file;
+    Buffer b;
+    if (*status) return;
+    if (telescope->mem_location != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+
+    /* Serialise the telescope data. */
+    memset(&b, 0, sizeof(Buffer));
+    put_double(&b, telescope->lon_rad);
+    put_double(&b, telescope->lat_rad);
+    put_double(&b, telescope->alt_metres);
+    put_int(&b, telescope->supplied_coord_type);
+    put_mem(&b, telescope->station_true_x_offset_ecef_metres);
+    put_mem(&b, telescope->station_true_y_offset_ecef_metres);
+    put_mem(&b, telescope->station_true_z_offset_ecef_metres);
+    put_mem(&b, telescope->station_true_x_enu_metres);
+    put_mem(&b, telescope->station_true_y_enu_metres);
+    put_mem(&b, telescope->station_true_z_enu_metres);
+    put_mem(&b, telescope->station_measured_x_offset_ecef_metres);
+    put_mem(&b, telescope->station_measured_y_offset_ecef_metres);
+    put_mem(&b, telescope->station_measured_z_offset_ecef_metres);
+    put_mem(&b, telescope->station_measured_x_enu_metres);
+    put_mem(&b, telescope->station_measured_y_enu_metres);
+    put_mem(&b, telescope->station_measured_z_enu_metres);
+    put_int(&b, telescope->num_stations);
+    put_stations(&b, telescope->station, telescope->num_stations);
+    if (b.error)
+    {
+        *status = b.error;
+        free(b.data);
+        return;
+    }
+
+    /* Fill in the header. */
+    memset(header, 0, sizeof(header));
+    memcpy(header, CACHE_MAGIC, 8);
+    header[1] = CACHE_VERSION;
+    header[2] = CACHE_BYTE_ORDER;
+    header[3] = hash;
+    header[4] = (unsigned long long) b.size;
+    header[5] = oskar_mem_hash_raw(b.data, b.size, 0);
+
+    /* Write to a temporary file, then rename it. */
+    temp_name = oskar_dir_temp_file_name(filename);
+    file = temp_name ? fopen(temp_name, "wb") : 0;
+    if (!file)
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        free(temp_name);
+        free(b.data);
+        return;
+    }
+    i = (fwrite(header, 1, HEADER_SIZE, file) != HEADER_SIZE ||
+            fwrite(b.data, 1, b.size, file) != b.size);
+    i |= fclose(file);
+    if (!i)
+    {
+        (void) remove(filename);
+        i = rename(temp_name, filename);
+    }
+    if (i)
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        (void) remove(temp_name);
+    }
+    free(temp_name);
+    free(b.data);
+}
+
+#ifdef __cplusplus
+}
+#endif
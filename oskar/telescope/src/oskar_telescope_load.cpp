@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2016, The University of Oxford
+ * Copyright (c) 2013-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -75,6 +75,23 @@ void oskar_telescope_load(oskar_Telescope* telescope, const char* path,
         return;
     }
 
+    // Use the cached model, if enabled and up to date.
+    char* cache_path = 0;
+    unsigned long long hash = 0;
+    if (oskar_telescope_enable_model_cache(telescope))
+    {
+        hash = oskar_telescope_cache_hash(telescope, path, status);
+        cache_path = oskar_dir_get_path(path, OSKAR_TELESCOPE_CACHE_NAME);
+        if (oskar_telescope_cache_read(telescope, cache_path, hash, status))
+        {
+            oskar_log_message(log, 'M', 0,
+                    "Loaded telescope model from cache '%s'.", cache_path);
+            oskar_telescope_set_station_ids(telescope);
+            free(cache_path);
+            return;
+        }
+    }
+
     // Create the loaders.
     vector<oskar_TelescopeLoadAbstract*> loaders;
     // The position loader must be first, because it defines the
@@ -109,6 +126,22 @@ void oskar_telescope_load(oskar_Telescope* telescope, const char* path,
 
     // (Re-)Set unique station IDs.
     oskar_telescope_set_station_ids(telescope);
+
+    // Write the cache, if enabled. Failure to do so is not an error.
+    if (cache_path && !*status)
+    {
+        int cache_status = 0;
+        oskar_telescope_cache_write(telescope, cache_path, hash,
+                &cache_status);
+        if (cache_status)
+            oskar_log_warning(log, "Could not write telescope model "
+                    "cache '%s' (%s).", cache_path,
+                    oskar_get_error_string(cache_status));
+        else
+            oskar_log_message(log, 'M', 0,
+                    "Saved telescope model cache '%s'.", cache_path);
+    }
+    free(cache_path);
 }
 
 // Private functions.
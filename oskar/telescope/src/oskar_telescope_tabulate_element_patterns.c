@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "telescope/oskar_telescope.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static void tabulate_station(oskar_Station* station, int interp,
+        double resolution_rad, oskar_Element*** done, int* num_done,
+        oskar_Log* log, int* status)
+{
+    int i, j;
+    if (*status || !station) return;
+    for (i = 0; i < oskar_station_num_element_types(station); ++i)
+    {
+        oskar_Element* e = oskar_station_element(station, i);
+        double err = 0.0;
+        if (!oskar_element_has_x_spline_data(e) &&
+                !oskar_element_has_y_spline_data(e) &&
+                !oskar_element_has_scalar_spline_data(e))
+            continue;
+
+        /* Copy the tables from an identical element, if there is one. */
+        for (j = 0; j < *num_done; ++j)
+        {
+            if (!oskar_element_different((*done)[j], e, status))
+                break;
+        }
+        if (j < *num_done)
+        {
+            oskar_element_copy(e, (*done)[j], status);
+            continue;
+        }
+
+        /* Otherwise sample the fitted data. */
+        oskar_element_tabulate(e, interp, resolution_rad, &err, status);
+        if (*status) return;
+        oskar_log_message(log, 'M', 0, "Tabulated element pattern %d "
+                "(%d frequencies) on %d x %d (theta, phi) grid: "
+                "max. interpolation error %.2e of peak.", i,
+                oskar_element_num_freq(e), oskar_element_table_num_theta(e),
+                oskar_element_table_num_phi(e), err);
+        *done = (oskar_Element**) realloc(*done,
+                (*num_done + 1) * sizeof(oskar_Element*));
+        if (!*done)
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return;
+        }
+        (*done)[(*num_done)++] = e;
+    }
+
+    /* Recursively tabulate child stations. */
+    if (oskar_station_has_child(station))
+    {
+        for (i = 0; i < oskar_station_num_elements(station); ++i)
+            tabulate_station(oskar_station_child(station, i), interp,
+                    resolution_rad, done, num_done, log, status);
+    }
+}
+
+void oskar_telescope_tabulate_element_patterns(oskar_Telescope* telescope,
+        int interp, double resolution_rad, oskar_Log* log, int* status)
+{
+    int i, num_done = 0;
+    oskar_Element** done = 0;
+    if (*status) return;
+    for (i = 0; i < oskar_telescope_num_stations(telescope); ++i)
+        tabulate_station(oskar_telescope_station(telescope, i), interp,
+                resolution_rad, &done, &num_done, log, status);
+    free(done);
+}
+
+#ifdef __cplusplus
+}
+#endif
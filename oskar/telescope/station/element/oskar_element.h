@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2015, The University of Oxford
+ * Copyright (c) 2013-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -66,6 +66,13 @@ enum OSKAR_ELEMENT_COORD_SYS
     OSKAR_ELEMENT_COORD_SYS_TANGENT_PLANE = 1
 };
 
+enum OSKAR_ELEMENT_TABLE_INTERP
+{
+    OSKAR_ELEMENT_TABLE_NONE = 0,
+    OSKAR_ELEMENT_TABLE_BILINEAR = 1,
+    OSKAR_ELEMENT_TABLE_BICUBIC = 2
+};
+
 /* FIXME(FD) Deprecated. */
 enum OSKAR_ELEMENT_TYPE
 {
@@ -91,6 +98,7 @@ enum OSKAR_ELEMENT_TAPER
 #include <telescope/station/element/oskar_element_create.h>
 #include <telescope/station/element/oskar_element_different.h>
 #include <telescope/station/element/oskar_element_evaluate.h>
+#include <telescope/station/element/oskar_element_fit_splines.h>
 #include <telescope/station/element/oskar_element_free.h>
 #include <telescope/station/element/oskar_element_load.h>
 #include <telescope/station/element/oskar_element_load_cst.h>
@@ -98,6 +106,7 @@ enum OSKAR_ELEMENT_TAPER
 #include <telescope/station/element/oskar_element_resize_freq_data.h>
 #include <telescope/station/element/oskar_element_read.h>
 #include <telescope/station/element/oskar_element_save.h>
+#include <telescope/station/element/oskar_element_tabulate.h>
 #include <telescope/station/element/oskar_element_write.h>
 
 #endif /* OSKAR_ELEMENT_H_ */
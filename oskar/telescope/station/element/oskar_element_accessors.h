@@ -59,6 +59,15 @@ int oskar_element_has_scalar_spline_data(const oskar_Element* data);
 OSKAR_EXPORT
 int oskar_element_num_freq(const oskar_Element* data);
 
+OSKAR_EXPORT
+int oskar_element_table_interp(const oskar_Element* data);
+
+OSKAR_EXPORT
+int oskar_element_table_num_theta(const oskar_Element* data);
+
+OSKAR_EXPORT
+int oskar_element_table_num_phi(const oskar_Element* data);
+
 OSKAR_EXPORT
 const double* oskar_element_freqs_hz_const(const oskar_Element* data);
 
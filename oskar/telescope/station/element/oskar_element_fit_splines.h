@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_ELEMENT_FIT_SPLINES_H_
+#define OSKAR_ELEMENT_FIT_SPLINES_H_
+
+/**
+ * @file oskar_element_fit_splines.h
+ */
+
+#include <oskar_global.h>
+#include <log/oskar_log.h>
+#include <mem/oskar_mem.h>
+#include <splines/oskar_splines.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Fits spline surfaces to several sets of element pattern data.
+ *
+ * @details
+ * This function fits spherical spline surfaces to each of the supplied
+ * data arrays. Each surface has its own (theta, phi) coordinates and
+ * weights, although surfaces from the same data set (for example, the
+ * components of a pattern at one frequency) can share the same arrays.
+ *
+ * The fits are independent, so they are done in parallel using OpenMP,
+ * over all the surfaces given. Passing surfaces for all frequencies in a
+ * single call therefore keeps all threads busy, even if only a few
+ * surfaces are fitted per frequency.
+ * Each fit gives the same result as it would if done on its own, and the
+ * report for each surface is written to the log in the order given once
+ * all fits have finished. The report contains the average fractional error
+ * reached, the number of knots, the RMS and maximum absolute residuals
+ * at the data points (as fractions of the peak absolute value of the data),
+ * and the time taken by the fit.
+ *
+ * If any fit fails, the status code of the first one to fail (in the order
+ * given) is returned.
+ *
+ * @param[in,out] log          Pointer to log structure to use.
+ * @param[in] num_surfaces     Number of surfaces to fit.
+ * @param[in,out] splines      Array of spline surfaces to fit.
+ * @param[in] names            Array of surface names, used in the log.
+ * @param[in] num_points       Number of data points for each surface.
+ * @param[in] theta            Theta coordinates of data points for each
+ *                             surface, in radians.
+ * @param[in] phi              Phi coordinates of data points for each
+ *                             surface, in radians.
+ * @param[in] data             Array of surface data arrays.
+ * @param[in] weight           Weights of data points for each surface.
+ * @param[in] closeness        Target average fractional error required (<< 1).
+ * @param[in] closeness_inc    Average fractional error factor increase (> 1).
+ * @param[in,out] status       Status return code.
+ */
+OSKAR_EXPORT
+void oskar_element_fit_splines(oskar_Log* log, int num_surfaces,
+        oskar_Splines** splines, const char* const* names,
+        const int* num_points, oskar_Mem* const* theta,
+        oskar_Mem* const* phi, const oskar_Mem* const* data,
+        const oskar_Mem* const* weight, double closeness,
+        double closeness_inc, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_ELEMENT_FIT_SPLINES_H_ */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2014, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -81,6 +81,37 @@ void oskar_element_load_cst(oskar_Element* data, oskar_Log* log,
         double closeness, double closeness_inc, int ignore_at_poles,
         int ignore_below_horizon, int* status);
 
+/**
+ * @brief
+ * Loads antenna patterns at several frequencies from CST text files.
+ *
+ * @details
+ * This function loads antenna pattern data from a set of text files, one
+ * per frequency, in the format described for oskar_element_load_cst().
+ *
+ * All the files are read first, and the surfaces for all frequencies are
+ * then fitted together, in parallel. The fitted data are the same as they
+ * would be if each file were loaded in turn using oskar_element_load_cst().
+ *
+ * @param[in,out] data         Pointer to element model data structure to fill.
+ * @param[in,out] log          Pointer to log structure to use.
+ * @param[in]  port            Port number: 1 for X dipole, 2 for Y dipole,
+ *                             or 0 for both.
+ * @param[in]  num_files       Number of files to load.
+ * @param[in]  freq_hz         Frequency at which each file applies, in Hz.
+ * @param[in]  filenames       Data file names.
+ * @param[in]  closeness       Target average fractional error required (<< 1).
+ * @param[in]  closeness_inc   Average fractional error factor increase (> 1).
+ * @param[in]  ignore_at_poles If set, ignore data at theta = 0 and theta = 180.
+ * @param[in]  ignore_below_horizon If set, ignore data at theta > 90 deg.
+ * @param[in,out] status       Status return code.
+ */
+OSKAR_EXPORT
+void oskar_element_load_cst_files(oskar_Element* data, oskar_Log* log,
+        int port, int num_files, const double* freq_hz,
+        const char* const* filenames, double closeness, double closeness_inc,
+        int ignore_at_poles, int ignore_below_horizon, int* status);
+
 #ifdef __cplusplus
 }
 #endif
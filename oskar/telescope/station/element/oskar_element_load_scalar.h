@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014, The University of Oxford
+ * Copyright (c) 2014-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -70,6 +70,36 @@ void oskar_element_load_scalar(oskar_Element* data, oskar_Log* log,
         double closeness_inc, int ignore_at_poles, int ignore_below_horizon,
         int* status);
 
+/**
+ * @brief
+ * Loads scalar antenna patterns at several frequencies from text files.
+ *
+ * @details
+ * This function loads scalar antenna pattern data from a set of text files,
+ * one per frequency, in the format described for oskar_element_load_scalar().
+ *
+ * All the files are read first, and the surfaces for all frequencies are
+ * then fitted together, in parallel. The fitted data are the same as they
+ * would be if each file were loaded in turn using
+ * oskar_element_load_scalar().
+ *
+ * @param[in,out] data         Pointer to element model data structure to fill.
+ * @param[in,out] log          Pointer to log structure to use.
+ * @param[in]  num_files       Number of files to load.
+ * @param[in]  freq_hz         Frequency at which each file applies, in Hz.
+ * @param[in]  filenames       Data file names.
+ * @param[in]  closeness       Target average fractional error required (<< 1).
+ * @param[in]  closeness_inc   Average fractional error factor increase (> 1).
+ * @param[in]  ignore_at_poles If set, ignore data at theta = 0 and theta = 180.
+ * @param[in]  ignore_below_horizon If set, ignore data at theta > 90 deg.
+ * @param[in,out] status       Status return code.
+ */
+OSKAR_EXPORT
+void oskar_element_load_scalar_files(oskar_Element* data, oskar_Log* log,
+        int num_files, const double* freq_hz, const char* const* filenames,
+        double closeness, double closeness_inc, int ignore_at_poles,
+        int ignore_below_horizon, int* status);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_ELEMENT_TABULATE_H_
+#define OSKAR_ELEMENT_TABULATE_H_
+
+/**
+ * @file oskar_element_tabulate.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Samples fitted element pattern data onto look-up tables.
+ *
+ * @details
+ * This function evaluates the fitted spline surfaces of the element model
+ * on a regular grid in (theta, phi) for every frequency, and stores the
+ * results so that oskar_element_evaluate() can use table interpolation
+ * instead of evaluating the splines.
+ *
+ * The grid spacing is at most \p resolution_rad in both coordinates.
+ * On exit, \p max_rel_error holds the largest difference between the
+ * interpolated table and the splines, found by evaluating both at the
+ * centre of every grid cell, as a fraction of the peak absolute value
+ * of the surface. \p max_rel_error may be NULL if this is not required.
+ *
+ * If \p interp is OSKAR_ELEMENT_TABLE_NONE, any existing tables are
+ * removed and the splines will be used again.
+ *
+ * The element model must be in CPU memory.
+ *
+ * @param[in,out] model        Pointer to element model structure.
+ * @param[in] interp           Interpolation type (enumerator).
+ * @param[in] resolution_rad   Maximum grid spacing, in radians.
+ * @param[out] max_rel_error   Largest fractional interpolation error.
+ * @param[in,out] status       Status return code.
+ */
+OSKAR_EXPORT
+void oskar_element_tabulate(oskar_Element* model, int interp,
+        double resolution_rad, double* max_rel_error, int* status);
+
+/**
+ * @brief
+ * Interpolates a tabulated element pattern.
+ *
+ * @details
+ * This function interpolates a table written by oskar_element_tabulate()
+ * at the given (theta, phi) positions, using bilinear or bicubic
+ * (Catmull-Rom) interpolation. The table wraps in phi, and interpolation
+ * stencils that cross a pole use the points on the other side of it.
+ *
+ * For each point, the \p num_components values are written to the
+ * \p output array starting at index \p offset + i * \p stride.
+ *
+ * @param[in] table            Look-up table.
+ * @param[in] num_components   Number of values at each grid point.
+ * @param[in] num_theta        Number of grid points in theta.
+ * @param[in] num_phi          Number of grid points in phi.
+ * @param[in] interp           Interpolation type (enumerator).
+ * @param[in] num_points       Number of positions.
+ * @param[in] theta            Theta coordinates, in radians.
+ * @param[in] phi              Phi coordinates, in radians.
+ * @param[in] offset           Index of first output value.
+ * @param[in] stride           Stride through the output array.
+ * @param[out] output          Output values.
+ * @param[in,out] status       Status return code.
+ */
+OSKAR_EXPORT
+void oskar_element_interpolate_table(const oskar_Mem* table,
+        int num_components, int num_theta, int num_phi, int interp,
+        int num_points, const oskar_Mem* theta, const oskar_Mem* phi,
+        int offset, int stride, oskar_Mem* output, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_ELEMENT_TABULATE_H_ */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2016, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -32,6 +32,23 @@
 #include <splines/oskar_splines.h>
 #include <mem/oskar_mem.h>
 
+/* Look-up tables sampled from the fitted data, per-frequency.
+ * Grid points run over theta in [0, pi] and phi in [0, 2 pi), with phi
+ * varying fastest. Each point holds (h_re, h_im, v_re, v_im) for the
+ * X and Y tables, or (re, im) for the scalar table.
+ * The tables are not modified once written, so copies of an element in
+ * CPU memory hold a reference to the same tables instead of copying them.
+ * They are freed when the last reference is released. */
+struct oskar_ElementTables
+{
+    int ref_count;
+    int num_freq;
+    oskar_Mem** x;
+    oskar_Mem** y;
+    oskar_Mem** scalar;
+};
+typedef struct oskar_ElementTables oskar_ElementTables;
+
 struct oskar_Element
 {
     int precision;
@@ -79,6 +96,12 @@ struct oskar_Element
     oskar_Splines** y_v_im;
     oskar_Splines** scalar_re;
     oskar_Splines** scalar_im;
+
+    /* Optional look-up tables sampled from the fitted data. */
+    int table_interp;
+    int table_num_theta;
+    int table_num_phi;
+    oskar_ElementTables* tables; /* Shared with copies of the element. */
 };
 
 #ifndef OSKAR_ELEMENT_TYPEDEF_
@@ -76,6 +76,21 @@ int oskar_element_num_freq(const oskar_Element* data)
     return data->num_freq;
 }
 
+int oskar_element_table_interp(const oskar_Element* data)
+{
+    return data->table_interp;
+}
+
+int oskar_element_table_num_theta(const oskar_Element* data)
+{
+    return data->table_num_theta;
+}
+
+int oskar_element_table_num_phi(const oskar_Element* data)
+{
+    return data->table_num_phi;
+}
+
 const double* oskar_element_freqs_hz_const(const oskar_Element* data)
 {
     return data->freqs_hz;
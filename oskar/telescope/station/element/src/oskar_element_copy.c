@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2015, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,6 +27,7 @@
  */
 
 #include "telescope/station/element/private_element.h"
+#include "telescope/station/element/private_element_tables.h"
 #include "telescope/station/element/oskar_element.h"
 
 #ifdef __cplusplus
@@ -36,7 +37,7 @@ extern "C" {
 void oskar_element_copy(oskar_Element* dst, const oskar_Element* src,
         int* status)
 {
-    int i;
+    int i, table;
 
     /* Check if safe to proceed. */
     if (*status) return;
@@ -49,6 +50,14 @@ void oskar_element_copy(oskar_Element* dst, const oskar_Element* src,
     dst->dipole_length = src->dipole_length;
     dst->dipole_length_units = src->dipole_length_units;
 
+    /* Look-up tables are only used in CPU memory.
+     * They are not modified once written, so share them with the source. */
+    table = (dst->mem_location == OSKAR_CPU);
+    dst->table_interp = table ? src->table_interp : OSKAR_ELEMENT_TABLE_NONE;
+    dst->table_num_theta = table ? src->table_num_theta : 0;
+    dst->table_num_phi = table ? src->table_num_phi : 0;
+    oskar_element_tables_set(dst, table ? src->tables : 0, status);
+
     /* Resize the arrays. */
     oskar_element_resize_freq_data(dst, src->num_freq, status);
 
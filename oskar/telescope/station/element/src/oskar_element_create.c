@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2015, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -38,7 +38,7 @@ oskar_Element* oskar_element_create(int precision, int location, int* status)
     oskar_Element* data = 0;
 
     /* Allocate and initialise the structure. */
-    data = (oskar_Element*) malloc(sizeof(oskar_Element));
+    data = (oskar_Element*) calloc(1, sizeof(oskar_Element));
     if (!data)
     {
         *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
@@ -75,6 +75,10 @@ oskar_Element* oskar_element_create(int precision, int location, int* status)
     data->y_v_im = 0;
     data->scalar_re = 0;
     data->scalar_im = 0;
+    data->table_interp = OSKAR_ELEMENT_TABLE_NONE;
+    data->table_num_theta = 0;
+    data->table_num_phi = 0;
+    data->tables = 0;
 
     /* Return pointer to the structure. */
     return data;
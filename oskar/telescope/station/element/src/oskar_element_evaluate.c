@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2015, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -45,12 +45,28 @@
 extern "C" {
 #endif
 
+/* Returns the look-up table to use, or NULL to use the splines. */
+static const oskar_Mem* get_table(const oskar_Element* model, int freq_id,
+        char type)
+{
+    const oskar_Mem* table;
+    const oskar_ElementTables* t = model->tables;
+    if (model->table_interp == OSKAR_ELEMENT_TABLE_NONE || !t ||
+            freq_id >= t->num_freq)
+        return 0;
+    table = (type == 'X') ? t->x[freq_id] :
+            (type == 'Y') ? t->y[freq_id] : t->scalar[freq_id];
+    return oskar_mem_length(table) > 0 ? table : 0;
+}
+
 void oskar_element_evaluate(const oskar_Element* model, oskar_Mem* output,
         double orientation_x, double orientation_y, int num_points,
         const oskar_Mem* x, const oskar_Mem* y, const oskar_Mem* z,
         double frequency_hz, oskar_Mem* theta, oskar_Mem* phi, int* status)
 {
     int element_type, taper_type, freq_id;
+    const oskar_Splines* splines[4];
+    const oskar_Mem* table;
     double dipole_length_m;
 
     /* Check if safe to proceed. */
@@ -100,14 +116,21 @@ void oskar_element_evaluate(const oskar_Element* model, oskar_Mem* output,
                     oskar_element_freqs_hz_const(model));
 
             /* Evaluate spline pattern for dipole X. */
-            oskar_splines_evaluate(output, 0, 8, model->x_h_re[freq_id],
-                    num_points, theta, phi, status);
-            oskar_splines_evaluate(output, 1, 8, model->x_h_im[freq_id],
-                    num_points, theta, phi, status);
-            oskar_splines_evaluate(output, 2, 8, model->x_v_re[freq_id],
-                    num_points, theta, phi, status);
-            oskar_splines_evaluate(output, 3, 8, model->x_v_im[freq_id],
-                    num_points, theta, phi, status);
+            table = get_table(model, freq_id, 'X');
+            if (table)
+                oskar_element_interpolate_table(table, 4,
+                        model->table_num_theta, model->table_num_phi,
+                        model->table_interp, num_points, theta, phi,
+                        0, 8, output, status);
+            else
+            {
+                splines[0] = model->x_h_re[freq_id];
+                splines[1] = model->x_h_im[freq_id];
+                splines[2] = model->x_v_re[freq_id];
+                splines[3] = model->x_v_im[freq_id];
+                oskar_splines_evaluate_fused(output, 0, 8, 4, splines,
+                        num_points, theta, phi, status);
+            }
 
             /* Convert from Ludwig-3 to spherical representation. */
             oskar_convert_ludwig3_to_theta_phi_components(output, 0, 4,
@@ -139,14 +162,21 @@ void oskar_element_evaluate(const oskar_Element* model, oskar_Mem* output,
                     oskar_element_freqs_hz_const(model));
 
             /* Evaluate spline pattern for dipole Y. */
-            oskar_splines_evaluate(output, 4, 8, model->y_h_re[freq_id],
-                    num_points, theta, phi, status);
-            oskar_splines_evaluate(output, 5, 8, model->y_h_im[freq_id],
-                    num_points, theta, phi, status);
-            oskar_splines_evaluate(output, 6, 8, model->y_v_re[freq_id],
-                    num_points, theta, phi, status);
-            oskar_splines_evaluate(output, 7, 8, model->y_v_im[freq_id],
-                    num_points, theta, phi, status);
+            table = get_table(model, freq_id, 'Y');
+            if (table)
+                oskar_element_interpolate_table(table, 4,
+                        model->table_num_theta, model->table_num_phi,
+                        model->table_interp, num_points, theta, phi,
+                        4, 8, output, status);
+            else
+            {
+                splines[0] = model->y_h_re[freq_id];
+                splines[1] = model->y_h_im[freq_id];
+                splines[2] = model->y_v_re[freq_id];
+                splines[3] = model->y_v_im[freq_id];
+                oskar_splines_evaluate_fused(output, 4, 8, 4, splines,
+                        num_points, theta, phi, status);
+            }
 
             /* Convert from Ludwig-3 to spherical representation. */
             oskar_convert_ludwig3_to_theta_phi_components(output, 2, 4,
@@ -177,10 +207,19 @@ void oskar_element_evaluate(const oskar_Element* model, oskar_Mem* output,
                     oskar_element_num_freq(model),
                     oskar_element_freqs_hz_const(model));
 
-            oskar_splines_evaluate(output, 0, 2, model->scalar_re[freq_id],
-                    num_points, theta, phi, status);
-            oskar_splines_evaluate(output, 1, 2, model->scalar_im[freq_id],
-                    num_points, theta, phi, status);
+            table = get_table(model, freq_id, 'S');
+            if (table)
+                oskar_element_interpolate_table(table, 2,
+                        model->table_num_theta, model->table_num_phi,
+                        model->table_interp, num_points, theta, phi,
+                        0, 2, output, status);
+            else
+            {
+                splines[0] = model->scalar_re[freq_id];
+                splines[1] = model->scalar_im[freq_id];
+                oskar_splines_evaluate_fused(output, 0, 2, 2, splines,
+                        num_points, theta, phi, status);
+            }
         }
         else if (element_type == OSKAR_ELEMENT_TYPE_DIPOLE)
         {
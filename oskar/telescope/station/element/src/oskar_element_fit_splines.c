@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "telescope/station/element/oskar_element_fit_splines.h"
+#include "utility/oskar_timer.h"
+#include "math/oskar_cmath.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    int status;
+    double avg_frac_error, rms_residual, max_residual, time_sec;
+} FitReport;
+
+static void fit_surface(oskar_Splines* splines, int n, oskar_Mem* theta,
+        oskar_Mem* phi, const oskar_Mem* data, const oskar_Mem* weight,
+        double closeness, double closeness_inc, FitReport* report);
+
+void oskar_element_fit_splines(oskar_Log* log, int num_surfaces,
+        oskar_Splines** splines, const char* const* names,
+        const int* num_points, oskar_Mem* const* theta,
+        oskar_Mem* const* phi, const oskar_Mem* const* data,
+        const oskar_Mem* const* weight, double closeness,
+        double closeness_inc, int* status)
+{
+    int i;
+    double start, total = 0.0;
+    FitReport* report;
+    if (*status || num_surfaces <= 0) return;
+    report = (FitReport*) calloc(num_surfaces, sizeof(FitReport));
+    if (!report)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+
+    /* Fit all the surfaces in parallel, whichever data set they are from. */
+    start = oskar_timer_wall_time();
+    #pragma omp parallel for private(i) schedule(dynamic, 1)
+    for (i = 0; i < num_surfaces; ++i)
+        fit_surface(splines[i], num_points[i], theta[i], phi[i], data[i],
+                weight[i], closeness, closeness_inc, &report[i]);
+
+    /* Write the report for each surface, in order. */
+    for (i = 0; i < num_surfaces; ++i)
+    {
+        const FitReport* r = &report[i];
+        total += r->time_sec;
+        oskar_log_line(log, 'M', ' ');
+        oskar_log_message(log, 'M', 0, "Fitted surface %s", names[i]);
+        if (r->status)
+        {
+            oskar_log_error(log, "Fitting surface %s failed (code %d).",
+                    names[i], r->status);
+            if (!*status) *status = r->status;
+            continue;
+        }
+        oskar_log_message(log, 'M', 1, "Surface fitted to %.4f average "
+                "frac. error (s=%.2e).", r->avg_frac_error,
+                oskar_splines_smoothing_factor(splines[i]));
+        oskar_log_message(log, 'M', 1, "Number of knots (theta, phi) = "
+                "(%d, %d).", oskar_splines_num_knots_x_theta(splines[i]),
+                oskar_splines_num_knots_y_phi(splines[i]));
+        oskar_log_message(log, 'M', 1, "Frac. residual (RMS, max) = "
+                "(%.3e, %.3e).", r->rms_residual, r->max_residual);
+        oskar_log_message(log, 'M', 1, "Fit took %.3f sec.", r->time_sec);
+    }
+    oskar_log_line(log, 'M', ' ');
+    oskar_log_message(log, 'M', 0, "Fitted %d surface(s) in %.3f sec "
+            "(%.3f sec total fit time).", num_surfaces,
+            oskar_timer_wall_time() - start, total);
+    free(report);
+}
+
+static void fit_surface(oskar_Splines* splines, int n, oskar_Mem* theta,
+        oskar_Mem* phi, const oskar_Mem* data, const oskar_Mem* weight,
+        double closeness, double closeness_inc, FitReport* report)
+{
+    int i, *status = &report->status;
+    double start, peak = 0.0, sum_sq = 0.0, max_abs = 0.0;
+    const double *z, *model;
+    oskar_Mem* eval;
+
+    /* Fit the surface. */
+    start = oskar_timer_wall_time();
+    report->avg_frac_error = closeness; /* Copy the fitting parameter. */
+    oskar_splines_fit(splines, n, oskar_mem_double(theta, status),
+            oskar_mem_double(phi, status), oskar_mem_double_const(data, status),
+            oskar_mem_double_const(weight, status), OSKAR_SPLINES_SPHERICAL, 1,
+            &report->avg_frac_error, closeness_inc, 1, 1e-14, status);
+
+    /* Evaluate the residuals at the data points. */
+    eval = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, n, status);
+    oskar_splines_evaluate(eval, 0, 1, splines, n, theta, phi, status);
+    if (!*status)
+    {
+        z = oskar_mem_double_const(data, status);
+        model = oskar_mem_double_const(eval, status);
+        for (i = 0; i < n; ++i)
+        {
+            const double r = fabs(z[i] - model[i]);
+            if (fabs(z[i]) > peak) peak = fabs(z[i]);
+            if (r > max_abs) max_abs = r;
+            sum_sq += r * r;
+        }
+        if (n > 0 && peak > 0.0)
+        {
+            report->rms_residual = sqrt(sum_sq / n) / peak;
+            report->max_residual = max_abs / peak;
+        }
+    }
+    oskar_mem_free(eval, status);
+    report->time_sec = oskar_timer_wall_time() - start;
+}
+
+#ifdef __cplusplus
+}
+#endif
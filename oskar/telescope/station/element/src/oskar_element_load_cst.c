@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2015, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -42,28 +42,44 @@ extern "C" {
 
 #define DEG2RAD (M_PI/180.0)
 
-static void fit_splines(oskar_Log* log, oskar_Splines* splines, int n,
-        oskar_Mem* theta, oskar_Mem* phi, oskar_Mem* data, oskar_Mem* weight,
-        double closeness, double closeness_inc, const char* name, int* status);
+/* Surface data read from one file, in Ludwig-3 format. */
+typedef struct
+{
+    int n;
+    oskar_Mem *theta, *phi, *h_re, *h_im, *v_re, *v_im, *weight;
+} CstData;
+
+static void read_file(CstData* d, const char* filename, int ignore_at_poles,
+        int ignore_below_horizon, int* status);
+
+static void free_data(CstData* d, int* status);
 
 void oskar_element_load_cst(oskar_Element* data, oskar_Log* log,
         int port, double freq_hz, const char* filename,
         double closeness, double closeness_inc, int ignore_at_poles,
         int ignore_below_horizon, int* status)
 {
-    int i, n = 0, type = OSKAR_DOUBLE;
-    size_t fname_len;
-    oskar_Splines *data_h_re = 0, *data_h_im = 0;
-    oskar_Splines *data_v_re = 0, *data_v_im = 0;
-    oskar_Mem *theta, *phi, *h_re, *h_im, *v_re, *v_im, *weight;
+    oskar_element_load_cst_files(data, log, port, 1, &freq_hz, &filename,
+            closeness, closeness_inc, ignore_at_poles, ignore_below_horizon,
+            status);
+}
 
-    /* Declare the line buffer. */
-    char *line = 0, *dbi = 0, *ludwig3 = 0;
-    size_t bufsize = 0;
-    FILE* file;
+void oskar_element_load_cst_files(oskar_Element* data, oskar_Log* log,
+        int port, int num_files, const double* freq_hz,
+        const char* const* filenames, double closeness, double closeness_inc,
+        int ignore_at_poles, int ignore_below_horizon, int* status)
+{
+    int f, i, j, k, num_surfaces, *freq_id = 0, *num_points = 0;
+    const char* names[] = {"H [real]", "H [imag]", "V [real]", "V [imag]"};
+    char* name_buffer = 0;
+    const char** surface_names = 0;
+    CstData* d = 0;
+    oskar_Splines** splines = 0;
+    oskar_Mem **theta = 0, **phi = 0;
+    const oskar_Mem **weight = 0, **surfaces = 0;
 
     /* Check if safe to proceed. */
-    if (*status) return;
+    if (*status || num_files <= 0) return;
 
     /* Check port number. */
     if (port != 0 && port != 1 && port != 2)
@@ -73,7 +89,7 @@ void oskar_element_load_cst(oskar_Element* data, oskar_Log* log,
     }
 
     /* Check the data type. */
-    if (oskar_element_precision(data) != type)
+    if (oskar_element_precision(data) != OSKAR_DOUBLE)
     {
         *status = OSKAR_ERR_TYPE_MISMATCH;
         return;
@@ -86,40 +102,136 @@ void oskar_element_load_cst(oskar_Element* data, oskar_Log* log,
         return;
     }
 
-    /* Check if this frequency has already been set, and get its index if so. */
-    n = data->num_freq;
-    for (i = 0; i < n; ++i)
+    /* Allocate arrays to hold the surfaces to fit from all files. */
+    num_surfaces = 4 * num_files;
+    d = (CstData*) calloc(num_files, sizeof(CstData));
+    freq_id = (int*) calloc(num_files, sizeof(int));
+    num_points = (int*) calloc(num_surfaces, sizeof(int));
+    name_buffer = (char*) calloc(num_surfaces, 64);
+    surface_names = (const char**) calloc(num_surfaces, sizeof(char*));
+    splines = (oskar_Splines**) calloc(num_surfaces, sizeof(oskar_Splines*));
+    theta = (oskar_Mem**) calloc(num_surfaces, sizeof(oskar_Mem*));
+    phi = (oskar_Mem**) calloc(num_surfaces, sizeof(oskar_Mem*));
+    weight = (const oskar_Mem**) calloc(num_surfaces, sizeof(oskar_Mem*));
+    surfaces = (const oskar_Mem**) calloc(num_surfaces, sizeof(oskar_Mem*));
+    if (!d || !freq_id || !num_points || !name_buffer || !surface_names ||
+            !splines || !theta || !phi || !weight || !surfaces)
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+
+    /* Read all the files. */
+    for (f = 0; f < num_files && !*status; ++f)
     {
-        if (fabs(data->freqs_hz[i] - freq_hz) <= freq_hz * DBL_EPSILON)
-            break;
-    }
+        /* Check if this frequency has already been set,
+         * and get its index if so. */
+        for (i = 0; i < data->num_freq; ++i)
+        {
+            if (fabs(data->freqs_hz[i] - freq_hz[f]) <=
+                    freq_hz[f] * DBL_EPSILON)
+                break;
+        }
 
-    /* Expand arrays to hold data for a new frequency, if needed. */
-    if (i >= data->num_freq)
-    {
-        i = data->num_freq;
-        oskar_element_resize_freq_data(data, i + 1, status);
-        data->freqs_hz[i] = freq_hz;
-    }
+        /* Expand arrays to hold data for a new frequency, if needed. */
+        if (i >= data->num_freq)
+        {
+            i = data->num_freq;
+            oskar_element_resize_freq_data(data, i + 1, status);
+            if (*status) break;
+            data->freqs_hz[i] = freq_hz[f];
+        }
+        freq_id[f] = i;
 
-    /* Get pointers to surface data based on port number and frequency index. */
-    if (port == 1 || port == 0)
-    {
-        data_h_re = oskar_element_x_h_re(data, i);
-        data_h_im = oskar_element_x_h_im(data, i);
-        data_v_re = oskar_element_x_v_re(data, i);
-        data_v_im = oskar_element_x_v_im(data, i);
+        /* Read the surface data. */
+        read_file(&d[f], filenames[f], ignore_at_poles, ignore_below_horizon,
+                status);
+        if (*status) break;
+
+        /* Get pointers to surface data based on port number. */
+        k = 4 * f;
+        if (port == 1 || port == 0)
+        {
+            splines[k + 0] = oskar_element_x_h_re(data, i);
+            splines[k + 1] = oskar_element_x_h_im(data, i);
+            splines[k + 2] = oskar_element_x_v_re(data, i);
+            splines[k + 3] = oskar_element_x_v_im(data, i);
+        }
+        else if (port == 2)
+        {
+            splines[k + 0] = oskar_element_y_h_re(data, i);
+            splines[k + 1] = oskar_element_y_h_im(data, i);
+            splines[k + 2] = oskar_element_y_v_re(data, i);
+            splines[k + 3] = oskar_element_y_v_im(data, i);
+        }
+        surfaces[k + 0] = d[f].h_re;
+        surfaces[k + 1] = d[f].h_im;
+        surfaces[k + 2] = d[f].v_re;
+        surfaces[k + 3] = d[f].v_im;
+        for (j = 0; j < 4; ++j)
+        {
+            char* name = name_buffer + 64 * (k + j);
+            num_points[k + j] = d[f].n;
+            theta[k + j] = d[f].theta;
+            phi[k + j] = d[f].phi;
+            weight[k + j] = d[f].weight;
+            if (num_files > 1)
+                sprintf(name, "%s at %.3f MHz", names[j], freq_hz[f] / 1e6);
+            else
+                strcpy(name, names[j]);
+            surface_names[k + j] = name;
+        }
     }
-    else if (port == 2)
+
+    /* Fit splines to the surface data from all files together. */
+    oskar_element_fit_splines(log, num_surfaces, splines, surface_names,
+            num_points, theta, phi, surfaces, weight, closeness,
+            closeness_inc, status);
+
+    for (f = 0; f < num_files && !*status; ++f)
     {
-        data_h_re = oskar_element_y_h_re(data, i);
-        data_h_im = oskar_element_y_h_im(data, i);
-        data_v_re = oskar_element_y_v_re(data, i);
-        data_v_im = oskar_element_y_v_im(data, i);
+        const size_t fname_len = 1 + strlen(filenames[f]);
+        i = freq_id[f];
+
+        /* Store the filename. */
+        if (port == 0 || port == 1)
+            oskar_mem_append_raw(data->filename_x[i], filenames[f],
+                    OSKAR_CHAR, OSKAR_CPU, fname_len, status);
+        if (port == 0 || port == 2)
+            oskar_mem_append_raw(data->filename_y[i], filenames[f],
+                    OSKAR_CHAR, OSKAR_CPU, fname_len, status);
+
+        /* Copy X to Y if both ports are the same. */
+        if (port == 0)
+        {
+            oskar_splines_copy(data->y_h_re[i], data->x_h_re[i], status);
+            oskar_splines_copy(data->y_h_im[i], data->x_h_im[i], status);
+            oskar_splines_copy(data->y_v_re[i], data->x_v_re[i], status);
+            oskar_splines_copy(data->y_v_im[i], data->x_v_im[i], status);
+        }
     }
 
+    /* Free local arrays. */
+    for (f = 0; d && f < num_files; ++f)
+        free_data(&d[f], status);
+    free(d);
+    free(freq_id);
+    free(num_points);
+    free(name_buffer);
+    free(surface_names);
+    free(splines);
+    free(theta);
+    free(phi);
+    free(weight);
+    free(surfaces);
+}
+
+static void read_file(CstData* d, const char* filename, int ignore_at_poles,
+        int ignore_below_horizon, int* status)
+{
+    int n = 0, type = OSKAR_DOUBLE;
+    char *line = 0, *dbi = 0, *ludwig3 = 0;
+    size_t bufsize = 0;
+    FILE* file;
+
     /* Open the file. */
-    fname_len = 1 + strlen(filename);
     file = fopen(filename, "r");
     if (!file)
     {
@@ -143,25 +255,27 @@ void oskar_element_load_cst(oskar_Element* data, oskar_Log* log,
     ludwig3 = strstr(line, "Horiz");
 
     /* Create local arrays to hold data for fitting. */
-    theta  = oskar_mem_create(type, OSKAR_CPU, 0, status);
-    phi    = oskar_mem_create(type, OSKAR_CPU, 0, status);
-    h_re   = oskar_mem_create(type, OSKAR_CPU, 0, status);
-    h_im   = oskar_mem_create(type, OSKAR_CPU, 0, status);
-    v_re   = oskar_mem_create(type, OSKAR_CPU, 0, status);
-    v_im   = oskar_mem_create(type, OSKAR_CPU, 0, status);
-    weight = oskar_mem_create(type, OSKAR_CPU, 0, status);
-    if (*status) return;
+    d->theta  = oskar_mem_create(type, OSKAR_CPU, 0, status);
+    d->phi    = oskar_mem_create(type, OSKAR_CPU, 0, status);
+    d->h_re   = oskar_mem_create(type, OSKAR_CPU, 0, status);
+    d->h_im   = oskar_mem_create(type, OSKAR_CPU, 0, status);
+    d->v_re   = oskar_mem_create(type, OSKAR_CPU, 0, status);
+    d->v_im   = oskar_mem_create(type, OSKAR_CPU, 0, status);
+    d->weight = oskar_mem_create(type, OSKAR_CPU, 0, status);
+    if (*status)
+    {
+        free(line);
+        fclose(file);
+        return;
+    }
 
     /* Loop over and read each line in the file. */
-    n = 0;
     while (oskar_getline(&line, &bufsize, file) != OSKAR_ERR_EOF)
     {
         double t = 0., p = 0., abs_theta_horiz, phase_theta_horiz;
         double abs_phi_verti, phase_phi_verti;
         double theta_horiz_re, theta_horiz_im, phi_verti_re, phi_verti_im;
         double h_re_, h_im_, v_re_, v_im_;
-        void *p_theta = 0, *p_phi = 0, *p_h_re = 0, *p_h_im = 0, *p_v_re = 0;
-        void *p_v_im = 0, *p_weight = 0;
 
         /* Parse the line, and skip if data were not read correctly. */
         if (sscanf(line, "%lf %lf %*f %lf %lf %lf %lf %*f", &t, &p,
@@ -187,22 +301,15 @@ void oskar_element_load_cst(oskar_Element* data, oskar_Log* log,
         {
             int size;
             size = n + 100;
-            oskar_mem_realloc(theta, size, status);
-            oskar_mem_realloc(phi, size, status);
-            oskar_mem_realloc(h_re, size, status);
-            oskar_mem_realloc(h_im, size, status);
-            oskar_mem_realloc(v_re, size, status);
-            oskar_mem_realloc(v_im, size, status);
-            oskar_mem_realloc(weight, size, status);
+            oskar_mem_realloc(d->theta, size, status);
+            oskar_mem_realloc(d->phi, size, status);
+            oskar_mem_realloc(d->h_re, size, status);
+            oskar_mem_realloc(d->h_im, size, status);
+            oskar_mem_realloc(d->v_re, size, status);
+            oskar_mem_realloc(d->v_im, size, status);
+            oskar_mem_realloc(d->weight, size, status);
             if (*status) break;
         }
-        p_theta  = oskar_mem_void(theta);
-        p_phi    = oskar_mem_void(phi);
-        p_h_re   = oskar_mem_void(h_re);
-        p_h_im   = oskar_mem_void(h_im);
-        p_v_re   = oskar_mem_void(v_re);
-        p_v_im   = oskar_mem_void(v_im);
-        p_weight = oskar_mem_void(weight);
 
         /* Convert decibel to linear scale if necessary. */
         if (dbi)
@@ -239,90 +346,33 @@ void oskar_element_load_cst(oskar_Element* data, oskar_Log* log,
         }
 
         /* Store the surface data in Ludwig-3 format. */
-        ((double*)p_theta)[n]  = t;
-        ((double*)p_phi)[n]    = p;
-        ((double*)p_h_re)[n]   = h_re_;
-        ((double*)p_h_im)[n]   = h_im_;
-        ((double*)p_v_re)[n]   = v_re_;
-        ((double*)p_v_im)[n]   = v_im_;
-        ((double*)p_weight)[n] = 1.0;
+        oskar_mem_double(d->theta, status)[n]  = t;
+        oskar_mem_double(d->phi, status)[n]    = p;
+        oskar_mem_double(d->h_re, status)[n]   = h_re_;
+        oskar_mem_double(d->h_im, status)[n]   = h_im_;
+        oskar_mem_double(d->v_re, status)[n]   = v_re_;
+        oskar_mem_double(d->v_im, status)[n]   = v_im_;
+        oskar_mem_double(d->weight, status)[n] = 1.0;
 
         /* Increment array pointer. */
         n++;
     }
+    d->n = n;
 
     /* Free the line buffer and close the file. */
     free(line);
     fclose(file);
-
-    /* Fit splines to the surface data. */
-    fit_splines(log, data_h_re, n, theta, phi, h_re, weight,
-            closeness, closeness_inc, "H [real]", status);
-    fit_splines(log, data_h_im, n, theta, phi, h_im, weight,
-            closeness, closeness_inc, "H [imag]", status);
-    fit_splines(log, data_v_re, n, theta, phi, v_re, weight,
-            closeness, closeness_inc, "V [real]", status);
-    fit_splines(log, data_v_im, n, theta, phi, v_im, weight,
-            closeness, closeness_inc, "V [imag]", status);
-
-    /* Store the filename. */
-    if (port == 0)
-    {
-        oskar_mem_append_raw(data->filename_x[i], filename, OSKAR_CHAR,
-                OSKAR_CPU, fname_len, status);
-        oskar_mem_append_raw(data->filename_y[i], filename, OSKAR_CHAR,
-                OSKAR_CPU, fname_len, status);
-    }
-    else if (port == 1)
-    {
-        oskar_mem_append_raw(data->filename_x[i], filename, OSKAR_CHAR,
-                OSKAR_CPU, fname_len, status);
-    }
-    else if (port == 2)
-    {
-        oskar_mem_append_raw(data->filename_y[i], filename, OSKAR_CHAR,
-                OSKAR_CPU, fname_len, status);
-    }
-
-    /* Copy X to Y if both ports are the same. */
-    if (port == 0)
-    {
-        oskar_splines_copy(data->y_h_re[i], data->x_h_re[i], status);
-        oskar_splines_copy(data->y_h_im[i], data->x_h_im[i], status);
-        oskar_splines_copy(data->y_v_re[i], data->x_v_re[i], status);
-        oskar_splines_copy(data->y_v_im[i], data->x_v_im[i], status);
-    }
-
-    /* Free local arrays. */
-    oskar_mem_free(theta, status);
-    oskar_mem_free(phi, status);
-    oskar_mem_free(h_re, status);
-    oskar_mem_free(h_im, status);
-    oskar_mem_free(v_re, status);
-    oskar_mem_free(v_im, status);
-    oskar_mem_free(weight, status);
 }
 
-
-static void fit_splines(oskar_Log* log, oskar_Splines* splines, int n,
-        oskar_Mem* theta, oskar_Mem* phi, oskar_Mem* data, oskar_Mem* weight,
-        double closeness, double closeness_inc, const char* name, int* status)
+static void free_data(CstData* d, int* status)
 {
-    double avg_frac_error;
-    if (*status) return;
-    avg_frac_error = closeness; /* Copy the fitting parameter. */
-    oskar_log_line(log, 'M', ' ');
-    oskar_log_message(log, 'M', 0, "Fitting surface %s...", name);
-    oskar_splines_fit(splines, n, oskar_mem_double(theta, status),
-            oskar_mem_double(phi, status), oskar_mem_double_const(data, status),
-            oskar_mem_double_const(weight, status), OSKAR_SPLINES_SPHERICAL, 1,
-            &avg_frac_error, closeness_inc, 1, 1e-14, status);
-    oskar_log_message(log, 'M', 1, "Surface fitted to %.4f average "
-            "frac. error (s=%.2e).", avg_frac_error,
-            oskar_splines_smoothing_factor(splines));
-    oskar_log_message(log, 'M', 1, "Number of knots (theta, phi) = (%d, %d).",
-            oskar_splines_num_knots_x_theta(splines),
-            oskar_splines_num_knots_y_phi(splines));
+    oskar_mem_free(d->theta, status);
+    oskar_mem_free(d->phi, status);
+    oskar_mem_free(d->h_re, status);
+    oskar_mem_free(d->h_im, status);
+    oskar_mem_free(d->v_re, status);
+    oskar_mem_free(d->v_im, status);
+    oskar_mem_free(d->weight, status);
 }
 
 #ifdef __cplusplus
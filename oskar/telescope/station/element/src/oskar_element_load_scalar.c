@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014-2015, The University of Oxford
+ * Copyright (c) 2014-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -43,29 +43,47 @@ extern "C" {
 
 #define DEG2RAD (M_PI/180.0)
 
-static void fit_splines(oskar_Log* log, oskar_Splines* splines, int n,
-        oskar_Mem* theta, oskar_Mem* phi, oskar_Mem* data, oskar_Mem* weight,
-        double closeness, double closeness_inc, const char* name, int* status);
+/* Surface data read from one file. */
+typedef struct
+{
+    int n;
+    oskar_Mem *theta, *phi, *re, *im, *weight;
+} ScalarData;
+
+static void read_file(ScalarData* d, const char* filename,
+        int ignore_at_poles, int ignore_below_horizon, int* status);
+
+static void free_data(ScalarData* d, int* status);
 
 void oskar_element_load_scalar(oskar_Element* data, oskar_Log* log,
         double freq_hz, const char* filename,
         double closeness, double closeness_inc, int ignore_at_poles,
         int ignore_below_horizon, int* status)
 {
-    int i, n = 0, type = OSKAR_DOUBLE;
-    oskar_Splines *scalar_re = 0, *scalar_im = 0;
-    oskar_Mem *theta = 0, *phi = 0, *re = 0, *im = 0, *weight = 0;
+    oskar_element_load_scalar_files(data, log, 1, &freq_hz, &filename,
+            closeness, closeness_inc, ignore_at_poles, ignore_below_horizon,
+            status);
+}
 
-    /* Declare the line buffer. */
-    char *line = NULL;
-    size_t bufsize = 0;
-    FILE* file;
+void oskar_element_load_scalar_files(oskar_Element* data, oskar_Log* log,
+        int num_files, const double* freq_hz, const char* const* filenames,
+        double closeness, double closeness_inc, int ignore_at_poles,
+        int ignore_below_horizon, int* status)
+{
+    int f, i, j, k, num_surfaces, *freq_id = 0, *num_points = 0;
+    const char* names[] = {"Scalar [real]", "Scalar [imag]"};
+    char* name_buffer = 0;
+    const char** surface_names = 0;
+    ScalarData* d = 0;
+    oskar_Splines** splines = 0;
+    oskar_Mem **theta = 0, **phi = 0;
+    const oskar_Mem **weight = 0, **surfaces = 0;
 
     /* Check if safe to proceed. */
-    if (*status) return;
+    if (*status || num_files <= 0) return;
 
     /* Check the data type. */
-    if (oskar_element_precision(data) != type)
+    if (oskar_element_precision(data) != OSKAR_DOUBLE)
     {
         *status = OSKAR_ERR_TYPE_MISMATCH;
         return;
@@ -78,25 +96,102 @@ void oskar_element_load_scalar(oskar_Element* data, oskar_Log* log,
         return;
     }
 
-    /* Check if this frequency has already been set, and get its index if so. */
-    n = data->num_freq;
-    for (i = 0; i < n; ++i)
-    {
-        if (fabs(data->freqs_hz[i] - freq_hz) <= freq_hz * DBL_EPSILON)
-            break;
-    }
+    /* Allocate arrays to hold the surfaces to fit from all files. */
+    num_surfaces = 2 * num_files;
+    d = (ScalarData*) calloc(num_files, sizeof(ScalarData));
+    freq_id = (int*) calloc(num_files, sizeof(int));
+    num_points = (int*) calloc(num_surfaces, sizeof(int));
+    name_buffer = (char*) calloc(num_surfaces, 64);
+    surface_names = (const char**) calloc(num_surfaces, sizeof(char*));
+    splines = (oskar_Splines**) calloc(num_surfaces, sizeof(oskar_Splines*));
+    theta = (oskar_Mem**) calloc(num_surfaces, sizeof(oskar_Mem*));
+    phi = (oskar_Mem**) calloc(num_surfaces, sizeof(oskar_Mem*));
+    weight = (const oskar_Mem**) calloc(num_surfaces, sizeof(oskar_Mem*));
+    surfaces = (const oskar_Mem**) calloc(num_surfaces, sizeof(oskar_Mem*));
+    if (!d || !freq_id || !num_points || !name_buffer || !surface_names ||
+            !splines || !theta || !phi || !weight || !surfaces)
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
 
-    /* Expand arrays to hold data for a new frequency, if needed. */
-    if (i >= data->num_freq)
+    /* Read all the files. */
+    for (f = 0; f < num_files && !*status; ++f)
     {
-        i = data->num_freq;
-        oskar_element_resize_freq_data(data, i + 1, status);
-        data->freqs_hz[i] = freq_hz;
+        /* Check if this frequency has already been set,
+         * and get its index if so. */
+        for (i = 0; i < data->num_freq; ++i)
+        {
+            if (fabs(data->freqs_hz[i] - freq_hz[f]) <=
+                    freq_hz[f] * DBL_EPSILON)
+                break;
+        }
+
+        /* Expand arrays to hold data for a new frequency, if needed. */
+        if (i >= data->num_freq)
+        {
+            i = data->num_freq;
+            oskar_element_resize_freq_data(data, i + 1, status);
+            if (*status) break;
+            data->freqs_hz[i] = freq_hz[f];
+        }
+        freq_id[f] = i;
+
+        /* Read the surface data. */
+        read_file(&d[f], filenames[f], ignore_at_poles, ignore_below_horizon,
+                status);
+        if (*status) break;
+
+        /* Get pointers to surface data based on frequency index. */
+        k = 2 * f;
+        splines[k + 0] = oskar_element_scalar_re(data, i);
+        splines[k + 1] = oskar_element_scalar_im(data, i);
+        surfaces[k + 0] = d[f].re;
+        surfaces[k + 1] = d[f].im;
+        for (j = 0; j < 2; ++j)
+        {
+            char* name = name_buffer + 64 * (k + j);
+            num_points[k + j] = d[f].n;
+            theta[k + j] = d[f].theta;
+            phi[k + j] = d[f].phi;
+            weight[k + j] = d[f].weight;
+            if (num_files > 1)
+                sprintf(name, "%s at %.3f MHz", names[j], freq_hz[f] / 1e6);
+            else
+                strcpy(name, names[j]);
+            surface_names[k + j] = name;
+        }
     }
 
-    /* Get pointers to surface data based on frequency index. */
-    scalar_re = oskar_element_scalar_re(data, i);
-    scalar_im = oskar_element_scalar_im(data, i);
+    /* Fit splines to the surface data from all files together. */
+    oskar_element_fit_splines(log, num_surfaces, splines, surface_names,
+            num_points, theta, phi, surfaces, weight, closeness,
+            closeness_inc, status);
+
+    /* Store the filenames. */
+    for (f = 0; f < num_files && !*status; ++f)
+        oskar_mem_append_raw(data->filename_scalar[freq_id[f]], filenames[f],
+                OSKAR_CHAR, OSKAR_CPU, 1 + strlen(filenames[f]), status);
+
+    /* Free local arrays. */
+    for (f = 0; d && f < num_files; ++f)
+        free_data(&d[f], status);
+    free(d);
+    free(freq_id);
+    free(num_points);
+    free(name_buffer);
+    free(surface_names);
+    free(splines);
+    free(theta);
+    free(phi);
+    free(weight);
+    free(surfaces);
+}
+
+static void read_file(ScalarData* d, const char* filename,
+        int ignore_at_poles, int ignore_below_horizon, int* status)
+{
+    int n = 0, type = OSKAR_DOUBLE;
+    char *line = NULL;
+    size_t bufsize = 0;
+    FILE* file;
 
     /* Open the file. */
     file = fopen(filename, "r");
@@ -107,20 +202,21 @@ void oskar_element_load_scalar(oskar_Element* data, oskar_Log* log,
     }
 
     /* Create local arrays to hold data for fitting. */
-    theta  = oskar_mem_create(type, OSKAR_CPU, 0, status);
-    phi    = oskar_mem_create(type, OSKAR_CPU, 0, status);
-    re     = oskar_mem_create(type, OSKAR_CPU, 0, status);
-    im     = oskar_mem_create(type, OSKAR_CPU, 0, status);
-    weight = oskar_mem_create(type, OSKAR_CPU, 0, status);
-    if (*status) return;
+    d->theta  = oskar_mem_create(type, OSKAR_CPU, 0, status);
+    d->phi    = oskar_mem_create(type, OSKAR_CPU, 0, status);
+    d->re     = oskar_mem_create(type, OSKAR_CPU, 0, status);
+    d->im     = oskar_mem_create(type, OSKAR_CPU, 0, status);
+    d->weight = oskar_mem_create(type, OSKAR_CPU, 0, status);
+    if (*status)
+    {
+        fclose(file);
+        return;
+    }
 
     /* Loop over and read each line in the file. */
-    n = 0;
     while (oskar_getline(&line, &bufsize, file) != OSKAR_ERR_EOF)
     {
-        double re_, im_;
         double par[] = {0., 0., 0., 0.}; /* theta, phi, amp, phase (optional) */
-        void *p_theta = 0, *p_phi = 0, *p_re = 0, *p_im = 0, *p_weight = 0;
 
         /* Parse the line, and skip if data were not read correctly. */
         if (oskar_string_to_array_d(line, 4, par) < 3)
@@ -143,76 +239,38 @@ void oskar_element_load_scalar(oskar_Element* data, oskar_Log* log,
         {
             int size;
             size = n + 100;
-            oskar_mem_realloc(theta, size, status);
-            oskar_mem_realloc(phi, size, status);
-            oskar_mem_realloc(re, size, status);
-            oskar_mem_realloc(im, size, status);
-            oskar_mem_realloc(weight, size, status);
+            oskar_mem_realloc(d->theta, size, status);
+            oskar_mem_realloc(d->phi, size, status);
+            oskar_mem_realloc(d->re, size, status);
+            oskar_mem_realloc(d->im, size, status);
+            oskar_mem_realloc(d->weight, size, status);
             if (*status) break;
         }
-        p_theta  = oskar_mem_void(theta);
-        p_phi    = oskar_mem_void(phi);
-        p_re     = oskar_mem_void(re);
-        p_im     = oskar_mem_void(im);
-        p_weight = oskar_mem_void(weight);
-
-        /* Amp,phase to real,imag conversion. */
-        re_ = par[2] * cos(par[3]);
-        im_ = par[2] * sin(par[3]);
-
-        /* Store the surface data. */
-        ((double*)p_theta)[n]  = par[0];
-        ((double*)p_phi)[n]    = par[1];
-        ((double*)p_re)[n]     = re_;
-        ((double*)p_im)[n]     = im_;
-        ((double*)p_weight)[n] = 1.0;
+
+        /* Store the surface data, converting amp,phase to real,imag. */
+        oskar_mem_double(d->theta, status)[n]  = par[0];
+        oskar_mem_double(d->phi, status)[n]    = par[1];
+        oskar_mem_double(d->re, status)[n]     = par[2] * cos(par[3]);
+        oskar_mem_double(d->im, status)[n]     = par[2] * sin(par[3]);
+        oskar_mem_double(d->weight, status)[n] = 1.0;
 
         /* Increment array pointer. */
         n++;
     }
+    d->n = n;
 
     /* Free the line buffer and close the file. */
     free(line);
     fclose(file);
-
-    /* Fit splines to the surface data. */
-    fit_splines(log, scalar_re, n, theta, phi, re, weight,
-            closeness, closeness_inc, "Scalar [real]", status);
-    fit_splines(log, scalar_im, n, theta, phi, im, weight,
-            closeness, closeness_inc, "Scalar [imag]", status);
-
-    /* Store the filename. */
-    oskar_mem_append_raw(data->filename_scalar[i], filename, OSKAR_CHAR,
-                OSKAR_CPU, 1 + strlen(filename), status);
-
-    /* Free local arrays. */
-    oskar_mem_free(theta, status);
-    oskar_mem_free(phi, status);
-    oskar_mem_free(re, status);
-    oskar_mem_free(im, status);
-    oskar_mem_free(weight, status);
 }
 
-
-static void fit_splines(oskar_Log* log, oskar_Splines* splines, int n,
-        oskar_Mem* theta, oskar_Mem* phi, oskar_Mem* data, oskar_Mem* weight,
-        double closeness, double closeness_inc, const char* name, int* status)
+static void free_data(ScalarData* d, int* status)
 {
-    double avg_frac_error;
-    if (*status) return;
-    avg_frac_error = closeness; /* Copy the fitting parameter. */
-    oskar_log_message(log, 'M', 0, "");
-    oskar_log_message(log, 'M', 0, "Fitting surface %s...", name);
-    oskar_splines_fit(splines, n, oskar_mem_double(theta, status),
-            oskar_mem_double(phi, status), oskar_mem_double_const(data, status),
-            oskar_mem_double_const(weight, status), OSKAR_SPLINES_SPHERICAL, 1,
-            &avg_frac_error, closeness_inc, 1, 1e-14, status);
-    oskar_log_message(log, 'M', 1, "Surface fitted to %.4f average "
-            "frac. error (s=%.2e).", avg_frac_error,
-            oskar_splines_smoothing_factor(splines));
-    oskar_log_message(log, 'M', 1, "Number of knots (theta, phi) = (%d, %d).",
-            oskar_splines_num_knots_x_theta(splines),
-            oskar_splines_num_knots_y_phi(splines));
+    oskar_mem_free(d->theta, status);
+    oskar_mem_free(d->phi, status);
+    oskar_mem_free(d->re, status);
+    oskar_mem_free(d->im, status);
+    oskar_mem_free(d->weight, status);
 }
 
 #ifdef __cplusplus
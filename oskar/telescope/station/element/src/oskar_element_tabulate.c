@@ -0,0 +1,394 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "telescope/station/element/private_element.h"
+#include "telescope/station/element/private_element_tables.h"
+#include "telescope/station/element/oskar_element.h"
+#include "math/oskar_cmath.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Sets up the interpolation stencil for one position, returning the number
+ * of taps in each dimension. Fills in the table row offset and weight for
+ * each tap in theta, and the column and weight for each tap in phi.
+ * Columns depend on the row, because rows beyond a pole are taken from
+ * the opposite side of the sphere.
+ */
+static int stencil(double theta, double phi, int num_theta, int num_phi,
+        int interp, int row[4], int col[4][4], double wt[4], double wp[4])
+{
+    int it, ip, j, k;
+    double t, p;
+    double ft = theta / (M_PI / (num_theta - 1));
+    double fp = phi / (2.0 * M_PI / num_phi);
+    if (ft < 0.0) ft = 0.0;
+    if (ft > num_theta - 1) ft = num_theta - 1;
+    it = (int) ft;
+    if (it > num_theta - 2) it = num_theta - 2;
+    t = ft - it;
+    fp = fmod(fp, (double) num_phi);
+    if (fp < 0.0) fp += num_phi;
+    ip = (int) fp;
+    p = fp - ip;
+    if (ip >= num_phi) ip -= num_phi;
+    if (interp == OSKAR_ELEMENT_TABLE_BILINEAR)
+    {
+        wt[0] = 1.0 - t;
+        wt[1] = t;
+        wp[0] = 1.0 - p;
+        wp[1] = p;
+        for (j = 0; j < 2; ++j)
+        {
+            row[j] = (it + j) * num_phi;
+            col[j][0] = ip;
+            col[j][1] = (ip + 1 < num_phi) ? ip + 1 : 0;
+        }
+        return 2;
+    }
+
+    /* Catmull-Rom cubic convolution weights. */
+    wt[0] = ((-0.5 * t + 1.0) * t - 0.5) * t;
+    wt[1] = (1.5 * t - 2.5) * t * t + 1.0;
+    wt[2] = ((-1.5 * t + 2.0) * t + 0.5) * t;
+    wt[3] = (0.5 * t - 0.5) * t * t;
+    wp[0] = ((-0.5 * p + 1.0) * p - 0.5) * p;
+    wp[1] = (1.5 * p - 2.5) * p * p + 1.0;
+    wp[2] = ((-1.5 * p + 2.0) * p + 0.5) * p;
+    wp[3] = (0.5 * p - 0.5) * p * p;
+    for (j = 0; j < 4; ++j)
+    {
+        int r = it - 1 + j, shift = 0;
+        if (r < 0)
+        {
+            r = -r;
+            shift = num_phi / 2;
+        }
+        else if (r > num_theta - 1)
+        {
+            r = 2 * (num_theta - 1) - r;
+            shift = num_phi / 2;
+        }
+        row[j] = r * num_phi;
+        for (k = 0; k < 4; ++k)
+        {
+            int c = ip - 1 + k + shift;
+            if (c < 0) c += num_phi;
+            if (c >= num_phi) c -= num_phi;
+            col[j][k] = c;
+        }
+    }
+    return 4;
+}
+
+static void interpolate_table_f(const float* table, int num_comp,
+        int num_theta, int num_phi, int interp, int num_points,
+        const float* theta, const float* phi, int stride, float* out)
+{
+    int i;
+    #pragma omp parallel for private(i)
+    for (i = 0; i < num_points; ++i)
+    {
+        int c, j, k, taps, row[4], col[4][4];
+        double wt[4], wp[4];
+        float sum[4];
+        taps = stencil(theta[i], phi[i], num_theta, num_phi, interp,
+                row, col, wt, wp);
+        for (c = 0; c < num_comp; ++c) sum[c] = 0.0f;
+        for (j = 0; j < taps; ++j)
+        {
+            for (k = 0; k < taps; ++k)
+            {
+                const float w = (float) (wt[j] * wp[k]);
+                const float* t = &table[(row[j] + col[j][k]) * num_comp];
+                for (c = 0; c < num_comp; ++c) sum[c] += w * t[c];
+            }
+        }
+        for (c = 0; c < num_comp; ++c) out[i * stride + c] = sum[c];
+    }
+}
+
+static void interpolate_table_d(const double* table, int num_comp,
+        int num_theta, int num_phi, int interp, int num_points,
+        const double* theta, const double* phi, int stride, double* out)
+{
+    int i;
+    #pragma omp parallel for private(i)
+    for (i = 0; i < num_points; ++i)
+    {
+        int c, j, k, taps, row[4], col[4][4];
+        double wt[4], wp[4];
+        double sum[4];
+        taps = stencil(theta[i], phi[i], num_theta, num_phi, interp,
+                row, col, wt, wp);
+        for (c = 0; c < num_comp; ++c) sum[c] = 0.0;
+        for (j = 0; j < taps; ++j)
+        {
+            for (k = 0; k < taps; ++k)
+            {
+                const double w = (double) (wt[j] * wp[k]);
+                const double* t = &table[(row[j] + col[j][k]) * num_comp];
+                for (c = 0; c < num_comp; ++c) sum[c] += w * t[c];
+            }
+        }
+        for (c = 0; c < num_comp; ++c) out[i * stride + c] = sum[c];
+    }
+}
+
+void oskar_element_interpolate_table(const oskar_Mem* table,
+        int num_components, int num_theta, int num_phi, int interp,
+        int num_points, const oskar_Mem* theta, const oskar_Mem* phi,
+        int offset, int stride, oskar_Mem* output, int* status)
+{
+    int type;
+    if (*status) return;
+    type = oskar_mem_type(table);
+    if (oskar_mem_location(table) != OSKAR_CPU ||
+            oskar_mem_location(output) != OSKAR_CPU ||
+            oskar_mem_location(theta) != OSKAR_CPU ||
+            oskar_mem_location(phi) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    if (oskar_mem_type(theta) != type || oskar_mem_type(phi) != type ||
+            oskar_mem_precision(output) != type)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (num_components < 1 || num_components > 4 || num_theta < 2 ||
+            num_phi < 2 || (interp != OSKAR_ELEMENT_TABLE_BILINEAR &&
+                    interp != OSKAR_ELEMENT_TABLE_BICUBIC))
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return;
+    }
+    if (type == OSKAR_DOUBLE)
+        interpolate_table_d(oskar_mem_double_const(table, status),
+                num_components, num_theta, num_phi, interp, num_points,
+                oskar_mem_double_const(theta, status),
+                oskar_mem_double_const(phi, status), stride,
+                oskar_mem_double(output, status) + offset);
+    else if (type == OSKAR_SINGLE)
+        interpolate_table_f(oskar_mem_float_const(table, status),
+                num_components, num_theta, num_phi, interp, num_points,
+                oskar_mem_float_const(theta, status),
+                oskar_mem_float_const(phi, status), stride,
+                oskar_mem_float(output, status) + offset);
+    else
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+}
+
+/* Returns the largest absolute difference between a and b relative to the
+ * largest absolute value in a. */
+static double max_rel_diff(const oskar_Mem* a, const oskar_Mem* b,
+        int* status)
+{
+    size_t i, n;
+    double peak = 0.0, diff = 0.0;
+    n = oskar_mem_length(a);
+    if (oskar_mem_precision(a) == OSKAR_DOUBLE)
+    {
+        const double *a_ = oskar_mem_double_const(a, status);
+        const double *b_ = oskar_mem_double_const(b, status);
+        for (i = 0; i < n; ++i)
+        {
+            if (fabs(a_[i]) > peak) peak = fabs(a_[i]);
+            if (fabs(a_[i] - b_[i]) > diff) diff = fabs(a_[i] - b_[i]);
+        }
+    }
+    else
+    {
+        const float *a_ = oskar_mem_float_const(a, status);
+        const float *b_ = oskar_mem_float_const(b, status);
+        for (i = 0; i < n; ++i)
+        {
+            if (fabs(a_[i]) > peak) peak = fabs(a_[i]);
+            if (fabs(a_[i] - b_[i]) > diff) diff = fabs(a_[i] - b_[i]);
+        }
+    }
+    return peak > 0.0 ? diff / peak : 0.0;
+}
+
+/* Fills coordinate arrays for a grid, optionally shifted by half a cell. */
+static void grid_coords(int num_theta, int num_phi, int half_cell,
+        oskar_Mem* theta, oskar_Mem* phi, int* status)
+{
+    int i, j, k = 0, rows;
+    const double inc_theta = M_PI / (num_theta - 1);
+    const double inc_phi = 2.0 * M_PI / num_phi;
+    const double shift = half_cell ? 0.5 : 0.0;
+    rows = half_cell ? num_theta - 1 : num_theta;
+    oskar_mem_realloc(theta, rows * num_phi, status);
+    oskar_mem_realloc(phi, rows * num_phi, status);
+    if (*status) return;
+    for (i = 0; i < rows; ++i)
+    {
+        for (j = 0; j < num_phi; ++j, ++k)
+        {
+            const double t = (i + shift) * inc_theta;
+            const double p = (j + shift) * inc_phi;
+            if (oskar_mem_precision(theta) == OSKAR_DOUBLE)
+            {
+                oskar_mem_double(theta, status)[k] = t;
+                oskar_mem_double(phi, status)[k] = p;
+            }
+            else
+            {
+                oskar_mem_float(theta, status)[k] = (float) t;
+                oskar_mem_float(phi, status)[k] = (float) p;
+            }
+        }
+    }
+}
+
+static void tabulate_surfaces(const oskar_Element* model, oskar_Mem* table,
+        int num_splines, const oskar_Splines* const* splines,
+        oskar_Mem* theta, oskar_Mem* phi, oskar_Mem* ref, oskar_Mem* test,
+        double* max_rel_error, int* status)
+{
+    double err;
+    const int nt = model->table_num_theta, np = model->table_num_phi;
+
+    /* Sample the surfaces on the grid. */
+    grid_coords(nt, np, 0, theta, phi, status);
+    oskar_mem_realloc(table, nt * np * num_splines, status);
+    oskar_splines_evaluate_fused(table, 0, num_splines, num_splines, splines,
+            nt * np, theta, phi, status);
+
+    /* Compare splines with the interpolated table at the cell centres. */
+    grid_coords(nt, np, 1, theta, phi, status);
+    oskar_mem_realloc(ref, (nt - 1) * np * num_splines, status);
+    oskar_mem_realloc(test, (nt - 1) * np * num_splines, status);
+    oskar_splines_evaluate_fused(ref, 0, num_splines, num_splines, splines,
+            (nt - 1) * np, theta, phi, status);
+    oskar_element_interpolate_table(table, num_splines, nt, np,
+            model->table_interp, (nt - 1) * np, theta, phi, 0, num_splines,
+            test, status);
+    if (*status) return;
+    err = max_rel_diff(ref, test, status);
+    if (err > *max_rel_error) *max_rel_error = err;
+}
+
+void oskar_element_tabulate(oskar_Element* model, int interp,
+        double resolution_rad, double* max_rel_error, int* status)
+{
+    int i, type;
+    double err = 0.0;
+    oskar_Mem *theta, *phi, *ref, *test;
+    const oskar_Splines* s[4];
+
+    /* Check if safe to proceed. */
+    if (max_rel_error) *max_rel_error = 0.0;
+    if (*status) return;
+
+    /* Check the location and parameters. */
+    if (model->mem_location != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    if (interp != OSKAR_ELEMENT_TABLE_NONE &&
+            interp != OSKAR_ELEMENT_TABLE_BILINEAR &&
+            interp != OSKAR_ELEMENT_TABLE_BICUBIC)
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return;
+    }
+    if (interp != OSKAR_ELEMENT_TABLE_NONE && !(resolution_rad > 0.0))
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return;
+    }
+
+    /* Release any existing tables, which may be shared with copies. */
+    model->table_interp = interp;
+    model->table_num_theta = 0;
+    model->table_num_phi = 0;
+    oskar_element_tables_release(model->tables, status);
+    model->tables = 0;
+    if (interp == OSKAR_ELEMENT_TABLE_NONE) return;
+    model->tables = oskar_element_tables_create(model->precision,
+            model->num_freq, status);
+    if (*status) return;
+
+    /* Set the grid size, using an even number of points in phi so that
+     * the point opposite any grid point across a pole is also on the grid. */
+    model->table_num_theta = 1 + (int) ceil(M_PI / resolution_rad);
+    model->table_num_phi = (int) ceil(2.0 * M_PI / resolution_rad);
+    model->table_num_phi += (model->table_num_phi % 2);
+    if (model->table_num_theta < 3) model->table_num_theta = 3;
+    if (model->table_num_phi < 4) model->table_num_phi = 4;
+
+    /* Tabulate all surfaces that have been fitted. */
+    type = model->precision;
+    theta = oskar_mem_create(type, OSKAR_CPU, 0, status);
+    phi = oskar_mem_create(type, OSKAR_CPU, 0, status);
+    ref = oskar_mem_create(type, OSKAR_CPU, 0, status);
+    test = oskar_mem_create(type, OSKAR_CPU, 0, status);
+    for (i = 0; i < model->num_freq; ++i)
+    {
+        if (oskar_element_has_x_spline_data(model))
+        {
+            s[0] = model->x_h_re[i];
+            s[1] = model->x_h_im[i];
+            s[2] = model->x_v_re[i];
+            s[3] = model->x_v_im[i];
+            tabulate_surfaces(model, model->tables->x[i], 4, s,
+                    theta, phi, ref, test, &err, status);
+        }
+        if (oskar_element_has_y_spline_data(model))
+        {
+            s[0] = model->y_h_re[i];
+            s[1] = model->y_h_im[i];
+            s[2] = model->y_v_re[i];
+            s[3] = model->y_v_im[i];
+            tabulate_surfaces(model, model->tables->y[i], 4, s,
+                    theta, phi, ref, test, &err, status);
+        }
+        if (oskar_element_has_scalar_spline_data(model))
+        {
+            s[0] = model->scalar_re[i];
+            s[1] = model->scalar_im[i];
+            tabulate_surfaces(model, model->tables->scalar[i], 2, s,
+                    theta, phi, ref, test, &err, status);
+        }
+    }
+    oskar_mem_free(theta, status);
+    oskar_mem_free(phi, status);
+    oskar_mem_free(ref, status);
+    oskar_mem_free(test, status);
+    if (max_rel_error) *max_rel_error = err;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "telescope/station/element/private_element_tables.h"
+#include "utility/oskar_thread.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+oskar_ElementTables* oskar_element_tables_create(int precision, int num_freq,
+        int* status)
+{
+    int i;
+    oskar_ElementTables* t;
+    if (*status) return 0;
+    t = (oskar_ElementTables*) calloc(1, sizeof(oskar_ElementTables));
+    if (!t)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+    t->ref_count = 1;
+    t->x = (oskar_Mem**) calloc(num_freq, sizeof(oskar_Mem*));
+    t->y = (oskar_Mem**) calloc(num_freq, sizeof(oskar_Mem*));
+    t->scalar = (oskar_Mem**) calloc(num_freq, sizeof(oskar_Mem*));
+    if (num_freq > 0 && (!t->x || !t->y || !t->scalar))
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        oskar_element_tables_release(t, status);
+        return 0;
+    }
+    t->num_freq = num_freq;
+    for (i = 0; i < num_freq; ++i)
+    {
+        t->x[i] = oskar_mem_create(precision, OSKAR_CPU, 0, status);
+        t->y[i] = oskar_mem_create(precision, OSKAR_CPU, 0, status);
+        t->scalar[i] = oskar_mem_create(precision, OSKAR_CPU, 0, status);
+    }
+    return t;
+}
+
+void oskar_element_tables_set(oskar_Element* model,
+        oskar_ElementTables* tables, int* status)
+{
+    /* Take the new reference before releasing the old one,
+     * in case they are the same. */
+    if (tables) oskar_atomic_add_int(&tables->ref_count, 1);
+    oskar_element_tables_release(model->tables, status);
+    model->tables = tables;
+}
+
+void oskar_element_tables_release(oskar_ElementTables* tables, int* status)
+{
+    int i;
+    if (!tables) return;
+    if (oskar_atomic_add_int(&tables->ref_count, -1) != 1) return;
+    for (i = 0; i < tables->num_freq; ++i)
+    {
+        oskar_mem_free(tables->x[i], status);
+        oskar_mem_free(tables->y[i], status);
+        oskar_mem_free(tables->scalar[i], status);
+    }
+    free(tables->x);
+    free(tables->y);
+    free(tables->scalar);
+    free(tables);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_EVALUATE_STATION_BEAM_LUT_H_
+#define OSKAR_EVALUATE_STATION_BEAM_LUT_H_
+
+/**
+ * @file oskar_evaluate_station_beam_lut.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+#include <telescope/station/oskar_station.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Evaluates the station beam for an aperture array station using
+ * a look-up table.
+ *
+ * @details
+ * This function evaluates the beam for an aperture array station by
+ * interpolating it from a look-up table, if this has been enabled using
+ * oskar_station_set_beam_lut_oversample(). Otherwise, the beam is
+ * evaluated directly using oskar_evaluate_station_beam_aperture_array().
+ *
+ * The look-up table samples the beam on a regular grid in the azimuthal
+ * equidistant projection about the zenith, with coordinates
+ * (p, q) = (2 theta / pi) (cos phi, sin phi), so that the whole sky down
+ * to the horizon is covered. The grid spacing is chosen
+ * to give the requested number of samples across the width of the station
+ * beam, using the size of the station and the observing frequency.
+ * Beam values are then obtained using cubic convolution interpolation.
+ *
+ * Tables are held in the work structure, so that each distinct station
+ * beam is evaluated only once for each time and frequency, however many
+ * source positions are requested. The table is regenerated if the station
+ * model, beam direction, time or frequency changes. When a table is
+ * generated, the interpolation error is estimated at a set of test points,
+ * and the largest value is available from
+ * oskar_station_work_beam_lut_error().
+ *
+ * Tables are only used if all data are in CPU memory, if the grid is
+ * not too large, and if they have not been disabled using
+ * oskar_station_work_set_beam_lut(): the beam is evaluated directly
+ * otherwise. The least recently used tables are discarded if the total
+ * size would exceed oskar_station_work_beam_lut_max_bytes(), so callers
+ * should check that their working set of tables fits, using
+ * oskar_evaluate_station_beam_lut_bytes().
+ *
+ * @param[out]    beam          Station beam evaluated at x,y,z positions.
+ * @param[in]     station       Fully populated station model structure.
+ * @param[in]     num_points    Number of coordinates at which to evaluate
+ *                              the beam.
+ * @param[in]     x             Array of horizontal x coordinates at which to
+ *                              evaluate the beam.
+ * @param[in]     y             Array of horizontal y coordinates at which to
+ *                              evaluate the beam.
+ * @param[in]     z             Array of horizontal z coordinates at which to
+ *                              evaluate the beam.
+ * @param[in]     gast          The Greenwich Apparent Sidereal Time in radians.
+ * @param[in]     frequency_hz  The observing frequency, in Hz.
+ * @param[in]     work          Initialised structure containing temporary work
+ *                              buffers.
+ * @param[in]     time_index    Simulation time index.
+ * @param[in,out] status        Status return code.
+ */
+OSKAR_EXPORT
+void oskar_evaluate_station_beam_lut(oskar_Mem* beam,
+        const oskar_Station* station, int num_points, const oskar_Mem* x,
+        const oskar_Mem* y, const oskar_Mem* z, double gast,
+        double frequency_hz, oskar_StationWork* work, int time_index,
+        int* status);
+
+/**
+ * @brief
+ * Returns the size of one station beam look-up table.
+ *
+ * @details
+ * Returns the number of bytes needed for the look-up table of the station
+ * at the given frequency, for beam data of the given type.
+ * Zero is returned if the station does not use a look-up table.
+ *
+ * @param[in]     station       Station model structure.
+ * @param[in]     frequency_hz  The observing frequency, in Hz.
+ * @param[in]     type          Enumerated data type of the station beam.
+ * @param[in,out] status        Status return code.
+ */
+OSKAR_EXPORT
+size_t oskar_evaluate_station_beam_lut_bytes(const oskar_Station* station,
+        double frequency_hz, int type, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_EVALUATE_STATION_BEAM_LUT_H_ */
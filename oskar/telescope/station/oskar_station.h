@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2015, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -66,6 +66,7 @@ enum OSKAR_STATION_TYPE
 #include <telescope/station/oskar_station_different.h>
 #include <telescope/station/oskar_station_duplicate_first_child.h>
 #include <telescope/station/oskar_station_free.h>
+#include <telescope/station/oskar_station_layout_hash.h>
 #include <telescope/station/oskar_station_load_apodisation.h>
 #include <telescope/station/oskar_station_load_element_types.h>
 #include <telescope/station/oskar_station_load_feed_angle.h>
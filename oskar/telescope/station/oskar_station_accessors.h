@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2015, The University of Oxford
+ * Copyright (c) 2013-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -152,6 +152,12 @@ int oskar_station_normalise_array_pattern(const oskar_Station* model);
 OSKAR_EXPORT
 int oskar_station_enable_array_pattern(const oskar_Station* model);
 
+OSKAR_EXPORT
+double oskar_station_nufft_tolerance(const oskar_Station* model);
+
+OSKAR_EXPORT
+double oskar_station_beam_lut_oversample(const oskar_Station* model);
+
 OSKAR_EXPORT
 int oskar_station_common_element_orientation(const oskar_Station* model);
 
@@ -450,6 +456,40 @@ void oskar_station_set_normalise_array_pattern(oskar_Station* model, int value);
 OSKAR_EXPORT
 void oskar_station_set_enable_array_pattern(oskar_Station* model, int value);
 
+/**
+ * @brief
+ * Sets the tolerance of the NUFFT used to evaluate the array pattern.
+ *
+ * @details
+ * If greater than zero, the array pattern is evaluated using a
+ * non-uniform FFT with the given accuracy relative to its peak, where
+ * this is likely to be faster than the DFT (see oskar_dftw_nufft()).
+ * If zero (the default), the DFT is always used.
+ *
+ * @param[in] model  Pointer to station model.
+ * @param[in] value  Required accuracy, or 0 to use the DFT.
+ */
+OSKAR_EXPORT
+void oskar_station_set_nufft_tolerance(oskar_Station* model, double value);
+
+/**
+ * @brief
+ * Sets the sampling of the station beam look-up table.
+ *
+ * @details
+ * If greater than zero, the beam of an aperture array station is evaluated
+ * on a grid of horizon direction cosines, with this number of samples
+ * per station beamwidth, and interpolated to the source positions
+ * (see oskar_evaluate_station_beam_lut()).
+ * If zero (the default), the beam is evaluated directly at every source.
+ *
+ * @param[in] model  Pointer to station model.
+ * @param[in] value  Samples per beamwidth, or 0 to evaluate directly.
+ */
+OSKAR_EXPORT
+void oskar_station_set_beam_lut_oversample(oskar_Station* model,
+        double value);
+
 /**
  * @brief
  * Sets the seed used to generate time-variable errors.
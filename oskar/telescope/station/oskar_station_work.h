@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2014, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -75,6 +75,46 @@ oskar_StationWork* oskar_station_work_create(int type, int location,
 OSKAR_EXPORT
 void oskar_station_work_free(oskar_StationWork* work, int* status);
 
+/**
+ * @brief Returns the estimated error of the station beam look-up tables.
+ *
+ * @details
+ * Returns the largest estimated interpolation error of any station beam
+ * look-up table generated using this work buffer, relative to the peak
+ * of the beam (see oskar_evaluate_station_beam_lut()).
+ *
+ * @param[in] work  Pointer to work buffer structure.
+ */
+OSKAR_EXPORT
+double oskar_station_work_beam_lut_error(const oskar_StationWork* work);
+
+/**
+ * @brief Enables or disables station beam look-up tables.
+ *
+ * @details
+ * If disabled, oskar_evaluate_station_beam_lut() evaluates all station
+ * beams directly, even if the station has look-up tables enabled.
+ * Look-up tables are enabled by default.
+ *
+ * @param[in,out] work     Pointer to work buffer structure.
+ * @param[in]     enabled  If true, allow look-up tables; if false, don't.
+ */
+OSKAR_EXPORT
+void oskar_station_work_set_beam_lut(oskar_StationWork* work, int enabled);
+
+/**
+ * @brief Returns the memory limit for station beam look-up tables.
+ *
+ * @details
+ * Returns the maximum number of bytes used by all station beam look-up
+ * tables held in the work buffer. If a new table would exceed this,
+ * the least recently used tables are discarded.
+ *
+ * @param[in] work  Pointer to work buffer structure.
+ */
+OSKAR_EXPORT
+size_t oskar_station_work_beam_lut_max_bytes(const oskar_StationWork* work);
+
 /* Accessors. */
 
 OSKAR_EXPORT
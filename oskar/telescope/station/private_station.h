@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2015, The University of Oxford
+ * Copyright (c) 2011-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -71,6 +71,8 @@ struct oskar_Station
     int num_element_types;        /* Number of element types (this is the size of element_pattern array). */
     int normalise_array_pattern;  /* True if the station beam should be normalised by the number of antennas. */
     int enable_array_pattern;     /* True if the array factor should be evaluated. */
+    double nufft_tolerance;       /* Tolerance of NUFFT used for array factor (0 to use DFT). */
+    double beam_lut_oversample;   /* Samples per station beamwidth in beam look-up table (0 to evaluate directly). */
     int common_element_orientation; /* True if elements share a common orientation (auto determined). */
     int array_is_3d;              /* True if array is 3-dimensional (auto determined; default false). */
     int apply_element_errors;     /* True if element gain and phase errors should be applied (auto determined; default false). */
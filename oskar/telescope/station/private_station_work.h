@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2015, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -31,6 +31,22 @@
 
 #include <mem/oskar_mem.h>
 
+#define OSKAR_STATION_WORK_MAX_BEAM_LUT_BYTES ((size_t)512 << 20)
+
+/* Station beam sampled on a grid of horizon direction cosines. */
+struct oskar_StationWorkBeamLut
+{
+    unsigned long long layout_hash;    /* Hash of the station model. */
+    int unique_id;                     /* Station ID (for element errors). */
+    double lon_rad, lat_rad;           /* Station position. */
+    double beam_x, beam_y, beam_z;     /* Station beam direction. */
+    double gast, frequency_hz;
+    int time_index, type, grid_side;
+    unsigned long long last_used;      /* For least-recently-used eviction. */
+    oskar_Mem* grid;                   /* Beam at grid_side^2 grid points. */
+};
+typedef struct oskar_StationWorkBeamLut oskar_StationWorkBeamLut;
+
 struct oskar_StationWork
 {
     oskar_Mem* horizon_mask;     /* Integer. */
@@ -49,6 +65,13 @@ struct oskar_StationWork
 
     int num_depths;
     oskar_Mem** beam;            /* For hierarchical stations. */
+
+    /* Station beam look-up tables. */
+    int beam_lut_enabled, num_beam_luts;
+    size_t beam_lut_max_bytes;
+    unsigned long long beam_lut_counter;
+    double beam_lut_error;             /* Largest estimated relative error. */
+    oskar_StationWorkBeamLut* beam_lut;
 };
 
 #ifndef OSKAR_STATION_WORK_TYPEDEF_
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2016, The University of Oxford
+ * Copyright (c) 2013-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -29,6 +29,7 @@
 #include "telescope/station/oskar_evaluate_station_beam.h"
 #include "telescope/station/oskar_evaluate_station_beam_aperture_array.h"
 #include "telescope/station/oskar_evaluate_station_beam_gaussian.h"
+#include "telescope/station/oskar_evaluate_station_beam_lut.h"
 #include "telescope/station/oskar_evaluate_vla_beam_pbcor.h"
 #include "convert/oskar_convert_relative_directions_to_enu_directions.h"
 #include "convert/oskar_convert_enu_directions_to_relative_directions.h"
@@ -204,7 +205,7 @@ static void evaluate_station_beam_relative_directions(oskar_Mem* beam_pattern,
     {
         case OSKAR_STATION_TYPE_AA:
         {
-            oskar_evaluate_station_beam_aperture_array(beam_pattern, station,
+            oskar_evaluate_station_beam_lut(beam_pattern, station,
                     np, x, y, z, GAST, frequency_hz, work, time_index, status);
             break;
         }
@@ -248,7 +249,7 @@ static void evaluate_station_beam_enu_directions(oskar_Mem* beam_pattern,
     {
         case OSKAR_STATION_TYPE_AA:
         {
-            oskar_evaluate_station_beam_aperture_array(beam_pattern, station,
+            oskar_evaluate_station_beam_lut(beam_pattern, station,
                     np, x, y, z, GAST, frequency_hz, work, time_index, status);
             break;
         }
@@ -36,6 +36,8 @@
 
 #include "math/oskar_cmath.h"
 #include "math/oskar_dftw.h"
+#include "math/oskar_dftw_indexed_input.h"
+#include "math/oskar_dftw_nufft.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -154,16 +156,17 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
             /* Check if array pattern is enabled. */
             if (oskar_station_enable_array_pattern(s))
             {
-                /* Generate beamforming weights and evaluate array pattern. */
+                /* Generate beamforming weights and evaluate array pattern.
+                 * Use the NUFFT if enabled (it falls back to the DFT). */
                 oskar_evaluate_element_weights(weights, weights_error,
                         wavenumber, s, beam_x, beam_y, beam_z,
                         time_index, status);
-                oskar_dftw(num_elements, wavenumber,
+                oskar_dftw_nufft(num_elements, wavenumber,
                         oskar_station_element_true_x_enu_metres_const(s),
                         oskar_station_element_true_y_enu_metres_const(s),
                         oskar_station_element_true_z_enu_metres_const(s),
-                        weights, num_points, x, y, (is_3d ? z : 0), 0, array,
-                        status);
+                        weights, num_points, x, y, (is_3d ? z : 0),
+                        oskar_station_nufft_tolerance(s), array, status);
 
                 /* Normalise array response if required. */
                 if (oskar_station_normalise_array_pattern(s))
@@ -174,11 +177,16 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
             }
         }
 
-#if 0
         /* Second optimisation: Common orientation for all elements within the
          * station, but more than one element type. */
-        else if (oskar_station_common_element_orientation(s))
+        /* Element patterns need only be evaluated once for each type. */
+        else if (oskar_station_common_element_orientation(s) &&
+                oskar_mem_location(beam) == OSKAR_CPU)
         {
+            int i, num_element_types;
+            oskar_Mem *element_block = 0, *element = 0;
+            const int* element_type_array = 0;
+
             /* Must evaluate array pattern, so check that this is enabled. */
             if (!oskar_station_enable_array_pattern(s))
             {
@@ -186,11 +194,58 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
                 return;
             }
 
-            /* Call a DFT using indexed input. */
-            /* TODO Not yet implemented. */
-            *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
+            /* Check that all element type indices are in range. */
+            element_type_array = oskar_station_element_types_cpu_const(s);
+            num_element_types = oskar_station_num_element_types(s);
+            for (i = 0; i < num_elements; ++i)
+            {
+                if (element_type_array[i] < 0 ||
+                        element_type_array[i] >= num_element_types)
+                {
+                    *status = OSKAR_ERR_OUT_OF_RANGE;
+                    return;
+                }
+            }
+
+            /* Get sized element pattern block (at depth 0). */
+            element_block = oskar_station_work_beam(work, beam,
+                    num_element_types * num_points, 0, status);
+
+            /* Create alias into element block. */
+            element = oskar_mem_create_alias(element_block, 0, 0, status);
+
+            /* Evaluate the response for each element type. */
+            for (i = 0; i < num_element_types; ++i)
+            {
+                oskar_mem_set_alias(element, element_block, i * num_points,
+                        num_points, status);
+                oskar_element_evaluate(oskar_station_element_const(s, i),
+                        element,
+                        oskar_station_element_x_alpha_rad(s, 0) + M_PI/2.0, /* FIXME Will change: This matches the old convention. */
+                        oskar_station_element_y_alpha_rad(s, 0),
+                        num_points, x, y, z, frequency_hz, theta, phi, status);
+            }
+
+            /* Generate beamforming weights. */
+            oskar_evaluate_element_weights(weights, weights_error,
+                    wavenumber, s, beam_x, beam_y, beam_z,
+                    time_index, status);
+
+            /* Use DFT with indexed input to evaluate array response. */
+            oskar_dftw_indexed_input(num_elements, wavenumber,
+                    oskar_station_element_true_x_enu_metres_const(s),
+                    oskar_station_element_true_y_enu_metres_const(s),
+                    oskar_station_element_true_z_enu_metres_const(s),
+                    weights, oskar_station_element_types_const(s),
+                    num_points, x, y, z, element_block, beam, status);
+
+            /* Free element alias. */
+            oskar_mem_free(element, status);
+
+            /* Normalise array response if required. */
+            if (oskar_station_normalise_array_pattern(s))
+                oskar_mem_scale_real(beam, 1.0 / num_elements, status);
         }
-#endif
 
         /* No optimisation: No common element orientation. */
         /* Can't separate array and element evaluation. */
@@ -0,0 +1,669 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "telescope/station/oskar_evaluate_station_beam_lut.h"
+#include "telescope/station/oskar_evaluate_station_beam_aperture_array.h"
+#include "telescope/station/oskar_evaluate_beam_horizon_direction.h"
+#include "telescope/station/oskar_blank_below_horizon.h"
+#include "telescope/station/private_station_work.h"
+#include "math/oskar_cmath.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MAX_GRID_SIDE 2049
+#define BLOCK_SIZE 16384
+#define NUM_TEST_POINTS 64
+
+/* Returns the largest distance of any element from the station centre,
+ * including the size of any child stations. */
+static double station_radius(const oskar_Station* s, int* status)
+{
+    int i, num_elements;
+    double r, r_max = 0.0, r_child = 0.0;
+    const oskar_Mem *x, *y, *z;
+    num_elements = oskar_station_num_elements(s);
+    x = oskar_station_element_true_x_enu_metres_const(s);
+    y = oskar_station_element_true_y_enu_metres_const(s);
+    z = oskar_station_element_true_z_enu_metres_const(s);
+    for (i = 0; i < num_elements; ++i)
+    {
+        const double x_ = oskar_mem_get_element(x, i, status);
+        const double y_ = oskar_mem_get_element(y, i, status);
+        const double z_ = oskar_mem_get_element(z, i, status);
+        r = sqrt(x_*x_ + y_*y_ + z_*z_);
+        if (r > r_max) r_max = r;
+    }
+    if (oskar_station_has_child(s))
+    {
+        for (i = 0; i < num_elements; ++i)
+        {
+            r = station_radius(oskar_station_child_const(s, i), status);
+            if (r > r_child) r_child = r;
+        }
+    }
+    return r_max + r_child;
+}
+
+/*
+ * The grid uses the azimuthal equidistant projection, with coordinates
+ * (p, q) = (2 theta / pi) (cos phi, sin phi), so that the horizon is at
+ * radius 1. Unlike direction cosines, this is a smooth function of the
+ * beam near the horizon as well as at the zenith.
+ */
+static void direction_to_grid(double x, double y, double z,
+        double* p, double* q)
+{
+    const double r = sqrt(x*x + y*y);
+    const double rho = atan2(r, z) / M_PI_2;
+    if (r > 0.0)
+    {
+        *p = rho * x / r;
+        *q = rho * y / r;
+    }
+    else
+    {
+        *p = 0.0;
+        *q = 0.0;
+    }
+}
+
+static void grid_to_direction(double p, double q,
+        double* x, double* y, double* z)
+{
+    const double rho = sqrt(p*p + q*q);
+    const double theta = rho * M_PI_2;
+    if (rho > 0.0)
+    {
+        *x = sin(theta) * p / rho;
+        *y = sin(theta) * q / rho;
+    }
+    else
+    {
+        *x = 0.0;
+        *y = 0.0;
+    }
+    *z = cos(theta);
+}
+
+/*
+ * The components of polarised beams are given in the theta and phi
+ * directions, which rotate with azimuth around the zenith. To give a
+ * smooth function for interpolation, the grid holds the components
+ * projected onto the fixed x and y directions (Ludwig's third definition).
+ * Each row of the Jones matrix is (re, im) pairs for theta then phi.
+ */
+static void to_ludwig3(double* v, double p, double q)
+{
+    int r, k;
+    double c = 1.0, s = 0.0, t = sqrt(p*p + q*q);
+    if (t > 0.0)
+    {
+        c = p / t;
+        s = q / t;
+    }
+    for (r = 0; r < 8; r += 4)
+    {
+        for (k = 0; k < 2; ++k)
+        {
+            const double e_theta = v[r + k], e_phi = v[r + 2 + k];
+            v[r + k]     = e_theta * c - e_phi * s;
+            v[r + 2 + k] = e_theta * s + e_phi * c;
+        }
+    }
+}
+
+static void from_ludwig3(double* v, double p, double q)
+{
+    int r, k;
+    double c = 1.0, s = 0.0, t = sqrt(p*p + q*q);
+    if (t > 0.0)
+    {
+        c = p / t;
+        s = q / t;
+    }
+    for (r = 0; r < 8; r += 4)
+    {
+        for (k = 0; k < 2; ++k)
+        {
+            const double e_x = v[r + k], e_y = v[r + 2 + k];
+            v[r + k]     = e_x * c + e_y * s;
+            v[r + 2 + k] = -e_x * s + e_y * c;
+        }
+    }
+}
+
+/* Returns the first grid index and the Catmull-Rom cubic convolution
+ * weights for a fractional grid position. */
+static int stencil(double f, int side, double w[4])
+{
+    int i;
+    double t;
+    if (!(f >= 1.0)) f = 1.0;
+    if (!(f <= side - 3.0)) f = side - 3.0;
+    i = (int) f;
+    t = f - i;
+    w[0] = ((-0.5 * t + 1.0) * t - 0.5) * t;
+    w[1] = (1.5 * t - 2.5) * t * t + 1.0;
+    w[2] = ((-1.5 * t + 2.0) * t + 0.5) * t;
+    w[3] = (0.5 * t - 0.5) * t * t;
+    return i - 1;
+}
+
+static void interpolate_grid_f(const float* grid, int num_comp, int side,
+        double delta, int num_points, const float* x, const float* y,
+        const float* z, float* out)
+{
+    int i;
+    #pragma omp parallel for private(i)
+    for (i = 0; i < num_points; ++i)
+    {
+        int c, j, k, ix, iy;
+        double p, q, wx[4], wy[4], sum[8];
+        direction_to_grid(x[i], y[i], z[i], &p, &q);
+        ix = stencil(p / delta + side / 2, side, wx);
+        iy = stencil(q / delta + side / 2, side, wy);
+        for (c = 0; c < num_comp; ++c) sum[c] = 0.0;
+        for (j = 0; j < 4; ++j)
+        {
+            for (k = 0; k < 4; ++k)
+            {
+                const double w = wy[j] * wx[k];
+                const float* t = &grid[((iy + j) * side + ix + k) * num_comp];
+                for (c = 0; c < num_comp; ++c) sum[c] += w * t[c];
+            }
+        }
+        if (num_comp == 8) from_ludwig3(sum, p, q);
+        for (c = 0; c < num_comp; ++c) out[i * num_comp + c] = (float) sum[c];
+    }
+}
+
+static void interpolate_grid_d(const double* grid, int num_comp, int side,
+        double delta, int num_points, const double* x, const double* y,
+        const double* z, double* out)
+{
+    int i;
+    #pragma omp parallel for private(i)
+    for (i = 0; i < num_points; ++i)
+    {
+        int c, j, k, ix, iy;
+        double p, q, wx[4], wy[4], sum[8];
+        direction_to_grid(x[i], y[i], z[i], &p, &q);
+        ix = stencil(p / delta + side / 2, side, wx);
+        iy = stencil(q / delta + side / 2, side, wy);
+        for (c = 0; c < num_comp; ++c) sum[c] = 0.0;
+        for (j = 0; j < 4; ++j)
+        {
+            for (k = 0; k < 4; ++k)
+            {
+                const double w = wy[j] * wx[k];
+                const double* t = &grid[((iy + j) * side + ix + k) * num_comp];
+                for (c = 0; c < num_comp; ++c) sum[c] += w * t[c];
+            }
+        }
+        if (num_comp == 8) from_ludwig3(sum, p, q);
+        for (c = 0; c < num_comp; ++c) out[i * num_comp + c] = sum[c];
+    }
+}
+
+static void interpolate_grid(const oskar_Mem* grid, int side, double delta,
+        int num_points, const oskar_Mem* x, const oskar_Mem* y,
+        const oskar_Mem* z, oskar_Mem* beam, int* status)
+{
+    int num_comp;
+    if (*status) return;
+    num_comp = oskar_mem_is_matrix(grid) ? 8 : 2;
+    if (oskar_mem_precision(grid) == OSKAR_DOUBLE)
+        interpolate_grid_d(oskar_mem_double_const(grid, status), num_comp,
+                side, delta, num_points, oskar_mem_double_const(x, status),
+                oskar_mem_double_const(y, status),
+                oskar_mem_double_const(z, status),
+                oskar_mem_double(beam, status));
+    else
+        interpolate_grid_f(oskar_mem_float_const(grid, status), num_comp,
+                side, delta, num_points, oskar_mem_float_const(x, status),
+                oskar_mem_float_const(y, status),
+                oskar_mem_float_const(z, status),
+                oskar_mem_float(beam, status));
+}
+
+/* Returns the largest absolute difference between the components of a and b
+ * relative to the given peak value. */
+static double max_rel_diff(const oskar_Mem* a, const oskar_Mem* b,
+        double peak, int* status)
+{
+    size_t i, n;
+    double diff = 0.0;
+    n = oskar_mem_length(a) * (oskar_mem_is_matrix(a) ? 8 : 2);
+    if (oskar_mem_precision(a) == OSKAR_DOUBLE)
+    {
+        const double *a_ = oskar_mem_double_const(a, status);
+        const double *b_ = oskar_mem_double_const(b, status);
+        for (i = 0; i < n; ++i)
+            if (fabs(a_[i] - b_[i]) > diff) diff = fabs(a_[i] - b_[i]);
+    }
+    else
+    {
+        const float *a_ = oskar_mem_float_const(a, status);
+        const float *b_ = oskar_mem_float_const(b, status);
+        for (i = 0; i < n; ++i)
+            if (fabs(a_[i] - b_[i]) > diff) diff = fabs(a_[i] - b_[i]);
+    }
+    return peak > 0.0 ? diff / peak : 0.0;
+}
+
+/* Returns the largest absolute value of any component in the array. */
+static double max_abs(const oskar_Mem* a, int* status)
+{
+    size_t i, n;
+    double peak = 0.0;
+    n = oskar_mem_length(a) * (oskar_mem_is_matrix(a) ? 8 : 2);
+    if (oskar_mem_precision(a) == OSKAR_DOUBLE)
+    {
+        const double *a_ = oskar_mem_double_const(a, status);
+        for (i = 0; i < n; ++i)
+            if (fabs(a_[i]) > peak) peak = fabs(a_[i]);
+    }
+    else
+    {
+        const float *a_ = oskar_mem_float_const(a, status);
+        for (i = 0; i < n; ++i)
+            if (fabs(a_[i]) > peak) peak = fabs(a_[i]);
+    }
+    return peak;
+}
+
+/* Evaluates the beam at a block of points, and adds the weighted results
+ * to the grid. */
+static void fill_block(oskar_Mem* grid, int num_points, const int* index,
+        const double* weight, oskar_Mem* block, const oskar_Mem* x,
+        const oskar_Mem* y, const oskar_Mem* z, const oskar_Station* station,
+        double gast, double frequency_hz, oskar_StationWork* work,
+        int time_index, int* status)
+{
+    int i, c, num_comp;
+    if (*status || num_points == 0) return;
+    oskar_evaluate_station_beam_aperture_array(block, station, num_points,
+            x, y, z, gast, frequency_hz, work, time_index, status);
+    if (*status) return;
+    num_comp = oskar_mem_is_matrix(grid) ? 8 : 2;
+    if (oskar_mem_precision(grid) == OSKAR_DOUBLE)
+    {
+        double* g = oskar_mem_double(grid, status);
+        const double* b = oskar_mem_double_const(block, status);
+        for (i = 0; i < num_points; ++i)
+            for (c = 0; c < num_comp; ++c)
+                g[index[i] * num_comp + c] += weight[i] * b[i * num_comp + c];
+    }
+    else
+    {
+        float* g = oskar_mem_float(grid, status);
+        const float* b = oskar_mem_float_const(block, status);
+        for (i = 0; i < num_points; ++i)
+            for (c = 0; c < num_comp; ++c)
+                g[index[i] * num_comp + c] += (float)
+                        (weight[i] * b[i * num_comp + c]);
+    }
+}
+
+/* Evaluates the beam at all grid points within reach of the horizon.
+ * Beyond the horizon, the beam is extended as 2 f(1) - f(2 - rho) along
+ * each radius, to keep its first derivative continuous. */
+static void fill_grid(oskar_Mem* grid, int side, double delta,
+        const oskar_Station* station, double gast, double frequency_hz,
+        oskar_StationWork* work, int time_index, int* status)
+{
+    int i, j, k, half, prec, num_points = 0, *index;
+    double rho_max, *weight;
+    oskar_Mem *x, *y, *z, *block;
+    if (*status) return;
+    prec = oskar_station_precision(station);
+    half = side / 2;
+    rho_max = 1.0 + 3.0 * delta;
+    x = oskar_mem_create(prec, OSKAR_CPU, BLOCK_SIZE, status);
+    y = oskar_mem_create(prec, OSKAR_CPU, BLOCK_SIZE, status);
+    z = oskar_mem_create(prec, OSKAR_CPU, BLOCK_SIZE, status);
+    block = oskar_mem_create(oskar_mem_type(grid), OSKAR_CPU, BLOCK_SIZE,
+            status);
+    index = (int*) malloc(BLOCK_SIZE * sizeof(int));
+    weight = (double*) malloc(BLOCK_SIZE * sizeof(double));
+    oskar_mem_clear_contents(grid, status);
+    for (j = 0; j < side && !*status; ++j)
+    {
+        for (i = 0; i < side; ++i)
+        {
+            int num_terms = 1;
+            double p, q, rho, p_[2], q_[2], w_[2];
+            p = (i - half) * delta;
+            q = (j - half) * delta;
+            rho = sqrt(p*p + q*q);
+            if (rho > rho_max) continue;
+            p_[0] = p;
+            q_[0] = q;
+            w_[0] = 1.0;
+            if (rho > 1.0)
+            {
+                num_terms = 2;
+                p_[0] = p / rho;
+                q_[0] = q / rho;
+                w_[0] = 2.0;
+                p_[1] = p_[0] * (2.0 - rho);
+                q_[1] = q_[0] * (2.0 - rho);
+                w_[1] = -1.0;
+            }
+            for (k = 0; k < num_terms; ++k)
+            {
+                double x_, y_, z_;
+                grid_to_direction(p_[k], q_[k], &x_, &y_, &z_);
+                oskar_mem_set_element_real(x, num_points, x_, status);
+                oskar_mem_set_element_real(y, num_points, y_, status);
+                oskar_mem_set_element_real(z, num_points, z_, status);
+                index[num_points] = j * side + i;
+                weight[num_points++] = w_[k];
+                if (num_points == BLOCK_SIZE)
+                {
+                    fill_block(grid, num_points, index, weight, block,
+                            x, y, z, station, gast, frequency_hz, work,
+                            time_index, status);
+                    num_points = 0;
+                }
+            }
+        }
+    }
+    fill_block(grid, num_points, index, weight, block, x, y, z, station,
+            gast, frequency_hz, work, time_index, status);
+
+    /* Rotate polarised components to the fixed x,y basis. */
+    if (oskar_mem_is_matrix(grid) && !*status)
+    {
+        double v[8];
+        for (j = 0; j < side; ++j)
+        {
+            for (i = 0; i < side; ++i)
+            {
+                const int idx = 8 * (j * side + i);
+                const double p = (i - half) * delta, q = (j - half) * delta;
+                if (oskar_mem_precision(grid) == OSKAR_DOUBLE)
+                    to_ludwig3(oskar_mem_double(grid, status) + idx, p, q);
+                else
+                {
+                    float* g = oskar_mem_float(grid, status) + idx;
+                    for (k = 0; k < 8; ++k) v[k] = g[k];
+                    to_ludwig3(v, p, q);
+                    for (k = 0; k < 8; ++k) g[k] = (float) v[k];
+                }
+            }
+        }
+    }
+    free(index);
+    free(weight);
+    oskar_mem_free(x, status);
+    oskar_mem_free(y, status);
+    oskar_mem_free(z, status);
+    oskar_mem_free(block, status);
+}
+
+/* Estimates the interpolation error at a set of test points spread
+ * evenly over the sky, relative to the peak of the beam. */
+static double estimate_error(const oskar_Mem* grid, int side, double delta,
+        const oskar_Station* station, double gast, double frequency_hz,
+        oskar_StationWork* work, int time_index, int* status)
+{
+    int i, prec, type;
+    double error;
+    oskar_Mem *x, *y, *z, *beam, *beam_interp;
+    if (*status) return 0.0;
+    prec = oskar_station_precision(station);
+    type = oskar_mem_type(grid);
+    x = oskar_mem_create(prec, OSKAR_CPU, NUM_TEST_POINTS, status);
+    y = oskar_mem_create(prec, OSKAR_CPU, NUM_TEST_POINTS, status);
+    z = oskar_mem_create(prec, OSKAR_CPU, NUM_TEST_POINTS, status);
+    beam = oskar_mem_create(type, OSKAR_CPU, NUM_TEST_POINTS, status);
+    beam_interp = oskar_mem_create(type, OSKAR_CPU, NUM_TEST_POINTS, status);
+    for (i = 0; i < NUM_TEST_POINTS; ++i)
+    {
+        /* Points on a Fermat spiral, down to the horizon. */
+        double x_, y_, z_;
+        const double rho = sqrt((i + 0.5) / NUM_TEST_POINTS);
+        const double a = i * M_PI * (3.0 - sqrt(5.0));
+        grid_to_direction(rho * cos(a), rho * sin(a), &x_, &y_, &z_);
+        oskar_mem_set_element_real(x, i, x_, status);
+        oskar_mem_set_element_real(y, i, y_, status);
+        oskar_mem_set_element_real(z, i, z_, status);
+    }
+    oskar_evaluate_station_beam_aperture_array(beam, station,
+            NUM_TEST_POINTS, x, y, z, gast, frequency_hz, work,
+            time_index, status);
+    interpolate_grid(grid, side, delta, NUM_TEST_POINTS, x, y, z,
+            beam_interp, status);
+    error = max_rel_diff(beam, beam_interp, max_abs(grid, status), status);
+    oskar_mem_free(x, status);
+    oskar_mem_free(y, status);
+    oskar_mem_free(z, status);
+    oskar_mem_free(beam, status);
+    oskar_mem_free(beam_interp, status);
+    return error;
+}
+
+/* Returns the number of bytes used by all look-up tables. */
+static size_t total_bytes(const oskar_StationWork* work)
+{
+    int i;
+    size_t bytes = 0;
+    for (i = 0; i < work->num_beam_luts; ++i)
+        bytes += oskar_mem_length(work->beam_lut[i].grid) *
+                oskar_mem_element_size(oskar_mem_type(work->beam_lut[i].grid));
+    return bytes;
+}
+
+/* Returns the look-up table for the station, generating it if necessary. */
+static const oskar_StationWorkBeamLut* get_lut(const oskar_Station* station,
+        int side, double delta, int type, double gast, double frequency_hz,
+        oskar_StationWork* work, int time_index, int* status)
+{
+    int i, idx;
+    double beam_x, beam_y, beam_z;
+    unsigned long long layout_hash;
+    oskar_StationWorkBeamLut* t;
+
+    /* Look for an existing table with a matching key. */
+    if (*status) return 0;
+    layout_hash = oskar_station_layout_hash(station, status);
+    oskar_evaluate_beam_horizon_direction(&beam_x, &beam_y, &beam_z, station,
+            gast, status);
+    if (*status) return 0;
+    for (i = 0; i < work->num_beam_luts; ++i)
+    {
+        t = &work->beam_lut[i];
+        if (t->layout_hash == layout_hash &&
+                t->unique_id == oskar_station_unique_id(station) &&
+                t->lon_rad == oskar_station_lon_rad(station) &&
+                t->lat_rad == oskar_station_lat_rad(station) &&
+                t->beam_x == beam_x && t->beam_y == beam_y &&
+                t->beam_z == beam_z && t->gast == gast &&
+                t->frequency_hz == frequency_hz &&
+                t->time_index == time_index && t->type == type &&
+                t->grid_side == side)
+        {
+            t->last_used = ++work->beam_lut_counter;
+            return t;
+        }
+    }
+
+    /* Not found: make room for a new table, removing the least recently
+     * used ones if the memory limit would be exceeded. */
+    while (work->num_beam_luts > 0 && total_bytes(work) +
+            (size_t)side * side * oskar_mem_element_size(type) >
+            work->beam_lut_max_bytes)
+    {
+        idx = 0;
+        for (i = 1; i < work->num_beam_luts; ++i)
+            if (work->beam_lut[i].last_used < work->beam_lut[idx].last_used)
+                idx = i;
+        oskar_mem_free(work->beam_lut[idx].grid, status);
+        work->beam_lut[idx] = work->beam_lut[--work->num_beam_luts];
+    }
+    t = (oskar_StationWorkBeamLut*) realloc(work->beam_lut,
+            (work->num_beam_luts + 1) * sizeof(oskar_StationWorkBeamLut));
+    if (!t)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+    work->beam_lut = t;
+    t = &work->beam_lut[work->num_beam_luts];
+    t->grid = oskar_mem_create(type, OSKAR_CPU, (size_t)side * side, status);
+    if (*status)
+    {
+        oskar_mem_free(t->grid, status);
+        return 0;
+    }
+    work->num_beam_luts++;
+    t->layout_hash = layout_hash;
+    t->unique_id = oskar_station_unique_id(station);
+    t->lon_rad = oskar_station_lon_rad(station);
+    t->lat_rad = oskar_station_lat_rad(station);
+    t->beam_x = beam_x;
+    t->beam_y = beam_y;
+    t->beam_z = beam_z;
+    t->gast = gast;
+    t->frequency_hz = frequency_hz;
+    t->time_index = time_index;
+    t->type = type;
+    t->grid_side = side;
+    t->last_used = ++work->beam_lut_counter;
+
+    /* Evaluate the beam on the grid, and estimate the error. */
+    fill_grid(t->grid, side, delta, station, gast, frequency_hz, work,
+            time_index, status);
+    if (!*status)
+    {
+        const double error = estimate_error(t->grid, side, delta, station,
+                gast, frequency_hz, work, time_index, status);
+        if (error > work->beam_lut_error) work->beam_lut_error = error;
+    }
+    if (*status)
+    {
+        /* Don't keep a partially-filled table. */
+        oskar_mem_free(t->grid, status);
+        work->num_beam_luts--;
+        return 0;
+    }
+    return t;
+}
+
+/* Returns the grid size and spacing for the station at the given frequency,
+ * or 0 if the grid would be too large. */
+static int grid_side(const oskar_Station* station, double frequency_hz,
+        double* delta, int* status)
+{
+    int half, side;
+    double wavelength, diameter;
+
+    /* Get the grid spacing from the width of the station beam, which is
+     * about (wavelength / diameter) in direction cosine, or a factor pi/2
+     * larger in the grid coordinates. Use a minimum size, so that element
+     * patterns are also sampled. */
+    wavelength = 299792458.0 / frequency_hz;
+    diameter = 2.0 * station_radius(station, status);
+    if (diameter < 2.0 * wavelength) diameter = 2.0 * wavelength;
+    *delta = wavelength / (M_PI_2 * diameter *
+            oskar_station_beam_lut_oversample(station));
+    half = (int) ceil(1.0 / *delta) + 2;
+    side = 2 * half + 1;
+    return (side > MAX_GRID_SIDE) ? 0 : side;
+}
+
+size_t oskar_evaluate_station_beam_lut_bytes(const oskar_Station* station,
+        double frequency_hz, int type, int* status)
+{
+    int side;
+    double delta;
+    if (*status || oskar_station_beam_lut_oversample(station) <= 0.0 ||
+            oskar_station_mem_location(station) != OSKAR_CPU)
+        return 0;
+    side = grid_side(station, frequency_hz, &delta, status);
+    return (size_t)side * side * oskar_mem_element_size(type);
+}
+
+void oskar_evaluate_station_beam_lut(oskar_Mem* beam,
+        const oskar_Station* station, int num_points, const oskar_Mem* x,
+        const oskar_Mem* y, const oskar_Mem* z, double gast,
+        double frequency_hz, oskar_StationWork* work, int time_index,
+        int* status)
+{
+    int side;
+    double delta;
+    const oskar_StationWorkBeamLut* t;
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+
+    /* Evaluate the beam directly if a look-up table can't be used. */
+    if (oskar_station_beam_lut_oversample(station) <= 0.0 ||
+            !work->beam_lut_enabled || num_points == 0 ||
+            oskar_mem_location(beam) != OSKAR_CPU ||
+            oskar_mem_location(x) != OSKAR_CPU ||
+            oskar_mem_location(y) != OSKAR_CPU ||
+            oskar_mem_location(z) != OSKAR_CPU ||
+            oskar_mem_type(z) != oskar_mem_precision(beam) ||
+            oskar_mem_type(x) != oskar_mem_precision(beam) ||
+            oskar_mem_type(y) != oskar_mem_precision(beam) ||
+            oskar_station_mem_location(station) != OSKAR_CPU)
+    {
+        oskar_evaluate_station_beam_aperture_array(beam, station, num_points,
+                x, y, z, gast, frequency_hz, work, time_index, status);
+        return;
+    }
+
+    /* Get the grid size, and check it is not too large. */
+    side = grid_side(station, frequency_hz, &delta, status);
+    if (side == 0)
+    {
+        oskar_evaluate_station_beam_aperture_array(beam, station, num_points,
+                x, y, z, gast, frequency_hz, work, time_index, status);
+        return;
+    }
+
+    /* Get the table and interpolate the beam. */
+    t = get_lut(station, side, delta, oskar_mem_type(beam), gast,
+            frequency_hz, work, time_index, status);
+    if (!t) return;
+    interpolate_grid(t->grid, side, delta, num_points, x, y, z, beam,
+            status);
+
+    /* Blank (set to zero) points below the horizon. */
+    oskar_blank_below_horizon(num_points, z, beam, status);
+}
+
+#ifdef __cplusplus
+}
+#endif
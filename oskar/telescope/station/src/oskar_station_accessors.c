@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2015, The University of Oxford
+ * Copyright (c) 2013-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -160,6 +160,16 @@ int oskar_station_enable_array_pattern(const oskar_Station* model)
     return model->enable_array_pattern;
 }
 
+double oskar_station_nufft_tolerance(const oskar_Station* model)
+{
+    return model->nufft_tolerance;
+}
+
+double oskar_station_beam_lut_oversample(const oskar_Station* model)
+{
+    return model->beam_lut_oversample;
+}
+
 int oskar_station_common_element_orientation(const oskar_Station* model)
 {
     return model->common_element_orientation;
@@ -491,6 +501,17 @@ void oskar_station_set_enable_array_pattern(oskar_Station* model, int value)
     model->enable_array_pattern = value;
 }
 
+void oskar_station_set_nufft_tolerance(oskar_Station* model, double value)
+{
+    model->nufft_tolerance = value;
+}
+
+void oskar_station_set_beam_lut_oversample(oskar_Station* model,
+        double value)
+{
+    model->beam_lut_oversample = value;
+}
+
 void oskar_station_set_seed_time_variable_errors(oskar_Station* model,
         unsigned int value)
 {
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2015, The University of Oxford
+ * Copyright (c) 2011-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -130,6 +130,8 @@ oskar_Station* oskar_station_create(int type, int location, int num_elements,
     model->num_element_types = 0;
     model->normalise_array_pattern = OSKAR_FALSE;
     model->enable_array_pattern = OSKAR_TRUE;
+    model->nufft_tolerance = 0.0;
+    model->beam_lut_oversample = 0.0;
     model->common_element_orientation = OSKAR_TRUE;
     model->array_is_3d = OSKAR_FALSE;
     model->apply_element_errors = OSKAR_FALSE;
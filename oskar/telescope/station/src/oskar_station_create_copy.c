@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2015, The University of Oxford
+ * Copyright (c) 2013-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -76,6 +76,8 @@ oskar_Station* oskar_station_create_copy(const oskar_Station* src,
     model->num_elements = src->num_elements;
     model->normalise_array_pattern = src->normalise_array_pattern;
     model->enable_array_pattern = src->enable_array_pattern;
+    model->nufft_tolerance = src->nufft_tolerance;
+    model->beam_lut_oversample = src->beam_lut_oversample;
     model->common_element_orientation = src->common_element_orientation;
     model->array_is_3d = src->array_is_3d;
     model->apply_element_errors = src->apply_element_errors;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2015, The University of Oxford
+ * Copyright (c) 2013-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -59,6 +59,8 @@ int oskar_station_different(const oskar_Station* a, const oskar_Station* b,
             a->num_element_types != b->num_element_types ||
             a->normalise_array_pattern != b->normalise_array_pattern ||
             a->enable_array_pattern != b->enable_array_pattern ||
+            a->nufft_tolerance != b->nufft_tolerance ||
+            a->beam_lut_oversample != b->beam_lut_oversample ||
             a->common_element_orientation != b->common_element_orientation ||
             a->array_is_3d != b->array_is_3d ||
             a->apply_element_errors != b->apply_element_errors ||
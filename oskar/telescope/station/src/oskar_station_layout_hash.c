@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "telescope/station/private_station.h"
+#include "telescope/station/oskar_station.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static unsigned long long hash_element(const oskar_Element* e,
+        unsigned long long h, int* status)
+{
+    int i, ints[6];
+    double doubles[3];
+    ints[0] = oskar_element_type(e);
+    ints[1] = oskar_element_taper_type(e);
+    ints[2] = oskar_element_dipole_length_units(e);
+    ints[3] = oskar_element_num_freq(e);
+    ints[4] = oskar_element_table_interp(e);
+    ints[5] = oskar_element_table_num_theta(e) *
+            oskar_element_table_num_phi(e);
+    doubles[0] = oskar_element_dipole_length(e);
+    doubles[1] = oskar_element_cosine_power(e);
+    doubles[2] = oskar_element_gaussian_fwhm_rad(e);
+    h = oskar_mem_hash_raw(ints, sizeof(ints), h);
+    h = oskar_mem_hash_raw(doubles, sizeof(doubles), h);
+    h = oskar_mem_hash_raw(oskar_element_freqs_hz_const(e),
+            ints[3] * sizeof(double), h);
+    for (i = 0; i < ints[3]; ++i)
+    {
+        h = oskar_mem_hash(oskar_element_x_filename_const(e, i), 0, h, status);
+        h = oskar_mem_hash(oskar_element_y_filename_const(e, i), 0, h, status);
+        h = oskar_mem_hash(oskar_element_scalar_filename_const(e, i), 0, h,
+                status);
+    }
+    return h;
+}
+
+static unsigned long long hash_station(const oskar_Station* s,
+        unsigned long long h, int* status)
+{
+    int i, n, ints[10];
+    double doubles[3];
+    n = s->num_elements;
+    ints[0] = s->station_type;
+    ints[1] = n;
+    ints[2] = s->num_element_types;
+    ints[3] = s->normalise_array_pattern;
+    ints[4] = s->enable_array_pattern;
+    ints[5] = s->common_element_orientation;
+    ints[6] = s->array_is_3d;
+    ints[7] = s->apply_element_errors;
+    ints[8] = s->apply_element_weight;
+    ints[9] = oskar_station_has_child(s);
+    doubles[0] = s->nufft_tolerance;
+    doubles[1] = s->gaussian_beam_fwhm_rad;
+    doubles[2] = s->gaussian_beam_reference_freq_hz;
+    h = oskar_mem_hash_raw(ints, sizeof(ints), h);
+    h = oskar_mem_hash_raw(doubles, sizeof(doubles), h);
+    h = oskar_mem_hash(s->element_true_x_enu_metres, n, h, status);
+    h = oskar_mem_hash(s->element_true_y_enu_metres, n, h, status);
+    h = oskar_mem_hash(s->element_true_z_enu_metres, n, h, status);
+    h = oskar_mem_hash(s->element_measured_x_enu_metres, n, h, status);
+    h = oskar_mem_hash(s->element_measured_y_enu_metres, n, h, status);
+    h = oskar_mem_hash(s->element_measured_z_enu_metres, n, h, status);
+    h = oskar_mem_hash(s->element_gain, n, h, status);
+    h = oskar_mem_hash(s->element_gain_error, n, h, status);
+    h = oskar_mem_hash(s->element_phase_offset_rad, n, h, status);
+    h = oskar_mem_hash(s->element_phase_error_rad, n, h, status);
+    h = oskar_mem_hash(s->element_weight, n, h, status);
+    h = oskar_mem_hash(s->element_types_cpu, n, h, status);
+    h = oskar_mem_hash(s->element_mount_types_cpu, n, h, status);
+    h = oskar_mem_hash(s->element_x_alpha_cpu, n, h, status);
+    h = oskar_mem_hash(s->element_x_beta_cpu, n, h, status);
+    h = oskar_mem_hash(s->element_x_gamma_cpu, n, h, status);
+    h = oskar_mem_hash(s->element_y_alpha_cpu, n, h, status);
+    h = oskar_mem_hash(s->element_y_beta_cpu, n, h, status);
+    h = oskar_mem_hash(s->element_y_gamma_cpu, n, h, status);
+    if (oskar_station_has_element(s))
+    {
+        for (i = 0; i < s->num_element_types; ++i)
+            h = hash_element(s->element[i], h, status);
+    }
+    if (oskar_station_has_child(s))
+    {
+        for (i = 0; i < n; ++i)
+            h = hash_station(s->child[i], h, status);
+    }
+    return h;
+}
+
+unsigned long long oskar_station_layout_hash(const oskar_Station* station,
+        int* status)
+{
+    if (*status) return 0;
+    return hash_station(station, 0, status);
+}
+
+#ifdef __cplusplus
+}
+#endif
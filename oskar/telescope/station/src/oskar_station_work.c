@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2015, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -29,6 +29,8 @@
 #include "telescope/station/oskar_station_work.h"
 #include "telescope/station/private_station_work.h"
 
+#include <stdlib.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -65,6 +67,12 @@ oskar_StationWork* oskar_station_work_create(int type,
     work->normalised_beam = 0;
     work->num_depths = 0;
     work->beam = 0;
+    work->beam_lut_enabled = 1;
+    work->beam_lut_max_bytes = OSKAR_STATION_WORK_MAX_BEAM_LUT_BYTES;
+    work->num_beam_luts = 0;
+    work->beam_lut_counter = 0;
+    work->beam_lut_error = 0.0;
+    work->beam_lut = 0;
 
     return work;
 }
@@ -90,6 +98,12 @@ void oskar_station_work_free(oskar_StationWork* work, int* status)
     {
         oskar_mem_free(work->beam[i], status);
     }
+    free(work->beam);
+    for (i = 0; i < work->num_beam_luts; ++i)
+    {
+        oskar_mem_free(work->beam_lut[i].grid, status);
+    }
+    free(work->beam_lut);
 
     /* Free the structure. */
     free(work);
@@ -147,6 +161,21 @@ oskar_Mem* oskar_station_work_beam(oskar_StationWork* work,
     return work->beam[depth];
 }
 
+double oskar_station_work_beam_lut_error(const oskar_StationWork* work)
+{
+    return work->beam_lut_error;
+}
+
+void oskar_station_work_set_beam_lut(oskar_StationWork* work, int enabled)
+{
+    work->beam_lut_enabled = enabled;
+}
+
+size_t oskar_station_work_beam_lut_max_bytes(const oskar_StationWork* work)
+{
+    return work->beam_lut_max_bytes;
+}
+
 static void get_mem_from_template(oskar_Mem** b, const oskar_Mem* a,
         size_t length, int* status)
 {
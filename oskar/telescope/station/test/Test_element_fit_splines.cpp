@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "telescope/station/element/oskar_element.h"
+#include "utility/oskar_get_error_string.h"
+#include "math/oskar_cmath.h"
+
+#include <cstdio>
+#include <vector>
+
+TEST(element, fit_splines)
+{
+    int status = 0;
+    const int n_theta = 19, n_phi = 37, n = n_theta * n_phi;
+    const int num_surfaces = 4;
+    const double closeness = 0.02, closeness_inc = 1.5;
+    const char* names[] = {"A", "B", "C", "D"};
+
+    // Generate data for each surface.
+    oskar_Mem *theta, *phi, *weight, *data[num_surfaces];
+    theta = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, n, &status);
+    phi = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, n, &status);
+    weight = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, n, &status);
+    oskar_mem_set_value_real(weight, 1.0, 0, n, &status);
+    double* t = oskar_mem_double(theta, &status);
+    double* p = oskar_mem_double(phi, &status);
+    for (int s = 0; s < num_surfaces; ++s)
+    {
+        data[s] = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, n, &status);
+        double* z = oskar_mem_double(data[s], &status);
+        for (int i = 0, k = 0; i < n_theta; ++i)
+        {
+            for (int j = 0; j < n_phi; ++j, ++k)
+            {
+                t[k] = i * (M_PI / 2.0) / (n_theta - 1);
+                p[k] = j * (2.0 * M_PI) / (n_phi - 1);
+                z[k] = cos(t[k]) * (1.0 + 0.3 * sin((s + 1) * p[k]));
+            }
+        }
+    }
+
+    // Fit the surfaces together, and one at a time.
+    oskar_Splines *fit_all[num_surfaces], *fit_one[num_surfaces];
+    for (int s = 0; s < num_surfaces; ++s)
+    {
+        fit_all[s] = oskar_splines_create(OSKAR_DOUBLE, OSKAR_CPU, &status);
+        fit_one[s] = oskar_splines_create(OSKAR_DOUBLE, OSKAR_CPU, &status);
+        double avg_frac_err = closeness;
+        oskar_splines_fit(fit_one[s], n, t, p,
+                oskar_mem_double_const(data[s], &status),
+                oskar_mem_double_const(weight, &status),
+                OSKAR_SPLINES_SPHERICAL, 1, &avg_frac_err, closeness_inc,
+                1, 1e-14, &status);
+    }
+    int num_points[num_surfaces];
+    oskar_Mem *thetas[num_surfaces], *phis[num_surfaces];
+    const oskar_Mem *weights[num_surfaces], *surfaces[num_surfaces];
+    for (int s = 0; s < num_surfaces; ++s)
+    {
+        num_points[s] = n;
+        thetas[s] = theta;
+        phis[s] = phi;
+        weights[s] = weight;
+        surfaces[s] = data[s];
+    }
+    oskar_element_fit_splines(0, num_surfaces, fit_all, names, num_points,
+            thetas, phis, surfaces, weights, closeness, closeness_inc,
+            &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check the results are identical.
+    for (int s = 0; s < num_surfaces; ++s)
+    {
+        EXPECT_EQ(oskar_splines_num_knots_x_theta(fit_one[s]),
+                oskar_splines_num_knots_x_theta(fit_all[s]));
+        EXPECT_EQ(oskar_splines_num_knots_y_phi(fit_one[s]),
+                oskar_splines_num_knots_y_phi(fit_all[s]));
+        EXPECT_FALSE(oskar_mem_different(oskar_splines_coeff(fit_one[s]),
+                oskar_splines_coeff(fit_all[s]), 0, &status));
+        EXPECT_FALSE(oskar_mem_different(
+                oskar_splines_knots_x_theta_const(fit_one[s]),
+                oskar_splines_knots_x_theta_const(fit_all[s]), 0, &status));
+        EXPECT_FALSE(oskar_mem_different(
+                oskar_splines_knots_y_phi_const(fit_one[s]),
+                oskar_splines_knots_y_phi_const(fit_all[s]), 0, &status));
+    }
+
+    for (int s = 0; s < num_surfaces; ++s)
+    {
+        oskar_mem_free(data[s], &status);
+        oskar_splines_free(fit_all[s], &status);
+        oskar_splines_free(fit_one[s], &status);
+    }
+    oskar_mem_free(theta, &status);
+    oskar_mem_free(phi, &status);
+    oskar_mem_free(weight, &status);
+}
+
+static void write_cst_file(const char* filename, double freq_scale)
+{
+    FILE* file = fopen(filename, "w");
+    ASSERT_TRUE(file != NULL);
+    fprintf(file, "Theta [deg.]  Phi [deg.]  Abs(Dir.)  Abs(Theta)  "
+            "Phase(Theta)  Abs(Phi)  Phase(Phi)  Ax.Ratio\n");
+    for (int t = 0; t <= 90; t += 5)
+    {
+        for (int p = 0; p <= 360; p += 10)
+        {
+            double th = t * M_PI / 180.0, ph = p * M_PI / 180.0;
+            double a = cos(th) * (1.0 + 0.2 * sin(freq_scale * ph));
+            double b = 0.5 * cos(th) * (1.0 + 0.1 * cos(freq_scale * ph));
+            fprintf(file, "%d %d 0 %.6f %.3f %.6f %.3f 0\n", t, p,
+                    a, 30.0 * freq_scale * th, b, 10.0 * sin(ph));
+        }
+    }
+    fclose(file);
+}
+
+TEST(element, load_cst_files)
+{
+    int status = 0;
+    const int num_files = 3;
+    const double closeness = 0.02, closeness_inc = 1.5;
+    const double freqs[] = {100e6, 150e6, 200e6};
+    const char* files[] = {"temp_test_element_100.txt",
+            "temp_test_element_150.txt", "temp_test_element_200.txt"};
+    for (int f = 0; f < num_files; ++f)
+        write_cst_file(files[f], 1.0 + f);
+
+    // Load all the files together, and one at a time.
+    oskar_Element *all, *one;
+    all = oskar_element_create(OSKAR_DOUBLE, OSKAR_CPU, &status);
+    one = oskar_element_create(OSKAR_DOUBLE, OSKAR_CPU, &status);
+    oskar_element_load_cst_files(all, 0, 0, num_files, freqs, files,
+            closeness, closeness_inc, 0, 1, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    for (int f = 0; f < num_files; ++f)
+        oskar_element_load_cst(one, 0, 0, freqs[f], files[f],
+                closeness, closeness_inc, 0, 1, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check the fitted data are identical.
+    ASSERT_EQ(num_files, oskar_element_num_freq(all));
+    ASSERT_EQ(num_files, oskar_element_num_freq(one));
+    EXPECT_FALSE(oskar_element_different(all, one, &status));
+    for (int f = 0; f < num_files; ++f)
+    {
+        EXPECT_EQ(freqs[f], oskar_element_freqs_hz_const(all)[f]);
+        const oskar_Splines* a[] = {
+                oskar_element_x_h_re_const(all, f),
+                oskar_element_x_v_im_const(all, f),
+                oskar_element_y_h_im_const(all, f)};
+        const oskar_Splines* b[] = {
+                oskar_element_x_h_re_const(one, f),
+                oskar_element_x_v_im_const(one, f),
+                oskar_element_y_h_im_const(one, f)};
+        for (int i = 0; i < 3; ++i)
+        {
+            ASSERT_GT(oskar_splines_num_knots_x_theta(a[i]), 0);
+            EXPECT_FALSE(oskar_mem_different(oskar_splines_coeff_const(a[i]),
+                    oskar_splines_coeff_const(b[i]), 0, &status));
+            EXPECT_FALSE(oskar_mem_different(
+                    oskar_splines_knots_x_theta_const(a[i]),
+                    oskar_splines_knots_x_theta_const(b[i]), 0, &status));
+        }
+    }
+
+    // Check a missing file is reported.
+    const char* missing[] = {files[0], "temp_test_element_missing.txt"};
+    oskar_Element* bad = oskar_element_create(OSKAR_DOUBLE, OSKAR_CPU,
+            &status);
+    oskar_element_load_cst_files(bad, 0, 1, 2, freqs, missing,
+            closeness, closeness_inc, 0, 1, &status);
+    EXPECT_EQ((int) OSKAR_ERR_FILE_IO, status);
+    status = 0;
+
+    for (int f = 0; f < num_files; ++f)
+        remove(files[f]);
+    oskar_element_free(all, &status);
+    oskar_element_free(one, &status);
+    oskar_element_free(bad, &status);
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "telescope/station/element/oskar_element.h"
+#include "telescope/station/element/private_element.h"
+#include "utility/oskar_get_error_string.h"
+#include "mem/oskar_mem.h"
+#include "math/oskar_cmath.h"
+
+#include <cstdlib>
+#include <vector>
+
+static void fit_surface(oskar_Splines* spline, double freq, double amp,
+        int* status)
+{
+    const int n_theta = 19, n_phi = 37, n = n_theta * n_phi;
+    double avg_frac_err = 0.02;
+    std::vector<double> theta(n), phi(n), z(n), wt(n, 1.0);
+    for (int i = 0, k = 0; i < n_theta; ++i)
+    {
+        for (int j = 0; j < n_phi; ++j, ++k)
+        {
+            theta[k] = i * (M_PI / 2.0) / (n_theta - 1);
+            phi[k] = j * (2.0 * M_PI) / (n_phi - 1);
+            z[k] = amp * cos(theta[k]) * (1.0 +
+                    0.3 * pow(sin(theta[k]), freq) * sin(freq * phi[k]));
+        }
+    }
+    oskar_splines_fit(spline, n, &theta[0], &phi[0], &z[0], &wt[0],
+            OSKAR_SPLINES_SPHERICAL, 1, &avg_frac_err, 1.5, 1.0, 1e-14,
+            status);
+}
+
+static double max_abs_diff(const oskar_Mem* a, const oskar_Mem* b,
+        int num_points, int* status)
+{
+    double max_diff = 0.0;
+    const double* p = oskar_mem_double_const(a, status);
+    const double* q = oskar_mem_double_const(b, status);
+    for (int i = 0; i < 2 * num_points; ++i)
+    {
+        double d = fabs(p[i] - q[i]);
+        if (d > max_diff) max_diff = d;
+    }
+    return max_diff;
+}
+
+TEST(element, tabulate)
+{
+    int status = 0, num_points = 10000;
+    double err_linear = 0.0, err_cubic = 0.0;
+
+    // Create a scalar element model with fitted data at one frequency.
+    oskar_Element* model = oskar_element_create(OSKAR_DOUBLE, OSKAR_CPU,
+            &status);
+    oskar_element_resize_freq_data(model, 1, &status);
+    fit_surface(oskar_element_scalar_re(model, 0), 2.0, 1.0, &status);
+    fit_surface(oskar_element_scalar_im(model, 0), 3.0, 0.5, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_TRUE(oskar_element_has_scalar_spline_data(model));
+
+    // Generate random directions above the horizon.
+    oskar_Mem *x, *y, *z, *theta, *phi, *ref, *out;
+    x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &status);
+    y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &status);
+    z = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &status);
+    theta = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    phi = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    ref = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU, num_points,
+            &status);
+    out = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU, num_points,
+            &status);
+    double *x_ = oskar_mem_double(x, &status);
+    double *y_ = oskar_mem_double(y, &status);
+    double *z_ = oskar_mem_double(z, &status);
+    srand(2);
+    for (int i = 0; i < num_points; ++i)
+    {
+        double r = 0.99 * sqrt(rand() / (double)RAND_MAX);
+        double a = 2.0 * M_PI * rand() / (double)RAND_MAX;
+        x_[i] = r * cos(a);
+        y_[i] = r * sin(a);
+        z_[i] = sqrt(1.0 - r * r);
+    }
+
+    // Evaluate using the splines.
+    oskar_element_evaluate(model, ref, 0.0, 0.0, num_points, x, y, z,
+            100e6, theta, phi, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Evaluate using bilinear interpolation.
+    oskar_element_tabulate(model, OSKAR_ELEMENT_TABLE_BILINEAR,
+            1.0 * M_PI / 180.0, &err_linear, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ((int) OSKAR_ELEMENT_TABLE_BILINEAR,
+            oskar_element_table_interp(model));
+    EXPECT_GE(oskar_element_table_num_theta(model), 181);
+    EXPECT_GE(oskar_element_table_num_phi(model), 360);
+    oskar_element_evaluate(model, out, 0.0, 0.0, num_points, x, y, z,
+            100e6, theta, phi, &status);
+    double diff_linear = max_abs_diff(ref, out, num_points, &status);
+    EXPECT_GT(diff_linear, 0.0);
+    EXPECT_LT(diff_linear, 1e-3);
+
+    // Evaluate using bicubic interpolation.
+    oskar_element_tabulate(model, OSKAR_ELEMENT_TABLE_BICUBIC,
+            1.0 * M_PI / 180.0, &err_cubic, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_element_evaluate(model, out, 0.0, 0.0, num_points, x, y, z,
+            100e6, theta, phi, &status);
+    double diff_cubic = max_abs_diff(ref, out, num_points, &status);
+    EXPECT_LT(diff_cubic, 1e-4);
+    EXPECT_LT(diff_cubic, diff_linear);
+    EXPECT_LT(err_cubic, err_linear);
+
+    // Check a copy of the model uses the same tables.
+    oskar_Mem* out_copy = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            num_points, &status);
+    oskar_Element* copy = oskar_element_create(OSKAR_DOUBLE, OSKAR_CPU,
+            &status);
+    oskar_element_copy(copy, model, &status);
+    oskar_element_evaluate(copy, out_copy, 0.0, 0.0, num_points, x, y, z,
+            100e6, theta, phi, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(0.0, max_abs_diff(out, out_copy, num_points, &status));
+
+    // Check the copy shares the table memory, rather than duplicating it.
+    ASSERT_TRUE(model->tables != 0);
+    EXPECT_EQ(model->tables, copy->tables);
+    EXPECT_EQ(2, model->tables->ref_count);
+
+    // Check the splines are used again once the tables are removed.
+    oskar_element_tabulate(model, OSKAR_ELEMENT_TABLE_NONE, 0.0, 0, &status);
+    oskar_element_evaluate(model, out, 0.0, 0.0, num_points, x, y, z,
+            100e6, theta, phi, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(0.0, max_abs_diff(ref, out, num_points, &status));
+
+    // Check the copy still uses the tables, which it now owns.
+    ASSERT_TRUE(copy->tables != 0);
+    EXPECT_EQ(1, copy->tables->ref_count);
+    oskar_mem_clear_contents(out, &status);
+    oskar_element_evaluate(copy, out, 0.0, 0.0, num_points, x, y, z,
+            100e6, theta, phi, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(0.0, max_abs_diff(out_copy, out, num_points, &status));
+
+    oskar_mem_free(x, &status);
+    oskar_mem_free(y, &status);
+    oskar_mem_free(z, &status);
+    oskar_mem_free(theta, &status);
+    oskar_mem_free(phi, &status);
+    oskar_mem_free(ref, &status);
+    oskar_mem_free(out, &status);
+    oskar_mem_free(out_copy, &status);
+    oskar_element_free(model, &status);
+    oskar_element_free(copy, &status);
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2015, The University of Oxford
+ * Copyright (c) 2011-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -31,6 +31,7 @@
 #include "telescope/station/oskar_station.h"
 #include "telescope/station/oskar_evaluate_station_beam_aperture_array.h"
 #include "telescope/station/oskar_evaluate_station_beam_gaussian.h"
+#include "telescope/station/oskar_evaluate_station_beam_lut.h"
 #include "telescope/station/oskar_evaluate_beam_horizon_direction.h"
 #include "utility/oskar_get_error_string.h"
 #include "math/oskar_linspace.h"
@@ -315,3 +316,195 @@ TEST(evaluate_station_beam, gaussian)
         oskar_mem_free(beam, &error);
     }
 }
+
+TEST(evaluate_station_beam, multiple_element_types)
+{
+    int status = 0, num_elements = 64, num_points = 2000;
+    double frequency = 100e6, gast = 0.0;
+
+    // Construct a station model with a single element type.
+    oskar_Station* station = oskar_station_create(OSKAR_DOUBLE,
+            OSKAR_CPU, num_elements, &status);
+    oskar_station_resize_element_types(station, 1, &status);
+    oskar_station_set_position(station, 0.0, M_PI / 2.0, 0.0);
+    oskar_station_set_phase_centre(station,
+            OSKAR_SPHERICAL_TYPE_EQUATORIAL, 0.3, 1.2);
+    srand(3);
+    for (int i = 0; i < num_elements; ++i)
+    {
+        double xyz[3];
+        xyz[0] = 20.0 * (rand() / (double)RAND_MAX - 0.5);
+        xyz[1] = 20.0 * (rand() / (double)RAND_MAX - 0.5);
+        xyz[2] = 0.0;
+        oskar_station_set_element_coords(station, i, xyz, xyz, &status);
+    }
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Copy it, and give the copy a second (identical) element type,
+    // so that the beam is evaluated using the indexed-input DFT.
+    oskar_Station* station_types = oskar_station_create_copy(station,
+            OSKAR_CPU, &status);
+    oskar_station_resize_element_types(station_types, 2, &status);
+    oskar_element_copy(oskar_station_element(station_types, 1),
+            oskar_station_element(station_types, 0), &status);
+    for (int i = 0; i < num_elements; i += 2)
+        oskar_station_set_element_type(station_types, i, 1, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(2, oskar_station_num_element_types(station_types));
+    ASSERT_TRUE(oskar_station_common_element_orientation(station_types));
+
+    // Generate random directions above the horizon.
+    oskar_Mem *x, *y, *z, *beam, *beam_types;
+    x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &status);
+    y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &status);
+    z = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &status);
+    double *x_ = oskar_mem_double(x, &status);
+    double *y_ = oskar_mem_double(y, &status);
+    double *z_ = oskar_mem_double(z, &status);
+    for (int i = 0; i < num_points; ++i)
+    {
+        double r = 0.99 * sqrt(rand() / (double)RAND_MAX);
+        double a = 2.0 * M_PI * rand() / (double)RAND_MAX;
+        x_[i] = r * cos(a);
+        y_[i] = r * sin(a);
+        z_[i] = sqrt(1.0 - r * r);
+    }
+
+    // Evaluate both beams.
+    oskar_StationWork* work = oskar_station_work_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &status);
+    beam = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX, OSKAR_CPU,
+            num_points, &status);
+    beam_types = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX, OSKAR_CPU,
+            num_points, &status);
+    oskar_evaluate_station_beam_aperture_array(beam, station,
+            num_points, x, y, z, gast, frequency, work, 0, &status);
+    oskar_evaluate_station_beam_aperture_array(beam_types, station_types,
+            num_points, x, y, z, gast, frequency, work, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check they are the same.
+    const double* a = oskar_mem_double_const(beam, &status);
+    const double* b = oskar_mem_double_const(beam_types, &status);
+    for (int i = 0; i < 8 * num_points; ++i)
+        ASSERT_NEAR(a[i], b[i], 1e-10) << "at index " << i;
+
+    oskar_mem_free(x, &status);
+    oskar_mem_free(y, &status);
+    oskar_mem_free(z, &status);
+    oskar_mem_free(beam, &status);
+    oskar_mem_free(beam_types, &status);
+    oskar_station_work_free(work, &status);
+    oskar_station_free(station, &status);
+    oskar_station_free(station_types, &status);
+}
+
+TEST(evaluate_station_beam, lookup_table)
+{
+    int status = 0, num_elements = 64, num_points = 20000;
+    double frequency = 100e6, gast = 0.0;
+
+    // Construct a station model.
+    oskar_Station* station = oskar_station_create(OSKAR_DOUBLE,
+            OSKAR_CPU, num_elements, &status);
+    oskar_station_resize_element_types(station, 1, &status);
+    oskar_station_set_position(station, 0.0, M_PI / 4.0, 0.0);
+    oskar_station_set_phase_centre(station,
+            OSKAR_SPHERICAL_TYPE_EQUATORIAL, 0.3, 0.5);
+    srand(5);
+    for (int i = 0; i < num_elements; ++i)
+    {
+        double xyz[3];
+        xyz[0] = 30.0 * (rand() / (double)RAND_MAX - 0.5);
+        xyz[1] = 30.0 * (rand() / (double)RAND_MAX - 0.5);
+        xyz[2] = 0.0;
+        oskar_station_set_element_coords(station, i, xyz, xyz, &status);
+    }
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Generate random directions, some below the horizon.
+    oskar_Mem *x, *y, *z;
+    x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &status);
+    y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &status);
+    z = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &status);
+    double *x_ = oskar_mem_double(x, &status);
+    double *y_ = oskar_mem_double(y, &status);
+    double *z_ = oskar_mem_double(z, &status);
+    for (int i = 0; i < num_points; ++i)
+    {
+        double r = sqrt(rand() / (double)RAND_MAX);
+        double a = 2.0 * M_PI * rand() / (double)RAND_MAX;
+        x_[i] = r * cos(a);
+        y_[i] = r * sin(a);
+        z_[i] = sqrt(1.0 - r * r) * (i % 10 == 0 ? -1.0 : 1.0);
+    }
+
+    // Evaluate the beam directly, and using look-up tables.
+    oskar_StationWork* work = oskar_station_work_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &status);
+    oskar_Mem *beam, *beam_lut;
+    beam = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX, OSKAR_CPU,
+            num_points, &status);
+    beam_lut = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX, OSKAR_CPU,
+            num_points, &status);
+    oskar_evaluate_station_beam_lut(beam, station, num_points,
+            x, y, z, gast, frequency, work, 0, &status);
+    ASSERT_EQ(0.0, oskar_station_work_beam_lut_error(work));
+    const double* a = oskar_mem_double_const(beam, &status);
+    const double* b = oskar_mem_double_const(beam_lut, &status);
+    double peak = 0.0;
+    for (int i = 0; i < 8 * num_points; ++i)
+        if (fabs(a[i]) > peak) peak = fabs(a[i]);
+    const double samples[] = {4.0, 8.0, 16.0};
+    double last_error = 1.0;
+    for (int k = 0; k < 3; ++k)
+    {
+        oskar_station_set_beam_lut_oversample(station, samples[k]);
+        oskar_evaluate_station_beam_lut(beam_lut, station, num_points,
+                x, y, z, gast, frequency, work, 0, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        double error = 0.0;
+        for (int i = 0; i < 8 * num_points; ++i)
+        {
+            if (z_[i / 8] < 0.0)
+            {
+                ASSERT_EQ(0.0, b[i]);
+            }
+            double t = fabs(a[i] - b[i]) / peak;
+            if (t > error) error = t;
+
+        }
+
+        // Check the error decreases with finer sampling, and that it
+        // agrees with the estimate to within an order of magnitude.
+        double estimate = oskar_station_work_beam_lut_error(work);
+        EXPECT_LT(error, last_error);
+        EXPECT_LT(error, 10.0 * estimate);
+        EXPECT_GT(error, 0.1 * estimate);
+        last_error = error;
+        oskar_station_work_free(work, &status);
+        work = oskar_station_work_create(OSKAR_DOUBLE, OSKAR_CPU, &status);
+    }
+    EXPECT_LT(last_error, 1e-4);
+
+    // Check the size of a table, and that disabling tables in the work
+    // buffer gives the beam evaluated directly.
+    EXPECT_GT(oskar_evaluate_station_beam_lut_bytes(station, frequency,
+            OSKAR_DOUBLE_COMPLEX_MATRIX, &status),
+            (size_t) (64 * 64 * 64));
+    oskar_station_work_set_beam_lut(work, 0);
+    oskar_evaluate_station_beam_lut(beam_lut, station, num_points,
+            x, y, z, gast, frequency, work, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(0.0, oskar_station_work_beam_lut_error(work));
+    for (int i = 0; i < 8 * num_points; ++i)
+        ASSERT_EQ(a[i], b[i]);
+
+    oskar_mem_free(x, &status);
+    oskar_mem_free(y, &status);
+    oskar_mem_free(z, &status);
+    oskar_mem_free(beam, &status);
+    oskar_mem_free(beam_lut, &status);
+    oskar_station_work_free(work, &status);
+    oskar_station_free(station, &status);
+}
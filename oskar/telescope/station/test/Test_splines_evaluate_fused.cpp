@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "splines/oskar_dierckx_bispev.h"
+#include "splines/oskar_splines.h"
+#include "splines/private_splines.h"
+#include "utility/oskar_get_error_string.h"
+#include "mem/oskar_mem.h"
+#include "math/oskar_cmath.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+static oskar_Splines* fit_surface(double freq, int* status)
+{
+    const int n_theta = 19, n_phi = 37, n = n_theta * n_phi;
+    double avg_frac_err = 0.02;
+    std::vector<double> theta(n), phi(n), z(n), wt(n, 1.0);
+    for (int i = 0, k = 0; i < n_theta; ++i)
+    {
+        for (int j = 0; j < n_phi; ++j, ++k)
+        {
+            theta[k] = i * (M_PI / 2.0) / (n_theta - 1);
+            phi[k] = j * (2.0 * M_PI) / (n_phi - 1);
+            z[k] = cos(theta[k]) * (1.0 + 0.3 * sin(freq * phi[k]));
+        }
+    }
+    oskar_Splines* spline = oskar_splines_create(OSKAR_DOUBLE, OSKAR_CPU,
+            status);
+    oskar_splines_fit(spline, n, &theta[0], &phi[0], &z[0], &wt[0],
+            OSKAR_SPLINES_SPHERICAL, 1, &avg_frac_err, 1.5, 1.0, 1e-14,
+            status);
+    return spline;
+}
+
+static void set_knots(oskar_Mem* knots, int num_knots, double max, int* status)
+{
+    oskar_mem_realloc(knots, num_knots, status);
+    double* t = oskar_mem_double(knots, status);
+    for (int i = 0; i < num_knots; ++i)
+    {
+        int j = i < 3 ? 3 : (i > num_knots - 4 ? num_knots - 4 : i);
+        t[i] = (j - 3) * max / (num_knots - 7);
+    }
+}
+
+TEST(splines, evaluate)
+{
+    int status = 0, num_points = 20000;
+    const int stride = 2, num_knots = 200;
+
+    // Create a surface with many knot intervals in each dimension.
+    oskar_Splines* s = oskar_splines_create(OSKAR_DOUBLE, OSKAR_CPU,
+            &status);
+    s->num_knots_x_theta = num_knots;
+    s->num_knots_y_phi = num_knots;
+    set_knots(s->knots_x_theta, num_knots, M_PI / 2.0, &status);
+    set_knots(s->knots_y_phi, num_knots, 2.0 * M_PI, &status);
+    oskar_mem_realloc(s->coeff, (num_knots - 4) * (num_knots - 4), &status);
+    srand(2);
+    oskar_mem_random_range(s->coeff, -1.0, 1.0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Evaluate at random points, then repeat with the points in order.
+    oskar_Mem *x, *y, *out;
+    x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &status);
+    y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &status);
+    out = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, stride * num_points,
+            &status);
+    oskar_mem_random_range(x, -0.1, M_PI / 2.0 + 0.1, &status);
+    oskar_mem_random_range(y, -0.1, 2.0 * M_PI + 0.1, &status);
+    oskar_Mem* out_ref = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_points, &status);
+    double* x_ = oskar_mem_double(x, &status);
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        if (pass == 1)
+            for (int i = 0; i < num_points; ++i)
+                x_[i] = -0.1 + i * (M_PI / 2.0 + 0.2) / num_points;
+        oskar_mem_clear_contents(out, &status);
+        oskar_splines_evaluate(out, 1, stride, s, num_points, x, y, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+        // Check against the evaluation done in the given point order.
+        oskar_splines_evaluate_fused(out_ref, 0, 1, 1, &s,
+                num_points, x, y, &status);
+        const double* a = oskar_mem_double_const(out, &status);
+        const double* b = oskar_mem_double_const(out_ref, &status);
+        for (int i = 0; i < num_points; ++i)
+        {
+            ASSERT_EQ(0.0, a[2 * i]);
+            ASSERT_DOUBLE_EQ(b[i], a[2 * i + 1]) << "at index " << i;
+        }
+    }
+
+    oskar_mem_free(x, &status);
+    oskar_mem_free(y, &status);
+    oskar_mem_free(out, &status);
+    oskar_mem_free(out_ref, &status);
+    oskar_splines_free(s, &status);
+}
+
+static void bispev(const float* tx, int nx, const float* ty, int ny,
+        const float* c, float x, float y, float* z, int* ier)
+{
+    float wrk[8];
+    int iwrk[2];
+    oskar_dierckx_bispev_f(tx, nx, ty, ny, c, 3, 3, &x, 1, &y, 1, z,
+            wrk, 8, iwrk, 2, ier);
+}
+
+static void bispev(const double* tx, int nx, const double* ty, int ny,
+        const double* c, double x, double y, double* z, int* ier)
+{
+    double wrk[8];
+    int iwrk[2];
+    oskar_dierckx_bispev_d(tx, nx, ty, ny, c, 3, 3, &x, 1, &y, 1, z,
+            wrk, 8, iwrk, 2, ier);
+}
+
+template<typename FP>
+static void check_against_bispev(int type, double tol)
+{
+    int status = 0;
+    const int stride = 2, num_knots = 40, num_random = 5000;
+    const FP inf = std::numeric_limits<FP>::infinity();
+
+    // Create a surface with random coefficients.
+    oskar_Splines* s = oskar_splines_create(type, OSKAR_CPU, &status);
+    s->num_knots_x_theta = num_knots;
+    s->num_knots_y_phi = num_knots;
+    oskar_mem_realloc(s->knots_x_theta, num_knots, &status);
+    oskar_mem_realloc(s->knots_y_phi, num_knots, &status);
+    oskar_mem_realloc(s->coeff, (num_knots - 4) * (num_knots - 4), &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    FP* tx = (FP*) oskar_mem_void(s->knots_x_theta);
+    FP* ty = (FP*) oskar_mem_void(s->knots_y_phi);
+    for (int i = 0; i < num_knots; ++i)
+    {
+        int j = i < 3 ? 3 : (i > num_knots - 4 ? num_knots - 4 : i);
+        tx[i] = (FP) ((j - 3) * (M_PI / 2.0) / (num_knots - 7));
+        ty[i] = (FP) ((j - 3) * (2.0 * M_PI) / (num_knots - 7));
+    }
+    srand(3);
+    oskar_mem_random_range(s->coeff, -1.0, 1.0, &status);
+
+    // Evaluate at each knot, at the nearest values either side of it,
+    // and at random points, including some outside the knot range.
+    std::vector<FP> px, py;
+    for (int i = 3; i < num_knots - 3; ++i)
+    {
+        const FP kx[] = { std::nextafter(tx[i], -inf), tx[i],
+                std::nextafter(tx[i], inf) };
+        const FP ky[] = { std::nextafter(ty[i], -inf), ty[i],
+                std::nextafter(ty[i], inf) };
+        for (int j = 0; j < 3; ++j)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                px.push_back(kx[j]);
+                py.push_back(ky[k]);
+            }
+            px.push_back(kx[j]);
+            py.push_back(ty[num_knots - 1 - i]);
+            px.push_back(tx[num_knots - 1 - i]);
+            py.push_back(ky[j]);
+        }
+    }
+    for (int i = 0; i < num_random; ++i)
+    {
+        px.push_back((FP) (-0.1 + (M_PI / 2.0 + 0.2) * rand() / RAND_MAX));
+        py.push_back((FP) (-0.1 + (2.0 * M_PI + 0.2) * rand() / RAND_MAX));
+    }
+    const int num_points = (int) px.size();
+    oskar_Mem *x, *y, *out;
+    x = oskar_mem_create(type, OSKAR_CPU, num_points, &status);
+    y = oskar_mem_create(type, OSKAR_CPU, num_points, &status);
+    out = oskar_mem_create(type, OSKAR_CPU, stride * num_points, &status);
+    for (int i = 0; i < num_points; ++i)
+    {
+        ((FP*) oskar_mem_void(x))[i] = px[i];
+        ((FP*) oskar_mem_void(y))[i] = py[i];
+    }
+    oskar_mem_clear_contents(out, &status);
+    oskar_splines_evaluate(out, 1, stride, s, num_points, x, y, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check against the reference evaluator, one point at a time.
+    const FP* c = (const FP*) oskar_mem_void_const(s->coeff);
+    const FP* a = (const FP*) oskar_mem_void_const(out);
+    for (int i = 0; i < num_points; ++i)
+    {
+        int ier = 0;
+        FP ref = (FP) 0;
+        bispev(tx, num_knots, ty, num_knots, c, px[i], py[i], &ref, &ier);
+        ASSERT_EQ(0, ier);
+        ASSERT_EQ((FP) 0, a[2 * i]);
+        ASSERT_NEAR(ref, a[2 * i + 1], tol) << "at point " << i << " ("
+                << px[i] << ", " << py[i] << ")";
+    }
+
+    oskar_mem_free(x, &status);
+    oskar_mem_free(y, &status);
+    oskar_mem_free(out, &status);
+    oskar_splines_free(s, &status);
+}
+
+TEST(splines, evaluate_matches_bispev_double)
+{
+    check_against_bispev<double>(OSKAR_DOUBLE, 1e-12);
+}
+
+TEST(splines, evaluate_matches_bispev_single)
+{
+    check_against_bispev<float>(OSKAR_SINGLE, 1e-5);
+}
+
+TEST(splines, evaluate_fused)
+{
+    int status = 0, num_points = 5000;
+    const int stride = 5;
+
+    // Two surfaces with shared knots, one with its own knots, and one empty.
+    oskar_Splines* s[4];
+    s[0] = fit_surface(2.0, &status);
+    s[1] = oskar_splines_create(OSKAR_DOUBLE, OSKAR_CPU, &status);
+    oskar_splines_copy(s[1], s[0], &status);
+    srand(1);
+    oskar_mem_random_range(oskar_splines_coeff(s[1]), -1.0, 1.0, &status);
+    s[2] = fit_surface(3.0, &status);
+    s[3] = oskar_splines_create(OSKAR_DOUBLE, OSKAR_CPU, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Evaluate at random points, including some outside the fitted range.
+    oskar_Mem *x, *y, *out_fused, *out_single;
+    x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &status);
+    y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &status);
+    out_fused = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            stride * num_points, &status);
+    out_single = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            stride * num_points, &status);
+    oskar_mem_random_range(x, -0.1, M_PI / 2.0 + 0.1, &status);
+    oskar_mem_random_range(y, -0.1, 2.0 * M_PI + 0.1, &status);
+    oskar_mem_clear_contents(out_fused, &status);
+    oskar_mem_clear_contents(out_single, &status);
+    for (int i = 0; i < 4; ++i)
+        oskar_splines_evaluate(out_single, 1 + i, stride, s[i],
+                num_points, x, y, &status);
+    oskar_splines_evaluate_fused(out_fused, 1, stride, 4, s,
+            num_points, x, y, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check results are the same.
+    const double* a = oskar_mem_double_const(out_single, &status);
+    const double* b = oskar_mem_double_const(out_fused, &status);
+    for (int i = 0; i < stride * num_points; ++i)
+        ASSERT_DOUBLE_EQ(a[i], b[i]) << "at index " << i;
+
+    // Check too many surfaces are rejected.
+    oskar_splines_evaluate_fused(out_fused, 0, 1, 9, s,
+            num_points, x, y, &status);
+    EXPECT_EQ((int) OSKAR_ERR_INVALID_ARGUMENT, status);
+    status = 0;
+
+    oskar_mem_free(x, &status);
+    oskar_mem_free(y, &status);
+    oskar_mem_free(out_fused, &status);
+    oskar_mem_free(out_single, &status);
+    for (int i = 0; i < 4; ++i)
+        oskar_splines_free(s[i], &status);
+}
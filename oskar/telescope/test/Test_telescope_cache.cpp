@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "utility/oskar_dir.h"
+#include "utility/oskar_get_error_string.h"
+#include "mem/oskar_mem.h"
+#include "math/oskar_cmath.h"
+#include "telescope/oskar_telescope.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static void write_file(const char* dir, const char* name, const char* text)
+{
+    oskar_dir_mkpath(dir);
+    char* path = oskar_dir_get_path(dir, name);
+    FILE* f = fopen(path, "w");
+    fprintf(f, "%s", text);
+    fclose(f);
+    free(path);
+}
+
+static oskar_Telescope* load(const char* dir, int use_cache, int* status)
+{
+    oskar_Telescope* t = oskar_telescope_create(OSKAR_DOUBLE, OSKAR_CPU, 0,
+            status);
+    oskar_telescope_set_enable_numerical_patterns(t, 0);
+    oskar_telescope_set_enable_model_cache(t, use_cache);
+    oskar_telescope_load(t, dir, NULL, status);
+    return t;
+}
+
+static void check_same(const oskar_Telescope* a, const oskar_Telescope* b)
+{
+    int status = 0;
+    ASSERT_EQ(oskar_telescope_num_stations(a),
+            oskar_telescope_num_stations(b));
+    EXPECT_EQ(oskar_telescope_lon_rad(a), oskar_telescope_lon_rad(b));
+    EXPECT_EQ(oskar_telescope_lat_rad(a), oskar_telescope_lat_rad(b));
+    EXPECT_FALSE(oskar_mem_different(
+            oskar_telescope_station_true_x_enu_metres_const(a),
+            oskar_telescope_station_true_x_enu_metres_const(b), 0, &status));
+    EXPECT_FALSE(oskar_mem_different(
+            oskar_telescope_station_measured_y_offset_ecef_metres_const(a),
+            oskar_telescope_station_measured_y_offset_ecef_metres_const(b),
+            0, &status));
+    for (int i = 0; i < oskar_telescope_num_stations(a); ++i)
+    {
+        const oskar_Station* s_a = oskar_telescope_station_const(a, i);
+        const oskar_Station* s_b = oskar_telescope_station_const(b, i);
+        EXPECT_FALSE(oskar_station_different(s_a, s_b, &status));
+        EXPECT_EQ(oskar_station_unique_id(s_a), oskar_station_unique_id(s_b));
+        ASSERT_TRUE(oskar_station_has_child(s_b));
+        EXPECT_FALSE(oskar_mem_different(
+                oskar_station_element_gain_const(
+                        oskar_station_child_const(s_a, 2)),
+                oskar_station_element_gain_const(
+                        oskar_station_child_const(s_b, 2)), 0, &status));
+    }
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(telescope_cache, load)
+{
+    int status = 0;
+    const char* tm = "temp_test_telescope_cache";
+    char* station = oskar_dir_get_path(tm, "station");
+    char* tile = oskar_dir_get_path(station, "tile");
+
+    // Create a telescope model with stations made of identical tiles.
+    write_file(tm, "position.txt", "20.0, -30.0\n");
+    write_file(tm, "layout.txt",
+            "0, 0\n100, 0\n0, 100\n-100, 0\n0, -100\n");
+    write_file(station, "layout.txt", "0, 0\n5, 0\n0, 5\n");
+    write_file(tile, "layout.txt", "0, 0\n1, 0\n0, 1\n1, 1\n");
+    write_file(tile, "gain_phase.txt",
+            "1.5, 0, 10, 0\n1.5, 0, 10, 0\n1.5, 0, 10, 0\n1.5, 0, 10, 0\n");
+
+    // Load the model without the cache, and twice with it.
+    oskar_Telescope* ref = load(tm, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_FALSE(oskar_dir_file_exists(tm, OSKAR_TELESCOPE_CACHE_NAME));
+    for (int i = 0; i < 2; ++i)
+    {
+        oskar_Telescope* t = load(tm, 1, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        EXPECT_TRUE(oskar_dir_file_exists(tm, OSKAR_TELESCOPE_CACHE_NAME));
+        check_same(ref, t);
+        oskar_telescope_free(t, &status);
+    }
+
+    // Check the cache is only used with a matching hash.
+    char* cache = oskar_dir_get_path(tm, OSKAR_TELESCOPE_CACHE_NAME);
+    oskar_Telescope* t = oskar_telescope_create(OSKAR_DOUBLE, OSKAR_CPU, 0,
+            &status);
+    oskar_telescope_set_enable_numerical_patterns(t, 0);
+    unsigned long long hash = oskar_telescope_cache_hash(t, tm, &status);
+    EXPECT_FALSE(oskar_telescope_cache_read(t, cache, hash + 1, &status));
+    EXPECT_EQ(0, oskar_telescope_num_stations(t));
+    EXPECT_TRUE(oskar_telescope_cache_read(t, cache, hash, &status));
+    EXPECT_EQ(5, oskar_telescope_num_stations(t));
+    oskar_telescope_set_enable_numerical_patterns(t, 1);
+    EXPECT_NE(hash, oskar_telescope_cache_hash(t, tm, &status));
+    oskar_telescope_free(t, &status);
+    free(cache);
+
+    // Change a file, and check the cache is not used.
+    write_file(tile, "gain_phase.txt",
+            "2.5, 0, 10, 0\n2.5, 0, 10, 0\n2.5, 0, 10, 0\n2.5, 0, 10, 0\n");
+    t = load(tm, 1, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const double* gain = oskar_mem_double_const(
+            oskar_station_element_gain_const(oskar_station_child_const(
+                    oskar_telescope_station_const(t, 4), 1)), &status);
+    EXPECT_DOUBLE_EQ(2.5, gain[3]);
+    oskar_telescope_free(t, &status);
+    oskar_telescope_free(ref, &status);
+    free(station);
+    free(tile);
+    oskar_dir_remove(tm);
+}
+
+TEST(telescope_cache, element_splines)
+{
+    int status = 0;
+    const char* tm = "temp_test_telescope_cache_splines";
+    oskar_dir_mkpath(tm);
+    char* cache = oskar_dir_get_path(tm, OSKAR_TELESCOPE_CACHE_NAME);
+
+    // Create a telescope with an element pattern fitted at two frequencies.
+    oskar_Telescope* t = oskar_telescope_create(OSKAR_DOUBLE, OSKAR_CPU, 2,
+            &status);
+    for (int s = 0; s < 2; ++s)
+    {
+        oskar_Station* st = oskar_telescope_station(t, s);
+        oskar_station_resize(st, 3, &status);
+        oskar_station_resize_element_types(st, 1, &status);
+    }
+    oskar_Element* e = oskar_station_element(oskar_telescope_station(t, 1), 0);
+    oskar_element_resize_freq_data(e, 2, &status);
+    const int n_theta = 10, n_phi = 19, n = n_theta * n_phi;
+    std::vector<double> theta(n), phi(n), z(n), wt(n, 1.0);
+    for (int f = 0; f < 2; ++f)
+    {
+        for (int i = 0, k = 0; i < n_theta; ++i)
+        {
+            for (int j = 0; j < n_phi; ++j, ++k)
+            {
+                theta[k] = i * (M_PI / 2.0) / (n_theta - 1);
+                phi[k] = j * (2.0 * M_PI) / (n_phi - 1);
+                z[k] = cos(theta[k]) * (1.0 + 0.2 * (f + 1) * sin(phi[k]));
+            }
+        }
+        double avg_frac_err = 0.02;
+        oskar_splines_fit(oskar_element_x_h_re(e, f), n, &theta[0], &phi[0],
+                &z[0], &wt[0], OSKAR_SPLINES_SPHERICAL, 1, &avg_frac_err,
+                1.5, 1.0, 1e-14, &status);
+    }
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Write the cache and read it back.
+    oskar_telescope_cache_write(t, cache, 1234, &status);
+    oskar_Telescope* t2 = oskar_telescope_create(OSKAR_DOUBLE, OSKAR_CPU, 0,
+            &status);
+    EXPECT_TRUE(oskar_telescope_cache_read(t2, cache, 1234, &status));
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(2, oskar_telescope_num_stations(t2));
+    EXPECT_FALSE(oskar_station_different(oskar_telescope_station_const(t, 0),
+            oskar_telescope_station_const(t2, 0), &status));
+    const oskar_Element* e2 = oskar_station_element_const(
+            oskar_telescope_station_const(t2, 1), 0);
+    ASSERT_EQ(2, oskar_element_num_freq(e2));
+    for (int f = 0; f < 2; ++f)
+    {
+        const oskar_Splines *a = oskar_element_x_h_re_const(e, f);
+        const oskar_Splines *b = oskar_element_x_h_re_const(e2, f);
+        ASSERT_GT(oskar_splines_num_knots_x_theta(a), 0);
+        EXPECT_EQ(oskar_splines_num_knots_x_theta(a),
+                oskar_splines_num_knots_x_theta(b));
+        EXPECT_EQ(oskar_splines_num_knots_y_phi(a),
+                oskar_splines_num_knots_y_phi(b));
+        EXPECT_FALSE(oskar_mem_different(oskar_splines_coeff_const(a),
+                oskar_splines_coeff_const(b), 0, &status));
+        EXPECT_FALSE(oskar_mem_different(
+                oskar_splines_knots_y_phi_const(a),
+                oskar_splines_knots_y_phi_const(b), 0, &status));
+    }
+
+    // Check a damaged cache file is rejected.
+    FILE* f = fopen(cache, "r+b");
+    fseek(f, -8, SEEK_END);
+    fputc('x', f);
+    fclose(f);
+    oskar_Telescope* t3 = oskar_telescope_create(OSKAR_DOUBLE, OSKAR_CPU, 0,
+            &status);
+    EXPECT_FALSE(oskar_telescope_cache_read(t3, cache, 1234, &status));
+    EXPECT_EQ(0, status) << oskar_get_error_string(status);
+
+    oskar_telescope_free(t, &status);
+    oskar_telescope_free(t2, &status);
+    oskar_telescope_free(t3, &status);
+    free(cache);
+    oskar_dir_remove(tm);
+}
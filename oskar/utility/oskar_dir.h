@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -168,6 +168,23 @@ OSKAR_EXPORT
 char oskar_dir_separator(void);
 
 
+/**
+ * @brief Returns a name for a temporary file next to the given file.
+ *
+ * @details
+ * This function returns a name of the form "<file_path>.<pid>.<n>.tmp",
+ * where <pid> is the process ID and <n> is a counter, so that
+ * concurrent writers in different processes and threads don't use the
+ * same temporary file. It can be used to write a file and then rename it.
+ *
+ * The returned string must be freed by the caller.
+ *
+ * @param[in] file_path  Path of the file.
+ */
+OSKAR_EXPORT
+char* oskar_dir_temp_file_name(const char* file_path);
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_EVENT_RING_H_
+#define OSKAR_EVENT_RING_H_
+
+/**
+ * @file oskar_event_ring.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @struct oskar_Event
+ *
+ * @brief Structure to hold a small, fixed-size event record.
+ *
+ * @details
+ * Holds an event type, a time stamp and a few integer values.
+ * The meaning of the values depends on the type, which is defined by the
+ * code that uses the ring buffer.
+ */
+struct oskar_Event
+{
+    double time_sec;
+    int type;
+    int values[5];
+};
+typedef struct oskar_Event oskar_Event;
+
+struct oskar_EventRing;
+#ifndef OSKAR_EVENT_RING_TYPEDEF_
+#define OSKAR_EVENT_RING_TYPEDEF_
+typedef struct oskar_EventRing oskar_EventRing;
+#endif
+
+/**
+ * @brief Creates a lock-free ring buffer of events.
+ *
+ * @details
+ * Creates a bounded, lock-free ring buffer of events, for use by exactly one
+ * producer thread and one consumer thread.
+ *
+ * Events pushed when the buffer is full are discarded and counted, so that
+ * the producer never has to wait for the consumer.
+ *
+ * @param[in] capacity Minimum number of events the buffer can hold.
+ *                     This is rounded up to a power of two.
+ *
+ * @return A handle to the buffer, or NULL if it could not be allocated.
+ */
+OSKAR_EXPORT
+oskar_EventRing* oskar_event_ring_create(int capacity);
+
+/**
+ * @brief Destroys the ring buffer.
+ *
+ * @details
+ * Destroys the ring buffer.
+ *
+ * @param[in,out] ring Pointer to ring buffer.
+ */
+OSKAR_EXPORT
+void oskar_event_ring_free(oskar_EventRing* ring);
+
+/**
+ * @brief Pushes an event onto the ring buffer (producer only).
+ *
+ * @details
+ * Pushes an event onto the ring buffer, if there is space.
+ * This function must only be called by the producer thread.
+ *
+ * @param[in,out] ring  Pointer to ring buffer.
+ * @param[in]     event Event to push.
+ *
+ * @return 1 if the event was stored, or 0 if it was discarded.
+ */
+OSKAR_EXPORT
+int oskar_event_ring_push(oskar_EventRing* ring, const oskar_Event* event);
+
+/**
+ * @brief Returns the oldest event in the ring buffer (consumer only).
+ *
+ * @details
+ * Returns a pointer to the oldest event in the ring buffer without
+ * removing it, or NULL if the buffer is empty.
+ * This function must only be called by the consumer thread.
+ *
+ * @param[in,out] ring  Pointer to ring buffer.
+ */
+OSKAR_EXPORT
+const oskar_Event* oskar_event_ring_peek(oskar_EventRing* ring);
+
+/**
+ * @brief Removes the oldest event from the ring buffer (consumer only).
+ *
+ * @details
+ * Removes the oldest event from the ring buffer, optionally copying it
+ * to \p event.
+ * This function must only be called by the consumer thread.
+ *
+ * @param[in,out] ring  Pointer to ring buffer.
+ * @param[out]    event If not NULL, the event that was removed.
+ *
+ * @return 1 if an event was removed, or 0 if the buffer was empty.
+ */
+OSKAR_EXPORT
+int oskar_event_ring_pop(oskar_EventRing* ring, oskar_Event* event);
+
+/**
+ * @brief Returns the number of events discarded because the buffer was full.
+ *
+ * @details
+ * Returns the number of events discarded because the buffer was full.
+ *
+ * @param[in] ring  Pointer to ring buffer.
+ */
+OSKAR_EXPORT
+int oskar_event_ring_num_dropped(oskar_EventRing* ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_EVENT_RING_H_ */
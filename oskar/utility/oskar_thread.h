@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017, The University of Oxford
+ * Copyright (c) 2017-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -40,11 +40,15 @@ extern "C" {
 #endif
 
 struct oskar_Mutex;
+struct oskar_ConditionVar;
 struct oskar_Thread;
 struct oskar_Barrier;
+struct oskar_Latch;
 typedef struct oskar_Mutex oskar_Mutex;
+typedef struct oskar_ConditionVar oskar_ConditionVar;
 typedef struct oskar_Thread oskar_Thread;
 typedef struct oskar_Barrier oskar_Barrier;
+typedef struct oskar_Latch oskar_Latch;
 
 /**
  * @brief Creates a mutex.
@@ -90,11 +94,79 @@ void oskar_mutex_lock(oskar_Mutex* mutex);
 OSKAR_EXPORT
 void oskar_mutex_unlock(oskar_Mutex* mutex);
 
+/**
+ * @brief Creates a condition variable.
+ *
+ * @details
+ * Creates a condition variable, together with the mutex that protects it.
+ */
+OSKAR_EXPORT
+oskar_ConditionVar* oskar_condition_create(void);
+
+/**
+ * @brief Destroys the condition variable.
+ *
+ * @details
+ * Destroys the condition variable.
+ *
+ * @param[in,out] var Pointer to condition variable.
+ */
+OSKAR_EXPORT
+void oskar_condition_free(oskar_ConditionVar* var);
+
+/**
+ * @brief Locks the mutex associated with the condition variable.
+ *
+ * @details
+ * Locks the mutex associated with the condition variable.
+ *
+ * @param[in,out] var Pointer to condition variable.
+ */
+OSKAR_EXPORT
+void oskar_condition_lock(oskar_ConditionVar* var);
+
+/**
+ * @brief Unlocks the mutex associated with the condition variable.
+ *
+ * @details
+ * Unlocks the mutex associated with the condition variable.
+ *
+ * @param[in,out] var Pointer to condition variable.
+ */
+OSKAR_EXPORT
+void oskar_condition_unlock(oskar_ConditionVar* var);
+
+/**
+ * @brief Wakes all threads waiting on the condition variable.
+ *
+ * @details
+ * Wakes all threads waiting on the condition variable.
+ *
+ * @param[in,out] var Pointer to condition variable.
+ */
+OSKAR_EXPORT
+void oskar_condition_notify_all(oskar_ConditionVar* var);
+
+/**
+ * @brief Waits on the condition variable.
+ *
+ * @details
+ * Atomically releases the mutex and blocks the caller until the condition
+ * variable is notified. The mutex is locked again before this function
+ * returns. The caller must hold the lock, and must re-check the condition
+ * on return, as spurious wake-ups are possible.
+ *
+ * @param[in,out] var Pointer to condition variable.
+ */
+OSKAR_EXPORT
+void oskar_condition_wait(oskar_ConditionVar* var);
+
 /**
  * @brief Creates and starts a thread.
  *
  * @details
  * Creates and starts a thread.
+ * Returns NULL if the thread could not be started.
  */
 OSKAR_EXPORT
 oskar_Thread* oskar_thread_create(void *(*start_routine)(void*), void* arg,
@@ -118,6 +190,21 @@ void oskar_thread_free(oskar_Thread* thread);
 OSKAR_EXPORT
 void oskar_thread_join(oskar_Thread* thread);
 
+/**
+ * @brief Binds a thread to a processor core.
+ *
+ * @details
+ * Restricts the thread so that it only runs on the given processor core.
+ * This is supported only on Linux and Windows, and does nothing elsewhere.
+ *
+ * @param[in,out] thread Pointer to thread.
+ * @param[in]     core   Zero-based index of the processor core.
+ *
+ * @return 1 if the affinity was set, or 0 if not.
+ */
+OSKAR_EXPORT
+int oskar_thread_set_affinity(oskar_Thread* thread, int core);
+
 /**
  * @brief Creates a barrier.
  *
@@ -163,6 +250,106 @@ void oskar_barrier_set_num_threads(oskar_Barrier* barrier, int num_threads);
 OSKAR_EXPORT
 int oskar_barrier_wait(oskar_Barrier* barrier);
 
+/**
+ * @brief Creates a countdown latch.
+ *
+ * @details
+ * Creates a countdown latch, which allows one thread to wait (with a
+ * time-out) until a number of other threads have counted down to zero.
+ *
+ * The latch is created with a count of zero.
+ */
+OSKAR_EXPORT
+oskar_Latch* oskar_latch_create(void);
+
+/**
+ * @brief Destroys the latch.
+ *
+ * @details
+ * Destroys the latch.
+ *
+ * @param[in,out] latch Pointer to latch.
+ */
+OSKAR_EXPORT
+void oskar_latch_free(oskar_Latch* latch);
+
+/**
+ * @brief Sets the count of the latch.
+ *
+ * @details
+ * Sets the count of the latch. This must not be called while any other
+ * thread is using the latch.
+ *
+ * @param[in,out] latch Pointer to latch.
+ * @param[in]     count New value of the count.
+ */
+OSKAR_EXPORT
+void oskar_latch_set(oskar_Latch* latch, int count);
+
+/**
+ * @brief Decrements the count of the latch.
+ *
+ * @details
+ * Decrements the count of the latch, and wakes any waiting thread if the
+ * count reaches zero.
+ *
+ * @param[in,out] latch Pointer to latch.
+ */
+OSKAR_EXPORT
+void oskar_latch_count_down(oskar_Latch* latch);
+
+/**
+ * @brief Waits until the count of the latch reaches zero.
+ *
+ * @details
+ * Blocks the caller until the count of the latch reaches zero, or until
+ * the given time-out has expired.
+ *
+ * @param[in,out] latch       Pointer to latch.
+ * @param[in]     timeout_sec Maximum time to wait, in seconds.
+ *
+ * @return 1 if the count is zero, or 0 if the wait timed out.
+ */
+OSKAR_EXPORT
+int oskar_latch_wait(oskar_Latch* latch, double timeout_sec);
+
+/**
+ * @brief Atomically adds a value to an integer.
+ *
+ * @details
+ * Atomically adds a value to an integer, and returns its previous value.
+ *
+ * @param[in,out] value     Pointer to value to modify.
+ * @param[in]     increment Amount to add.
+ *
+ * @return The value before the addition.
+ */
+OSKAR_EXPORT
+int oskar_atomic_add_int(volatile int* value, int increment);
+
+/**
+ * @brief Atomically loads an integer.
+ *
+ * @details
+ * Atomically loads an integer, with acquire semantics.
+ *
+ * @param[in] value Pointer to value to load.
+ */
+OSKAR_EXPORT
+int oskar_atomic_load_int(volatile int* value);
+
+/**
+ * @brief Atomically stores an integer.
+ *
+ * @details
+ * Atomically stores an integer, with release semantics.
+ *
+ * @param[in,out] value     Pointer to value to modify.
+ * @param[in]     new_value Value to store.
+ */
+OSKAR_EXPORT
+void oskar_atomic_store_int(volatile int* value, int new_value);
+
 #ifdef __cplusplus
 }
 #endif
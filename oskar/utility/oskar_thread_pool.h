@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_THREAD_POOL_H_
+#define OSKAR_THREAD_POOL_H_
+
+/**
+ * @file oskar_thread_pool.h
+ */
+
+#include <oskar_global.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_ThreadPool;
+struct oskar_Future;
+typedef struct oskar_ThreadPool oskar_ThreadPool;
+typedef struct oskar_Future oskar_Future;
+
+/**
+ * @brief Creates a pool of worker threads.
+ *
+ * @details
+ * Creates a pool of persistent worker threads, which run tasks submitted
+ * using oskar_thread_pool_submit() in the order they were submitted.
+ *
+ * Tasks may wait for each other (for example, at a barrier) only if
+ * there are no more of them in flight than there are threads in the pool.
+ *
+ * If \p pin_to_cores is set, each worker thread is bound to a different
+ * processor core, where the platform supports it.
+ *
+ * If any of the threads cannot be started, the error code is returned
+ * in \p status, and no pool is created.
+ *
+ * @param[in] num_threads  Number of worker threads in the pool.
+ * @param[in] pin_to_cores If set, bind each worker thread to one core.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+oskar_ThreadPool* oskar_thread_pool_create(int num_threads, int pin_to_cores,
+        int* status);
+
+/**
+ * @brief Destroys the thread pool.
+ *
+ * @details
+ * Waits for all submitted tasks to finish, then stops the worker threads
+ * and destroys the pool.
+ *
+ * All futures for tasks submitted to the pool must be freed before the
+ * pool is destroyed.
+ *
+ * @param[in,out] pool Pointer to thread pool.
+ */
+OSKAR_EXPORT
+void oskar_thread_pool_free(oskar_ThreadPool* pool);
+
+/**
+ * @brief Returns the number of worker threads in the pool.
+ *
+ * @details
+ * Returns the number of worker threads in the pool.
+ *
+ * @param[in] pool Pointer to thread pool.
+ */
+OSKAR_EXPORT
+int oskar_thread_pool_num_threads(const oskar_ThreadPool* pool);
+
+/**
+ * @brief Submits a task to the thread pool.
+ *
+ * @details
+ * Queues the function \p task to be called with argument \p arg by the
+ * next available worker thread.
+ *
+ * The returned future must be freed by the caller using
+ * oskar_future_free().
+ *
+ * If the task cannot be queued, the error code is returned in \p status,
+ * and the function returns NULL.
+ *
+ * @param[in,out] pool   Pointer to thread pool.
+ * @param[in]     task   Function to call.
+ * @param[in]     arg    Argument to pass to the function.
+ * @param[in,out] status Status return code.
+ *
+ * @return A handle to the result of the task.
+ */
+OSKAR_EXPORT
+oskar_Future* oskar_thread_pool_submit(oskar_ThreadPool* pool,
+        void *(*task)(void*), void* arg, int* status);
+
+/**
+ * @brief Submits a group of tasks to the thread pool.
+ *
+ * @details
+ * Queues \p num_tasks calls to the function \p task, each with a pointer
+ * to the next element of the array \p args, where each element is
+ * \p arg_size bytes long.
+ *
+ * Either all of the tasks are queued, or (if there is an error) none of
+ * them are, so tasks that wait for each other at a barrier cannot be
+ * left waiting for a task that was never started.
+ *
+ * The returned futures must each be freed by the caller using
+ * oskar_future_free().
+ *
+ * @param[in,out] pool      Pointer to thread pool.
+ * @param[in]     num_tasks Number of tasks to submit.
+ * @param[in]     task      Function to call.
+ * @param[in]     args      Array of arguments to pass to the function.
+ * @param[in]     arg_size  Size of each element of \p args, in bytes.
+ * @param[out]    futures   Array of \p num_tasks handles to the results.
+ * @param[in,out] status    Status return code.
+ */
+OSKAR_EXPORT
+void oskar_thread_pool_submit_all(oskar_ThreadPool* pool, int num_tasks,
+        void *(*task)(void*), void* args, size_t arg_size,
+        oskar_Future** futures, int* status);
+
+/**
+ * @brief Waits for a task to finish, and returns its result.
+ *
+ * @details
+ * Blocks the caller until the task has finished, and returns the value
+ * returned by the task function.
+ *
+ * @param[in,out] future Handle returned by oskar_thread_pool_submit().
+ */
+OSKAR_EXPORT
+void* oskar_future_get(oskar_Future* future);
+
+/**
+ * @brief Frees resources held by a future.
+ *
+ * @details
+ * Waits for the task to finish if necessary, and frees the future.
+ *
+ * @param[in,out] future Handle returned by oskar_thread_pool_submit().
+ */
+OSKAR_EXPORT
+void oskar_future_free(oskar_Future* future);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_THREAD_POOL_H_ */
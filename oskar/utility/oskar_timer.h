@@ -139,6 +139,19 @@ void oskar_timer_restart(oskar_Timer* timer);
 OSKAR_EXPORT
 void oskar_timer_start(oskar_Timer* timer);
 
+/**
+ * @brief Returns the current wall clock time.
+ *
+ * @details
+ * Returns the current time from the native system clock, in seconds,
+ * relative to an arbitrary origin.
+ *
+ * This does not use a timer object, so it can be called from any thread
+ * without locking. It is intended to time-stamp events.
+ */
+OSKAR_EXPORT
+double oskar_timer_wall_time(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_TRACE_H_
+#define OSKAR_TRACE_H_
+
+/**
+ * @file oskar_trace.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_Trace;
+#ifndef OSKAR_TRACE_TYPEDEF_
+#define OSKAR_TRACE_TYPEDEF_
+typedef struct oskar_Trace oskar_Trace;
+#endif
+
+/**
+ * @brief Creates a trace recorder.
+ *
+ * @details
+ * Creates a recorder for time-stamped begin and end events on a fixed
+ * number of threads, which can be written out in the Chrome trace-event
+ * JSON format and viewed using chrome://tracing or https://ui.perfetto.dev
+ *
+ * Each thread records events into its own buffer, so recording does not
+ * need any locking, but each thread index must only be used by one
+ * thread at a time.
+ *
+ * All functions that record events return immediately if the
+ * trace pointer is NULL, so calls can be left in place when tracing is
+ * not required.
+ *
+ * @param[in] num_threads Number of threads that will record events.
+ */
+OSKAR_EXPORT
+oskar_Trace* oskar_trace_create(int num_threads);
+
+/**
+ * @brief Destroys the trace recorder.
+ *
+ * @details
+ * Destroys the trace recorder.
+ *
+ * @param[in,out] trace Pointer to trace recorder.
+ */
+OSKAR_EXPORT
+void oskar_trace_free(oskar_Trace* trace);
+
+/**
+ * @brief Sets the display name of a thread.
+ *
+ * @details
+ * Sets the name of a thread, which is shown by the trace viewer.
+ *
+ * @param[in,out] trace  Pointer to trace recorder.
+ * @param[in]     thread Thread index.
+ * @param[in]     name   Name of the thread.
+ */
+OSKAR_EXPORT
+void oskar_trace_set_thread_name(oskar_Trace* trace, int thread,
+        const char* name);
+
+/**
+ * @brief Records the start of a named span.
+ *
+ * @details
+ * Records the start of a named span on the given thread.
+ *
+ * The name is not copied, so it must be a string literal, or otherwise
+ * remain valid until the trace has been written.
+ *
+ * @param[in,out] trace  Pointer to trace recorder.
+ * @param[in]     thread Thread index.
+ * @param[in]     name   Name of the span.
+ */
+OSKAR_EXPORT
+void oskar_trace_begin(oskar_Trace* trace, int thread, const char* name);
+
+/**
+ * @brief Records the start of a named span with integer arguments.
+ *
+ * @details
+ * Records the start of a named span on the given thread, with up to
+ * two integer arguments that are shown by the trace viewer.
+ * Argument names that are NULL are ignored.
+ *
+ * The names are not copied, so they must be string literals, or otherwise
+ * remain valid until the trace has been written.
+ *
+ * @param[in,out] trace  Pointer to trace recorder.
+ * @param[in]     thread Thread index.
+ * @param[in]     name   Name of the span.
+ * @param[in]     arg0_name Name of first argument.
+ * @param[in]     arg0      Value of first argument.
+ * @param[in]     arg1_name Name of second argument.
+ * @param[in]     arg1      Value of second argument.
+ */
+OSKAR_EXPORT
+void oskar_trace_begin_args(oskar_Trace* trace, int thread, const char* name,
+        const char* arg0_name, int arg0, const char* arg1_name, int arg1);
+
+/**
+ * @brief Records the end of the most recent span.
+ *
+ * @details
+ * Records the end of the most recently started span on the given thread.
+ *
+ * @param[in,out] trace  Pointer to trace recorder.
+ * @param[in]     thread Thread index.
+ */
+OSKAR_EXPORT
+void oskar_trace_end(oskar_Trace* trace, int thread);
+
+/**
+ * @brief Writes the trace to a file.
+ *
+ * @details
+ * Writes all recorded events to a file in the Chrome trace-event JSON format.
+ * This must only be called when no other thread is recording events.
+ *
+ * @param[in]     trace    Pointer to trace recorder.
+ * @param[in]     filename Path of the output file.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_trace_write(const oskar_Trace* trace, const char* filename,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_TRACE_H_ */
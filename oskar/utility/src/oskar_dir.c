@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,14 +27,17 @@
  */
 
 #include "utility/oskar_dir.h"
+#include "utility/oskar_thread.h"
 
 #ifndef OSKAR_OS_WIN
 #include <dirent.h>
 #include <errno.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #else
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#include <process.h>
 #endif
 
 #include <stdio.h>
@@ -294,6 +297,24 @@ char oskar_dir_separator(void)
 }
 
 
+char* oskar_dir_temp_file_name(const char* file_path)
+{
+    static volatile int counter = 0;
+    char* name;
+    long pid;
+    int n;
+#ifdef OSKAR_OS_WIN
+    pid = (long) _getpid();
+#else
+    pid = (long) getpid();
+#endif
+    n = oskar_atomic_add_int(&counter, 1);
+    name = (char*) malloc(strlen(file_path) + 40);
+    if (name) sprintf(name, "%s.%ld.%d.tmp", file_path, pid, n);
+    return name;
+}
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "utility/oskar_event_ring.h"
+#include "utility/oskar_thread.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_EventRing
+{
+    oskar_Event* events;
+    int mask;              /* Capacity - 1 (capacity is a power of two). */
+    volatile int head;     /* Count of events pushed (written by producer). */
+    volatile int tail;     /* Count of events popped (written by consumer). */
+    volatile int dropped;  /* Count of events discarded. */
+};
+
+oskar_EventRing* oskar_event_ring_create(int capacity)
+{
+    int size = 1;
+    oskar_EventRing* ring;
+    while (size < capacity) size <<= 1;
+    ring = (oskar_EventRing*) calloc(1, sizeof(oskar_EventRing));
+    if (!ring) return 0;
+    ring->events = (oskar_Event*) calloc(size, sizeof(oskar_Event));
+    if (!ring->events)
+    {
+        free(ring);
+        return 0;
+    }
+    ring->mask = size - 1;
+    return ring;
+}
+
+void oskar_event_ring_free(oskar_EventRing* ring)
+{
+    if (!ring) return;
+    free(ring->events);
+    free(ring);
+}
+
+int oskar_event_ring_push(oskar_EventRing* ring, const oskar_Event* event)
+{
+    const int head = ring->head; /* Only modified by this thread. */
+    if ((unsigned int)head - (unsigned int)oskar_atomic_load_int(
+            &ring->tail) > (unsigned int)ring->mask)
+    {
+        oskar_atomic_add_int(&ring->dropped, 1);
+        return 0;
+    }
+    memcpy(&ring->events[head & ring->mask], event, sizeof(oskar_Event));
+    oskar_atomic_store_int(&ring->head, (int)((unsigned int)head + 1u));
+    return 1;
+}
+
+const oskar_Event* oskar_event_ring_peek(oskar_EventRing* ring)
+{
+    const int tail = ring->tail; /* Only modified by this thread. */
+    if (oskar_atomic_load_int(&ring->head) == tail) return 0;
+    return &ring->events[tail & ring->mask];
+}
+
+int oskar_event_ring_pop(oskar_EventRing* ring, oskar_Event* event)
+{
+    const oskar_Event* e = oskar_event_ring_peek(ring);
+    if (!e) return 0;
+    if (event) memcpy(event, e, sizeof(oskar_Event));
+    oskar_atomic_store_int(&ring->tail,
+            (int)((unsigned int)ring->tail + 1u));
+    return 1;
+}
+
+int oskar_event_ring_num_dropped(oskar_EventRing* ring)
+{
+    return oskar_atomic_load_int(&ring->dropped);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017, The University of Oxford
+ * Copyright (c) 2017-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -26,6 +26,10 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE /* For pthread_setaffinity_np(). */
+#endif
+
 #include "utility/oskar_thread.h"
 #include <stdlib.h>
 
@@ -35,6 +39,14 @@
 #include <process.h>
 #else
 #include <pthread.h>
+#include <sys/time.h>
+#endif
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define OSKAR_HAVE_ATOMIC_BUILTINS
 #endif
 
 
@@ -120,7 +132,6 @@ struct oskar_ConditionVar
     pthread_cond_t var;
 #endif
 };
-typedef struct oskar_ConditionVar oskar_ConditionVar;
 
 static void oskar_condition_init(oskar_ConditionVar* var)
 {
@@ -142,17 +153,32 @@ static void oskar_condition_uninit(oskar_ConditionVar* var)
 #endif
 }
 
-static void oskar_condition_lock(oskar_ConditionVar* var)
+oskar_ConditionVar* oskar_condition_create(void)
+{
+    oskar_ConditionVar* var;
+    var = (oskar_ConditionVar*) calloc(1, sizeof(oskar_ConditionVar));
+    if (var) oskar_condition_init(var);
+    return var;
+}
+
+void oskar_condition_free(oskar_ConditionVar* var)
+{
+    if (!var) return;
+    oskar_condition_uninit(var);
+    free(var);
+}
+
+void oskar_condition_lock(oskar_ConditionVar* var)
 {
     oskar_mutex_lock(&var->lock);
 }
 
-static void oskar_condition_unlock(oskar_ConditionVar* var)
+void oskar_condition_unlock(oskar_ConditionVar* var)
 {
     oskar_mutex_unlock(&var->lock);
 }
 
-static void oskar_condition_notify_all(oskar_ConditionVar* var)
+void oskar_condition_notify_all(oskar_ConditionVar* var)
 {
 #if defined(OSKAR_OS_WIN)
     WakeAllConditionVariable(&var->var);
@@ -161,7 +187,7 @@ static void oskar_condition_notify_all(oskar_ConditionVar* var)
 #endif
 }
 
-static void oskar_condition_wait(oskar_ConditionVar* var)
+void oskar_condition_wait(oskar_ConditionVar* var)
 {
 #if defined(OSKAR_OS_WIN)
     SleepConditionVariableCS(&var->var, &(var->lock.lock), INFINITE);
@@ -170,6 +196,24 @@ static void oskar_condition_wait(oskar_ConditionVar* var)
 #endif
 }
 
+static int oskar_condition_wait_timeout(oskar_ConditionVar* var,
+        double timeout_sec)
+{
+#if defined(OSKAR_OS_WIN)
+    return SleepConditionVariableCS(&var->var, &(var->lock.lock),
+            (DWORD)(timeout_sec * 1000.0)) ? 0 : 1;
+#else
+    struct timeval tv;
+    struct timespec ts;
+    double t;
+    gettimeofday(&tv, 0);
+    t = tv.tv_usec / 1e6 + timeout_sec;
+    ts.tv_sec = tv.tv_sec + (time_t)t;
+    ts.tv_nsec = (long)((t - (time_t)t) * 1e9);
+    return pthread_cond_timedwait(&var->var, &(var->lock.lock), &ts);
+#endif
+}
+
 
 /* =========================================================================
  *  THREAD
@@ -204,7 +248,9 @@ oskar_Thread* oskar_thread_create(void *(*start_routine)(void*), void* arg,
     pthread_attr_t attr;
 #endif
     oskar_Thread* thread;
+    int error = 0;
     thread = (oskar_Thread*) calloc(1, sizeof(oskar_Thread));
+    if (!thread) return 0;
     thread->start_routine = start_routine;
     thread->arg = arg;
 
@@ -214,13 +260,20 @@ oskar_Thread* oskar_thread_create(void *(*start_routine)(void*), void* arg,
             (unsigned int) CREATE_SUSPENDED, &(thread->thread_id));
     if (thread->thread != 0)
         ResumeThread(thread->thread);
+    else
+        error = 1;
 #else
     pthread_attr_init(&attr);
     pthread_attr_setdetachstate(&attr,
             detached ? PTHREAD_CREATE_DETACHED : PTHREAD_CREATE_JOINABLE);
-    pthread_create(&thread->thread, &attr, start_routine, arg);
+    error = pthread_create(&thread->thread, &attr, start_routine, arg);
     pthread_attr_destroy(&attr);
 #endif
+    if (error)
+    {
+        free(thread);
+        return 0;
+    }
     return thread;
 }
 
@@ -243,6 +296,28 @@ void oskar_thread_join(oskar_Thread* thread)
 #endif
 }
 
+int oskar_thread_set_affinity(oskar_Thread* thread, int core)
+{
+    if (!thread || core < 0) return 0;
+#if defined(OSKAR_OS_WIN)
+    if (core >= (int) (8 * sizeof(DWORD_PTR))) return 0;
+    return SetThreadAffinityMask(thread->thread,
+            ((DWORD_PTR)1) << core) != 0;
+#elif defined(__linux__)
+    {
+        cpu_set_t set;
+        if (core >= CPU_SETSIZE) return 0;
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        return pthread_setaffinity_np(thread->thread,
+                sizeof(cpu_set_t), &set) == 0;
+    }
+#else
+    /* Thread affinity is not supported on this platform. */
+    return 0;
+#endif
+}
+
 
 /* =========================================================================
  *  BARRIER
@@ -302,6 +377,113 @@ int oskar_barrier_wait(oskar_Barrier* barrier)
     return 0;
 }
 
+
+
+/* =========================================================================
+ *  LATCH
+ * =========================================================================*/
+
+struct oskar_Latch
+{
+    oskar_ConditionVar var;
+    int count;
+};
+
+oskar_Latch* oskar_latch_create(void)
+{
+    oskar_Latch* latch;
+    latch = (oskar_Latch*) calloc(1, sizeof(oskar_Latch));
+    oskar_condition_init(&latch->var);
+    return latch;
+}
+
+void oskar_latch_free(oskar_Latch* latch)
+{
+    if (!latch) return;
+    oskar_condition_uninit(&latch->var);
+    free(latch);
+}
+
+void oskar_latch_set(oskar_Latch* latch, int count)
+{
+    oskar_condition_lock(&latch->var);
+    latch->count = count;
+    oskar_condition_unlock(&latch->var);
+}
+
+void oskar_latch_count_down(oskar_Latch* latch)
+{
+    oskar_condition_lock(&latch->var);
+    if (latch->count > 0 && --(latch->count) == 0)
+        oskar_condition_notify_all(&latch->var);
+    oskar_condition_unlock(&latch->var);
+}
+
+int oskar_latch_wait(oskar_Latch* latch, double timeout_sec)
+{
+    int done;
+    oskar_condition_lock(&latch->var);
+    if (latch->count > 0)
+        (void) oskar_condition_wait_timeout(&latch->var, timeout_sec);
+    done = (latch->count <= 0);
+    oskar_condition_unlock(&latch->var);
+    return done;
+}
+
+
+/* =========================================================================
+ *  ATOMICS
+ * =========================================================================*/
+
+#if !defined(OSKAR_HAVE_ATOMIC_BUILTINS) && !defined(OSKAR_OS_WIN)
+/* Fall back to a global lock if there are no atomic operations available. */
+static pthread_mutex_t atomic_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+int oskar_atomic_add_int(volatile int* value, int increment)
+{
+#if defined(OSKAR_HAVE_ATOMIC_BUILTINS)
+    return __atomic_fetch_add(value, increment, __ATOMIC_ACQ_REL);
+#elif defined(OSKAR_OS_WIN)
+    return (int) InterlockedExchangeAdd((volatile LONG*)value, increment);
+#else
+    int old;
+    pthread_mutex_lock(&atomic_lock);
+    old = *value;
+    *value += increment;
+    pthread_mutex_unlock(&atomic_lock);
+    return old;
+#endif
+}
+
+int oskar_atomic_load_int(volatile int* value)
+{
+#if defined(OSKAR_HAVE_ATOMIC_BUILTINS)
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#elif defined(OSKAR_OS_WIN)
+    return (int) InterlockedCompareExchange((volatile LONG*)value, 0, 0);
+#else
+    int v;
+    pthread_mutex_lock(&atomic_lock);
+    v = *value;
+    pthread_mutex_unlock(&atomic_lock);
+    return v;
+#endif
+}
+
+void oskar_atomic_store_int(volatile int* value, int new_value)
+{
+#if defined(OSKAR_HAVE_ATOMIC_BUILTINS)
+    __atomic_store_n(value, new_value, __ATOMIC_RELEASE);
+#elif defined(OSKAR_OS_WIN)
+    (void) InterlockedExchange((volatile LONG*)value, new_value);
+#else
+    pthread_mutex_lock(&atomic_lock);
+    *value = new_value;
+    pthread_mutex_unlock(&atomic_lock);
+#endif
+}
+
 #ifdef __cplusplus
 }
 #endif
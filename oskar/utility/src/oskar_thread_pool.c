@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "utility/oskar_thread_pool.h"
+#include "utility/oskar_get_num_procs.h"
+#include "utility/oskar_thread.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_Future
+{
+    oskar_ThreadPool* pool;
+    oskar_Future* next;
+    void *(*task)(void*);
+    void *arg, *result;
+    int done;
+};
+
+struct oskar_ThreadPool
+{
+    oskar_ConditionVar* var;
+    oskar_Thread** threads;
+    oskar_Future *head, *tail; /* Queue of tasks not yet started. */
+    int num_threads, shutdown;
+};
+
+static void* run_worker(void* arg)
+{
+    oskar_Future* f;
+    oskar_ThreadPool* pool = (oskar_ThreadPool*) arg;
+    oskar_condition_lock(pool->var);
+    for (;;)
+    {
+        /* Wait for a task, or until the pool is shut down. */
+        while (!pool->head && !pool->shutdown)
+            oskar_condition_wait(pool->var);
+        if (!pool->head) break;
+
+        /* Take the next task from the queue. */
+        f = pool->head;
+        pool->head = f->next;
+        if (!pool->head) pool->tail = 0;
+        oskar_condition_unlock(pool->var);
+
+        /* Run the task, and wake anything waiting for it. */
+        f->result = f->task(f->arg);
+        oskar_condition_lock(pool->var);
+        f->done = 1;
+        oskar_condition_notify_all(pool->var);
+    }
+    oskar_condition_unlock(pool->var);
+    return 0;
+}
+
+oskar_ThreadPool* oskar_thread_pool_create(int num_threads, int pin_to_cores,
+        int* status)
+{
+    int i, num_procs;
+    oskar_ThreadPool* pool;
+    if (*status) return 0;
+    if (num_threads < 1) num_threads = 1;
+    pool = (oskar_ThreadPool*) calloc(1, sizeof(oskar_ThreadPool));
+    if (!pool)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+    pool->var = oskar_condition_create();
+    pool->threads = (oskar_Thread**)
+            calloc(num_threads, sizeof(oskar_Thread*));
+    if (!pool->var || !pool->threads)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        oskar_thread_pool_free(pool);
+        return 0;
+    }
+    num_procs = oskar_get_num_procs();
+    for (i = 0; i < num_threads; ++i)
+    {
+        pool->threads[i] = oskar_thread_create(run_worker, (void*)pool, 0);
+        if (!pool->threads[i])
+        {
+            /* Stop any threads that were started, so that tasks are never
+             * run by a pool with fewer threads than requested. */
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            oskar_thread_pool_free(pool);
+            return 0;
+        }
+        pool->num_threads++;
+        if (pin_to_cores && num_procs > 0)
+            oskar_thread_set_affinity(pool->threads[i], i % num_procs);
+    }
+    return pool;
+}
+
+void oskar_thread_pool_free(oskar_ThreadPool* pool)
+{
+    int i;
+    if (!pool) return;
+    if (pool->var)
+    {
+        oskar_condition_lock(pool->var);
+        pool->shutdown = 1;
+        oskar_condition_notify_all(pool->var);
+        oskar_condition_unlock(pool->var);
+    }
+    for (i = 0; i < pool->num_threads; ++i)
+    {
+        oskar_thread_join(pool->threads[i]);
+        oskar_thread_free(pool->threads[i]);
+    }
+    oskar_condition_free(pool->var);
+    free(pool->threads);
+    free(pool);
+}
+
+int oskar_thread_pool_num_threads(const oskar_ThreadPool* pool)
+{
+    return pool ? pool->num_threads : 0;
+}
+
+oskar_Future* oskar_thread_pool_submit(oskar_ThreadPool* pool,
+        void *(*task)(void*), void* arg, int* status)
+{
+    oskar_Future* f = 0;
+    oskar_thread_pool_submit_all(pool, 1, task, arg, 0, &f, status);
+    return f;
+}
+
+void oskar_thread_pool_submit_all(oskar_ThreadPool* pool, int num_tasks,
+        void *(*task)(void*), void* args, size_t arg_size,
+        oskar_Future** futures, int* status)
+{
+    int i;
+    if (*status || num_tasks < 1) return;
+    if (!pool || !task || !futures)
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return;
+    }
+
+    /* Create all the futures before queueing any task, so that either
+     * all of them run or none of them do. */
+    for (i = 0; i < num_tasks; ++i)
+    {
+        futures[i] = (oskar_Future*) calloc(1, sizeof(oskar_Future));
+        if (!futures[i])
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            break;
+        }
+        futures[i]->pool = pool;
+        futures[i]->task = task;
+        futures[i]->arg = (char*)args + i * arg_size;
+        if (i > 0) futures[i - 1]->next = futures[i];
+    }
+    if (*status)
+    {
+        for (i = 0; i < num_tasks && futures[i]; ++i)
+        {
+            free(futures[i]);
+            futures[i] = 0;
+        }
+        return;
+    }
+
+    /* Queue the tasks. */
+    oskar_condition_lock(pool->var);
+    if (pool->tail)
+        pool->tail->next = futures[0];
+    else
+        pool->head = futures[0];
+    pool->tail = futures[num_tasks - 1];
+    oskar_condition_notify_all(pool->var);
+    oskar_condition_unlock(pool->var);
+}
+
+void* oskar_future_get(oskar_Future* future)
+{
+    if (!future) return 0;
+    oskar_condition_lock(future->pool->var);
+    while (!future->done)
+        oskar_condition_wait(future->pool->var);
+    oskar_condition_unlock(future->pool->var);
+    return future->result;
+}
+
+void oskar_future_free(oskar_Future* future)
+{
+    if (!future) return;
+    (void) oskar_future_get(future);
+    free(future);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -219,6 +219,20 @@ void oskar_timer_start(oskar_Timer* timer)
     oskar_timer_restart(timer);
 }
 
+double oskar_timer_wall_time(void)
+{
+    oskar_Timer timer;
+    timer.type = OSKAR_TIMER_NATIVE;
+#ifdef OSKAR_OS_WIN
+    {
+        LARGE_INTEGER freq;
+        QueryPerformanceFrequency(&freq);
+        timer.freq = (double)(freq.QuadPart);
+    }
+#endif
+    return oskar_get_wtime(&timer);
+}
+
 #ifdef __cplusplus
 }
 #endif
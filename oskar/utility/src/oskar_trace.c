@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "utility/oskar_trace.h"
+#include "utility/oskar_timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct TraceEvent
+{
+    double time_sec;
+    const char* name;         /* NULL for the end of a span. */
+    const char* arg_name[2];
+    int arg[2];
+};
+typedef struct TraceEvent TraceEvent;
+
+struct TraceThread
+{
+    char* name;
+    int num_events, capacity;
+    TraceEvent* events;
+};
+typedef struct TraceThread TraceThread;
+
+struct oskar_Trace
+{
+    double start_sec;
+    int num_threads;
+    TraceThread* threads;
+};
+
+static TraceEvent* new_event(oskar_Trace* trace, int thread)
+{
+    TraceThread* t;
+    if (thread < 0 || thread >= trace->num_threads) return 0;
+    t = &trace->threads[thread];
+    if (t->num_events == t->capacity)
+    {
+        TraceEvent* e;
+        const int capacity = t->capacity > 0 ? 2 * t->capacity : 1024;
+        e = (TraceEvent*) realloc(t->events, capacity * sizeof(TraceEvent));
+        if (!e) return 0;
+        t->events = e;
+        t->capacity = capacity;
+    }
+    return &t->events[t->num_events++];
+}
+
+oskar_Trace* oskar_trace_create(int num_threads)
+{
+    oskar_Trace* trace;
+    trace = (oskar_Trace*) calloc(1, sizeof(oskar_Trace));
+    trace->num_threads = num_threads;
+    trace->threads = (TraceThread*) calloc(num_threads, sizeof(TraceThread));
+    trace->start_sec = oskar_timer_wall_time();
+    return trace;
+}
+
+void oskar_trace_free(oskar_Trace* trace)
+{
+    int i;
+    if (!trace) return;
+    for (i = 0; i < trace->num_threads; ++i)
+    {
+        free(trace->threads[i].name);
+        free(trace->threads[i].events);
+    }
+    free(trace->threads);
+    free(trace);
+}
+
+void oskar_trace_set_thread_name(oskar_Trace* trace, int thread,
+        const char* name)
+{
+    TraceThread* t;
+    if (!trace || thread < 0 || thread >= trace->num_threads) return;
+    t = &trace->threads[thread];
+    free(t->name);
+    t->name = (char*) calloc(1 + strlen(name), 1);
+    strcpy(t->name, name);
+}
+
+void oskar_trace_begin(oskar_Trace* trace, int thread, const char* name)
+{
+    oskar_trace_begin_args(trace, thread, name, 0, 0, 0, 0);
+}
+
+void oskar_trace_begin_args(oskar_Trace* trace, int thread, const char* name,
+        const char* arg0_name, int arg0, const char* arg1_name, int arg1)
+{
+    TraceEvent* e;
+    if (!trace || !(e = new_event(trace, thread))) return;
+    e->name = name;
+    e->arg_name[0] = arg0_name;
+    e->arg_name[1] = arg1_name;
+    e->arg[0] = arg0;
+    e->arg[1] = arg1;
+    e->time_sec = oskar_timer_wall_time();
+}
+
+void oskar_trace_end(oskar_Trace* trace, int thread)
+{
+    TraceEvent* e;
+    if (!trace) return;
+    e = new_event(trace, thread);
+    if (!e) return;
+    e->time_sec = oskar_timer_wall_time();
+    e->name = 0;
+}
+
+void oskar_trace_write(const oskar_Trace* trace, const char* filename,
+        int* status)
+{
+    int i, j, k, first = 1;
+    FILE* file;
+    if (*status || !trace) return;
+    file = fopen(filename, "w");
+    if (!file)
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        return;
+    }
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    for (i = 0; i < trace->num_threads; ++i)
+    {
+        const TraceThread* t = &trace->threads[i];
+        if (t->name)
+        {
+            fprintf(file, "%s{\"name\": \"thread_name\", \"ph\": \"M\", "
+                    "\"pid\": 0, \"tid\": %d, \"args\": {\"name\": \"%s\"}}",
+                    first ? "" : ",\n", i, t->name);
+            fprintf(file, ",\n{\"name\": \"thread_sort_index\", "
+                    "\"ph\": \"M\", \"pid\": 0, \"tid\": %d, "
+                    "\"args\": {\"sort_index\": %d}}", i, i);
+            first = 0;
+        }
+        for (j = 0; j < t->num_events; ++j)
+        {
+            const TraceEvent* e = &t->events[j];
+            const double ts = 1e6 * (e->time_sec - trace->start_sec);
+            fprintf(file, "%s{\"name\": \"%s\", \"ph\": \"%c\", "
+                    "\"ts\": %.3f, \"pid\": 0, \"tid\": %d",
+                    first ? "" : ",\n", e->name ? e->name : "",
+                    e->name ? 'B' : 'E', ts, i);
+            if (e->name && (e->arg_name[0] || e->arg_name[1]))
+            {
+                fprintf(file, ", \"args\": {");
+                for (k = 0; k < 2; ++k)
+                {
+                    if (!e->arg_name[k]) continue;
+                    fprintf(file, "%s\"%s\": %d",
+                            (k > 0 && e->arg_name[0]) ? ", " : "",
+                            e->arg_name[k], e->arg[k]);
+                }
+                fprintf(file, "}");
+            }
+            fprintf(file, "}");
+            first = 0;
+        }
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017, The University of Oxford
+ * Copyright (c) 2017-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -29,6 +29,7 @@
 #include <gtest/gtest.h>
 #include "utility/oskar_get_num_procs.h"
 #include "utility/oskar_thread.h"
+#include "utility/oskar_thread_pool.h"
 #include "utility/oskar_timer.h"
 #include <cstdlib>
 
@@ -124,3 +125,154 @@ TEST(thread, barriers)
     free(args);
     free(threads);
 }
+
+struct CounterArgs
+{
+    volatile int* counter;
+    oskar_Latch* latch;
+};
+typedef struct CounterArgs CounterArgs;
+
+static void* thread_count(void* arg)
+{
+    CounterArgs* args = (CounterArgs*) arg;
+    for (int i = 0; i < 10000; ++i)
+        oskar_atomic_add_int(args->counter, 1);
+    oskar_latch_count_down(args->latch);
+    return 0;
+}
+
+TEST(thread, atomics_and_latch)
+{
+    int num_threads = 8;
+    volatile int counter = 0;
+    oskar_Latch* latch = oskar_latch_create();
+    oskar_latch_set(latch, num_threads);
+    ASSERT_EQ(0, oskar_latch_wait(latch, 0.001));
+    CounterArgs args;
+    args.counter = &counter;
+    args.latch = latch;
+    oskar_Thread** threads = (oskar_Thread**)
+            calloc((size_t) num_threads, sizeof(oskar_Thread*));
+    for (int i = 0; i < num_threads; ++i)
+        threads[i] = oskar_thread_create(thread_count, (void*)&args, 0);
+    while (!oskar_latch_wait(latch, 0.01)) {}
+    ASSERT_EQ(num_threads * 10000, oskar_atomic_load_int(&counter));
+    for (int i = 0; i < num_threads; ++i)
+    {
+        oskar_thread_join(threads[i]);
+        oskar_thread_free(threads[i]);
+    }
+    oskar_latch_free(latch);
+    free(threads);
+}
+
+struct QueueArgs
+{
+    oskar_ConditionVar* var;
+    int buffer[2], head, count, done, sum;
+};
+typedef struct QueueArgs QueueArgs;
+
+void* thread_consume(void* arg)
+{
+    QueueArgs* args = (QueueArgs*) arg;
+    for (;;)
+    {
+        oskar_condition_lock(args->var);
+        while (args->count == 0 && !args->done)
+            oskar_condition_wait(args->var);
+        if (args->count == 0)
+        {
+            oskar_condition_unlock(args->var);
+            break;
+        }
+        args->sum += args->buffer[args->head];
+        args->head = (args->head + 1) % 2;
+        args->count--;
+        oskar_condition_notify_all(args->var);
+        oskar_condition_unlock(args->var);
+    }
+    return 0;
+}
+
+TEST(thread, condition_variable)
+{
+    const int num_items = 1000;
+    QueueArgs args;
+    args.var = oskar_condition_create();
+    args.head = args.count = args.done = args.sum = 0;
+    oskar_Thread* thread = oskar_thread_create(thread_consume,
+            (void*)&args, 0);
+
+    // Produce items into a bounded buffer of two slots.
+    for (int i = 1; i <= num_items; ++i)
+    {
+        oskar_condition_lock(args.var);
+        while (args.count == 2)
+            oskar_condition_wait(args.var);
+        args.buffer[(args.head + args.count) % 2] = i;
+        args.count++;
+        oskar_condition_notify_all(args.var);
+        oskar_condition_unlock(args.var);
+    }
+    oskar_condition_lock(args.var);
+    args.done = 1;
+    oskar_condition_notify_all(args.var);
+    oskar_condition_unlock(args.var);
+    oskar_thread_join(thread);
+    oskar_thread_free(thread);
+    oskar_condition_free(args.var);
+    ASSERT_EQ(num_items * (num_items + 1) / 2, args.sum);
+}
+
+void* thread_double(void* arg)
+{
+    return (void*)((size_t)arg * 2);
+}
+
+TEST(thread, pool)
+{
+    int status = 0;
+    const int num_threads = 4, num_tasks = 100;
+    oskar_ThreadPool* pool = oskar_thread_pool_create(num_threads, 1, &status);
+    ASSERT_EQ(0, status);
+    ASSERT_EQ(num_threads, oskar_thread_pool_num_threads(pool));
+
+    // Check results of independent tasks.
+    oskar_Future* futures[num_tasks];
+    for (int i = 0; i < num_tasks; ++i)
+        futures[i] = oskar_thread_pool_submit(pool, thread_double,
+                (void*)(size_t)i, &status);
+    ASSERT_EQ(0, status);
+    for (int i = 0; i < num_tasks; ++i)
+    {
+        EXPECT_EQ((size_t)(2 * i), (size_t)oskar_future_get(futures[i]));
+        oskar_future_free(futures[i]);
+    }
+
+    // Re-use the same threads for tasks that wait at a barrier.
+    oskar_Barrier* barrier = oskar_barrier_create(num_threads);
+    ThreadArgs args[num_threads];
+    for (int k = 0; k < 2; ++k)
+    {
+        for (int i = 0; i < num_threads; ++i)
+        {
+            args[i].barrier = barrier;
+            args[i].thread_id = i;
+        }
+        oskar_thread_pool_submit_all(pool, num_threads, thread_barriers,
+                (void*)args, sizeof(ThreadArgs), futures, &status);
+        ASSERT_EQ(0, status);
+        for (int i = 0; i < num_threads; ++i)
+            oskar_future_free(futures[i]);
+    }
+    oskar_barrier_free(barrier);
+
+    // Check that an error status is not overwritten and nothing is queued.
+    status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+    EXPECT_TRUE(oskar_thread_pool_submit(pool, thread_double,
+            (void*)(size_t)1, &status) == 0);
+    EXPECT_EQ((int) OSKAR_ERR_MEMORY_ALLOC_FAILURE, status);
+    oskar_thread_pool_free(pool);
+}
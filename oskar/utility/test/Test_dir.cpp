@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -29,6 +29,8 @@
 #include <gtest/gtest.h>
 #include "utility/oskar_dir.h"
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 
 TEST(dir, create)
@@ -61,3 +63,16 @@ TEST(dir, list)
     for (int i = 0; i < n; ++i) free(d[i]);
     free(d);
 }
+
+
+TEST(dir, temp_file_name)
+{
+    char* name1 = oskar_dir_temp_file_name("test_file.dat");
+    char* name2 = oskar_dir_temp_file_name("test_file.dat");
+    ASSERT_TRUE(name1 != 0);
+    ASSERT_TRUE(name2 != 0);
+    EXPECT_EQ(0, strncmp(name1, "test_file.dat.", 14));
+    EXPECT_STRNE(name1, name2);
+    free(name1);
+    free(name2);
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+#include "utility/oskar_event_ring.h"
+#include "utility/oskar_thread.h"
+
+static const int num_events = 10000;
+
+static void* produce(void* arg)
+{
+    oskar_EventRing* ring = (oskar_EventRing*) arg;
+    for (int i = 0; i < num_events; ++i)
+    {
+        oskar_Event e;
+        e.type = 1;
+        e.time_sec = (double) i;
+        e.values[0] = i;
+        while (!oskar_event_ring_push(ring, &e)) {}
+    }
+    return 0;
+}
+
+TEST(event_ring, push_pop)
+{
+    oskar_Event e;
+    oskar_EventRing* ring = oskar_event_ring_create(3);
+    ASSERT_TRUE(oskar_event_ring_peek(ring) == 0);
+    for (int i = 0; i < 6; ++i)
+    {
+        e.values[0] = i;
+        oskar_event_ring_push(ring, &e);
+    }
+
+    // Capacity is rounded up to 4, so the last two events are discarded.
+    ASSERT_EQ(2, oskar_event_ring_num_dropped(ring));
+    for (int i = 0; i < 4; ++i)
+    {
+        ASSERT_EQ(i, oskar_event_ring_peek(ring)->values[0]);
+        ASSERT_EQ(1, oskar_event_ring_pop(ring, &e));
+        ASSERT_EQ(i, e.values[0]);
+    }
+    ASSERT_EQ(0, oskar_event_ring_pop(ring, &e));
+    oskar_event_ring_free(ring);
+}
+
+TEST(event_ring, threads)
+{
+    // Check events arrive in order when produced on another thread.
+    oskar_Event e;
+    oskar_EventRing* ring = oskar_event_ring_create(1024);
+    oskar_Thread* thread = oskar_thread_create(produce, (void*)ring, 0);
+    for (int i = 0; i < num_events; ++i)
+    {
+        while (!oskar_event_ring_pop(ring, &e)) {}
+        ASSERT_EQ(i, e.values[0]);
+    }
+    oskar_thread_join(thread);
+    oskar_thread_free(thread);
+    oskar_event_ring_free(ring);
+}
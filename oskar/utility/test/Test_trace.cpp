@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_trace.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+TEST(trace, write)
+{
+    int status = 0;
+    const char* filename = "temp_test_trace.json";
+    oskar_Trace* trace = oskar_trace_create(2);
+    oskar_trace_set_thread_name(trace, 0, "Writer");
+    oskar_trace_set_thread_name(trace, 1, "Device 0");
+    oskar_trace_begin_args(trace, 1, "Work unit", "time", 3, "chunk", 1);
+    oskar_trace_begin(trace, 1, "Jones K");
+    oskar_trace_end(trace, 1);
+    oskar_trace_end(trace, 1);
+    oskar_trace_begin(trace, 0, "Write");
+    oskar_trace_end(trace, 0);
+
+    // Out-of-range threads and NULL traces are ignored.
+    oskar_trace_begin(trace, 2, "Ignored");
+    oskar_trace_begin(0, 0, "Ignored");
+    oskar_trace_write(trace, filename, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_trace_free(trace);
+
+    // Check the file contents.
+    std::string contents;
+    char buffer[256];
+    FILE* file = fopen(filename, "r");
+    ASSERT_TRUE(file != 0);
+    while (fgets(buffer, sizeof(buffer), file)) contents += buffer;
+    fclose(file);
+    remove(filename);
+    EXPECT_NE(std::string::npos, contents.find("\"name\": \"Device 0\""));
+    EXPECT_NE(std::string::npos, contents.find(
+            "\"args\": {\"time\": 3, \"chunk\": 1}"));
+    EXPECT_NE(std::string::npos, contents.find("\"name\": \"Jones K\""));
+    EXPECT_EQ(std::string::npos, contents.find("Ignored"));
+}
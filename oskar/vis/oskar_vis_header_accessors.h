@@ -165,6 +165,13 @@ void oskar_vis_header_set_time_inc_sec(oskar_VisHeader* vis, double value);
 OSKAR_EXPORT
 void oskar_vis_header_set_time_average_sec(oskar_VisHeader* vis, double value);
 
+OSKAR_EXPORT
+void oskar_vis_header_set_max_channels_per_block(oskar_VisHeader* vis,
+        int value);
+
+OSKAR_EXPORT
+void oskar_vis_header_set_num_times_total(oskar_VisHeader* vis, int value);
+
 OSKAR_EXPORT
 void oskar_vis_header_set_phase_centre(oskar_VisHeader* vis,
         int coord_type, double ra_deg, double dec_deg);
@@ -59,16 +59,29 @@ static void oskar_get_station_std_dev_for_channel(oskar_Mem* station_std_dev,
     }
 }
 
-/* Applies noise to data in a visibility block, for the given channel. */
+/* Maximum number of baselines to generate random numbers for at once. */
+#define CHUNK 64
+
+/*
+ * Applies noise to data in a visibility block, for the given channel.
+ *
+ * The random number counter for each visibility amplitude is computed
+ * directly from its time and baseline index, rather than being incremented
+ * serially, so that rows of the baseline triangle can be processed in
+ * parallel while giving identical results to a serial loop.
+ * For each time, the counters run over all cross-correlations first and then
+ * over all auto-correlations; matrix types use two counters per element.
+ */
 static void oskar_vis_block_apply_noise(oskar_VisBlock* vis,
         const oskar_Mem* station_std_dev, unsigned int seed,
         unsigned int block_idx, unsigned int channel_idx,
         double channel_bandwidth_hz, double time_int_sec, int* status)
 {
-    int a1, a2, have_autocorr, have_crosscorr, block_start, b, c = 0, t;
+    int have_autocorr, have_crosscorr, row, num_rows, per_element;
     int num_baselines, num_channels, num_stations, num_times;
+    unsigned int counters_per_time, auto_offset;
     void *acorr_ptr, *xcorr_ptr;
-    double rnd[8], std, mean, sefd_conversion;
+    double sefd_conversion;
     const double inv_sqrt2 = 1.0 / sqrt(2.0);
 
     /* Get pointer to start of block, and block dimensions. */
@@ -80,6 +93,14 @@ static void oskar_vis_block_apply_noise(oskar_VisBlock* vis,
     num_channels   = oskar_vis_block_num_channels(vis);
     num_stations   = oskar_vis_block_num_stations(vis);
     num_times      = oskar_vis_block_num_times(vis);
+    num_rows       = num_times * num_stations;
+
+    /* Get the random number counter layout for each time. */
+    per_element = oskar_mem_is_matrix(
+            oskar_vis_block_cross_correlations(vis)) ? 2 : 1;
+    auto_offset = have_crosscorr ? num_baselines * per_element : 0;
+    counters_per_time = auto_offset +
+            (have_autocorr ? num_stations * per_element : 0);
 
     /* Get factor for conversion of sigma to SEFD. */
     sefd_conversion = sqrt(2.0*channel_bandwidth_hz * time_int_sec);
@@ -91,28 +112,43 @@ static void oskar_vis_block_apply_noise(oskar_VisBlock* vis,
      * falls out naturally when evaluating Stokes I from the dipole
      * correlations (i.e. I = 0.5 (XX+YY) ). */
 
+    /* Each row is a single time and first station of the baseline triangle:
+     * it holds the cross-correlations (a1, a1+1...) and the auto-correlation
+     * for station a1. */
     switch (oskar_mem_type(oskar_vis_block_cross_correlations(vis)))
     {
     case OSKAR_SINGLE_COMPLEX:
     {
         const float* station_std;
-        float2* data;
         station_std = oskar_mem_float_const(station_std_dev, status);
-        for (t = 0; t < num_times; ++t)
+#pragma omp parallel for private(row) schedule(dynamic)
+        for (row = 0; row < num_rows; ++row)
         {
+            int a1, a2, b, i, n, t;
+            unsigned int c0;
+            float2* data;
+            double rnd[2 * CHUNK], std, mean;
+            t = row / num_stations;
+            a1 = row % num_stations;
+            c0 = (unsigned int)t * counters_per_time;
             if (have_crosscorr)
             {
                 /* Cross-correlation noise. */
-                block_start = num_baselines * (num_channels * t + channel_idx);
-                data = (float2*) xcorr_ptr + block_start;
-                for (a1 = 0, b = 0; a1 < num_stations; ++a1)
+                b = a1 * (2 * num_stations - a1 - 1) / 2;
+                data = (float2*) xcorr_ptr +
+                        num_baselines * (num_channels * t + channel_idx);
+                for (a2 = a1 + 1; a2 < num_stations; a2 += n, b += n)
                 {
-                    for (a2 = a1 + 1; a2 < num_stations; ++b, ++a2)
+                    n = num_stations - a2;
+                    if (n > CHUNK) n = CHUNK;
+                    oskar_random_gaussian2_array(seed, c0 + b,
+                            block_idx, n, rnd);
+                    for (i = 0; i < n; ++i)
                     {
-                        oskar_random_gaussian2(seed, c++, block_idx, rnd);
-                        std = sqrt(station_std[a1] * station_std[a2]) * inv_sqrt2;
-                        data[b].x += std * rnd[0];
-                        data[b].y += std * rnd[1];
+                        std = sqrt(station_std[a1] * station_std[a2 + i]) *
+                                inv_sqrt2;
+                        data[b + i].x += std * rnd[2*i];
+                        data[b + i].y += std * rnd[2*i + 1];
                     }
                 }
             }
@@ -121,15 +157,13 @@ static void oskar_vis_block_apply_noise(oskar_VisBlock* vis,
             {
                 /* Autocorrelation noise. Phases are all zero after
                  * autocorrelation, so ignore the imaginary components. */
-                block_start = num_stations * (num_channels * t + channel_idx);
-                data = (float2*) acorr_ptr + block_start;
-                for (a1 = 0; a1 < num_stations; ++a1)
-                {
-                    oskar_random_gaussian2(seed, c++, block_idx, rnd);
-                    std = station_std[a1];
-                    mean = sqrt(2.0)*station_std[a1];
-                    data[a1].x += std * rnd[0] + mean * sefd_conversion;
-                }
+                data = (float2*) acorr_ptr +
+                        num_stations * (num_channels * t + channel_idx);
+                oskar_random_gaussian2(seed, c0 + auto_offset + a1,
+                        block_idx, rnd);
+                std = station_std[a1];
+                mean = sqrt(2.0)*station_std[a1];
+                data[a1].x += std * rnd[0] + mean * sefd_conversion;
             }
         }
         break;
@@ -137,30 +171,42 @@ static void oskar_vis_block_apply_noise(oskar_VisBlock* vis,
     case OSKAR_SINGLE_COMPLEX_MATRIX:
     {
         const float* station_std;
-        float4c* data;
         station_std = oskar_mem_float_const(station_std_dev, status);
-        for (t = 0; t < num_times; ++t)
+#pragma omp parallel for private(row) schedule(dynamic)
+        for (row = 0; row < num_rows; ++row)
         {
+            int a1, a2, b, i, n, t;
+            unsigned int c0;
+            float4c* data;
+            double rnd[8 * CHUNK], std, mean;
+            const double* r;
+            t = row / num_stations;
+            a1 = row % num_stations;
+            c0 = (unsigned int)t * counters_per_time;
             if (have_crosscorr)
             {
                 /* Cross-correlation noise. */
-                block_start = num_baselines * (num_channels * t + channel_idx);
-                data = (float4c*) xcorr_ptr + block_start;
-                for (a1 = 0, b = 0; a1 < num_stations; ++a1)
+                b = a1 * (2 * num_stations - a1 - 1) / 2;
+                data = (float4c*) xcorr_ptr +
+                        num_baselines * (num_channels * t + channel_idx);
+                for (a2 = a1 + 1; a2 < num_stations; a2 += n, b += n)
                 {
-                    for (a2 = a1 + 1; a2 < num_stations; ++b, ++a2)
+                    n = num_stations - a2;
+                    if (n > CHUNK) n = CHUNK;
+                    oskar_random_gaussian4_array(seed, c0 + 2 * b,
+                            block_idx, 0, 0, 2 * n, rnd);
+                    for (i = 0; i < n; ++i)
                     {
-                        oskar_random_gaussian4(seed, c++, block_idx, 0, 0, rnd);
-                        oskar_random_gaussian4(seed, c++, block_idx, 0, 0, rnd + 4);
-                        std = sqrt(station_std[a1] * station_std[a2]);
-                        data[b].a.x += std * rnd[0];
-                        data[b].a.y += std * rnd[1];
-                        data[b].b.x += std * rnd[2];
-                        data[b].b.y += std * rnd[3];
-                        data[b].c.x += std * rnd[4];
-                        data[b].c.y += std * rnd[5];
-                        data[b].d.x += std * rnd[6];
-                        data[b].d.y += std * rnd[7];
+                        r = &rnd[8*i];
+                        std = sqrt(station_std[a1] * station_std[a2 + i]);
+                        data[b + i].a.x += std * r[0];
+                        data[b + i].a.y += std * r[1];
+                        data[b + i].b.x += std * r[2];
+                        data[b + i].b.y += std * r[3];
+                        data[b + i].c.x += std * r[4];
+                        data[b + i].c.y += std * r[5];
+                        data[b + i].d.x += std * r[6];
+                        data[b + i].d.y += std * r[7];
                     }
                 }
             }
@@ -169,21 +215,18 @@ static void oskar_vis_block_apply_noise(oskar_VisBlock* vis,
             {
                 /* Autocorrelation noise. Phases are all zero after
                  * autocorrelation, so ignore the imaginary components. */
-                block_start = num_stations * (num_channels * t + channel_idx);
-                data = (float4c*) acorr_ptr + block_start;
-                for (a1 = 0; a1 < num_stations; ++a1)
-                {
-                    oskar_random_gaussian4(seed, c++, block_idx, 0, 0, rnd);
-                    oskar_random_gaussian4(seed, c++, block_idx, 0, 0, rnd + 4);
-                    std = station_std[a1] * sqrt(2.0);
-                    mean = std * sefd_conversion;
-                    data[a1].a.x += std * rnd[0] + mean;
-                    data[a1].b.x += std * rnd[1];
-                    data[a1].b.y += std * rnd[2];
-                    data[a1].c.x += std * rnd[3];
-                    data[a1].c.y += std * rnd[4];
-                    data[a1].d.x += std * rnd[5] + mean;
-                }
+                data = (float4c*) acorr_ptr +
+                        num_stations * (num_channels * t + channel_idx);
+                oskar_random_gaussian4_array(seed, c0 + auto_offset + 2 * a1,
+                        block_idx, 0, 0, 2, rnd);
+                std = station_std[a1] * sqrt(2.0);
+                mean = std * sefd_conversion;
+                data[a1].a.x += std * rnd[0] + mean;
+                data[a1].b.x += std * rnd[1];
+                data[a1].b.y += std * rnd[2];
+                data[a1].c.x += std * rnd[3];
+                data[a1].c.y += std * rnd[4];
+                data[a1].d.x += std * rnd[5] + mean;
             }
         }
         break;
@@ -191,23 +234,35 @@ static void oskar_vis_block_apply_noise(oskar_VisBlock* vis,
     case OSKAR_DOUBLE_COMPLEX:
     {
         const double* station_std;
-        double2* data;
         station_std = oskar_mem_double_const(station_std_dev, status);
-        for (t = 0; t < num_times; ++t)
+#pragma omp parallel for private(row) schedule(dynamic)
+        for (row = 0; row < num_rows; ++row)
         {
+            int a1, a2, b, i, n, t;
+            unsigned int c0;
+            double2* data;
+            double rnd[2 * CHUNK], std, mean;
+            t = row / num_stations;
+            a1 = row % num_stations;
+            c0 = (unsigned int)t * counters_per_time;
             if (have_crosscorr)
             {
                 /* Cross-correlation noise. */
-                block_start = num_baselines * (num_channels * t + channel_idx);
-                data = (double2*) xcorr_ptr + block_start;
-                for (a1 = 0, b = 0; a1 < num_stations; ++a1)
+                b = a1 * (2 * num_stations - a1 - 1) / 2;
+                data = (double2*) xcorr_ptr +
+                        num_baselines * (num_channels * t + channel_idx);
+                for (a2 = a1 + 1; a2 < num_stations; a2 += n, b += n)
                 {
-                    for (a2 = a1 + 1; a2 < num_stations; ++b, ++a2)
+                    n = num_stations - a2;
+                    if (n > CHUNK) n = CHUNK;
+                    oskar_random_gaussian2_array(seed, c0 + b,
+                            block_idx, n, rnd);
+                    for (i = 0; i < n; ++i)
                     {
-                        oskar_random_gaussian2(seed, c++, block_idx, rnd);
-                        std = sqrt(station_std[a1] * station_std[a2]) * inv_sqrt2;
-                        data[b].x += std * rnd[0];
-                        data[b].y += std * rnd[1];
+                        std = sqrt(station_std[a1] * station_std[a2 + i]) *
+                                inv_sqrt2;
+                        data[b + i].x += std * rnd[2*i];
+                        data[b + i].y += std * rnd[2*i + 1];
                     }
                 }
             }
@@ -216,15 +271,13 @@ static void oskar_vis_block_apply_noise(oskar_VisBlock* vis,
             {
                 /* Autocorrelation noise. Phases are all zero after
                  * autocorrelation, so ignore the imaginary components. */
-                block_start = num_stations * (num_channels * t + channel_idx);
-                data = (double2*) acorr_ptr + block_start;
-                for (a1 = 0; a1 < num_stations; ++a1)
-                {
-                    oskar_random_gaussian2(seed, c++, block_idx, rnd);
-                    std  = station_std[a1];
-                    mean = station_std[a1] * sefd_conversion * sqrt(2.0);
-                    data[a1].x += std * rnd[0] + mean;
-                }
+                data = (double2*) acorr_ptr +
+                        num_stations * (num_channels * t + channel_idx);
+                oskar_random_gaussian2(seed, c0 + auto_offset + a1,
+                        block_idx, rnd);
+                std  = station_std[a1];
+                mean = station_std[a1] * sefd_conversion * sqrt(2.0);
+                data[a1].x += std * rnd[0] + mean;
             }
         }
         break;
@@ -232,30 +285,42 @@ static void oskar_vis_block_apply_noise(oskar_VisBlock* vis,
     case OSKAR_DOUBLE_COMPLEX_MATRIX:
     {
         const double* station_std;
-        double4c* data;
         station_std = oskar_mem_double_const(station_std_dev, status);
-        for (t = 0; t < num_times; ++t)
+#pragma omp parallel for private(row) schedule(dynamic)
+        for (row = 0; row < num_rows; ++row)
         {
+            int a1, a2, b, i, n, t;
+            unsigned int c0;
+            double4c* data;
+            double rnd[8 * CHUNK], std, mean;
+            const double* r;
+            t = row / num_stations;
+            a1 = row % num_stations;
+            c0 = (unsigned int)t * counters_per_time;
             if (have_crosscorr)
             {
                 /* Cross-correlation noise. */
-                block_start = num_baselines * (num_channels * t + channel_idx);
-                data = (double4c*) xcorr_ptr + block_start;
-                for (a1 = 0, b = 0; a1 < num_stations; ++a1)
+                b = a1 * (2 * num_stations - a1 - 1) / 2;
+                data = (double4c*) xcorr_ptr +
+                        num_baselines * (num_channels * t + channel_idx);
+                for (a2 = a1 + 1; a2 < num_stations; a2 += n, b += n)
                 {
-                    for (a2 = a1 + 1; a2 < num_stations; ++b, ++a2)
+                    n = num_stations - a2;
+                    if (n > CHUNK) n = CHUNK;
+                    oskar_random_gaussian4_array(seed, c0 + 2 * b,
+                            block_idx, 0, 0, 2 * n, rnd);
+                    for (i = 0; i < n; ++i)
                     {
-                        oskar_random_gaussian4(seed, c++, block_idx, 0, 0, rnd);
-                        oskar_random_gaussian4(seed, c++, block_idx, 0, 0, rnd + 4);
-                        std = sqrt(station_std[a1] * station_std[a2]);
-                        data[b].a.x += std * rnd[0];
-                        data[b].a.y += std * rnd[1];
-                        data[b].b.x += std * rnd[2];
-                        data[b].b.y += std * rnd[3];
-                        data[b].c.x += std * rnd[4];
-                        data[b].c.y += std * rnd[5];
-                        data[b].d.x += std * rnd[6];
-                        data[b].d.y += std * rnd[7];
+                        r = &rnd[8*i];
+                        std = sqrt(station_std[a1] * station_std[a2 + i]);
+                        data[b + i].a.x += std * r[0];
+                        data[b + i].a.y += std * r[1];
+                        data[b + i].b.x += std * r[2];
+                        data[b + i].b.y += std * r[3];
+                        data[b + i].c.x += std * r[4];
+                        data[b + i].c.y += std * r[5];
+                        data[b + i].d.x += std * r[6];
+                        data[b + i].d.y += std * r[7];
                     }
                 }
             }
@@ -264,21 +329,18 @@ static void oskar_vis_block_apply_noise(oskar_VisBlock* vis,
             {
                 /* Autocorrelation noise. Phases are all zero after
                  * autocorrelation, so ignore the imaginary components. */
-                block_start = num_stations * (num_channels * t + channel_idx);
-                data = (double4c*) acorr_ptr + block_start;
-                for (a1 = 0; a1 < num_stations; ++a1)
-                {
-                    oskar_random_gaussian4(seed, c++, block_idx, 0, 0, rnd);
-                    oskar_random_gaussian4(seed, c++, block_idx, 0, 0, rnd+4);
-                    std  = station_std[a1]*sqrt(2.0);
-                    mean = std * sefd_conversion;
-                    data[a1].a.x += std * rnd[0] + mean;
-                    data[a1].b.x += std * rnd[1];
-                    data[a1].b.y += std * rnd[2];
-                    data[a1].c.x += std * rnd[3];
-                    data[a1].c.y += std * rnd[4];
-                    data[a1].d.x += std * rnd[5] + mean;
-                }
+                data = (double4c*) acorr_ptr +
+                        num_stations * (num_channels * t + channel_idx);
+                oskar_random_gaussian4_array(seed, c0 + auto_offset + 2 * a1,
+                        block_idx, 0, 0, 2, rnd);
+                std  = station_std[a1]*sqrt(2.0);
+                mean = std * sefd_conversion;
+                data[a1].a.x += std * rnd[0] + mean;
+                data[a1].b.x += std * rnd[1];
+                data[a1].b.y += std * rnd[2];
+                data[a1].c.x += std * rnd[3];
+                data[a1].c.y += std * rnd[4];
+                data[a1].d.x += std * rnd[5] + mean;
             }
         }
         break;
@@ -290,7 +352,7 @@ void oskar_vis_block_add_system_noise(oskar_VisBlock* vis,
         const oskar_VisHeader* header, const oskar_Telescope* telescope,
         unsigned int block_index, oskar_Mem* station_work, int* status)
 {
-    int c, num_channels;
+    int c, num_channels, start_channel;
     unsigned int seed;
     double freq_hz, freq_start_hz, freq_inc_hz;
     double channel_bandwidth_hz, time_int_sec;
@@ -316,11 +378,12 @@ void oskar_vis_block_add_system_noise(oskar_VisBlock* vis,
     time_int_sec         = oskar_vis_header_time_average_sec(header);
     freq_start_hz        = oskar_vis_header_freq_start_hz(header);
     freq_inc_hz          = oskar_vis_header_freq_inc_hz(header);
+    start_channel        = oskar_vis_block_start_channel_index(vis);
 
     /* Apply noise to each channel. */
     for (c = 0; c < num_channels; ++c)
     {
-        freq_hz = freq_start_hz + c * freq_inc_hz;
+        freq_hz = freq_start_hz + (start_channel + c) * freq_inc_hz;
         oskar_get_station_std_dev_for_channel(station_work, freq_hz,
                 telescope, status);
         oskar_vis_block_apply_noise(vis, station_work, seed,
@@ -441,7 +441,8 @@ class Imager(object):
             return _imager_lib.run(self._capsule, return_images, return_grids)
         else:
             self.reset_cache()
-            if self.weighting == 'Uniform' or self.algorithm == 'W-projection':
+            if self.weighting == 'Uniform' or \
+                    self.algorithm in ('W-projection', 'W-stacking'):
                 self.set_coords_only(True)
                 self.update(uu, vv, ww, amps, weight, time_centroid,
                             start_channel, end_channel, num_pols)
@@ -462,8 +463,8 @@ class Imager(object):
         """Sets the algorithm used by the imager.
 
         Args:
-            algorithm_type (str): Either 'FFT', 'DFT 2D', 'DFT 3D' or
-                'W-projection'.
+            algorithm_type (str): Either 'FFT', 'DFT 2D', 'DFT 3D',
+                'W-projection' or 'W-stacking'.
         """
         self.capsule_ensure()
         _imager_lib.set_algorithm(self._capsule, algorithm_type)
@@ -631,7 +632,8 @@ class Imager(object):
         _imager_lib.set_ms_column(self._capsule, column)
 
     def set_num_w_planes(self, num_planes):
-        """Sets the number of W-planes to use, if using W-projection.
+        """Sets the number of W-planes to use, if using W-projection,
+        or the number of W-layers, if using W-stacking.
 
         A number less than or equal to zero means 'automatic'.
 
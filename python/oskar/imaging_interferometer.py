@@ -94,10 +94,11 @@ class ImagingInterferometer(Interferometer):
         self._return_images = return_images
         self._return_grids = return_grids
 
-        # Iterate imagers to find any with uniform weighting or W-projection.
+        # Iterate imagers to find any with uniform weighting or W-correction.
         need_coords_first = False
         for im in self._imagers:
-            if im.weighting == 'Uniform' or im.algorithm == 'W-projection':
+            if im.weighting == 'Uniform' or \
+                    im.algorithm in ('W-projection', 'W-stacking'):
                 need_coords_first = True
 
         # Simulate coordinates first, if required.